@@ -54,7 +54,14 @@ Base64Help(VOID)
 }
 
 /**
- A buffer for a single data stream.
+ The number of bytes to read at a time.  This is a multiple of the number of
+ bytes encoded on each line, so each read encodes whole lines.
+ */
+#define BASE64_READ_SIZE (YORI_LIB_BASE64_LINE_LENGTH / 4 * 3 * 4096)
+
+/**
+ State for a single encode or decode operation.  Data is processed in fixed
+ size chunks, so memory use does not depend on the size of the input.
  */
 typedef struct _BASE64_BUFFER {
 
@@ -64,71 +71,66 @@ typedef struct _BASE64_BUFFER {
     HANDLE hSource;
 
     /**
-     The data buffer.
+     A handle to the destination of the processed data.
      */
-    YORI_LIB_BYTE_BUFFER ByteBuffer;
-
-} BASE64_BUFFER, *PBASE64_BUFFER;
+    HANDLE hTarget;
 
-/**
- Populate data from stdin into an in memory buffer.
+    /**
+     A buffer to read data into.
+     */
+    PUCHAR ReadBuffer;
 
- @param ThisBuffer A pointer to the process buffer set.
+    /**
+     The number of bytes in ReadBuffer.
+     */
+    YORI_ALLOC_SIZE_T ReadBufferLength;
 
- @return TRUE to indicate success, FALSE to indicate failure.
- */
-BOOL
-Base64BufferPump(
-    __in PBASE64_BUFFER ThisBuffer
-    )
-{
-    DWORD BytesRead;
-    BOOL Result = FALSE;
+    /**
+     A buffer to hold processed data before it is written.  This is large
+     enough to hold the result of processing a full ReadBuffer.
+     */
     PUCHAR WriteBuffer;
-    YORI_ALLOC_SIZE_T BytesAvailable;
-
-    while (TRUE) {
-
-        WriteBuffer = YoriLibByteBufferGetPointerToEnd(&ThisBuffer->ByteBuffer, 16384, &BytesAvailable);
-        if (WriteBuffer == NULL) {
-            break;
-        }
-
-        if (ReadFile(ThisBuffer->hSource,
-                     WriteBuffer,
-                     BytesAvailable,
-                     &BytesRead,
-                     NULL)) {
-
-            if (BytesRead == 0) {
-                Result = TRUE;
-                break;
-            }
-
-            YoriLibByteBufferAddToPopulatedLength(&ThisBuffer->ByteBuffer, BytesRead);
 
-        } else {
-            Result = TRUE;
-            break;
-        }
-    }
-
-    return Result;
-}
+} BASE64_BUFFER, *PBASE64_BUFFER;
 
 /**
- Allocate and initialize a buffer for an input stream.
+ Allocate and initialize buffers for an input stream.
 
  @param Buffer Pointer to the buffer to allocate structures for.
 
+ @param Decode TRUE if the stream is being decoded, FALSE if it is being
+        encoded.
+
  @return TRUE if the buffer is successfully initialized, FALSE if it is not.
  */
 BOOL
 Base64AllocateBuffer(
-    __out PBASE64_BUFFER Buffer
+    __inout PBASE64_BUFFER Buffer,
+    __in BOOLEAN Decode
     )
 {
-    return YoriLibByteBufferInitialize(&Buffer->ByteBuffer, 1024);
+    YORI_LIB_BASE64_ENCODER Encoder;
+    YORI_MAX_UNSIGNED_T WriteBufferLength;
+
+    Buffer->ReadBufferLength = BASE64_READ_SIZE;
+    if (Decode) {
+        WriteBufferLength = YoriLibBase64DecodeMaximumOutput(Buffer->ReadBufferLength);
+    } else {
+        YoriLibBase64EncodeInitialize(&Encoder, YORI_LIB_BASE64_LINE_LENGTH);
+        WriteBufferLength = YoriLibBase64EncodeMaximumOutput(&Encoder, Buffer->ReadBufferLength);
+    }
+
+    if (!YoriLibIsSizeAllocatable(Buffer->ReadBufferLength + WriteBufferLength)) {
+        return FALSE;
+    }
+
+    Buffer->ReadBuffer = YoriLibMalloc((YORI_ALLOC_SIZE_T)(Buffer->ReadBufferLength + WriteBufferLength));
+    if (Buffer->ReadBuffer == NULL) {
+        return FALSE;
+    }
+
+    Buffer->WriteBuffer = Buffer->ReadBuffer + Buffer->ReadBufferLength;
+    return TRUE;
 }
 
 /**
@@ -141,231 +143,159 @@ Base64FreeBuffer(
     __in PBASE64_BUFFER ThisBuffer
     )
 {
-    YoriLibByteBufferCleanup(&ThisBuffer->ByteBuffer);
+    if (ThisBuffer->ReadBuffer != NULL) {
+        YoriLibFree(ThisBuffer->ReadBuffer);
+        ThisBuffer->ReadBuffer = NULL;
+        ThisBuffer->WriteBuffer = NULL;
+    }
 }
 
 /**
- Perform base64 encode and output to the requested device.
+ Read the next chunk of data from the input stream.  A read failure is
+ treated as the end of the stream.
 
- @param ThisBuffer Pointer to the buffer to output.
+ @param ThisBuffer Pointer to the buffers for the stream.
 
- @return TRUE to indicate success, FALSE to indicate failure.
+ @return The number of bytes read, or zero at the end of the stream.
  */
-BOOL
-Base64Encode(
-    __inout PBASE64_BUFFER ThisBuffer
+YORI_ALLOC_SIZE_T
+Base64ReadChunk(
+    __in PBASE64_BUFFER ThisBuffer
     )
 {
-    DWORD CharsRequired;
-    YORI_STRING Buffer;
-    DWORD Err;
-    LPTSTR ErrText;
-    PUCHAR SourceBuffer;
-    YORI_ALLOC_SIZE_T BytesPopulated;
-
-    //
-    //  Calculate the buffer size needed
-    //
-
-    SourceBuffer = YoriLibByteBufferGetPointerToValidData(&ThisBuffer->ByteBuffer, 0, &BytesPopulated);
-    if (!DllCrypt32.pCryptBinaryToStringW(SourceBuffer, BytesPopulated, CRYPT_STRING_BASE64, NULL, &CharsRequired)) {
-        Err = GetLastError();
-        ErrText = YoriLibGetWinErrorText(Err);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: failure to calculate buffer length in CryptBinaryToString: %s"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
-        return FALSE;
-    }
-
-    //
-    //  Check if the buffer size would overflow, and fail if so
-    //
+    DWORD BytesRead;
 
-    if (!YoriLibIsSizeAllocatable(CharsRequired)) {
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: supplied data too large\n"));
-        return FALSE;
+    if (!ReadFile(ThisBuffer->hSource, ThisBuffer->ReadBuffer, ThisBuffer->ReadBufferLength, &BytesRead, NULL)) {
+        return 0;
     }
 
-    //
-    //  Allocate buffer
-    //
+    return (YORI_ALLOC_SIZE_T)BytesRead;
+}
 
-    if (!YoriLibAllocateString(&Buffer, (YORI_ALLOC_SIZE_T)CharsRequired)) {
-        Err = GetLastError();
-        ErrText = YoriLibGetWinErrorText(Err);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: allocation failure: %s"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
-        return FALSE;
-    }
+/**
+ Write processed data to the output stream.
 
-    //
-    //  Perform the encode
-    //
+ @param ThisBuffer Pointer to the buffers for the stream.
 
-    if (!DllCrypt32.pCryptBinaryToStringW(SourceBuffer, BytesPopulated, CRYPT_STRING_BASE64, Buffer.StartOfString, &CharsRequired)) {
-        Err = GetLastError();
-        ErrText = YoriLibGetWinErrorText(Err);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: failure to encode in CryptBinaryToString: %s"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
-        YoriLibFreeStringContents(&Buffer);
-        return FALSE;
-    }
-
-    Buffer.LengthInChars = (YORI_ALLOC_SIZE_T)CharsRequired;
+ @param Length The number of bytes in the write buffer to output.
 
-    //
-    //  Free the source buffer.  We're done with it by this point, and
-    //  output may need to double buffer for encoding.
-    //
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+Base64WriteChunk(
+    __in PBASE64_BUFFER ThisBuffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_ALLOC_SIZE_T BytesSent;
+    DWORD BytesWritten;
+    DWORD Err;
+    LPTSTR ErrText;
 
-    Base64FreeBuffer(ThisBuffer);
+    BytesSent = 0;
+    while (BytesSent < Length) {
+        if (!WriteFile(ThisBuffer->hTarget,
+                       YoriLibAddToPointer(ThisBuffer->WriteBuffer, BytesSent),
+                       Length - BytesSent,
+                       &BytesWritten,
+                       NULL)) {
 
-    //
-    //  Output the encoded form.
-    //
+            Err = GetLastError();
+            ErrText = YoriLibGetWinErrorText(Err);
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: failure to write to output: %s"), ErrText);
+            YoriLibFreeWinErrorText(ErrText);
+            return FALSE;
+        }
 
-    YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y"), &Buffer);
-    YoriLibFreeStringContents(&Buffer);
+        BytesSent = BytesSent + BytesWritten;
+        ASSERT(BytesSent <= Length);
+    }
 
     return TRUE;
 }
 
 /**
- Perform base64 decode and output to the requested device.
+ Perform base64 encode and output to the requested device.
 
- @param ThisBuffer Pointer to the buffer to output.
+ @param ThisBuffer Pointer to the buffers for the stream.
 
  @return TRUE to indicate success, FALSE to indicate failure.
  */
 BOOL
-Base64Decode(
+Base64Encode(
     __inout PBASE64_BUFFER ThisBuffer
     )
 {
-    YORI_ALLOC_SIZE_T CharsRequired;
-    DWORD BytesRequired;
-    YORI_STRING Buffer;
-    PUCHAR BinaryBuffer;
-    DWORD Skip;
-    DWORD Flags;
-    DWORD BytesSent;
-    BOOL Result;
-    HANDLE hTarget;
-    DWORD Err;
-    LPTSTR ErrText;
-    PUCHAR SourceBuffer;
-    YORI_ALLOC_SIZE_T BytesPopulated;
-
-    //
-    //  Convert the input buffer into a UTF16 string.
-    //
-
-    SourceBuffer = YoriLibByteBufferGetPointerToValidData(&ThisBuffer->ByteBuffer, 0, &BytesPopulated);
-    if (SourceBuffer == NULL) {
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: allocation failure\n"));
-        return FALSE;
-    }
-    CharsRequired = YoriLibGetMultibyteInputSizeNeeded(SourceBuffer, BytesPopulated);
-    if (!YoriLibAllocateString(&Buffer, CharsRequired + 1)) {
-        Err = GetLastError();
-        ErrText = YoriLibGetWinErrorText(Err);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: allocation failure: %s"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
-        return FALSE;
-    }
+    YORI_LIB_BASE64_ENCODER Encoder;
+    YORI_ALLOC_SIZE_T BytesRead;
+    YORI_ALLOC_SIZE_T CharsGenerated;
 
-    YoriLibMultibyteInput(SourceBuffer, BytesPopulated, Buffer.StartOfString, CharsRequired);
-    Buffer.LengthInChars = CharsRequired;
-    Buffer.StartOfString[CharsRequired] = '\0';
+    YoriLibBase64EncodeInitialize(&Encoder, YORI_LIB_BASE64_LINE_LENGTH);
 
-    //
-    //  Free the source buffer.  We're done with it by this point, and
-    //  output may need to double buffer for encoding.
-    //
-
-    Base64FreeBuffer(ThisBuffer);
+    while (TRUE) {
+        if (YoriLibIsOperationCancelled()) {
+            return FALSE;
+        }
 
-    //
-    //  Calculate the buffer size needed
-    //
+        BytesRead = Base64ReadChunk(ThisBuffer);
+        if (BytesRead == 0) {
+            break;
+        }
 
-    if (!DllCrypt32.pCryptStringToBinaryW(Buffer.StartOfString, Buffer.LengthInChars, CRYPT_STRING_BASE64, NULL, &BytesRequired, NULL, NULL)) {
-        Err = GetLastError();
-        ErrText = YoriLibGetWinErrorText(Err);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: failure to calculate buffer length in CryptStringToBinary: %s"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
-        YoriLibFreeStringContents(&Buffer);
-        return FALSE;
+        CharsGenerated = YoriLibBase64EncodeUpdate(&Encoder, ThisBuffer->ReadBuffer, BytesRead, ThisBuffer->WriteBuffer);
+        if (!Base64WriteChunk(ThisBuffer, CharsGenerated)) {
+            return FALSE;
+        }
     }
 
-    //
-    //  Allocate binary buffer
-    //
+    CharsGenerated = YoriLibBase64EncodeFinalize(&Encoder, ThisBuffer->WriteBuffer);
+    return Base64WriteChunk(ThisBuffer, CharsGenerated);
+}
 
-    BinaryBuffer = YoriLibMalloc((YORI_ALLOC_SIZE_T)BytesRequired);
-    if (BinaryBuffer == NULL) {
-        Err = GetLastError();
-        ErrText = YoriLibGetWinErrorText(Err);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: allocation failure: %s"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
-        YoriLibFreeStringContents(&Buffer);
-        return FALSE;
-    }
+/**
+ Perform base64 decode and output to the requested device.
 
-    //
-    //  Perform the decode
-    //
+ @param ThisBuffer Pointer to the buffers for the stream.
 
-    if (!DllCrypt32.pCryptStringToBinaryW(Buffer.StartOfString, Buffer.LengthInChars, CRYPT_STRING_BASE64, BinaryBuffer, &BytesRequired, &Skip, &Flags)) {
-        Err = GetLastError();
-        ErrText = YoriLibGetWinErrorText(Err);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: failure to encode in CryptBinaryToString: %s"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
-        YoriLibFreeStringContents(&Buffer);
-        YoriLibFree(BinaryBuffer);
-        return FALSE;
-    }
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+Base64Decode(
+    __inout PBASE64_BUFFER ThisBuffer
+    )
+{
+    YORI_LIB_BASE64_DECODER Decoder;
+    YORI_ALLOC_SIZE_T BytesRead;
+    YORI_ALLOC_SIZE_T BytesGenerated;
 
-    //
-    //  We're done with the string form of the source, deallocate it.
-    //
+    YoriLibBase64DecodeInitialize(&Decoder);
 
-    YoriLibFreeStringContents(&Buffer);
+    while (TRUE) {
+        if (YoriLibIsOperationCancelled()) {
+            return FALSE;
+        }
 
-    //
-    //  Output the decoded form.
-    //
-    BytesSent = 0;
-    Result = TRUE;
-    hTarget = GetStdHandle(STD_OUTPUT_HANDLE);
-
-    while (BytesSent < BytesRequired) {
-        DWORD BytesToWrite;
-        DWORD BytesWritten;
-        BytesToWrite = 4096;
-        if (BytesSent + BytesToWrite > BytesRequired) {
-            BytesToWrite = BytesRequired - BytesSent;
+        BytesRead = Base64ReadChunk(ThisBuffer);
+        if (BytesRead == 0) {
+            break;
         }
 
-        if (WriteFile(hTarget,
-                      YoriLibAddToPointer(BinaryBuffer, BytesSent),
-                      BytesToWrite,
-                      &BytesWritten,
-                      NULL)) {
+        if (!YoriLibBase64DecodeUpdate(&Decoder, ThisBuffer->ReadBuffer, BytesRead, ThisBuffer->WriteBuffer, &BytesGenerated)) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: input is not valid base64\n"));
+            return FALSE;
+        }
 
-            BytesSent += BytesWritten;
-        } else {
-            Err = GetLastError();
-            ErrText = YoriLibGetWinErrorText(Err);
-            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: failure to write to output: %s"), ErrText);
-            YoriLibFreeWinErrorText(ErrText);
-            Result = FALSE;
+        if (!Base64WriteChunk(ThisBuffer, BytesGenerated)) {
+            return FALSE;
         }
+    }
 
-        ASSERT(BytesSent <= BytesRequired);
+    if (!YoriLibBase64DecodeFinalize(&Decoder, ThisBuffer->WriteBuffer, &BytesGenerated)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: input is not valid base64\n"));
+        return FALSE;
     }
-    YoriLibFree(BinaryBuffer);
 
-    return Result;
+    return Base64WriteChunk(ThisBuffer, BytesGenerated);
 }
 
 #ifdef YORI_BUILTIN
@@ -441,14 +371,6 @@ ENTRYPOINT(
         }
     }
 
-    YoriLibLoadCrypt32Functions();
-    if (DllCrypt32.pCryptBinaryToStringW == NULL ||
-        DllCrypt32.pCryptStringToBinaryW == NULL) {
-
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: operating system support not present\n"));
-        return EXIT_FAILURE;
-    }
-
 #if YORI_BUILTIN
     YoriLibCancelEnable(FALSE);
 #endif
@@ -460,6 +382,7 @@ ENTRYPOINT(
 
     YoriLibInitEmptyString(&FullFilePath);
     Base64Buffer.hSource = GetStdHandle(STD_INPUT_HANDLE);
+    Base64Buffer.hTarget = GetStdHandle(STD_OUTPUT_HANDLE);
     if (StartArg == 0 || StartArg == ArgC) {
         if (YoriLibIsStdInConsole()) {
             YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: no file or pipe for input\n"));
@@ -485,7 +408,7 @@ ENTRYPOINT(
         }
     }
 
-    if (!Base64AllocateBuffer(&Base64Buffer)) {
+    if (!Base64AllocateBuffer(&Base64Buffer, Decode)) {
         Err = GetLastError();
         ErrText = YoriLibGetWinErrorText(Err);
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("base64: allocating buffer failed: %s"), ErrText);
@@ -497,15 +420,6 @@ ENTRYPOINT(
         return EXIT_FAILURE;
     }
 
-    if (!Base64BufferPump(&Base64Buffer)) {
-        if (FullFilePath.LengthInChars > 0) {
-            CloseHandle(Base64Buffer.hSource);
-        }
-        YoriLibFreeStringContents(&FullFilePath);
-        Base64FreeBuffer(&Base64Buffer);
-        return EXIT_FAILURE;
-    }
-
     if (!Decode) {
         if (!Base64Encode(&Base64Buffer)) {
             if (FullFilePath.LengthInChars > 0) {
@@ -224,6 +224,30 @@ typedef struct _YS_SCRIPT_LINE {
      */
     YORI_STRING LineContents;
 
+    /**
+     If the line is a label, the entry for the label within the script's
+     label hash table.  Only meaningful if LabelIndexed is TRUE.
+     */
+    YORI_HASH_ENTRY LabelEntry;
+
+    /**
+     The index of this line within the script's array of lines.
+     */
+    YORI_ALLOC_SIZE_T LineIndex;
+
+    /**
+     TRUE if this line is a label that has been inserted into the script's
+     label hash table.
+     */
+    BOOLEAN LabelIndexed;
+
+    /**
+     TRUE if the line contains a variable reference which needs to be
+     expanded each time the line is executed.  If FALSE, the line can be
+     executed directly.
+     */
+    BOOLEAN ContainsVariables;
+
 } YS_SCRIPT_LINE, *PYS_SCRIPT_LINE;
 
 /**
@@ -271,6 +295,23 @@ typedef struct _YS_SCRIPT {
      */
     YORI_LIST_ENTRY LineLinks;
 
+    /**
+     An array of pointers to lines within the script, in execution order.
+     This is rebuilt from LineLinks whenever lines are added.
+     */
+    PYS_SCRIPT_LINE *Lines;
+
+    /**
+     The number of elements in the Lines array.
+     */
+    YORI_ALLOC_SIZE_T LineCount;
+
+    /**
+     A hash table of labels within the script, pointing to the line
+     containing each label.
+     */
+    PYORI_HASH_TABLE Labels;
+
     /**
      A linked list of call context information.
      */
@@ -314,14 +355,9 @@ PYS_SCRIPT YsActiveScript = NULL;
 VOID
 YsGotoScriptEnd(VOID)
 {
-    PYORI_LIST_ENTRY ListEntry;
-    PYS_SCRIPT_LINE Line;
-
-    ListEntry = YoriLibGetPreviousListEntry(&YsActiveScript->LineLinks, NULL);
-    ASSERT(ListEntry != NULL);
-    if (ListEntry != NULL) {
-        Line = CONTAINING_RECORD(ListEntry, YS_SCRIPT_LINE, LineLinks);
-        YsActiveScript->ActiveLine = Line;
+    ASSERT(YsActiveScript->LineCount > 0);
+    if (YsActiveScript->LineCount > 0) {
+        YsActiveScript->ActiveLine = YsActiveScript->Lines[YsActiveScript->LineCount - 1];
     }
 }
 
@@ -339,8 +375,8 @@ YsGotoLabel(
     __in LPTSTR Label
     )
 {
-    PYORI_LIST_ENTRY ListEntry;
-    PYS_SCRIPT_LINE Line;
+    PYORI_HASH_ENTRY HashEntry;
+    YORI_STRING LabelString;
 
     //
     //  First special case :eof for no good reason other than CMD does.
@@ -355,29 +391,11 @@ YsGotoLabel(
     //  Now look for user defined labels within the script.
     //
 
-    ListEntry = YoriLibGetNextListEntry(&YsActiveScript->LineLinks, NULL);
-    while (ListEntry != NULL) {
-        Line = CONTAINING_RECORD(ListEntry, YS_SCRIPT_LINE, LineLinks);
-        if (Line->LineContents.LengthInChars > 1 &&
-            Line->LineContents.StartOfString[0] == ':') {
-
-            YORI_STRING LabelString;
-
-            YoriLibInitEmptyString(&LabelString);
-            LabelString.StartOfString = &Line->LineContents.StartOfString[1];
-            LabelString.LengthInChars = Line->LineContents.LengthInChars - 1;
-
-            if (LabelString.LengthInChars >= 1 &&
-                LabelString.StartOfString[LabelString.LengthInChars - 1] == '\0') {
-                LabelString.LengthInChars--;
-            }
-
-            if (YoriLibCompareStringLitIns(&LabelString, Label) == 0) {
-                YsActiveScript->ActiveLine = Line;
-                return TRUE;
-            }
-        }
-        ListEntry = YoriLibGetNextListEntry(&YsActiveScript->LineLinks, ListEntry);
+    YoriLibConstantString(&LabelString, Label);
+    HashEntry = YoriLibHashLookupByKey(YsActiveScript->Labels, &LabelString);
+    if (HashEntry != NULL) {
+        YsActiveScript->ActiveLine = HashEntry->Context;
+        return TRUE;
     }
 
     return FALSE;
@@ -430,6 +448,9 @@ YsLoadLines(
         }
 
         YoriLibInitEmptyString(&ThisLine->LineContents);
+        ThisLine->LineIndex = 0;
+        ThisLine->LabelIndexed = FALSE;
+        ThisLine->ContainsVariables = FALSE;
 
         if (!YoriLibReadLineToString(&ThisLine->LineContents, &LineContext, Handle)) {
             YoriLibFree(ThisLine);
@@ -451,6 +472,137 @@ YsLoadLines(
     }
 }
 
+/**
+ Remove all labels from the script's label hash table.
+
+ @param Script The script whose labels should be removed.
+ */
+VOID
+YsRemoveLabels(
+    __in PYS_SCRIPT Script
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYS_SCRIPT_LINE Line;
+
+    ListEntry = YoriLibGetNextListEntry(&Script->LineLinks, NULL);
+    while (ListEntry != NULL) {
+        Line = CONTAINING_RECORD(ListEntry, YS_SCRIPT_LINE, LineLinks);
+        if (Line->LabelIndexed) {
+            YoriLibHashRemoveByEntry(&Line->LabelEntry);
+            Line->LabelIndexed = FALSE;
+        }
+        ListEntry = YoriLibGetNextListEntry(&Script->LineLinks, ListEntry);
+    }
+}
+
+/**
+ Prepare the lines of a script for execution.  This builds an array of lines
+ so that execution can move between lines by index, a hash table of labels
+ so that goto and call can find their target without scanning the script,
+ and records which lines need variables expanded before they are executed.
+ This is performed when a script is loaded and again whenever lines are
+ included into it.
+
+ @param Script The script to prepare.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YsCompileScript(
+    __inout PYS_SCRIPT Script
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYS_SCRIPT_LINE Line;
+    PYS_SCRIPT_LINE *NewLines;
+    YORI_ALLOC_SIZE_T LineCount;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_STRING LabelString;
+
+    if (Script->Labels == NULL) {
+        Script->Labels = YoriLibAllocateHashTable(32);
+        if (Script->Labels == NULL) {
+            return FALSE;
+        }
+    }
+
+    LineCount = 0;
+    ListEntry = YoriLibGetNextListEntry(&Script->LineLinks, NULL);
+    while (ListEntry != NULL) {
+        LineCount++;
+        ListEntry = YoriLibGetNextListEntry(&Script->LineLinks, ListEntry);
+    }
+
+    NewLines = NULL;
+    if (LineCount > 0) {
+        NewLines = YoriLibMalloc(LineCount * sizeof(PYS_SCRIPT_LINE));
+        if (NewLines == NULL) {
+            return FALSE;
+        }
+    }
+
+    //
+    //  Labels are rebuilt from scratch so that if a label is defined more
+    //  than once, the first definition in the script is used, including
+    //  when a later include adds a duplicate earlier in the script.
+    //
+
+    YsRemoveLabels(Script);
+
+    Index = 0;
+    ListEntry = YoriLibGetNextListEntry(&Script->LineLinks, NULL);
+    while (ListEntry != NULL) {
+        Line = CONTAINING_RECORD(ListEntry, YS_SCRIPT_LINE, LineLinks);
+        NewLines[Index] = Line;
+        Line->LineIndex = Index;
+        Index++;
+
+        if (Line->LineContents.LengthInChars > 1 &&
+            Line->LineContents.StartOfString[0] == ':') {
+
+            //
+            //  The label string refers to the line's allocation, so the
+            //  hash table holds a reference to it.
+            //
+
+            YoriLibInitEmptyString(&LabelString);
+            LabelString.MemoryToFree = Line->LineContents.MemoryToFree;
+            LabelString.StartOfString = &Line->LineContents.StartOfString[1];
+            LabelString.LengthInChars = Line->LineContents.LengthInChars - 1;
+
+            if (LabelString.LengthInChars >= 1 &&
+                LabelString.StartOfString[LabelString.LengthInChars - 1] == '\0') {
+                LabelString.LengthInChars--;
+            }
+            LabelString.LengthAllocated = LabelString.LengthInChars;
+
+            if (LabelString.LengthInChars > 0 &&
+                YoriLibHashLookupByKey(Script->Labels, &LabelString) == NULL) {
+
+                YoriLibHashInsertByKey(Script->Labels, &LabelString, Line, &Line->LabelEntry);
+                Line->LabelIndexed = TRUE;
+            }
+            Line->ContainsVariables = FALSE;
+        } else if (YoriLibFindLeftMostCharacter(&Line->LineContents, '%') != NULL) {
+            Line->ContainsVariables = TRUE;
+        } else {
+            Line->ContainsVariables = FALSE;
+        }
+
+        ListEntry = YoriLibGetNextListEntry(&Script->LineLinks, ListEntry);
+    }
+
+    if (Script->Lines != NULL) {
+        YoriLibFree(Script->Lines);
+    }
+    Script->Lines = NewLines;
+    Script->LineCount = LineCount;
+
+    return TRUE;
+}
+
 /**
  Return from an isolated stack state or script.
 
@@ -908,11 +1060,16 @@ YoriCmd_INCLUDE(
 
     if (!YsLoadLines(FileHandle, &YsActiveScript->ActiveLine->LineLinks)) {
         CloseHandle(FileHandle);
+        YsCompileScript(YsActiveScript);
         return EXIT_FAILURE;
     }
 
     CloseHandle(FileHandle);
 
+    if (!YsCompileScript(YsActiveScript)) {
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -1093,9 +1250,11 @@ YsExecuteScript(
     )
 {
     YORI_STRING LineWithArgumentsExpanded;
+    YORI_STRING LineWithoutVariables;
+    PYORI_STRING Expression;
     YORI_STRING CommandName;
     DWORD Index;
-    PYORI_LIST_ENTRY NextEntry;
+    YORI_ALLOC_SIZE_T LineIndex;
     PYS_SCRIPT_LINE CurrentLine;
     PYS_SCRIPT PreviouslyActiveScript;
 
@@ -1115,34 +1274,50 @@ YsExecuteScript(
     YsActiveScript = Script;
 
     YoriLibInitEmptyString(&LineWithArgumentsExpanded);
-    NextEntry = YoriLibGetNextListEntry(&Script->LineLinks, NULL);
-    while(NextEntry != NULL) {
-        CurrentLine = CONTAINING_RECORD(NextEntry, YS_SCRIPT_LINE, LineLinks);
+    LineIndex = 0;
+    while(LineIndex < Script->LineCount) {
+        CurrentLine = Script->Lines[LineIndex];
         Script->ActiveLine = CurrentLine;
 
         if (CurrentLine->LineContents.LengthInChars > 1 &&
             CurrentLine->LineContents.StartOfString[0] != ':') {
 
-            if (!YoriLibExpandCommandVariables(&CurrentLine->LineContents, '%', TRUE, YsExpandArgumentVariables, Script->ArgContext, &LineWithArgumentsExpanded)) {
-                break;
-            }
-
-            //
-            //  Lines are intentionally left with NULLs inside the string, so
-            //  we'd normally truncate these here.  When an incomplete command
-            //  expansion is used though, the NULL ends up in the variable name
-            //  so it can get truncated.  YoriLibExpandCommandVariables
-            //  also adds one, but it's not within the string, so check which
-            //  case we're in.
-            //
+            if (CurrentLine->ContainsVariables) {
+                if (!YoriLibExpandCommandVariables(&CurrentLine->LineContents, '%', TRUE, YsExpandArgumentVariables, Script->ArgContext, &LineWithArgumentsExpanded)) {
+                    break;
+                }
 
-            if (LineWithArgumentsExpanded.LengthInChars > 0 &&
-                LineWithArgumentsExpanded.StartOfString[LineWithArgumentsExpanded.LengthInChars - 1] == '\0') {
-                LineWithArgumentsExpanded.LengthInChars--;
+                //
+                //  Lines are intentionally left with NULLs inside the string,
+                //  so we'd normally truncate these here.  When an incomplete
+                //  command expansion is used though, the NULL ends up in the
+                //  variable name so it can get truncated.
+                //  YoriLibExpandCommandVariables also adds one, but it's not
+                //  within the string, so check which case we're in.
+                //
+
+                if (LineWithArgumentsExpanded.LengthInChars > 0 &&
+                    LineWithArgumentsExpanded.StartOfString[LineWithArgumentsExpanded.LengthInChars - 1] == '\0') {
+                    LineWithArgumentsExpanded.LengthInChars--;
+                }
+                Expression = &LineWithArgumentsExpanded;
+            } else {
+
+                //
+                //  If the line has no variables to expand, execute it
+                //  directly without copying it.  The line's NULL terminator
+                //  is not part of the expression.
+                //
+
+                YoriLibInitEmptyString(&LineWithoutVariables);
+                LineWithoutVariables.StartOfString = CurrentLine->LineContents.StartOfString;
+                LineWithoutVariables.LengthInChars = CurrentLine->LineContents.LengthInChars - 1;
+                LineWithoutVariables.LengthAllocated = CurrentLine->LineContents.LengthInChars;
+                Expression = &LineWithoutVariables;
             }
-            ASSERT(LineWithArgumentsExpanded.StartOfString[LineWithArgumentsExpanded.LengthInChars] == '\0');
+            ASSERT(Expression->StartOfString[Expression->LengthInChars] == '\0');
 
-            YoriCallExecuteExpression(&LineWithArgumentsExpanded);
+            YoriCallExecuteExpression(Expression);
             ASSERT(YsActiveScript == Script);
 
             if (YoriCallIsProcessExiting()) {
@@ -1150,7 +1325,7 @@ YsExecuteScript(
             }
         }
 
-        NextEntry = YoriLibGetNextListEntry(&Script->LineLinks, &Script->ActiveLine->LineLinks);
+        LineIndex = Script->ActiveLine->LineIndex + 1;
     }
 
     YsActiveScript = PreviouslyActiveScript;
@@ -1186,10 +1361,24 @@ YsFreeScript(
         CurrentLine = CONTAINING_RECORD(NextEntry, YS_SCRIPT_LINE, LineLinks);
         NextEntry = YoriLibGetNextListEntry(&Script->LineLinks, NextEntry);
 
+        if (CurrentLine->LabelIndexed) {
+            YoriLibHashRemoveByEntry(&CurrentLine->LabelEntry);
+        }
         YoriLibFreeStringContents(&CurrentLine->LineContents);
         YoriLibFree(CurrentLine);
     }
 
+    if (Script->Lines != NULL) {
+        YoriLibFree(Script->Lines);
+        Script->Lines = NULL;
+    }
+    Script->LineCount = 0;
+
+    if (Script->Labels != NULL) {
+        YoriLibFreeEmptyHashTable(Script->Labels);
+        Script->Labels = NULL;
+    }
+
     CallStackFound = FALSE;
 
     NextEntry = YoriLibGetNextListEntry(&Script->CallStackLinks, NULL);
@@ -1225,9 +1414,15 @@ YsLoadScript(
 
     YoriLibInitializeListHead(&Script->LineLinks);
     YoriLibInitializeListHead(&Script->CallStackLinks);
+    YoriLibInitEmptyString(&Script->FileName);
+    Script->Lines = NULL;
+    Script->LineCount = 0;
+    Script->Labels = NULL;
 
     if (!YsLoadLines(Handle, &Script->LineLinks)) {
         Result = FALSE;
+    } else if (!YsCompileScript(Script)) {
+        Result = FALSE;
     }
 
     if (Result == FALSE) {
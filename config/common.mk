@@ -106,17 +106,20 @@ FDILIB=fdi.lib
 # optimization that only exists on newer compilers, so
 # skip the probe on old ones.
 #
+# Probes are commented with ymake:probe to indicate they
+# have no side effects, so ymake can run them in parallel.
+#
 
-!IF [$(CC) -GS- 2>&1 | find "D4002" >NUL]>0
+!IF [$(CC) -GS- 2>&1 | find "D4002" >NUL]>0 # ymake:probe
 CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -GS-
 CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -GF
 !IFNDEF _YMAKE_VER
-!IF [$(CC) -? 2>&1 | find "/MP" >NUL]==0
+!IF [$(CC) -? 2>&1 | find "/MP" >NUL]==0 # ymake:probe
 CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -MP
 !ENDIF
 !ENDIF
 !ELSE
-!IF [$(CC) -GF 2>&1 | find "D4002" >NUL]>0
+!IF [$(CC) -GF 2>&1 | find "D4002" >NUL]>0 # ymake:probe
 CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -GF
 !ELSE
 CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -Gf
@@ -128,7 +131,7 @@ CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -Gf
 # compilers, but not x64 compilers.
 #
 
-!IF [$(CC) -? 2>&1 | find "/Gz" >NUL]==0
+!IF [$(CC) -? 2>&1 | find "/Gz" >NUL]==0 # ymake:probe
 CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -Gz
 !ENDIF
 
@@ -136,7 +139,7 @@ CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -Gz
 # Probe for -Gs support.  This exists on x86 and x64 but not mips.
 #
 
-!IF [$(CC) -Gs9999 2>&1 |find "D4002" >NUL]>0
+!IF [$(CC) -Gs9999 2>&1 |find "D4002" >NUL]>0 # ymake:probe
 CFLAGS_NOUNICODE=$(CFLAGS_NOUNICODE) -Gs9999
 !ENDIF
 
@@ -155,9 +158,9 @@ CFLAGS=$(CFLAGS_NOUNICODE) -DUNICODE -D_UNICODE
 # with a pragma, so yet another probe
 #
 
-!IF [$(LINK) -OPT:ICF 2>&1 | find "ICF" >NUL]>0
+!IF [$(LINK) -OPT:ICF 2>&1 | find "ICF" >NUL]>0 # ymake:probe
 LDFLAGS_CORE=$(LDFLAGS_CORE) -OPT:ICF
-!IF [$(LINK) -OPT:NOWIN98 2>&1 | find "NOWIN98" >NUL]>0
+!IF [$(LINK) -OPT:NOWIN98 2>&1 | find "NOWIN98" >NUL]>0 # ymake:probe
 LDFLAGS_CORE=$(LDFLAGS_CORE) -OPT:NOWIN98
 !ENDIF
 !ENDIF
@@ -168,61 +171,61 @@ LDFLAGS_CORE=$(LDFLAGS_CORE) -OPT:NOWIN98
 # not fatal, the linker will figure it out in the end.
 #
 MINOS=310
-!IF [$(CC) --version 2>&1 | find "002 :" >NUL]==0 # MSVC or Clang
-!IF [$(CC) 2>&1 | find "x86" >NUL]==0
-!IF [$(CC) 2>&1 | find "80x86" >NUL]==0
+!IF [$(CC) --version 2>&1 | find "002 :" >NUL]==0 # MSVC or Clang, ymake:probe
+!IF [$(CC) 2>&1 | find "x86" >NUL]==0 # ymake:probe
+!IF [$(CC) 2>&1 | find "80x86" >NUL]==0 # ymake:probe
 MACHINE=IX86
 !ELSE
 MACHINE=X86
 !ENDIF # 80x86
 ARCH=win32
 !ELSE
-!IF [$(CC) 2>&1 | find "x64" >NUL]==0
+!IF [$(CC) 2>&1 | find "x64" >NUL]==0 # ymake:probe
 MACHINE=X64
 MINOS=520
 ARCH=amd64
 !ELSE
-!IF [$(CC) 2>&1 | find "AMD64" >NUL]==0
+!IF [$(CC) 2>&1 | find "AMD64" >NUL]==0 # ymake:probe
 MACHINE=AMD64
 MINOS=520
 ARCH=amd64
 !ELSE
-!IF [$(CC) 2>&1 | find "ARM64" >NUL]==0
+!IF [$(CC) 2>&1 | find "ARM64" >NUL]==0 # ymake:probe
 MACHINE=ARM64
 MINOS=1000
 ARCH=arm64
 !ELSE
-!IF [$(CC) 2>&1 | find "Itanium" >NUL]==0
+!IF [$(CC) 2>&1 | find "Itanium" >NUL]==0 # ymake:probe
 MACHINE=IA64
 MINOS=520
 ARCH=ia64
 !ELSE
-!IF [$(CC) 2>&1 | find "IA-64" >NUL]==0
+!IF [$(CC) 2>&1 | find "IA-64" >NUL]==0 # ymake:probe
 MACHINE=IA64
 MINOS=520
 ARCH=ia64
 !ELSE
-!IF [$(CC) 2>&1 | find "ARM" >NUL]==0
+!IF [$(CC) 2>&1 | find "ARM" >NUL]==0 # ymake:probe
 MACHINE=ARM
 # Add back msvcrt to provide 64 bit math assembly
 EXTERNLIBS=$(EXTERNLIBS) msvcrt.lib libvcruntime.lib
 MINOS=800
 ARCH=arm
 !ELSE
-!IF [$(CC) 2>&1 | find "MIPS" >NUL]==0
+!IF [$(CC) 2>&1 | find "MIPS" >NUL]==0 # ymake:probe
 MACHINE=MIPS
 # Add back msvcrt to provide 64 bit math assembly
 EXTERNLIBS=$(EXTERNLIBS) msvcrt.lib
 ARCH=mips
 !ELSE
-!IF [$(CC) 2>&1 | find "PowerPC" >NUL]==0
+!IF [$(CC) 2>&1 | find "PowerPC" >NUL]==0 # ymake:probe
 MACHINE=PPC
 # Add back msvcrt to provide 64 bit math assembly
 EXTERNLIBS=$(EXTERNLIBS) msvcrt.lib
 ARCH=ppc
 !ELSE
-!IF [$(CC) 2>&1 | find "Alpha" >NUL]==0
-!IF [$(CC) 2>&1 | find "13.00" >NUL]==0
+!IF [$(CC) 2>&1 | find "Alpha" >NUL]==0 # ymake:probe
+!IF [$(CC) 2>&1 | find "13.00" >NUL]==0 # ymake:probe
 MACHINE=ALPHA64
 ARCH=axp64
 MINOS=500
@@ -246,16 +249,16 @@ ARCH=axp
 !ENDIF # x64
 !ENDIF # x86
 !ELSE  # MSVC/Clang, clang is below
-!IF [$(CC) --version 2>&1 | find "x86-64-windows" >NUL]==0
+!IF [$(CC) --version 2>&1 | find "x86-64-windows" >NUL]==0 # ymake:probe
 MACHINE=X64
 MINOS=520
 ARCH=amd64
 !ELSE
-!IF [$(CC) --version 2>&1 | find "x86-pc-windows" >NUL]==0
+!IF [$(CC) --version 2>&1 | find "x86-pc-windows" >NUL]==0 # ymake:probe
 MACHINE=X86
 ARCH=win32
 !ELSE
-!IF [$(CC) --version 2>&1 | find "aarch64-pc-windows" >NUL]==0
+!IF [$(CC) --version 2>&1 | find "aarch64-pc-windows" >NUL]==0 # ymake:probe
 MACHINE=ARM64
 MINOS=1000
 ARCH=arm64
@@ -288,9 +291,9 @@ SUBSYSVER=
 # 32 bit builds need to probe 5.0 and lower.  64 bit builds can jump
 # straight to 5.2 which is the oldest 64 bit OS.
 !IF $(MINOS)<520
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.0 2>&1 | find "LNK4010" >NUL]>0
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,4.0 2>&1 | find "LNK4010" >NUL]>0
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,3.10 2>&1 | find "LNK4010" >NUL]>0
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.0 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,4.0 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,3.10 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
 SUBSYSVER=,3.10
 !ELSE  # !3.10
 SUBSYSVER=,4.0
@@ -299,23 +302,23 @@ SUBSYSVER=,4.0
 SUBSYSVER=,5.0
 !ENDIF # 4.0
 !ELSE  # !5.0
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.2 2>&1 | find "LNK4010" >NUL]>0
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.1 2>&1 | find "LNK4010" >NUL]>0
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.2 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.1 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
 SUBSYSVER=,5.1
 !ELSE  # !5.1
 SUBSYSVER=,5.2
 !ENDIF # 5.1
 !ELSE  # !5.2
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,6.0 2>&1 | find "LNK4010" >NUL]>0
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,6.0 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
 SUBSYSVER=,6.0
 !ENDIF # 6.0
 !ENDIF # 5.2
 !ENDIF # 5.0
 !ELSE  # MINOS<520 aka 64 bit build
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.2 2>&1 | find "LNK4010" >NUL]>0
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,5.2 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
 SUBSYSVER=,5.2
 !ELSE  # !5.2
-!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,6.0 2>&1 | find "LNK4010" >NUL]>0
+!IF [$(LINK) $(LDFLAGS_CORE) -SUBSYSTEM:CONSOLE,6.0 2>&1 | find "LNK4010" >NUL]>0 # ymake:probe
 SUBSYSVER=,6.0
 !ENDIF # 6.0
 !ENDIF # 5.2
@@ -336,21 +339,21 @@ RMDIR=rmdir
 # - No recursive mkdir
 
 !IFNDEF _YMAKE_VER
-!IF [oneyori.exe -c for -? >NUL 2>&1]==0
+!IF [oneyori.exe -c for -? >NUL 2>&1]==0 # ymake:probe
 FOR=oneyori -c for -c
 MKDIR=oneyori -c ymkdir
 RMDIR=oneyori -c yrmdir
 !ELSE
 
-!IF [yfor.exe -? >NUL 2>&1]==0
+!IF [yfor.exe -? >NUL 2>&1]==0 # ymake:probe
 FOR=yfor -c
 !ENDIF
 
-!IF [ymkdir.exe -? >NUL 2>&1]==0
+!IF [ymkdir.exe -? >NUL 2>&1]==0 # ymake:probe
 MKDIR=ymkdir
 !ENDIF
 
-!IF [yrmdir.exe -? >NUL 2>&1]==0
+!IF [yrmdir.exe -? >NUL 2>&1]==0 # ymake:probe
 RMDIR=yrmdir
 !ENDIF
 !ENDIF
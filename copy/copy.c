@@ -50,7 +50,7 @@ CHAR strCopyHelpText[] =
         "   -p             Preserve existing files, no overwriting\n"
         "   -s             Copy subdirectories as well as files\n"
         "   -t             Copy timestamps only, no data\n"
-        "   -v             Verbose output\n"
+        "   -v             Verbose output, including total throughput\n"
         "   -x             Exclude files matching specified pattern\n";
 
 /**
@@ -84,6 +84,72 @@ typedef struct _COPY_EXCLUDE_ITEM {
     YORI_STRING ExcludeCriteria;
 } COPY_EXCLUDE_ITEM, *PCOPY_EXCLUDE_ITEM;
 
+/**
+ The maximum number of threads that can copy files concurrently.
+ */
+#define COPY_MAX_WORKERS 16
+
+/**
+ The size of each buffer used when moving data without CopyFile.  Two of
+ these are used so that reading from the source can proceed while the
+ previous buffer is being written to the target.
+ */
+#define COPY_DATA_BUFFER_SIZE (4 * 1024 * 1024)
+
+/**
+ The smallest buffer size to use when moving data without CopyFile, if
+ the desired size cannot be allocated.
+ */
+#define COPY_DATA_BUFFER_MIN_SIZE (64 * 1024)
+
+/**
+ The number of buffers used when moving data without CopyFile.
+ */
+#define COPY_DATA_BUFFER_COUNT 2
+
+/**
+ Files at least this large are copied without using the system cache.
+ Data this large is unlikely to be read again soon, and moving it through
+ the cache evicts data that is more useful.
+ */
+#define COPY_UNBUFFERED_THRESHOLD (256 * 1024 * 1024)
+
+/**
+ A file which has been found by enumeration and is waiting to be copied by
+ a worker thread.
+ */
+typedef struct _COPY_PENDING_FILE {
+
+    /**
+     The entry for this file on the list of files waiting to be copied.
+     */
+    YORI_LIST_ENTRY PendingList;
+
+    /**
+     The fully qualified path to the source file.  The string contents are
+     allocated as part of this structure.
+     */
+    YORI_STRING SourceFile;
+
+    /**
+     The fully qualified path to the destination file.  The string contents
+     are allocated as part of this structure.
+     */
+    YORI_STRING DestFile;
+
+    /**
+     The entry for this file in the table of destinations being copied by
+     worker threads.  The key refers to DestFile.
+     */
+    YORI_HASH_ENTRY DestEntry;
+
+    /**
+     Information about the source file from enumeration.  This is used to
+     determine the size of the file and to apply timestamps after the copy.
+     */
+    WIN32_FIND_DATA FindData;
+} COPY_PENDING_FILE, *PCOPY_PENDING_FILE;
+
 /**
  A context passed between each source file match when copying multiple
  files.
@@ -104,6 +170,72 @@ typedef struct _COPY_CONTEXT {
      */
     YORILIB_COMPRESS_CONTEXT CompressContext;
 
+    /**
+     A list of files waiting to be copied by worker threads.
+     */
+    YORI_LIST_ENTRY PendingList;
+
+    /**
+     A mutex to synchronize the list of files waiting to be copied and the
+     count of bytes copied.  If this is NULL, all files are copied on the
+     main thread.
+     */
+    HANDLE Mutex;
+
+    /**
+     An event signalled when more files have been queued to worker threads.
+     */
+    HANDLE WorkerWaitEvent;
+
+    /**
+     An event signalled when a worker thread has finished copying a file.
+     */
+    HANDLE WorkerCompleteEvent;
+
+    /**
+     A table of destination files that are queued to or being copied by
+     worker threads.  Multiple sources can have the same destination, for
+     example if two sources with the same file name are copied into one
+     directory, and these must be copied in order rather than concurrently.
+     */
+    PYORI_HASH_TABLE DestTable;
+
+    /**
+     An event signalled when worker threads should terminate once the list
+     of files waiting to be copied has been drained.
+     */
+    HANDLE WorkerShutdownEvent;
+
+    /**
+     Handles to the worker threads that have been created.
+     */
+    HANDLE Threads[COPY_MAX_WORKERS];
+
+    /**
+     The maximum number of worker threads to create.
+     */
+    DWORD MaxThreads;
+
+    /**
+     The number of worker threads that have been created.
+     */
+    DWORD ThreadsAllocated;
+
+    /**
+     The number of files waiting to be copied by worker threads.
+     */
+    DWORD ItemsQueued;
+
+    /**
+     The total number of bytes of file data copied.
+     */
+    LONGLONG BytesCopied;
+
+    /**
+     The system time when copying started, used to report throughput.
+     */
+    LONGLONG StartTime;
+
     /**
      The number of bytes to copy when copying to or from a device.  Zero
      means copy until the end of the device.
@@ -553,12 +685,167 @@ CopyAsLink(
     return TRUE;
 }
 
+/**
+ Add to the count of bytes copied.  This can be called from worker threads
+ or the main thread.
+
+ @param CopyContext Pointer to the copy context.
+
+ @param BytesCopied The number of bytes to add.
+ */
+VOID
+CopyAddBytesCopied(
+    __in PCOPY_CONTEXT CopyContext,
+    __in LONGLONG BytesCopied
+    )
+{
+    if (CopyContext->Mutex != NULL) {
+        WaitForSingleObject(CopyContext->Mutex, INFINITE);
+        CopyContext->BytesCopied = CopyContext->BytesCopied + BytesCopied;
+        ReleaseMutex(CopyContext->Mutex);
+    } else {
+        CopyContext->BytesCopied = CopyContext->BytesCopied + BytesCopied;
+    }
+}
+
+/**
+ A single buffer used to move data from the reading thread to the writing
+ thread when copying without CopyFile.
+ */
+typedef struct _COPY_DATA_MOVE_BUFFER {
+
+    /**
+     Pointer to the data in the buffer.
+     */
+    PUCHAR Data;
+
+    /**
+     The number of bytes of valid data in the buffer.
+     */
+    DWORD BytesValid;
+
+    /**
+     TRUE if the reader has reached the end of the source, in which case
+     this buffer contains no data.
+     */
+    BOOLEAN EndOfData;
+} COPY_DATA_MOVE_BUFFER, *PCOPY_DATA_MOVE_BUFFER;
+
+/**
+ State shared between the reading thread and the writing thread when copying
+ without CopyFile.
+ */
+typedef struct _COPY_DATA_MOVE {
+
+    /**
+     Handle to the source, read by the reading thread.
+     */
+    HANDLE SourceHandle;
+
+    /**
+     The number of bytes to copy, or zero to copy until the end of the
+     source.
+     */
+    LONGLONG DeviceSize;
+
+    /**
+     The size of each buffer, in bytes.
+     */
+    DWORD BufferSize;
+
+    /**
+     A semaphore counting the buffers that are available for the reading
+     thread to fill.
+     */
+    HANDLE EmptySemaphore;
+
+    /**
+     A semaphore counting the buffers that have been filled and are waiting
+     to be written.
+     */
+    HANDLE FullSemaphore;
+
+    /**
+     Set to TRUE by the writing thread if a write has failed, indicating the
+     reading thread should stop reading.
+     */
+    BOOLEAN WriteFailed;
+
+    /**
+     The buffers used to move data.  These are used in order by both the
+     reading thread and the writing thread.
+     */
+    COPY_DATA_MOVE_BUFFER Buffers[COPY_DATA_BUFFER_COUNT];
+} COPY_DATA_MOVE, *PCOPY_DATA_MOVE;
+
+/**
+ A background thread which reads from the source into each buffer in turn,
+ and hands the buffer to the writing thread.  When the source is exhausted
+ or the writing thread has failed, a buffer indicating end of data is
+ handed to the writing thread and this thread terminates.
+
+ @param Context Pointer to the data move state.
+
+ @return Zero.
+ */
+DWORD WINAPI
+CopyDataMoveReader(
+    __in LPVOID Context
+    )
+{
+    PCOPY_DATA_MOVE DataMove = (PCOPY_DATA_MOVE)Context;
+    PCOPY_DATA_MOVE_BUFFER Buffer;
+    LONGLONG TotalBytesRead;
+    DWORD BytesRead;
+    DWORD Index;
+
+    Index = 0;
+    TotalBytesRead = 0;
+
+    while (TRUE) {
+        WaitForSingleObject(DataMove->EmptySemaphore, INFINITE);
+        Buffer = &DataMove->Buffers[Index];
+        Index = (Index + 1) % COPY_DATA_BUFFER_COUNT;
+
+        Buffer->BytesValid = 0;
+        Buffer->EndOfData = TRUE;
+
+        if (!DataMove->WriteFailed &&
+            (DataMove->DeviceSize == 0 || TotalBytesRead < DataMove->DeviceSize) &&
+            ReadFile(DataMove->SourceHandle, Buffer->Data, DataMove->BufferSize, &BytesRead, NULL) &&
+            BytesRead > 0) {
+
+            if (DataMove->DeviceSize != 0 &&
+                (TotalBytesRead + BytesRead) > DataMove->DeviceSize) {
+
+                BytesRead = (DWORD)(DataMove->DeviceSize - TotalBytesRead);
+            }
+
+            TotalBytesRead = TotalBytesRead + BytesRead;
+            Buffer->BytesValid = BytesRead;
+            Buffer->EndOfData = FALSE;
+        }
+
+        ReleaseSemaphore(DataMove->FullSemaphore, 1, NULL);
+
+        if (Buffer->EndOfData) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
 /**
  For objects that are not really files, copy can't use CopyFile, and instead
  falls back to this stupid thing of reading and writing.  Note this path
  should not be used for files since it makes no attempt to preserve any kind
  of file metadata, but for devices file metadata is meaningless anyway.
 
+ Reads are performed on a background thread into one buffer while the
+ previous buffer is written on this thread, so the source and target can
+ both be kept busy.
+
  @param CopyContext Pointer to the copy context, specifying device size.
 
  @param SourceFile Pointer to the source file/device name.
@@ -574,22 +861,26 @@ CopyAsDumbDataMove(
     __in PYORI_STRING DestFile
     )
 {
-    PVOID Buffer;
+    COPY_DATA_MOVE DataMove;
+    PCOPY_DATA_MOVE_BUFFER Buffer;
     DWORD BytesCopied;
-    DWORD BufferSize;
     DWORD SectorSize;
+    DWORD Index;
+    DWORD ThreadId;
     HANDLE SourceHandle;
     HANDLE DestHandle;
+    HANDLE ReaderThread;
     SYSERR LastError;
     LPTSTR ErrText;
     LONGLONG TotalBytesCopied;
+    BOOL Result;
 
     SourceHandle = CreateFile(SourceFile->StartOfString,
                               GENERIC_READ,
                               FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE,
                               NULL,
                               OPEN_EXISTING,
-                              FILE_FLAG_OPEN_NO_RECALL|FILE_FLAG_BACKUP_SEMANTICS,
+                              FILE_FLAG_OPEN_NO_RECALL|FILE_FLAG_BACKUP_SEMANTICS|FILE_FLAG_SEQUENTIAL_SCAN,
                               NULL);
 
     if (SourceHandle == INVALID_HANDLE_VALUE) {
@@ -630,79 +921,130 @@ CopyAsDumbDataMove(
 
     SectorSize = YoriLibGetHandleSectorSize(DestHandle);
 
-    BufferSize = 64 * 1024;
-    if (!YoriLibIsSizeAllocatable(BufferSize)) {
-        BufferSize = 32 * 1024;
+    ZeroMemory(&DataMove, sizeof(DataMove));
+    DataMove.SourceHandle = SourceHandle;
+    DataMove.DeviceSize = CopyContext->DeviceSize.QuadPart;
+    DataMove.BufferSize = YoriLibMaximumAllocationInRange(COPY_DATA_BUFFER_MIN_SIZE * COPY_DATA_BUFFER_COUNT, COPY_DATA_BUFFER_SIZE * COPY_DATA_BUFFER_COUNT);
+    DataMove.BufferSize = DataMove.BufferSize / COPY_DATA_BUFFER_COUNT;
+    DataMove.BufferSize = DataMove.BufferSize & ~(COPY_DATA_BUFFER_MIN_SIZE - 1);
+
+    Result = FALSE;
+    ReaderThread = NULL;
+
+    if (DataMove.BufferSize == 0) {
+        goto Exit;
     }
-    Buffer = YoriLibMalloc((YORI_ALLOC_SIZE_T)BufferSize);
-    if (Buffer == NULL) {
-        CloseHandle(SourceHandle);
-        CloseHandle(DestHandle);
-        return FALSE;
+
+    DataMove.Buffers[0].Data = YoriLibMalloc((YORI_ALLOC_SIZE_T)(DataMove.BufferSize * COPY_DATA_BUFFER_COUNT));
+    if (DataMove.Buffers[0].Data == NULL) {
+        goto Exit;
     }
 
-    if (SectorSize > BufferSize) {
-        SectorSize = BufferSize;
+    for (Index = 1; Index < COPY_DATA_BUFFER_COUNT; Index++) {
+        DataMove.Buffers[Index].Data = DataMove.Buffers[Index - 1].Data + DataMove.BufferSize;
     }
 
-    TotalBytesCopied = 0;
+    if (SectorSize > DataMove.BufferSize) {
+        SectorSize = DataMove.BufferSize;
+    }
 
-    while (ReadFile(SourceHandle, Buffer, BufferSize, &BytesCopied, NULL)) {
-        if (BytesCopied == 0) {
-            break;
-        }
+    DataMove.EmptySemaphore = CreateSemaphore(NULL, COPY_DATA_BUFFER_COUNT, COPY_DATA_BUFFER_COUNT, NULL);
+    if (DataMove.EmptySemaphore == NULL) {
+        goto Exit;
+    }
 
-        if (CopyContext->DeviceSize.QuadPart != 0 &&
-            (TotalBytesCopied + BytesCopied) > CopyContext->DeviceSize.QuadPart) {
+    DataMove.FullSemaphore = CreateSemaphore(NULL, 0, COPY_DATA_BUFFER_COUNT, NULL);
+    if (DataMove.FullSemaphore == NULL) {
+        goto Exit;
+    }
 
-            BytesCopied = (DWORD)(CopyContext->DeviceSize.QuadPart - TotalBytesCopied);
+    ReaderThread = CreateThread(NULL, 0, CopyDataMoveReader, &DataMove, 0, &ThreadId);
+    if (ReaderThread == NULL) {
+        LastError = GetLastError();
+        ErrText = YoriLibGetWinErrorText(LastError);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Could not create reader thread: %y: %s"), SourceFile, ErrText);
+        YoriLibFreeWinErrorText(ErrText);
+        goto Exit;
+    }
 
+    TotalBytesCopied = 0;
+    Index = 0;
+    Result = TRUE;
+
+    while (TRUE) {
+        WaitForSingleObject(DataMove.FullSemaphore, INFINITE);
+        Buffer = &DataMove.Buffers[Index];
+        Index = (Index + 1) % COPY_DATA_BUFFER_COUNT;
+
+        if (Buffer->EndOfData) {
+            break;
         }
 
         //
-        //  If the destination has a sector size requirement, round up to the
-        //  next whole sector
+        //  If a previous write failed, the reader may have already filled
+        //  this buffer.  Hand it back without writing so the reader can
+        //  observe the failure and terminate.
         //
 
-        if (SectorSize != 0 &&
-            (BytesCopied % SectorSize) != 0) {
+        if (!DataMove.WriteFailed) {
+            BytesCopied = Buffer->BytesValid;
 
-            DWORD SectorOffset;
-            DWORD SectorRemaining;
-            DWORD BufferOffset;
+            //
+            //  If the destination has a sector size requirement, round up to
+            //  the next whole sector
+            //
 
-            SectorOffset = BytesCopied % SectorSize;
-            SectorRemaining = SectorSize - SectorOffset;
+            if (SectorSize != 0 &&
+                (BytesCopied % SectorSize) != 0) {
 
-            BufferOffset = (BytesCopied / SectorSize) * SectorSize + SectorOffset;
+                DWORD SectorOffset;
+                DWORD SectorRemaining;
+                DWORD BufferOffset;
 
-            ZeroMemory(YoriLibAddToPointer(Buffer, BufferOffset), SectorRemaining);
-            BytesCopied = BytesCopied + SectorRemaining;
-        }
+                SectorOffset = BytesCopied % SectorSize;
+                SectorRemaining = SectorSize - SectorOffset;
 
-        if (!WriteFile(DestHandle, Buffer, BytesCopied, &BytesCopied, NULL)) {
-            LastError = GetLastError();
-            ErrText = YoriLibGetWinErrorText(LastError);
-            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Write to destination failed: %y: %s"), DestFile, ErrText);
-            YoriLibFreeWinErrorText(ErrText);
-            YoriLibFree(Buffer);
-            CloseHandle(SourceHandle);
-            CloseHandle(DestHandle);
-            return FALSE;
-        }
+                BufferOffset = (BytesCopied / SectorSize) * SectorSize + SectorOffset;
 
-        TotalBytesCopied = TotalBytesCopied + BytesCopied;
-        if (CopyContext->DeviceSize.QuadPart != 0 &&
-            TotalBytesCopied >= CopyContext->DeviceSize.QuadPart) {
+                ZeroMemory(YoriLibAddToPointer(Buffer->Data, BufferOffset), SectorRemaining);
+                BytesCopied = BytesCopied + SectorRemaining;
+            }
 
-            break;
+            if (!WriteFile(DestHandle, Buffer->Data, BytesCopied, &BytesCopied, NULL)) {
+                LastError = GetLastError();
+                ErrText = YoriLibGetWinErrorText(LastError);
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Write to destination failed: %y: %s"), DestFile, ErrText);
+                YoriLibFreeWinErrorText(ErrText);
+                DataMove.WriteFailed = TRUE;
+                Result = FALSE;
+            } else {
+                TotalBytesCopied = TotalBytesCopied + BytesCopied;
+            }
         }
+
+        ReleaseSemaphore(DataMove.EmptySemaphore, 1, NULL);
     }
 
-    YoriLibFree(Buffer);
+    WaitForSingleObject(ReaderThread, INFINITE);
+    CopyAddBytesCopied(CopyContext, TotalBytesCopied);
+
+Exit:
+
+    if (ReaderThread != NULL) {
+        CloseHandle(ReaderThread);
+    }
+    if (DataMove.FullSemaphore != NULL) {
+        CloseHandle(DataMove.FullSemaphore);
+    }
+    if (DataMove.EmptySemaphore != NULL) {
+        CloseHandle(DataMove.EmptySemaphore);
+    }
+    if (DataMove.Buffers[0].Data != NULL) {
+        YoriLibFree(DataMove.Buffers[0].Data);
+    }
     CloseHandle(SourceHandle);
     CloseHandle(DestHandle);
-    return TRUE;
+    return Result;
 }
 
 /**
@@ -748,6 +1090,427 @@ CopyTimestamps(
     return TRUE;
 }
 
+/**
+ Copy a regular file from the source to the target, preserving its metadata.
+ Large files are copied without using the system cache.  This can be called
+ on worker threads, or on the main thread if the file cannot be handed to a
+ worker thread.
+
+ @param CopyContext Pointer to the copy context.
+
+ @param SourceFile Pointer to the fully qualified source file name.
+
+ @param DestFile Pointer to the fully qualified destination file name.
+
+ @param SourceFindData Optionally points to information about the source
+        from enumeration, used to determine the size of the file.
+
+ @return TRUE to indicate success, FALSE to indicate failure.  Note this
+         function can display errors to the console.
+ */
+BOOL
+CopyRegularFile(
+    __in PCOPY_CONTEXT CopyContext,
+    __in PYORI_STRING SourceFile,
+    __in PYORI_STRING DestFile,
+    __in_opt PWIN32_FIND_DATA SourceFindData
+    )
+{
+    YORI_STRING HumanSourcePath;
+    YORI_STRING HumanDestPath;
+    PYORI_STRING SourceNameToDisplay;
+    PYORI_STRING DestNameToDisplay;
+    LARGE_INTEGER FileSize;
+    DWORD CopyFlags;
+    SYSERR LastError;
+    LPTSTR ErrText;
+    BOOL Result;
+
+    FileSize.QuadPart = 0;
+    CopyFlags = 0;
+    if (SourceFindData != NULL) {
+        FileSize.HighPart = SourceFindData->nFileSizeHigh;
+        FileSize.LowPart = SourceFindData->nFileSizeLow;
+        if (FileSize.QuadPart >= COPY_UNBUFFERED_THRESHOLD) {
+            CopyFlags = COPY_FILE_NO_BUFFERING;
+        }
+    }
+
+    Result = TRUE;
+    LastError = YoriLibCopyFileWithFlags(SourceFile, DestFile, CopyFlags);
+    if (LastError == ERROR_SUCCESS) {
+        CopyAddBytesCopied(CopyContext, FileSize.QuadPart);
+    } else if (LastError == ERROR_INVALID_PARAMETER) {
+
+        //
+        //  If it failed with an error indicating CopyFile couldn't
+        //  handle it, fall back to dumb data copy.  Note that this
+        //  function will output its own errors, so from this point,
+        //  error handling is over.
+        //
+
+        Result = CopyAsDumbDataMove(CopyContext, SourceFile, DestFile);
+    } else {
+        YoriLibInitEmptyString(&HumanSourcePath);
+        YoriLibInitEmptyString(&HumanDestPath);
+        SourceNameToDisplay = SourceFile;
+        DestNameToDisplay = DestFile;
+        if (YoriLibUnescapePath(SourceFile, &HumanSourcePath)) {
+            SourceNameToDisplay = &HumanSourcePath;
+        }
+        if (YoriLibUnescapePath(DestFile, &HumanDestPath)) {
+            DestNameToDisplay = &HumanDestPath;
+        }
+        ErrText = YoriLibGetWinErrorText(LastError);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("CopyFile failed: %y to %y: %s"), SourceNameToDisplay, DestNameToDisplay, ErrText);
+        YoriLibFreeWinErrorText(ErrText);
+        YoriLibFreeStringContents(&HumanSourcePath);
+        YoriLibFreeStringContents(&HumanDestPath);
+        Result = FALSE;
+    }
+
+    if (CopyContext->CompressDest) {
+
+        YoriLibCompressFileInBackground(&CopyContext->CompressContext, DestFile);
+    }
+
+    return Result;
+}
+
+/**
+ A background thread which will copy any files that it finds on the list of
+ files waiting to be copied.
+
+ @param Context Pointer to the copy context.
+
+ @return TRUE to indicate success, FALSE to indicate one or more copy
+         operations failed.
+ */
+DWORD WINAPI
+CopyWorker(
+    __in LPVOID Context
+    )
+{
+    PCOPY_CONTEXT CopyContext = (PCOPY_CONTEXT)Context;
+    PCOPY_PENDING_FILE PendingFile;
+    DWORD FoundEvent;
+    BOOL Result = TRUE;
+
+    while (TRUE) {
+
+        //
+        //  Wait for an indication of more work or shutdown.
+        //
+
+        FoundEvent = WaitForMultipleObjectsEx(2, &CopyContext->WorkerWaitEvent, FALSE, INFINITE, FALSE);
+
+        //
+        //  Process any queued work.
+        //
+
+        while (TRUE) {
+            WaitForSingleObject(CopyContext->Mutex, INFINITE);
+            if (!YoriLibIsListEmpty(&CopyContext->PendingList)) {
+                PendingFile = CONTAINING_RECORD(CopyContext->PendingList.Next, COPY_PENDING_FILE, PendingList);
+                ASSERT(CopyContext->ItemsQueued > 0);
+                CopyContext->ItemsQueued--;
+                YoriLibRemoveListItem(&PendingFile->PendingList);
+                ReleaseMutex(CopyContext->Mutex);
+
+                if (!CopyRegularFile(CopyContext, &PendingFile->SourceFile, &PendingFile->DestFile, &PendingFile->FindData)) {
+                    Result = FALSE;
+                }
+
+                if (CopyContext->CopyTimestamps) {
+                    CopyTimestamps(&PendingFile->FindData, &PendingFile->DestFile);
+                }
+
+                WaitForSingleObject(CopyContext->Mutex, INFINITE);
+                YoriLibHashRemoveByEntry(&PendingFile->DestEntry);
+                ReleaseMutex(CopyContext->Mutex);
+                SetEvent(CopyContext->WorkerCompleteEvent);
+
+                YoriLibFree(PendingFile);
+
+            } else {
+                ASSERT(CopyContext->ItemsQueued == 0);
+                ReleaseMutex(CopyContext->Mutex);
+                break;
+            }
+        }
+
+        //
+        //  If shutdown was requested, terminate the thread.
+        //
+
+        if (FoundEvent == (WAIT_OBJECT_0 + 1)) {
+            break;
+        }
+    }
+
+    return Result;
+}
+
+/**
+ Prepare the copy context to copy files on worker threads.  This is only
+ done when copying files into a directory.
+
+ @param CopyContext Pointer to the copy context.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+CopyInitializeWorkers(
+    __in PCOPY_CONTEXT CopyContext
+    )
+{
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+
+    //
+    //  Copying is mostly waiting on storage rather than the CPU, so allow
+    //  more threads than CPUs so that many small files can be in flight at
+    //  once.  Threads are only created as the queue grows.
+    //
+
+    CopyContext->MaxThreads = SystemInfo.dwNumberOfProcessors * 2;
+    if (CopyContext->MaxThreads < 2) {
+        CopyContext->MaxThreads = 2;
+    }
+    if (CopyContext->MaxThreads > COPY_MAX_WORKERS) {
+        CopyContext->MaxThreads = COPY_MAX_WORKERS;
+    }
+
+    YoriLibInitializeListHead(&CopyContext->PendingList);
+    CopyContext->WorkerWaitEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (CopyContext->WorkerWaitEvent == NULL) {
+        return FALSE;
+    }
+
+    CopyContext->WorkerShutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (CopyContext->WorkerShutdownEvent == NULL) {
+        return FALSE;
+    }
+
+    CopyContext->WorkerCompleteEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (CopyContext->WorkerCompleteEvent == NULL) {
+        return FALSE;
+    }
+
+    CopyContext->DestTable = YoriLibAllocateHashTable(256);
+    if (CopyContext->DestTable == NULL) {
+        return FALSE;
+    }
+
+    CopyContext->Mutex = CreateMutex(NULL, FALSE, NULL);
+    if (CopyContext->Mutex == NULL) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Add a file to the queue of files to be copied by worker threads.  If the
+ worker threads already have an excessively large queue of work, this
+ function returns FALSE to indicate it should be copied by the main thread.
+ This prevents the main thread from continuing to pile in more files than
+ the workers can get to.
+
+ If a worker thread is already copying to the same destination, this
+ function waits for it to finish and returns FALSE, so that the main thread
+ overwrites the destination afterwards, as it would if files were copied
+ one at a time.
+
+ @param CopyContext Pointer to the copy context.
+
+ @param SourceFile Pointer to the fully qualified source file name.
+
+ @param DestFile Pointer to the fully qualified destination file name.
+
+ @param SourceFindData Pointer to information about the source from
+        enumeration.
+
+ @return TRUE if the file was queued to be copied by worker threads, or FALSE
+         if it should be copied by the main thread.
+ */
+BOOL
+CopyQueueRegularFile(
+    __in PCOPY_CONTEXT CopyContext,
+    __in PYORI_STRING SourceFile,
+    __in PYORI_STRING DestFile,
+    __in PWIN32_FIND_DATA SourceFindData
+    )
+{
+    PCOPY_PENDING_FILE PendingFile;
+    DWORD ThreadId;
+    BOOL Result = FALSE;
+
+    if (CopyContext->Mutex == NULL) {
+        return FALSE;
+    }
+
+    //
+    //  If this destination is already queued, wait for the worker to copy
+    //  it.  The main thread is the only thread queueing files, so once
+    //  this completes no worker can be using the destination.
+    //
+
+    WaitForSingleObject(CopyContext->Mutex, INFINITE);
+    if (YoriLibHashLookupByKey(CopyContext->DestTable, DestFile) != NULL) {
+        while (YoriLibHashLookupByKey(CopyContext->DestTable, DestFile) != NULL) {
+            ReleaseMutex(CopyContext->Mutex);
+            WaitForSingleObject(CopyContext->WorkerCompleteEvent, INFINITE);
+            WaitForSingleObject(CopyContext->Mutex, INFINITE);
+        }
+        ReleaseMutex(CopyContext->Mutex);
+        return FALSE;
+    }
+    ReleaseMutex(CopyContext->Mutex);
+
+    PendingFile = YoriLibMalloc(sizeof(COPY_PENDING_FILE) + (SourceFile->LengthInChars + 1 + DestFile->LengthInChars + 1) * sizeof(TCHAR));
+    if (PendingFile == NULL) {
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(&PendingFile->SourceFile);
+    PendingFile->SourceFile.StartOfString = (LPTSTR)(PendingFile + 1);
+    PendingFile->SourceFile.LengthInChars = SourceFile->LengthInChars;
+    PendingFile->SourceFile.LengthAllocated = SourceFile->LengthInChars + 1;
+    memcpy(PendingFile->SourceFile.StartOfString, SourceFile->StartOfString, SourceFile->LengthInChars * sizeof(TCHAR));
+    PendingFile->SourceFile.StartOfString[SourceFile->LengthInChars] = '\0';
+
+    YoriLibInitEmptyString(&PendingFile->DestFile);
+    PendingFile->DestFile.StartOfString = PendingFile->SourceFile.StartOfString + PendingFile->SourceFile.LengthAllocated;
+    PendingFile->DestFile.LengthInChars = DestFile->LengthInChars;
+    PendingFile->DestFile.LengthAllocated = DestFile->LengthInChars + 1;
+    memcpy(PendingFile->DestFile.StartOfString, DestFile->StartOfString, DestFile->LengthInChars * sizeof(TCHAR));
+    PendingFile->DestFile.StartOfString[DestFile->LengthInChars] = '\0';
+
+    memcpy(&PendingFile->FindData, SourceFindData, sizeof(WIN32_FIND_DATA));
+
+    WaitForSingleObject(CopyContext->Mutex, INFINITE);
+    if (CopyContext->ThreadsAllocated == 0 ||
+        (CopyContext->ItemsQueued > CopyContext->ThreadsAllocated * 2 &&
+         CopyContext->ThreadsAllocated < CopyContext->MaxThreads)) {
+
+        CopyContext->Threads[CopyContext->ThreadsAllocated] = CreateThread(NULL, 0, CopyWorker, CopyContext, 0, &ThreadId);
+        if (CopyContext->Threads[CopyContext->ThreadsAllocated] != NULL) {
+            CopyContext->ThreadsAllocated++;
+        }
+    }
+
+    if (CopyContext->ThreadsAllocated > 0 &&
+        CopyContext->ItemsQueued < CopyContext->MaxThreads * 2) {
+
+        YoriLibAppendList(&CopyContext->PendingList, &PendingFile->PendingList);
+        YoriLibHashInsertByKey(CopyContext->DestTable, &PendingFile->DestFile, PendingFile, &PendingFile->DestEntry);
+        CopyContext->ItemsQueued++;
+        PendingFile = NULL;
+        Result = TRUE;
+    }
+
+    ReleaseMutex(CopyContext->Mutex);
+
+    SetEvent(CopyContext->WorkerWaitEvent);
+
+    if (PendingFile != NULL) {
+        YoriLibFree(PendingFile);
+    }
+
+    return Result;
+}
+
+/**
+ Wait for all files queued to worker threads to be copied, and free the
+ state used to manage worker threads.  This can be called more than once.
+
+ @param CopyContext Pointer to the copy context.
+ */
+VOID
+CopyFreeWorkers(
+    __in PCOPY_CONTEXT CopyContext
+    )
+{
+    DWORD Index;
+
+    if (CopyContext->ThreadsAllocated > 0) {
+        SetEvent(CopyContext->WorkerShutdownEvent);
+        WaitForMultipleObjectsEx(CopyContext->ThreadsAllocated, CopyContext->Threads, TRUE, INFINITE, FALSE);
+        for (Index = 0; Index < CopyContext->ThreadsAllocated; Index++) {
+            CloseHandle(CopyContext->Threads[Index]);
+            CopyContext->Threads[Index] = NULL;
+        }
+        CopyContext->ThreadsAllocated = 0;
+        ASSERT(YoriLibIsListEmpty(&CopyContext->PendingList));
+    }
+    if (CopyContext->WorkerWaitEvent != NULL) {
+        CloseHandle(CopyContext->WorkerWaitEvent);
+        CopyContext->WorkerWaitEvent = NULL;
+    }
+    if (CopyContext->WorkerShutdownEvent != NULL) {
+        CloseHandle(CopyContext->WorkerShutdownEvent);
+        CopyContext->WorkerShutdownEvent = NULL;
+    }
+    if (CopyContext->WorkerCompleteEvent != NULL) {
+        CloseHandle(CopyContext->WorkerCompleteEvent);
+        CopyContext->WorkerCompleteEvent = NULL;
+    }
+    if (CopyContext->DestTable != NULL) {
+        YoriLibFreeEmptyHashTable(CopyContext->DestTable);
+        CopyContext->DestTable = NULL;
+    }
+    if (CopyContext->Mutex != NULL) {
+        CloseHandle(CopyContext->Mutex);
+        CopyContext->Mutex = NULL;
+    }
+}
+
+/**
+ Display the total amount of data copied and the rate at which it was
+ copied.
+
+ @param CopyContext Pointer to the copy context.
+ */
+VOID
+CopyDisplayThroughput(
+    __in PCOPY_CONTEXT CopyContext
+    )
+{
+    YORI_STRING CopiedString;
+    YORI_STRING RateString;
+    TCHAR CopiedStringBuffer[10];
+    TCHAR RateStringBuffer[10];
+    LARGE_INTEGER Size;
+    LONGLONG ElapsedMs;
+
+    ElapsedMs = (YoriLibGetSystemTimeAsInteger() - CopyContext->StartTime) / (10 * 1000);
+    if (ElapsedMs <= 0) {
+        ElapsedMs = 1;
+    }
+
+    YoriLibInitEmptyString(&CopiedString);
+    CopiedString.StartOfString = CopiedStringBuffer;
+    CopiedString.LengthAllocated = sizeof(CopiedStringBuffer)/sizeof(CopiedStringBuffer[0]);
+
+    YoriLibInitEmptyString(&RateString);
+    RateString.StartOfString = RateStringBuffer;
+    RateString.LengthAllocated = sizeof(RateStringBuffer)/sizeof(RateStringBuffer[0]);
+
+    Size.QuadPart = CopyContext->BytesCopied;
+    YoriLibFileSizeToString(&CopiedString, &Size);
+    Size.QuadPart = CopyContext->BytesCopied * 1000 / ElapsedMs;
+    YoriLibFileSizeToString(&RateString, &Size);
+
+    YoriLibOutput(YORI_LIB_OUTPUT_STDOUT,
+                  _T("Copied %y in %lli.%03lli seconds (%y/s)\n"),
+                  &CopiedString,
+                  ElapsedMs / 1000,
+                  ElapsedMs % 1000,
+                  &RateString);
+}
+
 /**
  A callback that is invoked when a file is found that matches a search criteria
  specified in the set of strings to enumerate.
@@ -785,6 +1548,7 @@ CopyFileFoundCallback(
     YORI_ALLOC_SIZE_T SlashesFound;
     YORI_ALLOC_SIZE_T Index;
     SYSERR LastError;
+    BOOLEAN FileQueued;
 
     CopyContext->FilesFoundThisArg++;
 
@@ -795,6 +1559,7 @@ CopyFileFoundCallback(
     YoriLibInitEmptyString(&HumanSourcePath);
     YoriLibInitEmptyString(&HumanDestPath);
     SourceNameToDisplay = FilePath;
+    FileQueued = FALSE;
 
     SlashesFound = 0;
     for (Index = FilePath->LengthInChars; Index > 0; Index--) {
@@ -881,44 +1646,21 @@ CopyFileFoundCallback(
             }
         } else if (CopyContext->DestinationIsDevice || YoriLibIsFileNameDeviceName(FilePath)) {
             CopyAsDumbDataMove(CopyContext, FilePath, &FullDest);
-        } else {
-            LastError = YoriLibCopyFile(FilePath, &FullDest);
-            if (LastError != ERROR_SUCCESS) {
-
-                //
-                //  If it failed with an error indicating CopyFile couldn't
-                //  handle it, fall back to dumb data copy.  Note that this
-                //  function will output its own errors, so from this point,
-                //  error handling is over.
-                //
-
-                if (LastError == ERROR_INVALID_PARAMETER) {
-                    CopyAsDumbDataMove(CopyContext, FilePath, &FullDest);
-                } else {
-                    LPTSTR ErrText = YoriLibGetWinErrorText(LastError);
-                    if (SourceNameToDisplay != &HumanSourcePath) {
-                        if (YoriLibUnescapePath(FilePath, &HumanSourcePath)) {
-                            SourceNameToDisplay = &HumanSourcePath;
-                        }
-                    }
-                    if (DestNameToDisplay != &HumanDestPath) {
-                        if (YoriLibUnescapePath(&FullDest, &HumanDestPath)) {
-                            DestNameToDisplay = &HumanDestPath;
-                        }
-                    }
-                    YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("CopyFile failed: %y to %y: %s"), SourceNameToDisplay, DestNameToDisplay, ErrText);
-                    YoriLibFreeWinErrorText(ErrText);
-                }
-            }
+        } else if (FileInfo != NULL &&
+                   CopyQueueRegularFile(CopyContext, FilePath, &FullDest, FileInfo)) {
 
-            if (CopyContext->CompressDest) {
+            //
+            //  The worker thread will apply timestamps once the copy is
+            //  complete.
+            //
 
-                YoriLibCompressFileInBackground(&CopyContext->CompressContext, &FullDest);
-            }
+            FileQueued = TRUE;
+        } else {
+            CopyRegularFile(CopyContext, FilePath, &FullDest, FileInfo);
         }
     }
 
-    if (CopyContext->CopyTimestamps && FileInfo != NULL) {
+    if (CopyContext->CopyTimestamps && FileInfo != NULL && !FileQueued) {
         CopyTimestamps(FileInfo, &FullDest);
     }
 
@@ -932,7 +1674,7 @@ CopyFileFoundCallback(
 /**
  Free the structures allocated within a copy context.  The structure itself
  is on the stack and is not freed.  This will wait for any outstanding
- compression work to complete.
+ copy and compression work to complete.
 
  @param CopyContext Pointer to the context to free.
  */
@@ -941,6 +1683,7 @@ CopyFreeCopyContext(
     __in PCOPY_CONTEXT CopyContext
     )
 {
+    CopyFreeWorkers(CopyContext);
     YoriLibFreeCompressContext(&CopyContext->CompressContext);
     YoriLibFreeStringContents(&CopyContext->Dest);
     CopyFreeExcludes(CopyContext);
@@ -1168,7 +1911,24 @@ ENTRYPOINT(
     YoriLibCancelEnable(FALSE);
 #endif
 
+    //
+    //  When copying into a directory, files can be copied concurrently on
+    //  worker threads.  Sources which share a destination are copied in
+    //  order.
+    //
+
+    if ((CopyContext.DestAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 &&
+        !CopyContext.SkipDataCopy &&
+        !CopyContext.DestinationIsDevice) {
+
+        if (!CopyInitializeWorkers(&CopyContext)) {
+            CopyFreeCopyContext(&CopyContext);
+            return EXIT_FAILURE;
+        }
+    }
+
     CopyContext.FilesCopied = 0;
+    CopyContext.StartTime = YoriLibGetSystemTimeAsInteger();
     FilesProcessed = 0;
 
     for (i = FirstFileArg; i <= LastFileArg; i++) {
@@ -1222,6 +1982,12 @@ ENTRYPOINT(
         }
     }
 
+    CopyFreeWorkers(&CopyContext);
+
+    if (CopyContext.Verbose && CopyContext.BytesCopied > 0) {
+        CopyDisplayThroughput(&CopyContext);
+    }
+
     Result = EXIT_SUCCESS;
 
     if (CopyContext.FilesCopied == 0) {
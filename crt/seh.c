@@ -0,0 +1,199 @@
+/**
+ * @file crt/seh.c
+ *
+ * Structured exception handling support routines.
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WIN32_LEAN_AND_MEAN
+/**
+ Standard define to include somewhat less of the Windows headers.  Command
+ line software doesn't need much.
+ */
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+
+#pragma warning(disable: 4001) /* Single line comment */
+#pragma warning(disable: 4127) // conditional expression constant
+#pragma warning(disable: 4201) // nameless struct/union
+#pragma warning(disable: 4214) // bit field type other than int
+#pragma warning(disable: 4514) // unreferenced inline function
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma warning(push)
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1500)
+#pragma warning(disable: 4668) // preprocessor conditional with nonexistent macro, SDK bug
+#pragma warning(disable: 4255) // no function prototype given.  8.1 and earlier SDKs exhibit this.
+#pragma warning(disable: 4820) // implicit padding added in structure
+#endif
+
+/**
+ Indicate support for compiling for ARM32 if an SDK is available.
+ */
+#define _ARM_WINAPI_PARTITION_DESKTOP_SDK_AVAILABLE 1
+
+#include <windows.h>
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#pragma warning(pop)
+#endif
+
+#pragma warning(disable: 4273) // inconsistent DLL linkage with excpt.h
+
+/**
+ Indicate to the standard CRT header that we're compiling the CRT itself.
+ */
+#define MINICRT_BUILD
+#include "yoricrt.h"
+
+//
+//  When the compiler sees __try/__except it registers a language specific
+//  handler that is normally provided by the CRT.  Rather than reimplement
+//  scope table walking, these forward to the copy exported by ntdll, which
+//  has carried them since the first release of NT.
+//
+
+#if defined(_M_IX86)
+
+/**
+ A prototype for the x86 language specific exception handler.
+ */
+typedef
+EXCEPTION_DISPOSITION
+__cdecl
+MCRT_EXCEPT_HANDLER3(
+    struct _EXCEPTION_RECORD *ExceptionRecord,
+    PVOID EstablisherFrame,
+    struct _CONTEXT *ContextRecord,
+    PVOID DispatcherContext
+    );
+
+/**
+ A pointer to the x86 language specific exception handler.
+ */
+typedef MCRT_EXCEPT_HANDLER3 *PMCRT_EXCEPT_HANDLER3;
+
+/**
+ The language specific exception handler referenced by __try/__except blocks
+ on x86.
+
+ @param ExceptionRecord Pointer to the exception being dispatched.
+
+ @param EstablisherFrame Pointer to the registration record of the frame
+        containing the __try block.
+
+ @param ContextRecord Pointer to the processor state at the time of the
+        exception.
+
+ @param DispatcherContext Opaque state used by the dispatcher.
+
+ @return The disposition of the exception.
+ */
+EXCEPTION_DISPOSITION
+__cdecl
+_except_handler3(
+    struct _EXCEPTION_RECORD *ExceptionRecord,
+    PVOID EstablisherFrame,
+    struct _CONTEXT *ContextRecord,
+    PVOID DispatcherContext
+    )
+{
+    HMODULE hNtDll;
+    PMCRT_EXCEPT_HANDLER3 Handler;
+
+    hNtDll = GetModuleHandleA("NTDLL");
+    if (hNtDll == NULL) {
+        return ExceptionContinueSearch;
+    }
+
+    Handler = (PMCRT_EXCEPT_HANDLER3)GetProcAddress(hNtDll, "_except_handler3");
+    if (Handler == NULL) {
+        return ExceptionContinueSearch;
+    }
+
+    return Handler(ExceptionRecord, EstablisherFrame, ContextRecord, DispatcherContext);
+}
+
+#elif defined(_M_AMD64) || defined(_M_ARM64) || defined(_M_IA64)
+
+/**
+ A prototype for the table based language specific exception handler.
+ */
+typedef
+EXCEPTION_DISPOSITION
+MCRT_C_SPECIFIC_HANDLER(
+    struct _EXCEPTION_RECORD *ExceptionRecord,
+    PVOID EstablisherFrame,
+    struct _CONTEXT *ContextRecord,
+    struct _DISPATCHER_CONTEXT *DispatcherContext
+    );
+
+/**
+ A pointer to the table based language specific exception handler.
+ */
+typedef MCRT_C_SPECIFIC_HANDLER *PMCRT_C_SPECIFIC_HANDLER;
+
+/**
+ The language specific exception handler referenced by __try/__except blocks
+ on table based exception handling architectures.
+
+ @param ExceptionRecord Pointer to the exception being dispatched.
+
+ @param EstablisherFrame Pointer to the frame containing the __try block.
+
+ @param ContextRecord Pointer to the processor state at the time of the
+        exception.
+
+ @param DispatcherContext Pointer to the dispatcher state, including the
+        scope table for the frame.
+
+ @return The disposition of the exception.
+ */
+EXCEPTION_DISPOSITION
+__C_specific_handler(
+    struct _EXCEPTION_RECORD *ExceptionRecord,
+    PVOID EstablisherFrame,
+    struct _CONTEXT *ContextRecord,
+    struct _DISPATCHER_CONTEXT *DispatcherContext
+    )
+{
+    HMODULE hNtDll;
+    PMCRT_C_SPECIFIC_HANDLER Handler;
+
+    hNtDll = GetModuleHandleA("NTDLL");
+    if (hNtDll == NULL) {
+        return ExceptionContinueSearch;
+    }
+
+    Handler = (PMCRT_C_SPECIFIC_HANDLER)GetProcAddress(hNtDll, "__C_specific_handler");
+    if (Handler == NULL) {
+        return ExceptionContinueSearch;
+    }
+
+    return Handler(ExceptionRecord, EstablisherFrame, ContextRecord, DispatcherContext);
+}
+
+#endif
+
+// vim:sw=4:ts=4:et:
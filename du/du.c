@@ -88,15 +88,37 @@ typedef struct _DU_WIN32_FIND_STREAM_DATA {
 /**
  A structure describing a particular directory.  When traversing through
  files to calculate space, there will be one of these structures for each
- parent component of the file.
+ parent component of each file.
  */
-typedef struct _DU_DIRECTORY_STACK {
+typedef struct _DU_DIRECTORY {
+
+    /**
+     The entry for this directory within the hash table of directories,
+     keyed by the directory name.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     The links of this directory within the list of all directories.
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     Pointer to the parent of this directory, or NULL if this directory is
+     at depth zero.
+     */
+    struct _DU_DIRECTORY *Parent;
 
     /**
      The name of this directory, in escaped form.
      */
     YORI_STRING DirectoryName;
 
+    /**
+     The recursion depth of objects found within this directory.
+     */
+    DWORD Depth;
+
     /**
      The number of files or directories encountered within this directory.
      */
@@ -109,8 +131,7 @@ typedef struct _DU_DIRECTORY_STACK {
 
     /**
      The amount of bytes consumed by subdirectories within this directory.
-     Note this is populated only when the subdirectories have completed
-     their enumerations.
+     Note this is populated only when the results are being reported.
      */
     LONGLONG SpaceConsumedInChildren;
 
@@ -120,7 +141,7 @@ typedef struct _DU_DIRECTORY_STACK {
      enabled.
      */
     LONGLONG AllocationSize;
-} DU_DIRECTORY_STACK, *PDU_DIRECTORY_STACK;
+} DU_DIRECTORY, *PDU_DIRECTORY;
 
 /**
  Context passed to the callback which is invoked for each file found.
@@ -128,25 +149,28 @@ typedef struct _DU_DIRECTORY_STACK {
 typedef struct _DU_CONTEXT {
 
     /**
-     An array of directory components corresponding to the components within
-     the path currently being parsed.  File sizes are added to the leafmost
-     element (ie., StackIndex) and when a change to a parent component is
-     detected, size from the child component is propagated to the parent and
-     the child component is prepared for reuse by the next child directory.
+     A mutex to synchronize access to the directory table from the
+     threads performing the enumerate.
      */
-    PDU_DIRECTORY_STACK DirStack;
+    HANDLE Mutex;
 
     /**
-     Index of the last element in the directory stack that has been operated
-     on.
+     A hash table of directories containing objects that have been found,
+     keyed by directory name.  Because files are found on multiple threads
+     in no particular order, space is accumulated against each directory
+     and is propagated to parent directories once enumeration is complete.
      */
-    YORI_ALLOC_SIZE_T StackIndex;
+    PYORI_HASH_TABLE Directories;
 
     /**
-     The number of allocated elements in the DirStack array.  Will be zero
-     if the array has not been allocated yet.
+     A list of all directories within the hash table.
      */
-    YORI_ALLOC_SIZE_T StackAllocated;
+    YORI_LIST_ENTRY DirectoryList;
+
+    /**
+     The number of directories on DirectoryList.
+     */
+    YORI_ALLOC_SIZE_T DirectoryCount;
 
     /**
      The maximum depth to display.  This is a user specified value allowing
@@ -209,68 +233,72 @@ typedef struct _DU_CONTEXT {
 } DU_CONTEXT, *PDU_CONTEXT;
 
 /**
- Deallocate all child allocations within a DU_CONTEXT structure.  The
- structure itself is typically stack allocated and will not be freed.
+ Free all directories that have been found.
 
- @param DuContext Pointer to the DuContext to clean up.
+ @param DuContext Pointer to the DuContext containing directories to free.
  */
 VOID
-DuCleanupContext(
+DuFreeDirectories(
     __in PDU_CONTEXT DuContext
     )
 {
-    YORI_ALLOC_SIZE_T Index;
+    PYORI_LIST_ENTRY ListEntry;
+    PDU_DIRECTORY Directory;
 
-    for (Index = 0; Index < DuContext->StackAllocated; Index++) {
-        YoriLibFreeStringContents(&DuContext->DirStack[Index].DirectoryName);
-    }
+    while (TRUE) {
+        ListEntry = YoriLibGetNextListEntry(&DuContext->DirectoryList, NULL);
+        if (ListEntry == NULL) {
+            break;
+        }
 
-    if (DuContext->DirStack != NULL) {
-        YoriLibFree(DuContext->DirStack);
-        DuContext->DirStack = NULL;
+        Directory = CONTAINING_RECORD(ListEntry, DU_DIRECTORY, ListEntry);
+        YoriLibRemoveListItem(&Directory->ListEntry);
+        YoriLibHashRemoveByEntry(&Directory->HashEntry);
+        YoriLibFreeStringContents(&Directory->DirectoryName);
+        YoriLibFree(Directory);
     }
 
-    DuContext->StackAllocated = 0;
-    DuContext->StackIndex = 0;
-    YoriLibFileFiltFreeFilter(&DuContext->ColorRules);
+    DuContext->DirectoryCount = 0;
 }
 
 /**
- Clear the contents of a directory frame so it can be reused.
+ Deallocate all child allocations within a DU_CONTEXT structure.  The
+ structure itself is typically stack allocated and will not be freed.
 
- @param DirStack Pointer to the directory frame to clear.
+ @param DuContext Pointer to the DuContext to clean up.
  */
 VOID
-DuCloseStack(
-    __in PDU_DIRECTORY_STACK DirStack
+DuCleanupContext(
+    __in PDU_CONTEXT DuContext
     )
 {
-    //
-    //  Note the DirectoryName string remains allocated in the hope that the
-    //  next directory can use it.
-    //
+    if (DuContext->Directories != NULL) {
+        DuFreeDirectories(DuContext);
+        YoriLibFreeEmptyHashTable(DuContext->Directories);
+        DuContext->Directories = NULL;
+    }
 
-    DirStack->DirectoryName.LengthInChars = 0;
-    DirStack->ObjectsFoundThisDirectory = 0;
-    DirStack->SpaceConsumedThisDirectory = 0;
-    DirStack->SpaceConsumedInChildren = 0;
+    if (DuContext->Mutex != NULL) {
+        CloseHandle(DuContext->Mutex);
+        DuContext->Mutex = NULL;
+    }
+
+    YoriLibFileFiltFreeFilter(&DuContext->ColorRules);
 }
 
 /**
- Print the space consumed by a particular directory, and close out the
- directory's stack frame so it can be reused by the next directory.
+ Print the space consumed by a particular directory.
 
- @param DuContext Pointer to the DuContext which contains the directory to
-        display and close.
+ @param DuContext Pointer to the DuContext specifying display options.
 
- @param Depth Specifies the array index of the directory to display and close.
+ @param Directory Pointer to the directory to display.
 
  @return TRUE to indicate success, FALSE to indicate failure.
  */
 BOOL
-DuReportAndCloseStack(
+DuReportDirectory(
     __in PDU_CONTEXT DuContext,
-    __in DWORD Depth
+    __in PDU_DIRECTORY Directory
     )
 {
     YORI_STRING UnescapedPath;
@@ -282,14 +310,10 @@ DuReportAndCloseStack(
     TCHAR VtAttributeBuffer[YORI_MAX_VT_ESCAPE_CHARS];
     YORILIB_COLOR_ATTRIBUTES Attribute;
 
-    PDU_DIRECTORY_STACK DirStack;
-
-    DirStack = &DuContext->DirStack[Depth];
-
     if (DuContext->MaximumDepthToDisplay == 0 ||
-        Depth <= DuContext->MaximumDepthToDisplay) {
+        Directory->Depth <= DuContext->MaximumDepthToDisplay) {
 
-        SizeToDisplay.QuadPart = DirStack->SpaceConsumedInChildren + DirStack->SpaceConsumedThisDirectory;
+        SizeToDisplay.QuadPart = Directory->SpaceConsumedInChildren + Directory->SpaceConsumedThisDirectory;
 
         if (DuContext->MinimumDirectorySizeToDisplay.QuadPart == 0 ||
             SizeToDisplay.QuadPart >= DuContext->MinimumDirectorySizeToDisplay.QuadPart) {
@@ -299,10 +323,10 @@ DuReportAndCloseStack(
             //
 
             YoriLibInitEmptyString(&UnescapedPath);
-            if (YoriLibUnescapePath(&DirStack->DirectoryName, &UnescapedPath)) {
+            if (YoriLibUnescapePath(&Directory->DirectoryName, &UnescapedPath)) {
                 StringToDisplay = &UnescapedPath;
             } else {
-                StringToDisplay = &DirStack->DirectoryName;
+                StringToDisplay = &Directory->DirectoryName;
             }
 
             //
@@ -326,8 +350,8 @@ DuReportAndCloseStack(
                 VtAttribute.StartOfString = VtAttributeBuffer;
                 VtAttribute.LengthAllocated = sizeof(VtAttributeBuffer)/sizeof(VtAttributeBuffer[0]);
 
-                if (!YoriLibUpdateFindDataFromFileInformation(&FileInfo, DirStack->DirectoryName.StartOfString, TRUE) || 
-                    !YoriLibFileFiltCheckColorMatch(&DuContext->ColorRules, &DirStack->DirectoryName, &FileInfo, &Attribute)) {
+                if (!YoriLibUpdateFindDataFromFileInformation(&FileInfo, Directory->DirectoryName.StartOfString, TRUE) || 
+                    !YoriLibFileFiltCheckColorMatch(&DuContext->ColorRules, &Directory->DirectoryName, &FileInfo, &Attribute)) {
                     Attribute.Ctrl = YORILIB_ATTRCTRL_WINDOW_BG | YORILIB_ATTRCTRL_WINDOW_FG;
                     Attribute.Win32Attr = (UCHAR)YoriLibVtGetDefaultColor();
                 }
@@ -352,89 +376,298 @@ DuReportAndCloseStack(
         }
     }
 
-    DuCloseStack(DirStack);
     return TRUE;
 }
 
 /**
- Display all directory frames which have not been otherwise displayed because
- no object has been found in a subsequent directory.
+ Compare two directories to determine the order in which they should be
+ displayed.  Directories are displayed after all of their descendants, and
+ otherwise in case insensitive order, where a seperator sorts before any
+ other character so that each directory's descendants are contiguous.
+
+ @param First Pointer to the first directory.
+
+ @param Second Pointer to the second directory.
+
+ @return A negative value if First should be displayed before Second, a
+         positive value if Second should be displayed before First, or zero
+         if they are the same directory.
+ */
+int
+DuCompareDirectoryOrder(
+    __in PDU_DIRECTORY First,
+    __in PDU_DIRECTORY Second
+    )
+{
+    PYORI_STRING FirstName;
+    PYORI_STRING SecondName;
+    YORI_ALLOC_SIZE_T Index;
+    TCHAR FirstChar;
+    TCHAR SecondChar;
+
+    FirstName = &First->DirectoryName;
+    SecondName = &Second->DirectoryName;
+
+    FirstChar = '\0';
+    SecondChar = '\0';
+    for (Index = 0; Index < FirstName->LengthInChars && Index < SecondName->LengthInChars; Index++) {
+        FirstChar = YoriLibUpcaseChar(FirstName->StartOfString[Index]);
+        SecondChar = YoriLibUpcaseChar(SecondName->StartOfString[Index]);
+        if (FirstChar != SecondChar) {
+            break;
+        }
+    }
+
+    if (Index == FirstName->LengthInChars && Index == SecondName->LengthInChars) {
+        return 0;
+    }
+
+    //
+    //  If one name is exhausted, it's an ancestor of the other if the other
+    //  continues with a seperator or the exhausted name ends in one, as is
+    //  the case for a drive root.  Ancestors are displayed last.
+    //
+
+    if (Index == FirstName->LengthInChars) {
+        if (YoriLibIsSep(SecondName->StartOfString[Index]) ||
+            (Index > 0 && YoriLibIsSep(FirstName->StartOfString[Index - 1]))) {
+            return 1;
+        }
+        return -1;
+    }
+
+    if (Index == SecondName->LengthInChars) {
+        if (YoriLibIsSep(FirstName->StartOfString[Index]) ||
+            (Index > 0 && YoriLibIsSep(SecondName->StartOfString[Index - 1]))) {
+            return -1;
+        }
+        return 1;
+    }
+
+    if (YoriLibIsSep(FirstChar)) {
+        return -1;
+    }
+
+    if (YoriLibIsSep(SecondChar)) {
+        return 1;
+    }
+
+    if (FirstChar < SecondChar) {
+        return -1;
+    }
+
+    return 1;
+}
+
+/**
+ Sort an array of directories into display order via a merge sort.
+
+ @param Directories Pointer to the array of directories to sort.
+
+ @param Temp Pointer to an array of the same size to use as scratch space.
+
+ @param Count The number of elements in the arrays.
+ */
+VOID
+DuSortDirectories(
+    __inout_ecount(Count) PDU_DIRECTORY *Directories,
+    __inout_ecount(Count) PDU_DIRECTORY *Temp,
+    __in YORI_ALLOC_SIZE_T Count
+    )
+{
+    YORI_ALLOC_SIZE_T Half;
+    YORI_ALLOC_SIZE_T FirstIndex;
+    YORI_ALLOC_SIZE_T SecondIndex;
+    YORI_ALLOC_SIZE_T Index;
+
+    if (Count <= 1) {
+        return;
+    }
+
+    Half = Count / 2;
+    DuSortDirectories(Directories, Temp, Half);
+    DuSortDirectories(&Directories[Half], Temp, Count - Half);
+
+    memcpy(Temp, Directories, Count * sizeof(PDU_DIRECTORY));
+    FirstIndex = 0;
+    SecondIndex = Half;
+    for (Index = 0; Index < Count; Index++) {
+        if (SecondIndex >= Count ||
+            (FirstIndex < Half && DuCompareDirectoryOrder(Temp[FirstIndex], Temp[SecondIndex]) <= 0)) {
+            Directories[Index] = Temp[FirstIndex];
+            FirstIndex++;
+        } else {
+            Directories[Index] = Temp[SecondIndex];
+            SecondIndex++;
+        }
+    }
+}
+
+/**
+ Display all directories that have been found, and free them.  Each
+ directory is displayed after its descendants, and the space consumed by
+ each directory is added to its parent as it is displayed.
 
- @param DuContext Pointer to the DuContext which may contain active directory
-        frames.
+ @param DuContext Pointer to the DuContext which may contain directories.
 
  @param MinDepthToDisplay Indicates the minimum depth number that should be
-        displayed to the user.  Frames below this are cleared for reuse but
-        not displayed.
+        displayed to the user.  Directories below this are not displayed.
 
  @return TRUE to indicate success, FALSE to indicate failure.
  */
 BOOL
-DuReportAndCloseAllActiveStacks(
+DuReportAndFreeAllDirectories(
     __in PDU_CONTEXT DuContext,
     __in DWORD MinDepthToDisplay
     )
 {
+    PDU_DIRECTORY *Directories;
+    PDU_DIRECTORY Directory;
+    PYORI_LIST_ENTRY ListEntry;
     YORI_ALLOC_SIZE_T Index;
-    Index = DuContext->StackIndex;
-    if (Index >= DuContext->StackAllocated) {
-        ASSERT(Index == 0);
-        ASSERT(DuContext->DirStack == NULL);
+    YORI_MAX_UNSIGNED_T BytesRequested;
+    YORI_ALLOC_SIZE_T BytesToAllocate;
+
+    if (DuContext->DirectoryCount == 0) {
         return TRUE;
     }
-    while (TRUE) {
-        if (Index > 0) {
-            DuContext->DirStack[Index - 1].SpaceConsumedInChildren +=
-                DuContext->DirStack[Index].SpaceConsumedInChildren +
-                DuContext->DirStack[Index].SpaceConsumedThisDirectory;
+
+    BytesRequested = (YORI_MAX_UNSIGNED_T)DuContext->DirectoryCount * 2 * sizeof(PDU_DIRECTORY);
+    BytesToAllocate = YoriLibMaximumAllocationInRange(BytesRequested, BytesRequested);
+    if (BytesToAllocate == 0) {
+        DuFreeDirectories(DuContext);
+        return FALSE;
+    }
+
+    Directories = YoriLibMalloc(BytesToAllocate);
+    if (Directories == NULL) {
+        DuFreeDirectories(DuContext);
+        return FALSE;
+    }
+
+    Index = 0;
+    ListEntry = YoriLibGetNextListEntry(&DuContext->DirectoryList, NULL);
+    while (ListEntry != NULL) {
+        ASSERT(Index < DuContext->DirectoryCount);
+        Directories[Index] = CONTAINING_RECORD(ListEntry, DU_DIRECTORY, ListEntry);
+        Index++;
+        ListEntry = YoriLibGetNextListEntry(&DuContext->DirectoryList, ListEntry);
+    }
+
+    DuSortDirectories(Directories, &Directories[DuContext->DirectoryCount], DuContext->DirectoryCount);
+
+    for (Index = 0; Index < DuContext->DirectoryCount; Index++) {
+        Directory = Directories[Index];
+        if (Directory->Parent != NULL) {
+            Directory->Parent->SpaceConsumedInChildren +=
+                Directory->SpaceConsumedInChildren +
+                Directory->SpaceConsumedThisDirectory;
         }
-        if (Index >= MinDepthToDisplay) {
-            DuReportAndCloseStack(DuContext, Index);
-        } else {
-            DuCloseStack(&DuContext->DirStack[Index]);
+        if (Directory->Depth >= MinDepthToDisplay) {
+            DuReportDirectory(DuContext, Directory);
         }
-        if (Index == 0) {
-            break;
+    }
+
+    YoriLibFree(Directories);
+    DuFreeDirectories(DuContext);
+    return TRUE;
+}
+
+/**
+ Find the parent directory component of a path.
+
+ @param Path Pointer to the path.
+
+ @param Parent On successful completion, updated to refer to the parent
+        component of Path.  This refers to the same memory as Path.
+
+ @return TRUE if a parent was found, FALSE if the path contains no
+         parent component.
+ */
+BOOL
+DuGetParentName(
+    __in PYORI_STRING Path,
+    __out PYORI_STRING Parent
+    )
+{
+    LPTSTR FilePart;
+
+    FilePart = YoriLibFindRightMostCharacter(Path, '\\');
+    if (FilePart == NULL) {
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(Parent);
+    Parent->StartOfString = Path->StartOfString;
+    Parent->LengthInChars = (YORI_ALLOC_SIZE_T)(FilePart - Path->StartOfString);
+    if (Parent->LengthInChars == 6) {
+        Parent->LengthInChars++;
+        if (!YoriLibIsPfxDrvLetterColonSlash(Parent)) {
+            Parent->LengthInChars--;
         }
-        Index--;
-        DuContext->StackIndex--;
     }
+
     return TRUE;
 }
 
 /**
- Initialize a single directory stack location.
+ Find a directory that has been found previously, or if it has not been,
+ allocate a new directory along with any parent directories that have not
+ been found.  This function assumes the caller holds the mutex.
 
  @param DuContext Pointer to the DU context specifying the options to apply.
 
- @param DirStack Pointer to the directory stack location to initialize.
+ @param DirName Pointer to the directory name.
 
- @param DirName Pointer to the directory name to initialize in the stack.
+ @param Depth The recursion depth of objects within the directory.
 
- @return TRUE to indicate success, FALSE to indicate failure.
+ @return Pointer to the directory, or NULL on allocation failure.
  */
-BOOL
-DuInitializeDirectoryStack(
+PDU_DIRECTORY
+DuFindOrCreateDirectory(
     __in PDU_CONTEXT DuContext,
-    __in PDU_DIRECTORY_STACK DirStack,
-    __in PYORI_STRING DirName
+    __in PYORI_STRING DirName,
+    __in DWORD Depth
     )
 {
+    PYORI_HASH_ENTRY HashEntry;
+    PDU_DIRECTORY Directory;
+    PDU_DIRECTORY Parent;
+    YORI_STRING ParentName;
     DWORD SectorsPerCluster;
     DWORD BytesPerSector;
     DWORD NumberOfFreeClusters;
     DWORD TotalNumberOfClusters;
 
-    if (DirStack->DirectoryName.LengthAllocated <= DirName->LengthInChars) {
-        YoriLibFreeStringContents(&DirStack->DirectoryName);
-        if (!YoriLibAllocateString(&DirStack->DirectoryName, DirName->LengthInChars + 80)) {
-            return FALSE;
+    HashEntry = YoriLibHashLookupByKey(DuContext->Directories, DirName);
+    if (HashEntry != NULL) {
+        return HashEntry->Context;
+    }
+
+    Parent = NULL;
+    if (Depth > 0 && DuGetParentName(DirName, &ParentName)) {
+        Parent = DuFindOrCreateDirectory(DuContext, &ParentName, Depth - 1);
+        if (Parent == NULL) {
+            return NULL;
         }
     }
 
-    memcpy(DirStack->DirectoryName.StartOfString, DirName->StartOfString, DirName->LengthInChars * sizeof(TCHAR));
-    DirStack->DirectoryName.StartOfString[DirName->LengthInChars] = '\0';
-    DirStack->DirectoryName.LengthInChars = DirName->LengthInChars;
+    Directory = YoriLibMalloc(sizeof(DU_DIRECTORY));
+    if (Directory == NULL) {
+        return NULL;
+    }
+
+    ZeroMemory(Directory, sizeof(DU_DIRECTORY));
+    if (!YoriLibAllocateString(&Directory->DirectoryName, DirName->LengthInChars + 1)) {
+        YoriLibFree(Directory);
+        return NULL;
+    }
+
+    memcpy(Directory->DirectoryName.StartOfString, DirName->StartOfString, DirName->LengthInChars * sizeof(TCHAR));
+    Directory->DirectoryName.StartOfString[DirName->LengthInChars] = '\0';
+    Directory->DirectoryName.LengthInChars = DirName->LengthInChars;
+    Directory->Depth = Depth;
+    Directory->Parent = Parent;
 
     //
     //  If GetDiskFreeSpace fails, see if it works on the effective root.
@@ -443,31 +676,35 @@ DuInitializeDirectoryStack(
     //
 
     if (DuContext->AllocationSize) {
-        if (!GetDiskFreeSpace(DirStack->DirectoryName.StartOfString, &SectorsPerCluster, &BytesPerSector, &NumberOfFreeClusters, &TotalNumberOfClusters)) {
+        if (!GetDiskFreeSpace(Directory->DirectoryName.StartOfString, &SectorsPerCluster, &BytesPerSector, &NumberOfFreeClusters, &TotalNumberOfClusters)) {
             YORI_STRING EffectiveRoot;
 
-            DirStack->AllocationSize = 4096;
+            Directory->AllocationSize = 4096;
 
-            if (YoriLibFindEffRoot(&DirStack->DirectoryName, &EffectiveRoot) &&
-                EffectiveRoot.LengthInChars < DirStack->DirectoryName.LengthInChars) {
+            if (YoriLibFindEffRoot(&Directory->DirectoryName, &EffectiveRoot) &&
+                EffectiveRoot.LengthInChars < Directory->DirectoryName.LengthInChars) {
 
                 TCHAR SavedChar;
                 SavedChar = EffectiveRoot.StartOfString[EffectiveRoot.LengthInChars];
                 EffectiveRoot.StartOfString[EffectiveRoot.LengthInChars] = '\0';
 
                 if (GetDiskFreeSpace(EffectiveRoot.StartOfString, &SectorsPerCluster, &BytesPerSector, &NumberOfFreeClusters, &TotalNumberOfClusters)) {
-                    DirStack->AllocationSize = SectorsPerCluster * BytesPerSector;
+                    Directory->AllocationSize = SectorsPerCluster * BytesPerSector;
                 }
 
                 EffectiveRoot.StartOfString[EffectiveRoot.LengthInChars] = SavedChar;
             }
 
         } else {
-            DirStack->AllocationSize = SectorsPerCluster * BytesPerSector;
+            Directory->AllocationSize = SectorsPerCluster * BytesPerSector;
         }
     }
 
-    return TRUE;
+    YoriLibHashInsertByKey(DuContext->Directories, &Directory->DirectoryName, Directory, &Directory->HashEntry);
+    YoriLibAppendList(&DuContext->DirectoryList, &Directory->ListEntry);
+    DuContext->DirectoryCount++;
+
+    return Directory;
 }
 
 /**
@@ -476,7 +713,7 @@ DuInitializeDirectoryStack(
 
  @param DuContext Context specifying the accounting options to apply.
 
- @param DirStack Pointer to the directory stack indicating the allocation size
+ @param Directory Pointer to the directory indicating the allocation size
         used for the directory.
 
  @param FilePath Pointer to a fully specified path to the file.
@@ -489,7 +726,7 @@ DuInitializeDirectoryStack(
 LARGE_INTEGER
 DuCalculateSpaceUsedByFile(
     __in PDU_CONTEXT DuContext,
-    __in PDU_DIRECTORY_STACK DirStack,
+    __in PDU_DIRECTORY Directory,
     __in PYORI_STRING FilePath,
     __in PWIN32_FIND_DATA FileInfo
     )
@@ -568,7 +805,7 @@ DuCalculateSpaceUsedByFile(
     //
 
     if (DuContext->AllocationSize) {
-        FileSize.QuadPart = (FileSize.QuadPart + DirStack->AllocationSize - 1) & (~(DirStack->AllocationSize - 1));
+        FileSize.QuadPart = (FileSize.QuadPart + Directory->AllocationSize - 1) & (~(Directory->AllocationSize - 1));
     }
 
     //
@@ -597,7 +834,7 @@ DuCalculateSpaceUsedByFile(
                 if (_tcscmp(FindStreamData.cStreamName, L"::$DATA") != 0) {
                     FileSize.QuadPart += FindStreamData.StreamSize.QuadPart;
                     if (DuContext->AllocationSize) {
-                        FileSize.QuadPart = (FileSize.QuadPart + DirStack->AllocationSize - 1) & (~(DirStack->AllocationSize - 1));
+                        FileSize.QuadPart = (FileSize.QuadPart + Directory->AllocationSize - 1) & (~(Directory->AllocationSize - 1));
                     }
                 }
             } while (DllKernel32.pFindNextStreamW(hFind, &FindStreamData));
@@ -638,7 +875,8 @@ DuCalculateSpaceUsedByFile(
 
  @param FileInfo Information about the file.
 
- @param Depth Recursion depth, ignored in this application.
+ @param Depth Recursion depth, indicating the depth of the directory
+        containing the file.
 
  @param Context Pointer to the du context structure indicating the
         action to perform and populated with the number of objects found.
@@ -654,8 +892,8 @@ DuFileFoundCallback(
     )
 {
     PDU_CONTEXT DuContext = (PDU_CONTEXT)Context;
-    LPTSTR FilePart;
-    YORI_ALLOC_SIZE_T Index;
+    PDU_DIRECTORY Directory;
+    YORI_STRING ThisDirName;
 
     //
     //  Depth can only describe the number of path seperators in a single
@@ -664,120 +902,32 @@ DuFileFoundCallback(
 
     ASSERT(Depth < YORI_MAX_ALLOC_SIZE);
 
-    if (Depth >= DuContext->StackAllocated) {
-        PDU_DIRECTORY_STACK NewStack;
-        DWORD BytesRequested;
-        YORI_ALLOC_SIZE_T BytesToAllocate;
-        BytesRequested = (Depth + 8) * sizeof(DU_DIRECTORY_STACK);
-        BytesToAllocate = YoriLibMaximumAllocationInRange(BytesRequested, BytesRequested);
-        if (BytesToAllocate == 0) {
-            return FALSE;
-        }
-        NewStack = YoriLibMalloc(BytesToAllocate);
-        if (NewStack == NULL) {
-            return FALSE;
-        }
-
-        if (DuContext->StackAllocated > 0) {
-            memcpy(NewStack, DuContext->DirStack, DuContext->StackAllocated * sizeof(DU_DIRECTORY_STACK));
-            YoriLibFree(DuContext->DirStack);
-        }
-
-        for (Index = DuContext->StackAllocated; Index < Depth + 8; Index++) {
-            YoriLibInitEmptyString(&NewStack[Index].DirectoryName);
-            NewStack[Index].ObjectsFoundThisDirectory = 0;
-            NewStack[Index].SpaceConsumedThisDirectory = 0;
-            NewStack[Index].SpaceConsumedInChildren = 0;
-        }
-
-        DuContext->DirStack = NewStack;
-        DuContext->StackAllocated = (YORI_ALLOC_SIZE_T)Depth + 8;
+    if (!DuGetParentName(FilePath, &ThisDirName)) {
+        ASSERT(FALSE);
+        return TRUE;
     }
 
     //
-    //  StackIndex would normally be populated except for the first item at
-    //  Depth == 0
+    //  This is called from multiple threads, so the directory table can only
+    //  be accessed with the mutex held.  The file is inspected without the
+    //  mutex, since that can require opening it.
     //
 
-    if (DuContext->StackIndex > 0 || DuContext->DirStack[0].DirectoryName.LengthInChars > 0) {
-        Index = DuContext->StackIndex;
-        while (TRUE) {
-            YORI_ALLOC_SIZE_T StackDirLength;
-            StackDirLength = DuContext->DirStack[Index].DirectoryName.LengthInChars;
-            if (Depth >= Index &&
-                YoriLibCompareStringCnt(FilePath, &DuContext->DirStack[Index].DirectoryName, StackDirLength) == 0 &&
-                (FilePath->LengthInChars == StackDirLength ||
-                 YoriLibIsSep(FilePath->StartOfString[StackDirLength]) ||
-                 YoriLibIsSep(DuContext->DirStack[Index].DirectoryName.StartOfString[StackDirLength - 1]))) {
-
-                break;
-            }
-
-            if (Index > 0) {
-                DuContext->DirStack[Index - 1].SpaceConsumedInChildren +=
-                    DuContext->DirStack[Index].SpaceConsumedInChildren +
-                    DuContext->DirStack[Index].SpaceConsumedThisDirectory;
-            }
-            DuReportAndCloseStack(DuContext, Index);
-            if (Index == 0) {
-                break;
-            }
-            Index--;
-            DuContext->StackIndex--;
-        }
-    }
-
-    FilePart = YoriLibFindRightMostCharacter(FilePath, '\\');
-    ASSERT(FilePart != NULL);
-    if (FilePart != NULL) {
-        YORI_STRING ThisDirName;
-        YoriLibInitEmptyString(&ThisDirName);
-        ThisDirName.StartOfString = FilePath->StartOfString;
-        ThisDirName.LengthInChars = (YORI_ALLOC_SIZE_T)(FilePart - FilePath->StartOfString);
-        if (ThisDirName.LengthInChars == 6) {
-            ThisDirName.LengthInChars++;
-            if (!YoriLibIsPfxDrvLetterColonSlash(&ThisDirName)) {
-                ThisDirName.LengthInChars--;
-            }
-        }
-
-        Index = (YORI_ALLOC_SIZE_T)Depth;
-        while (TRUE) {
-            if (DuContext->DirStack[Index].DirectoryName.LengthInChars > 0) {
-
-                ASSERT(Index == DuContext->StackIndex);
-                ASSERT(YoriLibCompareString(&DuContext->DirStack[Index].DirectoryName, &ThisDirName) == 0);
-                break;
-            }
-            if (!DuInitializeDirectoryStack(DuContext, &DuContext->DirStack[Index], &ThisDirName)) {
-                return FALSE;
-            }
-            ASSERT(DuContext->DirStack[Index].ObjectsFoundThisDirectory == 0);
-            ASSERT(DuContext->DirStack[Index].SpaceConsumedThisDirectory == 0);
-            ASSERT(DuContext->DirStack[Index].SpaceConsumedInChildren == 0);
-            if (Index == 0) {
-                break;
-            }
-            Index--;
-            FilePart = YoriLibFindRightMostCharacter(&ThisDirName, '\\');
-            ASSERT(FilePart != NULL);
-            ThisDirName.LengthInChars = (YORI_ALLOC_SIZE_T)(FilePart - ThisDirName.StartOfString);
-            if (ThisDirName.LengthInChars == 6) {
-                ThisDirName.LengthInChars++;
-                if (!YoriLibIsPfxDrvLetterColonSlash(&ThisDirName)) {
-                    ThisDirName.LengthInChars--;
-                }
-            }
-        }
+    WaitForSingleObject(DuContext->Mutex, INFINITE);
+    Directory = DuFindOrCreateDirectory(DuContext, &ThisDirName, Depth);
+    if (Directory == NULL) {
+        ReleaseMutex(DuContext->Mutex);
+        return FALSE;
     }
-
-    DuContext->StackIndex = (YORI_ALLOC_SIZE_T)Depth;
-    DuContext->DirStack[Depth].ObjectsFoundThisDirectory++;
+    Directory->ObjectsFoundThisDirectory++;
+    ReleaseMutex(DuContext->Mutex);
 
     if ((FileInfo->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
         LARGE_INTEGER FileSize;
-        FileSize = DuCalculateSpaceUsedByFile(DuContext, &DuContext->DirStack[Depth], FilePath, FileInfo);
-        DuContext->DirStack[Depth].SpaceConsumedThisDirectory += FileSize.QuadPart;
+        FileSize = DuCalculateSpaceUsedByFile(DuContext, Directory, FilePath, FileInfo);
+        WaitForSingleObject(DuContext->Mutex, INFINITE);
+        Directory->SpaceConsumedThisDirectory += FileSize.QuadPart;
+        ReleaseMutex(DuContext->Mutex);
     }
 
     return TRUE;
@@ -942,6 +1092,15 @@ ENTRYPOINT(
 
     YoriLibVtStringForTextAttribute(&DuContext.FileSizeColorString, DuContext.FileSizeColor.Ctrl, DuContext.FileSizeColor.Win32Attr);
 
+    YoriLibInitializeListHead(&DuContext.DirectoryList);
+    DuContext.Directories = YoriLibAllocateHashTable(1000);
+    DuContext.Mutex = CreateMutex(NULL, FALSE, NULL);
+    if (DuContext.Directories == NULL || DuContext.Mutex == NULL) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("du: out of memory\n"));
+        DuCleanupContext(&DuContext);
+        return EXIT_FAILURE;
+    }
+
     YoriLibEnableBackupPrivilege();
 
 #if YORI_BUILTIN
@@ -951,7 +1110,8 @@ ENTRYPOINT(
     MatchFlags = YORILIB_ENUM_RETURN_FILES |
                  YORILIB_ENUM_RETURN_DIRECTORIES |
                  YORILIB_ENUM_REC_BEFORE_RETURN |
-                 YORILIB_ENUM_NO_LINK_TRAVERSE;
+                 YORILIB_ENUM_NO_LINK_TRAVERSE |
+                 YORILIB_ENUM_PARALLEL_UNORDERED;
     if (BasicEnumeration) {
         MatchFlags |= YORILIB_ENUM_BASIC_EXPANSION;
     }
@@ -964,11 +1124,11 @@ ENTRYPOINT(
         YORI_STRING FilesInDirectorySpec;
         YoriLibConstantString(&FilesInDirectorySpec, _T("."));
         YoriLibForEachFile(&FilesInDirectorySpec, MatchFlags, 0, DuFileFoundCallback, NULL, &DuContext);
-        DuReportAndCloseAllActiveStacks(&DuContext, 1);
+        DuReportAndFreeAllDirectories(&DuContext, 1);
     } else {
         for (i = StartArg; i < ArgC; i++) {
             YoriLibForEachFile(&ArgV[i], MatchFlags, 0, DuFileFoundCallback, DuFileEnumerateErrorCallback, &DuContext);
-            DuReportAndCloseAllActiveStacks(&DuContext, 1);
+            DuReportAndFreeAllDirectories(&DuContext, 1);
         }
     }
 
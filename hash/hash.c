@@ -32,6 +32,32 @@
  */
 #define MS_PRIMITIVE_PROVIDER L"Microsoft Primitive Provider"
 
+/**
+ The maximum number of algorithms that can be calculated in a single pass.
+ */
+#define HASH_MAX_ALGORITHMS 6
+
+/**
+ The maximum number of threads that can hash files concurrently.
+ */
+#define HASH_MAX_WORKERS 32
+
+/**
+ The maximum number of files whose results can be held waiting for an
+ earlier file to complete.  Results are displayed in the order files were
+ found, so a large file can delay the display of many small files behind it.
+ Once this limit is reached, no more files are submitted until the earliest
+ file completes.
+ */
+#define HASH_MAX_OUTSTANDING 4096
+
+/**
+ Files at least this large, or streams whose size is unknown, are read on a
+ separate thread so that reading the next buffer overlaps with hashing the
+ previous one.
+ */
+#define HASH_READ_AHEAD_THRESHOLD (4 * 1024 * 1024)
+
 /**
  Help text to display to the user.
  */
@@ -40,11 +66,19 @@ CHAR strHashHelpText[] =
         "\n"
         "Hash a file.\n"
         "\n"
-        "HASH [-license] [-a <algorithm>] [-b] [-s] [<file>]\n"
+        "HASH [-license] [-a <algorithm>[,<algorithm>...]] [-b] [-i] [-s] [<file>]\n"
+        "HASH [-license] [-a <algorithm>[,<algorithm>...]] [-i] -c <manifest>\n"
         "\n"
         "   -a <algorithm> Specify the hash algorithm. Supported algorithms:\n"
         "                    MD4, MD5, SHA1, SHA256, SHA384, or SHA512\n"
+        "                  Multiple algorithms can be separated by commas and are\n"
+        "                  calculated in a single pass over each file\n"
         "   -b             Use basic search criteria for files only\n"
+        "   -c             Verify files listed in a manifest previously generated by\n"
+        "                  this command.  Names in the manifest are relative to the\n"
+        "                  directory containing it.  If no algorithm is specified,\n"
+        "                  it is determined from the manifest\n"
+        "   -i             Use the internal implementation of SHA1 and SHA256\n"
         "   -s             Hash files in subdirectories\n";
 
 /**
@@ -61,6 +95,159 @@ HashHelp(VOID)
     return TRUE;
 }
 
+/**
+ Indicates whether an algorithm can be calculated without the operating
+ system's algorithm provider.
+ */
+typedef enum _HASH_SOFTWARE_TYPE {
+    HashSoftwareNone = 0,
+    HashSoftwareSha1 = 1,
+    HashSoftwareSha256 = 2
+} HASH_SOFTWARE_TYPE;
+
+/**
+ A description of a supported hash algorithm.
+ */
+typedef struct _HASH_ALGORITHM {
+
+    /**
+     The name of the algorithm as specified on the command line.
+     */
+    LPCTSTR Name;
+
+    /**
+     The algorithm in CALG_* format.
+     */
+    DWORD CryptAlgorithm;
+
+    /**
+     The number of bytes in the result of the algorithm.
+     */
+    DWORD HashLength;
+
+    /**
+     Indicates whether the algorithm has an internal implementation.
+     */
+    HASH_SOFTWARE_TYPE SoftwareType;
+} HASH_ALGORITHM, *PHASH_ALGORITHM;
+
+/**
+ A pointer to a constant hash algorithm description.
+ */
+typedef HASH_ALGORITHM CONST *PCHASH_ALGORITHM;
+
+/**
+ The table of supported algorithms.
+ */
+CONST HASH_ALGORITHM HashAlgorithms[] = {
+    {_T("MD4"),    CALG_MD4,     16, HashSoftwareNone},
+    {_T("MD5"),    CALG_MD5,     16, HashSoftwareNone},
+    {_T("SHA1"),   CALG_SHA1,    20, HashSoftwareSha1},
+    {_T("SHA256"), CALG_SHA_256, 32, HashSoftwareSha256},
+    {_T("SHA384"), CALG_SHA_384, 48, HashSoftwareNone},
+    {_T("SHA512"), CALG_SHA_512, 64, HashSoftwareNone}
+};
+
+/**
+ A pair of buffers used to read data from a stream.  When reading ahead,
+ one buffer is filled while the other is hashed.  Otherwise only the first
+ buffer is used.
+ */
+typedef struct _HASH_READ_BUFFERS {
+
+    /**
+     Pointers to each buffer.  These are part of a single allocation which
+     is referenced by the first pointer.
+     */
+    PUCHAR Buffer[2];
+
+    /**
+     Specifies the number of bytes in each buffer.
+     */
+    DWORD BufferLength;
+} HASH_READ_BUFFERS, *PHASH_READ_BUFFERS;
+
+/**
+ A single file being hashed or verified.  Files are hashed by worker threads
+ in any order, but results are displayed in the order files were found.
+ */
+typedef struct _HASH_ITEM {
+
+    /**
+     The entry for this file on the list of files waiting for a worker
+     thread.
+     */
+    YORI_LIST_ENTRY PendingList;
+
+    /**
+     The entry for this file on the list of files waiting for their result
+     to be displayed.
+     */
+    YORI_LIST_ENTRY OutputList;
+
+    /**
+     A handle to the opened file.  This is closed once the file has been
+     hashed.
+     */
+    HANDLE FileHandle;
+
+    /**
+     The name of the file to display.  The string contents are allocated as
+     part of this structure.
+     */
+    YORI_STRING DisplayName;
+
+    /**
+     A buffer to receive the result of each algorithm, concatenated.  This
+     is allocated as part of this structure.
+     */
+    PUCHAR Digest;
+
+    /**
+     When verifying, the expected result of each algorithm, concatenated.
+     NULL if not verifying.  This is allocated as part of this structure.
+     */
+    PUCHAR ExpectedDigest;
+
+    /**
+     When verifying, the error from opening the file, or ERROR_SUCCESS if it
+     was opened.
+     */
+    SYSERR OpenError;
+
+    /**
+     Set to TRUE once the file has been processed and its result can be
+     displayed.
+     */
+    BOOLEAN Complete;
+
+    /**
+     Set to TRUE if the file was successfully hashed.
+     */
+    BOOLEAN Succeeded;
+} HASH_ITEM, *PHASH_ITEM;
+
+/**
+ State for a single worker thread.
+ */
+typedef struct _HASH_WORKER {
+
+    /**
+     Pointer to the hash context.
+     */
+    struct _HASH_CONTEXT *HashContext;
+
+    /**
+     The buffers used by this thread to read files.
+     */
+    HASH_READ_BUFFERS Buffers;
+
+    /**
+     A handle to the thread.
+     */
+    HANDLE Thread;
+} HASH_WORKER, *PHASH_WORKER;
+
 /**
  Context passed to the callback which is invoked for each file found.
  */
@@ -72,6 +259,17 @@ typedef struct _HASH_CONTEXT {
      */
     BOOLEAN Recursive;
 
+    /**
+     TRUE if files are being verified against a manifest.
+     */
+    BOOLEAN Verify;
+
+    /**
+     TRUE if the internal implementation should be used for algorithms that
+     have one.
+     */
+    BOOLEAN ForceSoftware;
+
     /**
      WinCrypt handle to the algorithm provider.  If 0, the algorithm provider
      has not been initialized.
@@ -87,37 +285,96 @@ typedef struct _HASH_CONTEXT {
     SYSERR SavedErrorThisArg;
 
     /**
-     The algorithm to use in CALG_* format.
+     The number of algorithms to calculate.
      */
-    DWORD Algorithm;
+    DWORD AlgorithmCount;
 
     /**
-     Pointer to a blob of memory containing the result of the hash calculation
-     for each file.
+     The algorithms to calculate.
      */
-    PUCHAR HashBuffer;
+    PCHASH_ALGORITHM Algorithms[HASH_MAX_ALGORITHMS];
 
     /**
-     Specifies the number of bytes in HashBuffer.
+     For each algorithm, TRUE if the internal implementation is used, FALSE
+     if the operating system provider is used.
      */
-    YORI_ALLOC_SIZE_T HashLength;
+    BOOLEAN UseSoftware[HASH_MAX_ALGORITHMS];
 
     /**
-     Pointer to a buffer to read data from the file into.
+     Specifies the total number of bytes in the result of all algorithms.
      */
-    PVOID ReadBuffer;
+    YORI_ALLOC_SIZE_T DigestLength;
 
     /**
-     Specifies the number of bytes in ReadBuffer.
+     The buffers used to read data on the main thread.
      */
-    YORI_ALLOC_SIZE_T ReadBufferLength;
+    HASH_READ_BUFFERS Buffers;
 
     /**
      A string which contains enough characters to contain the hex
-     representation of HashBuffer plus a NULL terminator.
+     representation of the longest algorithm result plus a NULL terminator.
      */
     YORI_STRING HashString;
 
+    /**
+     A list of files waiting to be hashed by worker threads.
+     */
+    YORI_LIST_ENTRY PendingList;
+
+    /**
+     A list of files waiting for their result to be displayed, in the order
+     they were found.  This is only accessed by the main thread.
+     */
+    YORI_LIST_ENTRY OutputList;
+
+    /**
+     A mutex to synchronize the list of files waiting for worker threads
+     and the completion of each file.  If this is NULL, all files are hashed
+     on the main thread.
+     */
+    HANDLE Mutex;
+
+    /**
+     An event signalled when more files have been queued to worker threads.
+     */
+    HANDLE WorkerWaitEvent;
+
+    /**
+     An event signalled when worker threads should terminate once the list
+     of files waiting to be hashed has been drained.
+     */
+    HANDLE WorkerShutdownEvent;
+
+    /**
+     An event signalled when a worker thread has completed a file.
+     */
+    HANDLE ItemCompleteEvent;
+
+    /**
+     State for each worker thread that has been created.
+     */
+    HASH_WORKER Workers[HASH_MAX_WORKERS];
+
+    /**
+     The maximum number of worker threads to create.
+     */
+    DWORD MaxThreads;
+
+    /**
+     The number of worker threads that have been created.
+     */
+    DWORD ThreadsAllocated;
+
+    /**
+     The number of files waiting to be hashed by worker threads.
+     */
+    DWORD ItemsQueued;
+
+    /**
+     The number of files on OutputList.
+     */
+    DWORD OutputItems;
+
     /**
      Records the total number of files processed.
      */
@@ -129,73 +386,1014 @@ typedef struct _HASH_CONTEXT {
      */
     LONGLONG FilesFoundThisArg;
 
-} HASH_CONTEXT, *PHASH_CONTEXT;
+    /**
+     Records the number of files that did not match a manifest.
+     */
+    LONGLONG FilesFailed;
+
+} HASH_CONTEXT, *PHASH_CONTEXT;
+
+/**
+ The state of calculating every requested algorithm over a single stream.
+ */
+typedef struct _HASH_STATE {
+
+    /**
+     WinCrypt handles to each hash being calculated by the operating system
+     provider.
+     */
+    DWORD_PTR CryptHash[HASH_MAX_ALGORITHMS];
+
+    /**
+     The state of each hash being calculated by the internal implementation.
+     */
+    YORI_LIB_SHA_CONTEXT Software[HASH_MAX_ALGORITHMS];
+} HASH_STATE, *PHASH_STATE;
+
+/**
+ Find an algorithm by name.
+
+ @param Name Pointer to the name of the algorithm.
+
+ @return Pointer to the algorithm, or NULL if the name is not recognized.
+ */
+PCHASH_ALGORITHM
+HashFindAlgorithm(
+    __in PYORI_STRING Name
+    )
+{
+    DWORD Index;
+
+    for (Index = 0; Index < sizeof(HashAlgorithms)/sizeof(HashAlgorithms[0]); Index++) {
+        if (YoriLibCompareStringLitIns(Name, HashAlgorithms[Index].Name) == 0) {
+            return &HashAlgorithms[Index];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ Find an algorithm by its CALG_* identifier.
+
+ @param CryptAlgorithm The algorithm identifier.
+
+ @return Pointer to the algorithm, or NULL if the identifier is not
+         recognized.
+ */
+PCHASH_ALGORITHM
+HashFindAlgorithmByCrypt(
+    __in DWORD CryptAlgorithm
+    )
+{
+    DWORD Index;
+
+    for (Index = 0; Index < sizeof(HashAlgorithms)/sizeof(HashAlgorithms[0]); Index++) {
+        if (HashAlgorithms[Index].CryptAlgorithm == CryptAlgorithm) {
+            return &HashAlgorithms[Index];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ Add an algorithm to the set of algorithms to calculate.  Algorithms that
+ are already present are ignored.
+
+ @param HashContext Pointer to the hash context.
+
+ @param Algorithm Pointer to the algorithm to add.
+
+ @return TRUE to indicate success, FALSE if too many algorithms have been
+         specified.
+ */
+BOOL
+HashAddAlgorithm(
+    __in PHASH_CONTEXT HashContext,
+    __in PCHASH_ALGORITHM Algorithm
+    )
+{
+    DWORD Index;
+
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        if (HashContext->Algorithms[Index] == Algorithm) {
+            return TRUE;
+        }
+    }
+
+    if (HashContext->AlgorithmCount >= HASH_MAX_ALGORITHMS) {
+        return FALSE;
+    }
+
+    HashContext->Algorithms[HashContext->AlgorithmCount] = Algorithm;
+    HashContext->AlgorithmCount++;
+    return TRUE;
+}
+
+/**
+ Parse a comma separated list of algorithm names and add each to the set of
+ algorithms to calculate.
+
+ @param HashContext Pointer to the hash context.
+
+ @param AlgorithmList Pointer to the list of algorithm names.
+
+ @return TRUE to indicate success, FALSE if an algorithm was not recognized.
+ */
+BOOL
+HashParseAlgorithmList(
+    __in PHASH_CONTEXT HashContext,
+    __in PYORI_STRING AlgorithmList
+    )
+{
+    YORI_STRING Name;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Start;
+    PCHASH_ALGORITHM Algorithm;
+
+    YoriLibInitEmptyString(&Name);
+    Start = 0;
+    for (Index = 0; Index <= AlgorithmList->LengthInChars; Index++) {
+        if (Index == AlgorithmList->LengthInChars ||
+            AlgorithmList->StartOfString[Index] == ',') {
+
+            Name.StartOfString = &AlgorithmList->StartOfString[Start];
+            Name.LengthInChars = Index - Start;
+            Algorithm = HashFindAlgorithm(&Name);
+            if (Algorithm == NULL) {
+                return FALSE;
+            }
+            if (!HashAddAlgorithm(HashContext, Algorithm)) {
+                return FALSE;
+            }
+            Start = Index + 1;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ Begin calculating every requested algorithm over a stream.
+
+ @param HashContext Pointer to the hash context.
+
+ @param HashState Pointer to the state to initialize.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+HashStateBegin(
+    __in PHASH_CONTEXT HashContext,
+    __out PHASH_STATE HashState
+    )
+{
+    DWORD Index;
+
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        HashState->CryptHash[Index] = 0;
+        if (HashContext->UseSoftware[Index]) {
+            if (HashContext->Algorithms[Index]->SoftwareType == HashSoftwareSha256) {
+                YoriLibSha256Initialize(&HashState->Software[Index]);
+            } else {
+                YoriLibSha1Initialize(&HashState->Software[Index]);
+            }
+        } else {
+            if (!DllAdvApi32.pCryptCreateHash(HashContext->Provider, HashContext->Algorithms[Index]->CryptAlgorithm, 0, 0, &HashState->CryptHash[Index])) {
+                while (Index > 0) {
+                    Index--;
+                    if (HashState->CryptHash[Index] != 0) {
+                        DllAdvApi32.pCryptDestroyHash(HashState->CryptHash[Index]);
+                    }
+                }
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ Add data to every requested algorithm.
+
+ @param HashContext Pointer to the hash context.
+
+ @param HashState Pointer to the state of the calculation.
+
+ @param Buffer Pointer to the data to add.
+
+ @param Length The number of bytes in Buffer.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+HashStateUpdate(
+    __in PHASH_CONTEXT HashContext,
+    __inout PHASH_STATE HashState,
+    __in PUCHAR Buffer,
+    __in DWORD Length
+    )
+{
+    DWORD Index;
+
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        if (HashContext->UseSoftware[Index]) {
+            YoriLibShaUpdate(&HashState->Software[Index], Buffer, Length);
+        } else {
+            if (!DllAdvApi32.pCryptHashData(HashState->CryptHash[Index], Buffer, Length, 0)) {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ Complete calculating every requested algorithm and release the state.
+
+ @param HashContext Pointer to the hash context.
+
+ @param HashState Pointer to the state of the calculation.
+
+ @param Digest Optionally points to a buffer to receive the result of each
+        algorithm, concatenated.  If NULL, the calculation is abandoned.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+HashStateEnd(
+    __in PHASH_CONTEXT HashContext,
+    __inout PHASH_STATE HashState,
+    __out_opt PUCHAR Digest
+    )
+{
+    DWORD Index;
+    DWORD HashLength;
+    BOOL Result;
+
+    Result = TRUE;
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        if (HashContext->UseSoftware[Index]) {
+            if (Digest != NULL) {
+                YoriLibShaFinalize(&HashState->Software[Index], Digest);
+            }
+        } else {
+            if (Digest != NULL) {
+                HashLength = HashContext->Algorithms[Index]->HashLength;
+                if (!DllAdvApi32.pCryptGetHashParam(HashState->CryptHash[Index], HP_HASHVAL, Digest, &HashLength, 0)) {
+                    Result = FALSE;
+                }
+            }
+            DllAdvApi32.pCryptDestroyHash(HashState->CryptHash[Index]);
+        }
+        if (Digest != NULL) {
+            Digest = Digest + HashContext->Algorithms[Index]->HashLength;
+        }
+    }
+
+    return Result;
+}
+
+/**
+ State shared between a reading thread and a hashing thread when reading
+ ahead.
+ */
+typedef struct _HASH_READ_AHEAD {
+
+    /**
+     A handle to the stream to read.
+     */
+    HANDLE SourceHandle;
+
+    /**
+     Pointer to the buffers to read into.
+     */
+    PHASH_READ_BUFFERS Buffers;
+
+    /**
+     A semaphore counting the buffers that are available for the reading
+     thread to fill.
+     */
+    HANDLE EmptySemaphore;
+
+    /**
+     A semaphore counting the buffers that have been filled and are waiting
+     to be hashed.
+     */
+    HANDLE FullSemaphore;
+
+    /**
+     The number of bytes of valid data in each buffer.  Zero indicates the
+     end of the stream.
+     */
+    DWORD BytesValid[2];
+
+    /**
+     Set to TRUE by the hashing thread if hashing has failed, indicating the
+     reading thread should stop reading.
+     */
+    BOOLEAN Abort;
+} HASH_READ_AHEAD, *PHASH_READ_AHEAD;
+
+/**
+ A background thread which reads from a stream into each buffer in turn,
+ and hands the buffer to the hashing thread.  When the stream is exhausted
+ or hashing has failed, an empty buffer is handed to the hashing thread and
+ this thread terminates.
+
+ @param Context Pointer to the read ahead state.
+
+ @return Zero.
+ */
+DWORD WINAPI
+HashReadAheadThread(
+    __in LPVOID Context
+    )
+{
+    PHASH_READ_AHEAD ReadAhead = (PHASH_READ_AHEAD)Context;
+    DWORD Index;
+    DWORD BytesRead;
+
+    Index = 0;
+    while (TRUE) {
+        WaitForSingleObject(ReadAhead->EmptySemaphore, INFINITE);
+
+        //
+        //  Read errors are treated as the end of the stream, consistent with
+        //  reading on a single thread.
+        //
+
+        BytesRead = 0;
+        if (!ReadAhead->Abort) {
+            if (!ReadFile(ReadAhead->SourceHandle, ReadAhead->Buffers->Buffer[Index], ReadAhead->Buffers->BufferLength, &BytesRead, NULL)) {
+                BytesRead = 0;
+            }
+        }
+
+        ReadAhead->BytesValid[Index] = BytesRead;
+        ReleaseSemaphore(ReadAhead->FullSemaphore, 1, NULL);
+        if (BytesRead == 0) {
+            break;
+        }
+        Index = (Index + 1) % 2;
+    }
+
+    return 0;
+}
+
+/**
+ Hash a stream, reading the next buffer on a separate thread while the
+ previous buffer is hashed.
+
+ @param HashContext Pointer to the hash context.
+
+ @param HashState Pointer to the state of the calculation.
+
+ @param hSource A handle to the stream.
+
+ @param Buffers Pointer to the buffers to read into.
+
+ @param Result On successful completion, updated to indicate whether every
+        buffer was hashed successfully.
+
+ @return TRUE if the stream was processed, or FALSE if the reading thread
+         could not be started and the stream has not been read.
+ */
+__success(return)
+BOOL
+HashProcessStreamWithReadAhead(
+    __in PHASH_CONTEXT HashContext,
+    __inout PHASH_STATE HashState,
+    __in HANDLE hSource,
+    __in PHASH_READ_BUFFERS Buffers,
+    __out PBOOL Result
+    )
+{
+    HASH_READ_AHEAD ReadAhead;
+    HANDLE ReaderThread;
+    DWORD ThreadId;
+    DWORD Index;
+
+    ZeroMemory(&ReadAhead, sizeof(ReadAhead));
+    ReadAhead.SourceHandle = hSource;
+    ReadAhead.Buffers = Buffers;
+    ReadAhead.EmptySemaphore = CreateSemaphore(NULL, 2, 2, NULL);
+    if (ReadAhead.EmptySemaphore == NULL) {
+        return FALSE;
+    }
+
+    ReadAhead.FullSemaphore = CreateSemaphore(NULL, 0, 2, NULL);
+    if (ReadAhead.FullSemaphore == NULL) {
+        CloseHandle(ReadAhead.EmptySemaphore);
+        return FALSE;
+    }
+
+    ReaderThread = CreateThread(NULL, 0, HashReadAheadThread, &ReadAhead, 0, &ThreadId);
+    if (ReaderThread == NULL) {
+        CloseHandle(ReadAhead.FullSemaphore);
+        CloseHandle(ReadAhead.EmptySemaphore);
+        return FALSE;
+    }
+
+    *Result = TRUE;
+    Index = 0;
+    while (TRUE) {
+        WaitForSingleObject(ReadAhead.FullSemaphore, INFINITE);
+        if (ReadAhead.BytesValid[Index] == 0) {
+            break;
+        }
+
+        if (!ReadAhead.Abort &&
+            !HashStateUpdate(HashContext, HashState, Buffers->Buffer[Index], ReadAhead.BytesValid[Index])) {
+
+            ReadAhead.Abort = TRUE;
+            *Result = FALSE;
+        }
+
+        ReleaseSemaphore(ReadAhead.EmptySemaphore, 1, NULL);
+        Index = (Index + 1) % 2;
+    }
+
+    WaitForSingleObject(ReaderThread, INFINITE);
+    CloseHandle(ReaderThread);
+    CloseHandle(ReadAhead.FullSemaphore);
+    CloseHandle(ReadAhead.EmptySemaphore);
+    return TRUE;
+}
+
+/**
+ Calculate every requested algorithm over a single stream.
+
+ @param HashContext Pointer to a context describing the actions to perform.
+
+ @param hSource A handle to the incoming stream, which may be a file or a
+        pipe.
+
+ @param Buffers Pointer to the buffers to read into.  Each thread has its
+        own buffers.
+
+ @param ReadAhead If TRUE, the next buffer is read on a separate thread while
+        the previous one is hashed.
+
+ @param Digest On successful completion, populated with the result of each
+        algorithm, concatenated.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+HashProcessStream(
+    __in PHASH_CONTEXT HashContext,
+    __in HANDLE hSource,
+    __in PHASH_READ_BUFFERS Buffers,
+    __in BOOLEAN ReadAhead,
+    __out PUCHAR Digest
+    )
+{
+    HASH_STATE HashState;
+    DWORD BytesRead;
+    BOOL Result;
+
+    if (!HashStateBegin(HashContext, &HashState)) {
+        return FALSE;
+    }
+
+    if (!ReadAhead ||
+        !HashProcessStreamWithReadAhead(HashContext, &HashState, hSource, Buffers, &Result)) {
+
+        Result = TRUE;
+        while (TRUE) {
+            if (!ReadFile(hSource, Buffers->Buffer[0], Buffers->BufferLength, &BytesRead, NULL)) {
+                // MSFIX: Distinguish errors here better? EOF means success,
+                // read error means hash is wrong.  Could be reading from a pipe
+                // etc though
+                break;
+            }
+
+            if (BytesRead == 0) {
+                break;
+            }
+
+            if (!HashStateUpdate(HashContext, &HashState, Buffers->Buffer[0], BytesRead)) {
+                Result = FALSE;
+                break;
+            }
+        }
+    }
+
+    if (!Result) {
+        HashStateEnd(HashContext, &HashState, NULL);
+        return FALSE;
+    }
+
+    return HashStateEnd(HashContext, &HashState, Digest);
+}
+
+/**
+ Allocate the buffers used to read data.
+
+ @param Buffers Pointer to the buffers to allocate.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+HashAllocateReadBuffers(
+    __out PHASH_READ_BUFFERS Buffers
+    )
+{
+    YORI_ALLOC_SIZE_T BytesToAllocate;
+
+    BytesToAllocate = YoriLibMaximumAllocationInRange(2 * 60 * 1024, 2 * 1024 * 1024);
+    if (BytesToAllocate == 0) {
+        return FALSE;
+    }
+
+    Buffers->Buffer[0] = YoriLibMalloc(BytesToAllocate);
+    if (Buffers->Buffer[0] == NULL) {
+        return FALSE;
+    }
+
+    Buffers->BufferLength = BytesToAllocate / 2;
+    Buffers->Buffer[1] = Buffers->Buffer[0] + Buffers->BufferLength;
+    return TRUE;
+}
+
+/**
+ Free the buffers used to read data.
+
+ @param Buffers Pointer to the buffers to free.
+ */
+VOID
+HashFreeReadBuffers(
+    __in PHASH_READ_BUFFERS Buffers
+    )
+{
+    if (Buffers->Buffer[0] != NULL) {
+        YoriLibFree(Buffers->Buffer[0]);
+        Buffers->Buffer[0] = NULL;
+        Buffers->Buffer[1] = NULL;
+    }
+}
+
+/**
+ Allocate a structure describing a file to hash or verify.
+
+ @param HashContext Pointer to the hash context.
+
+ @param FileHandle A handle to the opened file, or NULL if the file could not
+        be opened.
+
+ @param DisplayName Pointer to the name of the file to display.
+
+ @return Pointer to the allocated item, or NULL on allocation failure.
+ */
+PHASH_ITEM
+HashAllocateItem(
+    __in PHASH_CONTEXT HashContext,
+    __in_opt HANDLE FileHandle,
+    __in PYORI_STRING DisplayName
+    )
+{
+    PHASH_ITEM Item;
+    YORI_ALLOC_SIZE_T DigestBytes;
+    YORI_MAX_UNSIGNED_T BytesToAllocate;
+
+    DigestBytes = HashContext->DigestLength;
+    if (HashContext->Verify) {
+        DigestBytes = DigestBytes * 2;
+    }
+
+    BytesToAllocate = sizeof(HASH_ITEM) + DigestBytes + (DisplayName->LengthInChars + 1) * sizeof(TCHAR);
+    if (!YoriLibIsSizeAllocatable(BytesToAllocate)) {
+        return NULL;
+    }
+
+    Item = YoriLibMalloc((YORI_ALLOC_SIZE_T)BytesToAllocate);
+    if (Item == NULL) {
+        return NULL;
+    }
+
+    ZeroMemory(Item, sizeof(HASH_ITEM));
+    Item->FileHandle = FileHandle;
+    Item->Digest = (PUCHAR)(Item + 1);
+    if (HashContext->Verify) {
+        Item->ExpectedDigest = Item->Digest + HashContext->DigestLength;
+    }
+
+    YoriLibInitEmptyString(&Item->DisplayName);
+    Item->DisplayName.StartOfString = (LPTSTR)(Item->Digest + DigestBytes);
+    Item->DisplayName.LengthInChars = DisplayName->LengthInChars;
+    Item->DisplayName.LengthAllocated = DisplayName->LengthInChars + 1;
+    memcpy(Item->DisplayName.StartOfString, DisplayName->StartOfString, DisplayName->LengthInChars * sizeof(TCHAR));
+    Item->DisplayName.StartOfString[DisplayName->LengthInChars] = '\0';
+
+    return Item;
+}
+
+/**
+ Hash a single file.  This can be called on worker threads, or on the main
+ thread if the file cannot be handed to a worker thread.
+
+ @param HashContext Pointer to the hash context.
+
+ @param Item Pointer to the file to hash.
+
+ @param Buffers Pointer to the buffers for the current thread to read into.
+ */
+VOID
+HashProcessItem(
+    __in PHASH_CONTEXT HashContext,
+    __in PHASH_ITEM Item,
+    __in PHASH_READ_BUFFERS Buffers
+    )
+{
+    DWORDLONG FileSize;
+    BOOLEAN ReadAhead;
+
+    if (Item->FileHandle == NULL) {
+        return;
+    }
+
+    ReadAhead = TRUE;
+    if (YoriLibGetFileOrDeviceSize(Item->FileHandle, &FileSize) == ERROR_SUCCESS &&
+        FileSize < HASH_READ_AHEAD_THRESHOLD) {
+
+        ReadAhead = FALSE;
+    }
+
+    if (HashProcessStream(HashContext, Item->FileHandle, Buffers, ReadAhead, Item->Digest)) {
+        Item->Succeeded = TRUE;
+    }
+
+    CloseHandle(Item->FileHandle);
+    Item->FileHandle = NULL;
+}
+
+/**
+ A background thread which will hash any files that it finds on the list of
+ files waiting to be hashed.
+
+ @param Context Pointer to the worker state.
+
+ @return Zero.
+ */
+DWORD WINAPI
+HashWorker(
+    __in LPVOID Context
+    )
+{
+    PHASH_WORKER Worker = (PHASH_WORKER)Context;
+    PHASH_CONTEXT HashContext = Worker->HashContext;
+    PHASH_ITEM Item;
+    DWORD FoundEvent;
+
+    while (TRUE) {
+
+        //
+        //  Wait for an indication of more work or shutdown.
+        //
+
+        FoundEvent = WaitForMultipleObjectsEx(2, &HashContext->WorkerWaitEvent, FALSE, INFINITE, FALSE);
+
+        //
+        //  Process any queued work.
+        //
+
+        while (TRUE) {
+            WaitForSingleObject(HashContext->Mutex, INFINITE);
+            if (!YoriLibIsListEmpty(&HashContext->PendingList)) {
+                Item = CONTAINING_RECORD(HashContext->PendingList.Next, HASH_ITEM, PendingList);
+                ASSERT(HashContext->ItemsQueued > 0);
+                HashContext->ItemsQueued--;
+                YoriLibRemoveListItem(&Item->PendingList);
+                ReleaseMutex(HashContext->Mutex);
+
+                HashProcessItem(HashContext, Item, &Worker->Buffers);
+
+                WaitForSingleObject(HashContext->Mutex, INFINITE);
+                Item->Complete = TRUE;
+                ReleaseMutex(HashContext->Mutex);
+                SetEvent(HashContext->ItemCompleteEvent);
+
+            } else {
+                ASSERT(HashContext->ItemsQueued == 0);
+                ReleaseMutex(HashContext->Mutex);
+                break;
+            }
+        }
+
+        //
+        //  If shutdown was requested, terminate the thread.
+        //
+
+        if (FoundEvent == (WAIT_OBJECT_0 + 1)) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ Prepare the hash context to hash files on worker threads.
+
+ @param HashContext Pointer to the hash context.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+HashInitializeWorkers(
+    __in PHASH_CONTEXT HashContext
+    )
+{
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+
+    //
+    //  Hashing is limited by the CPU once data is cached, so create up to
+    //  one thread per CPU.  Threads are only created as the queue grows.
+    //
+
+    HashContext->MaxThreads = SystemInfo.dwNumberOfProcessors;
+    if (HashContext->MaxThreads < 1) {
+        HashContext->MaxThreads = 1;
+    }
+    if (HashContext->MaxThreads > HASH_MAX_WORKERS) {
+        HashContext->MaxThreads = HASH_MAX_WORKERS;
+    }
+
+    HashContext->WorkerWaitEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (HashContext->WorkerWaitEvent == NULL) {
+        return FALSE;
+    }
+
+    HashContext->WorkerShutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (HashContext->WorkerShutdownEvent == NULL) {
+        return FALSE;
+    }
+
+    HashContext->ItemCompleteEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (HashContext->ItemCompleteEvent == NULL) {
+        return FALSE;
+    }
+
+    HashContext->Mutex = CreateMutex(NULL, FALSE, NULL);
+    if (HashContext->Mutex == NULL) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Add a file to the queue of files to be hashed by worker threads.  If the
+ worker threads already have an excessively large queue of work, this
+ function returns FALSE to indicate it should be hashed by the main thread.
+
+ @param HashContext Pointer to the hash context.
+
+ @param Item Pointer to the file to hash.
+
+ @return TRUE if the file was queued to be hashed by worker threads, or FALSE
+         if it should be hashed by the main thread.
+ */
+BOOL
+HashQueueItem(
+    __in PHASH_CONTEXT HashContext,
+    __in PHASH_ITEM Item
+    )
+{
+    PHASH_WORKER Worker;
+    DWORD ThreadId;
+    BOOL Result = FALSE;
+
+    if (HashContext->Mutex == NULL) {
+        return FALSE;
+    }
+
+    WaitForSingleObject(HashContext->Mutex, INFINITE);
+    if (HashContext->ThreadsAllocated == 0 ||
+        (HashContext->ItemsQueued > HashContext->ThreadsAllocated * 2 &&
+         HashContext->ThreadsAllocated < HashContext->MaxThreads)) {
+
+        Worker = &HashContext->Workers[HashContext->ThreadsAllocated];
+        Worker->HashContext = HashContext;
+        if (HashAllocateReadBuffers(&Worker->Buffers)) {
+            Worker->Thread = CreateThread(NULL, 0, HashWorker, Worker, 0, &ThreadId);
+            if (Worker->Thread != NULL) {
+                HashContext->ThreadsAllocated++;
+            } else {
+                HashFreeReadBuffers(&Worker->Buffers);
+            }
+        }
+    }
+
+    if (HashContext->ThreadsAllocated > 0 &&
+        HashContext->ItemsQueued < HashContext->MaxThreads * 2) {
+
+        YoriLibAppendList(&HashContext->PendingList, &Item->PendingList);
+        HashContext->ItemsQueued++;
+        Result = TRUE;
+    }
+
+    ReleaseMutex(HashContext->Mutex);
+
+    SetEvent(HashContext->WorkerWaitEvent);
+    return Result;
+}
+
+/**
+ Wait for all files queued to worker threads to be hashed, and free the
+ state used to manage worker threads.
+
+ @param HashContext Pointer to the hash context.
+ */
+VOID
+HashFreeWorkers(
+    __in PHASH_CONTEXT HashContext
+    )
+{
+    DWORD Index;
+
+    if (HashContext->ThreadsAllocated > 0) {
+        SetEvent(HashContext->WorkerShutdownEvent);
+        for (Index = 0; Index < HashContext->ThreadsAllocated; Index++) {
+            WaitForSingleObject(HashContext->Workers[Index].Thread, INFINITE);
+            CloseHandle(HashContext->Workers[Index].Thread);
+            HashContext->Workers[Index].Thread = NULL;
+            HashFreeReadBuffers(&HashContext->Workers[Index].Buffers);
+        }
+        HashContext->ThreadsAllocated = 0;
+        ASSERT(YoriLibIsListEmpty(&HashContext->PendingList));
+    }
+    if (HashContext->WorkerWaitEvent != NULL) {
+        CloseHandle(HashContext->WorkerWaitEvent);
+        HashContext->WorkerWaitEvent = NULL;
+    }
+    if (HashContext->WorkerShutdownEvent != NULL) {
+        CloseHandle(HashContext->WorkerShutdownEvent);
+        HashContext->WorkerShutdownEvent = NULL;
+    }
+    if (HashContext->ItemCompleteEvent != NULL) {
+        CloseHandle(HashContext->ItemCompleteEvent);
+        HashContext->ItemCompleteEvent = NULL;
+    }
+    if (HashContext->Mutex != NULL) {
+        CloseHandle(HashContext->Mutex);
+        HashContext->Mutex = NULL;
+    }
+}
+
+/**
+ Display the result of each algorithm for a stream, separated by spaces.
+
+ @param HashContext Pointer to the hash context.
+
+ @param Digest Pointer to the result of each algorithm, concatenated.
+ */
+VOID
+HashOutputDigest(
+    __in PHASH_CONTEXT HashContext,
+    __in PUCHAR Digest
+    )
+{
+    DWORD Index;
+    YORI_ALLOC_SIZE_T HashLength;
+
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        HashLength = (YORI_ALLOC_SIZE_T)HashContext->Algorithms[Index]->HashLength;
+        if (YoriLibHexBufferToString(Digest, HashLength, &HashContext->HashString)) {
+            if (Index > 0) {
+                YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T(" "));
+            }
+            YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y"), &HashContext->HashString);
+        }
+        Digest = Digest + HashLength;
+    }
+}
 
 /**
- Take a single incoming stream and break it into pieces.
+ Display the result for a file once it has been hashed.  When verifying,
+ only files that do not match the manifest are displayed.
 
- @param hSource A handle to the incoming stream, which may be a file or a
-        pipe.
- 
- @param HashContext Pointer to a context describing the actions to perform.
+ @param HashContext Pointer to the hash context.
 
- @return TRUE to indicate success, FALSE to indicate failure.
+ @param Item Pointer to the file that has been hashed.
  */
-BOOL
-HashProcessStream(
-    __in HANDLE hSource,
-    __in PHASH_CONTEXT HashContext
+VOID
+HashOutputItem(
+    __in PHASH_CONTEXT HashContext,
+    __in PHASH_ITEM Item
     )
 {
-    DWORD Err;
-    DWORD_PTR hHash;
-    DWORD BytesRead;
+    LPTSTR ErrText;
 
-    HashContext->FilesFound++;
-    HashContext->FilesFoundThisArg++;
+    if (!HashContext->Verify) {
+        if (Item->Succeeded) {
+            HashOutputDigest(HashContext, Item->Digest);
+            YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T(" %y\n"), &Item->DisplayName);
+        }
+        return;
+    }
 
-    if (!DllAdvApi32.pCryptCreateHash(HashContext->Provider, HashContext->Algorithm, 0, 0, &hHash)) {
-        return FALSE;
+    if (Item->OpenError != ERROR_SUCCESS) {
+        ErrText = YoriLibGetWinErrorText(Item->OpenError);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y: could not be opened: %s"), &Item->DisplayName, ErrText);
+        YoriLibFreeWinErrorText(ErrText);
+        HashContext->FilesFailed++;
+    } else if (!Item->Succeeded) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y: could not be hashed\n"), &Item->DisplayName);
+        HashContext->FilesFailed++;
+    } else if (memcmp(Item->Digest, Item->ExpectedDigest, HashContext->DigestLength) != 0) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y: FAILED\n"), &Item->DisplayName);
+        HashContext->FilesFailed++;
     }
+}
+
+/**
+ Display the results of files that have been completed, in the order the
+ files were found.  If more than a specified number of files remain
+ outstanding, wait for the earliest to complete.
+
+ @param HashContext Pointer to the hash context.
 
+ @param MaximumOutstanding The number of files that can remain waiting for
+        their result to be displayed when this function returns.  Zero
+        indicates all files should be completed and displayed.
+ */
+VOID
+HashFlushOutput(
+    __in PHASH_CONTEXT HashContext,
+    __in DWORD MaximumOutstanding
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PHASH_ITEM Item;
+    BOOLEAN Complete;
 
-    Err = ERROR_SUCCESS;
     while (TRUE) {
-        if (!ReadFile(hSource, HashContext->ReadBuffer, HashContext->ReadBufferLength, &BytesRead, NULL)) {
-            // MSFIX: Distinguish errors here better? EOF means success,
-            // read error means hash is wrong.  Could be reading from a pipe
-            // etc though
+        ListEntry = YoriLibGetNextListEntry(&HashContext->OutputList, NULL);
+        if (ListEntry == NULL) {
             break;
         }
 
-        if (BytesRead == 0) {
-            break;
+        Item = CONTAINING_RECORD(ListEntry, HASH_ITEM, OutputList);
+        if (HashContext->Mutex != NULL) {
+            WaitForSingleObject(HashContext->Mutex, INFINITE);
+            Complete = Item->Complete;
+            ReleaseMutex(HashContext->Mutex);
+        } else {
+            Complete = Item->Complete;
         }
 
-        if (!DllAdvApi32.pCryptHashData(hHash, HashContext->ReadBuffer, BytesRead, 0)) {
-            Err = GetLastError();
-            break;
+        if (!Complete) {
+            if (HashContext->OutputItems <= MaximumOutstanding) {
+                break;
+            }
+            WaitForSingleObject(HashContext->ItemCompleteEvent, INFINITE);
+            continue;
         }
 
+        YoriLibRemoveListItem(&Item->OutputList);
+        HashContext->OutputItems--;
+        HashOutputItem(HashContext, Item);
+        YoriLibFree(Item);
     }
+}
 
-    if (Err == ERROR_SUCCESS) {
-        DWORD HashLength;
-        HashLength = HashContext->HashLength;
-        if (DllAdvApi32.pCryptGetHashParam(hHash, HP_HASHVAL, HashContext->HashBuffer, &HashLength, 0)) {
-            if (!YoriLibHexBufferToString(HashContext->HashBuffer, HashContext->HashLength, &HashContext->HashString)) {
-                Err = !(ERROR_SUCCESS);
-            }
-        }
-    }
+/**
+ Submit a file to be hashed.  The file is handed to a worker thread if
+ possible, or is hashed on the main thread if not.  Any results that are
+ ready are displayed.
 
-    DllAdvApi32.pCryptDestroyHash(hHash);
+ @param HashContext Pointer to the hash context.
 
-    if (Err != STATUS_SUCCESS) {
-        return FALSE;
+ @param Item Pointer to the file to hash.  This is freed once its result has
+        been displayed.
+ */
+VOID
+HashSubmitItem(
+    __in PHASH_CONTEXT HashContext,
+    __in PHASH_ITEM Item
+    )
+{
+    YoriLibAppendList(&HashContext->OutputList, &Item->OutputList);
+    HashContext->OutputItems++;
+
+    if (Item->FileHandle == NULL ||
+        !HashQueueItem(HashContext, Item)) {
+
+        HashProcessItem(HashContext, Item, &HashContext->Buffers);
+        Item->Complete = TRUE;
     }
 
-    return TRUE;
+    HashFlushOutput(HashContext, HASH_MAX_OUTSTANDING);
 }
 
 /**
@@ -224,6 +1422,7 @@ HashFileFoundCallback(
     PHASH_CONTEXT HashContext = (PHASH_CONTEXT)Context;
     YORI_STRING RelativePathFrom;
     HANDLE FileHandle;
+    PHASH_ITEM Item;
     YORI_ALLOC_SIZE_T SlashesFound;
     YORI_ALLOC_SIZE_T Index;
 
@@ -254,7 +1453,7 @@ HashFileFoundCallback(
                             FILE_SHARE_READ | FILE_SHARE_DELETE,
                             NULL,
                             OPEN_EXISTING,
-                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_BACKUP_SEMANTICS,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_SEQUENTIAL_SCAN,
                             NULL);
 
     if (FileHandle == NULL || FileHandle == INVALID_HANDLE_VALUE) {
@@ -268,12 +1467,16 @@ HashFileFoundCallback(
     }
 
     HashContext->SavedErrorThisArg = ERROR_SUCCESS;
+    HashContext->FilesFound++;
+    HashContext->FilesFoundThisArg++;
 
-    if (HashProcessStream(FileHandle, HashContext)) {
-        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y %y\n"), &HashContext->HashString, &RelativePathFrom);
+    Item = HashAllocateItem(HashContext, FileHandle, &RelativePathFrom);
+    if (Item == NULL) {
+        CloseHandle(FileHandle);
+        return FALSE;
     }
 
-    CloseHandle(FileHandle);
+    HashSubmitItem(HashContext, Item);
     return TRUE;
 }
 
@@ -291,16 +1494,8 @@ HashCleanupContext(
 {
     BOOL Result;
 
-    if (HashContext->HashBuffer != NULL) {
-        YoriLibFree(HashContext->HashBuffer);
-        HashContext->HashBuffer = NULL;
-    }
-
-    if (HashContext->ReadBuffer != NULL) {
-        YoriLibFree(HashContext->ReadBuffer);
-        HashContext->ReadBuffer = NULL;
-    }
-
+    HashFreeWorkers(HashContext);
+    HashFreeReadBuffers(&HashContext->Buffers);
     YoriLibFreeStringContents(&HashContext->HashString);
 
     if (HashContext->Provider != 0) {
@@ -345,123 +1540,470 @@ CONST HASH_ACQUIRE_CONFIG HashAcquireConfigOptions[] = {
 };
 
 /**
- Allocate any internal allocations within the hash context needed for the
- specified hash algorithm.
+ Initialize the hash context.  For each algorithm, determine whether the
+ operating system provider or the internal implementation should be used,
+ and allocate buffers to read data and display results.
 
  @param HashContext Pointer to the hash context to initialize.
 
- @param Algorithm Specifies a CALG_* algorithm indicating the algorithm to
-        initialize.
-
  @return TRUE to indicate success, FALSE to indicate failure.
  */
+__success(return)
 BOOL
 HashInitializeContext(
-    __in PHASH_CONTEXT HashContext,
-    __in DWORD Algorithm
+    __in PHASH_CONTEXT HashContext
     )
 {
     DWORD_PTR hHash;
     SYSERR LastError;
     LPTSTR ErrText;
     DWORD Index;
-    DWORD HashLength;
+    DWORD LongestHash;
+    BOOLEAN ProviderNeeded;
+    BOOLEAN ProviderPresent;
 
     LastError = ERROR_SUCCESS;
+    ProviderNeeded = FALSE;
+
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        HashContext->UseSoftware[Index] = FALSE;
+        if (HashContext->ForceSoftware &&
+            HashContext->Algorithms[Index]->SoftwareType != HashSoftwareNone) {
+
+            HashContext->UseSoftware[Index] = TRUE;
+        } else {
+            ProviderNeeded = TRUE;
+        }
+    }
+
+    ProviderPresent = FALSE;
+    if (ProviderNeeded) {
+        YoriLibLoadAdvApi32Functions();
+        if (DllAdvApi32.pCryptAcquireContextW != NULL &&
+            DllAdvApi32.pCryptCreateHash != NULL &&
+            DllAdvApi32.pCryptDestroyHash != NULL &&
+            DllAdvApi32.pCryptGetHashParam != NULL &&
+            DllAdvApi32.pCryptHashData != NULL &&
+            DllAdvApi32.pCryptReleaseContext != NULL) {
+
+            ProviderPresent = TRUE;
+        }
+    }
 
     //
     //  Iterate through the supported providers, looking for one that works.
     //
 
-    for (Index = 0; Index < sizeof(HashAcquireConfigOptions)/sizeof(HashAcquireConfigOptions[0]); Index++) {
-        if (DllAdvApi32.pCryptAcquireContextW(&HashContext->Provider,
-                                              NULL,
-                                              HashAcquireConfigOptions[Index].Provider,
-                                              HashAcquireConfigOptions[Index].ProviderType,
-                                              HashAcquireConfigOptions[Index].Flags)) {
-            LastError = ERROR_SUCCESS;
-            break;
-        } else {
-            LastError = GetLastError();
-
-            //
-            //  NTE_BAD_KEYSET indicates that a keyset may need to be created.
-            //  The documentation suggests code should always handle this,
-            //  although it's less clear on why.  In practice this appears
-            //  necessary on NT 4 RTM (perhaps nothing else has used it first?)
-            //
-            if (LastError != (DWORD)NTE_BAD_KEYSET) {
-                continue;
-            }
-
+    if (ProviderPresent) {
+        for (Index = 0; Index < sizeof(HashAcquireConfigOptions)/sizeof(HashAcquireConfigOptions[0]); Index++) {
             if (DllAdvApi32.pCryptAcquireContextW(&HashContext->Provider,
                                                   NULL,
                                                   HashAcquireConfigOptions[Index].Provider,
                                                   HashAcquireConfigOptions[Index].ProviderType,
-                                                  HashAcquireConfigOptions[Index].Flags | CRYPT_NEWKEYSET)) {
+                                                  HashAcquireConfigOptions[Index].Flags)) {
                 LastError = ERROR_SUCCESS;
                 break;
+            } else {
+                LastError = GetLastError();
+
+                //
+                //  NTE_BAD_KEYSET indicates that a keyset may need to be created.
+                //  The documentation suggests code should always handle this,
+                //  although it's less clear on why.  In practice this appears
+                //  necessary on NT 4 RTM (perhaps nothing else has used it first?)
+                //
+                if (LastError != (DWORD)NTE_BAD_KEYSET) {
+                    continue;
+                }
+
+                if (DllAdvApi32.pCryptAcquireContextW(&HashContext->Provider,
+                                                      NULL,
+                                                      HashAcquireConfigOptions[Index].Provider,
+                                                      HashAcquireConfigOptions[Index].ProviderType,
+                                                      HashAcquireConfigOptions[Index].Flags | CRYPT_NEWKEYSET)) {
+                    LastError = ERROR_SUCCESS;
+                    break;
+                }
             }
         }
+
+        if (LastError != ERROR_SUCCESS) {
+            HashContext->Provider = 0;
+        }
     }
 
-    if (LastError != ERROR_SUCCESS) {
-        ErrText = YoriLibGetWinErrorText(LastError);
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: algorithm provider not functional: %s\n"), ErrText);
-        YoriLibFreeWinErrorText(ErrText);
+    //
+    //  Check that the provider supports each algorithm.  If it doesn't, and
+    //  an internal implementation exists, use that instead.
+    //
+
+    LongestHash = 0;
+    HashContext->DigestLength = 0;
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        if (!HashContext->UseSoftware[Index]) {
+            if (HashContext->Provider != 0 &&
+                DllAdvApi32.pCryptCreateHash(HashContext->Provider, HashContext->Algorithms[Index]->CryptAlgorithm, 0, 0, &hHash)) {
+
+                DllAdvApi32.pCryptDestroyHash(hHash);
+            } else if (HashContext->Algorithms[Index]->SoftwareType != HashSoftwareNone) {
+                HashContext->UseSoftware[Index] = TRUE;
+            } else if (!ProviderPresent) {
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: operating system support not present\n"));
+                HashCleanupContext(HashContext);
+                return FALSE;
+            } else if (HashContext->Provider == 0) {
+                ErrText = YoriLibGetWinErrorText(LastError);
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: algorithm provider not functional: %s\n"), ErrText);
+                YoriLibFreeWinErrorText(ErrText);
+                HashCleanupContext(HashContext);
+                return FALSE;
+            } else {
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: algorithm %s not supported by the operating system\n"), HashContext->Algorithms[Index]->Name);
+                HashCleanupContext(HashContext);
+                return FALSE;
+            }
+        }
+
+        if (HashContext->Algorithms[Index]->HashLength > LongestHash) {
+            LongestHash = HashContext->Algorithms[Index]->HashLength;
+        }
+        HashContext->DigestLength = HashContext->DigestLength + (YORI_ALLOC_SIZE_T)HashContext->Algorithms[Index]->HashLength;
+    }
+
+    if (!YoriLibAllocateString(&HashContext->HashString, (YORI_ALLOC_SIZE_T)(LongestHash * 2 + 1))) {
         HashCleanupContext(HashContext);
         return FALSE;
     }
 
-    if (!DllAdvApi32.pCryptCreateHash(HashContext->Provider, Algorithm, 0, 0, &hHash)) {
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: operating system support not present\n"));
+    if (!HashAllocateReadBuffers(&HashContext->Buffers)) {
         HashCleanupContext(HashContext);
         return FALSE;
     }
 
-    if (!DllAdvApi32.pCryptGetHashParam(hHash, HP_HASHVAL, NULL, &HashLength, 0)) {
-        LastError = GetLastError();
-        if (LastError != ERROR_MORE_DATA) {
-            ErrText = YoriLibGetWinErrorText(LastError);
-            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: could not determine hash length: %s\n"), ErrText);
-            YoriLibFreeWinErrorText(ErrText);
-            DllAdvApi32.pCryptDestroyHash(hHash);
-            HashCleanupContext(HashContext);
+    YoriLibInitializeListHead(&HashContext->PendingList);
+    YoriLibInitializeListHead(&HashContext->OutputList);
+
+    return TRUE;
+}
+
+/**
+ Parse the digests at the beginning of a manifest line, in the order of the
+ algorithms being calculated.
+
+ @param HashContext Pointer to the hash context.
+
+ @param Line Pointer to the manifest line.
+
+ @param ExpectedDigest On successful completion, populated with the result of
+        each algorithm, concatenated.
+
+ @param FileName On successful completion, updated to point to the file name
+        within the line.
+
+ @return TRUE to indicate the line was parsed successfully, FALSE if it was
+         not in the expected format.
+ */
+__success(return)
+BOOL
+HashParseManifestLine(
+    __in PHASH_CONTEXT HashContext,
+    __in PYORI_STRING Line,
+    __out PUCHAR ExpectedDigest,
+    __out PYORI_STRING FileName
+    )
+{
+    YORI_STRING Remaining;
+    YORI_ALLOC_SIZE_T HexLength;
+    DWORD Index;
+
+    YoriLibInitEmptyString(&Remaining);
+    Remaining.StartOfString = Line->StartOfString;
+    Remaining.LengthInChars = Line->LengthInChars;
+
+    for (Index = 0; Index < HashContext->AlgorithmCount; Index++) {
+        HexLength = (YORI_ALLOC_SIZE_T)(HashContext->Algorithms[Index]->HashLength * 2);
+        if (Remaining.LengthInChars <= HexLength ||
+            Remaining.StartOfString[HexLength] != ' ') {
+
+            return FALSE;
+        }
+
+        if (!YoriLibStringToHexBuffer(&Remaining, ExpectedDigest, (YORI_ALLOC_SIZE_T)HashContext->Algorithms[Index]->HashLength)) {
             return FALSE;
         }
+
+        ExpectedDigest = ExpectedDigest + HashContext->Algorithms[Index]->HashLength;
+        Remaining.StartOfString = Remaining.StartOfString + HexLength + 1;
+        Remaining.LengthInChars = Remaining.LengthInChars - HexLength - 1;
     }
 
-    if (!YoriLibIsSizeAllocatable(HashLength)) {
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: hash length %i too large\n"), HashLength);
-        DllAdvApi32.pCryptDestroyHash(hHash);
-        HashCleanupContext(HashContext);
+    //
+    //  Other tools indicate text or binary mode with a space or asterisk
+    //  before the file name.  This program doesn't distinguish, but accept
+    //  either so their manifests can be verified.
+    //
+
+    if (Remaining.LengthInChars > 0 &&
+        (Remaining.StartOfString[0] == '*' || Remaining.StartOfString[0] == ' ')) {
+
+        Remaining.StartOfString++;
+        Remaining.LengthInChars--;
+    }
+
+    if (Remaining.LengthInChars == 0) {
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(FileName);
+    FileName->StartOfString = Remaining.StartOfString;
+    FileName->LengthInChars = Remaining.LengthInChars;
+    return TRUE;
+}
+
+/**
+ Determine the algorithms used to generate a manifest from the length of the
+ digests on its first line.  Where more than one algorithm has the same
+ length, the more commonly used algorithm is assumed.
+
+ @param HashContext Pointer to the hash context whose algorithms should be
+        populated.
+
+ @param ManifestName Pointer to the name of the manifest as specified by the
+        user.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+HashDetermineManifestAlgorithms(
+    __in PHASH_CONTEXT HashContext,
+    __in PYORI_STRING ManifestName
+    )
+{
+    YORI_STRING FullPath;
+    YORI_STRING Line;
+    YORI_STRING Token;
+    PVOID LineContext;
+    HANDLE FileHandle;
+    PCHASH_ALGORITHM Algorithm;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T TokenLength;
+    DWORD AlgIndex;
+    TCHAR Char;
+
+    YoriLibInitEmptyString(&FullPath);
+    if (!YoriLibUserToSingleFilePath(ManifestName, TRUE, &FullPath)) {
+        return FALSE;
+    }
+
+    FileHandle = CreateFile(FullPath.StartOfString,
+                            GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_DELETE,
+                            NULL,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            NULL);
+
+    YoriLibFreeStringContents(&FullPath);
+    if (FileHandle == INVALID_HANDLE_VALUE) {
         return FALSE;
     }
-    HashContext->HashLength = (YORI_ALLOC_SIZE_T)HashLength;
 
-    DllAdvApi32.pCryptDestroyHash(hHash);
+    LineContext = NULL;
+    YoriLibInitEmptyString(&Line);
+    YoriLibInitEmptyString(&Token);
+    while (YoriLibReadLineToString(&Line, &LineContext, FileHandle)) {
+        YoriLibTrimSpaces(&Line);
+        if (Line.LengthInChars == 0) {
+            continue;
+        }
+
+        //
+        //  Each leading token consisting of hex digits whose length matches
+        //  a known algorithm, and which is followed by more text, is a
+        //  digest.
+        //
+
+        Token.StartOfString = Line.StartOfString;
+        Token.LengthInChars = Line.LengthInChars;
+        while (TRUE) {
+            for (TokenLength = 0; TokenLength < Token.LengthInChars; TokenLength++) {
+                Char = Token.StartOfString[TokenLength];
+                if (!((Char >= '0' && Char <= '9') ||
+                      (Char >= 'a' && Char <= 'f') ||
+                      (Char >= 'A' && Char <= 'F'))) {
+                    break;
+                }
+            }
 
-    HashContext->Algorithm = Algorithm;
+            if (TokenLength >= Token.LengthInChars ||
+                Token.StartOfString[TokenLength] != ' ') {
 
-    HashContext->HashBuffer = YoriLibMalloc(HashContext->HashLength);
-    if (HashContext->HashBuffer == NULL) {
-        HashCleanupContext(HashContext);
+                break;
+            }
+
+            Algorithm = NULL;
+            for (AlgIndex = 0; AlgIndex < sizeof(HashAlgorithms)/sizeof(HashAlgorithms[0]); AlgIndex++) {
+                if (HashAlgorithms[AlgIndex].HashLength * 2 == TokenLength &&
+                    HashAlgorithms[AlgIndex].CryptAlgorithm != CALG_MD4) {
+
+                    Algorithm = &HashAlgorithms[AlgIndex];
+                    break;
+                }
+            }
+
+            if (Algorithm == NULL ||
+                !HashAddAlgorithm(HashContext, Algorithm)) {
+
+                break;
+            }
+
+            Index = TokenLength + 1;
+            Token.StartOfString = Token.StartOfString + Index;
+            Token.LengthInChars = Token.LengthInChars - Index;
+        }
+        break;
+    }
+
+    YoriLibLineReadCloseOrCache(LineContext);
+    YoriLibFreeStringContents(&Line);
+    CloseHandle(FileHandle);
+
+    if (HashContext->AlgorithmCount == 0) {
         return FALSE;
     }
 
-    if (!YoriLibAllocateString(&HashContext->HashString, HashContext->HashLength * 2 + 1)) {
-        HashCleanupContext(HashContext);
+    return TRUE;
+}
+
+/**
+ Verify each file listed in a manifest.  File names in the manifest are
+ relative to the directory containing the manifest.
+
+ @param HashContext Pointer to the hash context.
+
+ @param ManifestName Pointer to the name of the manifest as specified by the
+        user.
+
+ @return TRUE if the manifest was processed, FALSE if it could not be opened.
+ */
+BOOL
+HashVerifyManifest(
+    __in PHASH_CONTEXT HashContext,
+    __in PYORI_STRING ManifestName
+    )
+{
+    YORI_STRING FullPath;
+    YORI_STRING ManifestDirectory;
+    YORI_STRING FilePath;
+    YORI_STRING FileName;
+    YORI_STRING Line;
+    PVOID LineContext;
+    HANDLE ManifestHandle;
+    HANDLE FileHandle;
+    PHASH_ITEM Item;
+    PUCHAR ExpectedDigest;
+    LPTSTR FinalSeperator;
+    LPTSTR ErrText;
+    SYSERR LastError;
+    LONGLONG LineNumber;
+
+    YoriLibInitEmptyString(&FullPath);
+    if (!YoriLibUserToSingleFilePath(ManifestName, TRUE, &FullPath)) {
         return FALSE;
     }
 
-    HashContext->ReadBufferLength = YoriLibMaximumAllocationInRange(60 * 1024, 1024 * 1024);
+    ManifestHandle = CreateFile(FullPath.StartOfString,
+                                GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                NULL,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL,
+                                NULL);
 
-    HashContext->ReadBuffer = YoriLibMalloc(HashContext->ReadBufferLength);
-    if (HashContext->ReadBuffer == NULL) {
-        HashCleanupContext(HashContext);
+    if (ManifestHandle == INVALID_HANDLE_VALUE) {
+        LastError = GetLastError();
+        ErrText = YoriLibGetWinErrorText(LastError);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: open of %y failed: %s"), &FullPath, ErrText);
+        YoriLibFreeWinErrorText(ErrText);
+        YoriLibFreeStringContents(&FullPath);
         return FALSE;
     }
 
+    ExpectedDigest = YoriLibMalloc(HashContext->DigestLength);
+    if (ExpectedDigest == NULL) {
+        CloseHandle(ManifestHandle);
+        YoriLibFreeStringContents(&FullPath);
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(&ManifestDirectory);
+    ManifestDirectory.StartOfString = FullPath.StartOfString;
+    ManifestDirectory.LengthInChars = FullPath.LengthInChars;
+    FinalSeperator = YoriLibFindRightMostCharacter(&ManifestDirectory, '\\');
+    if (FinalSeperator != NULL) {
+        ManifestDirectory.LengthInChars = (YORI_ALLOC_SIZE_T)(FinalSeperator - ManifestDirectory.StartOfString);
+    }
+
+    LineContext = NULL;
+    LineNumber = 0;
+    YoriLibInitEmptyString(&Line);
+    YoriLibInitEmptyString(&FilePath);
+    while (YoriLibReadLineToString(&Line, &LineContext, ManifestHandle)) {
+        LineNumber++;
+
+        if (YoriLibIsOperationCancelled()) {
+            break;
+        }
+
+        YoriLibTrimSpaces(&Line);
+        if (Line.LengthInChars == 0) {
+            continue;
+        }
+
+        if (!HashParseManifestLine(HashContext, &Line, ExpectedDigest, &FileName)) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: %y: line %lli not understood\n"), ManifestName, LineNumber);
+            continue;
+        }
+
+        FileHandle = NULL;
+        LastError = ERROR_SUCCESS;
+        if (YoriLibGetFullPathNameRelTo(&ManifestDirectory, &FileName, TRUE, &FilePath, NULL)) {
+            FileHandle = CreateFile(FilePath.StartOfString,
+                                    GENERIC_READ,
+                                    FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                    NULL,
+                                    OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_SEQUENTIAL_SCAN,
+                                    NULL);
+            if (FileHandle == INVALID_HANDLE_VALUE) {
+                LastError = GetLastError();
+                FileHandle = NULL;
+            }
+        } else {
+            LastError = ERROR_NOT_ENOUGH_MEMORY;
+        }
+
+        Item = HashAllocateItem(HashContext, FileHandle, &FileName);
+        if (Item == NULL) {
+            if (FileHandle != NULL) {
+                CloseHandle(FileHandle);
+            }
+            break;
+        }
+
+        Item->OpenError = LastError;
+        memcpy(Item->ExpectedDigest, ExpectedDigest, HashContext->DigestLength);
+        HashContext->FilesFound++;
+        HashSubmitItem(HashContext, Item);
+    }
+
+    YoriLibLineReadCloseOrCache(LineContext);
+    YoriLibFreeStringContents(&Line);
+    YoriLibFreeStringContents(&FilePath);
+    YoriLibFree(ExpectedDigest);
+    CloseHandle(ManifestHandle);
+    YoriLibFreeStringContents(&FullPath);
     return TRUE;
 }
 
@@ -561,7 +2103,7 @@ ENTRYPOINT(
     BOOLEAN BasicEnumeration = FALSE;
     HASH_CONTEXT HashContext;
     YORI_STRING Arg;
-    DWORD Algorithm = CALG_SHA1;
+    PUCHAR Digest;
 
     ZeroMemory(&HashContext, sizeof(HashContext));
 
@@ -580,30 +2122,9 @@ ENTRYPOINT(
                 return EXIT_SUCCESS;
             } else if (YoriLibCompareStringLitIns(&Arg, _T("a")) == 0) {
                 if (i + 1 < ArgC) {
-                    if (YoriLibCompareStringLitIns(&ArgV[i + 1], _T("MD4")) == 0) {
-                        ArgumentUnderstood = TRUE;
-                        i++;
-                        Algorithm = CALG_MD4;
-                    } else if (YoriLibCompareStringLitIns(&ArgV[i + 1], _T("MD5")) == 0) {
-                        ArgumentUnderstood = TRUE;
-                        i++;
-                        Algorithm = CALG_MD5;
-                    } else if (YoriLibCompareStringLitIns(&ArgV[i + 1], _T("SHA1")) == 0) {
-                        ArgumentUnderstood = TRUE;
-                        i++;
-                        Algorithm = CALG_SHA1;
-                    } else if (YoriLibCompareStringLitIns(&ArgV[i + 1], _T("SHA256")) == 0) {
-                        ArgumentUnderstood = TRUE;
-                        i++;
-                        Algorithm = CALG_SHA_256;
-                    } else if (YoriLibCompareStringLitIns(&ArgV[i + 1], _T("SHA384")) == 0) {
-                        ArgumentUnderstood = TRUE;
-                        i++;
-                        Algorithm = CALG_SHA_384;
-                    } else if (YoriLibCompareStringLitIns(&ArgV[i + 1], _T("SHA512")) == 0) {
+                    if (HashParseAlgorithmList(&HashContext, &ArgV[i + 1])) {
                         ArgumentUnderstood = TRUE;
                         i++;
-                        Algorithm = CALG_SHA_512;
                     } else {
                         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: algorithm not recognized.  Supported algorithms are MD4, MD5, SHA1, SHA256, SHA384, and SHA512\n"));
                         return EXIT_FAILURE;
@@ -612,6 +2133,12 @@ ENTRYPOINT(
             } else if (YoriLibCompareStringLitIns(&Arg, _T("b")) == 0) {
                 BasicEnumeration = TRUE;
                 ArgumentUnderstood = TRUE;
+            } else if (YoriLibCompareStringLitIns(&Arg, _T("c")) == 0) {
+                HashContext.Verify = TRUE;
+                ArgumentUnderstood = TRUE;
+            } else if (YoriLibCompareStringLitIns(&Arg, _T("i")) == 0) {
+                HashContext.ForceSoftware = TRUE;
+                ArgumentUnderstood = TRUE;
             } else if (YoriLibCompareStringLitIns(&Arg, _T("s")) == 0) {
                 HashContext.Recursive = TRUE;
                 ArgumentUnderstood = TRUE;
@@ -631,19 +2158,28 @@ ENTRYPOINT(
         }
     }
 
-    YoriLibLoadAdvApi32Functions();
-    if (DllAdvApi32.pCryptAcquireContextW == NULL ||
-        DllAdvApi32.pCryptCreateHash == NULL ||
-        DllAdvApi32.pCryptDestroyHash == NULL ||
-        DllAdvApi32.pCryptGetHashParam == NULL ||
-        DllAdvApi32.pCryptHashData == NULL ||
-        DllAdvApi32.pCryptReleaseContext == NULL) {
+    //
+    //  When verifying, if no algorithm was specified, determine it from the
+    //  manifest.  Otherwise default to SHA1.
+    //
+
+    if (HashContext.Verify) {
+        if (StartArg == 0 || StartArg == ArgC) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: no manifest specified\n"));
+            return EXIT_FAILURE;
+        }
+
+        if (HashContext.AlgorithmCount == 0 &&
+            !HashDetermineManifestAlgorithms(&HashContext, &ArgV[StartArg])) {
 
-        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: operating system support not present\n"));
-        return EXIT_FAILURE;
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: could not determine algorithm from manifest %y\n"), &ArgV[StartArg]);
+            return EXIT_FAILURE;
+        }
+    } else if (HashContext.AlgorithmCount == 0) {
+        HashAddAlgorithm(&HashContext, HashFindAlgorithmByCrypt(CALG_SHA1));
     }
 
-    if (!HashInitializeContext(&HashContext, Algorithm)) {
+    if (!HashInitializeContext(&HashContext)) {
         return EXIT_FAILURE;
     }
 
@@ -670,12 +2206,32 @@ ENTRYPOINT(
             return EXIT_FAILURE;
         }
 
-        if (!HashProcessStream(GetStdHandle(STD_INPUT_HANDLE), &HashContext)) {
+        Digest = YoriLibMalloc(HashContext.DigestLength);
+        if (Digest == NULL) {
             HashCleanupContext(&HashContext);
             return EXIT_FAILURE;
         }
-        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y\n"), &HashContext.HashString);
+
+        if (!HashProcessStream(&HashContext, GetStdHandle(STD_INPUT_HANDLE), &HashContext.Buffers, TRUE, Digest)) {
+            YoriLibFree(Digest);
+            HashCleanupContext(&HashContext);
+            return EXIT_FAILURE;
+        }
+        HashOutputDigest(&HashContext, Digest);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("\n"));
+        YoriLibFree(Digest);
+        HashContext.FilesFound++;
     } else {
+
+        //
+        //  If worker threads can't be initialized, files are hashed on the
+        //  main thread.
+        //
+
+        if (!HashInitializeWorkers(&HashContext)) {
+            HashFreeWorkers(&HashContext);
+        }
+
         MatchFlags = YORILIB_ENUM_RETURN_FILES | YORILIB_ENUM_DIRECTORY_CONTENTS;
         if (BasicEnumeration) {
             MatchFlags |= YORILIB_ENUM_BASIC_EXPANSION;
@@ -686,6 +2242,11 @@ ENTRYPOINT(
 
         for (i = StartArg; i < ArgC; i++) {
 
+            if (HashContext.Verify) {
+                HashVerifyManifest(&HashContext, &ArgV[i]);
+                continue;
+            }
+
             HashContext.FilesFoundThisArg = 0;
             HashContext.SavedErrorThisArg = ERROR_SUCCESS;
 
@@ -708,6 +2269,8 @@ ENTRYPOINT(
                 }
             }
         }
+
+        HashFlushOutput(&HashContext, 0);
     }
 
     HashCleanupContext(&HashContext);
@@ -717,6 +2280,14 @@ ENTRYPOINT(
         return EXIT_FAILURE;
     }
 
+    if (HashContext.Verify) {
+        if (HashContext.FilesFailed > 0) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hash: %lli of %lli files failed verification\n"), HashContext.FilesFailed, HashContext.FilesFound);
+            return EXIT_FAILURE;
+        }
+        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%lli files verified\n"), HashContext.FilesFound);
+    }
+
     return EXIT_SUCCESS;
 }
 
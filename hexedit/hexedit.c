@@ -29,6 +29,12 @@
 #include <yoriwin.h>
 #include <yoridlg.h>
 
+/**
+ The number of bytes to process at a time when saving or searching data that
+ may be paged from a file or device.
+ */
+#define HEXEDIT_CHUNK_SIZE (1024 * 1024)
+
 /**
  Help text to display to the user.
  */
@@ -108,7 +114,15 @@ typedef struct _HEXEDIT_CONTEXT {
     /**
      The length of the range of the currently edited data.
      */
-    YORI_ALLOC_SIZE_T DataLength;
+    DWORDLONG DataLength;
+
+    /**
+     A handle to the opened file, if the hex edit control is paging data
+     from it.  This is retained to prevent other processes from modifying
+     the file while it is displayed, and to allow modified pages to be
+     written back in place.  NULL if no file is open.
+     */
+    HANDLE FileHandle;
 
     /**
      The data that was most recently searched for.
@@ -227,6 +241,12 @@ typedef struct _HEXEDIT_CONTEXT {
      */
     BOOLEAN OpenAsDevice;
 
+    /**
+     TRUE if FileHandle was opened with write access, allowing modified
+     pages to be written back in place.
+     */
+    BOOLEAN FileWritable;
+
 } HEXEDIT_CONTEXT, *PHEXEDIT_CONTEXT;
 
 /**
@@ -234,6 +254,24 @@ typedef struct _HEXEDIT_CONTEXT {
  */
 HEXEDIT_CONTEXT GlobalHexEditContext;
 
+/**
+ Close the handle to the file displayed by the hex edit control, if it is
+ open.
+
+ @param HexEditContext Pointer to the hexedit context.
+ */
+VOID
+HexEditCloseFileHandle(
+    __in PHEXEDIT_CONTEXT HexEditContext
+    )
+{
+    if (HexEditContext->FileHandle != NULL) {
+        CloseHandle(HexEditContext->FileHandle);
+        HexEditContext->FileHandle = NULL;
+    }
+    HexEditContext->FileWritable = FALSE;
+}
+
 /**
  Free all found files in the list.
 
@@ -244,6 +282,7 @@ HexEditFreeHexEditContext(
     __in PHEXEDIT_CONTEXT HexEditContext
     )
 {
+    HexEditCloseFileHandle(HexEditContext);
     YoriLibFreeStringContents(&HexEditContext->OpenFileName);
     if (HexEditContext->SearchBuffer) {
         YoriLibDereference(HexEditContext->SearchBuffer);
@@ -302,7 +341,10 @@ HexEditUpdateOpenedFileCaption(
 }
 
 /**
- Load the contents of the specified file into the hexedit window.
+ Load the contents of the specified file into the hexedit window.  The data
+ is paged from the file or device as it is accessed rather than being read
+ into memory, so files and devices of any size can be displayed.  The file
+ handle is retained so that modifications can be written back in place.
 
  @param HexEditContext Pointer to the hexedit context.
 
@@ -325,12 +367,10 @@ HexEditLoadFile(
 {
     HANDLE hFile;
     LARGE_INTEGER FileSize;
-    LARGE_INTEGER FileOffset;
-    YORI_MAX_SIGNED_T nFileSize;
-    YORI_ALLOC_SIZE_T ReadLength;
-    PUCHAR Buffer;
-    DWORD BytesRead;
     SYSERR Err;
+    DWORD ShareMode;
+    DWORD Flags;
+    BOOLEAN Writable;
 
     if (FileName->StartOfString == NULL) {
         return ERROR_INVALID_NAME;
@@ -338,9 +378,36 @@ HexEditLoadFile(
 
     ASSERT(YoriLibIsStringNullTerminated(FileName));
 
-    hFile = CreateFile(FileName->StartOfString, FILE_READ_DATA | FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    //
+    //  Close any handle to a previously displayed file, since it may be the
+    //  same file and would conflict with opening it again.  The control
+    //  holds its own reference until its contents are replaced.
+    //
+
+    HexEditCloseFileHandle(HexEditContext);
+
+    //
+    //  Devices are opened unbuffered so that data is read and written
+    //  directly.  Other processes are allowed to continue using the device,
+    //  since volumes are typically mounted while being inspected.
+    //
+
+    if (YoriLibIsFileNameDeviceName(FileName)) {
+        ShareMode = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+        Flags = FILE_FLAG_NO_BUFFERING;
+    } else {
+        ShareMode = FILE_SHARE_READ | FILE_SHARE_DELETE;
+        Flags = FILE_ATTRIBUTE_NORMAL;
+    }
+
+    Writable = TRUE;
+    hFile = CreateFile(FileName->StartOfString, FILE_READ_DATA | FILE_WRITE_DATA | FILE_READ_ATTRIBUTES | SYNCHRONIZE, ShareMode, NULL, OPEN_EXISTING, Flags, NULL);
     if (hFile == INVALID_HANDLE_VALUE) {
-        return GetLastError();
+        Writable = FALSE;
+        hFile = CreateFile(FileName->StartOfString, FILE_READ_DATA | FILE_READ_ATTRIBUTES | SYNCHRONIZE, ShareMode, NULL, OPEN_EXISTING, Flags, NULL);
+        if (hFile == INVALID_HANDLE_VALUE) {
+            return GetLastError();
+        }
     }
 
     // 
@@ -355,69 +422,149 @@ HexEditLoadFile(
             CloseHandle(hFile);
             return Err;
         }
+
+        //
+        //  The range starts at DataOffset, so it ends at the end of the file
+        //  or device.
+        //
+
+        if ((DWORDLONG)FileSize.QuadPart > DataOffset) {
+            FileSize.QuadPart = FileSize.QuadPart - DataOffset;
+        } else {
+            FileSize.QuadPart = 0;
+        }
     } else {
         FileSize.QuadPart = DataLength;
     }
 
-    nFileSize = (YORI_MAX_SIGNED_T)FileSize.QuadPart;
-    if (!YoriLibIsSizeAllocatable(nFileSize)) {
+    YoriWinHexEditClear(HexEditContext->HexEdit);
+
+    //
+    //  An empty range has nothing to page, so leave the control empty.  The
+    //  handle is not needed since anything saved is written in full.
+    //
+
+    if (FileSize.QuadPart == 0) {
         CloseHandle(hFile);
-        return ERROR_READ_FAULT;
+        YoriWinHexEditSetVisualBufferOffset(HexEditContext->HexEdit, DataOffset);
+        HexEditContext->DataOffset = DataOffset;
+        HexEditContext->DataLength = 0;
+        return ERROR_SUCCESS;
     }
 
-    ReadLength = (YORI_ALLOC_SIZE_T)FileSize.QuadPart;
+    //
+    //  If the call requested us to automatically detect the length, tolerate
+    //  it being a little smaller than we expect.  This happens when the
+    //  partition layer passes IOCTLs to the disk, sigh.
+    //
 
-    FileOffset.QuadPart = DataOffset;
-    if (FileOffset.QuadPart != 0) {
-        if (!SetFilePointer(hFile, FileOffset.LowPart, &FileOffset.HighPart, FILE_BEGIN)) {
-            Err = GetLastError();
-            CloseHandle(hFile);
-            return Err;
+    if (!YoriWinHexEditSetDataFromFile(HexEditContext->HexEdit, hFile, DataOffset, FileSize.QuadPart, (BOOLEAN)(DataLength == 0))) {
+        Err = GetLastError();
+        CloseHandle(hFile);
+        if (Err == ERROR_SUCCESS) {
+            Err = ERROR_READ_FAULT;
         }
+        return Err;
     }
 
-    Buffer = YoriLibReferencedMalloc(ReadLength);
-    if (Buffer == NULL) {
-        CloseHandle(hFile);
-        return ERROR_NOT_ENOUGH_MEMORY;
-    }
+    YoriWinHexEditSetVisualBufferOffset(HexEditContext->HexEdit, DataOffset);
+
+    HexEditContext->FileHandle = hFile;
+    HexEditContext->FileWritable = Writable;
+    HexEditContext->DataOffset = DataOffset;
+    HexEditContext->DataLength = YoriWinHexEditGetDataLength(HexEditContext->HexEdit);
+
+    return ERROR_SUCCESS;
+}
 
-    if (!ReadFile(hFile, Buffer, ReadLength, &BytesRead, NULL)) {
+/**
+ Write the pages of data that have been modified back to the file or device
+ that the hex edit control is paging from.  Since the control is reading
+ unmodified data from the file, it already matches the file contents.
+
+ @param HexEditContext Pointer to the hexedit context.
+
+ @return Win32 error code, including ERROR_SUCCESS to indicate success.
+ */
+DWORD
+HexEditSaveModifiedPages(
+    __in PHEXEDIT_CONTEXT HexEditContext
+    )
+{
+    DWORD Err;
+
+    if (!YoriWinHexEditWriteModifiedPages(HexEditContext->HexEdit)) {
         Err = GetLastError();
-        YoriLibDereference(Buffer);
-        CloseHandle(hFile);
+        if (Err == ERROR_SUCCESS) {
+            Err = ERROR_WRITE_FAULT;
+        }
         return Err;
     }
 
-    //
-    //  If the call requested us to automatically detect the length, tolerate
-    //  it being a little smaller than we expect.  This happens when the
-    //  partition layer passes IOCTLs to the disk, sigh.
-    //
+    return ERROR_SUCCESS;
+}
 
-    if (BytesRead > ReadLength ||
-        (DataLength != 0 && BytesRead != ReadLength)) {
+/**
+ Write the entire contents of the hex edit control to a handle, starting at
+ its current file position.  The data is copied through a page aligned
+ buffer a chunk at a time, so that data paged from a file does not need to
+ be held in memory, and so that the buffer meets the alignment requirements
+ of unbuffered device writes.
 
-        YoriLibDereference(Buffer);
-        CloseHandle(hFile);
-        return ERROR_INVALID_DATA;
-    }
+ @param HexEditContext Pointer to the hexedit context.
 
-    CloseHandle(hFile);
+ @param WriteHandle Handle to the file or device to write to.
 
-    YoriWinHexEditClear(HexEditContext->HexEdit);
+ @return Win32 error code, including ERROR_SUCCESS to indicate success.
+ */
+DWORD
+HexEditWriteAllData(
+    __in PHEXEDIT_CONTEXT HexEditContext,
+    __in HANDLE WriteHandle
+    )
+{
+    PUCHAR Buffer;
+    YORI_MAX_UNSIGNED_T DataLength;
+    YORI_MAX_UNSIGNED_T Offset;
+    DWORD ChunkLength;
+    DWORD BytesWritten;
+    DWORD Err;
+
+    DataLength = YoriWinHexEditGetDataLength(HexEditContext->HexEdit);
+    if (DataLength == 0) {
+        return ERROR_SUCCESS;
+    }
 
-    if (!YoriWinHexEditSetDataNoCopy(HexEditContext->HexEdit, Buffer, ReadLength, (YORI_ALLOC_SIZE_T)BytesRead)) {
-        YoriLibDereference(Buffer);
+    Buffer = VirtualAlloc(NULL, HEXEDIT_CHUNK_SIZE, MEM_COMMIT, PAGE_READWRITE);
+    if (Buffer == NULL) {
         return ERROR_NOT_ENOUGH_MEMORY;
     }
-    YoriLibDereference(Buffer);
-    YoriWinHexEditSetVisualBufferOffset(HexEditContext->HexEdit, DataOffset);
 
-    HexEditContext->DataOffset = DataOffset;
-    HexEditContext->DataLength = ReadLength;
+    Err = ERROR_SUCCESS;
+    for (Offset = 0; Offset < DataLength; Offset = Offset + ChunkLength) {
+        ChunkLength = HEXEDIT_CHUNK_SIZE;
+        if (DataLength - Offset < ChunkLength) {
+            ChunkLength = (DWORD)(DataLength - Offset);
+        }
 
-    return ERROR_SUCCESS;
+        if (!YoriWinHexEditReadData(HexEditContext->HexEdit, Offset, Buffer, ChunkLength)) {
+            Err = ERROR_READ_FAULT;
+            break;
+        }
+
+        if (!WriteFile(WriteHandle, Buffer, ChunkLength, &BytesWritten, NULL)) {
+            Err = GetLastError();
+            break;
+        }
+
+        if (BytesWritten != ChunkLength) {
+            Err = ERROR_WRITE_FAULT;
+            break;
+        }
+    }
+
+    VirtualFree(Buffer, 0, MEM_RELEASE);
+    return Err;
 }
 
 /**
@@ -457,10 +604,14 @@ HexEditSaveFile(
     YORI_STRING TempFileName;
     HANDLE WriteHandle;
     BOOLEAN ReplaceSucceeded;
-    PUCHAR Buffer;
-    YORI_ALLOC_SIZE_T BufferLength;
-    YORI_ALLOC_SIZE_T EffectiveDataLength;
-    DWORD BufferWritten;
+    BOOLEAN Paged;
+    BOOLEAN SameFile;
+    BOOLEAN AsChar;
+    UCHAR BitShift;
+    YORI_MAX_UNSIGNED_T BufferLength;
+    YORI_MAX_UNSIGNED_T CursorOffset;
+    YORI_ALLOC_SIZE_T ViewportLeft;
+    YORI_MAX_UNSIGNED_T ViewportTop;
     YORI_STRING Text;
     YORI_STRING Title;
     YORI_STRING ButtonText;
@@ -475,14 +626,51 @@ HexEditSaveFile(
         goto DisplayErrorAndFail;
     }
 
-    if (!YoriLibIsSizeAllocatable(DataLength)) {
-        YoriLibConstantString(&Text, _T("Cannot save: device size too large"));
+    ASSERT(YoriLibIsStringNullTerminated(FileName));
+
+    BufferLength = YoriWinHexEditGetDataLength(HexEditContext->HexEdit);
+    if (DataLength != 0 &&
+        DataLength != BufferLength) {
+
+        YoriLibYPrintf(&Text, _T("Device length %lli bytes does not match buffer length %lli bytes"), DataLength, BufferLength);
         goto DisplayErrorAndFail;
     }
 
-    EffectiveDataLength = (YORI_ALLOC_SIZE_T)DataLength;
+    Paged = YoriWinHexEditIsDataPaged(HexEditContext->HexEdit);
+    SameFile = FALSE;
+    if (HexEditContext->FileHandle != NULL &&
+        DataOffset == HexEditContext->DataOffset &&
+        YoriLibCompareStringIns(FileName, &HexEditContext->OpenFileName) == 0) {
 
-    ASSERT(YoriLibIsStringNullTerminated(FileName));
+        SameFile = TRUE;
+    }
+
+    //
+    //  If the control is paging from the file being saved to, and it was
+    //  opened for write, only modified pages need to be written.  The
+    //  length can't have changed, since that requires the data to be held
+    //  in memory.
+    //
+
+    if (Paged && SameFile && HexEditContext->FileWritable) {
+        Err = HexEditSaveModifiedPages(HexEditContext);
+        if (Err != ERROR_SUCCESS) {
+            ErrText = YoriLibGetWinErrorText(Err);
+            YoriLibYPrintf(&Text, _T("Could not write to file: %s"), ErrText);
+            YoriLibFreeWinErrorText(ErrText);
+            goto DisplayErrorAndFail;
+        }
+        return TRUE;
+    }
+
+    //
+    //  If the data is held in memory, the file handle is no longer needed
+    //  and would prevent the file from being replaced.
+    //
+
+    if (!Paged) {
+        HexEditCloseFileHandle(HexEditContext);
+    }
 
     if (!YoriLibIsFileNameDeviceName(FileName)) {
 
@@ -533,56 +721,49 @@ HexEditSaveFile(
         }
     }
 
-    YoriWinHexEditGetDataNoCopy(HexEditContext->HexEdit, &Buffer, &BufferLength);
-
-    if (EffectiveDataLength != 0 &&
-        EffectiveDataLength != BufferLength) {
-
-        CloseHandle(WriteHandle);
-        if (TempFileName.LengthInChars > 0) {
-            DeleteFile(TempFileName.StartOfString);
-        }
-        YoriLibFreeStringContents(&TempFileName);
-
-        YoriLibYPrintf(&Text, _T("Device length %i bytes does not match buffer length %i bytes"), EffectiveDataLength, BufferLength);
-        goto DisplayErrorAndFail;
-    }
-
     if (DataOffset != 0) {
         LARGE_INTEGER FileOffset;
         FileOffset.QuadPart = DataOffset;
-        if (!SetFilePointer(WriteHandle, FileOffset.LowPart, &FileOffset.HighPart, FILE_BEGIN)) {
+        FileOffset.LowPart = SetFilePointer(WriteHandle, FileOffset.LowPart, &FileOffset.HighPart, FILE_BEGIN);
+        if (FileOffset.LowPart == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR) {
             CloseHandle(WriteHandle);
             if (TempFileName.LengthInChars > 0) {
                 DeleteFile(TempFileName.StartOfString);
             }
             YoriLibFreeStringContents(&TempFileName);
-            YoriLibYPrintf(&Text, _T("Could not seek to offset 0x%llx"), FileOffset.QuadPart);
+            YoriLibYPrintf(&Text, _T("Could not seek to offset 0x%llx"), DataOffset);
             goto DisplayErrorAndFail;
         }
     }
 
-    if (Buffer != NULL) {
-
-        //
-        //  MSFIX This is truncating to 4Gb but is probably limited much lower
-        //
-
-        if (!WriteFile(WriteHandle, Buffer, (DWORD)BufferLength, &BufferWritten, NULL)) {
-            Err = GetLastError();
-            ErrText = YoriLibGetWinErrorText(Err);
-            CloseHandle(WriteHandle);
-            if (TempFileName.LengthInChars > 0) {
-                DeleteFile(TempFileName.StartOfString);
-            }
-            YoriLibFreeStringContents(&TempFileName);
-            YoriLibDereference(Buffer);
-            YoriLibYPrintf(&Text, _T("Could not write to device: %s"), ErrText);
-            YoriLibFreeWinErrorText(ErrText);
-            goto DisplayErrorAndFail;
+    Err = HexEditWriteAllData(HexEditContext, WriteHandle);
+    if (Err != ERROR_SUCCESS) {
+        ErrText = YoriLibGetWinErrorText(Err);
+        CloseHandle(WriteHandle);
+        if (TempFileName.LengthInChars > 0) {
+            DeleteFile(TempFileName.StartOfString);
         }
+        YoriLibFreeStringContents(&TempFileName);
+        YoriLibYPrintf(&Text, _T("Could not write to device: %s"), ErrText);
+        YoriLibFreeWinErrorText(ErrText);
+        goto DisplayErrorAndFail;
+    }
+
+    //
+    //  If the control is paging data, capture the position so the saved file
+    //  can be reloaded in the same place.  The control continues to page
+    //  from the previous file until then, and any modified pages were only
+    //  written to the new one.
+    //
 
-        YoriLibDereference(Buffer);
+    CursorOffset = 0;
+    BitShift = 0;
+    AsChar = FALSE;
+    ViewportLeft = 0;
+    ViewportTop = 0;
+    if (Paged) {
+        YoriWinHexEditGetCursorLocation(HexEditContext->HexEdit, &AsChar, &CursorOffset, &BitShift);
+        YoriWinHexEditGetViewportLocation(HexEditContext->HexEdit, &ViewportLeft, &ViewportTop);
     }
 
     if (TempFileName.LengthInChars > 0) {
@@ -604,6 +785,17 @@ HexEditSaveFile(
 
         CloseHandle(WriteHandle);
 
+        //
+        //  If the control is paging from the file being replaced, stop so
+        //  the file is no longer in use.  All of the data has been written
+        //  to the temporary file, and will be reloaded from there.
+        //
+
+        if (Paged && SameFile) {
+            YoriWinHexEditClear(HexEditContext->HexEdit);
+            HexEditCloseFileHandle(HexEditContext);
+        }
+
         //
         //  If the file exists and ReplaceFile is present, replace it. Without
         //  ReplaceFile or if the file doesn't exist, rename the temporary file
@@ -624,6 +816,20 @@ HexEditSaveFile(
 
         if (!ReplaceSucceeded) {
             if (!MoveFileEx(TempFileName.StartOfString, FileName->StartOfString, MOVEFILE_REPLACE_EXISTING)) {
+
+                //
+                //  If the control was paging from this file, its changes
+                //  only exist in the temporary file now, so leave it for
+                //  the user and redisplay the original file.
+                //
+
+                if (Paged && SameFile) {
+                    YoriLibYPrintf(&Text, _T("Could not replace file with temporary file.  Changes were saved to %y"), &TempFileName);
+                    YoriLibFreeStringContents(&TempFileName);
+                    HexEditLoadFile(HexEditContext, FileName, DataOffset, BufferLength);
+                    goto DisplayErrorAndFail;
+                }
+
                 DeleteFile(TempFileName.StartOfString);
                 YoriLibFreeStringContents(&TempFileName);
                 YoriLibConstantString(&Text, _T("Could not replace file with temporary file"));
@@ -634,10 +840,29 @@ HexEditSaveFile(
         CloseHandle(WriteHandle);
     }
 
+    YoriLibFreeStringContents(&TempFileName);
+
+    //
+    //  If the control was paging, display the newly saved file so that
+    //  future saves apply to it.
+    //
+
+    if (Paged) {
+        Err = HexEditLoadFile(HexEditContext, FileName, DataOffset, BufferLength);
+        if (Err != ERROR_SUCCESS) {
+            ErrText = YoriLibGetWinErrorText(Err);
+            YoriLibYPrintf(&Text, _T("File saved but could not be reopened: %s"), ErrText);
+            YoriLibFreeWinErrorText(ErrText);
+            goto DisplayErrorAndFail;
+        }
+
+        YoriWinHexEditSetViewportLocation(HexEditContext->HexEdit, ViewportLeft, ViewportTop);
+        YoriWinHexEditSetCursorLocation(HexEditContext->HexEdit, AsChar, CursorOffset, BitShift);
+    }
+
     HexEditContext->DataOffset = DataOffset;
-    HexEditContext->DataLength = EffectiveDataLength;
+    HexEditContext->DataLength = DataLength;
 
-    YoriLibFreeStringContents(&TempFileName);
     return TRUE;
 
 DisplayErrorAndFail:
@@ -1182,6 +1407,7 @@ HexEditNewButtonClicked(
     }
 
     YoriWinHexEditClear(HexEditContext->HexEdit);
+    HexEditCloseFileHandle(HexEditContext);
     YoriLibFreeStringContents(&HexEditContext->OpenFileName);
     HexEditUpdateOpenedFileCaption(HexEditContext);
     YoriWinHexEditSetModifyState(HexEditContext->HexEdit, FALSE);
@@ -1482,168 +1708,174 @@ HexEditSearchButtonClicked(
 }
 
 /**
- Search forward through a memory buffer looking for a matching sub-buffer.
- Both are treated as opaque binary buffers.
+ Translate a byte aligned offset into a control buffer offset and bit shift.
+ This is necessary because the control can display values of different word
+ sizes, which is expressed using a buffer offset to point to the word and
+ a bit shift to refer to the digit within the word.  Here we only care about
+ being 8 bit aligned (no nibble alignment.)
 
- @param Buffer Pointer to the master buffer that may contain a match.
+ @param HexEditContext Pointer to the hexedit context, implicitly containing
+        information about the bytes per word.
 
- @param BufferLength The length of the master buffer, in bytes.
+ @param ByteOffset The offset within the buffer, in bytes.
 
- @param BufferOffset The initial offset to search within the master buffer,
-        in bytes.
+ @param BufferOffset On successful completion, updated to point to the
+        beginning of the word within the buffer.
 
- @param SearchBuffer Pointer to the buffer to search for.
+ @param BitShift On successful completion, updated to indicate the number
+        of bits to shift to point to the digit describing the specified byte.
+ */
+VOID
+HexEditByteOffsetToBufferOffsetAndShift(
+    __in PHEXEDIT_CONTEXT HexEditContext,
+    __in YORI_MAX_UNSIGNED_T ByteOffset,
+    __out PYORI_MAX_UNSIGNED_T BufferOffset,
+    __out PUCHAR BitShift
+    )
+{
+    YORI_MAX_UNSIGNED_T LocalBufferOffset;
+    YORI_MAX_UNSIGNED_T BytesPerWord;
 
- @param SearchBufferLength The length of the search buffer, in bytes.
+    BytesPerWord = HexEditContext->BytesPerWord;
+    BytesPerWord = ~(BytesPerWord - 1);
 
- @param FoundOffset On successful completion (ie., a match is found), updated
-        to point to the offset within the master buffer of the match.
+    LocalBufferOffset = ByteOffset & BytesPerWord;
+    *BufferOffset = LocalBufferOffset;
+    *BitShift = (UCHAR)((ByteOffset - LocalBufferOffset) * 8);
+}
 
- @return TRUE to indicate a match was found, FALSE if no match was found.
+/**
+ Allocate a buffer to search data in chunks.  Each chunk is read with enough
+ extra bytes that a match which starts within the chunk can be found within
+ it.
+
+ @param HexEditContext Pointer to the hexedit context, specifying the data
+        being searched for.
+
+ @param BufferLength On successful completion, updated to contain the length
+        of the allocated buffer.
+
+ @return Pointer to the allocated buffer, or NULL on failure.  This should be
+         freed with @ref YoriLibFree .
  */
-__success(return)
-BOOLEAN
-HexEditFindNextMemorySubset(
-    __in PUCHAR Buffer,
-    __in YORI_ALLOC_SIZE_T BufferLength,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
-    __in PUCHAR SearchBuffer,
-    __in YORI_ALLOC_SIZE_T SearchBufferLength,
-    __out PYORI_ALLOC_SIZE_T FoundOffset
+PUCHAR
+HexEditAllocateSearchChunk(
+    __in PHEXEDIT_CONTEXT HexEditContext,
+    __out PYORI_ALLOC_SIZE_T BufferLength
     )
 {
-    YORI_ALLOC_SIZE_T BufferIndex;
-    YORI_ALLOC_SIZE_T SearchBufferIndex;
-    YORI_ALLOC_SIZE_T EndIndex;
-
-    if (BufferOffset > BufferLength ||
-        BufferLength - BufferOffset < SearchBufferLength) {
+    YORI_MAX_UNSIGNED_T Length;
+    PUCHAR Buffer;
 
-        return FALSE;
+    Length = HEXEDIT_CHUNK_SIZE;
+    Length = Length + HexEditContext->SearchBufferLength - 1;
+    if (!YoriLibIsSizeAllocatable(Length)) {
+        return NULL;
     }
 
-    EndIndex = BufferLength - SearchBufferLength + 1;
-
-    for (BufferIndex = BufferOffset; BufferIndex < EndIndex; BufferIndex++) {
-        for (SearchBufferIndex = 0; SearchBufferIndex < SearchBufferLength; SearchBufferIndex++) {
-            if (Buffer[BufferIndex + SearchBufferIndex] != SearchBuffer[SearchBufferIndex]) {
-                break;
-            }
-        }
-
-        if (SearchBufferIndex == SearchBufferLength) {
-            *FoundOffset = BufferIndex;
-            return TRUE;
-        }
+    Buffer = YoriLibMalloc((YORI_ALLOC_SIZE_T)Length);
+    if (Buffer == NULL) {
+        return NULL;
     }
 
-    return FALSE;
+    *BufferLength = (YORI_ALLOC_SIZE_T)Length;
+    return Buffer;
 }
 
 /**
- Search backward through a memory buffer looking for a matching sub-buffer.
- Both are treated as opaque binary buffers.
-
- @param Buffer Pointer to the master buffer that may contain a match.
+ Find the next search match from a specified byte offset.  The data is
+ searched in chunks, since it may be paged from a file or device and be
+ larger than can be held in memory.
 
- @param BufferLength The length of the master buffer, in bytes.
-
- @param BufferOffset The initial offset to search within the master buffer,
-        in bytes.
-
- @param SearchBuffer Pointer to the buffer to search for.
+ @param HexEditContext Pointer to the hexedit context, implicitly containing
+        the buffer to search.
 
- @param SearchBufferLength The length of the search buffer, in bytes.
+ @param StartOffset The byte offset to search within the buffer.
 
- @param FoundOffset On successful completion (ie., a match is found), updated
-        to point to the offset within the master buffer of the match.
+ @param MatchOffset If a new match is found, updated to contain the offset of
+        the newly found match.
 
  @return TRUE to indicate a match was found, FALSE if no match was found.
  */
 __success(return)
 BOOLEAN
-HexEditFindPreviousMemorySubset(
-    __in PUCHAR Buffer,
-    __in YORI_ALLOC_SIZE_T BufferLength,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
-    __in PUCHAR SearchBuffer,
-    __in YORI_ALLOC_SIZE_T SearchBufferLength,
-    __out PYORI_ALLOC_SIZE_T FoundOffset
+HexEditFindNextFromPosition(
+    __in PHEXEDIT_CONTEXT HexEditContext,
+    __in YORI_MAX_UNSIGNED_T StartOffset,
+    __out PYORI_MAX_UNSIGNED_T MatchOffset
     )
 {
-    YORI_ALLOC_SIZE_T BufferIndex;
-    YORI_ALLOC_SIZE_T SearchBufferIndex;
+    PUCHAR Buffer;
+    YORI_ALLOC_SIZE_T BufferLength;
+    YORI_ALLOC_SIZE_T ReadLength;
+    YORI_ALLOC_SIZE_T FindOffset;
+    YORI_MAX_UNSIGNED_T DataLength;
+    YORI_MAX_UNSIGNED_T ChunkOffset;
+    YORI_ALLOC_SIZE_T SearchLength;
+    BOOLEAN Result;
+
+    DataLength = YoriWinHexEditGetDataLength(HexEditContext->HexEdit);
+    SearchLength = HexEditContext->SearchBufferLength;
+
+    //
+    //  This can happen if the hex edit control contains no data.  In that
+    //  case, no match is found.
+    //
 
-    if (BufferOffset > BufferLength ||
-        BufferLength - BufferOffset < SearchBufferLength) {
+    if (SearchLength == 0 ||
+        StartOffset >= DataLength ||
+        DataLength - StartOffset < SearchLength) {
 
         return FALSE;
     }
 
-    for (BufferIndex = BufferOffset; TRUE; BufferIndex--) {
-        for (SearchBufferIndex = 0; SearchBufferIndex < SearchBufferLength; SearchBufferIndex++) {
-            if (Buffer[BufferIndex + SearchBufferIndex] != SearchBuffer[SearchBufferIndex]) {
-                break;
-            }
-        }
+    Buffer = HexEditAllocateSearchChunk(HexEditContext, &BufferLength);
+    if (Buffer == NULL) {
+        return FALSE;
+    }
 
-        if (SearchBufferIndex == SearchBufferLength) {
-            *FoundOffset = BufferIndex;
-            return TRUE;
+    Result = FALSE;
+    ChunkOffset = StartOffset;
+    while (TRUE) {
+        ReadLength = BufferLength;
+        if (DataLength - ChunkOffset < ReadLength) {
+            ReadLength = (YORI_ALLOC_SIZE_T)(DataLength - ChunkOffset);
         }
 
-        if (BufferIndex == 0) {
+        if (!YoriWinHexEditReadData(HexEditContext->HexEdit, ChunkOffset, Buffer, ReadLength)) {
             break;
         }
-    }
-
-    return FALSE;
-}
 
-/**
- Translate a byte aligned offset into a control buffer offset and bit shift.
- This is necessary because the control can display values of different word
- sizes, which is expressed using a buffer offset to point to the word and
- a bit shift to refer to the digit within the word.  Here we only care about
- being 8 bit aligned (no nibble alignment.)
-
- @param HexEditContext Pointer to the hexedit context, implicitly containing
-        information about the bytes per word.
-
- @param ByteOffset The offset within the buffer, in bytes.
-
- @param BufferOffset On successful completion, updated to point to the
-        beginning of the word within the buffer.
+        if (YoriLibFindNextBytes(Buffer, ReadLength, 0, HexEditContext->SearchBuffer, SearchLength, &FindOffset)) {
+            *MatchOffset = ChunkOffset + FindOffset;
+            Result = TRUE;
+            break;
+        }
 
- @param BitShift On successful completion, updated to indicate the number
-        of bits to shift to point to the digit describing the specified byte.
- */
-VOID
-HexEditByteOffsetToBufferOffsetAndShift(
-    __in PHEXEDIT_CONTEXT HexEditContext,
-    __in YORI_ALLOC_SIZE_T ByteOffset,
-    __out PYORI_ALLOC_SIZE_T BufferOffset,
-    __out PUCHAR BitShift
-    )
-{
-    YORI_ALLOC_SIZE_T LocalBufferOffset;
-    YORI_ALLOC_SIZE_T BytesPerWord;
+        //
+        //  Overlap the next chunk with the end of this one so that a match
+        //  spanning the two is found.
+        //
 
-    BytesPerWord = HexEditContext->BytesPerWord;
-    BytesPerWord = (YORI_ALLOC_SIZE_T)(~(BytesPerWord - 1));
+        if (ChunkOffset + ReadLength >= DataLength) {
+            break;
+        }
+        ChunkOffset = ChunkOffset + ReadLength - (SearchLength - 1);
+    }
 
-    LocalBufferOffset = (YORI_ALLOC_SIZE_T)(ByteOffset & BytesPerWord);
-    *BufferOffset = LocalBufferOffset;
-    *BitShift = (UCHAR)((ByteOffset - LocalBufferOffset) * 8);
+    YoriLibFree(Buffer);
+    return Result;
 }
 
 /**
- Find the next search match from a specified byte offset.
+ Find the previous search match from a specified byte offset.  The data is
+ searched in chunks, since it may be paged from a file or device and be
+ larger than can be held in memory.
 
  @param HexEditContext Pointer to the hexedit context, implicitly containing
         the buffer to search.
 
- @param StartOffset The byte offset to search within the buffer.
+ @param StartOffset The last byte offset that a match may start at.
 
  @param MatchOffset If a new match is found, updated to contain the offset of
         the newly found match.
@@ -1652,40 +1884,72 @@ HexEditByteOffsetToBufferOffsetAndShift(
  */
 __success(return)
 BOOLEAN
-HexEditFindNextFromPosition(
+HexEditFindPreviousFromPosition(
     __in PHEXEDIT_CONTEXT HexEditContext,
-    __in YORI_ALLOC_SIZE_T StartOffset,
-    __out PYORI_ALLOC_SIZE_T MatchOffset
+    __in YORI_MAX_UNSIGNED_T StartOffset,
+    __out PYORI_MAX_UNSIGNED_T MatchOffset
     )
 {
     PUCHAR Buffer;
     YORI_ALLOC_SIZE_T BufferLength;
+    YORI_ALLOC_SIZE_T ReadLength;
     YORI_ALLOC_SIZE_T FindOffset;
+    YORI_MAX_UNSIGNED_T DataLength;
+    YORI_MAX_UNSIGNED_T ChunkOffset;
+    YORI_MAX_UNSIGNED_T ChunkEnd;
+    YORI_ALLOC_SIZE_T SearchLength;
+    BOOLEAN Result;
 
-    YoriWinHexEditGetDataNoCopy(HexEditContext->HexEdit, &Buffer, &BufferLength);
+    DataLength = YoriWinHexEditGetDataLength(HexEditContext->HexEdit);
+    SearchLength = HexEditContext->SearchBufferLength;
 
-    //
-    //  This can happen if the hex edit control contains no data.  In that
-    //  case, no match is found.
-    //
+    if (SearchLength == 0 ||
+        DataLength < SearchLength) {
 
-    if (Buffer == NULL) {
         return FALSE;
     }
 
-    if (StartOffset >= BufferLength) {
-        YoriLibDereference(Buffer);
+    if (StartOffset > DataLength - SearchLength) {
+        StartOffset = DataLength - SearchLength;
+    }
+
+    Buffer = HexEditAllocateSearchChunk(HexEditContext, &BufferLength);
+    if (Buffer == NULL) {
         return FALSE;
     }
 
-    if (HexEditFindNextMemorySubset(Buffer, BufferLength, StartOffset, HexEditContext->SearchBuffer, HexEditContext->SearchBufferLength, &FindOffset)) {
-        *MatchOffset = FindOffset;
-        YoriLibDereference(Buffer);
-        return TRUE;
+    Result = FALSE;
+    ChunkEnd = StartOffset + SearchLength;
+    while (TRUE) {
+        ReadLength = BufferLength;
+        if (ChunkEnd < ReadLength) {
+            ReadLength = (YORI_ALLOC_SIZE_T)ChunkEnd;
+        }
+        ChunkOffset = ChunkEnd - ReadLength;
+
+        if (!YoriWinHexEditReadData(HexEditContext->HexEdit, ChunkOffset, Buffer, ReadLength)) {
+            break;
+        }
+
+        if (YoriLibFindPreviousBytes(Buffer, ReadLength, ReadLength - SearchLength, HexEditContext->SearchBuffer, SearchLength, &FindOffset)) {
+            *MatchOffset = ChunkOffset + FindOffset;
+            Result = TRUE;
+            break;
+        }
+
+        //
+        //  Overlap the previous chunk with the start of this one so that a
+        //  match spanning the two is found.
+        //
+
+        if (ChunkOffset == 0) {
+            break;
+        }
+        ChunkEnd = ChunkOffset + SearchLength - 1;
     }
 
-    YoriLibDereference(Buffer);
-    return FALSE;
+    YoriLibFree(Buffer);
+    return Result;
 }
 
 /**
@@ -1705,8 +1969,8 @@ HexEditFindNextFromCurrentPosition(
     __in BOOLEAN StartAtNextByte
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
-    YORI_ALLOC_SIZE_T FindOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
+    YORI_MAX_UNSIGNED_T FindOffset;
     UCHAR BitShift;
     BOOLEAN AsChar;
 
@@ -1742,47 +2006,30 @@ HexEditFindPreviousFromCurrentPosition(
     __in PHEXEDIT_CONTEXT HexEditContext
     )
 {
-    PUCHAR Buffer;
-    YORI_ALLOC_SIZE_T BufferLength;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     UCHAR BitShift;
     BOOLEAN AsChar;
-    YORI_ALLOC_SIZE_T FindOffset;
-
-    YoriWinHexEditGetDataNoCopy(HexEditContext->HexEdit, &Buffer, &BufferLength);
-
-    //
-    //  This can happen if the hex edit control contains no data.  In that
-    //  case, no match is found.
-    //
-
-    if (Buffer == NULL) {
-        return FALSE;
-    }
+    YORI_MAX_UNSIGNED_T FindOffset;
 
     if (!YoriWinHexEditGetCursorLocation(HexEditContext->HexEdit, &AsChar, &BufferOffset, &BitShift)) {
-        YoriLibDereference(Buffer);
         return FALSE;
     }
 
     BufferOffset = BufferOffset + (BitShift / 8);
 
     if (BufferOffset == 0) {
-        YoriLibDereference(Buffer);
         return FALSE;
     }
 
     BufferOffset = BufferOffset - 1;
 
-    if (HexEditFindPreviousMemorySubset(Buffer, BufferLength, BufferOffset, HexEditContext->SearchBuffer, HexEditContext->SearchBufferLength, &FindOffset)) {
+    if (HexEditFindPreviousFromPosition(HexEditContext, BufferOffset, &FindOffset)) {
         HexEditByteOffsetToBufferOffsetAndShift(HexEditContext, FindOffset, &BufferOffset, &BitShift);
         YoriWinHexEditSetCursorLocation(HexEditContext->HexEdit, FALSE, BufferOffset, BitShift);
         YoriWinHexEditSetSelectionRange(HexEditContext->HexEdit, FindOffset, FindOffset + HexEditContext->SearchBufferLength - 1);
-        YoriLibDereference(Buffer);
         return TRUE;
     }
 
-    YoriLibDereference(Buffer);
     return FALSE;
 }
 
@@ -1945,8 +2192,8 @@ HexEditChangeButtonClicked(
     BOOLEAN AsChar;
     PYORI_WIN_CTRL_HANDLE Parent;
     PHEXEDIT_CONTEXT HexEditContext;
-    YORI_ALLOC_SIZE_T StartOffset;
-    YORI_ALLOC_SIZE_T NextMatchOffset;
+    YORI_MAX_UNSIGNED_T StartOffset;
+    YORI_MAX_UNSIGNED_T NextMatchOffset;
     UCHAR BitShift;
     WORD DialogTop;
 
@@ -2010,10 +2257,10 @@ HexEditChangeButtonClicked(
 
                 COORD WinMgrSize;
                 COORD ClientSize;
-                YORI_ALLOC_SIZE_T CursorLine;
+                YORI_MAX_UNSIGNED_T CursorLine;
                 YORI_ALLOC_SIZE_T CursorOffset;
                 YORI_ALLOC_SIZE_T ViewportLeft;
-                YORI_ALLOC_SIZE_T ViewportTop;
+                YORI_MAX_UNSIGNED_T ViewportTop;
                 WORD DialogHeight;
                 WORD RemainingEditHeight;
 
@@ -2033,7 +2280,7 @@ HexEditChangeButtonClicked(
 
                 RemainingEditHeight = (SHORT)(ClientSize.Y - DialogHeight);
 
-                if (CursorLine > (DWORD)(ViewportTop + RemainingEditHeight - 1)) {
+                if (CursorLine > ViewportTop + RemainingEditHeight - 1) {
                     ViewportTop = CursorLine - (RemainingEditHeight / 2);
                     YoriWinHexEditSetViewportLocation(HexEditContext->HexEdit, ViewportLeft, ViewportTop);
                 }
@@ -2096,8 +2343,26 @@ HexEditChangeButtonClicked(
 
         if (MatchFound) {
             YoriWinHexEditClearSelection(HexEditContext->HexEdit);
-            YoriWinHexEditDeleteData(HexEditContext->HexEdit, StartOffset, OldDataLength);
-            YoriWinHexEditInsertData(HexEditContext->HexEdit, StartOffset, NewData, NewDataLength);
+
+            //
+            //  Replacing data with data of the same length can be done in
+            //  place.  Changing the length requires the data to be held in
+            //  memory, which fails if it is too large.
+            //
+
+            if (OldDataLength == NewDataLength) {
+                if (!YoriWinHexEditReplaceData(HexEditContext->HexEdit, StartOffset, NewData, NewDataLength)) {
+                    break;
+                }
+            } else {
+                if (!YoriWinHexEditDeleteData(HexEditContext->HexEdit, StartOffset, OldDataLength)) {
+                    break;
+                }
+                if (!YoriWinHexEditInsertData(HexEditContext->HexEdit, StartOffset, NewData, NewDataLength)) {
+                    YoriWinHexEditSetModifyState(HexEditContext->HexEdit, TRUE);
+                    break;
+                }
+            }
             YoriWinHexEditSetModifyState(HexEditContext->HexEdit, TRUE);
             StartOffset = StartOffset + NewDataLength;
         }
@@ -2167,7 +2432,7 @@ HexEditGoToButtonClicked(
             NewOffset = (YORI_MAX_UNSIGNED_T)SignedNewOffset;
         }
 
-        YoriWinHexEditSetCursorLocation(HexEditContext->HexEdit, FALSE, (YORI_ALLOC_SIZE_T)NewOffset, 0);
+        YoriWinHexEditSetCursorLocation(HexEditContext->HexEdit, FALSE, NewOffset, 0);
     }
 
     YoriLibFreeStringContents(&Text);
@@ -2428,6 +2693,7 @@ HexEditCalculatePEChecksumButtonClicked(
     YORI_STRING ButtonText[1];
     PYORILIB_PE_HEADERS PeHeaders;
     PUCHAR Buffer;
+    YORI_MAX_UNSIGNED_T DataLength;
     YORI_ALLOC_SIZE_T BufferLength;
     DWORD CurrentChecksum;
     DWORD NewChecksum;
@@ -2455,13 +2721,30 @@ HexEditCalculatePEChecksumButtonClicked(
         return;
     }
 
-    if (!YoriWinHexEditGetDataNoCopy(HexEditContext->HexEdit, &Buffer, &BufferLength)) {
+    //
+    //  The checksum covers the entire image, so it needs to be read into
+    //  memory.
+    //
+
+    DataLength = YoriWinHexEditGetDataLength(HexEditContext->HexEdit);
+    if (DataLength == 0 || !YoriLibIsSizeAllocatable(DataLength)) {
+        return;
+    }
+
+    BufferLength = (YORI_ALLOC_SIZE_T)DataLength;
+    Buffer = YoriLibMalloc(BufferLength);
+    if (Buffer == NULL) {
+        return;
+    }
+
+    if (!YoriWinHexEditReadData(HexEditContext->HexEdit, 0, Buffer, BufferLength)) {
+        YoriLibFree(Buffer);
         return;
     }
 
     PeHeaders = DllImageHlp.pCheckSumMappedFile(Buffer, BufferLength, &CurrentChecksum, &NewChecksum);
     if (PeHeaders == NULL) {
-        YoriLibDereference(Buffer);
+        YoriLibFree(Buffer);
         YoriLibConstantString(&Title, _T("Error"));
         YoriLibConstantString(&Text, _T("Could not calculate checksum.  Possibly not PE file?"));
         YoriLibConstantString(&ButtonText[0], _T("&Ok"));
@@ -2479,7 +2762,7 @@ HexEditCalculatePEChecksumButtonClicked(
 
     DataOffset = (YORI_ALLOC_SIZE_T)((PUCHAR)PeHeaders - Buffer);
     DataOffset = DataOffset + FIELD_OFFSET(YORILIB_PE_HEADERS, OptionalHeader.CheckSum);
-    YoriLibDereference(Buffer);
+    YoriLibFree(Buffer);
     YoriWinHexEditReplaceData(HexEditContext->HexEdit, DataOffset, &NewChecksum, sizeof(NewChecksum));
 }
 
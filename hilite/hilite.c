@@ -151,6 +151,28 @@ typedef struct _HILITE_CONTEXT {
      */
     YORI_LIST_ENTRY EndMatches;
 
+    /**
+     The number of elements in MiddleStrings and MiddleCriteria.
+     */
+    YORI_ALLOC_SIZE_T MiddleCount;
+
+    /**
+     An array of strings to search for within lines, corresponding to the
+     entries in MiddleMatches.
+     */
+    PYORI_STRING MiddleStrings;
+
+    /**
+     An array of pointers to the criteria for each entry in MiddleStrings.
+     */
+    PHILITE_MATCH_CRITERIA *MiddleCriteria;
+
+    /**
+     A matcher that can search for all of MiddleStrings in a single pass
+     over each line.
+     */
+    YORI_LIB_MULTI_MATCH MiddleMatcher;
+
 } HILITE_CONTEXT, *PHILITE_CONTEXT;
 
 /**
@@ -220,6 +242,120 @@ HiliteGetNextMatch(
     return NULL;
 }
 
+/**
+ Prepare to search for all of the matches that can occur in the middle of a
+ line at once, so that each line only needs to be searched once regardless
+ of the number of criteria.
+
+ @param HiliteContext Pointer to the context.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+HiliteCompileMiddleMatches(
+    __in PHILITE_CONTEXT HiliteContext
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PHILITE_MATCH_CRITERIA MatchCriteria;
+    YORI_ALLOC_SIZE_T Count;
+
+    Count = 0;
+    ListEntry = YoriLibGetNextListEntry(&HiliteContext->MiddleMatches, NULL);
+    while (ListEntry != NULL) {
+        Count++;
+        ListEntry = YoriLibGetNextListEntry(&HiliteContext->MiddleMatches, ListEntry);
+    }
+
+    if (Count == 0) {
+        return TRUE;
+    }
+
+    HiliteContext->MiddleStrings = YoriLibMalloc((YORI_ALLOC_SIZE_T)(Count * (sizeof(YORI_STRING) + sizeof(PHILITE_MATCH_CRITERIA))));
+    if (HiliteContext->MiddleStrings == NULL) {
+        return FALSE;
+    }
+    HiliteContext->MiddleCriteria = (PHILITE_MATCH_CRITERIA *)&HiliteContext->MiddleStrings[Count];
+
+    //
+    //  When highlighting text, an empty string can never be highlighted, so
+    //  don't search for it.
+    //
+
+    Count = 0;
+    ListEntry = YoriLibGetNextListEntry(&HiliteContext->MiddleMatches, NULL);
+    while (ListEntry != NULL) {
+        MatchCriteria = CONTAINING_RECORD(ListEntry, HILITE_MATCH_CRITERIA, ListEntry);
+        if (!HiliteContext->HighlightMatchText ||
+            MatchCriteria->MatchString.LengthInChars > 0) {
+
+            YoriLibInitEmptyString(&HiliteContext->MiddleStrings[Count]);
+            HiliteContext->MiddleStrings[Count].StartOfString = MatchCriteria->MatchString.StartOfString;
+            HiliteContext->MiddleStrings[Count].LengthInChars = MatchCriteria->MatchString.LengthInChars;
+            HiliteContext->MiddleCriteria[Count] = MatchCriteria;
+            Count++;
+        }
+        ListEntry = YoriLibGetNextListEntry(&HiliteContext->MiddleMatches, ListEntry);
+    }
+
+    HiliteContext->MiddleCount = Count;
+    if (!YoriLibMultiMatchInitialize(&HiliteContext->MiddleMatcher,
+                                     HiliteContext->MiddleCount,
+                                     HiliteContext->MiddleStrings,
+                                     HiliteContext->Insensitive)) {
+        YoriLibFree(HiliteContext->MiddleStrings);
+        HiliteContext->MiddleStrings = NULL;
+        HiliteContext->MiddleCriteria = NULL;
+        HiliteContext->MiddleCount = 0;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Search a string for all of the matches that can occur in the middle of a
+ line.
+
+ @param HiliteContext Pointer to the context.
+
+ @param Substring The string to search.
+
+ @param MatchOffset On successful completion, updated to contain the offset
+        of the match within Substring.
+
+ @return Pointer to the criteria that matched, or NULL if no criteria
+         matched.  When highlighting text, this is the criteria that matched
+         earliest in the string; when highlighting lines, this is the first
+         criteria that matched anywhere in the string.
+ */
+PHILITE_MATCH_CRITERIA
+HiliteFindMiddleMatch(
+    __in PHILITE_CONTEXT HiliteContext,
+    __in PYORI_STRING Substring,
+    __out PYORI_ALLOC_SIZE_T MatchOffset
+    )
+{
+    PYORI_STRING FoundString;
+
+    if (HiliteContext->MiddleCount == 0) {
+        return NULL;
+    }
+
+    if (HiliteContext->HighlightMatchText) {
+        FoundString = YoriLibMultiMatchFindFirst(&HiliteContext->MiddleMatcher, Substring, MatchOffset);
+    } else {
+        FoundString = YoriLibMultiMatchFindAny(&HiliteContext->MiddleMatcher, Substring, MatchOffset);
+    }
+
+    if (FoundString == NULL) {
+        return NULL;
+    }
+
+    return HiliteContext->MiddleCriteria[FoundString - HiliteContext->MiddleStrings];
+}
+
 /**
  Process a stream and apply the hilite criteria before outputting to standard
  output.
@@ -243,6 +379,7 @@ HiliteProcessStream(
     YORI_STRING Substring;
     YORI_STRING DisplayString;
     PHILITE_MATCH_CRITERIA MatchCriteria;
+    PHILITE_MATCH_CRITERIA FoundCriteria;
     PHILITE_MATCH_CRITERIA BestMatchCriteria;
     YORI_ALLOC_SIZE_T BestMatchOffset;
     YORILIB_COLOR_ATTRIBUTES ColorToUse;
@@ -290,6 +427,7 @@ HiliteProcessStream(
             MatchCriteria = HiliteGetNextMatch(HiliteContext, &ListHead, MatchCriteria);
             while (MatchCriteria != NULL) {
                 MatchFound = FALSE;
+                FoundCriteria = MatchCriteria;
                 if (MatchCriteria->MatchType == HiliteMatchTypeBeginsWith) {
                     if (HiliteContext->Insensitive) {
                         if (YoriLibCompareStringInsCnt(&Substring,
@@ -327,15 +465,19 @@ HiliteProcessStream(
                         }
                     }
                 } else if (MatchCriteria->MatchType == HiliteMatchTypeContains) {
-                    if (HiliteContext->Insensitive) {
-                        if (YoriLibFindFirstMatchSubstrIns(&Substring, 1, &MatchCriteria->MatchString, &MatchOffset)) {
-                            MatchFound = TRUE;
-                        }
-                    } else {
-                        if (YoriLibFindFirstMatchSubstr(&Substring, 1, &MatchCriteria->MatchString, &MatchOffset)) {
-                            MatchFound = TRUE;
-                        }
+
+                    //
+                    //  All of the matches in the middle of the line are
+                    //  searched for together, so move on to the matches at
+                    //  the end of the line afterwards.
+                    //
+
+                    FoundCriteria = HiliteFindMiddleMatch(HiliteContext, &Substring, &MatchOffset);
+                    if (FoundCriteria != NULL) {
+                        MatchFound = TRUE;
                     }
+                    ListHead = &HiliteContext->EndMatches;
+                    MatchCriteria = NULL;
                 }
 
 
@@ -349,14 +491,14 @@ HiliteProcessStream(
                 if (MatchFound) {
 
                     if (!HiliteContext->HighlightMatchText) {
-                        BestMatchCriteria = MatchCriteria;
+                        BestMatchCriteria = FoundCriteria;
                         BestMatchOffset = MatchOffset;
                         break;
                     }
 
-                    if (MatchCriteria->MatchString.LengthInChars > 0 &&
+                    if (FoundCriteria->MatchString.LengthInChars > 0 &&
                         (BestMatchCriteria == NULL || MatchOffset < BestMatchOffset)) {
-                        BestMatchCriteria = MatchCriteria;
+                        BestMatchCriteria = FoundCriteria;
                         BestMatchOffset = MatchOffset;
                     }
                 }
@@ -573,6 +715,14 @@ HiliteCleanupContext(
     PHILITE_MATCH_CRITERIA NextMatchCriteria;
     PYORI_LIST_ENTRY ListHead;
 
+    if (HiliteContext->MiddleStrings != NULL) {
+        YoriLibMultiMatchCleanup(&HiliteContext->MiddleMatcher);
+        YoriLibFree(HiliteContext->MiddleStrings);
+        HiliteContext->MiddleStrings = NULL;
+        HiliteContext->MiddleCriteria = NULL;
+        HiliteContext->MiddleCount = 0;
+    }
+
     ListHead = &HiliteContext->StartMatches;
 
     MatchCriteria = HiliteGetNextMatch(HiliteContext, &ListHead, NULL);
@@ -738,6 +888,12 @@ ENTRYPOINT(
 
     YoriLibEnableBackupPrivilege();
 
+    if (!HiliteCompileMiddleMatches(&HiliteContext)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("hilite: out of memory\n"));
+        HiliteCleanupContext(&HiliteContext);
+        return EXIT_FAILURE;
+    }
+
     //
     //  If no file name is specified, use stdin; otherwise open
     //  the file and use that
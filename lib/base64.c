@@ -0,0 +1,726 @@
+/**
+ * @file lib/base64.c
+ *
+ * Yori streaming base64 encode and decode routines
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "yoripch.h"
+#include "yorilib.h"
+
+/**
+ Indicates whether this compiler can generate SSSE3 instructions through
+ intrinsics.  The instructions are only executed if the processor is found
+ to support them at runtime, which requires the compiler to support CPUID
+ intrinsics as well.
+ */
+#if defined(_MSC_VER) && (_MSC_VER >= 1900) && (defined(_M_AMD64) || defined(_M_IX86))
+#define YORI_LIB_BASE64_SSSE3 1
+#include <tmmintrin.h>
+#else
+#define YORI_LIB_BASE64_SSSE3 0
+#endif
+
+/**
+ The characters used to encode each six bit value.
+ */
+CONST UCHAR YoriLibBase64EncodeTable[64] = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+    'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+    'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+};
+
+/**
+ A value in YoriLibBase64DecodeTable indicating a character that is not
+ valid in base64 input.
+ */
+#define YORI_LIB_BASE64_INVALID    0xFF
+
+/**
+ A value in YoriLibBase64DecodeTable indicating a whitespace character that
+ is ignored.
+ */
+#define YORI_LIB_BASE64_WHITESPACE 0xFE
+
+/**
+ A value in YoriLibBase64DecodeTable indicating the padding character.
+ */
+#define YORI_LIB_BASE64_PADDING    0xFD
+
+/**
+ The six bit value for each input character, or one of the special values
+ above.
+ */
+CONST UCHAR YoriLibBase64DecodeTable[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfe, 0xff, 0xff, 0xfe, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xfd, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+#if YORI_LIB_BASE64_SSSE3
+
+/**
+ Encode 12 bytes into 16 characters using SSSE3 instructions.  This reads
+ 16 bytes from the source, so the caller must ensure that many bytes are
+ accessible even though only 12 are encoded.
+
+ The bytes are first arranged so each 32 bit lane contains one group of
+ three bytes, then the four six bit values in each lane are moved into
+ their own byte with multiplies.  Each value is converted to a character by
+ adding an offset that depends on which range of the alphabet it falls in.
+
+ @param Source Pointer to the bytes to encode.
+
+ @param Dest Pointer to a buffer to receive 16 characters.
+ */
+VOID
+YoriLibBase64EncodeBlockSsse3(
+    __in PUCHAR Source,
+    __out_ecount(16) PUCHAR Dest
+    )
+{
+    __m128i Input;
+    __m128i High;
+    __m128i Low;
+    __m128i Indices;
+    __m128i Result;
+    __m128i Less;
+
+    Input = _mm_loadu_si128((__m128i const *)Source);
+    Input = _mm_shuffle_epi8(Input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+    High = _mm_and_si128(Input, _mm_set1_epi32(0x0fc0fc00));
+    High = _mm_mulhi_epu16(High, _mm_set1_epi32(0x04000040));
+    Low = _mm_and_si128(Input, _mm_set1_epi32(0x003f03f0));
+    Low = _mm_mullo_epi16(Low, _mm_set1_epi32(0x01000010));
+    Indices = _mm_or_si128(High, Low);
+
+    //
+    //  Values 0-25 map to offset 13 in the table below, values 26-51 to
+    //  offset 0, and values 52-63 to offsets 1-12.
+    //
+
+    Result = _mm_subs_epu8(Indices, _mm_set1_epi8(51));
+    Less = _mm_cmpgt_epi8(_mm_set1_epi8(26), Indices);
+    Result = _mm_or_si128(Result, _mm_and_si128(Less, _mm_set1_epi8(13)));
+    Result = _mm_shuffle_epi8(_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                            '/' - 63, 'A', 0, 0),
+                              Result);
+    Result = _mm_add_epi8(Result, Indices);
+
+    _mm_storeu_si128((__m128i *)Dest, Result);
+}
+
+/**
+ Decode 16 characters into 12 bytes using SSSE3 instructions.  If any of the
+ characters are not part of the base64 alphabet, including whitespace and
+ padding, nothing is written and the caller is expected to process the
+ characters individually.
+
+ Each character is classified by looking up its high and low nibbles in two
+ tables whose bits only overlap for invalid characters.  Valid characters
+ are converted to their six bit value by adding an offset selected by the
+ high nibble, then four values are combined into three bytes with
+ multiplies.
+
+ @param Source Pointer to the characters to decode.
+
+ @param Dest Pointer to a buffer to receive 12 bytes.
+
+ @return TRUE if the characters were decoded, FALSE if they contain a
+         character that is not part of the base64 alphabet.
+ */
+BOOL
+YoriLibBase64DecodeBlockSsse3(
+    __in PUCHAR Source,
+    __out_ecount(12) PUCHAR Dest
+    )
+{
+    __m128i Input;
+    __m128i HighNibble;
+    __m128i LowNibble;
+    __m128i LowClass;
+    __m128i HighClass;
+    __m128i EqualsSlash;
+    __m128i Roll;
+    __m128i Values;
+    __m128i Merged;
+    __m128i Output;
+    UCHAR Buffer[16];
+
+    Input = _mm_loadu_si128((__m128i const *)Source);
+    HighNibble = _mm_and_si128(_mm_srli_epi32(Input, 4), _mm_set1_epi8(0x0f));
+    LowNibble = _mm_and_si128(Input, _mm_set1_epi8(0x0f));
+
+    LowClass = _mm_shuffle_epi8(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                              0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a),
+                                LowNibble);
+    HighClass = _mm_shuffle_epi8(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                               0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10),
+                                 HighNibble);
+
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(LowClass, HighClass), _mm_setzero_si128())) != 0) {
+        return FALSE;
+    }
+
+    EqualsSlash = _mm_cmpeq_epi8(Input, _mm_set1_epi8('/'));
+    Roll = _mm_shuffle_epi8(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                          0, 0, 0, 0, 0, 0, 0, 0),
+                            _mm_add_epi8(EqualsSlash, HighNibble));
+    Values = _mm_add_epi8(Input, Roll);
+
+    Merged = _mm_maddubs_epi16(Values, _mm_set1_epi32(0x01400140));
+    Output = _mm_madd_epi16(Merged, _mm_set1_epi32(0x00011000));
+    Output = _mm_shuffle_epi8(Output, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    _mm_storeu_si128((__m128i *)Buffer, Output);
+    memcpy(Dest, Buffer, 12);
+    return TRUE;
+}
+
+#endif
+
+/**
+ Encode a single group of three bytes into four characters.
+
+ @param Source Pointer to the bytes to encode.
+
+ @param Dest Pointer to a buffer to receive four characters.
+ */
+VOID
+YoriLibBase64EncodeGroup(
+    __in PUCHAR Source,
+    __out_ecount(4) PUCHAR Dest
+    )
+{
+    DWORD Value;
+
+    Value = (Source[0] << 16) | (Source[1] << 8) | Source[2];
+    Dest[0] = YoriLibBase64EncodeTable[(Value >> 18) & 0x3f];
+    Dest[1] = YoriLibBase64EncodeTable[(Value >> 12) & 0x3f];
+    Dest[2] = YoriLibBase64EncodeTable[(Value >> 6) & 0x3f];
+    Dest[3] = YoriLibBase64EncodeTable[Value & 0x3f];
+}
+
+/**
+ Encode a run of complete groups of three bytes without line breaks.
+
+ @param Encoder Pointer to the encoder, which indicates whether SSSE3
+        instructions can be used.
+
+ @param Source Pointer to the bytes to encode.
+
+ @param SourceLength The number of bytes to encode.  This must be a multiple
+        of three.
+
+ @param SourceAvailable The number of bytes that can be read from Source,
+        which may be larger than SourceLength.  Vectorized encoding reads
+        beyond the bytes it encodes.
+
+ @param Dest Pointer to a buffer to receive the characters.
+
+ @return The number of characters written.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibBase64EncodeRun(
+    __in PYORI_LIB_BASE64_ENCODER Encoder,
+    __in PUCHAR Source,
+    __in YORI_ALLOC_SIZE_T SourceLength,
+    __in YORI_ALLOC_SIZE_T SourceAvailable,
+    __out PUCHAR Dest
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T CharsWritten;
+
+    ASSERT((SourceLength % 3) == 0);
+    ASSERT(SourceAvailable >= SourceLength);
+
+    Index = 0;
+    CharsWritten = 0;
+
+#if YORI_LIB_BASE64_SSSE3
+    if (Encoder->UseSsse3) {
+        while (Index + 12 <= SourceLength && Index + 16 <= SourceAvailable) {
+            YoriLibBase64EncodeBlockSsse3(&Source[Index], &Dest[CharsWritten]);
+            Index = Index + 12;
+            CharsWritten = CharsWritten + 16;
+        }
+    }
+#else
+    UNREFERENCED_PARAMETER(Encoder);
+    UNREFERENCED_PARAMETER(SourceAvailable);
+#endif
+
+    while (Index < SourceLength) {
+        YoriLibBase64EncodeGroup(&Source[Index], &Dest[CharsWritten]);
+        Index = Index + 3;
+        CharsWritten = CharsWritten + 4;
+    }
+
+    return CharsWritten;
+}
+
+/**
+ Initialize a base64 encoder.
+
+ @param Encoder Pointer to the encoder to initialize.
+
+ @param LineLength The number of characters to output before each line
+        break, which must be a multiple of four.  If zero, no line breaks are
+        output.
+ */
+VOID
+YoriLibBase64EncodeInitialize(
+    __out PYORI_LIB_BASE64_ENCODER Encoder,
+    __in YORI_ALLOC_SIZE_T LineLength
+    )
+{
+    ASSERT((LineLength % 4) == 0);
+
+    ZeroMemory(Encoder, sizeof(YORI_LIB_BASE64_ENCODER));
+    Encoder->LineLength = LineLength;
+#if YORI_LIB_BASE64_SSSE3
+    Encoder->UseSsse3 = YoriLibIsSsse3Available();
+#endif
+}
+
+/**
+ Return the largest number of characters that can be written by a single
+ call to YoriLibBase64EncodeUpdate or YoriLibBase64EncodeFinalize.
+
+ @param Encoder Pointer to the encoder.
+
+ @param SourceLength The number of bytes to be encoded.
+
+ @return The number of characters that the output buffer must hold.
+ */
+YORI_MAX_UNSIGNED_T
+YoriLibBase64EncodeMaximumOutput(
+    __in PYORI_LIB_BASE64_ENCODER Encoder,
+    __in YORI_ALLOC_SIZE_T SourceLength
+    )
+{
+    YORI_MAX_UNSIGNED_T Chars;
+
+    Chars = (((YORI_MAX_UNSIGNED_T)SourceLength + 2) / 3 + 1) * 4;
+    if (Encoder->LineLength != 0) {
+        Chars = Chars + (Chars / Encoder->LineLength + 1) * 2;
+    }
+
+    return Chars;
+}
+
+/**
+ Record that a number of characters have been output on the current line,
+ and output a line break if the line is complete.
+
+ @param Encoder Pointer to the encoder.
+
+ @param CharsAdded The number of characters output on the current line.
+
+ @param Dest Pointer to the location to write a line break to.
+
+ @return The number of characters written.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibBase64EncodeAdvanceLine(
+    __inout PYORI_LIB_BASE64_ENCODER Encoder,
+    __in YORI_ALLOC_SIZE_T CharsAdded,
+    __out_ecount(2) PUCHAR Dest
+    )
+{
+    if (Encoder->LineLength == 0) {
+        return 0;
+    }
+
+    Encoder->CharsThisLine = Encoder->CharsThisLine + CharsAdded;
+    if (Encoder->CharsThisLine < Encoder->LineLength) {
+        return 0;
+    }
+
+    Encoder->CharsThisLine = 0;
+    Dest[0] = '\r';
+    Dest[1] = '\n';
+    return 2;
+}
+
+/**
+ Encode a chunk of data.  Data that does not complete a group of three bytes
+ is retained by the encoder and encoded along with the next chunk or when
+ the encoder is finalized.
+
+ @param Encoder Pointer to the encoder.
+
+ @param Source Pointer to the bytes to encode.
+
+ @param SourceLength The number of bytes to encode.
+
+ @param Dest Pointer to a buffer to receive the characters.  This must be at
+        least as large as indicated by YoriLibBase64EncodeMaximumOutput.
+
+ @return The number of characters written.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibBase64EncodeUpdate(
+    __inout PYORI_LIB_BASE64_ENCODER Encoder,
+    __in PUCHAR Source,
+    __in YORI_ALLOC_SIZE_T SourceLength,
+    __out PUCHAR Dest
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T CharsWritten;
+    YORI_ALLOC_SIZE_T BytesPerLine;
+    YORI_ALLOC_SIZE_T RunLength;
+
+    Index = 0;
+    CharsWritten = 0;
+
+    //
+    //  Complete any group left over from the previous chunk.
+    //
+
+    if (Encoder->PendingLength > 0) {
+        while (Encoder->PendingLength < 3 && Index < SourceLength) {
+            Encoder->Pending[Encoder->PendingLength] = Source[Index];
+            Encoder->PendingLength++;
+            Index++;
+        }
+
+        if (Encoder->PendingLength < 3) {
+            return 0;
+        }
+
+        YoriLibBase64EncodeGroup(Encoder->Pending, Dest);
+        CharsWritten = 4;
+        CharsWritten = CharsWritten + YoriLibBase64EncodeAdvanceLine(Encoder, 4, &Dest[CharsWritten]);
+        Encoder->PendingLength = 0;
+    }
+
+    //
+    //  Encode whole lines at a time where possible, and single groups
+    //  otherwise.  Without line breaks, everything is one run.
+    //
+
+    BytesPerLine = Encoder->LineLength / 4 * 3;
+    while (SourceLength - Index >= 3) {
+        if (Encoder->LineLength == 0) {
+            RunLength = (SourceLength - Index) / 3 * 3;
+            CharsWritten = CharsWritten + YoriLibBase64EncodeRun(Encoder, &Source[Index], RunLength, SourceLength - Index, &Dest[CharsWritten]);
+            Index = Index + RunLength;
+        } else if (Encoder->CharsThisLine == 0 && SourceLength - Index >= BytesPerLine) {
+            CharsWritten = CharsWritten + YoriLibBase64EncodeRun(Encoder, &Source[Index], BytesPerLine, SourceLength - Index, &Dest[CharsWritten]);
+            Index = Index + BytesPerLine;
+            Dest[CharsWritten] = '\r';
+            Dest[CharsWritten + 1] = '\n';
+            CharsWritten = CharsWritten + 2;
+        } else {
+            YoriLibBase64EncodeGroup(&Source[Index], &Dest[CharsWritten]);
+            Index = Index + 3;
+            CharsWritten = CharsWritten + 4;
+            CharsWritten = CharsWritten + YoriLibBase64EncodeAdvanceLine(Encoder, 4, &Dest[CharsWritten]);
+        }
+    }
+
+    while (Index < SourceLength) {
+        Encoder->Pending[Encoder->PendingLength] = Source[Index];
+        Encoder->PendingLength++;
+        Index++;
+    }
+
+    return CharsWritten;
+}
+
+/**
+ Complete encoding, writing any retained bytes with padding and terminating
+ the final line.
+
+ @param Encoder Pointer to the encoder.
+
+ @param Dest Pointer to a buffer to receive the characters.  This must be at
+        least as large as indicated by YoriLibBase64EncodeMaximumOutput for
+        a zero length source.
+
+ @return The number of characters written.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibBase64EncodeFinalize(
+    __inout PYORI_LIB_BASE64_ENCODER Encoder,
+    __out PUCHAR Dest
+    )
+{
+    YORI_ALLOC_SIZE_T CharsWritten;
+
+    CharsWritten = 0;
+    if (Encoder->PendingLength > 0) {
+        if (Encoder->PendingLength == 1) {
+            Encoder->Pending[1] = 0;
+        }
+        Encoder->Pending[2] = 0;
+        YoriLibBase64EncodeGroup(Encoder->Pending, Dest);
+        Dest[3] = '=';
+        if (Encoder->PendingLength == 1) {
+            Dest[2] = '=';
+        }
+        CharsWritten = 4;
+        Encoder->PendingLength = 0;
+        Encoder->CharsThisLine = Encoder->CharsThisLine + 4;
+    }
+
+    if (Encoder->LineLength != 0 && Encoder->CharsThisLine > 0) {
+        Dest[CharsWritten] = '\r';
+        Dest[CharsWritten + 1] = '\n';
+        CharsWritten = CharsWritten + 2;
+        Encoder->CharsThisLine = 0;
+    }
+
+    return CharsWritten;
+}
+
+/**
+ Initialize a base64 decoder.
+
+ @param Decoder Pointer to the decoder to initialize.
+ */
+VOID
+YoriLibBase64DecodeInitialize(
+    __out PYORI_LIB_BASE64_DECODER Decoder
+    )
+{
+    ZeroMemory(Decoder, sizeof(YORI_LIB_BASE64_DECODER));
+#if YORI_LIB_BASE64_SSSE3
+    Decoder->UseSsse3 = YoriLibIsSsse3Available();
+#endif
+}
+
+/**
+ Return the largest number of bytes that can be written by a single call to
+ YoriLibBase64DecodeUpdate or YoriLibBase64DecodeFinalize.
+
+ @param SourceLength The number of characters to be decoded.
+
+ @return The number of bytes that the output buffer must hold.
+ */
+YORI_MAX_UNSIGNED_T
+YoriLibBase64DecodeMaximumOutput(
+    __in YORI_ALLOC_SIZE_T SourceLength
+    )
+{
+    return (((YORI_MAX_UNSIGNED_T)SourceLength + 3) / 4 + 1) * 3;
+}
+
+/**
+ Decode a chunk of characters.  Whitespace is ignored, and characters that
+ do not complete a group of four are retained by the decoder and decoded
+ along with the next chunk or when the decoder is finalized.
+
+ @param Decoder Pointer to the decoder.
+
+ @param Source Pointer to the characters to decode.
+
+ @param SourceLength The number of characters to decode.
+
+ @param Dest Pointer to a buffer to receive the bytes.  This must be at
+        least as large as indicated by YoriLibBase64DecodeMaximumOutput.
+
+ @param BytesWritten On successful completion, updated to contain the number
+        of bytes written.
+
+ @return TRUE to indicate success, FALSE if the characters are not valid
+         base64.
+ */
+__success(return)
+BOOL
+YoriLibBase64DecodeUpdate(
+    __inout PYORI_LIB_BASE64_DECODER Decoder,
+    __in PUCHAR Source,
+    __in YORI_ALLOC_SIZE_T SourceLength,
+    __out PUCHAR Dest,
+    __out PYORI_ALLOC_SIZE_T BytesWritten
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Written;
+    DWORD Value;
+    DWORD Values[4];
+    UCHAR Char;
+
+    Index = 0;
+    Written = 0;
+
+    while (Index < SourceLength) {
+
+        //
+        //  When at the start of a group, attempt to decode a block at once,
+        //  or failing that a single group of four characters.  These fail
+        //  on any whitespace or padding, which is then handled one
+        //  character at a time.
+        //
+
+        if (Decoder->CharsAccumulated == 0 && !Decoder->PaddingFound) {
+#if YORI_LIB_BASE64_SSSE3
+            if (Decoder->UseSsse3 &&
+                SourceLength - Index >= 16 &&
+                YoriLibBase64DecodeBlockSsse3(&Source[Index], &Dest[Written])) {
+
+                Index = Index + 16;
+                Written = Written + 12;
+                continue;
+            }
+#endif
+            if (SourceLength - Index >= 4) {
+                Values[0] = YoriLibBase64DecodeTable[Source[Index]];
+                Values[1] = YoriLibBase64DecodeTable[Source[Index + 1]];
+                Values[2] = YoriLibBase64DecodeTable[Source[Index + 2]];
+                Values[3] = YoriLibBase64DecodeTable[Source[Index + 3]];
+
+                //
+                //  Valid characters have values below 64, and all special
+                //  values have the high bits set.
+                //
+
+                if (((Values[0] | Values[1] | Values[2] | Values[3]) & 0xC0) == 0) {
+                    Value = (Values[0] << 18) | (Values[1] << 12) | (Values[2] << 6) | Values[3];
+                    Dest[Written] = (UCHAR)(Value >> 16);
+                    Dest[Written + 1] = (UCHAR)(Value >> 8);
+                    Dest[Written + 2] = (UCHAR)Value;
+                    Index = Index + 4;
+                    Written = Written + 3;
+                    continue;
+                }
+            }
+        }
+
+        Char = YoriLibBase64DecodeTable[Source[Index]];
+        Index++;
+
+        if (Char < 64) {
+            if (Decoder->PaddingFound) {
+                return FALSE;
+            }
+            Decoder->Accumulator = (Decoder->Accumulator << 6) | Char;
+            Decoder->CharsAccumulated++;
+            if (Decoder->CharsAccumulated == 4) {
+                Dest[Written] = (UCHAR)(Decoder->Accumulator >> 16);
+                Dest[Written + 1] = (UCHAR)(Decoder->Accumulator >> 8);
+                Dest[Written + 2] = (UCHAR)Decoder->Accumulator;
+                Written = Written + 3;
+                Decoder->Accumulator = 0;
+                Decoder->CharsAccumulated = 0;
+            }
+        } else if (Char == YORI_LIB_BASE64_WHITESPACE) {
+            continue;
+        } else if (Char == YORI_LIB_BASE64_PADDING) {
+
+            //
+            //  The first padding character completes a group of two or
+            //  three characters.  Any further padding is ignored.
+            //
+
+            if (!Decoder->PaddingFound) {
+                if (Decoder->CharsAccumulated < 2) {
+                    return FALSE;
+                }
+                if (Decoder->CharsAccumulated == 2) {
+                    Dest[Written] = (UCHAR)(Decoder->Accumulator >> 4);
+                    Written = Written + 1;
+                } else {
+                    Dest[Written] = (UCHAR)(Decoder->Accumulator >> 10);
+                    Dest[Written + 1] = (UCHAR)(Decoder->Accumulator >> 2);
+                    Written = Written + 2;
+                }
+                Decoder->Accumulator = 0;
+                Decoder->CharsAccumulated = 0;
+                Decoder->PaddingFound = TRUE;
+            }
+        } else {
+            return FALSE;
+        }
+    }
+
+    *BytesWritten = Written;
+    return TRUE;
+}
+
+/**
+ Complete decoding, writing any bytes from a final group that was not
+ padded.
+
+ @param Decoder Pointer to the decoder.
+
+ @param Dest Pointer to a buffer to receive the bytes.  This must be at
+        least as large as indicated by YoriLibBase64DecodeMaximumOutput for
+        a zero length source.
+
+ @param BytesWritten On successful completion, updated to contain the number
+        of bytes written.
+
+ @return TRUE to indicate success, FALSE if the characters are not valid
+         base64.
+ */
+__success(return)
+BOOL
+YoriLibBase64DecodeFinalize(
+    __inout PYORI_LIB_BASE64_DECODER Decoder,
+    __out PUCHAR Dest,
+    __out PYORI_ALLOC_SIZE_T BytesWritten
+    )
+{
+    YORI_ALLOC_SIZE_T Written;
+
+    Written = 0;
+    if (Decoder->CharsAccumulated == 1) {
+        return FALSE;
+    } else if (Decoder->CharsAccumulated == 2) {
+        Dest[0] = (UCHAR)(Decoder->Accumulator >> 4);
+        Written = 1;
+    } else if (Decoder->CharsAccumulated == 3) {
+        Dest[0] = (UCHAR)(Decoder->Accumulator >> 10);
+        Dest[1] = (UCHAR)(Decoder->Accumulator >> 2);
+        Written = 2;
+    }
+
+    Decoder->Accumulator = 0;
+    Decoder->CharsAccumulated = 0;
+    *BytesWritten = Written;
+    return TRUE;
+}
+
+// vim:sw=4:ts=4:et:
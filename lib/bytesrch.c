@@ -0,0 +1,448 @@
+/**
+ * @file lib/bytesrch.c
+ *
+ * Yori binary buffer search routines
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "yoripch.h"
+#include "yorilib.h"
+
+/**
+ Indicates whether this compiler can generate SSE2 instructions through
+ intrinsics.  The instructions are only executed if the processor is found
+ to support them at runtime.
+ */
+#if defined(_MSC_VER) && (_MSC_VER >= 1400) && (defined(_M_AMD64) || defined(_M_IX86))
+#define YORI_LIB_BYTE_SEARCH_SSE2 1
+#include <emmintrin.h>
+#else
+#define YORI_LIB_BYTE_SEARCH_SSE2 0
+#endif
+
+/**
+ The length of a search buffer at which a Horspool search is used in
+ preference to a vector search.  Horspool can advance by up to the length of
+ the search buffer on each comparison, so for long search buffers it can
+ outperform examining 16 positions at a time.
+ */
+#define YORI_LIB_BYTE_SEARCH_HORSPOOL_THRESHOLD 16
+
+/**
+ Search forward through a memory buffer for a matching sub-buffer using the
+ Boyer-Moore-Horspool algorithm.  The caller is expected to have validated
+ that the search buffer fits within the buffer from the initial offset.
+
+ @param Buffer Pointer to the buffer that may contain a match.
+
+ @param BufferLength The length of the buffer, in bytes.
+
+ @param BufferOffset The first offset that a match may start at.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.  This
+        must be nonzero.
+
+ @param FoundOffset On successful completion, updated to contain the offset
+        of the match.
+
+ @return TRUE to indicate a match was found, FALSE if no match was found.
+ */
+__success(return)
+BOOLEAN
+YoriLibFindNextBytesHorspool(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    )
+{
+    YORI_ALLOC_SIZE_T Skip[256];
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T LastIndex;
+    UCHAR LastChar;
+    UCHAR Char;
+
+    for (Index = 0; Index < sizeof(Skip)/sizeof(Skip[0]); Index++) {
+        Skip[Index] = SearchBufferLength;
+    }
+
+    for (Index = 0; Index < SearchBufferLength - 1; Index++) {
+        Skip[SearchBuffer[Index]] = SearchBufferLength - 1 - Index;
+    }
+
+    LastChar = SearchBuffer[SearchBufferLength - 1];
+    LastIndex = BufferLength - SearchBufferLength;
+    Index = BufferOffset;
+
+    while (Index <= LastIndex) {
+        Char = Buffer[Index + SearchBufferLength - 1];
+        if (Char == LastChar &&
+            memcmp(&Buffer[Index], SearchBuffer, SearchBufferLength - 1) == 0) {
+
+            *FoundOffset = Index;
+            return TRUE;
+        }
+
+        if (LastIndex - Index < Skip[Char]) {
+            break;
+        }
+        Index = Index + Skip[Char];
+    }
+
+    return FALSE;
+}
+
+/**
+ Search backward through a memory buffer for a matching sub-buffer using
+ the Boyer-Moore-Horspool algorithm applied in reverse, where the shift is
+ determined by the first byte of each candidate rather than the last.  The
+ caller is expected to have validated that the search buffer fits within the
+ buffer from the initial offset.
+
+ @param Buffer Pointer to the buffer that may contain a match.
+
+ @param BufferOffset The last offset that a match may start at.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.  This
+        must be nonzero.
+
+ @param FoundOffset On successful completion, updated to contain the offset
+        of the match.
+
+ @return TRUE to indicate a match was found, FALSE if no match was found.
+ */
+__success(return)
+BOOLEAN
+YoriLibFindPreviousBytesHorspool(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    )
+{
+    YORI_ALLOC_SIZE_T Skip[256];
+    YORI_ALLOC_SIZE_T Index;
+    UCHAR FirstChar;
+    UCHAR Char;
+
+    for (Index = 0; Index < sizeof(Skip)/sizeof(Skip[0]); Index++) {
+        Skip[Index] = SearchBufferLength;
+    }
+
+    for (Index = SearchBufferLength - 1; Index > 0; Index--) {
+        Skip[SearchBuffer[Index]] = Index;
+    }
+
+    FirstChar = SearchBuffer[0];
+    Index = BufferOffset;
+
+    while (TRUE) {
+        Char = Buffer[Index];
+        if (Char == FirstChar &&
+            memcmp(&Buffer[Index + 1], &SearchBuffer[1], SearchBufferLength - 1) == 0) {
+
+            *FoundOffset = Index;
+            return TRUE;
+        }
+
+        if (Index < Skip[Char]) {
+            break;
+        }
+        Index = Index - Skip[Char];
+    }
+
+    return FALSE;
+}
+
+#if YORI_LIB_BYTE_SEARCH_SSE2
+/**
+ Search forward through a memory buffer for a matching sub-buffer, using
+ SSE2 to find positions where both the first and last bytes of the search
+ buffer match 16 positions at a time, and only comparing the remainder of
+ the search buffer at those positions.  Any tail too small for a vector is
+ searched with Horspool.  The caller is expected to have checked that the
+ processor supports SSE2.
+
+ @param Buffer Pointer to the buffer that may contain a match.
+
+ @param BufferLength The length of the buffer, in bytes.
+
+ @param BufferOffset The first offset that a match may start at.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.  This
+        must be nonzero.
+
+ @param FoundOffset On successful completion, updated to contain the offset
+        of the match.
+
+ @return TRUE to indicate a match was found, FALSE if no match was found.
+ */
+__success(return)
+BOOLEAN
+YoriLibFindNextBytesSse2(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Bit;
+    YORI_ALLOC_SIZE_T LastOffset;
+    __m128i First;
+    __m128i Last;
+    __m128i FirstChunk;
+    __m128i LastChunk;
+    int Mask;
+
+    First = _mm_set1_epi8((char)SearchBuffer[0]);
+    Last = _mm_set1_epi8((char)SearchBuffer[SearchBufferLength - 1]);
+    LastOffset = SearchBufferLength - 1;
+    Index = BufferOffset;
+
+    while (BufferLength - Index >= LastOffset + sizeof(__m128i)) {
+        FirstChunk = _mm_loadu_si128((__m128i *)&Buffer[Index]);
+        LastChunk = _mm_loadu_si128((__m128i *)&Buffer[Index + LastOffset]);
+        Mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(FirstChunk, First),
+                                               _mm_cmpeq_epi8(LastChunk, Last)));
+        for (Bit = 0; Mask != 0; Bit++, Mask = Mask >> 1) {
+            if ((Mask & 1) != 0 &&
+                (SearchBufferLength <= 2 ||
+                 memcmp(&Buffer[Index + Bit + 1], &SearchBuffer[1], SearchBufferLength - 2) == 0)) {
+
+                *FoundOffset = Index + Bit;
+                return TRUE;
+            }
+        }
+        Index = Index + (YORI_ALLOC_SIZE_T)sizeof(__m128i);
+    }
+
+    if (BufferLength - Index < SearchBufferLength) {
+        return FALSE;
+    }
+
+    return YoriLibFindNextBytesHorspool(Buffer, BufferLength, Index, SearchBuffer, SearchBufferLength, FoundOffset);
+}
+
+/**
+ Search backward through a memory buffer for a matching sub-buffer, using
+ SSE2 to find positions where both the first and last bytes of the search
+ buffer match 16 positions at a time, and only comparing the remainder of
+ the search buffer at those positions.  Any region at the start of the
+ buffer too small for a vector is searched with Horspool.  The caller is
+ expected to have checked that the processor supports SSE2.
+
+ @param Buffer Pointer to the buffer that may contain a match.
+
+ @param BufferOffset The last offset that a match may start at.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.  This
+        must be nonzero.
+
+ @param FoundOffset On successful completion, updated to contain the offset
+        of the match.
+
+ @return TRUE to indicate a match was found, FALSE if no match was found.
+ */
+__success(return)
+BOOLEAN
+YoriLibFindPreviousBytesSse2(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T End;
+    YORI_ALLOC_SIZE_T Bit;
+    YORI_ALLOC_SIZE_T LastOffset;
+    __m128i First;
+    __m128i Last;
+    __m128i FirstChunk;
+    __m128i LastChunk;
+    int Mask;
+
+    First = _mm_set1_epi8((char)SearchBuffer[0]);
+    Last = _mm_set1_epi8((char)SearchBuffer[SearchBufferLength - 1]);
+    LastOffset = SearchBufferLength - 1;
+
+    //
+    //  End is one beyond the last position that a match may start at.
+    //  Each vector examines the 16 positions immediately before End.
+    //
+
+    End = BufferOffset + 1;
+
+    while (End >= sizeof(__m128i)) {
+        Index = End - (YORI_ALLOC_SIZE_T)sizeof(__m128i);
+        FirstChunk = _mm_loadu_si128((__m128i *)&Buffer[Index]);
+        LastChunk = _mm_loadu_si128((__m128i *)&Buffer[Index + LastOffset]);
+        Mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(FirstChunk, First),
+                                               _mm_cmpeq_epi8(LastChunk, Last)));
+        for (Bit = sizeof(__m128i); Mask != 0; Bit--) {
+            if ((Mask & (1 << (Bit - 1))) != 0) {
+                if (SearchBufferLength <= 2 ||
+                    memcmp(&Buffer[Index + Bit], &SearchBuffer[1], SearchBufferLength - 2) == 0) {
+
+                    *FoundOffset = Index + Bit - 1;
+                    return TRUE;
+                }
+                Mask = Mask & ~(1 << (Bit - 1));
+            }
+        }
+        End = Index;
+    }
+
+    if (End == 0) {
+        return FALSE;
+    }
+
+    return YoriLibFindPreviousBytesHorspool(Buffer, End - 1, SearchBuffer, SearchBufferLength, FoundOffset);
+}
+#endif
+
+/**
+ Search forward through a memory buffer looking for a matching sub-buffer.
+ Both are treated as opaque binary buffers.  This uses vector instructions
+ to filter candidate positions if the processor supports them, and a
+ Boyer-Moore-Horspool search for long search buffers or if the processor
+ does not.
+
+ @param Buffer Pointer to the buffer that may contain a match.
+
+ @param BufferLength The length of the buffer, in bytes.
+
+ @param BufferOffset The initial offset to search within the buffer, in
+        bytes.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.
+
+ @param FoundOffset On successful completion (ie., a match is found), updated
+        to point to the offset within the buffer of the match.
+
+ @return TRUE to indicate a match was found, FALSE if no match was found.
+ */
+__success(return)
+BOOLEAN
+YoriLibFindNextBytes(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    )
+{
+    if (SearchBufferLength == 0 ||
+        BufferOffset > BufferLength ||
+        BufferLength - BufferOffset < SearchBufferLength) {
+
+        return FALSE;
+    }
+
+#if YORI_LIB_BYTE_SEARCH_SSE2
+    if (SearchBufferLength < YORI_LIB_BYTE_SEARCH_HORSPOOL_THRESHOLD &&
+        YoriLibIsSse2Available()) {
+
+        return YoriLibFindNextBytesSse2(Buffer, BufferLength, BufferOffset, SearchBuffer, SearchBufferLength, FoundOffset);
+    }
+#endif
+
+    return YoriLibFindNextBytesHorspool(Buffer, BufferLength, BufferOffset, SearchBuffer, SearchBufferLength, FoundOffset);
+}
+
+/**
+ Search backward through a memory buffer looking for a matching sub-buffer.
+ Both are treated as opaque binary buffers.  The match returned is the one
+ starting closest to, but not after, the initial offset.  This uses vector
+ instructions to filter candidate positions if the processor supports them,
+ and a reverse Boyer-Moore-Horspool search for long search buffers or if the
+ processor does not.
+
+ @param Buffer Pointer to the buffer that may contain a match.
+
+ @param BufferLength The length of the buffer, in bytes.
+
+ @param BufferOffset The initial offset to search within the buffer, in
+        bytes.  If a match could not start at this offset because it would
+        extend beyond the end of the buffer, the search starts from the last
+        offset where a match could start.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.
+
+ @param FoundOffset On successful completion (ie., a match is found), updated
+        to point to the offset within the buffer of the match.
+
+ @return TRUE to indicate a match was found, FALSE if no match was found.
+ */
+__success(return)
+BOOLEAN
+YoriLibFindPreviousBytes(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    )
+{
+    if (SearchBufferLength == 0 ||
+        BufferLength < SearchBufferLength) {
+
+        return FALSE;
+    }
+
+    if (BufferOffset > BufferLength - SearchBufferLength) {
+        BufferOffset = BufferLength - SearchBufferLength;
+    }
+
+#if YORI_LIB_BYTE_SEARCH_SSE2
+    if (SearchBufferLength < YORI_LIB_BYTE_SEARCH_HORSPOOL_THRESHOLD &&
+        YoriLibIsSse2Available()) {
+
+        return YoriLibFindPreviousBytesSse2(Buffer, BufferOffset, SearchBuffer, SearchBufferLength, FoundOffset);
+    }
+#endif
+
+    return YoriLibFindPreviousBytesHorspool(Buffer, BufferOffset, SearchBuffer, SearchBufferLength, FoundOffset);
+}
+
+// vim:sw=4:ts=4:et:
@@ -282,6 +282,43 @@ YoriCallClearHistoryStrings(VOID)
     return pYoriApiClearHistoryStrings();
 }
 
+/**
+ Prototype for the @ref YoriApiClearPathCache function.
+ */
+typedef BOOL YORI_API_CLEAR_PATH_CACHE(VOID);
+
+/**
+ Prototype for a pointer to the @ref YoriApiClearPathCache function.
+ */
+typedef YORI_API_CLEAR_PATH_CACHE *PYORI_API_CLEAR_PATH_CACHE;
+
+/**
+ Pointer to the @ref YoriApiClearPathCache function.
+ */
+PYORI_API_CLEAR_PATH_CACHE pYoriApiClearPathCache;
+
+/**
+ Discard all cached knowledge of executables found in the path.
+
+ @return TRUE if the cache was cleared, FALSE if not.
+ */
+__success(return)
+BOOL
+YoriCallClearPathCache(VOID)
+{
+    if (pYoriApiClearPathCache == NULL) {
+        HMODULE hYori;
+
+        hYori = GetModuleHandle(NULL);
+        __analysis_assume(hYori != NULL);
+        pYoriApiClearPathCache = (PYORI_API_CLEAR_PATH_CACHE)GetProcAddress(hYori, "YoriApiClearPathCache");
+        if (pYoriApiClearPathCache == NULL) {
+            return FALSE;
+        }
+    }
+    return pYoriApiClearPathCache();
+}
+
 /**
  Prototype for the @ref YoriApiDecrementPromptRecursionDepth function.
  */
@@ -985,6 +1022,51 @@ YoriCallGetNextJobId(
     return pYoriApiGetNextJobId(PreviousJobId);
 }
 
+/**
+ Prototype for the @ref YoriApiGetPathCacheStrings function.
+ */
+typedef BOOL YORI_API_GET_PATH_CACHE_STRINGS(PYORI_STRING);
+
+/**
+ Prototype for a pointer to the @ref YoriApiGetPathCacheStrings function.
+ */
+typedef YORI_API_GET_PATH_CACHE_STRINGS *PYORI_API_GET_PATH_CACHE_STRINGS;
+
+/**
+ Pointer to the @ref YoriApiGetPathCacheStrings function.
+ */
+PYORI_API_GET_PATH_CACHE_STRINGS pYoriApiGetPathCacheStrings;
+
+/**
+ Build the set of commands that the shell has resolved to executables in
+ the path into an array of NULL terminated strings in command=path form,
+ terminated by an additional NULL terminator.  The result must be freed
+ with a subsequent call to @ref YoriCallFreeYoriString .
+
+ @param CommandStrings On successful completion, populated with the set of
+        command strings.
+
+ @return Return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriCallGetPathCacheStrings(
+    __out PYORI_STRING CommandStrings
+    )
+{
+    if (pYoriApiGetPathCacheStrings == NULL) {
+        HMODULE hYori;
+
+        hYori = GetModuleHandle(NULL);
+        __analysis_assume(hYori != NULL);
+        pYoriApiGetPathCacheStrings = (PYORI_API_GET_PATH_CACHE_STRINGS)GetProcAddress(hYori, "YoriApiGetPathCacheStrings");
+        if (pYoriApiGetPathCacheStrings == NULL) {
+            return FALSE;
+        }
+    }
+    return pYoriApiGetPathCacheStrings(CommandStrings);
+}
+
 /**
  Prototype for the @ref YoriApiGetSystemAliasStrings function.
  */
@@ -27,6 +27,163 @@
 #include "yoripch.h"
 #include "yorilib.h"
 
+/**
+ Indicates whether this compiler can query processor features with the
+ CPUID instruction through intrinsics.  This is only needed for features
+ that the compiler can generate code for, which currently means SSSE3 and
+ the SHA extensions.
+ */
+#if defined(_MSC_VER) && (_MSC_VER >= 1900) && (defined(_M_AMD64) || defined(_M_IX86))
+#define YORI_LIB_CPUID_AVAILABLE 1
+#include <intrin.h>
+#else
+#define YORI_LIB_CPUID_AVAILABLE 0
+#endif
+
+/**
+ Set to TRUE once the processor has been queried for SSE2 support.
+ */
+BOOLEAN YoriLibSse2Queried;
+
+/**
+ Set to TRUE if the processor has been found to support SSE2.  Only
+ meaningful if YoriLibSse2Queried is TRUE.
+ */
+BOOLEAN YoriLibSse2Present;
+
+/**
+ Returns TRUE if the processor can execute SSE2 instructions.  On AMD64 this
+ is part of the architecture and is always available.  On 32 bit x86 the
+ system is asked once and the result is cached, and if the system is too old
+ to answer, SSE2 is assumed to be unavailable.  Other architectures never
+ report SSE2 support.
+
+ @return TRUE if SSE2 instructions can be used, FALSE if they cannot.
+ */
+BOOLEAN
+YoriLibIsSse2Available(VOID)
+{
+#if defined(_M_AMD64)
+    return TRUE;
+#elif defined(_M_IX86)
+    if (!YoriLibSse2Queried) {
+        YoriLibSse2Present = FALSE;
+        if (DllKernel32.pIsProcessorFeaturePresent != NULL &&
+            DllKernel32.pIsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE)) {
+
+            YoriLibSse2Present = TRUE;
+        }
+        YoriLibSse2Queried = TRUE;
+    }
+    return YoriLibSse2Present;
+#else
+    return FALSE;
+#endif
+}
+
+/**
+ Set to TRUE once the processor has been queried for SSSE3 support.
+ */
+BOOLEAN YoriLibSsse3Queried;
+
+/**
+ Set to TRUE if the processor has been found to support SSSE3.  Only
+ meaningful if YoriLibSsse3Queried is TRUE.
+ */
+BOOLEAN YoriLibSsse3Present;
+
+/**
+ Returns TRUE if the processor can execute SSSE3 instructions.  The
+ processor is asked once and the result is cached.  These instructions
+ operate on XMM registers, so the operating system is required to support
+ SSE2 as well.
+
+ @return TRUE if SSSE3 instructions can be used, FALSE if they cannot.
+ */
+BOOLEAN
+YoriLibIsSsse3Available(VOID)
+{
+#if YORI_LIB_CPUID_AVAILABLE
+    int CpuInfo[4];
+
+    if (!YoriLibSsse3Queried) {
+        YoriLibSsse3Present = FALSE;
+        if (YoriLibIsSse2Available()) {
+
+            //
+            //  Leaf 1 ECX bit 9 is SSSE3.
+            //
+
+            __cpuid(CpuInfo, 1);
+            if ((CpuInfo[2] & (1 << 9)) != 0) {
+                YoriLibSsse3Present = TRUE;
+            }
+        }
+        YoriLibSsse3Queried = TRUE;
+    }
+    return YoriLibSsse3Present;
+#else
+    return FALSE;
+#endif
+}
+
+/**
+ Set to TRUE once the processor has been queried for SHA extension support.
+ */
+BOOLEAN YoriLibShaExtensionQueried;
+
+/**
+ Set to TRUE if the processor has been found to support SHA extensions.
+ Only meaningful if YoriLibShaExtensionQueried is TRUE.
+ */
+BOOLEAN YoriLibShaExtensionPresent;
+
+/**
+ Returns TRUE if the processor can execute the SHA extension instructions,
+ along with the SSSE3 and SSE4.1 instructions used to arrange data for them.
+ The processor is asked once and the result is cached.  These instructions
+ operate on XMM registers, so the operating system is required to support
+ SSE2 as well.
+
+ @return TRUE if SHA extension instructions can be used, FALSE if they
+         cannot.
+ */
+BOOLEAN
+YoriLibIsShaExtensionAvailable(VOID)
+{
+#if YORI_LIB_CPUID_AVAILABLE
+    int CpuInfo[4];
+
+    if (!YoriLibShaExtensionQueried) {
+        YoriLibShaExtensionPresent = FALSE;
+        if (YoriLibIsSse2Available()) {
+            __cpuid(CpuInfo, 0);
+            if (CpuInfo[0] >= 7) {
+
+                //
+                //  Leaf 1 ECX bit 9 is SSSE3 and bit 19 is SSE4.1.  Leaf 7
+                //  EBX bit 29 is the SHA extensions.
+                //
+
+                __cpuid(CpuInfo, 1);
+                if ((CpuInfo[2] & (1 << 9)) != 0 &&
+                    (CpuInfo[2] & (1 << 19)) != 0) {
+
+                    __cpuidex(CpuInfo, 7, 0);
+                    if ((CpuInfo[1] & (1 << 29)) != 0) {
+                        YoriLibShaExtensionPresent = TRUE;
+                    }
+                }
+            }
+        }
+        YoriLibShaExtensionQueried = TRUE;
+    }
+    return YoriLibShaExtensionPresent;
+#else
+    return FALSE;
+#endif
+}
+
 
 /**
  Query the system to find the number of high performance and high efficiency
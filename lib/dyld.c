@@ -208,6 +208,7 @@ CONST YORI_DLL_NAME_MAP DllKernel32Symbols[] = {
     {(FARPROC *)&DllKernel32.pGlobalSize, "GlobalSize"},
     {(FARPROC *)&DllKernel32.pGlobalUnlock, "GlobalUnlock"},
     {(FARPROC *)&DllKernel32.pInterlockedCompareExchange, "InterlockedCompareExchange"},
+    {(FARPROC *)&DllKernel32.pIsProcessorFeaturePresent, "IsProcessorFeaturePresent"},
     {(FARPROC *)&DllKernel32.pIsWow64Process, "IsWow64Process"},
     {(FARPROC *)&DllKernel32.pIsWow64Process2, "IsWow64Process2"},
     {(FARPROC *)&DllKernel32.pLoadLibraryW, "LoadLibraryW"},
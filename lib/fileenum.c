@@ -89,49 +89,903 @@ typedef struct _YORILIB_FOREACHFILE_CONTEXT {
      */
     WIN32_FIND_DATA FileInfo;
 
+    /**
+     When performing an ordered parallel enumerate, points to a listing of
+     the directory that was read ahead of time, either by a worker thread
+     or by this thread for the purpose of finding subdirectories to
+     prefetch.  NULL if results are being returned from FindFirstFile.
+     */
+    struct _YORILIB_FOREACHFILE_LISTING *Listing;
+
+    /**
+     The index of the next entry to return from Listing.
+     */
+    YORI_ALLOC_SIZE_T ListingIndex;
+
+    /**
+     A list of listings that have been requested for subdirectories of this
+     directory, in the order that the subdirectories will be recursed into.
+     */
+    YORI_LIST_ENTRY PrefetchList;
+
 } YORILIB_FOREACHFILE_CONTEXT, *PYORILIB_FOREACHFILE_CONTEXT;
 
 /**
- If a string contains a directory that ends with a seperator, and it's not
- referring to a drive root, remove the seperator.
+ The maximum number of threads to use for a parallel enumerate.
+ */
+#define YORILIB_FOREACHFILE_MAX_THREADS 32
+
+/**
+ The maximum number of directory listings that can be held in memory at
+ any time when performing an ordered parallel enumerate.  Once this many
+ are outstanding, further directories are enumerated by the calling
+ thread when they are reached.
+ */
+#define YORILIB_FOREACHFILE_MAX_LISTINGS 256
+
+/**
+ The maximum number of entries to hold in a single directory listing.
+ Directories larger than this are enumerated by the calling thread via
+ FindFirstFile when they are reached, so memory consumption is bounded.
+ */
+#define YORILIB_FOREACHFILE_MAX_LISTING_ENTRIES 0x4000
+
+/**
+ A directory listing has been queued for a worker thread but no thread has
+ started reading it.
+ */
+#define YORILIB_FOREACHFILE_LISTING_PENDING  0
+
+/**
+ A worker thread is currently reading a directory listing.
+ */
+#define YORILIB_FOREACHFILE_LISTING_RUNNING  1
+
+/**
+ A directory listing has been fully read, or reading it has failed.
+ */
+#define YORILIB_FOREACHFILE_LISTING_COMPLETE 2
+
+/**
+ The complete contents of a directory, read in advance of the point where
+ the directory would be enumerated in depth first order.
+ */
+typedef struct _YORILIB_FOREACHFILE_LISTING {
+
+    /**
+     The links of this listing on the list of work for worker threads.
+     This is only meaningful while State is
+     YORILIB_FOREACHFILE_LISTING_PENDING.
+     */
+    YORI_LIST_ENTRY PendingList;
+
+    /**
+     The links of this listing on the parent directory's list of requested
+     listings.
+     */
+    YORI_LIST_ENTRY PrefetchList;
+
+    /**
+     The search criteria to pass to FindFirstFile.
+     */
+    YORI_STRING SearchPath;
+
+    /**
+     An event which is signalled once the listing is complete.
+     */
+    HANDLE CompleteEvent;
+
+    /**
+     Pointer to an array of entries found in the directory.
+     */
+    PWIN32_FIND_DATA Entries;
+
+    /**
+     The number of elements allocated in the Entries array.
+     */
+    YORI_ALLOC_SIZE_T EntriesAllocated;
+
+    /**
+     The number of elements populated in the Entries array.
+     */
+    YORI_ALLOC_SIZE_T EntryCount;
+
+    /**
+     The index of the entry within the parent's listing that this listing
+     describes.
+     */
+    YORI_ALLOC_SIZE_T ParentIndex;
+
+    /**
+     The error that prevented the listing from being read, or ERROR_SUCCESS
+     if the listing is valid.
+     */
+    SYSERR Error;
+
+    /**
+     One of the YORILIB_FOREACHFILE_LISTING_ values.
+     */
+    UCHAR State;
+
+    /**
+     Set to TRUE if the listing is no longer wanted by the time a worker
+     thread completes it, indicating that the worker thread should free it.
+     */
+    BOOLEAN Abandoned;
+
+} YORILIB_FOREACHFILE_LISTING, *PYORILIB_FOREACHFILE_LISTING;
+
+/**
+ A directory that needs to be enumerated by a worker thread when performing
+ an unordered parallel enumerate.
+ */
+typedef struct _YORILIB_FOREACHFILE_WORK_ITEM {
+
+    /**
+     The links of this item on the list of work for worker threads.
+     */
+    YORI_LIST_ENTRY PendingList;
+
+    /**
+     The criteria to enumerate.
+     */
+    YORI_STRING FileSpec;
+
+    /**
+     The recursion depth of the criteria.
+     */
+    DWORD Depth;
+
+} YORILIB_FOREACHFILE_WORK_ITEM, *PYORILIB_FOREACHFILE_WORK_ITEM;
+
+/**
+ State shared between all threads participating in a parallel enumerate.
+ */
+typedef struct _YORILIB_FOREACHFILE_PARALLEL {
+
+    /**
+     A mutex to synchronize access to the pending list and counters.
+     */
+    HANDLE Mutex;
+
+    /**
+     A semaphore which is released once for each item added to the pending
+     list.
+     */
+    HANDLE WorkerWaitSemaphore;
+
+    /**
+     A manual reset event which is set to indicate worker threads should
+     terminate.
+     */
+    HANDLE WorkerShutdownEvent;
+
+    /**
+     A manual reset event which is set when no work items are outstanding
+     in an unordered enumerate.
+     */
+    HANDLE AllCompleteEvent;
+
+    /**
+     A list of work that has not yet been started.  In an unordered
+     enumerate, this is a list of YORILIB_FOREACHFILE_WORK_ITEM structures.
+     In an ordered enumerate, it is a list of YORILIB_FOREACHFILE_LISTING
+     structures.
+     */
+    YORI_LIST_ENTRY PendingList;
+
+    /**
+     The number of work items which have been queued and not yet completed
+     in an unordered enumerate.
+     */
+    DWORD ItemsOutstanding;
+
+    /**
+     The number of directory listings currently allocated in an ordered
+     enumerate.
+     */
+    DWORD ListingsAllocated;
+
+    /**
+     The number of worker threads created.
+     */
+    DWORD ThreadsAllocated;
+
+    /**
+     Handles to the worker threads.
+     */
+    HANDLE Threads[YORILIB_FOREACHFILE_MAX_THREADS];
+
+    /**
+     The flags describing the enumerate.
+     */
+    WORD MatchFlags;
+
+    /**
+     TRUE if callbacks are invoked by any thread as soon as objects are
+     found.  FALSE if worker threads only read directories and callbacks
+     are invoked by the calling thread in depth first order.
+     */
+    BOOLEAN Unordered;
+
+    /**
+     Set to TRUE if any callback has failed, indicating that outstanding
+     work should be discarded.
+     */
+    BOOLEAN Aborted;
+
+    /**
+     The callback to invoke on each match.
+     */
+    PYORILIB_FILE_ENUM_FN Callback;
+
+    /**
+     Optionally points to a function to invoke if a directory cannot be
+     enumerated.
+     */
+    PYORILIB_FILE_ENUM_ERROR_FN ErrorCallback;
+
+    /**
+     Caller provided context to pass to the callbacks.
+     */
+    PVOID Context;
+
+} YORILIB_FOREACHFILE_PARALLEL, *PYORILIB_FOREACHFILE_PARALLEL;
+
+/**
+ If a string contains a directory that ends with a seperator, and it's not
+ referring to a drive root, remove the seperator.
+
+ This can be thought of as a mini version of @ref YoriLibFindEffRoot .
+ Unlike that function, this one has to run on purely relative paths that
+ haven't been converted to their full form, where seperators could go
+ either way, where relative components are still present.  Also, it doesn't
+ need to deal with UNC paths because a share and a root are equivalent;
+ there's no concept of "current directory on UNC share" which is the meaning
+ if a trailing seperator is removed from a drive.
+
+ @param String The string to inspect and potentially trim if a trailing
+        seperator is present.
+ */
+VOID
+YoriLibTruncateTrailingSeperatorIfBenign(
+    __inout PYORI_STRING String
+    )
+{
+    //
+    //  Trim trailing slashes, except if the string is just a slash, or if
+    //  the slash follows a drive letter and colon, in which case it's
+    //  meaningful.
+    //
+
+    if (String->LengthInChars > 1 &&
+        YoriLibIsSep(String->StartOfString[String->LengthInChars - 1])) {
+
+        if (YoriLibIsPfxDrvLetterColonSlash(String)) {
+            if (String->LengthInChars >= sizeof("\\\\?\\c:\\")) {
+                String->LengthInChars--;
+            }
+        } else if (YoriLibIsDrvLetterColonSlash(String)) {
+            if (String->LengthInChars >= sizeof("c:\\")) {
+                String->LengthInChars--;
+            }
+        } else {
+            String->LengthInChars--;
+        }
+    }
+}
+
+/**
+ Return TRUE if an object found by enumerate is a directory that would be
+ recursed into, given the specified match flags.
+
+ @param MatchFlags Specifies the behavior of the match.
+
+ @param FileInfo Pointer to the object found by enumerate.
+
+ @return TRUE if the object would be recursed into, FALSE if not.
+ */
+BOOLEAN
+YoriLibForEachFileIsTraversable(
+    __in WORD MatchFlags,
+    __in PWIN32_FIND_DATA FileInfo
+    )
+{
+    if ((FileInfo->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+        return FALSE;
+    }
+
+    if (_tcscmp(FileInfo->cFileName, _T(".")) == 0 ||
+        _tcscmp(FileInfo->cFileName, _T("..")) == 0) {
+        return FALSE;
+    }
+
+    if ((MatchFlags & YORILIB_ENUM_NO_LINK_TRAVERSE) != 0 &&
+        (FileInfo->dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0 &&
+        (FileInfo->dwReserved0 == IO_REPARSE_TAG_MOUNT_POINT ||
+         FileInfo->dwReserved0 == IO_REPARSE_TAG_SYMLINK)) {
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Read the complete contents of a directory into a listing.  On failure,
+ the error is recorded in the listing, and the caller is expected to
+ enumerate the directory via FindFirstFile instead.  This means a listing
+ that cannot be read never changes the results of an enumerate, it only
+ fails to make it faster.
+
+ @param Listing Pointer to the listing to populate.  The SearchPath member
+        is expected to be initialized on entry.
+ */
+VOID
+YoriLibForEachFileReadListing(
+    __inout PYORILIB_FOREACHFILE_LISTING Listing
+    )
+{
+    HANDLE hFind;
+    PWIN32_FIND_DATA NewEntries;
+    YORI_ALLOC_SIZE_T NewEntriesAllocated;
+
+    Listing->Error = ERROR_SUCCESS;
+    Listing->EntryCount = 0;
+
+    if (Listing->Entries == NULL) {
+        Listing->Entries = YoriLibMalloc(64 * sizeof(WIN32_FIND_DATA));
+        if (Listing->Entries == NULL) {
+            Listing->Error = ERROR_NOT_ENOUGH_MEMORY;
+            return;
+        }
+        Listing->EntriesAllocated = 64;
+    }
+
+    hFind = FindFirstFile(Listing->SearchPath.StartOfString, &Listing->Entries[0]);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        Listing->Error = GetLastError();
+        return;
+    }
+
+    Listing->EntryCount = 1;
+
+    while (TRUE) {
+        if (Listing->EntryCount >= Listing->EntriesAllocated) {
+            if (Listing->EntriesAllocated >= YORILIB_FOREACHFILE_MAX_LISTING_ENTRIES) {
+                Listing->Error = ERROR_NOT_ENOUGH_MEMORY;
+                break;
+            }
+
+            NewEntriesAllocated = Listing->EntriesAllocated * 2;
+            NewEntries = YoriLibMalloc((YORI_ALLOC_SIZE_T)(NewEntriesAllocated * sizeof(WIN32_FIND_DATA)));
+            if (NewEntries == NULL) {
+                Listing->Error = ERROR_NOT_ENOUGH_MEMORY;
+                break;
+            }
+
+            memcpy(NewEntries, Listing->Entries, Listing->EntryCount * sizeof(WIN32_FIND_DATA));
+            YoriLibFree(Listing->Entries);
+            Listing->Entries = NewEntries;
+            Listing->EntriesAllocated = NewEntriesAllocated;
+        }
+
+        if (!FindNextFile(hFind, &Listing->Entries[Listing->EntryCount])) {
+            break;
+        }
+        Listing->EntryCount++;
+    }
+
+    FindClose(hFind);
+}
+
+/**
+ Allocate a directory listing for a specified search criteria.  The
+ listing is not populated by this function.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param SearchPath Pointer to the search criteria to pass to FindFirstFile.
+
+ @param Prefetch If TRUE, the listing is being allocated to be populated by
+        a worker thread, so requires an event to indicate completion.
+
+ @return Pointer to the listing, or NULL on allocation failure.
+ */
+PYORILIB_FOREACHFILE_LISTING
+YoriLibForEachFileAllocateListing(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORI_STRING SearchPath,
+    __in BOOLEAN Prefetch
+    )
+{
+    PYORILIB_FOREACHFILE_LISTING Listing;
+
+    Listing = YoriLibMalloc(sizeof(YORILIB_FOREACHFILE_LISTING));
+    if (Listing == NULL) {
+        return NULL;
+    }
+
+    ZeroMemory(Listing, sizeof(YORILIB_FOREACHFILE_LISTING));
+    if (!YoriLibAllocateString(&Listing->SearchPath, SearchPath->LengthInChars + 1)) {
+        YoriLibFree(Listing);
+        return NULL;
+    }
+
+    memcpy(Listing->SearchPath.StartOfString, SearchPath->StartOfString, SearchPath->LengthInChars * sizeof(TCHAR));
+    Listing->SearchPath.LengthInChars = SearchPath->LengthInChars;
+    Listing->SearchPath.StartOfString[Listing->SearchPath.LengthInChars] = '\0';
+
+    if (Prefetch) {
+        Listing->CompleteEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if (Listing->CompleteEvent == NULL) {
+            YoriLibFreeStringContents(&Listing->SearchPath);
+            YoriLibFree(Listing);
+            return NULL;
+        }
+    }
+
+    Listing->State = YORILIB_FOREACHFILE_LISTING_PENDING;
+
+    WaitForSingleObject(Parallel->Mutex, INFINITE);
+    Parallel->ListingsAllocated++;
+    ReleaseMutex(Parallel->Mutex);
+
+    return Listing;
+}
+
+/**
+ Free a directory listing.  The caller is expected to ensure that no other
+ thread is referencing it.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param Listing Pointer to the listing to free.
+ */
+VOID
+YoriLibForEachFileFreeListing(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORILIB_FOREACHFILE_LISTING Listing
+    )
+{
+    if (Listing->Entries != NULL) {
+        YoriLibFree(Listing->Entries);
+    }
+    if (Listing->CompleteEvent != NULL) {
+        CloseHandle(Listing->CompleteEvent);
+    }
+    YoriLibFreeStringContents(&Listing->SearchPath);
+    YoriLibFree(Listing);
+
+    WaitForSingleObject(Parallel->Mutex, INFINITE);
+    ASSERT(Parallel->ListingsAllocated > 0);
+    Parallel->ListingsAllocated--;
+    ReleaseMutex(Parallel->Mutex);
+}
+
+/**
+ Indicate that a directory listing is no longer needed.  If a worker thread
+ has not started reading it, it is removed from the queue and freed.  If a
+ worker thread is reading it, the worker thread will free it on completion.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param Listing Pointer to the listing.  If NULL, this function has no
+        effect.
+ */
+VOID
+YoriLibForEachFileReleaseListing(
+    __in_opt PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in_opt PYORILIB_FOREACHFILE_LISTING Listing
+    )
+{
+    if (Listing == NULL) {
+        return;
+    }
+
+    ASSERT(Parallel != NULL);
+    __analysis_assume(Parallel != NULL);
+
+    WaitForSingleObject(Parallel->Mutex, INFINITE);
+    if (Listing->State == YORILIB_FOREACHFILE_LISTING_RUNNING) {
+        Listing->Abandoned = TRUE;
+        ReleaseMutex(Parallel->Mutex);
+        return;
+    }
+
+    if (Listing->State == YORILIB_FOREACHFILE_LISTING_PENDING) {
+        YoriLibRemoveListItem(&Listing->PendingList);
+    }
+    ReleaseMutex(Parallel->Mutex);
+
+    YoriLibForEachFileFreeListing(Parallel, Listing);
+}
+
+/**
+ Wait for a directory listing to be complete.  If no worker thread has
+ started reading it, it is read on the calling thread rather than waiting
+ for a worker thread to become available.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param Listing Pointer to the listing.
+ */
+VOID
+YoriLibForEachFileWaitForListing(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORILIB_FOREACHFILE_LISTING Listing
+    )
+{
+    WaitForSingleObject(Parallel->Mutex, INFINITE);
+    if (Listing->State == YORILIB_FOREACHFILE_LISTING_PENDING) {
+        YoriLibRemoveListItem(&Listing->PendingList);
+        Listing->State = YORILIB_FOREACHFILE_LISTING_RUNNING;
+        ReleaseMutex(Parallel->Mutex);
+        YoriLibForEachFileReadListing(Listing);
+        Listing->State = YORILIB_FOREACHFILE_LISTING_COMPLETE;
+    } else if (Listing->State == YORILIB_FOREACHFILE_LISTING_RUNNING) {
+        ReleaseMutex(Parallel->Mutex);
+        WaitForSingleObject(Listing->CompleteEvent, INFINITE);
+    } else {
+        ReleaseMutex(Parallel->Mutex);
+    }
+}
+
+/**
+ Queue a request for a worker thread to read a directory listing.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param SearchPath Pointer to the search criteria to pass to FindFirstFile.
+
+ @return Pointer to the listing, or NULL if the listing could not be
+         queued, either because of allocation failure or because too many
+         listings are already outstanding.
+ */
+PYORILIB_FOREACHFILE_LISTING
+YoriLibForEachFileRequestListing(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORI_STRING SearchPath
+    )
+{
+    PYORILIB_FOREACHFILE_LISTING Listing;
+
+    if (Parallel->ThreadsAllocated == 0 ||
+        Parallel->ListingsAllocated >= YORILIB_FOREACHFILE_MAX_LISTINGS) {
+        return NULL;
+    }
+
+    Listing = YoriLibForEachFileAllocateListing(Parallel, SearchPath, TRUE);
+    if (Listing == NULL) {
+        return NULL;
+    }
+
+    WaitForSingleObject(Parallel->Mutex, INFINITE);
+    YoriLibAppendList(&Parallel->PendingList, &Listing->PendingList);
+    ReleaseMutex(Parallel->Mutex);
+    ReleaseSemaphore(Parallel->WorkerWaitSemaphore, 1, NULL);
+
+    return Listing;
+}
+
+/**
+ Queue listings to be read by worker threads for each subdirectory found in
+ a directory listing.  The search criteria is the one that the enumerate of
+ the subdirectory will use for its first FindFirstFile.  If that prediction
+ turns out to be wrong, the listing is discarded when the subdirectory is
+ enumerated and FindFirstFile is used instead.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param ForEachContext Pointer to the enumerate context for the parent
+        directory, containing a complete listing of its contents.
+
+ @param TrailingSlashInParentComponent TRUE if the full path to the parent
+        directory ends in a seperator, FALSE if it does not.
+ */
+VOID
+YoriLibForEachFilePrefetchSubdirectories(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORILIB_FOREACHFILE_CONTEXT ForEachContext,
+    __in BOOLEAN TrailingSlashInParentComponent
+    )
+{
+    PYORILIB_FOREACHFILE_LISTING Listing;
+    PYORILIB_FOREACHFILE_LISTING ChildListing;
+    PWIN32_FIND_DATA FileInfo;
+    YORI_STRING Wild;
+    YORI_STRING SearchPath;
+    YORI_ALLOC_SIZE_T Index;
+    WORD MatchFlags;
+
+    MatchFlags = Parallel->MatchFlags;
+    Listing = ForEachContext->Listing;
+
+    //
+    //  Determine the search criteria that the subdirectory will apply in
+    //  its first phase.  If it is recursing first and preserving wild, it
+    //  will look for all subdirectories; otherwise it looks for the wild
+    //  applied to this directory when preserving wild, or everything if not.
+    //
+
+    YoriLibConstantString(&Wild, _T("*"));
+    if ((MatchFlags & YORILIB_ENUM_REC_PRESERVE_WILD) != 0 &&
+        (MatchFlags & YORILIB_ENUM_REC_BEFORE_RETURN) == 0) {
+
+        Wild.StartOfString = &ForEachContext->EffectiveFileSpec.StartOfString[ForEachContext->CharsToFinalSlash];
+        Wild.LengthInChars = ForEachContext->EffectiveFileSpec.LengthInChars - ForEachContext->CharsToFinalSlash;
+    }
+
+    if (!YoriLibAllocateString(&SearchPath, ForEachContext->ParentFullPath.LengthInChars + 1 + sizeof(Listing->Entries[0].cFileName) / sizeof(TCHAR) + 1 + Wild.LengthInChars + 1)) {
+        return;
+    }
+
+    for (Index = 0; Index < Listing->EntryCount; Index++) {
+        FileInfo = &Listing->Entries[Index];
+        if (!YoriLibForEachFileIsTraversable(MatchFlags, FileInfo)) {
+            continue;
+        }
+
+        if (TrailingSlashInParentComponent) {
+            SearchPath.LengthInChars =
+                YoriLibSPrintfS(SearchPath.StartOfString,
+                                SearchPath.LengthAllocated,
+                                _T("%y%s\\%y"),
+                                &ForEachContext->ParentFullPath,
+                                FileInfo->cFileName,
+                                &Wild);
+        } else {
+            SearchPath.LengthInChars =
+                YoriLibSPrintfS(SearchPath.StartOfString,
+                                SearchPath.LengthAllocated,
+                                _T("%y\\%s\\%y"),
+                                &ForEachContext->ParentFullPath,
+                                FileInfo->cFileName,
+                                &Wild);
+        }
+
+        ChildListing = YoriLibForEachFileRequestListing(Parallel, &SearchPath);
+        if (ChildListing == NULL) {
+            break;
+        }
+
+        ChildListing->ParentIndex = Index;
+        YoriLibAppendList(&ForEachContext->PrefetchList, &ChildListing->PrefetchList);
+    }
+
+    YoriLibFreeStringContents(&SearchPath);
+}
+
+/**
+ Find a listing that was requested for a subdirectory that is about to be
+ recursed into.  Any listings for earlier subdirectories that were not
+ recursed into are released.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param ForEachContext Pointer to the enumerate context for the parent
+        directory.
+
+ @return Pointer to the listing for the subdirectory at the current
+         position in the parent's listing, or NULL if no listing was
+         requested.  The caller assumes ownership of the listing.
+ */
+PYORILIB_FOREACHFILE_LISTING
+YoriLibForEachFileTakeChildListing(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORILIB_FOREACHFILE_CONTEXT ForEachContext
+    )
+{
+    PYORILIB_FOREACHFILE_LISTING ChildListing;
+    PYORI_LIST_ENTRY ListEntry;
+
+    if (ForEachContext->Listing == NULL) {
+        return NULL;
+    }
+
+    while (TRUE) {
+        ListEntry = YoriLibGetNextListEntry(&ForEachContext->PrefetchList, NULL);
+        if (ListEntry == NULL) {
+            return NULL;
+        }
+
+        ChildListing = CONTAINING_RECORD(ListEntry, YORILIB_FOREACHFILE_LISTING, PrefetchList);
+        if (ChildListing->ParentIndex >= ForEachContext->ListingIndex) {
+            return NULL;
+        }
+
+        YoriLibRemoveListItem(&ChildListing->PrefetchList);
+        if (ChildListing->ParentIndex == ForEachContext->ListingIndex - 1) {
+            return ChildListing;
+        }
+
+        YoriLibForEachFileReleaseListing(Parallel, ChildListing);
+    }
+}
+
+/**
+ Release all listings requested for subdirectories of a directory that
+ have not been recursed into.
 
- This can be thought of as a mini version of @ref YoriLibFindEffRoot .
- Unlike that function, this one has to run on purely relative paths that
- haven't been converted to their full form, where seperators could go
- either way, where relative components are still present.  Also, it doesn't
- need to deal with UNC paths because a share and a root are equivalent;
- there's no concept of "current directory on UNC share" which is the meaning
- if a trailing seperator is removed from a drive.
+ @param Parallel Pointer to the parallel enumerate state.
 
- @param String The string to inspect and potentially trim if a trailing
-        seperator is present.
+ @param ForEachContext Pointer to the enumerate context for the parent
+        directory.
  */
 VOID
-YoriLibTruncateTrailingSeperatorIfBenign(
-    __inout PYORI_STRING String
+YoriLibForEachFileReleaseChildListings(
+    __in_opt PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORILIB_FOREACHFILE_CONTEXT ForEachContext
     )
 {
-    //
-    //  Trim trailing slashes, except if the string is just a slash, or if
-    //  the slash follows a drive letter and colon, in which case it's
-    //  meaningful.
-    //
+    PYORILIB_FOREACHFILE_LISTING ChildListing;
+    PYORI_LIST_ENTRY ListEntry;
 
-    if (String->LengthInChars > 1 &&
-        YoriLibIsSep(String->StartOfString[String->LengthInChars - 1])) {
+    while (TRUE) {
+        ListEntry = YoriLibGetNextListEntry(&ForEachContext->PrefetchList, NULL);
+        if (ListEntry == NULL) {
+            break;
+        }
 
-        if (YoriLibIsPfxDrvLetterColonSlash(String)) {
-            if (String->LengthInChars >= sizeof("\\\\?\\c:\\")) {
-                String->LengthInChars--;
+        ChildListing = CONTAINING_RECORD(ListEntry, YORILIB_FOREACHFILE_LISTING, PrefetchList);
+        YoriLibRemoveListItem(&ChildListing->PrefetchList);
+        YoriLibForEachFileReleaseListing(Parallel, ChildListing);
+    }
+}
+
+/**
+ Begin enumerating a directory.  For a regular enumerate this is a wrapper
+ around FindFirstFile.  For an ordered parallel enumerate, this will use a
+ listing that has been read by a worker thread if one is available.  If
+ not, and this enumerate is looking for subdirectories to recurse into,
+ the listing is read in full so that subdirectories can be read by worker
+ threads before they are reached.
+
+ @param Parallel Pointer to the parallel enumerate state, or NULL if this is
+        not a parallel enumerate.
+
+ @param ForEachContext Pointer to the enumerate context.  FullPath contains
+        the search criteria, and FileInfo is populated with the first match
+        on success.
+
+ @param RecursePhase TRUE if this enumerate is looking for subdirectories to
+        recurse into.
+
+ @return A find handle from FindFirstFile, INVALID_HANDLE_VALUE on failure,
+         or NULL to indicate that results are being returned from a
+         listing.
+ */
+HANDLE
+YoriLibForEachFileFindFirst(
+    __in_opt PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in PYORILIB_FOREACHFILE_CONTEXT ForEachContext,
+    __in BOOLEAN RecursePhase
+    )
+{
+    PYORILIB_FOREACHFILE_LISTING Listing;
+
+    if (Parallel != NULL && !Parallel->Unordered) {
+        Listing = ForEachContext->Listing;
+        if (Listing != NULL) {
+            if (YoriLibCompareStringIns(&Listing->SearchPath, &ForEachContext->FullPath) != 0) {
+                YoriLibForEachFileReleaseListing(Parallel, Listing);
+                Listing = NULL;
+            } else {
+                YoriLibForEachFileWaitForListing(Parallel, Listing);
+                if (Listing->Error != ERROR_SUCCESS) {
+                    YoriLibForEachFileReleaseListing(Parallel, Listing);
+                    Listing = NULL;
+                }
             }
-        } else if (YoriLibIsDrvLetterColonSlash(String)) {
-            if (String->LengthInChars >= sizeof("c:\\")) {
-                String->LengthInChars--;
+        }
+
+        if (Listing == NULL && RecursePhase && Parallel->ThreadsAllocated > 0) {
+            Listing = YoriLibForEachFileAllocateListing(Parallel, &ForEachContext->FullPath, FALSE);
+            if (Listing != NULL) {
+                Listing->State = YORILIB_FOREACHFILE_LISTING_RUNNING;
+                YoriLibForEachFileReadListing(Listing);
+                Listing->State = YORILIB_FOREACHFILE_LISTING_COMPLETE;
+                if (Listing->Error != ERROR_SUCCESS) {
+                    YoriLibForEachFileReleaseListing(Parallel, Listing);
+                    Listing = NULL;
+                }
             }
-        } else {
-            String->LengthInChars--;
         }
+
+        ForEachContext->Listing = Listing;
+        if (Listing != NULL) {
+            memcpy(&ForEachContext->FileInfo, &Listing->Entries[0], sizeof(WIN32_FIND_DATA));
+            ForEachContext->ListingIndex = 1;
+            return NULL;
+        }
+    }
+
+    return FindFirstFile(ForEachContext->FullPath.StartOfString, &ForEachContext->FileInfo);
+}
+
+/**
+ Continue enumerating a directory, returning the next entry from either
+ a listing or a find handle.
+
+ @param hFind The find handle returned from
+        @ref YoriLibForEachFileFindFirst .
+
+ @param ForEachContext Pointer to the enumerate context.  FileInfo is
+        populated with the next match on success.
+
+ @return TRUE if another entry was returned, FALSE if the enumerate is
+         complete.
+ */
+BOOL
+YoriLibForEachFileFindNext(
+    __in HANDLE hFind,
+    __in PYORILIB_FOREACHFILE_CONTEXT ForEachContext
+    )
+{
+    PYORILIB_FOREACHFILE_LISTING Listing;
+
+    Listing = ForEachContext->Listing;
+    if (Listing != NULL) {
+        if (ForEachContext->ListingIndex >= Listing->EntryCount) {
+            return FALSE;
+        }
+        memcpy(&ForEachContext->FileInfo, &Listing->Entries[ForEachContext->ListingIndex], sizeof(WIN32_FIND_DATA));
+        ForEachContext->ListingIndex++;
+        return TRUE;
+    }
+
+    if (hFind == NULL || hFind == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    return FindNextFile(hFind, &ForEachContext->FileInfo);
+}
+
+/**
+ Queue a subdirectory to be enumerated by a worker thread as part of an
+ unordered parallel enumerate.  Items are inserted at the head of the list
+ so that the deepest directories are processed first, which bounds the
+ length of the queue in the same way as a depth first traversal.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param FileSpec Pointer to the criteria to enumerate.  On success, the
+        allocation for this string is transferred to the work item and the
+        caller's string is reinitialized to empty.
+
+ @param Depth The recursion depth of the criteria.
+
+ @return TRUE if the item was queued, FALSE if it was not, in which case
+         the caller should enumerate the criteria itself.
+ */
+BOOLEAN
+YoriLibForEachFileQueueDirectory(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __inout PYORI_STRING FileSpec,
+    __in DWORD Depth
+    )
+{
+    PYORILIB_FOREACHFILE_WORK_ITEM WorkItem;
+
+    WorkItem = YoriLibMalloc(sizeof(YORILIB_FOREACHFILE_WORK_ITEM));
+    if (WorkItem == NULL) {
+        return FALSE;
     }
+
+    memcpy(&WorkItem->FileSpec, FileSpec, sizeof(YORI_STRING));
+    YoriLibInitEmptyString(FileSpec);
+    WorkItem->Depth = Depth;
+
+    WaitForSingleObject(Parallel->Mutex, INFINITE);
+    YoriLibInsertList(&Parallel->PendingList, &WorkItem->PendingList);
+    Parallel->ItemsOutstanding++;
+    if (Parallel->ItemsOutstanding == 1) {
+        ResetEvent(Parallel->AllCompleteEvent);
+    }
+    ReleaseMutex(Parallel->Mutex);
+    ReleaseSemaphore(Parallel->WorkerWaitSemaphore, 1, NULL);
+
+    return TRUE;
 }
 
 /**
@@ -152,6 +1006,13 @@ YoriLibTruncateTrailingSeperatorIfBenign(
         about failures and wants to silently continue.
 
  @param Context Caller provided context to pass to the callback.
+
+ @param Parallel Optionally points to the state of a parallel enumerate.
+        If NULL, subdirectories are enumerated synchronously by this thread.
+
+ @param Listing Optionally points to a listing that was requested for this
+        directory by the parent directory's enumerate.  This function
+        assumes ownership of the listing.
  */
 __success(return)
 BOOL
@@ -161,7 +1022,9 @@ YoriLibForEachFileEnum(
     __in DWORD Depth,
     __in PYORILIB_FILE_ENUM_FN Callback,
     __in_opt PYORILIB_FILE_ENUM_ERROR_FN ErrorCallback,
-    __in_opt PVOID Context
+    __in_opt PVOID Context,
+    __in_opt PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in_opt PYORILIB_FOREACHFILE_LISTING Listing
     )
 {
     HANDLE hFind;
@@ -183,9 +1046,13 @@ YoriLibForEachFileEnum(
 
     ForEachContext = YoriLibMalloc(sizeof(YORILIB_FOREACHFILE_CONTEXT));
     if (ForEachContext == NULL) {
+        YoriLibForEachFileReleaseListing(Parallel, Listing);
         return FALSE;
     }
     YoriLibInitEmptyString(&ForEachContext->RecurseCriteria);
+    ForEachContext->Listing = Listing;
+    ForEachContext->ListingIndex = 0;
+    YoriLibInitializeListHead(&ForEachContext->PrefetchList);
 
     //
     //  This is currently only needed for the GetFileAttributes call.  It may
@@ -320,6 +1187,7 @@ YoriLibForEachFileEnum(
         YoriLibTruncateTrailingSeperatorIfBenign(&DirectoryPart);
 
         if (!YoriLibGetFullPathNameAlloc(&DirectoryPart, TRUE, &ForEachContext->ParentFullPath, NULL)) {
+            YoriLibForEachFileReleaseListing(Parallel, ForEachContext->Listing);
             YoriLibFreeStringContents(&ForEachContext->EffectiveFileSpec);
             YoriLibFree(ForEachContext);
             return FALSE;
@@ -328,6 +1196,7 @@ YoriLibForEachFileEnum(
         YORI_STRING ThisDir;
         YoriLibConstantString(&ThisDir, _T("."));
         if (!YoriLibGetFullPathNameAlloc(&ThisDir, TRUE, &ForEachContext->ParentFullPath, NULL)) {
+            YoriLibForEachFileReleaseListing(Parallel, ForEachContext->Listing);
             YoriLibFreeStringContents(&ForEachContext->EffectiveFileSpec);
             YoriLibFree(ForEachContext);
             return FALSE;
@@ -351,6 +1220,8 @@ YoriLibForEachFileEnum(
     }
 
     if (!YoriLibAllocateString(&ForEachContext->FullPath, ForEachContext->ParentFullPath.LengthInChars + 1 + sizeof(ForEachContext->FileInfo.cFileName) / sizeof(TCHAR) + 1)) {
+        YoriLibForEachFileReleaseListing(Parallel, ForEachContext->Listing);
+        YoriLibFreeStringContents(&ForEachContext->ParentFullPath);
         YoriLibFreeStringContents(&ForEachContext->EffectiveFileSpec);
         YoriLibFree(ForEachContext);
         return FALSE;
@@ -388,7 +1259,7 @@ YoriLibForEachFileEnum(
                                 ForEachContext->FullPath.LengthAllocated,
                                 _T("%y\\*"),
                                 &ForEachContext->ParentFullPath);
-            hFind = FindFirstFile(ForEachContext->FullPath.StartOfString, &ForEachContext->FileInfo);
+            hFind = YoriLibForEachFileFindFirst(Parallel, ForEachContext, RecursePhase);
         } else {
             if (FinalSlashFound) {
 
@@ -439,7 +1310,7 @@ YoriLibForEachFileEnum(
                                         &ForEachContext->EffectiveFileSpec);
                 }
             }
-            hFind = FindFirstFile(ForEachContext->FullPath.StartOfString, &ForEachContext->FileInfo);
+            hFind = YoriLibForEachFileFindFirst(Parallel, ForEachContext, RecursePhase);
 
             //
             //  If we can't enumerate it because it's a volume root, cook up
@@ -468,6 +1339,19 @@ YoriLibForEachFileEnum(
                 break;
             }
         } else {
+
+            //
+            //  If this is an ordered parallel enumerate and the directory
+            //  has been read in full, ask worker threads to read any
+            //  subdirectories before they are reached.
+            //
+
+            if (RecursePhase && ForEachContext->Listing != NULL) {
+                ASSERT(Parallel != NULL);
+                __analysis_assume(Parallel != NULL);
+                YoriLibForEachFilePrefetchSubdirectories(Parallel, ForEachContext, TrailingSlashInParentComponent);
+            }
+
             do {
 
                 ReportObject = TRUE;
@@ -574,9 +1458,29 @@ YoriLibForEachFileEnum(
                         ForEachContext->RecurseCriteria.StartOfString[ForEachContext->RecurseCriteria.LengthInChars] = '\0';
                     }
 
-                    if (!YoriLibForEachFileEnum(&ForEachContext->RecurseCriteria, MatchFlags, Depth + 1, Callback, ErrorCallback, Context)) {
-                        Result = FALSE;
-                        break;
+                    //
+                    //  In an unordered parallel enumerate, hand the
+                    //  subdirectory to a worker thread.  Otherwise recurse
+                    //  now, supplying any listing that a worker thread has
+                    //  read for it.
+                    //
+
+                    if (Parallel != NULL && Parallel->Unordered) {
+                        if (!YoriLibForEachFileQueueDirectory(Parallel, &ForEachContext->RecurseCriteria, Depth + 1)) {
+                            if (!YoriLibForEachFileEnum(&ForEachContext->RecurseCriteria, MatchFlags, Depth + 1, Callback, ErrorCallback, Context, Parallel, NULL)) {
+                                Result = FALSE;
+                                break;
+                            }
+                        }
+                    } else {
+                        PYORILIB_FOREACHFILE_LISTING ChildListing = NULL;
+                        if (Parallel != NULL) {
+                            ChildListing = YoriLibForEachFileTakeChildListing(Parallel, ForEachContext);
+                        }
+                        if (!YoriLibForEachFileEnum(&ForEachContext->RecurseCriteria, MatchFlags, Depth + 1, Callback, ErrorCallback, Context, Parallel, ChildListing)) {
+                            Result = FALSE;
+                            break;
+                        }
                     }
 
                     YoriLibFreeStringContents(&ForEachContext->RecurseCriteria);
@@ -629,9 +1533,15 @@ YoriLibForEachFileEnum(
                     }
                 }
 
-            } while (hFind != INVALID_HANDLE_VALUE && hFind != NULL && FindNextFile(hFind, &ForEachContext->FileInfo));
+                if (Parallel != NULL && Parallel->Aborted) {
+                    Result = FALSE;
+                    break;
+                }
+
+            } while (YoriLibForEachFileFindNext(hFind, ForEachContext));
 
             YoriLibFreeStringContents(&ForEachContext->RecurseCriteria);
+            YoriLibForEachFileReleaseChildListings(Parallel, ForEachContext);
 
             if (hFind != NULL && hFind != INVALID_HANDLE_VALUE) {
                 FindClose(hFind);
@@ -643,6 +1553,7 @@ YoriLibForEachFileEnum(
         }
     }
 
+    YoriLibForEachFileReleaseListing(Parallel, ForEachContext->Listing);
     YoriLibFreeStringContents(&ForEachContext->EffectiveFileSpec);
     YoriLibFreeStringContents(&ForEachContext->ParentFullPath);
     YoriLibFreeStringContents(&ForEachContext->FullPath);
@@ -651,6 +1562,241 @@ YoriLibForEachFileEnum(
     return Result;
 }
 
+/**
+ Process work from the pending list of a parallel enumerate until an
+ event is signalled.  This is used by worker threads until shutdown, and
+ by the calling thread of an unordered enumerate until all work is complete.
+
+ @param Parallel Pointer to the parallel enumerate state.
+
+ @param ExitEvent The event which indicates that processing should stop.
+ */
+VOID
+YoriLibForEachFileProcessWork(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel,
+    __in HANDLE ExitEvent
+    )
+{
+    HANDLE WaitHandles[2];
+    DWORD FoundEvent;
+    PYORI_LIST_ENTRY ListEntry;
+    PYORILIB_FOREACHFILE_LISTING Listing;
+    PYORILIB_FOREACHFILE_WORK_ITEM WorkItem;
+    BOOLEAN Abandoned;
+
+    WaitHandles[0] = ExitEvent;
+    WaitHandles[1] = Parallel->WorkerWaitSemaphore;
+
+    while (TRUE) {
+
+        //
+        //  Wait for an indication of more work or exit.  Note that the
+        //  semaphore is released once per item queued, but items can be
+        //  removed by a thread that needs them immediately, so finding an
+        //  empty list here is normal.
+        //
+
+        FoundEvent = WaitForMultipleObjectsEx(2, WaitHandles, FALSE, INFINITE, FALSE);
+        if (FoundEvent != (WAIT_OBJECT_0 + 1)) {
+            break;
+        }
+
+        WaitForSingleObject(Parallel->Mutex, INFINITE);
+        ListEntry = YoriLibGetNextListEntry(&Parallel->PendingList, NULL);
+        if (ListEntry == NULL) {
+            ReleaseMutex(Parallel->Mutex);
+            continue;
+        }
+        YoriLibRemoveListItem(ListEntry);
+
+        if (Parallel->Unordered) {
+            ReleaseMutex(Parallel->Mutex);
+            WorkItem = CONTAINING_RECORD(ListEntry, YORILIB_FOREACHFILE_WORK_ITEM, PendingList);
+
+            if (!Parallel->Aborted) {
+                if (!YoriLibForEachFileEnum(&WorkItem->FileSpec,
+                                            Parallel->MatchFlags,
+                                            WorkItem->Depth,
+                                            Parallel->Callback,
+                                            Parallel->ErrorCallback,
+                                            Parallel->Context,
+                                            Parallel,
+                                            NULL)) {
+                    Parallel->Aborted = TRUE;
+                }
+            }
+
+            YoriLibFreeStringContents(&WorkItem->FileSpec);
+            YoriLibFree(WorkItem);
+
+            WaitForSingleObject(Parallel->Mutex, INFINITE);
+            ASSERT(Parallel->ItemsOutstanding > 0);
+            Parallel->ItemsOutstanding--;
+            if (Parallel->ItemsOutstanding == 0) {
+                SetEvent(Parallel->AllCompleteEvent);
+            }
+            ReleaseMutex(Parallel->Mutex);
+        } else {
+            Listing = CONTAINING_RECORD(ListEntry, YORILIB_FOREACHFILE_LISTING, PendingList);
+            ASSERT(Listing->State == YORILIB_FOREACHFILE_LISTING_PENDING);
+            Listing->State = YORILIB_FOREACHFILE_LISTING_RUNNING;
+            ReleaseMutex(Parallel->Mutex);
+
+            YoriLibForEachFileReadListing(Listing);
+
+            WaitForSingleObject(Parallel->Mutex, INFINITE);
+            Listing->State = YORILIB_FOREACHFILE_LISTING_COMPLETE;
+            Abandoned = Listing->Abandoned;
+            if (!Abandoned) {
+                SetEvent(Listing->CompleteEvent);
+            }
+            ReleaseMutex(Parallel->Mutex);
+
+            if (Abandoned) {
+                YoriLibForEachFileFreeListing(Parallel, Listing);
+            }
+        }
+    }
+}
+
+/**
+ A worker thread for a parallel enumerate.
+
+ @param Context Pointer to the parallel enumerate state.
+
+ @return Zero.
+ */
+DWORD WINAPI
+YoriLibForEachFileWorker(
+    __in LPVOID Context
+    )
+{
+    PYORILIB_FOREACHFILE_PARALLEL Parallel = (PYORILIB_FOREACHFILE_PARALLEL)Context;
+
+    YoriLibForEachFileProcessWork(Parallel, Parallel->WorkerShutdownEvent);
+    return 0;
+}
+
+/**
+ Terminate any worker threads for a parallel enumerate and free its state.
+
+ @param Parallel Pointer to the parallel enumerate state.
+ */
+VOID
+YoriLibForEachFileEndParallel(
+    __in PYORILIB_FOREACHFILE_PARALLEL Parallel
+    )
+{
+    DWORD Index;
+
+    if (Parallel->ThreadsAllocated > 0) {
+        SetEvent(Parallel->WorkerShutdownEvent);
+        WaitForMultipleObjectsEx(Parallel->ThreadsAllocated, Parallel->Threads, TRUE, INFINITE, FALSE);
+        for (Index = 0; Index < Parallel->ThreadsAllocated; Index++) {
+            CloseHandle(Parallel->Threads[Index]);
+        }
+    }
+
+    ASSERT(YoriLibIsListEmpty(&Parallel->PendingList));
+    ASSERT(Parallel->ListingsAllocated == 0);
+
+    if (Parallel->AllCompleteEvent != NULL) {
+        CloseHandle(Parallel->AllCompleteEvent);
+    }
+    if (Parallel->WorkerShutdownEvent != NULL) {
+        CloseHandle(Parallel->WorkerShutdownEvent);
+    }
+    if (Parallel->WorkerWaitSemaphore != NULL) {
+        CloseHandle(Parallel->WorkerWaitSemaphore);
+    }
+    if (Parallel->Mutex != NULL) {
+        CloseHandle(Parallel->Mutex);
+    }
+    YoriLibFree(Parallel);
+}
+
+/**
+ Allocate state for a parallel enumerate and create its worker threads.
+
+ @param MatchFlags Specifies the behavior of the match.
+
+ @param Callback The callback to invoke on each match.
+
+ @param ErrorCallback Optionally points to a function to invoke if a
+        directory cannot be enumerated.
+
+ @param Context Caller provided context to pass to the callbacks.
+
+ @return Pointer to the parallel enumerate state, or NULL on failure, in
+         which case the caller should perform a regular enumerate.
+ */
+PYORILIB_FOREACHFILE_PARALLEL
+YoriLibForEachFileStartParallel(
+    __in WORD MatchFlags,
+    __in PYORILIB_FILE_ENUM_FN Callback,
+    __in_opt PYORILIB_FILE_ENUM_ERROR_FN ErrorCallback,
+    __in_opt PVOID Context
+    )
+{
+    PYORILIB_FOREACHFILE_PARALLEL Parallel;
+    SYSTEM_INFO SystemInfo;
+    DWORD MaxThreads;
+    DWORD ThreadId;
+
+    Parallel = YoriLibMalloc(sizeof(YORILIB_FOREACHFILE_PARALLEL));
+    if (Parallel == NULL) {
+        return NULL;
+    }
+
+    ZeroMemory(Parallel, sizeof(YORILIB_FOREACHFILE_PARALLEL));
+    YoriLibInitializeListHead(&Parallel->PendingList);
+    Parallel->MatchFlags = MatchFlags;
+    Parallel->Callback = Callback;
+    Parallel->ErrorCallback = ErrorCallback;
+    Parallel->Context = Context;
+    if ((MatchFlags & YORILIB_ENUM_PARALLEL_UNORDERED) != 0) {
+        Parallel->Unordered = TRUE;
+    }
+
+    Parallel->Mutex = CreateMutex(NULL, FALSE, NULL);
+    Parallel->WorkerWaitSemaphore = CreateSemaphore(NULL, 0, 0x7FFFFFFF, NULL);
+    Parallel->WorkerShutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    Parallel->AllCompleteEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
+    if (Parallel->Mutex == NULL ||
+        Parallel->WorkerWaitSemaphore == NULL ||
+        Parallel->WorkerShutdownEvent == NULL ||
+        Parallel->AllCompleteEvent == NULL) {
+
+        YoriLibForEachFileEndParallel(Parallel);
+        return NULL;
+    }
+
+    //
+    //  Directory enumeration spends most of its time waiting for the file
+    //  system, particularly over a network, so use more threads than
+    //  processors.
+    //
+
+    GetSystemInfo(&SystemInfo);
+    MaxThreads = SystemInfo.dwNumberOfProcessors * 2;
+    if (MaxThreads < 4) {
+        MaxThreads = 4;
+    }
+    if (MaxThreads > YORILIB_FOREACHFILE_MAX_THREADS) {
+        MaxThreads = YORILIB_FOREACHFILE_MAX_THREADS;
+    }
+
+    while (Parallel->ThreadsAllocated < MaxThreads) {
+        Parallel->Threads[Parallel->ThreadsAllocated] = CreateThread(NULL, 0, YoriLibForEachFileWorker, Parallel, 0, &ThreadId);
+        if (Parallel->Threads[Parallel->ThreadsAllocated] == NULL) {
+            break;
+        }
+        Parallel->ThreadsAllocated++;
+    }
+
+    return Parallel;
+}
+
 /**
  Enumerate the set of possible files matching a user specified pattern.
  This function is responsible for expanding Yori defined sequences, including
@@ -672,17 +1818,20 @@ YoriLibForEachFileEnum(
 
  @param Context Caller provided context to pass to the callback.
 
+ @param Parallel Optionally points to the state of a parallel enumerate.
+
  @return TRUE to indicate success, FALSE to indicate failure.
  */
 __success(return)
 BOOL
-YoriLibForEachFile(
+YoriLibForEachFileExpand(
     __in PYORI_STRING FileSpec,
     __in WORD MatchFlags,
     __in DWORD Depth,
     __in PYORILIB_FILE_ENUM_FN Callback,
     __in_opt PYORILIB_FILE_ENUM_ERROR_FN ErrorCallback,
-    __in_opt PVOID Context
+    __in_opt PVOID Context,
+    __in_opt PYORILIB_FOREACHFILE_PARALLEL Parallel
     )
 {
     YORI_STRING BeforeOperator;
@@ -694,7 +1843,7 @@ YoriLibForEachFile(
     BOOL SingleCharMode;
 
     if (MatchFlags & YORILIB_ENUM_BASIC_EXPANSION) {
-        return YoriLibForEachFileEnum(FileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context);
+        return YoriLibForEachFileEnum(FileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context, Parallel, NULL);
     }
 
     SingleCharMode = FALSE;
@@ -709,12 +1858,12 @@ YoriLibForEachFile(
 
         if (YoriLibExpandHomeDirectories(FileSpec, &NewFileSpec)) {
             BOOL Result;
-            Result = YoriLibForEachFileEnum(&NewFileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context);
+            Result = YoriLibForEachFileEnum(&NewFileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context, Parallel, NULL);
             YoriLibFreeStringContents(&NewFileSpec);
             return Result;
         }
 
-        return YoriLibForEachFileEnum(FileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context);
+        return YoriLibForEachFileEnum(FileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context, Parallel, NULL);
     }
 
     YoriLibInitEmptyString(&BeforeOperator);
@@ -733,7 +1882,7 @@ YoriLibForEachFile(
 
     CharsToOperator = YoriLibCntStringNotWithChars(&SubstituteValues, SingleCharMode?_T("]"):_T("}"));
     if (CharsToOperator == SubstituteValues.LengthInChars) {
-        return YoriLibForEachFileEnum(FileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context);
+        return YoriLibForEachFileEnum(FileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context, Parallel, NULL);
     }
 
     AfterOperator.StartOfString = &SubstituteValues.StartOfString[CharsToOperator + 1];
@@ -754,7 +1903,7 @@ YoriLibForEachFile(
 
             YoriLibYPrintf(&NewFileSpec, _T("%y%y%y"), &BeforeOperator, &MatchValue, &AfterOperator);
 
-            if (!YoriLibForEachFile(&NewFileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context)) {
+            if (!YoriLibForEachFileExpand(&NewFileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context, Parallel)) {
                 YoriLibFreeStringContents(&NewFileSpec);
                 return FALSE;
             }
@@ -781,7 +1930,7 @@ YoriLibForEachFile(
 
             YoriLibYPrintf(&NewFileSpec, _T("%y%y%y"), &BeforeOperator, &MatchValue, &AfterOperator);
 
-            if (!YoriLibForEachFile(&NewFileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context)) {
+            if (!YoriLibForEachFileExpand(&NewFileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context, Parallel)) {
                 YoriLibFreeStringContents(&NewFileSpec);
                 return FALSE;
             }
@@ -800,6 +1949,86 @@ YoriLibForEachFile(
     return TRUE;
 }
 
+/**
+ Enumerate the set of possible files matching a user specified pattern.
+ This function is responsible for expanding Yori defined sequences, including
+ {}, [], and ~ operators.
+
+ If YORILIB_ENUM_PARALLEL is specified, directories are read by a pool of
+ worker threads ahead of the point where they are needed, and callbacks are
+ invoked on the calling thread in the same order as a regular enumerate.
+ If YORILIB_ENUM_PARALLEL_UNORDERED is specified, subdirectories are
+ enumerated by worker threads and callbacks are invoked concurrently from
+ any thread in no defined order, including objects in a subdirectory being
+ returned before or after the objects in its parent irrespective of the
+ YORILIB_ENUM_REC_ flags.  Callers are responsible for synchronizing any
+ state accessed from the callbacks.
+
+ @param FileSpec The user provided file specification to enumerate matches on.
+
+ @param MatchFlags Specifies the behavior of the match, including whether
+        it should be applied recursively and the recursing behavior.
+
+ @param Depth Indicates the current recursion depth.  If this function is
+        reentered, this value is incremented.
+
+ @param Callback The callback to invoke on each match.
+
+ @param ErrorCallback Optionally points to a function to invoke if a
+        directory cannot be enumerated.  If NULL, the caller does not care
+        about failures and wants to silently continue.
+
+ @param Context Caller provided context to pass to the callback.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriLibForEachFile(
+    __in PYORI_STRING FileSpec,
+    __in WORD MatchFlags,
+    __in DWORD Depth,
+    __in PYORILIB_FILE_ENUM_FN Callback,
+    __in_opt PYORILIB_FILE_ENUM_ERROR_FN ErrorCallback,
+    __in_opt PVOID Context
+    )
+{
+    PYORILIB_FOREACHFILE_PARALLEL Parallel;
+    BOOL Result;
+
+    Parallel = NULL;
+    if ((MatchFlags & (YORILIB_ENUM_PARALLEL | YORILIB_ENUM_PARALLEL_UNORDERED)) != 0 &&
+        (MatchFlags & (YORILIB_ENUM_REC_AFTER_RETURN | YORILIB_ENUM_REC_BEFORE_RETURN)) != 0) {
+
+        Parallel = YoriLibForEachFileStartParallel(MatchFlags, Callback, ErrorCallback, Context);
+    }
+
+    Result = YoriLibForEachFileExpand(FileSpec, MatchFlags, Depth, Callback, ErrorCallback, Context, Parallel);
+
+    if (Parallel != NULL) {
+
+        //
+        //  In an unordered enumerate, the calling thread has finished the
+        //  top level directory but subdirectories may still be queued or
+        //  in progress.  Help the worker threads until they are done.
+        //
+
+        if (Parallel->Unordered) {
+            if (!Result) {
+                Parallel->Aborted = TRUE;
+            }
+            YoriLibForEachFileProcessWork(Parallel, Parallel->AllCompleteEvent);
+            if (Parallel->Aborted) {
+                Result = FALSE;
+            }
+        }
+
+        YoriLibForEachFileEndParallel(Parallel);
+    }
+
+    return Result;
+}
+
 /**
  Compare a file name against a wildcard criteria to see if it matches.
 
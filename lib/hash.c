@@ -27,11 +27,58 @@
 #include "yoripch.h"
 #include "yorilib.h"
 
+/**
+ The smallest number of buckets that a hash table will be created with.
+ */
+#define YORI_HASH_MIN_BUCKETS 16
+
+/**
+ The number of entries per bucket, on average, above which the table is
+ grown.
+ */
+#define YORI_HASH_MAX_LOAD_FACTOR 1
+
+/**
+ Allocate and initialize an array of hash buckets.
+
+ @param NumberBuckets The number of buckets to allocate.
+
+ @return Pointer to the array of buckets, or NULL on allocation failure.
+ */
+PYORI_HASH_BUCKET
+YoriLibAllocateHashBuckets(
+    __in YORI_ALLOC_SIZE_T NumberBuckets
+    )
+{
+    YORI_MAX_UNSIGNED_T SizeNeeded;
+    PYORI_HASH_BUCKET Buckets;
+    YORI_ALLOC_SIZE_T BucketIndex;
+
+    SizeNeeded = NumberBuckets;
+    SizeNeeded = SizeNeeded * sizeof(YORI_HASH_BUCKET);
+    if (!YoriLibIsSizeAllocatable(SizeNeeded)) {
+        return NULL;
+    }
+
+    Buckets = YoriLibMalloc((YORI_ALLOC_SIZE_T)SizeNeeded);
+    if (Buckets == NULL) {
+        return NULL;
+    }
+
+    for (BucketIndex = 0; BucketIndex < NumberBuckets; BucketIndex++) {
+        YoriLibInitializeListHead(&Buckets[BucketIndex].ListHead);
+    }
+
+    return Buckets;
+}
 
 /**
  Allocate an empty hash table.
 
  @param NumberBuckets The number of buckets to allocate into the hash table.
+        This is a hint describing the expected number of entries.  It is
+        rounded up to a power of two, and the table will grow as needed
+        as entries are inserted.
 
  @return On successful completion, points to the resulting hash table.
          On allocation failure, returns NULL.
@@ -41,26 +88,28 @@ YoriLibAllocateHashTable(
     __in YORI_ALLOC_SIZE_T NumberBuckets
     )
 {
-    DWORD SizeNeeded = sizeof(YORI_HASH_TABLE) + NumberBuckets * sizeof(YORI_HASH_BUCKET);
     PYORI_HASH_TABLE HashTable;
-    DWORD BucketIndex;
+    YORI_ALLOC_SIZE_T RoundedBuckets;
 
-    if (!YoriLibIsSizeAllocatable(SizeNeeded)) {
-        return NULL;
+    RoundedBuckets = YORI_HASH_MIN_BUCKETS;
+    while (RoundedBuckets < NumberBuckets && RoundedBuckets < (YORI_MAX_ALLOC_SIZE / 2 / sizeof(YORI_HASH_BUCKET))) {
+        RoundedBuckets = RoundedBuckets * 2;
     }
 
-    HashTable = YoriLibReferencedMalloc((YORI_ALLOC_SIZE_T)SizeNeeded);
+    HashTable = YoriLibReferencedMalloc(sizeof(YORI_HASH_TABLE));
     if (HashTable == NULL) {
         return NULL;
     }
 
-    HashTable->NumberBuckets = NumberBuckets;
-    HashTable->Buckets = (PYORI_HASH_BUCKET)(HashTable + 1);
-
-    for (BucketIndex = 0; BucketIndex < NumberBuckets; BucketIndex++) {
-        YoriLibInitializeListHead(&HashTable->Buckets[BucketIndex].ListHead);
+    HashTable->Buckets = YoriLibAllocateHashBuckets(RoundedBuckets);
+    if (HashTable->Buckets == NULL) {
+        YoriLibDereference(HashTable);
+        return NULL;
     }
 
+    HashTable->NumberBuckets = RoundedBuckets;
+    HashTable->EntryCount = 0;
+
     return HashTable;
 }
 
@@ -82,7 +131,9 @@ YoriLibFreeEmptyHashTable(
         ASSERT(YoriLibGetNextListEntry(&HashTable->Buckets[BucketIndex].ListHead, NULL) == NULL);
     }
 #endif
+    ASSERT(HashTable->EntryCount == 0);
 
+    YoriLibFree(HashTable->Buckets);
     YoriLibDereference(HashTable);
 }
 
@@ -113,40 +164,93 @@ YoriLibHashString32(
         Hash = (Hash << 3) ^ YoriLibUpcaseChar(String->StartOfString[Index]) ^ (Hash >> 29);
     }
 
-    //
-    //  Move some high bits into the low bits since the low bits
-    //  will likely be used as a bucket index.  Note we're moving
-    //  bits 16 here and 3 above (ie., not divisible and won't
-    //  cancel out.)
-    //
-
     return Hash;
 }
 
 /**
- Hash a yori string into a 16 bit hash value.
+ Hash a yori string into a 32 bit hash value for use in a hash table.  This
+ is not the same as YoriLibHashString32, whose values may be persisted by
+ callers, so cannot change.  This version aims to distribute keys well
+ across every bit of the result, since a hash table uses the low bits to
+ select a bucket, and is case insensitive to match the key comparison.
 
  @param String The string to generate a hash for.
 
- @return A 16 bit hash value for the string.
+ @return A 32 bit hash value for the string.
  */
-WORD
+DWORD
 YoriLibHashString(
     __in PCYORI_STRING String
     )
 {
     DWORD Hash;
-    Hash = YoriLibHashString32(0, String);
+    DWORD Index;
 
     //
-    //  Move some high bits into the low bits since the low bits
-    //  will likely be used as a bucket index.  Note we're moving
-    //  bits 16 here and 3 above (ie., not divisible and won't
-    //  cancel out.)
+    //  FNV-1a over the upcased characters
     //
 
+    Hash = 2166136261UL;
+    for (Index = 0; Index < String->LengthInChars; Index++) {
+        Hash = Hash ^ YoriLibUpcaseChar(String->StartOfString[Index]);
+        Hash = Hash * 16777619UL;
+    }
+
+    //
+    //  FNV leaves the low bits weakly mixed when keys differ only in their
+    //  final characters.  Avalanche the result so every bit of the hash
+    //  depends on every bit of the input.
+    //
+
+    Hash = Hash ^ (Hash >> 16);
+    Hash = Hash * 0x85EBCA6BUL;
+    Hash = Hash ^ (Hash >> 13);
+    Hash = Hash * 0xC2B2AE35UL;
     Hash = Hash ^ (Hash >> 16);
-    return (WORD)Hash;
+
+    return Hash;
+}
+
+/**
+ Attempt to double the number of buckets in a hash table, moving all
+ existing entries into the new buckets.  If memory cannot be allocated, the
+ table continues to operate with its existing buckets.
+
+ @param HashTable Pointer to the hash table to grow.
+ */
+VOID
+YoriLibHashGrow(
+    __in PYORI_HASH_TABLE HashTable
+    )
+{
+    PYORI_HASH_BUCKET NewBuckets;
+    YORI_ALLOC_SIZE_T NewNumberBuckets;
+    YORI_ALLOC_SIZE_T BucketIndex;
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_HASH_ENTRY HashEntry;
+
+    if (HashTable->NumberBuckets >= (YORI_MAX_ALLOC_SIZE / 2 / sizeof(YORI_HASH_BUCKET))) {
+        return;
+    }
+
+    NewNumberBuckets = HashTable->NumberBuckets * 2;
+    NewBuckets = YoriLibAllocateHashBuckets(NewNumberBuckets);
+    if (NewBuckets == NULL) {
+        return;
+    }
+
+    for (BucketIndex = 0; BucketIndex < HashTable->NumberBuckets; BucketIndex++) {
+        while (!YoriLibIsListEmpty(&HashTable->Buckets[BucketIndex].ListHead)) {
+            ListEntry = HashTable->Buckets[BucketIndex].ListHead.Next;
+            HashEntry = CONTAINING_RECORD(ListEntry, YORI_HASH_ENTRY, ListEntry);
+            YoriLibRemoveListItem(ListEntry);
+            YoriLibInsertList(&NewBuckets[HashEntry->Hash & (NewNumberBuckets - 1)].ListHead, ListEntry);
+        }
+    }
+
+    YoriLibFree(HashTable->Buckets);
+    HashTable->Buckets = NewBuckets;
+    HashTable->NumberBuckets = NewNumberBuckets;
 }
 
 /**
@@ -170,11 +274,20 @@ YoriLibHashInsertByKey(
     __out PYORI_HASH_ENTRY HashEntry
     )
 {
-    DWORD BucketIndex = YoriLibHashString(KeyString) % HashTable->NumberBuckets;
+    DWORD BucketIndex;
+
+    if (HashTable->EntryCount >= HashTable->NumberBuckets * YORI_HASH_MAX_LOAD_FACTOR) {
+        YoriLibHashGrow(HashTable);
+    }
+
+    HashEntry->Hash = YoriLibHashString(KeyString);
+    HashEntry->HashTable = HashTable;
+    BucketIndex = HashEntry->Hash & (HashTable->NumberBuckets - 1);
 
     YoriLibCloneString(&HashEntry->Key, KeyString);
     HashEntry->Context = Context;
     YoriLibInsertList(&HashTable->Buckets[BucketIndex].ListHead, &HashEntry->ListEntry);
+    HashTable->EntryCount++;
 }
 
 /**
@@ -193,7 +306,8 @@ YoriLibHashLookupByKey(
     __in PCYORI_STRING KeyString
     )
 {
-    DWORD BucketIndex = YoriLibHashString(KeyString) % HashTable->NumberBuckets;
+    DWORD Hash = YoriLibHashString(KeyString);
+    DWORD BucketIndex = Hash & (HashTable->NumberBuckets - 1);
     PYORI_LIST_ENTRY ListEntry;
     PYORI_HASH_ENTRY HashEntry;
 
@@ -201,7 +315,8 @@ YoriLibHashLookupByKey(
     ListEntry = YoriLibGetNextListEntry(&HashTable->Buckets[BucketIndex].ListHead, NULL);
     while (ListEntry != NULL) {
         HashEntry = CONTAINING_RECORD(ListEntry, YORI_HASH_ENTRY, ListEntry);
-        if (YoriLibCompareStringIns(KeyString, &HashEntry->Key) == 0) {
+        if (HashEntry->Hash == Hash &&
+            YoriLibCompareStringIns(KeyString, &HashEntry->Key) == 0) {
             break;
         }
         HashEntry = NULL;
@@ -222,6 +337,9 @@ YoriLibHashRemoveByEntry(
     __in PYORI_HASH_ENTRY HashEntry
     )
 {
+    ASSERT(HashEntry->HashTable->EntryCount > 0);
+    HashEntry->HashTable->EntryCount--;
+    HashEntry->HashTable = NULL;
     YoriLibRemoveListItem(&HashEntry->ListEntry);
     YoriLibFreeStringContents(&HashEntry->Key);
 }
@@ -939,6 +939,7 @@ YoriLibHexDiff(
     YORI_ALLOC_SIZE_T BufferLengths[2];
     YORI_STRING LineBuffer;
     YORI_STRING Subset;
+    YORI_LIB_OUTPUT_BUFFER OutputBuffer;
 
     if (BytesPerWord != 1 && BytesPerWord != 2 && BytesPerWord != 4 && BytesPerWord != 8) {
         return FALSE;
@@ -948,6 +949,11 @@ YoriLibHexDiff(
         return FALSE;
     }
 
+    if (!YoriLibOutputBufferInitialize(&OutputBuffer, GetStdHandle(STD_OUTPUT_HANDLE))) {
+        YoriLibFreeStringContents(&LineBuffer);
+        return FALSE;
+    }
+
     Subset.StartOfString = LineBuffer.StartOfString;
     Subset.LengthInChars = 0;
     Subset.LengthAllocated = LineBuffer.LengthAllocated;
@@ -1137,13 +1143,14 @@ YoriLibHexDiff(
             Subset.StartOfString++;
             LineBuffer.LengthInChars++;
         }
-        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y"), &LineBuffer);
+        YoriLibOutputStringToBuffer(&OutputBuffer, 0, &LineBuffer);
         LineBuffer.LengthInChars = 0;
         Subset.StartOfString = LineBuffer.StartOfString;
         Subset.LengthInChars = LineBuffer.LengthInChars;
         Subset.LengthAllocated = LineBuffer.LengthAllocated;
     }
 
+    YoriLibOutputBufferCleanup(&OutputBuffer);
     YoriLibFreeStringContents(&LineBuffer);
     return TRUE;
 }
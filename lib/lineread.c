@@ -27,6 +27,18 @@
 #include "yoripch.h"
 #include "yorilib.h"
 
+/**
+ Indicates whether this compiler can generate SSE2 instructions through
+ intrinsics.  The instructions are only executed if the processor is found
+ to support them at runtime.
+ */
+#if defined(_MSC_VER) && (_MSC_VER >= 1400) && (defined(_M_AMD64) || defined(_M_IX86))
+#define YORI_LIB_LINE_READ_SSE2 1
+#include <emmintrin.h>
+#else
+#define YORI_LIB_LINE_READ_SSE2 0
+#endif
+
 /**
  Context to be passed between repeated line read calls to contain data
  that doesn't constitute a whole line but cannot be left in the incoming
@@ -380,17 +392,312 @@ YoriLibLineReadCleanupCache(VOID)
 
 
 /**
- Read a line from an input stream.
+ A machine word where every byte contains the value 1.
+ */
+#define YORI_LIB_SWAR_ONES8    ((DWORD_PTR)-1 / 0xFF)
 
- @param UserString Pointer to a string to be updated to contain data for a
-        line.  This must be initialized by the caller and the caller's buffer
-        will be used if it is large enough.  If not, this function may
-        reallocate the string to point to a new buffer.
+/**
+ A machine word where every byte has its high bit set.
+ */
+#define YORI_LIB_SWAR_HIGHS8   (YORI_LIB_SWAR_ONES8 * 0x80)
+
+/**
+ A machine word where every 16 bit element contains the value 1.
+ */
+#define YORI_LIB_SWAR_ONES16   ((DWORD_PTR)-1 / 0xFFFF)
+
+/**
+ A machine word where every 16 bit element has its high bit set.
+ */
+#define YORI_LIB_SWAR_HIGHS16  (YORI_LIB_SWAR_ONES16 * 0x8000)
+
+/**
+ Evaluates to nonzero if any byte in a machine word is zero.  This can
+ report false positives in bytes following a zero byte, but never reports
+ a zero byte when none exists, so it is suitable for testing whether a word
+ needs to be examined in more detail.
+ */
+#define YORI_LIB_SWAR_HAS_ZERO8(x)  (((x) - YORI_LIB_SWAR_ONES8) & ~(x) & YORI_LIB_SWAR_HIGHS8)
+
+/**
+ Evaluates to nonzero if any 16 bit element in a machine word is zero.
+ */
+#define YORI_LIB_SWAR_HAS_ZERO16(x) (((x) - YORI_LIB_SWAR_ONES16) & ~(x) & YORI_LIB_SWAR_HIGHS16)
+
+/**
+ Search a buffer of 8 bit characters for a carriage return or line feed,
+ examining a machine word at a time.  This is used on processors without
+ a vector unit and to handle any tail that is too small for one.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param Length The number of characters in the buffer.
+
+ @return The offset of the first line terminator, or Length if no line
+         terminator is present.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorWordA(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    DWORD_PTR Word;
+    DWORD_PTR CrWord;
+    DWORD_PTR LfWord;
+
+    Index = 0;
+
+    //
+    //  Check individual characters until the buffer is aligned so that
+    //  word reads never cross a page that the buffer doesn't touch.
+    //
+
+    while (Index < Length &&
+           (((DWORD_PTR)&Buffer[Index]) & (sizeof(DWORD_PTR) - 1)) != 0) {
+
+        if (Buffer[Index] == 0xD || Buffer[Index] == 0xA) {
+            return Index;
+        }
+        Index++;
+    }
+
+    while (Index + sizeof(DWORD_PTR) <= Length) {
+        Word = *(PDWORD_PTR)&Buffer[Index];
+        CrWord = Word ^ (YORI_LIB_SWAR_ONES8 * 0xD);
+        LfWord = Word ^ (YORI_LIB_SWAR_ONES8 * 0xA);
+        if (YORI_LIB_SWAR_HAS_ZERO8(CrWord) || YORI_LIB_SWAR_HAS_ZERO8(LfWord)) {
+            break;
+        }
+        Index = Index + (YORI_ALLOC_SIZE_T)sizeof(DWORD_PTR);
+    }
+
+    for (; Index < Length; Index++) {
+        if (Buffer[Index] == 0xD || Buffer[Index] == 0xA) {
+            return Index;
+        }
+    }
+
+    return Length;
+}
+
+/**
+ Search a buffer of 16 bit characters for a carriage return or line feed,
+ examining a machine word at a time.  This is used on processors without
+ a vector unit and to handle any tail that is too small for one.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param Length The number of characters in the buffer.
+
+ @return The offset of the first line terminator, in characters, or Length
+         if no line terminator is present.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorWordW(
+    __in PWCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    DWORD_PTR Word;
+    DWORD_PTR CrWord;
+    DWORD_PTR LfWord;
+
+    Index = 0;
+
+    while (Index < Length &&
+           (((DWORD_PTR)&Buffer[Index]) & (sizeof(DWORD_PTR) - 1)) != 0) {
+
+        if (Buffer[Index] == 0xD || Buffer[Index] == 0xA) {
+            return Index;
+        }
+        Index++;
+    }
+
+    while (Index + sizeof(DWORD_PTR) / sizeof(WCHAR) <= Length) {
+        Word = *(PDWORD_PTR)&Buffer[Index];
+        CrWord = Word ^ (YORI_LIB_SWAR_ONES16 * 0xD);
+        LfWord = Word ^ (YORI_LIB_SWAR_ONES16 * 0xA);
+        if (YORI_LIB_SWAR_HAS_ZERO16(CrWord) || YORI_LIB_SWAR_HAS_ZERO16(LfWord)) {
+            break;
+        }
+        Index = Index + (YORI_ALLOC_SIZE_T)(sizeof(DWORD_PTR) / sizeof(WCHAR));
+    }
+
+    for (; Index < Length; Index++) {
+        if (Buffer[Index] == 0xD || Buffer[Index] == 0xA) {
+            return Index;
+        }
+    }
+
+    return Length;
+}
+
+#if YORI_LIB_LINE_READ_SSE2
+/**
+ Search a buffer of 8 bit characters for a carriage return or line feed,
+ examining 16 characters at a time using SSE2.  The caller is expected to
+ have checked that the processor supports SSE2.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param Length The number of characters in the buffer.
+
+ @return The offset of the first line terminator, or Length if no line
+         terminator is present.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorSse2A(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    __m128i Cr;
+    __m128i Lf;
+    __m128i Chunk;
+    int Mask;
+
+    Cr = _mm_set1_epi8(0xD);
+    Lf = _mm_set1_epi8(0xA);
+    Index = 0;
+
+    while (Index + sizeof(__m128i) <= Length) {
+        Chunk = _mm_loadu_si128((__m128i *)&Buffer[Index]);
+        Mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Chunk, Cr),
+                                              _mm_cmpeq_epi8(Chunk, Lf)));
+        if (Mask != 0) {
+            while ((Mask & 1) == 0) {
+                Mask = Mask >> 1;
+                Index++;
+            }
+            return Index;
+        }
+        Index = Index + (YORI_ALLOC_SIZE_T)sizeof(__m128i);
+    }
+
+    return Index + YoriLibFindLineTerminatorWordA(&Buffer[Index], Length - Index);
+}
+
+/**
+ Search a buffer of 16 bit characters for a carriage return or line feed,
+ examining 8 characters at a time using SSE2.  The caller is expected to
+ have checked that the processor supports SSE2.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param Length The number of characters in the buffer.
+
+ @return The offset of the first line terminator, in characters, or Length
+         if no line terminator is present.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorSse2W(
+    __in PWCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    __m128i Cr;
+    __m128i Lf;
+    __m128i Chunk;
+    int Mask;
+
+    Cr = _mm_set1_epi16(0xD);
+    Lf = _mm_set1_epi16(0xA);
+    Index = 0;
+
+    while (Index + sizeof(__m128i) / sizeof(WCHAR) <= Length) {
+        Chunk = _mm_loadu_si128((__m128i *)&Buffer[Index]);
+        Mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi16(Chunk, Cr),
+                                              _mm_cmpeq_epi16(Chunk, Lf)));
+        if (Mask != 0) {
+
+            //
+            //  Each matching character sets two bits in the mask.
+            //
+
+            while ((Mask & 3) == 0) {
+                Mask = Mask >> 2;
+                Index++;
+            }
+            return Index;
+        }
+        Index = Index + (YORI_ALLOC_SIZE_T)(sizeof(__m128i) / sizeof(WCHAR));
+    }
+
+    return Index + YoriLibFindLineTerminatorWordW(&Buffer[Index], Length - Index);
+}
+#endif
+
+/**
+ Search a buffer of 8 bit characters for a carriage return or line feed.
+ This uses vector instructions if the processor supports them, and falls
+ back to examining a machine word at a time if it does not.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param Length The number of characters in the buffer.
+
+ @return The offset of the first line terminator, or Length if no line
+         terminator is present.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorA(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+#if YORI_LIB_LINE_READ_SSE2
+    if (Length >= sizeof(__m128i) && YoriLibIsSse2Available()) {
+        return YoriLibFindLineTerminatorSse2A(Buffer, Length);
+    }
+#endif
+    return YoriLibFindLineTerminatorWordA(Buffer, Length);
+}
+
+/**
+ Search a buffer of 16 bit characters for a carriage return or line feed.
+ This uses vector instructions if the processor supports them, and falls
+ back to examining a machine word at a time if it does not.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param Length The number of characters in the buffer.
+
+ @return The offset of the first line terminator, in characters, or Length
+         if no line terminator is present.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorW(
+    __in PWCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+#if YORI_LIB_LINE_READ_SSE2
+    if (Length >= sizeof(__m128i) / sizeof(WCHAR) && YoriLibIsSse2Available()) {
+        return YoriLibFindLineTerminatorSse2W(Buffer, Length);
+    }
+#endif
+    return YoriLibFindLineTerminatorWordW(Buffer, Length);
+}
+
+/**
+ Find the next line in an input stream and describe its location within the
+ line read context's buffer.  The line is not copied or converted.  The
+ returned view remains valid until the next call that uses the same context.
+
+ @param View On successful completion, updated to describe the line.
 
  @param Context Pointer to a PVOID sized block of memory that should be
         initialized to NULL for the first line read, and will be updated by
         this function.
 
+ @param MinimumBufferLength The smallest buffer, in bytes, to read into.  A
+        line which does not fit in the buffer cannot be returned.
+
  @param ReturnFinalNonTerminatedLine If TRUE, treat any line at the end of the
         stream without a line ending character to be a line to return.  If
         FALSE, assume new input could arrive that means we just haven't
@@ -399,30 +706,26 @@ YoriLibLineReadCleanupCache(VOID)
  @param MaximumDelay Specifies the maximum amount of time to wait for a
         complete line.  This value can be INFINITE or a specified number of
         milliseconds.  If the timeout value is reached, TimeoutReached will
-        be set to true and the function will return NULL.
+        be set to true and the function will return FALSE.
 
  @param FileHandle Specifies the handle to the file to read the line from.
 
- @param LineEnding On successful completion, set to indicate the string of
-        characters used to terminate the line.  Can be YoriLibLineEndingNone
-        to indicate no line end was found, which can happen if
-        ReturnFinalNonTerminatedLine is TRUE or MaximumDelay is less than
-        infinite and a partial line was found.
-
  @param TimeoutReached On successful completion, set to TRUE to indicate that
         the timeout value in MaximumDelay was reached.  If MaximumDelay is
         INFINITE, this cannot happen.
 
- @return Pointer to the Line buffer for success, NULL on failure.
+ @return TRUE to indicate a line was found, FALSE if no further lines can be
+         returned.
  */
-PVOID
-YoriLibReadLineToStringEx(
-    __in PYORI_STRING UserString,
+__success(return)
+BOOL
+YoriLibReadLineToViewInternal(
+    __out PYORI_LIB_LINE_VIEW View,
     __inout PVOID * Context,
+    __in YORI_ALLOC_SIZE_T MinimumBufferLength,
     __in BOOL ReturnFinalNonTerminatedLine,
     __in DWORD MaximumDelay,
     __in HANDLE FileHandle,
-    __out PYORI_LIB_LINE_ENDING LineEnding,
     __out PBOOL TimeoutReached
     )
 {
@@ -444,6 +747,10 @@ YoriLibReadLineToStringEx(
     YORI_LIB_LINE_ENDING LocalLineEnding;
 
     *TimeoutReached = FALSE;
+    View->Data = NULL;
+    View->LengthInChars = 0;
+    View->WideChars = FALSE;
+    View->LineEnding = YoriLibLineEndingNone;
 
     //
     //  If we don't have a line read context yet, allocate one.
@@ -452,9 +759,7 @@ YoriLibReadLineToStringEx(
     if (*Context == NULL) {
         ReadContext = YoriLibReadLineAllocateContext();
         if (ReadContext == NULL) {
-            UserString->LengthInChars = 0;
-            *LineEnding = YoriLibLineEndingNone;
-            return NULL;
+            return FALSE;
         }
         *Context = ReadContext;
         ReadContext->BytesInBuffer = 0;
@@ -470,36 +775,46 @@ YoriLibReadLineToStringEx(
     } else {
         ReadContext = *Context;
         if (ReadContext->Terminated) {
-            return NULL;
+            return FALSE;
         }
     }
 
+    View->WideChars = ReadContext->ReadWChars;
+
     //
-    //  If the line read context doesn't have a buffer yet, allocate it
+    //  If the line read context doesn't have a buffer yet, allocate it.  If
+    //  it has a buffer that is too small, allocate a larger one, preserving
+    //  any data that has been read but not yet returned.
     //
 
-    if (ReadContext->PreviousBuffer == NULL || UserString->LengthAllocated > ReadContext->LengthOfBuffer) {
+    if (ReadContext->PreviousBuffer == NULL || MinimumBufferLength > ReadContext->LengthOfBuffer) {
         YORI_ALLOC_SIZE_T MinBufferSize;
-        if (ReadContext->PreviousBuffer != NULL) {
-            YoriLibFree(ReadContext->PreviousBuffer);
-            ReadContext->PreviousBuffer = NULL;
-        }
+        YORI_ALLOC_SIZE_T NewLength;
+        LPSTR NewBuffer;
 
         //
         //  MSFIX: Need to adjust this for smaller alloc size limits
         //
-        ReadContext->LengthOfBuffer = UserString->LengthAllocated;
+        NewLength = MinimumBufferLength;
         MinBufferSize = YoriLibMaximumAllocationInRange(60 * 1024, 256 * 1024);
-        if (ReadContext->LengthOfBuffer < MinBufferSize) {
-            ReadContext->LengthOfBuffer = MinBufferSize;
+        if (NewLength < MinBufferSize) {
+            NewLength = MinBufferSize;
         }
-        ReadContext->PreviousBuffer = YoriLibMalloc(ReadContext->LengthOfBuffer);
-        if (ReadContext->PreviousBuffer == NULL) {
-            UserString->LengthInChars = 0;
-            *LineEnding = YoriLibLineEndingNone;
+        NewBuffer = YoriLibMalloc(NewLength);
+        if (NewBuffer == NULL) {
             ReadContext->Terminated = TRUE;
-            return NULL;
+            return FALSE;
         }
+        if (ReadContext->PreviousBuffer != NULL) {
+            memcpy(NewBuffer,
+                   YoriLibAddToPointer(ReadContext->PreviousBuffer, ReadContext->CurrentBufferOffset),
+                   ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset);
+            YoriLibFree(ReadContext->PreviousBuffer);
+        }
+        ReadContext->BytesInBuffer = ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset;
+        ReadContext->CurrentBufferOffset = 0;
+        ReadContext->PreviousBuffer = NewBuffer;
+        ReadContext->LengthOfBuffer = NewLength;
     }
 
     do {
@@ -509,7 +824,7 @@ YoriLibReadLineToStringEx(
 
         //
         //  Scan through the buffer looking for newlines.  If we find one,
-        //  copy the data back into the caller's buffer.  Copy any remaining
+        //  return its location to the caller.  Copy any remaining
         //  buffer back to the beginning of the holdover buffer, and
         //  decrement chars there accordingly.
         //
@@ -517,103 +832,98 @@ YoriLibReadLineToStringEx(
         if (ReadContext->ReadWChars) {
             PWCHAR WideBuffer = (PWCHAR)YoriLibAddToPointer(ReadContext->PreviousBuffer, ReadContext->CurrentBufferOffset);
             CharsRemaining = (ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset) / sizeof(WCHAR);
-            for (Count = 0; Count < CharsRemaining; Count++) {
-                if (WideBuffer[Count] == 0xD ||
-                    WideBuffer[Count] == 0xA) {
-
-                    ProcessThisLine = TRUE;
-
-                    CharsToCopy = Count;
-                    LocalLineEnding = YoriLibLineEndingCR;
-                    if (WideBuffer[Count] == 0xD) {
-                        if ((Count + 1) * sizeof(WCHAR) < (ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset)) {
-                            if (WideBuffer[Count + 1] == 0xA) {
-                                Count++;
-                                LocalLineEnding = YoriLibLineEndingCRLF;
-                            }
-                        } else if (ReadContext->CurrentBufferOffset > 0) {
-                            ProcessThisLine = FALSE;
+            Count = 0;
+            while (Count < CharsRemaining) {
+
+                Count = Count + YoriLibFindLineTerminatorW(&WideBuffer[Count], CharsRemaining - Count);
+                if (Count >= CharsRemaining) {
+                    break;
+                }
+
+                ProcessThisLine = TRUE;
+
+                CharsToCopy = Count;
+                LocalLineEnding = YoriLibLineEndingCR;
+                if (WideBuffer[Count] == 0xD) {
+                    if ((Count + 1) * sizeof(WCHAR) < (ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset)) {
+                        if (WideBuffer[Count + 1] == 0xA) {
+                            Count++;
+                            LocalLineEnding = YoriLibLineEndingCRLF;
                         }
-                    } else {
-                        LocalLineEnding = YoriLibLineEndingLF;
+                    } else if (ReadContext->CurrentBufferOffset > 0) {
+                        ProcessThisLine = FALSE;
                     }
+                } else {
+                    LocalLineEnding = YoriLibLineEndingLF;
+                }
 
-                    Count++;
+                Count++;
 
-                    if (ProcessThisLine) {
+                if (ProcessThisLine) {
 
-                        CharsToSkip = 0;
-                        if (!BomFound && ReadContext->LinesRead == 0) {
-                            CharsToSkip = YoriLibBytesInBom((PUCHAR)ReadContext->PreviousBuffer, CharsToCopy * sizeof(WCHAR));
-                            if (CharsToSkip > 0) {
-                                BomFound = TRUE;
-                                CharsToSkip = CharsToSkip / sizeof(WCHAR);
-                                CharsToCopy = CharsToCopy - CharsToSkip;
-                            }
-                        }
-                        if (YoriLibCopyLineToUserBufferW(UserString, (LPSTR)&WideBuffer[CharsToSkip], CharsToCopy)) {
-                            ReadContext->CurrentBufferOffset = ReadContext->CurrentBufferOffset + Count * sizeof(WCHAR);
-                            ReadContext->LinesRead++;
-                            *LineEnding = LocalLineEnding;
-                            return UserString->StartOfString;
-                        } else {
-                            UserString->LengthInChars = 0;
-                            *LineEnding = YoriLibLineEndingNone;
-                            ReadContext->Terminated = TRUE;
-                            return NULL;
+                    CharsToSkip = 0;
+                    if (!BomFound && ReadContext->LinesRead == 0) {
+                        CharsToSkip = YoriLibBytesInBom((PUCHAR)ReadContext->PreviousBuffer, CharsToCopy * sizeof(WCHAR));
+                        if (CharsToSkip > 0) {
+                            BomFound = TRUE;
+                            CharsToSkip = CharsToSkip / sizeof(WCHAR);
+                            CharsToCopy = CharsToCopy - CharsToSkip;
                         }
                     }
+                    View->Data = &WideBuffer[CharsToSkip];
+                    View->LengthInChars = CharsToCopy;
+                    View->LineEnding = LocalLineEnding;
+                    ReadContext->CurrentBufferOffset = ReadContext->CurrentBufferOffset + Count * sizeof(WCHAR);
+                    ReadContext->LinesRead++;
+                    return TRUE;
                 }
             }
         } else {
             PUCHAR Buffer = YoriLibAddToPointer(ReadContext->PreviousBuffer, ReadContext->CurrentBufferOffset);
             CharsRemaining = ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset;
-            for (Count = 0; Count < CharsRemaining; Count++) {
-
-                if (Buffer[Count] == 0xD ||
-                    Buffer[Count] == 0xA) {
-
-                    ProcessThisLine = TRUE;
-
-                    CharsToCopy = Count;
-                    LocalLineEnding = YoriLibLineEndingCR;
-                    if (Buffer[Count] == 0xD) {
-                        if (Count + 1 < (ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset)) {
-                            if (Buffer[Count + 1] == 0xA) {
-                                Count++;
-                                LocalLineEnding = YoriLibLineEndingCRLF;
-                            }
-                        } else if (ReadContext->CurrentBufferOffset > 0) {
-                            ProcessThisLine = FALSE;
+            Count = 0;
+            while (Count < CharsRemaining) {
+
+                Count = Count + YoriLibFindLineTerminatorA(&Buffer[Count], CharsRemaining - Count);
+                if (Count >= CharsRemaining) {
+                    break;
+                }
+
+                ProcessThisLine = TRUE;
+
+                CharsToCopy = Count;
+                LocalLineEnding = YoriLibLineEndingCR;
+                if (Buffer[Count] == 0xD) {
+                    if (Count + 1 < (ReadContext->BytesInBuffer - ReadContext->CurrentBufferOffset)) {
+                        if (Buffer[Count + 1] == 0xA) {
+                            Count++;
+                            LocalLineEnding = YoriLibLineEndingCRLF;
                         }
-                    } else {
-                        LocalLineEnding = YoriLibLineEndingLF;
+                    } else if (ReadContext->CurrentBufferOffset > 0) {
+                        ProcessThisLine = FALSE;
                     }
+                } else {
+                    LocalLineEnding = YoriLibLineEndingLF;
+                }
 
-                    Count++;
+                Count++;
 
-                    if (ProcessThisLine) {
+                if (ProcessThisLine) {
 
-                        CharsToSkip = 0;
-                        if (!BomFound && ReadContext->LinesRead == 0) {
-                            CharsToSkip = YoriLibBytesInBom((PUCHAR)ReadContext->PreviousBuffer, CharsToCopy);
-                            if (CharsToSkip > 0) {
-                                BomFound = TRUE;
-                                CharsToCopy = CharsToCopy - CharsToSkip;
-                            }
-                        }
-                        if (YoriLibCopyLineToUserBufferW(UserString, (LPSTR)&Buffer[CharsToSkip], CharsToCopy)) {
-                            ReadContext->CurrentBufferOffset = ReadContext->CurrentBufferOffset + Count;
-                            ReadContext->LinesRead++;
-                            *LineEnding = LocalLineEnding;
-                            return UserString->StartOfString;
-                        } else {
-                            UserString->LengthInChars = 0;
-                            *LineEnding = YoriLibLineEndingNone;
-                            ReadContext->Terminated = TRUE;
-                            return NULL;
+                    CharsToSkip = 0;
+                    if (!BomFound && ReadContext->LinesRead == 0) {
+                        CharsToSkip = YoriLibBytesInBom((PUCHAR)ReadContext->PreviousBuffer, CharsToCopy);
+                        if (CharsToSkip > 0) {
+                            BomFound = TRUE;
+                            CharsToCopy = CharsToCopy - CharsToSkip;
                         }
                     }
+                    View->Data = &Buffer[CharsToSkip];
+                    View->LengthInChars = CharsToCopy;
+                    View->LineEnding = LocalLineEnding;
+                    ReadContext->CurrentBufferOffset = ReadContext->CurrentBufferOffset + Count;
+                    ReadContext->LinesRead++;
+                    return TRUE;
                 }
             }
         }
@@ -639,10 +949,8 @@ YoriLibReadLineToStringEx(
         //
 
         if (ReadContext->LengthOfBuffer == ReadContext->BytesInBuffer) {
-            UserString->LengthInChars = 0;
-            *LineEnding = YoriLibLineEndingNone;
             ReadContext->Terminated = TRUE;
-            return NULL;
+            return FALSE;
         }
 
         //
@@ -819,16 +1127,13 @@ YoriLibReadLineToStringEx(
                     if (ReadContext->ReadWChars) {
                         CharsToCopy = CharsToCopy / sizeof(WCHAR);
                     }
-                    if (YoriLibCopyLineToUserBufferW(UserString, &ReadContext->PreviousBuffer[CharsToSkip], CharsToCopy)) {
-                        ReadContext->BytesInBuffer = 0;
-                        *LineEnding = YoriLibLineEndingNone;
-                        return UserString->StartOfString;
-                    }
+                    View->Data = &ReadContext->PreviousBuffer[CharsToSkip];
+                    View->LengthInChars = CharsToCopy;
+                    ReadContext->BytesInBuffer = 0;
+                    return TRUE;
                 }
             }
-            UserString->LengthInChars = 0;
-            *LineEnding = YoriLibLineEndingNone;
-            return NULL;
+            return FALSE;
         }
 
         ReadContext->BytesInBuffer = ReadContext->BytesInBuffer + (YORI_ALLOC_SIZE_T)BytesRead;
@@ -836,6 +1141,204 @@ YoriLibReadLineToStringEx(
     } while(TRUE);
 }
 
+/**
+ Read a line from an input stream.
+
+ @param UserString Pointer to a string to be updated to contain data for a
+        line.  This must be initialized by the caller and the caller's buffer
+        will be used if it is large enough.  If not, this function may
+        reallocate the string to point to a new buffer.
+
+ @param Context Pointer to a PVOID sized block of memory that should be
+        initialized to NULL for the first line read, and will be updated by
+        this function.
+
+ @param ReturnFinalNonTerminatedLine If TRUE, treat any line at the end of the
+        stream without a line ending character to be a line to return.  If
+        FALSE, assume new input could arrive that means we just haven't
+        observed the line break yet.
+
+ @param MaximumDelay Specifies the maximum amount of time to wait for a
+        complete line.  This value can be INFINITE or a specified number of
+        milliseconds.  If the timeout value is reached, TimeoutReached will
+        be set to true and the function will return NULL.
+
+ @param FileHandle Specifies the handle to the file to read the line from.
+
+ @param LineEnding On successful completion, set to indicate the string of
+        characters used to terminate the line.  Can be YoriLibLineEndingNone
+        to indicate no line end was found, which can happen if
+        ReturnFinalNonTerminatedLine is TRUE or MaximumDelay is less than
+        infinite and a partial line was found.
+
+ @param TimeoutReached On successful completion, set to TRUE to indicate that
+        the timeout value in MaximumDelay was reached.  If MaximumDelay is
+        INFINITE, this cannot happen.
+
+ @return Pointer to the Line buffer for success, NULL on failure.
+ */
+PVOID
+YoriLibReadLineToStringEx(
+    __in PYORI_STRING UserString,
+    __inout PVOID * Context,
+    __in BOOL ReturnFinalNonTerminatedLine,
+    __in DWORD MaximumDelay,
+    __in HANDLE FileHandle,
+    __out PYORI_LIB_LINE_ENDING LineEnding,
+    __out PBOOL TimeoutReached
+    )
+{
+    YORI_LIB_LINE_VIEW View;
+
+    if (!YoriLibReadLineToViewInternal(&View,
+                                       Context,
+                                       UserString->LengthAllocated,
+                                       ReturnFinalNonTerminatedLine,
+                                       MaximumDelay,
+                                       FileHandle,
+                                       TimeoutReached)) {
+
+        UserString->LengthInChars = 0;
+        *LineEnding = YoriLibLineEndingNone;
+        return NULL;
+    }
+
+    if (!YoriLibCopyLineToUserBufferW(UserString, View.Data, View.LengthInChars)) {
+        PYORI_LIB_LINE_READ_CONTEXT ReadContext = (PYORI_LIB_LINE_READ_CONTEXT)*Context;
+        UserString->LengthInChars = 0;
+        *LineEnding = YoriLibLineEndingNone;
+        ReadContext->Terminated = TRUE;
+        return NULL;
+    }
+
+    *LineEnding = View.LineEnding;
+    return UserString->StartOfString;
+}
+
+/**
+ Return a view of the next line in an input stream without copying it or
+ converting it from its input encoding.  This is intended for consumers that
+ only need to count or inspect lines, and can request conversion for the
+ subset of lines they need with YoriLibLineViewToString.  The view refers to
+ memory owned by the line read context and is only valid until the next call
+ using the same context.  Line read contexts used with this function read
+ from the stream in large blocks, and can be released with
+ YoriLibLineReadClose or YoriLibLineReadCloseOrCache.
+
+ @param View On successful completion, updated to describe the line.
+
+ @param Context Pointer to a PVOID sized block of memory that should be
+        initialized to NULL for the first line read, and will be updated by
+        this function.
+
+ @param ReturnFinalNonTerminatedLine If TRUE, treat any line at the end of the
+        stream without a line ending character to be a line to return.  If
+        FALSE, assume new input could arrive that means we just haven't
+        observed the line break yet.
+
+ @param MaximumDelay Specifies the maximum amount of time to wait for a
+        complete line.  This value can be INFINITE or a specified number of
+        milliseconds.  If the timeout value is reached, TimeoutReached will
+        be set to true and the function will return FALSE.
+
+ @param FileHandle Specifies the handle to the file to read the line from.
+
+ @param TimeoutReached On successful completion, set to TRUE to indicate that
+        the timeout value in MaximumDelay was reached.  If MaximumDelay is
+        INFINITE, this cannot happen.
+
+ @return TRUE to indicate a line was found, FALSE if no further lines can be
+         returned.
+ */
+__success(return)
+BOOL
+YoriLibReadLineToViewEx(
+    __out PYORI_LIB_LINE_VIEW View,
+    __inout PVOID * Context,
+    __in BOOL ReturnFinalNonTerminatedLine,
+    __in DWORD MaximumDelay,
+    __in HANDLE FileHandle,
+    __out PBOOL TimeoutReached
+    )
+{
+    return YoriLibReadLineToViewInternal(View,
+                                         Context,
+                                         YoriLibMaximumAllocationInRange(256 * 1024, 1024 * 1024),
+                                         ReturnFinalNonTerminatedLine,
+                                         MaximumDelay,
+                                         FileHandle,
+                                         TimeoutReached);
+}
+
+/**
+ Return a view of the next line in an input stream without copying it or
+ converting it from its input encoding.  The view is only valid until the
+ next call using the same context.
+
+ @param View On successful completion, updated to describe the line.
+
+ @param Context Pointer to a PVOID sized block of memory that should be
+        initialized to NULL for the first line read, and will be updated by
+        this function.
+
+ @param FileHandle Specifies the handle to the file to read the line from.
+
+ @return TRUE to indicate a line was found, FALSE if no further lines can be
+         returned.
+ */
+__success(return)
+BOOL
+YoriLibReadLineToView(
+    __out PYORI_LIB_LINE_VIEW View,
+    __inout PVOID * Context,
+    __in HANDLE FileHandle
+    )
+{
+    BOOL TimeoutReached;
+
+    return YoriLibReadLineToViewEx(View, Context, TRUE, INFINITE, FileHandle, &TimeoutReached);
+}
+
+/**
+ Convert a line returned from YoriLibReadLineToView into a string in host
+ (UTF16) encoding.  If the string is not large enough, it is reallocated.
+
+ @param View Pointer to the line to convert.
+
+ @param UserString The user provided string to populate with the line.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriLibLineViewToString(
+    __in PYORI_LIB_LINE_VIEW View,
+    __inout PYORI_STRING UserString
+    )
+{
+    return YoriLibCopyLineToUserBufferW(UserString, View->Data, View->LengthInChars);
+}
+
+/**
+ Return the number of characters that a line returned from
+ YoriLibReadLineToView would contain after conversion to host (UTF16)
+ encoding, without performing the conversion.
+
+ @param View Pointer to the line.
+
+ @return The number of characters in the line.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibLineViewGetLengthInChars(
+    __in PYORI_LIB_LINE_VIEW View
+    )
+{
+    if (View->LengthInChars == 0) {
+        return 0;
+    }
+    return (YORI_ALLOC_SIZE_T)YoriLibGetMultibyteInputSizeNeeded(View->Data, View->LengthInChars);
+}
+
 /**
  Read a line from an input stream.
 
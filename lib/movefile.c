@@ -201,6 +201,49 @@ YoriLibMoveFile(
     return ERROR_SUCCESS;
 }
 
+/**
+ Perform a single attempt to copy a file.  If flags are specified and the
+ system supports CopyFileEx, the flags are passed through.  If the system
+ rejects the flags as invalid, the copy is retried without them, since the
+ flags are performance hints and the copy should not fail because of them.
+
+ @param SourceFile The source file name, expected to be NULL terminated.
+
+ @param DestFile The destination file name, expected to be NULL terminated.
+
+ @param CopyFlags Flags to pass to CopyFileEx, or zero for none.
+
+ @return TRUE to indicate success, FALSE to indicate failure.  On failure,
+         the error is available from GetLastError.
+ */
+BOOL
+YoriLibCopyFileOnce(
+    __in PYORI_STRING SourceFile,
+    __in PYORI_STRING DestFile,
+    __in DWORD CopyFlags
+    )
+{
+    BOOL Result;
+    BOOL Cancelled;
+
+    if (CopyFlags != 0 && DllKernel32.pCopyFileExW != NULL) {
+        Cancelled = FALSE;
+        Result = DllKernel32.pCopyFileExW(SourceFile->StartOfString, DestFile->StartOfString, NULL, NULL, &Cancelled, CopyFlags);
+        if (Result || GetLastError() != ERROR_INVALID_PARAMETER) {
+            return Result;
+        }
+    }
+
+    if (DllKernel32.pCopyFileW != NULL) {
+        Result = DllKernel32.pCopyFileW(SourceFile->StartOfString, DestFile->StartOfString, FALSE);
+    } else {
+        Cancelled = FALSE;
+        Result = DllKernel32.pCopyFileExW(SourceFile->StartOfString, DestFile->StartOfString, NULL, NULL, &Cancelled, 0);
+    }
+
+    return Result;
+}
+
 /**
  Call CopyFile, and if the operation fails, check if it's due to readonly,
  hidden or system attributes on the target, clear those and retry.
@@ -209,20 +252,24 @@ YoriLibMoveFile(
 
  @param DestFile The destination file name, expected to be NULL terminated.
 
+ @param CopyFlags Flags to pass to CopyFileEx, such as
+        COPY_FILE_NO_BUFFERING.  These are treated as hints: if the system
+        cannot honor them the copy is performed without them.
+
  @return The Win32 error code, possibly ERROR_SUCCESS or appropriate error
          on failure.
  */
 DWORD
-YoriLibCopyFile(
+YoriLibCopyFileWithFlags(
     __in PYORI_STRING SourceFile,
-    __in PYORI_STRING DestFile
+    __in PYORI_STRING DestFile,
+    __in DWORD CopyFlags
     )
 {
     DWORD Error;
     DWORD Attributes;
     DWORD NewAttributes;
     BOOL Result;
-    BOOL Cancelled;
 
     ASSERT(YoriLibIsStringNullTerminated(SourceFile));
     ASSERT(YoriLibIsStringNullTerminated(DestFile));
@@ -234,12 +281,7 @@ YoriLibCopyFile(
     }
 
     Error = ERROR_SUCCESS;
-    if (DllKernel32.pCopyFileW != NULL) {
-        Result = DllKernel32.pCopyFileW(SourceFile->StartOfString, DestFile->StartOfString, FALSE);
-    } else {
-        Cancelled = FALSE;
-        Result = DllKernel32.pCopyFileExW(SourceFile->StartOfString, DestFile->StartOfString, NULL, NULL, &Cancelled, 0);
-    }
+    Result = YoriLibCopyFileOnce(SourceFile, DestFile, CopyFlags);
     if (!Result) {
         Error = GetLastError();
         if (Error == ERROR_ACCESS_DENIED) {
@@ -252,13 +294,7 @@ YoriLibCopyFile(
                     return Error;
                 }
 
-                if (DllKernel32.pCopyFileW != NULL) {
-                    Result = DllKernel32.pCopyFileW(SourceFile->StartOfString, DestFile->StartOfString, FALSE);
-                } else {
-                    Cancelled = FALSE;
-                    Result = DllKernel32.pCopyFileExW(SourceFile->StartOfString, DestFile->StartOfString, NULL, NULL, &Cancelled, 0);
-                }
-
+                Result = YoriLibCopyFileOnce(SourceFile, DestFile, CopyFlags);
                 if (!Result) {
                     SetFileAttributes(DestFile->StartOfString, Attributes);
                     return Error;
@@ -271,5 +307,25 @@ YoriLibCopyFile(
     return Error;
 }
 
+/**
+ Call CopyFile, and if the operation fails, check if it's due to readonly,
+ hidden or system attributes on the target, clear those and retry.
+
+ @param SourceFile The source file name, expected to be NULL terminated.
+
+ @param DestFile The destination file name, expected to be NULL terminated.
+
+ @return The Win32 error code, possibly ERROR_SUCCESS or appropriate error
+         on failure.
+ */
+DWORD
+YoriLibCopyFile(
+    __in PYORI_STRING SourceFile,
+    __in PYORI_STRING DestFile
+    )
+{
+    return YoriLibCopyFileWithFlags(SourceFile, DestFile, 0);
+}
+
 
 // vim:sw=4:ts=4:et:
@@ -0,0 +1,633 @@
+/**
+ * @file lib/sha.c
+ *
+ * Yori software SHA-1 and SHA-256 routines
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "yoripch.h"
+#include "yorilib.h"
+
+/**
+ Indicates whether this compiler can generate SHA extension instructions
+ through intrinsics.  The instructions are only executed if the processor is
+ found to support them at runtime.
+ */
+#if defined(_MSC_VER) && (_MSC_VER >= 1900) && (defined(_M_AMD64) || defined(_M_IX86))
+#define YORI_LIB_SHA_EXTENSIONS 1
+#include <immintrin.h>
+#else
+#define YORI_LIB_SHA_EXTENSIONS 0
+#endif
+
+/**
+ Rotate a 32 bit value left by a specified number of bits.
+ */
+#define YORI_LIB_SHA_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/**
+ Rotate a 32 bit value right by a specified number of bits.
+ */
+#define YORI_LIB_SHA_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/**
+ The round constants used by SHA-256.
+ */
+CONST DWORD YoriLibSha256RoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/**
+ Read a 32 bit big endian value from a buffer.
+
+ @param Buffer Pointer to the buffer to read from.
+
+ @return The value.
+ */
+DWORD
+YoriLibShaReadBigEndian32(
+    __in PUCHAR Buffer
+    )
+{
+    return ((DWORD)Buffer[0] << 24) |
+           ((DWORD)Buffer[1] << 16) |
+           ((DWORD)Buffer[2] << 8) |
+           (DWORD)Buffer[3];
+}
+
+/**
+ Write a 32 bit value into a buffer in big endian form.
+
+ @param Buffer Pointer to the buffer to write to.
+
+ @param Value The value to write.
+ */
+VOID
+YoriLibShaWriteBigEndian32(
+    __out PUCHAR Buffer,
+    __in DWORD Value
+    )
+{
+    Buffer[0] = (UCHAR)(Value >> 24);
+    Buffer[1] = (UCHAR)(Value >> 16);
+    Buffer[2] = (UCHAR)(Value >> 8);
+    Buffer[3] = (UCHAR)Value;
+}
+
+/**
+ Process complete blocks of data with SHA-1 using general purpose
+ instructions.
+
+ @param State Pointer to the five words of SHA-1 state to update.
+
+ @param Data Pointer to the data to process.
+
+ @param BlockCount The number of 64 byte blocks in Data.
+ */
+VOID
+YoriLibSha1TransformPortable(
+    __inout PDWORD State,
+    __in PUCHAR Data,
+    __in DWORD BlockCount
+    )
+{
+    DWORD W[16];
+    DWORD A, B, C, D, E;
+    DWORD Temp;
+    DWORD Round;
+
+    for (; BlockCount > 0; BlockCount--) {
+        for (Round = 0; Round < 16; Round++) {
+            W[Round] = YoriLibShaReadBigEndian32(&Data[Round * 4]);
+        }
+
+        A = State[0];
+        B = State[1];
+        C = State[2];
+        D = State[3];
+        E = State[4];
+
+        for (Round = 0; Round < 80; Round++) {
+
+            //
+            //  After the first 16 rounds, the message schedule is extended
+            //  in place, since each word only depends on the previous 16.
+            //
+
+            if (Round >= 16) {
+                Temp = W[(Round + 13) & 15] ^ W[(Round + 8) & 15] ^ W[(Round + 2) & 15] ^ W[Round & 15];
+                W[Round & 15] = YORI_LIB_SHA_ROTL(Temp, 1);
+            }
+
+            if (Round < 20) {
+                Temp = ((B & C) | (~B & D)) + 0x5a827999;
+            } else if (Round < 40) {
+                Temp = (B ^ C ^ D) + 0x6ed9eba1;
+            } else if (Round < 60) {
+                Temp = ((B & C) | (B & D) | (C & D)) + 0x8f1bbcdc;
+            } else {
+                Temp = (B ^ C ^ D) + 0xca62c1d6;
+            }
+
+            Temp = Temp + YORI_LIB_SHA_ROTL(A, 5) + E + W[Round & 15];
+            E = D;
+            D = C;
+            C = YORI_LIB_SHA_ROTL(B, 30);
+            B = A;
+            A = Temp;
+        }
+
+        State[0] = State[0] + A;
+        State[1] = State[1] + B;
+        State[2] = State[2] + C;
+        State[3] = State[3] + D;
+        State[4] = State[4] + E;
+
+        Data = Data + YORI_LIB_SHA_BLOCK_SIZE;
+    }
+}
+
+/**
+ Process complete blocks of data with SHA-256 using general purpose
+ instructions.
+
+ @param State Pointer to the eight words of SHA-256 state to update.
+
+ @param Data Pointer to the data to process.
+
+ @param BlockCount The number of 64 byte blocks in Data.
+ */
+VOID
+YoriLibSha256TransformPortable(
+    __inout PDWORD State,
+    __in PUCHAR Data,
+    __in DWORD BlockCount
+    )
+{
+    DWORD W[64];
+    DWORD A, B, C, D, E, F, G, H;
+    DWORD Sigma0;
+    DWORD Sigma1;
+    DWORD Temp1;
+    DWORD Temp2;
+    DWORD Round;
+
+    for (; BlockCount > 0; BlockCount--) {
+        for (Round = 0; Round < 16; Round++) {
+            W[Round] = YoriLibShaReadBigEndian32(&Data[Round * 4]);
+        }
+
+        for (; Round < 64; Round++) {
+            Sigma0 = YORI_LIB_SHA_ROTR(W[Round - 15], 7) ^ YORI_LIB_SHA_ROTR(W[Round - 15], 18) ^ (W[Round - 15] >> 3);
+            Sigma1 = YORI_LIB_SHA_ROTR(W[Round - 2], 17) ^ YORI_LIB_SHA_ROTR(W[Round - 2], 19) ^ (W[Round - 2] >> 10);
+            W[Round] = W[Round - 16] + Sigma0 + W[Round - 7] + Sigma1;
+        }
+
+        A = State[0];
+        B = State[1];
+        C = State[2];
+        D = State[3];
+        E = State[4];
+        F = State[5];
+        G = State[6];
+        H = State[7];
+
+        for (Round = 0; Round < 64; Round++) {
+            Sigma1 = YORI_LIB_SHA_ROTR(E, 6) ^ YORI_LIB_SHA_ROTR(E, 11) ^ YORI_LIB_SHA_ROTR(E, 25);
+            Temp1 = H + Sigma1 + ((E & F) ^ (~E & G)) + YoriLibSha256RoundConstants[Round] + W[Round];
+            Sigma0 = YORI_LIB_SHA_ROTR(A, 2) ^ YORI_LIB_SHA_ROTR(A, 13) ^ YORI_LIB_SHA_ROTR(A, 22);
+            Temp2 = Sigma0 + ((A & B) ^ (A & C) ^ (B & C));
+            H = G;
+            G = F;
+            F = E;
+            E = D + Temp1;
+            D = C;
+            C = B;
+            B = A;
+            A = Temp1 + Temp2;
+        }
+
+        State[0] = State[0] + A;
+        State[1] = State[1] + B;
+        State[2] = State[2] + C;
+        State[3] = State[3] + D;
+        State[4] = State[4] + E;
+        State[5] = State[5] + F;
+        State[6] = State[6] + G;
+        State[7] = State[7] + H;
+
+        Data = Data + YORI_LIB_SHA_BLOCK_SIZE;
+    }
+}
+
+#if YORI_LIB_SHA_EXTENSIONS
+
+/**
+ Process complete blocks of data with SHA-1 using the processor's SHA
+ extensions.  The caller is expected to have checked that the processor
+ supports these instructions.
+
+ Each group of four rounds consumes one of four message registers.  While
+ a group is processed, the message register for four groups later is
+ extended from the registers that precede it.
+
+ @param State Pointer to the five words of SHA-1 state to update.
+
+ @param Data Pointer to the data to process.
+
+ @param BlockCount The number of 64 byte blocks in Data.
+ */
+VOID
+YoriLibSha1TransformExtensions(
+    __inout PDWORD State,
+    __in PUCHAR Data,
+    __in DWORD BlockCount
+    )
+{
+    __m128i Abcd;
+    __m128i AbcdSave;
+    __m128i E[2];
+    __m128i ESave;
+    __m128i Msg[4];
+    __m128i ByteSwap;
+    DWORD Group;
+
+    ByteSwap = _mm_set_epi64x(0x0001020304050607, 0x08090a0b0c0d0e0f);
+
+    Abcd = _mm_loadu_si128((__m128i *)State);
+    Abcd = _mm_shuffle_epi32(Abcd, 0x1B);
+    E[0] = _mm_set_epi32(State[4], 0, 0, 0);
+
+    for (; BlockCount > 0; BlockCount--) {
+        AbcdSave = Abcd;
+        ESave = E[0];
+
+        for (Group = 0; Group < 20; Group++) {
+            if (Group < 4) {
+                Msg[Group] = _mm_loadu_si128((__m128i *)&Data[Group * 16]);
+                Msg[Group] = _mm_shuffle_epi8(Msg[Group], ByteSwap);
+            }
+
+            //
+            //  The first group adds the message to E directly.  Subsequent
+            //  groups derive E from the A value four rounds earlier.
+            //
+
+            if (Group == 0) {
+                E[0] = _mm_add_epi32(E[0], Msg[0]);
+            } else {
+                E[Group % 2] = _mm_sha1nexte_epu32(E[Group % 2], Msg[Group % 4]);
+            }
+            E[(Group + 1) % 2] = Abcd;
+
+            if (Group >= 3 && Group < 19) {
+                Msg[(Group + 1) % 4] = _mm_sha1msg2_epu32(Msg[(Group + 1) % 4], Msg[Group % 4]);
+            }
+
+            switch (Group / 5) {
+                case 0:
+                    Abcd = _mm_sha1rnds4_epu32(Abcd, E[Group % 2], 0);
+                    break;
+                case 1:
+                    Abcd = _mm_sha1rnds4_epu32(Abcd, E[Group % 2], 1);
+                    break;
+                case 2:
+                    Abcd = _mm_sha1rnds4_epu32(Abcd, E[Group % 2], 2);
+                    break;
+                default:
+                    Abcd = _mm_sha1rnds4_epu32(Abcd, E[Group % 2], 3);
+                    break;
+            }
+
+            if (Group >= 1 && Group < 17) {
+                Msg[(Group + 3) % 4] = _mm_sha1msg1_epu32(Msg[(Group + 3) % 4], Msg[Group % 4]);
+            }
+
+            if (Group >= 2 && Group < 18) {
+                Msg[(Group + 2) % 4] = _mm_xor_si128(Msg[(Group + 2) % 4], Msg[Group % 4]);
+            }
+        }
+
+        //
+        //  After the final group, E[0] holds the A value from four rounds
+        //  earlier, which is rotated to become the new E.
+        //
+
+        E[0] = _mm_sha1nexte_epu32(E[0], ESave);
+        Abcd = _mm_add_epi32(Abcd, AbcdSave);
+
+        Data = Data + YORI_LIB_SHA_BLOCK_SIZE;
+    }
+
+    Abcd = _mm_shuffle_epi32(Abcd, 0x1B);
+    _mm_storeu_si128((__m128i *)State, Abcd);
+    State[4] = (DWORD)_mm_extract_epi32(E[0], 3);
+}
+
+/**
+ Process complete blocks of data with SHA-256 using the processor's SHA
+ extensions.  The caller is expected to have checked that the processor
+ supports these instructions.
+
+ Each group of four rounds consumes one of four message registers.  While
+ a group is processed, the message register for four groups later is
+ extended from the registers that precede it.
+
+ @param State Pointer to the eight words of SHA-256 state to update.
+
+ @param Data Pointer to the data to process.
+
+ @param BlockCount The number of 64 byte blocks in Data.
+ */
+VOID
+YoriLibSha256TransformExtensions(
+    __inout PDWORD State,
+    __in PUCHAR Data,
+    __in DWORD BlockCount
+    )
+{
+    __m128i State0;
+    __m128i State1;
+    __m128i State0Save;
+    __m128i State1Save;
+    __m128i Msg[4];
+    __m128i RoundInput;
+    __m128i Temp;
+    __m128i ByteSwap;
+    DWORD Group;
+
+    ByteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203);
+
+    //
+    //  The instructions operate on the state arranged as ABEF and CDGH.
+    //
+
+    Temp = _mm_loadu_si128((__m128i *)&State[0]);
+    State1 = _mm_loadu_si128((__m128i *)&State[4]);
+    Temp = _mm_shuffle_epi32(Temp, 0xB1);
+    State1 = _mm_shuffle_epi32(State1, 0x1B);
+    State0 = _mm_alignr_epi8(Temp, State1, 8);
+    State1 = _mm_blend_epi16(State1, Temp, 0xF0);
+
+    for (; BlockCount > 0; BlockCount--) {
+        State0Save = State0;
+        State1Save = State1;
+
+        for (Group = 0; Group < 16; Group++) {
+            if (Group < 4) {
+                Msg[Group] = _mm_loadu_si128((__m128i *)&Data[Group * 16]);
+                Msg[Group] = _mm_shuffle_epi8(Msg[Group], ByteSwap);
+            }
+
+            RoundInput = _mm_add_epi32(Msg[Group % 4], _mm_loadu_si128((__m128i *)&YoriLibSha256RoundConstants[Group * 4]));
+            State1 = _mm_sha256rnds2_epu32(State1, State0, RoundInput);
+
+            if (Group >= 3 && Group < 15) {
+                Temp = _mm_alignr_epi8(Msg[Group % 4], Msg[(Group + 3) % 4], 4);
+                Msg[(Group + 1) % 4] = _mm_add_epi32(Msg[(Group + 1) % 4], Temp);
+                Msg[(Group + 1) % 4] = _mm_sha256msg2_epu32(Msg[(Group + 1) % 4], Msg[Group % 4]);
+            }
+
+            RoundInput = _mm_shuffle_epi32(RoundInput, 0x0E);
+            State0 = _mm_sha256rnds2_epu32(State0, State1, RoundInput);
+
+            if (Group >= 1 && Group < 13) {
+                Msg[(Group + 3) % 4] = _mm_sha256msg1_epu32(Msg[(Group + 3) % 4], Msg[Group % 4]);
+            }
+        }
+
+        State0 = _mm_add_epi32(State0, State0Save);
+        State1 = _mm_add_epi32(State1, State1Save);
+
+        Data = Data + YORI_LIB_SHA_BLOCK_SIZE;
+    }
+
+    Temp = _mm_shuffle_epi32(State0, 0x1B);
+    State1 = _mm_shuffle_epi32(State1, 0xB1);
+    State0 = _mm_blend_epi16(Temp, State1, 0xF0);
+    State1 = _mm_alignr_epi8(State1, Temp, 8);
+
+    _mm_storeu_si128((__m128i *)&State[0], State0);
+    _mm_storeu_si128((__m128i *)&State[4], State1);
+}
+
+#endif
+
+/**
+ Process complete blocks of data with the algorithm selected in a context,
+ using the processor's SHA extensions if they are available.
+
+ @param ShaContext Pointer to the context to update.
+
+ @param Data Pointer to the data to process.
+
+ @param BlockCount The number of 64 byte blocks in Data.
+ */
+VOID
+YoriLibShaTransform(
+    __inout PYORI_LIB_SHA_CONTEXT ShaContext,
+    __in PUCHAR Data,
+    __in DWORD BlockCount
+    )
+{
+#if YORI_LIB_SHA_EXTENSIONS
+    if (ShaContext->UseShaExtensions) {
+        if (ShaContext->Sha256) {
+            YoriLibSha256TransformExtensions(ShaContext->State, Data, BlockCount);
+        } else {
+            YoriLibSha1TransformExtensions(ShaContext->State, Data, BlockCount);
+        }
+        return;
+    }
+#endif
+
+    if (ShaContext->Sha256) {
+        YoriLibSha256TransformPortable(ShaContext->State, Data, BlockCount);
+    } else {
+        YoriLibSha1TransformPortable(ShaContext->State, Data, BlockCount);
+    }
+}
+
+/**
+ Prepare a context to calculate a SHA-1 digest.
+
+ @param ShaContext Pointer to the context to initialize.
+ */
+VOID
+YoriLibSha1Initialize(
+    __out PYORI_LIB_SHA_CONTEXT ShaContext
+    )
+{
+    ZeroMemory(ShaContext, sizeof(YORI_LIB_SHA_CONTEXT));
+    ShaContext->State[0] = 0x67452301;
+    ShaContext->State[1] = 0xefcdab89;
+    ShaContext->State[2] = 0x98badcfe;
+    ShaContext->State[3] = 0x10325476;
+    ShaContext->State[4] = 0xc3d2e1f0;
+    ShaContext->DigestLength = YORI_LIB_SHA1_DIGEST_LENGTH;
+    ShaContext->Sha256 = FALSE;
+    ShaContext->UseShaExtensions = YoriLibIsShaExtensionAvailable();
+}
+
+/**
+ Prepare a context to calculate a SHA-256 digest.
+
+ @param ShaContext Pointer to the context to initialize.
+ */
+VOID
+YoriLibSha256Initialize(
+    __out PYORI_LIB_SHA_CONTEXT ShaContext
+    )
+{
+    ZeroMemory(ShaContext, sizeof(YORI_LIB_SHA_CONTEXT));
+    ShaContext->State[0] = 0x6a09e667;
+    ShaContext->State[1] = 0xbb67ae85;
+    ShaContext->State[2] = 0x3c6ef372;
+    ShaContext->State[3] = 0xa54ff53a;
+    ShaContext->State[4] = 0x510e527f;
+    ShaContext->State[5] = 0x9b05688c;
+    ShaContext->State[6] = 0x1f83d9ab;
+    ShaContext->State[7] = 0x5be0cd19;
+    ShaContext->DigestLength = YORI_LIB_SHA256_DIGEST_LENGTH;
+    ShaContext->Sha256 = TRUE;
+    ShaContext->UseShaExtensions = YoriLibIsShaExtensionAvailable();
+}
+
+/**
+ Add data to a SHA-1 or SHA-256 digest calculation.  Complete blocks are
+ processed directly from the caller's buffer, and any trailing partial block
+ is retained in the context until more data arrives.
+
+ @param ShaContext Pointer to a context previously initialized with
+        YoriLibSha1Initialize or YoriLibSha256Initialize.
+
+ @param Data Pointer to the data to add.
+
+ @param Length The number of bytes in Data.
+ */
+VOID
+YoriLibShaUpdate(
+    __inout PYORI_LIB_SHA_CONTEXT ShaContext,
+    __in PUCHAR Data,
+    __in DWORD Length
+    )
+{
+    DWORD BufferOffset;
+    DWORD BytesToCopy;
+    DWORD BlockCount;
+
+    BufferOffset = (DWORD)(ShaContext->BytesProcessed % YORI_LIB_SHA_BLOCK_SIZE);
+    ShaContext->BytesProcessed = ShaContext->BytesProcessed + Length;
+
+    //
+    //  If there's a partial block from a previous call, fill it first.
+    //
+
+    if (BufferOffset > 0) {
+        BytesToCopy = YORI_LIB_SHA_BLOCK_SIZE - BufferOffset;
+        if (BytesToCopy > Length) {
+            BytesToCopy = Length;
+        }
+        memcpy(&ShaContext->Buffer[BufferOffset], Data, BytesToCopy);
+        Data = Data + BytesToCopy;
+        Length = Length - BytesToCopy;
+        if (BufferOffset + BytesToCopy < YORI_LIB_SHA_BLOCK_SIZE) {
+            return;
+        }
+        YoriLibShaTransform(ShaContext, ShaContext->Buffer, 1);
+    }
+
+    BlockCount = Length / YORI_LIB_SHA_BLOCK_SIZE;
+    if (BlockCount > 0) {
+        YoriLibShaTransform(ShaContext, Data, BlockCount);
+        Data = Data + BlockCount * YORI_LIB_SHA_BLOCK_SIZE;
+        Length = Length - BlockCount * YORI_LIB_SHA_BLOCK_SIZE;
+    }
+
+    if (Length > 0) {
+        memcpy(ShaContext->Buffer, Data, Length);
+    }
+}
+
+/**
+ Complete a SHA-1 or SHA-256 digest calculation.  The context cannot be
+ used to add more data after this call.
+
+ @param ShaContext Pointer to the context to complete.
+
+ @param Digest Pointer to a buffer to receive the digest.  This must be
+        YORI_LIB_SHA1_DIGEST_LENGTH bytes for SHA-1 or
+        YORI_LIB_SHA256_DIGEST_LENGTH bytes for SHA-256.
+ */
+VOID
+YoriLibShaFinalize(
+    __inout PYORI_LIB_SHA_CONTEXT ShaContext,
+    __out PUCHAR Digest
+    )
+{
+    DWORD BufferOffset;
+    DWORDLONG BitCount;
+    DWORD Index;
+
+    BitCount = ShaContext->BytesProcessed * 8;
+    BufferOffset = (DWORD)(ShaContext->BytesProcessed % YORI_LIB_SHA_BLOCK_SIZE);
+
+    //
+    //  Append a single set bit, then pad with zeroes so that the length in
+    //  bits fits at the end of a block.
+    //
+
+    ShaContext->Buffer[BufferOffset] = 0x80;
+    BufferOffset++;
+
+    if (BufferOffset > YORI_LIB_SHA_BLOCK_SIZE - sizeof(BitCount)) {
+        ZeroMemory(&ShaContext->Buffer[BufferOffset], YORI_LIB_SHA_BLOCK_SIZE - BufferOffset);
+        YoriLibShaTransform(ShaContext, ShaContext->Buffer, 1);
+        BufferOffset = 0;
+    }
+
+    ZeroMemory(&ShaContext->Buffer[BufferOffset], YORI_LIB_SHA_BLOCK_SIZE - sizeof(BitCount) - BufferOffset);
+    YoriLibShaWriteBigEndian32(&ShaContext->Buffer[YORI_LIB_SHA_BLOCK_SIZE - 8], (DWORD)(BitCount >> 32));
+    YoriLibShaWriteBigEndian32(&ShaContext->Buffer[YORI_LIB_SHA_BLOCK_SIZE - 4], (DWORD)BitCount);
+    YoriLibShaTransform(ShaContext, ShaContext->Buffer, 1);
+
+    for (Index = 0; Index < ShaContext->DigestLength / sizeof(DWORD); Index++) {
+        YoriLibShaWriteBigEndian32(&Digest[Index * sizeof(DWORD)], ShaContext->State[Index]);
+    }
+}
+
+// vim:sw=4:ts=4:et:
@@ -0,0 +1,523 @@
+/**
+ * @file lib/strmatch.c
+ *
+ * Yori multi-pattern string matching routines
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "yoripch.h"
+#include "yorilib.h"
+
+/**
+ A single state within a multi-pattern matcher.  Each state corresponds to
+ a prefix of one or more of the strings being searched for.  State zero is
+ the root, corresponding to the empty prefix, so a zero index is used to
+ indicate that no state is present.
+ */
+typedef struct _YORI_LIB_MULTI_MATCH_NODE {
+
+    /**
+     The index of the first state that extends this state by one character.
+     */
+    YORI_ALLOC_SIZE_T FirstChild;
+
+    /**
+     The index of the next state that extends this state's parent by one
+     character.
+     */
+    YORI_ALLOC_SIZE_T NextSibling;
+
+    /**
+     The index of the state corresponding to the longest proper suffix of
+     this state's prefix that is also a prefix of a string being searched
+     for.
+     */
+    YORI_ALLOC_SIZE_T Failure;
+
+    /**
+     The index of the next state along the failure chain that completes a
+     string being searched for, or zero if no such state exists.
+     */
+    YORI_ALLOC_SIZE_T OutputLink;
+
+    /**
+     One plus the index of the lowest numbered string that is completed by
+     this state, or zero if this state does not complete a string.
+     */
+    YORI_ALLOC_SIZE_T Output;
+
+    /**
+     The number of characters in the prefix represented by this state.
+     */
+    YORI_ALLOC_SIZE_T Depth;
+
+    /**
+     The character that moves from the parent state to this state.
+     */
+    TCHAR Char;
+
+} YORI_LIB_MULTI_MATCH_NODE, *PYORI_LIB_MULTI_MATCH_NODE;
+
+/**
+ Locate the state that extends a specified state by one character, without
+ following any failure links.
+
+ @param Matcher Pointer to the matcher.
+
+ @param State The index of the state to extend.
+
+ @param Char The character to extend the state with.
+
+ @return The index of the state that extends State by Char, or zero if no
+         such state exists.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibMultiMatchFindChild(
+    __in PYORI_LIB_MULTI_MATCH Matcher,
+    __in YORI_ALLOC_SIZE_T State,
+    __in TCHAR Char
+    )
+{
+    YORI_ALLOC_SIZE_T Child;
+
+    Child = Matcher->Nodes[State].FirstChild;
+    while (Child != 0) {
+        if (Matcher->Nodes[Child].Char == Char) {
+            return Child;
+        }
+        Child = Matcher->Nodes[Child].NextSibling;
+    }
+
+    return 0;
+}
+
+/**
+ Determine the next state after consuming a character, following failure
+ links until a state is found that can be extended by the character.
+
+ @param Matcher Pointer to the matcher.
+
+ @param State The index of the current state.
+
+ @param Char The character to consume.  If the matcher is case insensitive,
+        this character has already been converted to upper case.
+
+ @return The index of the next state.
+ */
+YORI_ALLOC_SIZE_T
+YoriLibMultiMatchNextState(
+    __in PYORI_LIB_MULTI_MATCH Matcher,
+    __in YORI_ALLOC_SIZE_T State,
+    __in TCHAR Char
+    )
+{
+    YORI_ALLOC_SIZE_T Child;
+
+    while (State != 0) {
+        Child = YoriLibMultiMatchFindChild(Matcher, State, Char);
+        if (Child != 0) {
+            return Child;
+        }
+        State = Matcher->Nodes[State].Failure;
+    }
+
+    if (Char < sizeof(Matcher->RootNext)/sizeof(Matcher->RootNext[0])) {
+        return Matcher->RootNext[Char];
+    }
+
+    return YoriLibMultiMatchFindChild(Matcher, 0, Char);
+}
+
+/**
+ Free any allocations within a multi-pattern matcher.  The matcher structure
+ itself is owned by the caller.
+
+ @param Matcher Pointer to the matcher to clean up.
+ */
+VOID
+YoriLibMultiMatchCleanup(
+    __in PYORI_LIB_MULTI_MATCH Matcher
+    )
+{
+    if (Matcher->Nodes != NULL) {
+        YoriLibFree(Matcher->Nodes);
+        Matcher->Nodes = NULL;
+    }
+    Matcher->NodeCount = 0;
+    Matcher->NumberMatches = 0;
+    Matcher->MatchArray = NULL;
+}
+
+/**
+ Prepare a matcher that can search for any of a set of substrings within a
+ string in a single pass over the string.  This is useful when the same set
+ of substrings is searched for in many strings, since the cost of searching
+ no longer increases with the number of substrings being searched for.
+
+ @param Matcher Pointer to a caller allocated structure to initialize.
+
+ @param NumberMatches The number of substrings to look for.
+
+ @param MatchArray An array of strings corresponding to the matches to look
+        for.  This array is referenced by the matcher and must remain valid
+        until the matcher is cleaned up.
+
+ @param Insensitive TRUE if matches should be found case insensitively,
+        FALSE if they should be found case sensitively.
+
+ @return TRUE to indicate the matcher was successfully initialized, FALSE
+         on failure.  On success, the caller should call
+         @ref YoriLibMultiMatchCleanup when the matcher is no longer needed.
+ */
+__success(return)
+BOOLEAN
+YoriLibMultiMatchInitialize(
+    __out PYORI_LIB_MULTI_MATCH Matcher,
+    __in YORI_ALLOC_SIZE_T NumberMatches,
+    __in PYORI_STRING MatchArray,
+    __in BOOLEAN Insensitive
+    )
+{
+    PYORI_LIB_MULTI_MATCH_NODE Nodes;
+    PYORI_ALLOC_SIZE_T Queue;
+    YORI_MAX_UNSIGNED_T MaximumNodes;
+    YORI_ALLOC_SIZE_T QueueHead;
+    YORI_ALLOC_SIZE_T QueueTail;
+    YORI_ALLOC_SIZE_T MatchIndex;
+    YORI_ALLOC_SIZE_T CharIndex;
+    YORI_ALLOC_SIZE_T State;
+    YORI_ALLOC_SIZE_T Child;
+    YORI_ALLOC_SIZE_T Failure;
+    TCHAR Char;
+
+    ZeroMemory(Matcher, (DWORD)sizeof(YORI_LIB_MULTI_MATCH));
+
+    //
+    //  Each character in each string can add at most one state, plus the
+    //  root state.
+    //
+
+    MaximumNodes = 1;
+    for (MatchIndex = 0; MatchIndex < NumberMatches; MatchIndex++) {
+        MaximumNodes = MaximumNodes + MatchArray[MatchIndex].LengthInChars;
+    }
+
+    if (!YoriLibIsSizeAllocatable(MaximumNodes * sizeof(YORI_LIB_MULTI_MATCH_NODE)) ||
+        !YoriLibIsSizeAllocatable(MaximumNodes * sizeof(YORI_ALLOC_SIZE_T))) {
+
+        return FALSE;
+    }
+
+    Nodes = YoriLibMalloc((YORI_ALLOC_SIZE_T)(MaximumNodes * sizeof(YORI_LIB_MULTI_MATCH_NODE)));
+    if (Nodes == NULL) {
+        return FALSE;
+    }
+
+    Queue = YoriLibMalloc((YORI_ALLOC_SIZE_T)(MaximumNodes * sizeof(YORI_ALLOC_SIZE_T)));
+    if (Queue == NULL) {
+        YoriLibFree(Nodes);
+        return FALSE;
+    }
+
+    ZeroMemory(Nodes, (DWORD)(MaximumNodes * sizeof(YORI_LIB_MULTI_MATCH_NODE)));
+    Matcher->Nodes = Nodes;
+    Matcher->NodeCount = 1;
+    Matcher->NumberMatches = NumberMatches;
+    Matcher->MatchArray = MatchArray;
+    Matcher->Insensitive = Insensitive;
+
+    //
+    //  Build a tree of every prefix of every string.  If the same string is
+    //  present more than once, the lowest numbered entry is reported.
+    //
+
+    for (MatchIndex = 0; MatchIndex < NumberMatches; MatchIndex++) {
+        if (MatchArray[MatchIndex].LengthInChars > Matcher->MaximumLength) {
+            Matcher->MaximumLength = MatchArray[MatchIndex].LengthInChars;
+        }
+
+        if (MatchArray[MatchIndex].LengthInChars == 0) {
+            if (Matcher->EmptyMatchIndex == 0) {
+                Matcher->EmptyMatchIndex = MatchIndex + 1;
+            }
+            continue;
+        }
+
+        State = 0;
+        for (CharIndex = 0; CharIndex < MatchArray[MatchIndex].LengthInChars; CharIndex++) {
+            Char = MatchArray[MatchIndex].StartOfString[CharIndex];
+            if (Insensitive) {
+                Char = YoriLibUpcaseChar(Char);
+            }
+
+            Child = YoriLibMultiMatchFindChild(Matcher, State, Char);
+            if (Child == 0) {
+                Child = Matcher->NodeCount;
+                Matcher->NodeCount++;
+                Nodes[Child].Char = Char;
+                Nodes[Child].Depth = Nodes[State].Depth + 1;
+                Nodes[Child].NextSibling = Nodes[State].FirstChild;
+                Nodes[State].FirstChild = Child;
+            }
+            State = Child;
+        }
+
+        if (Nodes[State].Output == 0) {
+            Nodes[State].Output = MatchIndex + 1;
+        }
+    }
+
+    //
+    //  Transitions from the root are by far the most common, so resolve
+    //  these through a table for the common characters.
+    //
+
+    Child = Nodes[0].FirstChild;
+    while (Child != 0) {
+        if (Nodes[Child].Char < sizeof(Matcher->RootNext)/sizeof(Matcher->RootNext[0])) {
+            Matcher->RootNext[Nodes[Child].Char] = Child;
+        }
+        Child = Nodes[Child].NextSibling;
+    }
+
+    //
+    //  Walk the tree breadth first, so that when a state is processed all
+    //  shorter states already have their failure links resolved.  States
+    //  directly below the root fail back to the root.
+    //
+
+    QueueHead = 0;
+    QueueTail = 0;
+    Child = Nodes[0].FirstChild;
+    while (Child != 0) {
+        Queue[QueueTail] = Child;
+        QueueTail++;
+        Child = Nodes[Child].NextSibling;
+    }
+
+    while (QueueHead < QueueTail) {
+        State = Queue[QueueHead];
+        QueueHead++;
+
+        Child = Nodes[State].FirstChild;
+        while (Child != 0) {
+            Failure = YoriLibMultiMatchNextState(Matcher, Nodes[State].Failure, Nodes[Child].Char);
+            Nodes[Child].Failure = Failure;
+            if (Nodes[Failure].Output != 0) {
+                Nodes[Child].OutputLink = Failure;
+            } else {
+                Nodes[Child].OutputLink = Nodes[Failure].OutputLink;
+            }
+
+            Queue[QueueTail] = Child;
+            QueueTail++;
+            Child = Nodes[Child].NextSibling;
+        }
+    }
+
+    YoriLibFree(Queue);
+    return TRUE;
+}
+
+/**
+ Search through a string looking to see if any of the substrings in a
+ matcher can be located.  Returns the first match in offset from the
+ beginning of the string order.  If more than one substring matches at the
+ same offset, the one earliest in the match array is returned.  This is
+ equivalent to @ref YoriLibFindFirstMatchSubstr or
+ @ref YoriLibFindFirstMatchSubstrIns but examines each character of the
+ string once.
+
+ @param Matcher Pointer to the matcher describing the substrings to look
+        for.
+
+ @param String The string to search through.
+
+ @param StringOffsetOfMatch On successful completion, returns the offset
+        within the string of the match.
+
+ @return If a match is found, returns a pointer to the entry in the match
+         array corresponding to the substring that was matched.  If no match
+         is found, returns NULL.
+ */
+PYORI_STRING
+YoriLibMultiMatchFindFirst(
+    __in PYORI_LIB_MULTI_MATCH Matcher,
+    __in PCYORI_STRING String,
+    __out_opt PYORI_ALLOC_SIZE_T StringOffsetOfMatch
+    )
+{
+    PYORI_LIB_MULTI_MATCH_NODE Nodes;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T State;
+    YORI_ALLOC_SIZE_T OutputState;
+    YORI_ALLOC_SIZE_T MatchStart;
+    YORI_ALLOC_SIZE_T BestMatch;
+    YORI_ALLOC_SIZE_T BestMatchStart;
+    TCHAR Char;
+
+    Nodes = Matcher->Nodes;
+    BestMatch = 0;
+    BestMatchStart = 0;
+
+    if (Matcher->EmptyMatchIndex != 0 && String->LengthInChars > 0) {
+        BestMatch = Matcher->EmptyMatchIndex;
+    }
+
+    State = 0;
+    for (Index = 0; Index < String->LengthInChars; Index++) {
+
+        //
+        //  Once a match has been found, any match ending here or later must
+        //  start after it, so there's no need to look further.
+        //
+
+        if (BestMatch != 0 && Index >= BestMatchStart + Matcher->MaximumLength) {
+            break;
+        }
+
+        Char = String->StartOfString[Index];
+        if (Matcher->Insensitive) {
+            Char = YoriLibUpcaseChar(Char);
+        }
+
+        State = YoriLibMultiMatchNextState(Matcher, State, Char);
+        if (Nodes[State].Output != 0) {
+            OutputState = State;
+        } else {
+            OutputState = Nodes[State].OutputLink;
+        }
+
+        while (OutputState != 0) {
+            MatchStart = Index + 1 - Nodes[OutputState].Depth;
+            if (BestMatch == 0 ||
+                MatchStart < BestMatchStart ||
+                (MatchStart == BestMatchStart && Nodes[OutputState].Output < BestMatch)) {
+
+                BestMatch = Nodes[OutputState].Output;
+                BestMatchStart = MatchStart;
+            }
+            OutputState = Nodes[OutputState].OutputLink;
+        }
+    }
+
+    if (BestMatch == 0) {
+        if (StringOffsetOfMatch != NULL) {
+            *StringOffsetOfMatch = 0;
+        }
+        return NULL;
+    }
+
+    if (StringOffsetOfMatch != NULL) {
+        *StringOffsetOfMatch = BestMatchStart;
+    }
+    return &Matcher->MatchArray[BestMatch - 1];
+}
+
+/**
+ Search through a string looking to see if any of the substrings in a
+ matcher can be located.  Returns the substring earliest in the match array
+ that occurs anywhere in the string, regardless of where in the string it
+ occurs.
+
+ @param Matcher Pointer to the matcher describing the substrings to look
+        for.
+
+ @param String The string to search through.
+
+ @param StringOffsetOfMatch On successful completion, returns the offset
+        within the string of the first occurrence of the match.
+
+ @return If a match is found, returns a pointer to the entry in the match
+         array corresponding to the substring that was matched.  If no match
+         is found, returns NULL.
+ */
+PYORI_STRING
+YoriLibMultiMatchFindAny(
+    __in PYORI_LIB_MULTI_MATCH Matcher,
+    __in PCYORI_STRING String,
+    __out_opt PYORI_ALLOC_SIZE_T StringOffsetOfMatch
+    )
+{
+    PYORI_LIB_MULTI_MATCH_NODE Nodes;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T State;
+    YORI_ALLOC_SIZE_T OutputState;
+    YORI_ALLOC_SIZE_T BestMatch;
+    YORI_ALLOC_SIZE_T BestMatchStart;
+    TCHAR Char;
+
+    Nodes = Matcher->Nodes;
+    BestMatch = 0;
+    BestMatchStart = 0;
+
+    if (Matcher->EmptyMatchIndex != 0 && String->LengthInChars > 0) {
+        BestMatch = Matcher->EmptyMatchIndex;
+    }
+
+    State = 0;
+    for (Index = 0; Index < String->LengthInChars; Index++) {
+
+        //
+        //  If the first entry in the match array has been found, nothing
+        //  else can be better.
+        //
+
+        if (BestMatch == 1) {
+            break;
+        }
+
+        Char = String->StartOfString[Index];
+        if (Matcher->Insensitive) {
+            Char = YoriLibUpcaseChar(Char);
+        }
+
+        State = YoriLibMultiMatchNextState(Matcher, State, Char);
+        if (Nodes[State].Output != 0) {
+            OutputState = State;
+        } else {
+            OutputState = Nodes[State].OutputLink;
+        }
+
+        while (OutputState != 0) {
+            if (BestMatch == 0 || Nodes[OutputState].Output < BestMatch) {
+                BestMatch = Nodes[OutputState].Output;
+                BestMatchStart = Index + 1 - Nodes[OutputState].Depth;
+            }
+            OutputState = Nodes[OutputState].OutputLink;
+        }
+    }
+
+    if (BestMatch == 0) {
+        if (StringOffsetOfMatch != NULL) {
+            *StringOffsetOfMatch = 0;
+        }
+        return NULL;
+    }
+
+    if (StringOffsetOfMatch != NULL) {
+        *StringOffsetOfMatch = BestMatchStart;
+    }
+    return &Matcher->MatchArray[BestMatch - 1];
+}
+
+// vim:sw=4:ts=4:et:
@@ -189,12 +189,103 @@ YoriLibOutputTextToMbyteDev(
     return Result;
 }
 
+/**
+ Write any data accumulated in an output buffer to its device.
+
+ @param OutputBuffer Pointer to the output buffer.
+
+ @return TRUE to indicate success, FALSE to indicate failure.  On failure the
+         buffered data is discarded.
+ */
+BOOL
+YoriLibOutputBufferFlush(
+    __in PYORI_LIB_OUTPUT_BUFFER OutputBuffer
+    )
+{
+    DWORD BytesWritten;
+    YORI_ALLOC_SIZE_T BytesFlushed;
+    BOOL Result;
+
+    Result = TRUE;
+    BytesFlushed = 0;
+    while (BytesFlushed < OutputBuffer->BytesPopulated) {
+        if (!WriteFile(OutputBuffer->hOutput,
+                       &OutputBuffer->Buffer[BytesFlushed],
+                       OutputBuffer->BytesPopulated - BytesFlushed,
+                       &BytesWritten,
+                       NULL) ||
+            BytesWritten == 0) {
+
+            Result = FALSE;
+            break;
+        }
+        BytesFlushed = BytesFlushed + BytesWritten;
+    }
+
+    OutputBuffer->BytesPopulated = 0;
+    return Result;
+}
+
+/**
+ Convert any incoming string to the active output encoding, and append it to
+ an output buffer.  If the buffer does not have space, it is flushed first,
+ and if the string is larger than the buffer it is written to the device
+ directly.
+
+ @param OutputBuffer Pointer to the output buffer.
+
+ @param String Pointer to the string to output which is in host (UTF16)
+        encoding.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+YoriLibOutputTextToMbyteBuffer(
+    __in PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __in PCYORI_STRING String
+    )
+{
+    YORI_ALLOC_SIZE_T BytesNeeded;
+
+#ifdef UNICODE
+    BytesNeeded = (YORI_ALLOC_SIZE_T)YoriLibGetMbyteOutputSizeNeeded(String->StartOfString, String->LengthInChars);
+#else
+    BytesNeeded = String->LengthInChars * sizeof(TCHAR);
+#endif
+
+    if (BytesNeeded > OutputBuffer->BytesAllocated - OutputBuffer->BytesPopulated) {
+        if (!YoriLibOutputBufferFlush(OutputBuffer)) {
+            return FALSE;
+        }
+
+        if (BytesNeeded > OutputBuffer->BytesAllocated) {
+            return YoriLibOutputTextToMbyteDev(OutputBuffer->hOutput, String);
+        }
+    }
+
+#ifdef UNICODE
+    YoriLibMultibyteOutput(String->StartOfString,
+                           String->LengthInChars,
+                           (LPSTR)&OutputBuffer->Buffer[OutputBuffer->BytesPopulated],
+                           BytesNeeded);
+#else
+    memcpy(&OutputBuffer->Buffer[OutputBuffer->BytesPopulated], String->StartOfString, BytesNeeded);
+#endif
+
+    OutputBuffer->BytesPopulated = OutputBuffer->BytesPopulated + BytesNeeded;
+    return TRUE;
+}
+
 /**
  Convert any incoming string to contain specified line endings, and pass the
  result for conversion into the active output encoding.
 
  @param hOutput Handle to the device to receive any output.
 
+ @param OutputBuffer Optionally points to an output buffer.  If specified,
+        the result is appended to the buffer rather than written to the
+        device immediately.
+
  @param String Pointer to the string to output, which can have any line
         ending and is in host (UTF16) encoding.
 
@@ -203,6 +294,7 @@ YoriLibOutputTextToMbyteDev(
 BOOL
 YoriLibOutputTextMbyteFixLnEnd(
     __in HANDLE hOutput,
+    __in_opt PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
     __in PCYORI_STRING String
     )
 {
@@ -243,14 +335,22 @@ YoriLibOutputTextMbyteFixLnEnd(
             DisplayString.StartOfString = SearchString.StartOfString;
             DisplayString.LengthInChars = NonLineEndLength;
 
-            if (!YoriLibOutputTextToMbyteDev(hOutput, &DisplayString)) {
+            if (OutputBuffer != NULL) {
+                if (!YoriLibOutputTextToMbyteBuffer(OutputBuffer, &DisplayString)) {
+                    return FALSE;
+                }
+            } else if (!YoriLibOutputTextToMbyteDev(hOutput, &DisplayString)) {
                 return FALSE;
             }
         }
 
         if (GenerateLineEnd) {
             YoriLibConstantString(&DisplayString, YoriLibVtLineEnding);
-            if (!YoriLibOutputTextToMbyteDev(hOutput, &DisplayString)) {
+            if (OutputBuffer != NULL) {
+                if (!YoriLibOutputTextToMbyteBuffer(OutputBuffer, &DisplayString)) {
+                    return FALSE;
+                }
+            } else if (!YoriLibOutputTextToMbyteDev(hOutput, &DisplayString)) {
                 return FALSE;
             }
         }
@@ -746,7 +846,8 @@ YoriLibUtf8TextEndStream(
 
  @param String Pointer to the string to output.
 
- @param Context Pointer to context (unused.)
+ @param Context Pointer to context.  If nonzero, this is a pointer to an
+        output buffer to accumulate text into.
 
  @return TRUE for success, FALSE on failure.
  */
@@ -757,8 +858,10 @@ YoriLibUtf8TextProcOutputText(
     __inout PYORI_MAX_UNSIGNED_T Context
     )
 {
-    UNREFERENCED_PARAMETER(Context);
-    return YoriLibOutputTextMbyteFixLnEnd(hOutput, String);
+    PYORI_LIB_OUTPUT_BUFFER OutputBuffer;
+
+    OutputBuffer = (PYORI_LIB_OUTPUT_BUFFER)(DWORD_PTR)*Context;
+    return YoriLibOutputTextMbyteFixLnEnd(hOutput, OutputBuffer, String);
 }
 
 /**
@@ -997,11 +1100,78 @@ YoriLibProcVtEscOnNewStream(
     return Result;
 }
 
+/**
+ Select the set of callback functions to use to render output to a device.
+
+ @param hOut The output stream to write any result to.
+
+ @param Flags Flags, indicating behavior.
+
+ @param OutputBuffer Optionally points to an output buffer for the device.
+        If specified, the console state cached in the buffer is used rather
+        than querying the device, and text for devices other than the
+        console is accumulated in the buffer.
+
+ @param Callbacks On completion, populated with the callback functions to
+        use.
+ */
+VOID
+YoriLibOutputSelectCallbacks(
+    __in HANDLE hOut,
+    __in WORD Flags,
+    __in_opt PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __out PYORI_LIB_VT_CALLBACK_FUNCTIONS Callbacks
+    )
+{
+    DWORD CurrentMode;
+    BOOLEAN IsConsole;
+
+    if (hOut == YORI_LIB_DEBUGGER_HANDLE) {
+        YoriLibDbgSetFn(Callbacks);
+        return;
+    }
+
+    //
+    //  Check if we're writing to a console supporting color or a file
+    //  that doesn't
+    //
+
+    if (OutputBuffer != NULL) {
+        IsConsole = OutputBuffer->IsConsole;
+    } else if (GetConsoleMode(hOut, &CurrentMode)) {
+        IsConsole = TRUE;
+    } else {
+        IsConsole = FALSE;
+    }
+
+    if (IsConsole) {
+        if ((Flags & YORI_LIB_OUTPUT_STRIP_VT) != 0) {
+            YoriLibConsoleNoEscSetFn(Callbacks);
+        } else if ((Flags & YORI_LIB_OUTPUT_PASSTHROUGH_VT) != 0) {
+            YoriLibConsoleIncludeEscSetFn(Callbacks);
+        } else {
+            YoriLibConsoleSetFn(Callbacks);
+        }
+    } else {
+        if ((Flags & YORI_LIB_OUTPUT_STRIP_VT) != 0) {
+            YoriLibUtf8TextNoEscSetFn(Callbacks);
+        } else {
+            YoriLibUtf8TextWithEscSetFn(Callbacks);
+        }
+
+        if (OutputBuffer != NULL && OutputBuffer->Buffer != NULL) {
+            Callbacks->Context = (YORI_MAX_UNSIGNED_T)(DWORD_PTR)OutputBuffer;
+        }
+    }
+}
+
 /**
  Output a printf-style formatted string to the specified output stream.
 
  @param hOut The output stream to write any result to.
 
+ @param OutputBuffer Optionally points to an output buffer for the device.
+
  @param Flags Flags, indicating behavior.
 
  @param szFmt The format string, followed by appropriate arguments.
@@ -1013,6 +1183,7 @@ YoriLibProcVtEscOnNewStream(
 BOOL CDECL
 YoriLibOutputInternal(
     __in HANDLE hOut,
+    __in_opt PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
     __in WORD Flags,
     __in LPCTSTR szFmt,
     __in va_list marker
@@ -1027,33 +1198,13 @@ YoriLibOutputInternal(
     TCHAR stack_buf[64];
     TCHAR * buf;
     YORI_LIB_VT_CALLBACK_FUNCTIONS Callbacks;
-    DWORD CurrentMode;
     BOOL Result;
 
 #ifdef __WATCOMC__
     savedmarker[0] = marker[0];
 #endif
 
-    //
-    //  Check if we're writing to a console supporting color or a file
-    //  that doesn't
-    //
-
-    if (hOut == YORI_LIB_DEBUGGER_HANDLE) {
-        YoriLibDbgSetFn(&Callbacks);
-    } else if (GetConsoleMode(hOut, &CurrentMode)) {
-        if ((Flags & YORI_LIB_OUTPUT_STRIP_VT) != 0) {
-            YoriLibConsoleNoEscSetFn(&Callbacks);
-        } else if ((Flags & YORI_LIB_OUTPUT_PASSTHROUGH_VT) != 0) {
-            YoriLibConsoleIncludeEscSetFn(&Callbacks);
-        } else {
-            YoriLibConsoleSetFn(&Callbacks);
-        }
-    } else if ((Flags & YORI_LIB_OUTPUT_STRIP_VT) != 0) {
-        YoriLibUtf8TextNoEscSetFn(&Callbacks);
-    } else {
-        YoriLibUtf8TextWithEscSetFn(&Callbacks);
-    }
+    YoriLibOutputSelectCallbacks(hOut, Flags, OutputBuffer, &Callbacks);
 
     len = YoriLibVSPrintfSize(szFmt, marker);
 
@@ -1111,7 +1262,7 @@ YoriLibOutput(
     }
 
     va_start(marker, szFmt);
-    Result = YoriLibOutputInternal(hOut, Flags, szFmt, marker);
+    Result = YoriLibOutputInternal(hOut, NULL, Flags, szFmt, marker);
     va_end(marker);
     return Result;
 }
@@ -1136,27 +1287,9 @@ YoriLibOutputString(
     )
 {
     YORI_LIB_VT_CALLBACK_FUNCTIONS Callbacks;
-    DWORD CurrentMode;
     BOOL Result;
 
-    //
-    //  Check if we're writing to a console supporting color or a file
-    //  that doesn't
-    //
-
-    if (GetConsoleMode(hOut, &CurrentMode)) {
-        if ((Flags & YORI_LIB_OUTPUT_STRIP_VT) != 0) {
-            YoriLibConsoleNoEscSetFn(&Callbacks);
-        } else if ((Flags & YORI_LIB_OUTPUT_PASSTHROUGH_VT) != 0) {
-            YoriLibConsoleIncludeEscSetFn(&Callbacks);
-        } else {
-            YoriLibConsoleSetFn(&Callbacks);
-        }
-    } else if ((Flags & YORI_LIB_OUTPUT_STRIP_VT) != 0) {
-        YoriLibUtf8TextNoEscSetFn(&Callbacks);
-    } else {
-        YoriLibUtf8TextWithEscSetFn(&Callbacks);
-    }
+    YoriLibOutputSelectCallbacks(hOut, Flags, NULL, &Callbacks);
 
     Result = YoriLibProcVtEscOnNewStream(String->StartOfString, String->LengthInChars, hOut, &Callbacks);
 
@@ -1186,11 +1319,131 @@ YoriLibOutputToDevice(
     BOOL Result;
 
     va_start(marker, szFmt);
-    Result = YoriLibOutputInternal(hOut, Flags, szFmt, marker);
+    Result = YoriLibOutputInternal(hOut, NULL, Flags, szFmt, marker);
     va_end(marker);
     return Result;
 }
 
+/**
+ Prepare an output buffer for a device.  Whether the device is a console is
+ determined once here rather than on every write.  Output to a console is
+ not buffered, because escapes are translated into console calls that must
+ be ordered with respect to text; output to any other device is accumulated
+ in the buffer and written in large blocks.  The caller must call
+ @ref YoriLibOutputBufferCleanup to write any remaining data and free the
+ buffer.
+
+ @param OutputBuffer Pointer to the output buffer to initialize.
+
+ @param hOutput Handle to the device to write output to.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriLibOutputBufferInitialize(
+    __out PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __in HANDLE hOutput
+    )
+{
+    DWORD CurrentMode;
+
+    OutputBuffer->hOutput = hOutput;
+    OutputBuffer->Buffer = NULL;
+    OutputBuffer->BytesAllocated = 0;
+    OutputBuffer->BytesPopulated = 0;
+    OutputBuffer->IsConsole = FALSE;
+
+    if (GetConsoleMode(hOutput, &CurrentMode)) {
+        OutputBuffer->IsConsole = TRUE;
+        return TRUE;
+    }
+
+    OutputBuffer->Buffer = YoriLibMalloc(YORI_LIB_OUTPUT_BUFFER_SIZE);
+    if (OutputBuffer->Buffer == NULL) {
+        return FALSE;
+    }
+    OutputBuffer->BytesAllocated = YORI_LIB_OUTPUT_BUFFER_SIZE;
+
+    return TRUE;
+}
+
+/**
+ Write any data remaining in an output buffer to its device and free the
+ buffer.
+
+ @param OutputBuffer Pointer to the output buffer to clean up.
+ */
+VOID
+YoriLibOutputBufferCleanup(
+    __inout PYORI_LIB_OUTPUT_BUFFER OutputBuffer
+    )
+{
+    if (OutputBuffer->Buffer != NULL) {
+        YoriLibOutputBufferFlush(OutputBuffer);
+        YoriLibFree(OutputBuffer->Buffer);
+        OutputBuffer->Buffer = NULL;
+    }
+    OutputBuffer->BytesAllocated = 0;
+    OutputBuffer->BytesPopulated = 0;
+}
+
+/**
+ Output a printf-style formatted string via an output buffer.
+
+ @param OutputBuffer Pointer to the output buffer.
+
+ @param Flags Flags, indicating behavior.  The output stream is determined
+        by the output buffer.
+
+ @param szFmt The format string, followed by appropriate arguments.
+
+ @return TRUE for success, FALSE for failure.
+ */
+BOOL
+YoriLibOutputToBuffer(
+    __in PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __in WORD Flags,
+    __in LPCTSTR szFmt,
+    ...
+    )
+{
+    va_list marker;
+    BOOL Result;
+
+    va_start(marker, szFmt);
+    Result = YoriLibOutputInternal(OutputBuffer->hOutput, OutputBuffer, Flags, szFmt, marker);
+    va_end(marker);
+    return Result;
+}
+
+/**
+ Output a Yori string via an output buffer.  This will perform ANSI escape
+ processing but has no mechanism for expanding extra tokens in the stream.
+
+ @param OutputBuffer Pointer to the output buffer.
+
+ @param Flags Flags, indicating behavior.  The output stream is determined
+        by the output buffer.
+
+ @param String The string to output.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+YoriLibOutputStringToBuffer(
+    __in PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __in WORD Flags,
+    __in PCYORI_STRING String
+    )
+{
+    YORI_LIB_VT_CALLBACK_FUNCTIONS Callbacks;
+
+    YoriLibOutputSelectCallbacks(OutputBuffer->hOutput, Flags, OutputBuffer, &Callbacks);
+
+    return YoriLibProcVtEscOnNewStream(String->StartOfString, String->LengthInChars, OutputBuffer->hOutput, &Callbacks);
+}
+
 /**
  Generate a string that is the VT100 representation for the specified Win32
  attribute.
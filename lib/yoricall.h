@@ -56,6 +56,10 @@ YoriCallBuiltinUnregister(
 BOOL
 YoriCallClearHistoryStrings(VOID);
 
+__success(return)
+BOOL
+YoriCallClearPathCache(VOID);
+
 BOOL
 YoriCallDecrementPromptRecursionDepth(VOID);
 
@@ -151,6 +155,12 @@ YoriCallGetNextJobId(
     __in DWORD PreviousJobId
     );
 
+__success(return)
+BOOL
+YoriCallGetPathCacheStrings(
+    __out PYORI_STRING CommandStrings
+    );
+
 __success(return)
 BOOL
 YoriCallGetSystemAliasStrings(
@@ -2673,6 +2673,14 @@ typedef struct _YORI_REPARSE_DATA_BUFFER {
 #define FILE_FLAG_OPEN_NO_RECALL         (0x00100000)
 #endif
 
+#ifndef COPY_FILE_NO_BUFFERING
+/**
+ Specifies the flag to CopyFileEx to perform the copy without using the
+ system cache if the compilation environment doesn't provide it.
+ */
+#define COPY_FILE_NO_BUFFERING           (0x00001000)
+#endif
+
 #ifndef FSCTL_GET_COMPRESSION
 /**
  Specifies the FSCTL_GET_RETRIEVAL_POINTERS numerical representation if the
@@ -8336,6 +8344,25 @@ INTERLOCKED_COMPARE_EXCHANGE(LONG volatile *, LONG, LONG);
  */
 typedef INTERLOCKED_COMPARE_EXCHANGE *PINTERLOCKED_COMPARE_EXCHANGE;
 
+#ifndef PF_XMMI64_INSTRUCTIONS_AVAILABLE
+/**
+ The processor feature to indicate SSE2 instructions are available.
+ */
+#define PF_XMMI64_INSTRUCTIONS_AVAILABLE 10
+#endif
+
+/**
+ A prototype for the IsProcessorFeaturePresent function.
+ */
+typedef
+BOOL WINAPI
+IS_PROCESSOR_FEATURE_PRESENT(DWORD);
+
+/**
+ A prototype for a pointer to the IsProcessorFeaturePresent function.
+ */
+typedef IS_PROCESSOR_FEATURE_PRESENT *PIS_PROCESSOR_FEATURE_PRESENT;
+
 /**
  A prototype for the IsWow64Process function.
  */
@@ -8844,6 +8871,11 @@ typedef struct _YORI_KERNEL32_FUNCTIONS {
      */
     PINTERLOCKED_COMPARE_EXCHANGE pInterlockedCompareExchange;
 
+    /**
+     If it's available on the current system, a pointer to IsProcessorFeaturePresent.
+     */
+    PIS_PROCESSOR_FEATURE_PRESENT pIsProcessorFeaturePresent;
+
     /**
      If it's available on the current system, a pointer to IsWow64Process.
      */
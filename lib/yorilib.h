@@ -194,6 +194,179 @@ typedef struct _YORI_LIB_BYTE_BUFFER {
 
 } YORI_LIB_BYTE_BUFFER, *PYORI_LIB_BYTE_BUFFER;
 
+/**
+ A compiled set of substrings that can be searched for within a string in a
+ single pass.  The contents are private to the matching routines.
+ */
+typedef struct _YORI_LIB_MULTI_MATCH {
+
+    /**
+     The array of substrings being searched for.  This is owned by the
+     caller.
+     */
+    PYORI_STRING MatchArray;
+
+    /**
+     The number of elements in MatchArray.
+     */
+    YORI_ALLOC_SIZE_T NumberMatches;
+
+    /**
+     The number of states in Nodes.
+     */
+    YORI_ALLOC_SIZE_T NodeCount;
+
+    /**
+     The length of the longest substring being searched for.
+     */
+    YORI_ALLOC_SIZE_T MaximumLength;
+
+    /**
+     One plus the index of the first empty substring being searched for, or
+     zero if no substring is empty.
+     */
+    YORI_ALLOC_SIZE_T EmptyMatchIndex;
+
+    /**
+     TRUE if substrings should be matched case insensitively.
+     */
+    BOOLEAN Insensitive;
+
+    /**
+     An array of states, where the first state corresponds to no characters
+     having been matched.
+     */
+    struct _YORI_LIB_MULTI_MATCH_NODE *Nodes;
+
+    /**
+     The state that follows the first state for each low character value.
+     */
+    YORI_ALLOC_SIZE_T RootNext[128];
+
+} YORI_LIB_MULTI_MATCH, *PYORI_LIB_MULTI_MATCH;
+
+/**
+ The number of bytes processed at a time by the SHA-1 and SHA-256
+ algorithms.
+ */
+#define YORI_LIB_SHA_BLOCK_SIZE 64
+
+/**
+ The number of bytes in a SHA-1 digest.
+ */
+#define YORI_LIB_SHA1_DIGEST_LENGTH 20
+
+/**
+ The number of bytes in a SHA-256 digest.
+ */
+#define YORI_LIB_SHA256_DIGEST_LENGTH 32
+
+/**
+ The state of a SHA-1 or SHA-256 digest calculation performed in software.
+ */
+typedef struct _YORI_LIB_SHA_CONTEXT {
+
+    /**
+     The intermediate hash value.  SHA-1 uses the first five words and
+     SHA-256 uses all eight.
+     */
+    DWORD State[8];
+
+    /**
+     The total number of bytes added to the calculation.
+     */
+    DWORDLONG BytesProcessed;
+
+    /**
+     A partial block of data that has been added but not yet processed.
+     */
+    UCHAR Buffer[YORI_LIB_SHA_BLOCK_SIZE];
+
+    /**
+     The number of bytes in the resulting digest.
+     */
+    DWORD DigestLength;
+
+    /**
+     TRUE if the calculation is SHA-256, FALSE if it is SHA-1.
+     */
+    BOOLEAN Sha256;
+
+    /**
+     TRUE if the processor's SHA extensions should be used.
+     */
+    BOOLEAN UseShaExtensions;
+
+} YORI_LIB_SHA_CONTEXT, *PYORI_LIB_SHA_CONTEXT;
+
+/**
+ The number of characters on each line of base64 output, matching the
+ operating system's base64 encoding.
+ */
+#define YORI_LIB_BASE64_LINE_LENGTH 64
+
+/**
+ The state of a base64 encoding operation that is performed in chunks.
+ */
+typedef struct _YORI_LIB_BASE64_ENCODER {
+
+    /**
+     The number of characters to output before each line break, or zero if
+     no line breaks should be output.
+     */
+    YORI_ALLOC_SIZE_T LineLength;
+
+    /**
+     The number of characters output on the current line.
+     */
+    YORI_ALLOC_SIZE_T CharsThisLine;
+
+    /**
+     The number of bytes in Pending.
+     */
+    DWORD PendingLength;
+
+    /**
+     Bytes from the end of a previous chunk that did not form a complete
+     group of three.
+     */
+    UCHAR Pending[3];
+
+    /**
+     TRUE if SSSE3 instructions should be used.
+     */
+    BOOLEAN UseSsse3;
+
+} YORI_LIB_BASE64_ENCODER, *PYORI_LIB_BASE64_ENCODER;
+
+/**
+ The state of a base64 decoding operation that is performed in chunks.
+ */
+typedef struct _YORI_LIB_BASE64_DECODER {
+
+    /**
+     The six bit values of characters from a group that is not yet complete.
+     */
+    DWORD Accumulator;
+
+    /**
+     The number of characters in Accumulator.
+     */
+    DWORD CharsAccumulated;
+
+    /**
+     TRUE once a padding character has been found, after which only padding
+     and whitespace are valid.
+     */
+    BOOLEAN PaddingFound;
+
+    /**
+     TRUE if SSSE3 instructions should be used.
+     */
+    BOOLEAN UseSsse3;
+
+} YORI_LIB_BASE64_DECODER, *PYORI_LIB_BASE64_DECODER;
+
 /**
  A structure describing an entry that is an element of a hash table.
  */
@@ -214,6 +387,18 @@ typedef struct _YORI_HASH_ENTRY {
      table to identify the entry.
      */
     PVOID Context;
+
+    /**
+     The hash table that this entry is currently inserted into.
+     */
+    struct _YORI_HASH_TABLE *HashTable;
+
+    /**
+     The full hash of the key.  This is retained so that entries can be
+     moved to new buckets when the table grows without rehashing the key,
+     and so that most mismatches can be rejected without a string compare.
+     */
+    DWORD Hash;
 } YORI_HASH_ENTRY, *PYORI_HASH_ENTRY;
 
 /**
@@ -233,10 +418,16 @@ typedef struct _YORI_HASH_BUCKET {
 typedef struct _YORI_HASH_TABLE {
 
     /**
-     The number of buckets in the hash table.
+     The number of buckets in the hash table.  This is always a power of
+     two, and increases as entries are inserted.
      */
     YORI_ALLOC_SIZE_T NumberBuckets;
 
+    /**
+     The number of entries currently inserted into the hash table.
+     */
+    YORI_ALLOC_SIZE_T EntryCount;
+
     /**
      An array of hash buckets.
      */
@@ -563,6 +754,62 @@ YoriLibDisplayBarGraph(
     __in DWORD RedThreshold
     );
 
+// *** BASE64.C ***
+
+VOID
+YoriLibBase64EncodeInitialize(
+    __out PYORI_LIB_BASE64_ENCODER Encoder,
+    __in YORI_ALLOC_SIZE_T LineLength
+    );
+
+YORI_MAX_UNSIGNED_T
+YoriLibBase64EncodeMaximumOutput(
+    __in PYORI_LIB_BASE64_ENCODER Encoder,
+    __in YORI_ALLOC_SIZE_T SourceLength
+    );
+
+YORI_ALLOC_SIZE_T
+YoriLibBase64EncodeUpdate(
+    __inout PYORI_LIB_BASE64_ENCODER Encoder,
+    __in PUCHAR Source,
+    __in YORI_ALLOC_SIZE_T SourceLength,
+    __out PUCHAR Dest
+    );
+
+YORI_ALLOC_SIZE_T
+YoriLibBase64EncodeFinalize(
+    __inout PYORI_LIB_BASE64_ENCODER Encoder,
+    __out PUCHAR Dest
+    );
+
+VOID
+YoriLibBase64DecodeInitialize(
+    __out PYORI_LIB_BASE64_DECODER Decoder
+    );
+
+YORI_MAX_UNSIGNED_T
+YoriLibBase64DecodeMaximumOutput(
+    __in YORI_ALLOC_SIZE_T SourceLength
+    );
+
+__success(return)
+BOOL
+YoriLibBase64DecodeUpdate(
+    __inout PYORI_LIB_BASE64_DECODER Decoder,
+    __in PUCHAR Source,
+    __in YORI_ALLOC_SIZE_T SourceLength,
+    __out PUCHAR Dest,
+    __out PYORI_ALLOC_SIZE_T BytesWritten
+    );
+
+__success(return)
+BOOL
+YoriLibBase64DecodeFinalize(
+    __inout PYORI_LIB_BASE64_DECODER Decoder,
+    __out PUCHAR Dest,
+    __out PYORI_ALLOC_SIZE_T BytesWritten
+    );
+
 // *** BUILTIN.C ***
 
 BOOL
@@ -620,6 +867,30 @@ YoriLibByteBufferGetValidBytes(
     __in PYORI_LIB_BYTE_BUFFER Buffer
     );
 
+// *** BYTESRCH.C ***
+
+__success(return)
+BOOLEAN
+YoriLibFindNextBytes(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    );
+
+__success(return)
+BOOLEAN
+YoriLibFindPreviousBytes(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength,
+    __out PYORI_ALLOC_SIZE_T FoundOffset
+    );
+
 // *** CABINET.C ***
 
 /**
@@ -981,6 +1252,15 @@ YoriLibSetConsoleDisplayMode(
 
 // *** CPUINFO.C ***
 
+BOOLEAN
+YoriLibIsSse2Available(VOID);
+
+BOOLEAN
+YoriLibIsShaExtensionAvailable(VOID);
+
+BOOLEAN
+YoriLibIsSsse3Available(VOID);
+
 VOID
 YoriLibQueryCpuCount(
     __out PWORD PerformanceLogicalProcessors,
@@ -1605,6 +1885,20 @@ typedef YORILIB_FILE_ENUM_FN *PYORILIB_FILE_ENUM_FN;
  */
 #define YORILIB_ENUM_DIRECTORY_CONTENTS      0x00000100
 
+/**
+ When recursing, read directories on a pool of worker threads ahead of the
+ point where they are reached.  Callbacks are invoked on the calling thread
+ in the same order as without this flag.
+ */
+#define YORILIB_ENUM_PARALLEL                0x00000200
+
+/**
+ When recursing, enumerate subdirectories on a pool of worker threads and
+ invoke callbacks from any thread in no defined order.  The callbacks must
+ be safe to call concurrently.
+ */
+#define YORILIB_ENUM_PARALLEL_UNORDERED      0x00000400
+
 __success(return)
 BOOL
 YoriLibForEachFile(
@@ -2911,6 +3205,55 @@ typedef enum _YORI_LIB_LINE_ENDING {
  */
 typedef YORI_LIB_LINE_ENDING *PYORI_LIB_LINE_ENDING;
 
+/**
+ A description of a line within a line read context's buffer.  The line is
+ in input encoding and has not been copied or converted, and is only valid
+ until the next read operation using the same context.
+ */
+typedef struct _YORI_LIB_LINE_VIEW {
+
+    /**
+     Pointer to the beginning of the line.  This points to 16 bit characters
+     if WideChars is TRUE, or 8 bit characters if it is FALSE.
+     */
+    PVOID Data;
+
+    /**
+     The number of characters in the line, excluding any line ending.  Note
+     this refers to 8 bit or 16 bit characters depending on WideChars.
+     */
+    YORI_ALLOC_SIZE_T LengthInChars;
+
+    /**
+     TRUE if the line consists of 16 bit characters, FALSE if it consists of
+     8 bit characters.
+     */
+    BOOLEAN WideChars;
+
+    /**
+     The line ending that terminated the line.
+     */
+    YORI_LIB_LINE_ENDING LineEnding;
+
+} YORI_LIB_LINE_VIEW;
+
+/**
+ Pointer to a description of a line within a line read context's buffer.
+ */
+typedef YORI_LIB_LINE_VIEW *PYORI_LIB_LINE_VIEW;
+
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorA(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    );
+
+YORI_ALLOC_SIZE_T
+YoriLibFindLineTerminatorW(
+    __in PWCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    );
+
 PVOID
 YoriLibReadLineToString(
     __in PYORI_STRING UserString,
@@ -2929,6 +3272,37 @@ YoriLibReadLineToStringEx(
     __out PBOOL TimeoutReached
     );
 
+__success(return)
+BOOL
+YoriLibReadLineToViewEx(
+    __out PYORI_LIB_LINE_VIEW View,
+    __inout PVOID * Context,
+    __in BOOL ReturnFinalNonTerminatedLine,
+    __in DWORD MaximumDelay,
+    __in HANDLE FileHandle,
+    __out PBOOL TimeoutReached
+    );
+
+__success(return)
+BOOL
+YoriLibReadLineToView(
+    __out PYORI_LIB_LINE_VIEW View,
+    __inout PVOID * Context,
+    __in HANDLE FileHandle
+    );
+
+__success(return)
+BOOL
+YoriLibLineViewToString(
+    __in PYORI_LIB_LINE_VIEW View,
+    __inout PYORI_STRING UserString
+    );
+
+YORI_ALLOC_SIZE_T
+YoriLibLineViewGetLengthInChars(
+    __in PYORI_LIB_LINE_VIEW View
+    );
+
 VOID
 YoriLibLineReadClose(
     __in_opt PVOID Context
@@ -3084,6 +3458,13 @@ YoriLibCopyFile(
     __in PYORI_STRING DestFile
     );
 
+DWORD
+YoriLibCopyFileWithFlags(
+    __in PYORI_STRING SourceFile,
+    __in PYORI_STRING DestFile,
+    __in DWORD CopyFlags
+    );
+
 // *** NUMKEY.C ***
 
 /**
@@ -3706,6 +4087,31 @@ YoriLibSetSelectionColor(
     __in WORD SelectionColor
     );
 
+// *** SHA.C ***
+
+VOID
+YoriLibSha1Initialize(
+    __out PYORI_LIB_SHA_CONTEXT ShaContext
+    );
+
+VOID
+YoriLibSha256Initialize(
+    __out PYORI_LIB_SHA_CONTEXT ShaContext
+    );
+
+VOID
+YoriLibShaUpdate(
+    __inout PYORI_LIB_SHA_CONTEXT ShaContext,
+    __in PUCHAR Data,
+    __in DWORD Length
+    );
+
+VOID
+YoriLibShaFinalize(
+    __inout PYORI_LIB_SHA_CONTEXT ShaContext,
+    __out PUCHAR Digest
+    );
+
 // *** STRARRAY.C ***
 
 VOID
@@ -4063,6 +4469,36 @@ YoriLibStringConcatWithLiteral(
  */
 #define wcscpy(a,b)  YoriLibSPrintf(a, L"%s", b)
 
+// *** STRMATCH.C ***
+
+VOID
+YoriLibMultiMatchCleanup(
+    __in PYORI_LIB_MULTI_MATCH Matcher
+    );
+
+__success(return)
+BOOLEAN
+YoriLibMultiMatchInitialize(
+    __out PYORI_LIB_MULTI_MATCH Matcher,
+    __in YORI_ALLOC_SIZE_T NumberMatches,
+    __in PYORI_STRING MatchArray,
+    __in BOOLEAN Insensitive
+    );
+
+PYORI_STRING
+YoriLibMultiMatchFindFirst(
+    __in PYORI_LIB_MULTI_MATCH Matcher,
+    __in PCYORI_STRING String,
+    __out_opt PYORI_ALLOC_SIZE_T StringOffsetOfMatch
+    );
+
+PYORI_STRING
+YoriLibMultiMatchFindAny(
+    __in PYORI_LIB_MULTI_MATCH Matcher,
+    __in PCYORI_STRING String,
+    __out_opt PYORI_ALLOC_SIZE_T StringOffsetOfMatch
+    );
+
 // *** STRMENUM.C ***
 
 BOOL
@@ -4285,6 +4721,54 @@ YoriLibOutputTextToMbyteDev(
     __in PCYORI_STRING String
     );
 
+/**
+ The size of the buffer used to accumulate output to a device that is not a
+ console, in bytes.
+ */
+#define YORI_LIB_OUTPUT_BUFFER_SIZE (64 * 1024)
+
+/**
+ A buffer which accumulates output for a single device so that many small
+ writes can be combined into a few large ones.
+ */
+typedef struct _YORI_LIB_OUTPUT_BUFFER {
+
+    /**
+     Handle to the device to write output to.
+     */
+    HANDLE hOutput;
+
+    /**
+     Pointer to the buffer of output that has not yet been written to the
+     device, in the device's encoding.  This is NULL if the device is not
+     being buffered.
+     */
+    PUCHAR Buffer;
+
+    /**
+     The size of the Buffer allocation, in bytes.
+     */
+    YORI_ALLOC_SIZE_T BytesAllocated;
+
+    /**
+     The number of bytes in Buffer that have not yet been written to the
+     device.
+     */
+    YORI_ALLOC_SIZE_T BytesPopulated;
+
+    /**
+     TRUE if the device is a console.  This is determined once when the
+     buffer is initialized.
+     */
+    BOOLEAN IsConsole;
+
+} YORI_LIB_OUTPUT_BUFFER, *PYORI_LIB_OUTPUT_BUFFER;
+
+BOOL
+YoriLibOutputBufferFlush(
+    __in PYORI_LIB_OUTPUT_BUFFER OutputBuffer
+    );
+
 /**
  Output the string to the standard output device.
  */
@@ -4420,6 +4904,33 @@ YoriLibOutputString(
     __in PYORI_STRING String
     );
 
+__success(return)
+BOOL
+YoriLibOutputBufferInitialize(
+    __out PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __in HANDLE hOutput
+    );
+
+VOID
+YoriLibOutputBufferCleanup(
+    __inout PYORI_LIB_OUTPUT_BUFFER OutputBuffer
+    );
+
+BOOL
+YoriLibOutputToBuffer(
+    __in PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __in WORD Flags,
+    __in LPCTSTR szFmt,
+    ...
+    );
+
+BOOL
+YoriLibOutputStringToBuffer(
+    __in PYORI_LIB_OUTPUT_BUFFER OutputBuffer,
+    __in WORD Flags,
+    __in PCYORI_STRING String
+    );
+
 BOOL
 YoriLibVtSetConsoleTextAttrDev(
     __in HANDLE hOut,
@@ -28,6 +28,43 @@
 #include <yorilib.h>
 #include <yorish.h>
 
+/**
+ The number of bytes of process output held in each chunk of a process
+ buffer.
+ */
+#define YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE (64 * 1024)
+
+/**
+ A fixed size chunk of process output.  Output is always appended to the
+ final chunk of a process buffer, and a new chunk is allocated when it is
+ full, so output that has already been buffered is never copied as the
+ buffer grows.
+ */
+typedef struct _YORI_LIBSH_PROCESS_BUFFER_CHUNK {
+
+    /**
+     The link into the list of chunks held in memory for a process buffer.
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     The offset within the data stream of the first byte in this chunk.
+     */
+    DWORDLONG StreamOffset;
+
+    /**
+     The number of bytes populated with data in this chunk.
+     */
+    DWORD BytesPopulated;
+
+    /**
+     The data buffer.  This is allocated immediately following this
+     structure and contains YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE bytes.
+     */
+    PCHAR Buffer;
+
+} YORI_LIBSH_PROCESS_BUFFER_CHUNK, *PYORI_LIBSH_PROCESS_BUFFER_CHUNK;
+
 /**
  A buffer for a single data stream.  A process may have a different buffered
  data stream for stdout as well as stderr.
@@ -35,14 +72,53 @@
 typedef struct _YORI_LIBSH_PROCESS_BUFFER {
 
     /**
-     The number of bytes currently allocated to this buffer.
+     The list of chunks held in memory, ordered from the oldest data to the
+     newest.  Data older than the first chunk has been written to the spill
+     file.
      */
-    YORI_ALLOC_SIZE_T BytesAllocated;
+    YORI_LIST_ENTRY ChunkList;
 
     /**
-     The number of bytes populated with data in this buffer.
+     The number of chunks in ChunkList.
      */
-    YORI_ALLOC_SIZE_T BytesPopulated;
+    DWORD ChunksInMemory;
+
+    /**
+     The maximum number of chunks to hold in memory before writing older
+     chunks to the spill file.  Zero indicates no limit.
+     */
+    DWORD MaxChunksInMemory;
+
+    /**
+     The chunk that was most recently used to satisfy a read from the buffer.
+     Reads are typically sequential, so this is used as the place to start
+     searching for the next read.
+     */
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK LookupHint;
+
+    /**
+     The number of bytes populated with data in this buffer, including data
+     which has been written to the spill file.
+     */
+    DWORDLONG BytesPopulated;
+
+    /**
+     The number of bytes at the beginning of the data stream which have been
+     written to the spill file and are no longer held in memory.
+     */
+    DWORDLONG BytesSpilled;
+
+    /**
+     A handle to a temporary file containing data that has been removed from
+     memory, or NULL if no data has been removed from memory.
+     */
+    HANDLE hSpillFile;
+
+    /**
+     The name of the spill file, so it can be deleted when the buffer is
+     freed.
+     */
+    YORI_STRING SpillFileName;
 
     /**
      A handle to the buffer processing thread.
@@ -68,12 +144,7 @@ typedef struct _YORI_LIBSH_PROCESS_BUFFER {
     /**
      The number of bytes which have been sent to hMirror.
      */
-    DWORD BytesSent;
-
-    /**
-     The data buffer.
-     */
-    PCHAR Buffer;
+    DWORDLONG BytesSent;
 
 } YORI_LIBSH_PROCESS_BUFFER, *PYORI_LIBSH_PROCESS_BUFFER;
 
@@ -141,6 +212,275 @@ AcquireMutex(
     WaitForSingleObject(Mutex, INFINITE);
 }
 
+/**
+ Allocate a new chunk to hold process output.
+
+ @param StreamOffset The offset within the data stream of the first byte that
+        will be stored in the chunk.
+
+ @return Pointer to the chunk, or NULL on allocation failure.
+ */
+PYORI_LIBSH_PROCESS_BUFFER_CHUNK
+YoriLibShAllocateProcessBufferChunk(
+    __in DWORDLONG StreamOffset
+    )
+{
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK Chunk;
+
+    Chunk = YoriLibMalloc(sizeof(YORI_LIBSH_PROCESS_BUFFER_CHUNK) + YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE);
+    if (Chunk == NULL) {
+        return NULL;
+    }
+
+    Chunk->StreamOffset = StreamOffset;
+    Chunk->BytesPopulated = 0;
+    Chunk->Buffer = (PCHAR)(Chunk + 1);
+    return Chunk;
+}
+
+/**
+ Determine the maximum number of chunks of output to hold in memory for each
+ buffered stream.  This is configured by setting YORIJOBBUFFERLIMIT to a size,
+ such as 64m.  Output beyond this size is written to a temporary file.  By
+ default, all output is held in memory.
+
+ @return The maximum number of chunks to hold in memory, or zero to indicate
+         no limit.
+ */
+DWORD
+YoriLibShGetProcessBufferChunkLimit(VOID)
+{
+    YORI_STRING Value;
+    LARGE_INTEGER Limit;
+    DWORDLONG ChunkCount;
+
+    YoriLibInitEmptyString(&Value);
+    if (!YoriLibAllocateAndGetEnvVar(_T("YORIJOBBUFFERLIMIT"), &Value)) {
+        return 0;
+    }
+
+    if (Value.LengthInChars == 0) {
+        YoriLibFreeStringContents(&Value);
+        return 0;
+    }
+
+    YoriLibStringToFileSize(&Value, &Limit);
+    YoriLibFreeStringContents(&Value);
+
+    if (Limit.QuadPart <= 0) {
+        return 0;
+    }
+
+    ChunkCount = ((DWORDLONG)Limit.QuadPart + YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE - 1) / YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE;
+    if (ChunkCount > (DWORD)-1) {
+        return 0;
+    }
+
+    return (DWORD)ChunkCount;
+}
+
+/**
+ Move the file pointer of a process buffer's spill file to a specified
+ offset.
+
+ @param ThisBuffer Pointer to the process buffer.
+
+ @param Offset The offset within the spill file.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriLibShSeekProcessBufferSpillFile(
+    __in PYORI_LIBSH_PROCESS_BUFFER ThisBuffer,
+    __in DWORDLONG Offset
+    )
+{
+    LARGE_INTEGER FilePosition;
+    DWORD Result;
+
+    FilePosition.QuadPart = Offset;
+    Result = SetFilePointer(ThisBuffer->hSpillFile, FilePosition.LowPart, &FilePosition.HighPart, FILE_BEGIN);
+    if (Result == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Write the oldest chunks of a process buffer to its spill file until the
+ number of chunks in memory is within the buffer's limit.  The final chunk
+ is never written, since the pump thread may be reading into it without
+ holding the mutex.  If the spill file cannot be created or written, the
+ limit is removed and all further output is held in memory.  The caller is
+ expected to hold the buffer's mutex.
+
+ @param ThisBuffer Pointer to the process buffer.
+ */
+VOID
+YoriLibShSpillProcessBufferChunks(
+    __in PYORI_LIBSH_PROCESS_BUFFER ThisBuffer
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK Chunk;
+    YORI_STRING TempPath;
+    YORI_STRING Prefix;
+    DWORD BytesWritten;
+
+    if (ThisBuffer->hSpillFile == NULL) {
+        if (!YoriLibGetTempPath(&TempPath, 0)) {
+            ThisBuffer->MaxChunksInMemory = 0;
+            return;
+        }
+
+        YoriLibConstantString(&Prefix, _T("YJOB"));
+        if (!YoriLibGetTempFileName(&TempPath, &Prefix, &ThisBuffer->hSpillFile, &ThisBuffer->SpillFileName)) {
+            YoriLibFreeStringContents(&TempPath);
+            ThisBuffer->hSpillFile = NULL;
+            ThisBuffer->MaxChunksInMemory = 0;
+            return;
+        }
+        YoriLibFreeStringContents(&TempPath);
+    }
+
+    while (ThisBuffer->ChunksInMemory > ThisBuffer->MaxChunksInMemory &&
+           ThisBuffer->ChunksInMemory > 1) {
+
+        ListEntry = YoriLibGetNextListEntry(&ThisBuffer->ChunkList, NULL);
+        Chunk = CONTAINING_RECORD(ListEntry, YORI_LIBSH_PROCESS_BUFFER_CHUNK, ListEntry);
+        ASSERT(Chunk->StreamOffset == ThisBuffer->BytesSpilled);
+
+        if (!YoriLibShSeekProcessBufferSpillFile(ThisBuffer, ThisBuffer->BytesSpilled) ||
+            !WriteFile(ThisBuffer->hSpillFile, Chunk->Buffer, Chunk->BytesPopulated, &BytesWritten, NULL) ||
+            BytesWritten != Chunk->BytesPopulated) {
+
+            ThisBuffer->MaxChunksInMemory = 0;
+            return;
+        }
+
+        ThisBuffer->BytesSpilled = ThisBuffer->BytesSpilled + Chunk->BytesPopulated;
+        if (ThisBuffer->LookupHint == Chunk) {
+            ThisBuffer->LookupHint = NULL;
+        }
+        YoriLibRemoveListItem(&Chunk->ListEntry);
+        YoriLibFree(Chunk);
+        ThisBuffer->ChunksInMemory--;
+    }
+}
+
+/**
+ Copy data from a process buffer, which may be held in memory or may have
+ been written to the spill file.  The caller is expected to hold the
+ buffer's mutex.
+
+ @param ThisBuffer Pointer to the process buffer.
+
+ @param Offset The offset within the data stream to copy from.
+
+ @param Destination Pointer to a buffer to copy data into.
+
+ @param Length The number of bytes to copy.
+
+ @return The number of bytes copied.  This is less than Length if the end of
+         the data is reached or the spill file cannot be read.
+ */
+DWORD
+YoriLibShCopyFromProcessBuffer(
+    __in PYORI_LIBSH_PROCESS_BUFFER ThisBuffer,
+    __in DWORDLONG Offset,
+    __out_bcount(Length) PCHAR Destination,
+    __in DWORD Length
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK Chunk;
+    DWORD BytesCopied;
+    DWORD BytesThisPass;
+    DWORD OffsetInChunk;
+
+    if (Offset >= ThisBuffer->BytesPopulated) {
+        return 0;
+    }
+
+    if (Length > ThisBuffer->BytesPopulated - Offset) {
+        Length = (DWORD)(ThisBuffer->BytesPopulated - Offset);
+    }
+
+    BytesCopied = 0;
+
+    //
+    //  Read any data that is no longer in memory from the spill file.
+    //
+
+    if (Offset < ThisBuffer->BytesSpilled) {
+        BytesThisPass = Length;
+        if (BytesThisPass > ThisBuffer->BytesSpilled - Offset) {
+            BytesThisPass = (DWORD)(ThisBuffer->BytesSpilled - Offset);
+        }
+
+        if (!YoriLibShSeekProcessBufferSpillFile(ThisBuffer, Offset) ||
+            !ReadFile(ThisBuffer->hSpillFile, Destination, BytesThisPass, &BytesCopied, NULL) ||
+            BytesCopied != BytesThisPass) {
+
+            return BytesCopied;
+        }
+    }
+
+    if (BytesCopied == Length) {
+        return BytesCopied;
+    }
+
+    //
+    //  Find the chunk containing the next byte, starting from the chunk
+    //  that satisfied the previous read if it's not beyond this offset.
+    //
+
+    Offset = Offset + BytesCopied;
+    Chunk = ThisBuffer->LookupHint;
+    if (Chunk == NULL || Chunk->StreamOffset > Offset) {
+        ListEntry = YoriLibGetNextListEntry(&ThisBuffer->ChunkList, NULL);
+        Chunk = CONTAINING_RECORD(ListEntry, YORI_LIBSH_PROCESS_BUFFER_CHUNK, ListEntry);
+    }
+
+    while (Offset >= Chunk->StreamOffset + Chunk->BytesPopulated) {
+        ListEntry = YoriLibGetNextListEntry(&ThisBuffer->ChunkList, &Chunk->ListEntry);
+        ASSERT(ListEntry != NULL);
+        if (ListEntry == NULL) {
+            return BytesCopied;
+        }
+        Chunk = CONTAINING_RECORD(ListEntry, YORI_LIBSH_PROCESS_BUFFER_CHUNK, ListEntry);
+    }
+
+    //
+    //  Copy from this chunk and any following chunks.
+    //
+
+    while (BytesCopied < Length) {
+        OffsetInChunk = (DWORD)(Offset - Chunk->StreamOffset);
+        BytesThisPass = Chunk->BytesPopulated - OffsetInChunk;
+        if (BytesThisPass > Length - BytesCopied) {
+            BytesThisPass = Length - BytesCopied;
+        }
+
+        memcpy(Destination + BytesCopied, Chunk->Buffer + OffsetInChunk, BytesThisPass);
+        BytesCopied = BytesCopied + BytesThisPass;
+        Offset = Offset + BytesThisPass;
+        ThisBuffer->LookupHint = Chunk;
+
+        if (BytesCopied < Length) {
+            ListEntry = YoriLibGetNextListEntry(&ThisBuffer->ChunkList, &Chunk->ListEntry);
+            if (ListEntry == NULL) {
+                break;
+            }
+            Chunk = CONTAINING_RECORD(ListEntry, YORI_LIBSH_PROCESS_BUFFER_CHUNK, ListEntry);
+        }
+    }
+
+    return BytesCopied;
+}
+
 /**
  Free structures associated with a single input stream.
 
@@ -151,9 +491,23 @@ YoriLibShFreeProcessBuffer(
     __in PYORI_LIBSH_PROCESS_BUFFER ThisBuffer
     )
 {
-    if (ThisBuffer->Buffer != NULL) {
-        YoriLibFree(ThisBuffer->Buffer);
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK Chunk;
+
+    if (ThisBuffer->ChunkList.Next != NULL) {
+        ListEntry = YoriLibGetNextListEntry(&ThisBuffer->ChunkList, NULL);
+        while (ListEntry != NULL) {
+            Chunk = CONTAINING_RECORD(ListEntry, YORI_LIBSH_PROCESS_BUFFER_CHUNK, ListEntry);
+            ListEntry = YoriLibGetNextListEntry(&ThisBuffer->ChunkList, ListEntry);
+            YoriLibRemoveListItem(&Chunk->ListEntry);
+            YoriLibFree(Chunk);
+        }
     }
+    if (ThisBuffer->hSpillFile != NULL) {
+        CloseHandle(ThisBuffer->hSpillFile);
+        DeleteFile(ThisBuffer->SpillFileName.StartOfString);
+    }
+    YoriLibFreeStringContents(&ThisBuffer->SpillFileName);
     if (ThisBuffer->hMirror != NULL) {
         CloseHandle(ThisBuffer->hMirror);
     }
@@ -198,35 +552,26 @@ YoriLibShCmdBufferPumpToNextProcess(
     )
 {
     PYORI_LIBSH_PROCESS_BUFFER ThisBuffer = (PYORI_LIBSH_PROCESS_BUFFER)Param;
-    DWORD BytesSent = 0;
+    DWORDLONG BytesSent = 0;
     DWORD BytesWritten;
     DWORD BytesToWrite;
+    CHAR Data[4096];
 
     while (TRUE) {
 
-        BytesToWrite = 4096;
         AcquireMutex(ThisBuffer->Mutex);
-        if (BytesSent + BytesToWrite > ThisBuffer->BytesPopulated) {
-            BytesToWrite = ThisBuffer->BytesPopulated - BytesSent;
-        }
-
-        if (WriteFile(ThisBuffer->hSource,
-                      YoriLibAddToPointer(ThisBuffer->Buffer, BytesSent),
-                      BytesToWrite,
-                      &BytesWritten,
-                      NULL)) {
+        BytesToWrite = YoriLibShCopyFromProcessBuffer(ThisBuffer, BytesSent, Data, sizeof(Data));
+        ReleaseMutex(ThisBuffer->Mutex);
 
-            BytesSent += BytesWritten;
-        } else {
-            ReleaseMutex(ThisBuffer->Mutex);
+        if (BytesToWrite == 0) {
             break;
         }
-        ReleaseMutex(ThisBuffer->Mutex);
 
-        ASSERT(BytesSent <= ThisBuffer->BytesPopulated);
-        if (BytesSent >= ThisBuffer->BytesPopulated) {
+        if (!WriteFile(ThisBuffer->hSource, Data, BytesToWrite, &BytesWritten, NULL)) {
             break;
         }
+
+        BytesSent = BytesSent + BytesWritten;
     }
 
     CloseHandle(ThisBuffer->hSource);
@@ -250,14 +595,28 @@ YoriLibShCmdBufferPump(
     )
 {
     PYORI_LIBSH_PROCESS_BUFFER ThisBuffer = (PYORI_LIBSH_PROCESS_BUFFER)Param;
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK Chunk;
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK NewChunk;
     DWORD BytesRead;
     HANDLE hTemp;
+    CHAR Data[4096];
 
     while (ThisBuffer->hSource != NULL) {
 
+        //
+        //  Read into the final chunk.  Only this thread adds data, and the
+        //  final chunk is never written to the spill file, so this can occur
+        //  without holding the mutex.  Other threads only access bytes that
+        //  are already populated.
+        //
+
+        ListEntry = YoriLibGetPreviousListEntry(&ThisBuffer->ChunkList, NULL);
+        Chunk = CONTAINING_RECORD(ListEntry, YORI_LIBSH_PROCESS_BUFFER_CHUNK, ListEntry);
+
         if (ReadFile(ThisBuffer->hSource,
-                     YoriLibAddToPointer(ThisBuffer->Buffer, ThisBuffer->BytesPopulated),
-                     ThisBuffer->BytesAllocated - ThisBuffer->BytesPopulated,
+                     YoriLibAddToPointer(Chunk->Buffer, Chunk->BytesPopulated),
+                     YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE - Chunk->BytesPopulated,
                      &BytesRead,
                      NULL)) {
 
@@ -267,27 +626,24 @@ YoriLibShCmdBufferPump(
                 break;
             }
 
-            ThisBuffer->BytesPopulated = ThisBuffer->BytesPopulated + (YORI_ALLOC_SIZE_T)BytesRead;
-            ASSERT(ThisBuffer->BytesPopulated <= ThisBuffer->BytesAllocated);
-            if (ThisBuffer->BytesPopulated >= ThisBuffer->BytesAllocated) {
-                YORI_ALLOC_SIZE_T NewBytesAllocated;
-                PCHAR NewBuffer;
+            Chunk->BytesPopulated = Chunk->BytesPopulated + BytesRead;
+            ThisBuffer->BytesPopulated = ThisBuffer->BytesPopulated + BytesRead;
+            ASSERT(Chunk->BytesPopulated <= YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE);
+            if (Chunk->BytesPopulated >= YORI_LIBSH_PROCESS_BUFFER_CHUNK_SIZE) {
 
-                if (ThisBuffer->BytesAllocated >= YORI_MAX_ALLOC_SIZE) {
+                NewChunk = YoriLibShAllocateProcessBufferChunk(ThisBuffer->BytesPopulated);
+                if (NewChunk == NULL) {
                     break;
                 }
 
-                NewBytesAllocated = ThisBuffer->BytesAllocated * 4;
+                YoriLibAppendList(&ThisBuffer->ChunkList, &NewChunk->ListEntry);
+                ThisBuffer->ChunksInMemory++;
 
-                NewBuffer = YoriLibMalloc(NewBytesAllocated);
-                if (NewBuffer == NULL) {
-                    break;
-                }
+                if (ThisBuffer->MaxChunksInMemory != 0 &&
+                    ThisBuffer->ChunksInMemory > ThisBuffer->MaxChunksInMemory) {
 
-                memcpy(NewBuffer, ThisBuffer->Buffer, ThisBuffer->BytesAllocated);
-                YoriLibFree(ThisBuffer->Buffer);
-                ThisBuffer->Buffer = NewBuffer;
-                ThisBuffer->BytesAllocated = NewBytesAllocated;
+                    YoriLibShSpillProcessBufferChunks(ThisBuffer);
+                }
             }
         } else {
             SYSERR LastError = GetLastError();
@@ -311,13 +667,11 @@ YoriLibShCmdBufferPump(
             while (ThisBuffer->BytesSent < ThisBuffer->BytesPopulated) {
                 DWORD BytesToWrite;
                 DWORD BytesWritten;
-                BytesToWrite = 4096;
-                if (ThisBuffer->BytesSent + BytesToWrite > ThisBuffer->BytesPopulated) {
-                    BytesToWrite = ThisBuffer->BytesPopulated - ThisBuffer->BytesSent;
-                }
+                BytesToWrite = YoriLibShCopyFromProcessBuffer(ThisBuffer, ThisBuffer->BytesSent, Data, sizeof(Data));
 
-                if (WriteFile(ThisBuffer->hMirror,
-                              YoriLibAddToPointer(ThisBuffer->Buffer, ThisBuffer->BytesSent),
+                if (BytesToWrite > 0 &&
+                    WriteFile(ThisBuffer->hMirror,
+                              Data,
                               BytesToWrite,
                               &BytesWritten,
                               NULL)) {
@@ -368,12 +722,18 @@ YoriLibShAllocateSingleProcessBuffer(
     __out PYORI_LIBSH_PROCESS_BUFFER Buffer
     )
 {
-    Buffer->BytesAllocated = 1024;
-    Buffer->Buffer = YoriLibMalloc(Buffer->BytesAllocated);
-    if (Buffer->Buffer == NULL) {
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK Chunk;
+
+    YoriLibInitializeListHead(&Buffer->ChunkList);
+    Chunk = YoriLibShAllocateProcessBufferChunk(0);
+    if (Chunk == NULL) {
         return FALSE;
     }
 
+    YoriLibAppendList(&Buffer->ChunkList, &Chunk->ListEntry);
+    Buffer->ChunksInMemory = 1;
+    Buffer->MaxChunksInMemory = YoriLibShGetProcessBufferChunkLimit();
+
     Buffer->Mutex = CreateMutex(NULL, FALSE, NULL);
     if (Buffer->Mutex == NULL) {
         return FALSE;
@@ -613,7 +973,9 @@ YoriLibShReferenceProcessBuffer(
 }
 
 /**
- Return contents of a process buffer.
+ Return contents of a process buffer.  If the data is held in more than one
+ chunk, it is copied into a single allocation first so that multibyte
+ sequences that span chunks are converted correctly.
 
  @param ThisBuffer Pointer to the buffer to any output from.
 
@@ -631,29 +993,69 @@ YoriLibShGetProcessBuffer(
     )
 {
     YORI_ALLOC_SIZE_T LengthNeeded;
+    YORI_ALLOC_SIZE_T BytesPopulated;
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_LIBSH_PROCESS_BUFFER_CHUNK Chunk;
+    PCHAR Data;
+    PCHAR CombinedData;
 
-    if (ThisBuffer->Buffer == NULL) {
+    if (ThisBuffer->Mutex == NULL) {
         return FALSE;
     }
 
     AcquireMutex(ThisBuffer->Mutex);
 
-    LengthNeeded = YoriLibGetMultibyteInputSizeNeeded(ThisBuffer->Buffer, ThisBuffer->BytesPopulated);
-    if (LengthNeeded == 0 && ThisBuffer->BytesPopulated == 0) {
+    if (ThisBuffer->BytesPopulated == 0) {
         ReleaseMutex(ThisBuffer->Mutex);
         YoriLibInitEmptyString(String);
         return TRUE;
     }
 
+    if (!YoriLibIsSizeAllocatable(ThisBuffer->BytesPopulated)) {
+        ReleaseMutex(ThisBuffer->Mutex);
+        return FALSE;
+    }
+
+    BytesPopulated = (YORI_ALLOC_SIZE_T)ThisBuffer->BytesPopulated;
+    CombinedData = NULL;
+
+    if (ThisBuffer->ChunksInMemory == 1 && ThisBuffer->BytesSpilled == 0) {
+        ListEntry = YoriLibGetNextListEntry(&ThisBuffer->ChunkList, NULL);
+        Chunk = CONTAINING_RECORD(ListEntry, YORI_LIBSH_PROCESS_BUFFER_CHUNK, ListEntry);
+        Data = Chunk->Buffer;
+    } else {
+        CombinedData = YoriLibMalloc(BytesPopulated);
+        if (CombinedData == NULL) {
+            ReleaseMutex(ThisBuffer->Mutex);
+            return FALSE;
+        }
+
+        if (YoriLibShCopyFromProcessBuffer(ThisBuffer, 0, CombinedData, BytesPopulated) != BytesPopulated) {
+            ReleaseMutex(ThisBuffer->Mutex);
+            YoriLibFree(CombinedData);
+            return FALSE;
+        }
+        Data = CombinedData;
+    }
+
+    LengthNeeded = YoriLibGetMultibyteInputSizeNeeded(Data, BytesPopulated);
+
     if (!YoriLibAllocateString(String, LengthNeeded)) {
         ReleaseMutex(ThisBuffer->Mutex);
+        if (CombinedData != NULL) {
+            YoriLibFree(CombinedData);
+        }
         return FALSE;
     }
 
-    YoriLibMultibyteInput(ThisBuffer->Buffer, ThisBuffer->BytesPopulated, String->StartOfString, String->LengthAllocated);
+    YoriLibMultibyteInput(Data, BytesPopulated, String->StartOfString, String->LengthAllocated);
     String->LengthInChars = LengthNeeded;
     ReleaseMutex(ThisBuffer->Mutex);
 
+    if (CombinedData != NULL) {
+        YoriLibFree(CombinedData);
+    }
+
     return TRUE;
 }
 
@@ -924,7 +1326,7 @@ YoriLibShPipeProcessBuffers(
     //
 
     if (hPipeOutput != NULL) {
-        if (ThisBufferNonOpaque->OutputBuffer.Buffer != NULL) {
+        if (ThisBufferNonOpaque->OutputBuffer.Mutex != NULL) {
             HaveOutput = TRUE;
         } else {
             return FALSE;
@@ -932,7 +1334,7 @@ YoriLibShPipeProcessBuffers(
     }
 
     if (hPipeErrors != NULL) {
-        if (ThisBufferNonOpaque->ErrorBuffer.Buffer != NULL) {
+        if (ThisBufferNonOpaque->ErrorBuffer.Mutex != NULL) {
             HaveErrors = TRUE;
         } else {
             return FALSE;
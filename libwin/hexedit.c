@@ -62,6 +62,36 @@ typedef struct _YORI_WIN_HEX_EDIT_SELECT {
 
 } YORI_WIN_HEX_EDIT_SELECT, *PYORI_WIN_HEX_EDIT_SELECT;
 
+/**
+ The number of bytes in each modified page of paged data.  Pages are aligned
+ to this size within the backing file or device, so this must be a multiple
+ of the sector size of any device being edited.
+ */
+#define YORI_WIN_HEX_EDIT_PAGE_SIZE (4096)
+
+/**
+ The number of bytes of backing data to map or read at a time.  This must be
+ a multiple of the system allocation granularity.
+ */
+#define YORI_WIN_HEX_EDIT_WINDOW_SIZE (1024 * 1024)
+
+/**
+ A copy of a page of backing data that has been modified.
+ */
+typedef struct _YORI_WIN_HEX_EDIT_PAGE {
+
+    /**
+     The offset within the backing file or device of the start of the page.
+     */
+    YORI_MAX_UNSIGNED_T Offset;
+
+    /**
+     The contents of the page.
+     */
+    UCHAR Data[YORI_WIN_HEX_EDIT_PAGE_SIZE];
+
+} YORI_WIN_HEX_EDIT_PAGE, *PYORI_WIN_HEX_EDIT_PAGE;
+
 /**
  A structure describing the contents of a hex edit control.
  */
@@ -88,7 +118,8 @@ typedef struct _YORI_WIN_CTRL_HEX_EDIT {
     YORI_STRING Caption;
 
     /**
-     Pointer to the data buffer to display.
+     Pointer to the data buffer to display, if the data is held in memory.
+     NULL if the data is paged from a file or device.
      */
     PUCHAR Buffer;
 
@@ -98,10 +129,64 @@ typedef struct _YORI_WIN_CTRL_HEX_EDIT {
     YORI_ALLOC_SIZE_T BufferAllocated;
 
     /**
-     The number of bytes within the data allocation that contain meaningful
-     data.
+     The number of bytes of meaningful data.  If the data is held in memory
+     this is within the data allocation; if it is paged, this is the length
+     of the range within the backing file or device.
+     */
+    YORI_MAX_UNSIGNED_T BufferValid;
+
+    /**
+     Handle to the file or device that data is paged from.  NULL if the data
+     is held in memory.
+     */
+    HANDLE BackingHandle;
+
+    /**
+     Handle to a read only section for BackingHandle.  NULL if data is
+     paged in with ReadFile, which is used for devices or if the file cannot
+     be mapped.
+     */
+    HANDLE BackingSection;
+
+    /**
+     The offset within BackingHandle of the first byte displayed by the
+     control.
      */
-    YORI_ALLOC_SIZE_T BufferValid;
+    YORI_MAX_UNSIGNED_T BackingOffset;
+
+    /**
+     Points to the window of backing data most recently paged in.  If
+     BackingSection is non-NULL this is a mapped view, otherwise it is a
+     buffer populated by ReadFile.
+     */
+    PUCHAR Window;
+
+    /**
+     The offset within BackingHandle of the first byte in Window.
+     */
+    YORI_MAX_UNSIGNED_T WindowOffset;
+
+    /**
+     The number of bytes within Window that contain backing data.
+     */
+    YORI_ALLOC_SIZE_T WindowLength;
+
+    /**
+     An array of pages of backing data that have been modified, sorted by
+     offset.  Paged data is never modified in place; the first write to a
+     page copies it here and later reads are satisfied from the copy.
+     */
+    PYORI_WIN_HEX_EDIT_PAGE *ModifiedPages;
+
+    /**
+     The number of elements in the ModifiedPages array that are in use.
+     */
+    YORI_ALLOC_SIZE_T ModifiedPageCount;
+
+    /**
+     The number of elements allocated in the ModifiedPages array.
+     */
+    YORI_ALLOC_SIZE_T ModifiedPagesAllocated;
 
     /**
      The number of bytes that will be displayed in a single line of the
@@ -126,7 +211,7 @@ typedef struct _YORI_WIN_CTRL_HEX_EDIT {
     /**
      The index within LineArray that is displayed at the top of the control.
      */
-    YORI_ALLOC_SIZE_T ViewportTop;
+    YORI_MAX_UNSIGNED_T ViewportTop;
 
     /**
      The horizontal offset within each line to display.
@@ -136,7 +221,7 @@ typedef struct _YORI_WIN_CTRL_HEX_EDIT {
     /**
      The index within LineArray that the cursor is located at.
      */
-    YORI_ALLOC_SIZE_T CursorLine;
+    YORI_MAX_UNSIGNED_T CursorLine;
 
     /**
      The horizontal offset of the cursor in terms of the offset within the
@@ -151,14 +236,14 @@ typedef struct _YORI_WIN_CTRL_HEX_EDIT {
      occurs.  This is a fairly common scenario when the cursor is moved,
      where a repaint is needed but no data changes are occurring.
      */
-    YORI_ALLOC_SIZE_T FirstDirtyLine;
+    YORI_MAX_UNSIGNED_T FirstDirtyLine;
 
     /**
      The last line, in cursor coordinates, that requires redrawing.  Lines
      between the first line above and this line (inclusive) will be redrawn
      on paint.
      */
-    YORI_ALLOC_SIZE_T LastDirtyLine;
+    YORI_MAX_UNSIGNED_T LastDirtyLine;
 
     /**
      Specifies the selection state of text within the multiline edit control.
@@ -299,19 +384,19 @@ typedef enum _YORI_WIN_HEX_EDIT_CELL_TYPE {
 
  @return The number of lines that will need to be displayed.
  */
-YORI_ALLOC_SIZE_T
+YORI_MAX_UNSIGNED_T
 YoriWinHexEditLinesPopulated(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit
     )
 {
-    YORI_ALLOC_SIZE_T LineCount;
+    YORI_MAX_UNSIGNED_T LineCount;
 
     //
     //  Calculate the number of lines, rounding up if any partial lines
     //  exist.
     //
 
-    LineCount = (YORI_ALLOC_SIZE_T)((HexEdit->BufferValid + HexEdit->BytesPerLine - 1)/HexEdit->BytesPerLine);
+    LineCount = (HexEdit->BufferValid + HexEdit->BytesPerLine - 1)/HexEdit->BytesPerLine;
     return LineCount;
 }
 
@@ -420,7 +505,7 @@ YoriWinHexEditGetCellIndexForBitShift(
 YORI_WIN_HEX_EDIT_CELL_TYPE
 YoriWinHexEditCellType(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T LineIndex,
+    __in YORI_MAX_UNSIGNED_T LineIndex,
     __in YORI_ALLOC_SIZE_T CellOffset,
     __out_opt PYORI_ALLOC_SIZE_T ByteOffset,
     __out_opt PUCHAR BitShift,
@@ -431,7 +516,7 @@ YoriWinHexEditCellType(
     UCHAR ModValue;
     YORI_ALLOC_SIZE_T DataOffset;
     YORI_ALLOC_SIZE_T BytesThisLine;
-    YORI_ALLOC_SIZE_T LinesPopulated;
+    YORI_MAX_UNSIGNED_T LinesPopulated;
     UCHAR CellsPerWord;
     YORI_ALLOC_SIZE_T OffsetInChars;
     YORI_ALLOC_SIZE_T WordsPerLine;
@@ -450,7 +535,7 @@ YoriWinHexEditCellType(
     LinesPopulated = YoriWinHexEditLinesPopulated(HexEdit);
     BytesThisLine = HexEdit->BytesPerLine;
     if (LineIndex + 1 == LinesPopulated) {
-        YORI_ALLOC_SIZE_T BytesInFullLines;
+        YORI_MAX_UNSIGNED_T BytesInFullLines;
 
         BytesInFullLines = LineIndex;
         BytesInFullLines = BytesInFullLines * HexEdit->BytesPerLine;
@@ -566,8 +651,8 @@ __success(return)
 BOOLEAN
 YoriWinHexEditCellFromCharBufferOffset(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
-    __out PYORI_ALLOC_SIZE_T EndLine,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
+    __out PYORI_MAX_UNSIGNED_T EndLine,
     __out PYORI_ALLOC_SIZE_T EndCharOffset
     )
 {
@@ -591,7 +676,7 @@ YoriWinHexEditCellFromCharBufferOffset(
     CellsPerWord = YoriWinHexEditGetCellsPerWord(HexEdit);
     WordsPerLine = HexEdit->BytesPerLine / HexEdit->BytesPerWord;
 
-    *EndLine = (YORI_ALLOC_SIZE_T)(BufferOffset / HexEdit->BytesPerLine);
+    *EndLine = BufferOffset / HexEdit->BytesPerLine;
     LineByteOffset = (YORI_ALLOC_SIZE_T)(BufferOffset % HexEdit->BytesPerLine);
     *EndCharOffset = OffsetInChars + WordsPerLine * CellsPerWord + 1 + LineByteOffset;
     return TRUE;
@@ -621,9 +706,9 @@ __success(return)
 BOOLEAN
 YoriWinHexEditCellFromHexBufferOffset(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
     __in UCHAR BitShift,
-    __out PYORI_ALLOC_SIZE_T EndLine,
+    __out PYORI_MAX_UNSIGNED_T EndLine,
     __out PYORI_ALLOC_SIZE_T EndCharOffset
     )
 {
@@ -651,7 +736,7 @@ YoriWinHexEditCellFromHexBufferOffset(
     CellsPerWord = YoriWinHexEditGetCellsPerWord(HexEdit);
 
     *EndLine = (BufferOffset / HexEdit->BytesPerLine);
-    LineByteOffset = (BufferOffset % HexEdit->BytesPerLine);
+    LineByteOffset = (YORI_ALLOC_SIZE_T)(BufferOffset % HexEdit->BytesPerLine);
     LineCellOffset = (LineByteOffset + HexEdit->BytesPerWord - 1) / HexEdit->BytesPerWord;
 
     BitShiftCellIndex = YoriWinHexEditGetCellIndexForBitShift(HexEdit, BitShift);
@@ -687,15 +772,15 @@ BOOLEAN
 YoriWinHexEditPreviousCellSameType(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __in YORI_WIN_HEX_EDIT_CELL_TYPE CellType,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
     __in UCHAR BitShift,
-    __out PYORI_ALLOC_SIZE_T EndLine,
+    __out PYORI_MAX_UNSIGNED_T EndLine,
     __out PYORI_ALLOC_SIZE_T EndCharOffset
     )
 {
     UCHAR NewBitShift;
     YORI_ALLOC_SIZE_T Unaligned;
-    YORI_ALLOC_SIZE_T NewBufferOffset;
+    YORI_MAX_UNSIGNED_T NewBufferOffset;
 
     if (CellType != YoriWinHexEditCellTypeHexDigit &&
         CellType != YoriWinHexEditCellTypeCharValue) {
@@ -721,7 +806,7 @@ YoriWinHexEditPreviousCellSameType(
     Unaligned = (YORI_ALLOC_SIZE_T)(NewBufferOffset % HexEdit->BytesPerWord);
     ASSERT(Unaligned == 0);
     if (Unaligned != 0) {
-        NewBufferOffset = (YORI_ALLOC_SIZE_T)(NewBufferOffset - Unaligned);
+        NewBufferOffset = NewBufferOffset - Unaligned;
         NewBitShift = (UCHAR)(NewBitShift + 8 * Unaligned);
     }
 
@@ -764,15 +849,15 @@ BOOLEAN
 YoriWinHexEditNextCellSameType(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __in YORI_WIN_HEX_EDIT_CELL_TYPE CellType,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
     __in UCHAR BitShift,
-    __out PYORI_ALLOC_SIZE_T EndLine,
+    __out PYORI_MAX_UNSIGNED_T EndLine,
     __out PYORI_ALLOC_SIZE_T EndCharOffset
     )
 {
     UCHAR NewBitShift;
     YORI_ALLOC_SIZE_T Unaligned;
-    YORI_ALLOC_SIZE_T NewBufferOffset;
+    YORI_MAX_UNSIGNED_T NewBufferOffset;
 
     if (CellType != YoriWinHexEditCellTypeHexDigit &&
         CellType != YoriWinHexEditCellTypeCharValue) {
@@ -810,6 +895,564 @@ YoriWinHexEditNextCellSameType(
     return YoriWinHexEditCellFromHexBufferOffset(HexEdit, NewBufferOffset, NewBitShift, EndLine, EndCharOffset);
 }
 
+//
+//  =========================================
+//  DATA ACCESS FUNCTIONS
+//  =========================================
+//
+
+/**
+ Copy data from a window of backing data.  If the window is a mapped view,
+ touching it raises EXCEPTION_IN_PAGE_ERROR if the backing file cannot be
+ read, for example because removable media was ejected or a network
+ connection was lost.  That exception is caught here and reported as a
+ failure so the control can keep running.
+
+ @param Dest Pointer to the buffer to copy data into.
+
+ @param Source Pointer within the window to copy data from.
+
+ @param Length The number of bytes to copy.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditCopyFromWindow(
+    __out_bcount(Length) PUCHAR Dest,
+    __in_bcount(Length) UCHAR CONST * Source,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    __try {
+        memcpy(Dest, Source, Length);
+    } __except(GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Ensure the window of backing data contains the specified offset, mapping or
+ reading a new window if it does not.
+
+ @param HexEdit Pointer to the hex edit control.
+
+ @param BackingOffset The offset within the backing file or device that the
+        window should contain.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditMoveWindow(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
+    __in YORI_MAX_UNSIGNED_T BackingOffset
+    )
+{
+    YORI_MAX_UNSIGNED_T BackingEnd;
+    YORI_MAX_UNSIGNED_T WindowOffset;
+    YORI_ALLOC_SIZE_T WindowLength;
+    LARGE_INTEGER FileOffset;
+    DWORD BytesRead;
+    PVOID View;
+
+    if (HexEdit->Window != NULL &&
+        BackingOffset >= HexEdit->WindowOffset &&
+        BackingOffset < HexEdit->WindowOffset + HexEdit->WindowLength) {
+
+        return TRUE;
+    }
+
+    BackingEnd = HexEdit->BackingOffset + HexEdit->BufferValid;
+    if (BackingOffset >= BackingEnd) {
+        return FALSE;
+    }
+
+    WindowOffset = BackingOffset - (BackingOffset % YORI_WIN_HEX_EDIT_WINDOW_SIZE);
+    WindowLength = YORI_WIN_HEX_EDIT_WINDOW_SIZE;
+    if (BackingEnd - WindowOffset < WindowLength) {
+        WindowLength = (YORI_ALLOC_SIZE_T)(BackingEnd - WindowOffset);
+    }
+
+    FileOffset.QuadPart = WindowOffset;
+    HexEdit->WindowLength = 0;
+
+    if (HexEdit->BackingSection != NULL) {
+        if (HexEdit->Window != NULL) {
+            UnmapViewOfFile(HexEdit->Window);
+            HexEdit->Window = NULL;
+        }
+
+        View = MapViewOfFile(HexEdit->BackingSection, FILE_MAP_READ, FileOffset.HighPart, FileOffset.LowPart, WindowLength);
+        if (View == NULL) {
+            return FALSE;
+        }
+
+        HexEdit->Window = View;
+    } else {
+
+        //
+        //  Devices can only be read in multiples of the sector size, so
+        //  read whole pages and let the read stop at the end of the device.
+        //
+
+        WindowLength = (WindowLength + YORI_WIN_HEX_EDIT_PAGE_SIZE - 1) / YORI_WIN_HEX_EDIT_PAGE_SIZE * YORI_WIN_HEX_EDIT_PAGE_SIZE;
+        FileOffset.LowPart = SetFilePointer(HexEdit->BackingHandle, FileOffset.LowPart, &FileOffset.HighPart, FILE_BEGIN);
+        if (FileOffset.LowPart == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR) {
+            return FALSE;
+        }
+
+        if (!ReadFile(HexEdit->BackingHandle, HexEdit->Window, WindowLength, &BytesRead, NULL)) {
+            return FALSE;
+        }
+
+        WindowLength = BytesRead;
+    }
+
+    HexEdit->WindowOffset = WindowOffset;
+    HexEdit->WindowLength = WindowLength;
+
+    if (BackingOffset >= WindowOffset + WindowLength) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Read data from the backing file or device, ignoring any modified pages.
+
+ @param HexEdit Pointer to the hex edit control.
+
+ @param BackingOffset The offset within the backing file or device to read
+        from.
+
+ @param Buffer Pointer to a buffer to populate with data.
+
+ @param Length The number of bytes to read.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditReadBacking(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
+    __in YORI_MAX_UNSIGNED_T BackingOffset,
+    __out_bcount(Length) PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_ALLOC_SIZE_T BytesCopied;
+    YORI_ALLOC_SIZE_T BytesThisPass;
+    YORI_ALLOC_SIZE_T WindowIndex;
+
+    BytesCopied = 0;
+    while (BytesCopied < Length) {
+        if (!YoriWinHexEditMoveWindow(HexEdit, BackingOffset + BytesCopied)) {
+            return FALSE;
+        }
+
+        WindowIndex = (YORI_ALLOC_SIZE_T)(BackingOffset + BytesCopied - HexEdit->WindowOffset);
+        BytesThisPass = HexEdit->WindowLength - WindowIndex;
+        if (BytesThisPass > Length - BytesCopied) {
+            BytesThisPass = Length - BytesCopied;
+        }
+
+        if (!YoriWinHexEditCopyFromWindow(&Buffer[BytesCopied], &HexEdit->Window[WindowIndex], BytesThisPass)) {
+            return FALSE;
+        }
+
+        BytesCopied = BytesCopied + BytesThisPass;
+    }
+
+    return TRUE;
+}
+
+/**
+ Search the array of modified pages for the page at a specified offset.
+
+ @param HexEdit Pointer to the hex edit control.
+
+ @param PageOffset The offset within the backing file or device of the page
+        to find.  This is aligned to YORI_WIN_HEX_EDIT_PAGE_SIZE.
+
+ @param Index On completion, updated to the index of the page within the
+        modified page array if it was found, or the index at which it
+        should be inserted if it was not found.
+
+ @return TRUE if the page has been modified, FALSE if it has not.
+ */
+BOOLEAN
+YoriWinHexEditFindModifiedPage(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
+    __in YORI_MAX_UNSIGNED_T PageOffset,
+    __out PYORI_ALLOC_SIZE_T Index
+    )
+{
+    YORI_ALLOC_SIZE_T Start;
+    YORI_ALLOC_SIZE_T End;
+    YORI_ALLOC_SIZE_T Middle;
+    PYORI_WIN_HEX_EDIT_PAGE Page;
+
+    Start = 0;
+    End = HexEdit->ModifiedPageCount;
+    while (Start < End) {
+        Middle = Start + (End - Start) / 2;
+        Page = HexEdit->ModifiedPages[Middle];
+        if (Page->Offset == PageOffset) {
+            *Index = Middle;
+            return TRUE;
+        } else if (Page->Offset < PageOffset) {
+            Start = Middle + 1;
+        } else {
+            End = Middle;
+        }
+    }
+
+    *Index = Start;
+    return FALSE;
+}
+
+/**
+ Allocate a modified page, populate it from the backing file or device, and
+ insert it into the array of modified pages.
+
+ @param HexEdit Pointer to the hex edit control.
+
+ @param PageOffset The offset within the backing file or device of the page
+        to allocate.  This is aligned to YORI_WIN_HEX_EDIT_PAGE_SIZE.
+
+ @param Index The index within the modified page array to insert the page,
+        as returned from @ref YoriWinHexEditFindModifiedPage .
+
+ @return Pointer to the page, or NULL on failure.
+ */
+PYORI_WIN_HEX_EDIT_PAGE
+YoriWinHexEditAllocateModifiedPage(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
+    __in YORI_MAX_UNSIGNED_T PageOffset,
+    __in YORI_ALLOC_SIZE_T Index
+    )
+{
+    PYORI_WIN_HEX_EDIT_PAGE Page;
+    PYORI_WIN_HEX_EDIT_PAGE *NewPages;
+    YORI_ALLOC_SIZE_T NewAllocated;
+    YORI_MAX_UNSIGNED_T BackingEnd;
+    YORI_ALLOC_SIZE_T BytesToRead;
+
+    if (HexEdit->ModifiedPageCount >= HexEdit->ModifiedPagesAllocated) {
+        NewAllocated = HexEdit->ModifiedPagesAllocated * 2;
+        if (NewAllocated < 64) {
+            NewAllocated = 64;
+        }
+
+        if (!YoriLibIsSizeAllocatable((YORI_MAX_UNSIGNED_T)NewAllocated * sizeof(PYORI_WIN_HEX_EDIT_PAGE))) {
+            return NULL;
+        }
+
+        NewPages = YoriLibMalloc(NewAllocated * sizeof(PYORI_WIN_HEX_EDIT_PAGE));
+        if (NewPages == NULL) {
+            return NULL;
+        }
+
+        if (HexEdit->ModifiedPages != NULL) {
+            memcpy(NewPages, HexEdit->ModifiedPages, HexEdit->ModifiedPageCount * sizeof(PYORI_WIN_HEX_EDIT_PAGE));
+            YoriLibFree(HexEdit->ModifiedPages);
+        }
+
+        HexEdit->ModifiedPages = NewPages;
+        HexEdit->ModifiedPagesAllocated = NewAllocated;
+    }
+
+    Page = YoriLibMalloc(sizeof(YORI_WIN_HEX_EDIT_PAGE));
+    if (Page == NULL) {
+        return NULL;
+    }
+
+    //
+    //  The page can begin before the data displayed in the control, since
+    //  pages are aligned within the backing file or device.  Any part of
+    //  the page beyond the end of the data is never displayed or written.
+    //
+
+    BackingEnd = HexEdit->BackingOffset + HexEdit->BufferValid;
+    BytesToRead = YORI_WIN_HEX_EDIT_PAGE_SIZE;
+    if (BackingEnd - PageOffset < BytesToRead) {
+        BytesToRead = (YORI_ALLOC_SIZE_T)(BackingEnd - PageOffset);
+        ZeroMemory(&Page->Data[BytesToRead], YORI_WIN_HEX_EDIT_PAGE_SIZE - BytesToRead);
+    }
+
+    if (!YoriWinHexEditReadBacking(HexEdit, PageOffset, Page->Data, BytesToRead)) {
+        YoriLibFree(Page);
+        return NULL;
+    }
+
+    Page->Offset = PageOffset;
+
+    if (Index < HexEdit->ModifiedPageCount) {
+        memmove(&HexEdit->ModifiedPages[Index + 1],
+                &HexEdit->ModifiedPages[Index],
+                (HexEdit->ModifiedPageCount - Index) * sizeof(PYORI_WIN_HEX_EDIT_PAGE));
+    }
+
+    HexEdit->ModifiedPages[Index] = Page;
+    HexEdit->ModifiedPageCount++;
+
+    return Page;
+}
+
+/**
+ Free all modified pages.  Any changes to paged data that have not been
+ written back are discarded.
+
+ @param HexEdit Pointer to the hex edit control.
+ */
+VOID
+YoriWinHexEditFreeModifiedPages(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+
+    for (Index = 0; Index < HexEdit->ModifiedPageCount; Index++) {
+        YoriLibFree(HexEdit->ModifiedPages[Index]);
+    }
+
+    if (HexEdit->ModifiedPages != NULL) {
+        YoriLibFree(HexEdit->ModifiedPages);
+        HexEdit->ModifiedPages = NULL;
+    }
+
+    HexEdit->ModifiedPageCount = 0;
+    HexEdit->ModifiedPagesAllocated = 0;
+}
+
+/**
+ Read data from the control, whether it is held in memory or paged from a
+ file or device.
+
+ @param HexEdit Pointer to the hex edit control.
+
+ @param Offset The offset within the data to read from.
+
+ @param Buffer Pointer to a buffer to populate with data.
+
+ @param Length The number of bytes to read.  The range must be within the
+        valid data.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditReadDataInternal(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __out_bcount(Length) PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_MAX_UNSIGNED_T BackingOffset;
+    YORI_ALLOC_SIZE_T PageIndex;
+    YORI_ALLOC_SIZE_T BytesCopied;
+    YORI_ALLOC_SIZE_T BytesThisPass;
+    YORI_ALLOC_SIZE_T Index;
+
+    ASSERT(Offset <= HexEdit->BufferValid && HexEdit->BufferValid - Offset >= Length);
+    if (Offset > HexEdit->BufferValid || HexEdit->BufferValid - Offset < Length) {
+        return FALSE;
+    }
+
+    if (HexEdit->BackingHandle == NULL) {
+        if (Length > 0) {
+            memcpy(Buffer, &HexEdit->Buffer[(YORI_ALLOC_SIZE_T)Offset], Length);
+        }
+        return TRUE;
+    }
+
+    if (HexEdit->ModifiedPageCount == 0) {
+        return YoriWinHexEditReadBacking(HexEdit, HexEdit->BackingOffset + Offset, Buffer, Length);
+    }
+
+    BytesCopied = 0;
+    while (BytesCopied < Length) {
+        BackingOffset = HexEdit->BackingOffset + Offset + BytesCopied;
+        PageIndex = (YORI_ALLOC_SIZE_T)(BackingOffset % YORI_WIN_HEX_EDIT_PAGE_SIZE);
+        BytesThisPass = YORI_WIN_HEX_EDIT_PAGE_SIZE - PageIndex;
+        if (BytesThisPass > Length - BytesCopied) {
+            BytesThisPass = Length - BytesCopied;
+        }
+
+        if (YoriWinHexEditFindModifiedPage(HexEdit, BackingOffset - PageIndex, &Index)) {
+            memcpy(&Buffer[BytesCopied], &HexEdit->ModifiedPages[Index]->Data[PageIndex], BytesThisPass);
+        } else if (!YoriWinHexEditReadBacking(HexEdit, BackingOffset, &Buffer[BytesCopied], BytesThisPass)) {
+            return FALSE;
+        }
+
+        BytesCopied = BytesCopied + BytesThisPass;
+    }
+
+    return TRUE;
+}
+
+/**
+ Overwrite data in the control, whether it is held in memory or paged from a
+ file or device.  Paged data is not written back to the file or device; the
+ modified pages are retained in memory until they are written by
+ @ref YoriWinHexEditWriteModifiedPages .
+
+ @param HexEdit Pointer to the hex edit control.
+
+ @param Offset The offset within the data to write to.
+
+ @param Buffer Pointer to the data to write.
+
+ @param Length The number of bytes to write.  The range must be within the
+        valid data.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditWriteDataInternal(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __in_bcount(Length) UCHAR CONST * Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    YORI_MAX_UNSIGNED_T BackingOffset;
+    YORI_ALLOC_SIZE_T PageIndex;
+    YORI_ALLOC_SIZE_T BytesCopied;
+    YORI_ALLOC_SIZE_T BytesThisPass;
+    YORI_ALLOC_SIZE_T Index;
+    PYORI_WIN_HEX_EDIT_PAGE Page;
+
+    ASSERT(Offset <= HexEdit->BufferValid && HexEdit->BufferValid - Offset >= Length);
+    if (Offset > HexEdit->BufferValid || HexEdit->BufferValid - Offset < Length) {
+        return FALSE;
+    }
+
+    if (HexEdit->BackingHandle == NULL) {
+        if (Length > 0) {
+            memcpy(&HexEdit->Buffer[(YORI_ALLOC_SIZE_T)Offset], Buffer, Length);
+        }
+        return TRUE;
+    }
+
+    BytesCopied = 0;
+    while (BytesCopied < Length) {
+        BackingOffset = HexEdit->BackingOffset + Offset + BytesCopied;
+        PageIndex = (YORI_ALLOC_SIZE_T)(BackingOffset % YORI_WIN_HEX_EDIT_PAGE_SIZE);
+        BytesThisPass = YORI_WIN_HEX_EDIT_PAGE_SIZE - PageIndex;
+        if (BytesThisPass > Length - BytesCopied) {
+            BytesThisPass = Length - BytesCopied;
+        }
+
+        if (YoriWinHexEditFindModifiedPage(HexEdit, BackingOffset - PageIndex, &Index)) {
+            Page = HexEdit->ModifiedPages[Index];
+        } else {
+            Page = YoriWinHexEditAllocateModifiedPage(HexEdit, BackingOffset - PageIndex, Index);
+            if (Page == NULL) {
+                return FALSE;
+            }
+        }
+
+        memcpy(&Page->Data[PageIndex], &Buffer[BytesCopied], BytesThisPass);
+        BytesCopied = BytesCopied + BytesThisPass;
+    }
+
+    return TRUE;
+}
+
+/**
+ Stop paging data from a file or device, closing the handle and discarding
+ any modified pages.  The control contains no data after this call.
+
+ @param HexEdit Pointer to the hex edit control.
+ */
+VOID
+YoriWinHexEditReleaseBacking(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit
+    )
+{
+    YoriWinHexEditFreeModifiedPages(HexEdit);
+
+    if (HexEdit->Window != NULL) {
+        if (HexEdit->BackingSection != NULL) {
+            UnmapViewOfFile(HexEdit->Window);
+        } else {
+            VirtualFree(HexEdit->Window, 0, MEM_RELEASE);
+        }
+        HexEdit->Window = NULL;
+    }
+    HexEdit->WindowOffset = 0;
+    HexEdit->WindowLength = 0;
+
+    if (HexEdit->BackingSection != NULL) {
+        CloseHandle(HexEdit->BackingSection);
+        HexEdit->BackingSection = NULL;
+    }
+
+    if (HexEdit->BackingHandle != NULL) {
+        CloseHandle(HexEdit->BackingHandle);
+        HexEdit->BackingHandle = NULL;
+    }
+
+    HexEdit->BackingOffset = 0;
+    HexEdit->BufferValid = 0;
+}
+
+/**
+ If the control is paging data from a file or device, read all of the data
+ into memory and stop paging.  This is required before the length of the
+ data can change, since inserting or deleting bytes moves all following
+ data.  This fails if the data is too large to hold in memory.
+
+ @param HexEdit Pointer to the hex edit control.
+
+ @return TRUE to indicate the data is held in memory, FALSE to indicate
+         failure.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditConvertToMemory(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit
+    )
+{
+    PUCHAR NewBuffer;
+    YORI_ALLOC_SIZE_T Length;
+
+    if (HexEdit->BackingHandle == NULL) {
+        return TRUE;
+    }
+
+    if (!YoriLibIsSizeAllocatable(HexEdit->BufferValid + 1)) {
+        return FALSE;
+    }
+
+    Length = (YORI_ALLOC_SIZE_T)HexEdit->BufferValid;
+    NewBuffer = YoriLibReferencedMalloc(Length + 1);
+    if (NewBuffer == NULL) {
+        return FALSE;
+    }
+
+    if (!YoriWinHexEditReadDataInternal(HexEdit, 0, NewBuffer, Length)) {
+        YoriLibDereference(NewBuffer);
+        return FALSE;
+    }
+
+    YoriWinHexEditReleaseBacking(HexEdit);
+
+    ASSERT(HexEdit->Buffer == NULL);
+    HexEdit->Buffer = NewBuffer;
+    HexEdit->BufferAllocated = Length + 1;
+    HexEdit->BufferValid = Length;
+
+    return TRUE;
+}
+
 //
 //  =========================================
 //  DISPLAY FUNCTIONS
@@ -833,7 +1476,7 @@ YoriWinHexEditNextCellSameType(
 WORD
 YoriWinHexEditSelectionColor(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T Offset,
+    __in YORI_MAX_UNSIGNED_T Offset,
     __in BOOLEAN PaddingAfter
     )
 {
@@ -846,8 +1489,8 @@ YoriWinHexEditSelectionColor(
     if (Offset >= HexEdit->Selection.FirstByteOffset &&
         Offset < HexEdit->Selection.BeyondLastByteOffset) {
 
-        YORI_ALLOC_SIZE_T LastByteOffset;
-        LastByteOffset = (YORI_ALLOC_SIZE_T)(HexEdit->Selection.BeyondLastByteOffset - 1);
+        YORI_MAX_UNSIGNED_T LastByteOffset;
+        LastByteOffset = HexEdit->Selection.BeyondLastByteOffset - 1;
 
         if (PaddingAfter && Offset == LastByteOffset) {
             return Attributes;
@@ -874,6 +1517,9 @@ YoriWinHexEditSelectionColor(
  @param Offset The offset within the hex edit control's buffer to display
         data from.
 
+ @param Buffer Pointer to the data to display, which has been read from
+        Offset.
+
  @param BytesToDisplay Number of bytes to display.
 
  @return The number of elements written to the Output buffer.
@@ -883,7 +1529,8 @@ YoriWinHexEditByteLine(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __out_ecount(OutputSize) PCHAR_INFO Output,
     __in YORI_ALLOC_SIZE_T OutputSize,
-    __in YORI_ALLOC_SIZE_T Offset,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __in_ecount(BytesToDisplay) UCHAR CONST * Buffer,
     __in YORI_ALLOC_SIZE_T BytesToDisplay
     )
 {
@@ -893,7 +1540,6 @@ YoriWinHexEditByteLine(
     YORI_ALLOC_SIZE_T ByteIndex;
     YORI_ALLOC_SIZE_T OutputIndex = 0;
     YORI_ALLOC_SIZE_T WordCount;
-    UCHAR CONST * Buffer;
 
     ASSERT(BytesToDisplay <= HexEdit->BytesPerLine);
     if (BytesToDisplay > HexEdit->BytesPerLine) {
@@ -906,8 +1552,6 @@ YoriWinHexEditByteLine(
         return 0;
     }
 
-    Buffer = &HexEdit->Buffer[Offset];
-
     for (WordIndex = 0; WordIndex < WordCount; WordIndex++) {
 
         WordToDisplay = 0;
@@ -957,6 +1601,9 @@ YoriWinHexEditByteLine(
  @param Offset The offset within the hex edit control's buffer to display
         data from.
 
+ @param Buffer Pointer to the data to display, which has been read from
+        Offset.
+
  @param BytesToDisplay Number of bytes to display.
 
  @return The number of elements written to the Output buffer.
@@ -966,7 +1613,8 @@ YoriWinHexEditWordLine(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __out_ecount(OutputSize) PCHAR_INFO Output,
     __in YORI_ALLOC_SIZE_T OutputSize,
-    __in YORI_ALLOC_SIZE_T Offset,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __in_ecount(BytesToDisplay) UCHAR CONST * Buffer,
     __in YORI_ALLOC_SIZE_T BytesToDisplay
     )
 {
@@ -976,7 +1624,6 @@ YoriWinHexEditWordLine(
     YORI_ALLOC_SIZE_T ByteIndex;
     YORI_ALLOC_SIZE_T OutputIndex = 0;
     YORI_ALLOC_SIZE_T WordCount;
-    UCHAR CONST * Buffer;
 
     ASSERT(BytesToDisplay <= HexEdit->BytesPerLine);
     if (BytesToDisplay > HexEdit->BytesPerLine) {
@@ -988,8 +1635,6 @@ YoriWinHexEditWordLine(
         return 0;
     }
 
-    Buffer = &HexEdit->Buffer[Offset];
-
     for (WordIndex = 0; WordIndex < WordCount; WordIndex++) {
 
         WordToDisplay = 0;
@@ -1044,6 +1689,9 @@ YoriWinHexEditWordLine(
  @param Offset The offset within the hex edit control's buffer to display
         data from.
 
+ @param Buffer Pointer to the data to display, which has been read from
+        Offset.
+
  @param BytesToDisplay Number of bytes to display.
 
  @return The number of elements written to the Output buffer.
@@ -1053,7 +1701,8 @@ YoriWinHexEditDWordLine(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __out_ecount(OutputSize) PCHAR_INFO Output,
     __in YORI_ALLOC_SIZE_T OutputSize,
-    __in YORI_ALLOC_SIZE_T Offset,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __in_ecount(BytesToDisplay) UCHAR CONST * Buffer,
     __in YORI_ALLOC_SIZE_T BytesToDisplay
     )
 {
@@ -1063,7 +1712,6 @@ YoriWinHexEditDWordLine(
     YORI_ALLOC_SIZE_T ByteIndex;
     YORI_ALLOC_SIZE_T OutputIndex = 0;
     YORI_ALLOC_SIZE_T WordCount;
-    UCHAR CONST * Buffer;
 
     ASSERT(BytesToDisplay <= HexEdit->BytesPerLine);
     if (BytesToDisplay > HexEdit->BytesPerLine) {
@@ -1075,8 +1723,6 @@ YoriWinHexEditDWordLine(
         return 0;
     }
 
-    Buffer = &HexEdit->Buffer[Offset];
-
     for (WordIndex = 0; WordIndex < WordCount; WordIndex++) {
 
         WordToDisplay = 0;
@@ -1138,6 +1784,9 @@ YoriWinHexEditDWordLine(
  @param Offset The offset within the hex edit control's buffer to display
         data from.
 
+ @param Buffer Pointer to the data to display, which has been read from
+        Offset.
+
  @param BytesToDisplay Number of bytes to display.
 
  @return The number of elements written to the Output buffer.
@@ -1147,7 +1796,8 @@ YoriWinHexEditDWordLongLine(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __out_ecount(OutputSize) PCHAR_INFO Output,
     __in YORI_ALLOC_SIZE_T OutputSize,
-    __in YORI_ALLOC_SIZE_T Offset,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __in_ecount(BytesToDisplay) UCHAR CONST * Buffer,
     __in YORI_ALLOC_SIZE_T BytesToDisplay
     )
 {
@@ -1157,7 +1807,6 @@ YoriWinHexEditDWordLongLine(
     YORI_ALLOC_SIZE_T ByteIndex;
     YORI_ALLOC_SIZE_T OutputIndex = 0;
     YORI_ALLOC_SIZE_T WordCount;
-    UCHAR CONST * Buffer;
 
     ASSERT(BytesToDisplay <= HexEdit->BytesPerLine);
     if (BytesToDisplay > HexEdit->BytesPerLine) {
@@ -1169,8 +1818,6 @@ YoriWinHexEditDWordLongLine(
         return 0;
     }
 
-    Buffer = &HexEdit->Buffer[Offset];
-
     for (WordIndex = 0; WordIndex < WordCount; WordIndex++) {
 
         WordToDisplay = 0;
@@ -1261,7 +1908,7 @@ YoriWinHexEditDWordLongLine(
 VOID
 YoriWinHexEditFindCursorCharFromDisplayChar(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T LineIndex,
+    __in YORI_MAX_UNSIGNED_T LineIndex,
     __in YORI_ALLOC_SIZE_T DisplayChar,
     __out PYORI_ALLOC_SIZE_T CursorChar
     )
@@ -1288,7 +1935,7 @@ YoriWinHexEditFindCursorCharFromDisplayChar(
 VOID
 YoriWinHexEditFindDisplayCharFromCursorChar(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T LineIndex,
+    __in YORI_MAX_UNSIGNED_T LineIndex,
     __in YORI_ALLOC_SIZE_T CursorChar,
     __out PYORI_ALLOC_SIZE_T DisplayChar
     )
@@ -1318,11 +1965,11 @@ YoriWinHexEditTranslateViewportCoordinatesToCursorCoordinates(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __in YORI_ALLOC_SIZE_T ViewportLeftOffset,
     __in YORI_ALLOC_SIZE_T ViewportTopOffset,
-    __out PYORI_ALLOC_SIZE_T LineIndex,
+    __out PYORI_MAX_UNSIGNED_T LineIndex,
     __out PYORI_ALLOC_SIZE_T CursorChar
     )
 {
-    YORI_ALLOC_SIZE_T LineOffset;
+    YORI_MAX_UNSIGNED_T LineOffset;
     YORI_ALLOC_SIZE_T DisplayOffset;
 
     LineOffset = ViewportTopOffset + HexEdit->ViewportTop;
@@ -1347,15 +1994,15 @@ YoriWinHexEditRepaintScrollBar(
     )
 {
     if (HexEdit->VScrollCtrl) {
-        DWORD MaximumTopValue;
-        DWORD LinesPopulated;
+        YORI_MAX_UNSIGNED_T MaximumTopValue;
+        YORI_MAX_UNSIGNED_T LinesPopulated;
         COORD ClientSize;
 
         YoriWinGetControlClientSize(&HexEdit->Ctrl, &ClientSize);
 
         LinesPopulated = YoriWinHexEditLinesPopulated(HexEdit);
 
-        if (LinesPopulated > (DWORD)ClientSize.Y) {
+        if (LinesPopulated > (YORI_MAX_UNSIGNED_T)ClientSize.Y) {
             MaximumTopValue = LinesPopulated - ClientSize.Y;
         } else {
             MaximumTopValue = 0;
@@ -1466,7 +2113,7 @@ VOID
 YoriWinHexEditPaintSingleLine(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __in PCOORD ClientSize,
-    __in YORI_ALLOC_SIZE_T LineIndex
+    __in YORI_MAX_UNSIGNED_T LineIndex
     )
 {
     WORD ColumnIndex;
@@ -1474,14 +2121,16 @@ YoriWinHexEditPaintSingleLine(
     WORD TextAttributes;
     WORD RowIndex;
     YORI_STRING String;
-    DWORD LinesPopulated;
+    YORI_MAX_UNSIGNED_T LinesPopulated;
     TCHAR StringBuffer[sizeof("01234567`89abcdef: ")];
     CHAR_INFO CharInfoBuffer[YORI_LIB_HEXDUMP_BYTES_PER_LINE * 4 + 32];
+    UCHAR SourceBuffer[YORI_LIB_HEXDUMP_BYTES_PER_LINE];
     YORI_ALLOC_SIZE_T CharInfoBufferAllocated;
     YORI_ALLOC_SIZE_T CharInfoBufferPopulated;
-    YORI_ALLOC_SIZE_T Offset;
+    YORI_ALLOC_SIZE_T DataCellsStart;
+    YORI_MAX_UNSIGNED_T Offset;
     YORI_ALLOC_SIZE_T LineLength;
-    PUCHAR SourceBuffer;
+    BOOLEAN DataValid;
     YORI_ALLOC_SIZE_T WordIndex;
     UCHAR CharToDisplay;
     PCHAR_INFO Cell;
@@ -1506,13 +2155,23 @@ YoriWinHexEditPaintSingleLine(
 
         ASSERT(Offset <= HexEdit->BufferValid);
 
-        SourceBuffer = &HexEdit->Buffer[Offset];
         if (HexEdit->BufferValid - Offset < HexEdit->BytesPerLine) {
             LineLength = (YORI_ALLOC_SIZE_T)(HexEdit->BufferValid - Offset);
         } else {
             LineLength = HexEdit->BytesPerLine;
         }
 
+        //
+        //  If the data is paged and the backing file or device cannot be
+        //  read, display the line with placeholders rather than failing
+        //  the paint.
+        //
+
+        DataValid = YoriWinHexEditReadDataInternal(HexEdit, Offset, SourceBuffer, LineLength);
+        if (!DataValid) {
+            ZeroMemory(SourceBuffer, LineLength);
+        }
+
         String.LengthInChars = 0;
 
         //
@@ -1526,7 +2185,7 @@ YoriWinHexEditPaintSingleLine(
             LongOffset = LongOffset + HexEdit->VisualBufferOffset;
             String.LengthInChars = YoriLibSPrintfS(String.StartOfString, String.LengthAllocated, _T("%08x`%08x: "), (DWORD)(LongOffset >> 32), (DWORD)LongOffset);
         } else if (HexEdit->OffsetWidth == 32) {
-            String.LengthInChars = YoriLibSPrintfS(String.StartOfString, String.LengthAllocated, _T("%08x: "), Offset + (DWORD)HexEdit->VisualBufferOffset);
+            String.LengthInChars = YoriLibSPrintfS(String.StartOfString, String.LengthAllocated, _T("%08x: "), (DWORD)(Offset + HexEdit->VisualBufferOffset));
         }
 
         for (ColumnIndex = 0; ColumnIndex < String.LengthInChars; ColumnIndex++) {
@@ -1535,6 +2194,7 @@ YoriWinHexEditPaintSingleLine(
 
         }
         CharInfoBufferPopulated = CharInfoBufferPopulated + String.LengthInChars;
+        DataCellsStart = CharInfoBufferPopulated;
 
         //
         //  Depending on the requested display format, generate the data.
@@ -1546,6 +2206,7 @@ YoriWinHexEditPaintSingleLine(
                                        &CharInfoBuffer[CharInfoBufferPopulated],
                                        CharInfoBufferAllocated - CharInfoBufferPopulated,
                                        Offset,
+                                       SourceBuffer,
                                        LineLength);
         } else if (HexEdit->BytesPerWord == 2) {
             CharInfoBufferPopulated = CharInfoBufferPopulated +
@@ -1553,6 +2214,7 @@ YoriWinHexEditPaintSingleLine(
                                        &CharInfoBuffer[CharInfoBufferPopulated],
                                        CharInfoBufferAllocated - CharInfoBufferPopulated,
                                        Offset,
+                                       SourceBuffer,
                                        LineLength);
         } else if (HexEdit->BytesPerWord == 4) {
             CharInfoBufferPopulated = CharInfoBufferPopulated +
@@ -1560,6 +2222,7 @@ YoriWinHexEditPaintSingleLine(
                                         &CharInfoBuffer[CharInfoBufferPopulated],
                                         CharInfoBufferAllocated - CharInfoBufferPopulated,
                                         Offset,
+                                        SourceBuffer,
                                         LineLength);
         } else if (HexEdit->BytesPerWord == 8) {
             CharInfoBufferPopulated = CharInfoBufferPopulated +
@@ -1567,9 +2230,20 @@ YoriWinHexEditPaintSingleLine(
                                             &CharInfoBuffer[CharInfoBufferPopulated],
                                             CharInfoBufferAllocated - CharInfoBufferPopulated,
                                             Offset,
+                                            SourceBuffer,
                                             LineLength);
         }
 
+        if (!DataValid) {
+            for (WordIndex = DataCellsStart; WordIndex < CharInfoBufferPopulated; WordIndex++) {
+                if (CharInfoBuffer[WordIndex].Char.UnicodeChar != ' ' &&
+                    CharInfoBuffer[WordIndex].Char.UnicodeChar != '`') {
+
+                    CharInfoBuffer[WordIndex].Char.UnicodeChar = '?';
+                }
+            }
+        }
+
         //
         //  Generate character output.
         //
@@ -1594,7 +2268,9 @@ YoriWinHexEditPaintSingleLine(
             for (WordIndex = 0;
                  WordIndex < HexEdit->BytesPerLine && CharInfoBufferPopulated < CharInfoBufferAllocated;
                  WordIndex++, CharInfoBufferPopulated++) {
-                if (WordIndex < LineLength) {
+                if (WordIndex < LineLength && !DataValid) {
+                    CharToDisplay = '?';
+                } else if (WordIndex < LineLength) {
                     CharToDisplay = SourceBuffer[WordIndex];
                     if (!YoriLibIsCharPrintable(CharToDisplay)) {
                         CharToDisplay = '.';
@@ -1647,7 +2323,7 @@ YoriWinHexEditPaint(
     )
 {
     WORD RowIndex;
-    YORI_ALLOC_SIZE_T LineIndex;
+    YORI_MAX_UNSIGNED_T LineIndex;
     COORD ClientSize;
 
     YoriWinGetControlClientSize(&HexEdit->Ctrl, &ClientSize);
@@ -1670,7 +2346,7 @@ YoriWinHexEditPaint(
             }
         }
 
-        HexEdit->FirstDirtyLine = (YORI_ALLOC_SIZE_T)-1;
+        HexEdit->FirstDirtyLine = (YORI_MAX_UNSIGNED_T)-1;
         HexEdit->LastDirtyLine = 0;
     }
 
@@ -1754,8 +2430,8 @@ YoriWinHexEditPaint(
 VOID
 YoriWinHexEditExpandDirtyRange(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T NewFirstDirtyLine,
-    __in YORI_ALLOC_SIZE_T NewLastDirtyLine
+    __in YORI_MAX_UNSIGNED_T NewFirstDirtyLine,
+    __in YORI_MAX_UNSIGNED_T NewLastDirtyLine
     )
 {
     if (NewFirstDirtyLine < HexEdit->FirstDirtyLine) {
@@ -1781,14 +2457,14 @@ VOID
 YoriWinHexEditSetCursorLocationInternal(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __in YORI_ALLOC_SIZE_T NewCursorOffset,
-    __in YORI_ALLOC_SIZE_T NewCursorLine
+    __in YORI_MAX_UNSIGNED_T NewCursorLine
     )
 {
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
 
     if (NewCursorOffset == HexEdit->CursorOffset &&
         NewCursorLine == HexEdit->CursorLine) {
@@ -1829,7 +2505,7 @@ YoriWinHexEditEnsureCursorVisible(
 {
     COORD ClientSize;
     YORI_ALLOC_SIZE_T NewViewportLeft;
-    YORI_ALLOC_SIZE_T NewViewportTop;
+    YORI_MAX_UNSIGNED_T NewViewportTop;
 
     NewViewportLeft = HexEdit->ViewportLeft;
     NewViewportTop = HexEdit->ViewportTop;
@@ -1850,13 +2526,13 @@ YoriWinHexEditEnsureCursorVisible(
 
     if (NewViewportTop != HexEdit->ViewportTop) {
         HexEdit->ViewportTop = NewViewportTop;
-        YoriWinHexEditExpandDirtyRange(HexEdit, NewViewportTop, (YORI_ALLOC_SIZE_T)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, NewViewportTop, (YORI_MAX_UNSIGNED_T)-1);
         YoriWinHexEditRepaintScrollBar(HexEdit);
     }
 
     if (NewViewportLeft != HexEdit->ViewportLeft) {
         HexEdit->ViewportLeft = NewViewportLeft;
-        YoriWinHexEditExpandDirtyRange(HexEdit, NewViewportTop, (YORI_ALLOC_SIZE_T)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, NewViewportTop, (YORI_MAX_UNSIGNED_T)-1);
     }
 }
 
@@ -1881,11 +2557,11 @@ BOOLEAN
 YoriWinHexEditSetCursorToBufferLocation(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
     __in YORI_WIN_HEX_EDIT_CELL_TYPE CellType,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
     __in UCHAR BitShift
     )
 {
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorOffset;
 
     ASSERT (CellType == YoriWinHexEditCellTypeHexDigit || CellType == YoriWinHexEditCellTypeCharValue);
@@ -1976,6 +2652,26 @@ YoriWinHexEditInputCharToByte(
     return (UCHAR)Char;
 }
 
+/**
+ Release the data in the control, which may be a referenced allocation or
+ paged from a file or device.
+
+ @param HexEdit Pointer to the hex edit control.
+ */
+VOID
+YoriWinHexEditFreeBuffer(
+    __in PYORI_WIN_CTRL_HEX_EDIT HexEdit
+    )
+{
+    if (HexEdit->BackingHandle != NULL) {
+        YoriWinHexEditReleaseBacking(HexEdit);
+    }
+    if (HexEdit->Buffer != NULL) {
+        YoriLibDereference(HexEdit->Buffer);
+        HexEdit->Buffer = NULL;
+    }
+}
+
 /**
  Delete a single cell.
 
@@ -2000,19 +2696,19 @@ __success(return)
 BOOLEAN
 YoriWinHexEditDeleteCell(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T FirstLine,
+    __in YORI_MAX_UNSIGNED_T FirstLine,
     __in YORI_ALLOC_SIZE_T FirstCharOffset,
-    __out PYORI_ALLOC_SIZE_T LastLine,
+    __out PYORI_MAX_UNSIGNED_T LastLine,
     __out PYORI_ALLOC_SIZE_T LastCharOffset
     )
 {
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     UCHAR BitShift;
-    YORI_ALLOC_SIZE_T CurrentLine;
+    YORI_MAX_UNSIGNED_T CurrentLine;
     YORI_ALLOC_SIZE_T CurrentCharOffset;
-    YORI_ALLOC_SIZE_T DirtyLastLine;
+    YORI_MAX_UNSIGNED_T DirtyLastLine;
     UCHAR BitMask;
     UCHAR InputChar;
     PUCHAR Cell;
@@ -2040,8 +2736,6 @@ YoriWinHexEditDeleteCell(
     //  are assuming operation on nibbles in a word
     //
 
-    Cell = YoriLibAddToPointer(HexEdit->Buffer, BufferOffset);
-
     switch(CellType) {
         case YoriWinHexEditCellTypeOffset:
             break;
@@ -2051,8 +2745,19 @@ YoriWinHexEditDeleteCell(
             break;
         case YoriWinHexEditCellTypeHexDigit:
             if (BitShift == 0) {
+
+                //
+                //  Removing a word moves all following data, which can only
+                //  happen once the data is held in memory.
+                //
+
+                if (!YoriWinHexEditConvertToMemory(HexEdit)) {
+                    break;
+                }
+
+                Cell = YoriLibAddToPointer(HexEdit->Buffer, (YORI_ALLOC_SIZE_T)BufferOffset);
                 if (BufferOffset < HexEdit->BufferValid) {
-                    BytesToCopy = HexEdit->BufferValid - BufferOffset;
+                    BytesToCopy = (YORI_ALLOC_SIZE_T)(HexEdit->BufferValid - BufferOffset);
                     if (BytesToCopy > HexEdit->BytesPerWord) {
                         BytesToCopy = BytesToCopy - HexEdit->BytesPerWord;
                         memmove(Cell,
@@ -2071,21 +2776,29 @@ YoriWinHexEditDeleteCell(
 
                 BitShift = (UCHAR)(HexEdit->BytesPerWord * 8 - 4);
                 YoriWinHexEditCellFromHexBufferOffset(HexEdit, BufferOffset, BitShift, &CurrentLine, &CurrentCharOffset);
-                DirtyLastLine = (YORI_ALLOC_SIZE_T)-1;
+                DirtyLastLine = (YORI_MAX_UNSIGNED_T)-1;
             } else {
                 BitMask = (UCHAR)(0xF << BitShift);
 
-                InputChar = *Cell;
+                if (!YoriWinHexEditReadDataInternal(HexEdit, BufferOffset, &InputChar, 1)) {
+                    break;
+                }
                 InputChar = (UCHAR)(InputChar & ~(BitMask));
-                *Cell = InputChar;
+                if (!YoriWinHexEditWriteDataInternal(HexEdit, BufferOffset, &InputChar, 1)) {
+                    break;
+                }
 
                 YoriWinHexEditNextCellSameType(HexEdit, CellType, BufferOffset, BitShift, &CurrentLine, &CurrentCharOffset);
             }
             HexEdit->UserModified = TRUE;
             break;
         case YoriWinHexEditCellTypeCharValue:
+            if (!YoriWinHexEditConvertToMemory(HexEdit)) {
+                break;
+            }
             if (BufferOffset < HexEdit->BufferValid) {
-                BytesToCopy = HexEdit->BufferValid - BufferOffset;
+                Cell = YoriLibAddToPointer(HexEdit->Buffer, (YORI_ALLOC_SIZE_T)BufferOffset);
+                BytesToCopy = (YORI_ALLOC_SIZE_T)(HexEdit->BufferValid - BufferOffset);
                 if (BytesToCopy > 1) {
                     BytesToCopy = BytesToCopy - 1;
                     memmove(Cell,
@@ -2093,7 +2806,7 @@ YoriWinHexEditDeleteCell(
                             (DWORD)BytesToCopy);
                 }
                 HexEdit->BufferValid = HexEdit->BufferValid - 1;
-                DirtyLastLine = (YORI_ALLOC_SIZE_T)-1;
+                DirtyLastLine = (YORI_MAX_UNSIGNED_T)-1;
                 HexEdit->UserModified = TRUE;
             }
             break;
@@ -2125,6 +2838,15 @@ YoriWinHexEditEnsureBufferLength(
     YORI_MAX_UNSIGNED_T PaddedBufferLength;
     PUCHAR NewBuffer;
 
+    //
+    //  Paged data can be overwritten but not grown, so bring it into memory
+    //  first.
+    //
+
+    if (!YoriWinHexEditConvertToMemory(HexEdit)) {
+        return FALSE;
+    }
+
     if (HexEdit->BufferAllocated >= NewBufferLength) {
         return TRUE;
     }
@@ -2180,7 +2902,7 @@ YoriWinHexEditEnsureBufferLength(
 BOOLEAN
 YoriWinHexEditEnsureBufferValid(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T NewBufferLength
+    __in YORI_MAX_UNSIGNED_T NewBufferLength
     )
 {
     ASSERT(NewBufferLength > HexEdit->BufferValid);
@@ -2190,7 +2912,7 @@ YoriWinHexEditEnsureBufferValid(
     if (!YoriWinHexEditEnsureBufferLength(HexEdit, NewBufferLength)) {
         return FALSE;
     }
-    ZeroMemory(YoriLibAddToPointer(HexEdit->Buffer, HexEdit->BufferValid), (DWORD)(NewBufferLength - HexEdit->BufferValid));
+    ZeroMemory(YoriLibAddToPointer(HexEdit->Buffer, (YORI_ALLOC_SIZE_T)HexEdit->BufferValid), (DWORD)(NewBufferLength - HexEdit->BufferValid));
     HexEdit->BufferValid = NewBufferLength;
     return TRUE;
 }
@@ -2210,11 +2932,12 @@ YoriWinHexEditEnsureBufferValid(
 BOOLEAN
 YoriWinHexEditInsertSpaceInBuffer(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
     __in YORI_ALLOC_SIZE_T BytesToInsert
     )
 {
     YORI_MAX_UNSIGNED_T BytesToMove;
+    YORI_ALLOC_SIZE_T Offset;
 
     ASSERT(BufferOffset <= HexEdit->BufferValid);
     if (BufferOffset > HexEdit->BufferValid) {
@@ -2229,11 +2952,12 @@ YoriWinHexEditInsertSpaceInBuffer(
     if (BytesToMove > (DWORD)-1) {
         return FALSE;
     }
+    Offset = (YORI_ALLOC_SIZE_T)BufferOffset;
     if (BytesToMove > 0) {
-        memmove(&HexEdit->Buffer[BufferOffset + BytesToInsert], &HexEdit->Buffer[BufferOffset], (DWORD)BytesToMove);
+        memmove(&HexEdit->Buffer[Offset + BytesToInsert], &HexEdit->Buffer[Offset], (DWORD)BytesToMove);
     }
 
-    ZeroMemory(&HexEdit->Buffer[BufferOffset], BytesToInsert);
+    ZeroMemory(&HexEdit->Buffer[Offset], BytesToInsert);
     HexEdit->BufferValid = HexEdit->BufferValid + BytesToInsert;
     ASSERT(HexEdit->BufferValid <= HexEdit->BufferAllocated);
 
@@ -2267,27 +2991,26 @@ __success(return)
 BOOLEAN
 YoriWinHexEditInsertCell(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T FirstLine,
+    __in YORI_MAX_UNSIGNED_T FirstLine,
     __in YORI_ALLOC_SIZE_T FirstCharOffset,
     __in TCHAR Char,
-    __out PYORI_ALLOC_SIZE_T LastLine,
+    __out PYORI_MAX_UNSIGNED_T LastLine,
     __out PYORI_ALLOC_SIZE_T LastCharOffset
     )
 {
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     UCHAR BitShift;
-    YORI_ALLOC_SIZE_T CurrentLine;
+    YORI_MAX_UNSIGNED_T CurrentLine;
     YORI_ALLOC_SIZE_T CurrentCharOffset;
-    YORI_ALLOC_SIZE_T DirtyLastLine;
+    YORI_MAX_UNSIGNED_T DirtyLastLine;
     UCHAR BitMask;
     UCHAR NewNibble;
     UCHAR InputChar;
-    PUCHAR Cell;
     BOOLEAN CellUpdated;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T EditBufferOffset;
+    YORI_MAX_UNSIGNED_T EditBufferOffset;
     YORI_ALLOC_SIZE_T EditBitShift;
 
     CurrentLine = FirstLine;
@@ -2305,7 +3028,7 @@ YoriWinHexEditInsertCell(
             *LastCharOffset = CurrentCharOffset;
             return TRUE;
         }
-        DirtyLastLine = (DWORD)-1;
+        DirtyLastLine = (YORI_MAX_UNSIGNED_T)-1;
     }
 
     //
@@ -2319,7 +3042,6 @@ YoriWinHexEditInsertCell(
         EditBitShift = EditBitShift % 8;
     }
 
-    Cell = YoriLibAddToPointer(HexEdit->Buffer, EditBufferOffset);
     CellUpdated = FALSE;
 
     InputChar = YoriWinHexEditInputCharToByte(Char);
@@ -2345,15 +3067,18 @@ YoriWinHexEditInsertCell(
                 if (!YoriWinHexEditInsertSpaceInBuffer(HexEdit, BufferOffset, HexEdit->BytesPerWord)) {
                     break;
                 }
-                DirtyLastLine = (DWORD)-1;
-                Cell = YoriLibAddToPointer(HexEdit->Buffer, EditBufferOffset);
+                DirtyLastLine = (YORI_MAX_UNSIGNED_T)-1;
             }
 
             BitMask = (UCHAR)(0xF << EditBitShift);
-            InputChar = *Cell;
+            if (!YoriWinHexEditReadDataInternal(HexEdit, EditBufferOffset, &InputChar, 1)) {
+                break;
+            }
             InputChar = (UCHAR)(InputChar & ~(BitMask));
             InputChar = (UCHAR)(InputChar | (NewNibble << EditBitShift));
-            *Cell = InputChar;
+            if (!YoriWinHexEditWriteDataInternal(HexEdit, EditBufferOffset, &InputChar, 1)) {
+                break;
+            }
             CellUpdated = TRUE;
 
             break;
@@ -2361,9 +3086,10 @@ YoriWinHexEditInsertCell(
             if (!YoriWinHexEditInsertSpaceInBuffer(HexEdit, EditBufferOffset, 1)) {
                 break;
             }
-            DirtyLastLine = (DWORD)-1;
-            Cell = YoriLibAddToPointer(HexEdit->Buffer, EditBufferOffset);
-            *Cell = InputChar;
+            DirtyLastLine = (YORI_MAX_UNSIGNED_T)-1;
+            if (!YoriWinHexEditWriteDataInternal(HexEdit, EditBufferOffset, &InputChar, 1)) {
+                break;
+            }
             CellUpdated = TRUE;
             break;
     }
@@ -2407,26 +3133,25 @@ __success(return)
 BOOLEAN
 YoriWinHexEditOverwriteCell(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit,
-    __in YORI_ALLOC_SIZE_T FirstLine,
+    __in YORI_MAX_UNSIGNED_T FirstLine,
     __in YORI_ALLOC_SIZE_T FirstCharOffset,
     __in TCHAR Char,
-    __out PYORI_ALLOC_SIZE_T LastLine,
+    __out PYORI_MAX_UNSIGNED_T LastLine,
     __out PYORI_ALLOC_SIZE_T LastCharOffset
     )
 {
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     UCHAR BitShift;
-    YORI_ALLOC_SIZE_T CurrentLine;
+    YORI_MAX_UNSIGNED_T CurrentLine;
     YORI_ALLOC_SIZE_T CurrentCharOffset;
     UCHAR BitMask;
     UCHAR NewNibble;
     UCHAR InputChar;
-    PUCHAR Cell;
     BOOLEAN CellUpdated;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T EditBufferOffset;
+    YORI_MAX_UNSIGNED_T EditBufferOffset;
     UCHAR EditBitShift;
 
     CurrentLine = FirstLine;
@@ -2476,11 +3201,14 @@ YoriWinHexEditOverwriteCell(
                 }
             }
 
-            Cell = YoriLibAddToPointer(HexEdit->Buffer, EditBufferOffset);
-            InputChar = *Cell;
+            if (!YoriWinHexEditReadDataInternal(HexEdit, EditBufferOffset, &InputChar, 1)) {
+                break;
+            }
             InputChar = (UCHAR)(InputChar & ~(BitMask));
             InputChar = (UCHAR)(InputChar | (NewNibble << EditBitShift));
-            *Cell = InputChar;
+            if (!YoriWinHexEditWriteDataInternal(HexEdit, EditBufferOffset, &InputChar, 1)) {
+                break;
+            }
             CellUpdated = TRUE;
 
             break;
@@ -2492,8 +3220,9 @@ YoriWinHexEditOverwriteCell(
                     return TRUE;
                 }
             }
-            Cell = YoriLibAddToPointer(HexEdit->Buffer, EditBufferOffset);
-            *Cell = InputChar;
+            if (!YoriWinHexEditWriteDataInternal(HexEdit, EditBufferOffset, &InputChar, 1)) {
+                break;
+            }
             CellUpdated = TRUE;
             break;
     }
@@ -2542,9 +3271,7 @@ YoriWinHexEditSetDataNoCopy(
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
 
-    if (HexEdit->Buffer != NULL) {
-        YoriLibDereference(HexEdit->Buffer);
-    }
+    YoriWinHexEditFreeBuffer(HexEdit);
 
     YoriLibReference(NewBuffer);
     HexEdit->Buffer = NewBuffer;
@@ -2557,7 +3284,7 @@ YoriWinHexEditSetDataNoCopy(
     //  lines need to be redisplayed.
     //
 
-    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (YORI_ALLOC_SIZE_T)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (YORI_MAX_UNSIGNED_T)-1);
     YoriWinHexEditPaint(HexEdit);
 
     return TRUE;
@@ -2593,12 +3320,318 @@ YoriWinHexEditGetDataNoCopy(
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
 
+    //
+    //  Paged data can't be referenced, so return a copy of it if it fits
+    //  in memory.
+    //
+
+    if (HexEdit->BackingHandle != NULL) {
+        PUCHAR NewBuffer;
+        YORI_ALLOC_SIZE_T Length;
+
+        if (!YoriLibIsSizeAllocatable(HexEdit->BufferValid)) {
+            return FALSE;
+        }
+
+        Length = (YORI_ALLOC_SIZE_T)HexEdit->BufferValid;
+        NewBuffer = YoriLibReferencedMalloc(Length);
+        if (NewBuffer == NULL) {
+            return FALSE;
+        }
+        if (!YoriWinHexEditReadDataInternal(HexEdit, 0, NewBuffer, Length)) {
+            YoriLibDereference(NewBuffer);
+            return FALSE;
+        }
+        *Buffer = NewBuffer;
+        *BufferLength = Length;
+        return TRUE;
+    }
+
     if (HexEdit->Buffer) {
         YoriLibReference(HexEdit->Buffer);
     }
     *Buffer = HexEdit->Buffer;
-    *BufferLength = HexEdit->BufferValid;
+    *BufferLength = (YORI_ALLOC_SIZE_T)HexEdit->BufferValid;
+
+    return TRUE;
+}
+
+/**
+ Return the number of bytes of data in the control.
+
+ @param CtrlHandle Pointer to the hex edit control.
+
+ @return The number of bytes of data in the control.
+ */
+YORI_MAX_UNSIGNED_T
+YoriWinHexEditGetDataLength(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle
+    )
+{
+    PYORI_WIN_CTRL_HEX_EDIT HexEdit;
+    PYORI_WIN_CTRL Ctrl;
+
+    Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
+    HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
+
+    return HexEdit->BufferValid;
+}
+
+/**
+ Copy a range of data from the control into a caller supplied buffer.  This
+ works whether the data is held in memory or paged from a file or device,
+ so callers that process large data should read it in chunks rather than
+ requesting a single buffer.
+
+ @param CtrlHandle Pointer to the hex edit control.
+
+ @param Offset The offset within the data to read from.
+
+ @param Buffer Pointer to a buffer to populate with data.
+
+ @param Length The number of bytes to read.  The range must be within the
+        data in the control.
+
+ @return TRUE to indicate success, FALSE to indicate failure.  Failure can
+         indicate the backing file or device could not be read.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditReadData(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __out_bcount(Length) PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    )
+{
+    PYORI_WIN_CTRL_HEX_EDIT HexEdit;
+    PYORI_WIN_CTRL Ctrl;
+
+    Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
+    HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
+
+    return YoriWinHexEditReadDataInternal(HexEdit, Offset, Buffer, Length);
+}
+
+/**
+ Display the contents of a file or device in a hex edit control without
+ reading it into memory.  Data is paged in as it is displayed or searched,
+ and modified pages are held in memory until they are written back with
+ @ref YoriWinHexEditWriteModifiedPages .  Changes that alter the length of
+ the data require all of it to be read into memory, which fails if the data
+ is too large.
+
+ @param CtrlHandle Pointer to the hex edit control.
+
+ @param FileHandle Handle to the file or device, opened for read access, and
+        for write access if modified pages will be written back.  The
+        control duplicates this handle, so the caller may close it.
+
+ @param FileOffset The offset within the file or device of the first byte to
+        display.
+
+ @param Length The number of bytes to display.
+
+ @param AllowShortData If TRUE, tolerate the file or device containing less
+        data than Length, which happens when a device reports a length
+        larger than can be read, and display the data that can be read.  If
+        FALSE, fail if Length bytes cannot be read.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditSetDataFromFile(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
+    __in HANDLE FileHandle,
+    __in DWORDLONG FileOffset,
+    __in DWORDLONG Length,
+    __in BOOLEAN AllowShortData
+    )
+{
+    PYORI_WIN_CTRL_HEX_EDIT HexEdit;
+    PYORI_WIN_CTRL Ctrl;
+    HANDLE ProcessHandle;
+    HANDLE BackingHandle;
+    HANDLE BackingSection;
+    PUCHAR Window;
+
+    Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
+    HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
+
+    if (Length == 0 || FileOffset + Length < FileOffset) {
+        return FALSE;
+    }
+
+    ProcessHandle = GetCurrentProcess();
+    if (!DuplicateHandle(ProcessHandle, FileHandle, ProcessHandle, &BackingHandle, 0, FALSE, DUPLICATE_SAME_ACCESS)) {
+        return FALSE;
+    }
+
+    //
+    //  Files are paged through views of a read only section.  Devices can't
+    //  be mapped, so they are paged by reading into a window buffer, which
+    //  is allocated from VirtualAlloc to satisfy the alignment requirements
+    //  of unbuffered I/O.
+    //
+
+    Window = NULL;
+    BackingSection = CreateFileMapping(BackingHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (BackingSection == NULL) {
+        Window = VirtualAlloc(NULL, YORI_WIN_HEX_EDIT_WINDOW_SIZE, MEM_COMMIT, PAGE_READWRITE);
+        if (Window == NULL) {
+            CloseHandle(BackingHandle);
+            return FALSE;
+        }
+    }
+
+    YoriWinHexEditFreeBuffer(HexEdit);
+
+    HexEdit->BufferAllocated = 0;
+    HexEdit->BufferValid = Length;
+    HexEdit->BackingHandle = BackingHandle;
+    HexEdit->BackingSection = BackingSection;
+    HexEdit->BackingOffset = FileOffset;
+    HexEdit->Window = Window;
+    HexEdit->WindowOffset = 0;
+    HexEdit->WindowLength = 0;
+
+    //
+    //  Read the final window now, so a range extending beyond the data that
+    //  can be read is found when it is opened rather than when it is
+    //  displayed or saved.
+    //
+
+    if (!YoriWinHexEditMoveWindow(HexEdit, FileOffset + Length - 1)) {
+        if (HexEdit->WindowLength == 0 ||
+            HexEdit->WindowOffset + HexEdit->WindowLength <= FileOffset) {
+
+            YoriWinHexEditReleaseBacking(HexEdit);
+            return FALSE;
+        }
+
+        if (!AllowShortData) {
+            YoriWinHexEditReleaseBacking(HexEdit);
+            SetLastError(ERROR_INVALID_DATA);
+            return FALSE;
+        }
+
+        HexEdit->BufferValid = HexEdit->WindowOffset + HexEdit->WindowLength - FileOffset;
+    }
+
+    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (YORI_MAX_UNSIGNED_T)-1);
+    YoriWinHexEditPaint(HexEdit);
+
+    return TRUE;
+}
+
+/**
+ Indicate whether the control is paging its data from a file or device.  If
+ so, modifications can be saved with
+ @ref YoriWinHexEditWriteModifiedPages .  A control stops paging data if the
+ length of the data changes, since that requires it to be held in memory.
+
+ @param CtrlHandle Pointer to the hex edit control.
+
+ @return TRUE if the data is paged from a file or device, FALSE if it is held
+         in memory.
+ */
+BOOLEAN
+YoriWinHexEditIsDataPaged(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle
+    )
+{
+    PYORI_WIN_CTRL_HEX_EDIT HexEdit;
+    PYORI_WIN_CTRL Ctrl;
+
+    Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
+    HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
+
+    if (HexEdit->BackingHandle != NULL) {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ Write any modified pages back to the file or device that the control is
+ paging data from, and discard them.  Each page is written in full, aligned
+ to its offset within the file or device, which satisfies the alignment
+ requirements of devices.
+
+ @param CtrlHandle Pointer to the hex edit control.
+
+ @return TRUE to indicate success, FALSE to indicate failure.  On failure,
+         extended error information is available from GetLastError, and all
+         modified pages are retained so the operation can be retried.
+ */
+__success(return)
+BOOLEAN
+YoriWinHexEditWriteModifiedPages(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle
+    )
+{
+    PYORI_WIN_CTRL_HEX_EDIT HexEdit;
+    PYORI_WIN_CTRL Ctrl;
+    PYORI_WIN_HEX_EDIT_PAGE Page;
+    YORI_MAX_UNSIGNED_T BackingEnd;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Length;
+    LARGE_INTEGER FileOffset;
+    DWORD BytesWritten;
+    PUCHAR Source;
+
+    Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
+    HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
+
+    if (HexEdit->BackingHandle == NULL) {
+        SetLastError(ERROR_INVALID_FUNCTION);
+        return FALSE;
+    }
+
+    BackingEnd = HexEdit->BackingOffset + HexEdit->BufferValid;
+    for (Index = 0; Index < HexEdit->ModifiedPageCount; Index++) {
+        Page = HexEdit->ModifiedPages[Index];
+        Length = YORI_WIN_HEX_EDIT_PAGE_SIZE;
+        if (BackingEnd - Page->Offset < Length) {
+            Length = (YORI_ALLOC_SIZE_T)(BackingEnd - Page->Offset);
+        }
+
+        //
+        //  Unbuffered writes to devices need an aligned buffer, so stage the
+        //  page through the window buffer.  The window no longer describes
+        //  backing data after this.
+        //
+
+        Source = Page->Data;
+        if (HexEdit->BackingSection == NULL) {
+            memcpy(HexEdit->Window, Page->Data, Length);
+            HexEdit->WindowLength = 0;
+            Source = HexEdit->Window;
+        }
+
+        FileOffset.QuadPart = Page->Offset;
+        FileOffset.LowPart = SetFilePointer(HexEdit->BackingHandle, FileOffset.LowPart, &FileOffset.HighPart, FILE_BEGIN);
+        if (FileOffset.LowPart == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR) {
+            return FALSE;
+        }
+
+        if (!WriteFile(HexEdit->BackingHandle, Source, Length, &BytesWritten, NULL)) {
+            return FALSE;
+        }
+
+        if (BytesWritten != Length) {
+            SetLastError(ERROR_WRITE_FAULT);
+            return FALSE;
+        }
+    }
+
+    if (!FlushFileBuffers(HexEdit->BackingHandle)) {
+        return FALSE;
+    }
 
+    YoriWinHexEditFreeModifiedPages(HexEdit);
     return TRUE;
 }
 
@@ -2618,16 +3651,16 @@ YoriWinHexEditClearSelectionInternal(
     __in PYORI_WIN_CTRL_HEX_EDIT HexEdit
     )
 {
-    YORI_ALLOC_SIZE_T FirstDirtyLine;
-    YORI_ALLOC_SIZE_T LastDirtyLine;
+    YORI_MAX_UNSIGNED_T FirstDirtyLine;
+    YORI_MAX_UNSIGNED_T LastDirtyLine;
 
     if (HexEdit->Selection.Active == YoriWinHexEditSelectNotActive) {
         return;
     }
 
-    FirstDirtyLine = (YORI_ALLOC_SIZE_T)(HexEdit->Selection.FirstByteOffset / HexEdit->BytesPerLine);
+    FirstDirtyLine = HexEdit->Selection.FirstByteOffset / HexEdit->BytesPerLine;
     if (HexEdit->Selection.BeyondLastByteOffset > 0) {
-        LastDirtyLine = (YORI_ALLOC_SIZE_T)((HexEdit->Selection.BeyondLastByteOffset - 1) / HexEdit->BytesPerLine);
+        LastDirtyLine = (HexEdit->Selection.BeyondLastByteOffset - 1) / HexEdit->BytesPerLine;
     } else {
         LastDirtyLine = 0;
     }
@@ -2716,8 +3749,8 @@ YoriWinHexEditStartSelectionAtCursor(
     //
 
     if (Selection->Active == YoriWinHexEditSelectNotActive) {
-        YORI_ALLOC_SIZE_T FirstDirtyLine;
-        YORI_ALLOC_SIZE_T EffectiveCursorOffset;
+        YORI_MAX_UNSIGNED_T FirstDirtyLine;
+        YORI_MAX_UNSIGNED_T EffectiveCursorOffset;
         BOOLEAN AsChar;
         UCHAR BitShift;
 
@@ -2740,7 +3773,7 @@ YoriWinHexEditStartSelectionAtCursor(
         Selection->BeyondLastByteOffset = EffectiveCursorOffset;
 
 
-        FirstDirtyLine = (YORI_ALLOC_SIZE_T)(EffectiveCursorOffset / HexEdit->BytesPerLine);
+        FirstDirtyLine = EffectiveCursorOffset / HexEdit->BytesPerLine;
 
         YoriWinHexEditExpandDirtyRange(HexEdit, FirstDirtyLine, FirstDirtyLine);
     }
@@ -2764,15 +3797,15 @@ YoriWinHexEditSetSelectionByte(
     __in YORI_MAX_UNSIGNED_T NewValue
     )
 {
-    YORI_ALLOC_SIZE_T FirstDirtyLine;
-    YORI_ALLOC_SIZE_T LastDirtyLine;
+    YORI_MAX_UNSIGNED_T FirstDirtyLine;
+    YORI_MAX_UNSIGNED_T LastDirtyLine;
 
     if (NewValue < *SelectionByte) {
-        FirstDirtyLine = (YORI_ALLOC_SIZE_T)(NewValue / HexEdit->BytesPerLine);
-        LastDirtyLine = (YORI_ALLOC_SIZE_T)(*SelectionByte / HexEdit->BytesPerLine);
+        FirstDirtyLine = NewValue / HexEdit->BytesPerLine;
+        LastDirtyLine = *SelectionByte / HexEdit->BytesPerLine;
         YoriWinHexEditExpandDirtyRange(HexEdit, FirstDirtyLine, LastDirtyLine);
     } else if (NewValue > *SelectionByte) {
-        FirstDirtyLine = (YORI_ALLOC_SIZE_T)(*SelectionByte / HexEdit->BytesPerLine);
+        FirstDirtyLine = *SelectionByte / HexEdit->BytesPerLine;
 
         //
         //  The selection visually extends into whitespace if there is more
@@ -2784,7 +3817,7 @@ YoriWinHexEditSetSelectionByte(
         if (FirstDirtyLine > 0 && ((*SelectionByte) % HexEdit->BytesPerLine) == 0) {
             FirstDirtyLine--;
         }
-        LastDirtyLine = (YORI_ALLOC_SIZE_T)(NewValue / HexEdit->BytesPerLine);
+        LastDirtyLine = NewValue / HexEdit->BytesPerLine;
         YoriWinHexEditExpandDirtyRange(HexEdit, FirstDirtyLine, LastDirtyLine);
     }
 
@@ -2810,7 +3843,7 @@ YoriWinHexEditExtendSelectionToCursor(
     )
 {
     YORI_MAX_UNSIGNED_T AnchorOffset;
-    YORI_ALLOC_SIZE_T EffectiveCursorOffset;
+    YORI_MAX_UNSIGNED_T EffectiveCursorOffset;
     BOOLEAN AsChar;
     UCHAR BitShift;
     UCHAR BitsPerWord;
@@ -2972,12 +4005,12 @@ YoriWinHexEditScrollForMouseSelect(
 {
     COORD ClientSize;
     YORI_ALLOC_SIZE_T LineCountToDisplay;
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorOffset;
-    YORI_ALLOC_SIZE_T NewViewportTop;
+    YORI_MAX_UNSIGNED_T NewViewportTop;
     YORI_ALLOC_SIZE_T NewViewportLeft;
-    YORI_ALLOC_SIZE_T LinesPopulated;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T LinesPopulated;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
@@ -3132,12 +4165,15 @@ YoriWinHexEditClearSelection(
 }
 
 /**
- Return a pointer to the selected data in the control.  This is not allocated
- or copied, just a direct pointer.
+ Return a copy of the selected data in the control.  The buffer is allocated
+ within this routine and should be freed by the caller with
+ @ref YoriLibDereference.  If no data is selected, or the selection is too
+ large to hold in memory, this routine returns FALSE.
 
  @param CtrlHandle Pointer to the hex edit control.
 
- @param Data On successful completion, updated to point to the selected data.
+ @param Data On successful completion, updated to point to a newly allocated
+        buffer containing the selected data.
 
  @param DataLength On successful completion, updated to point to the length
         of the data.
@@ -3146,7 +4182,7 @@ YoriWinHexEditClearSelection(
  */
 __success(return)
 BOOLEAN
-YoriWinHexEditGetSelectedDataPointer(
+YoriWinHexEditGetSelectedData(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __out PVOID * Data,
     __out PYORI_ALLOC_SIZE_T DataLength
@@ -3175,59 +4211,18 @@ YoriWinHexEditGetSelectedDataPointer(
         return FALSE;
     }
 
-    Buffer = &HexEdit->Buffer[HexEdit->Selection.FirstByteOffset];
-
-    *Data = Buffer;
-    *DataLength = (YORI_ALLOC_SIZE_T)LocalDataLength;
-
-    return TRUE;
-}
-
-/**
- Return a copy of the selected data in the control.  The buffer is allocated
- within this routine and should be freed by the caller with
- @ref YoriLibDereference.  If no data is selected, this routine returns
- FALSE.
-
- @param CtrlHandle Pointer to the hex edit control.
-
- @param Data On successful completion, updated to point to a newly allocated
-        buffer containing the selected data.
-
- @param DataLength On successful completion, updated to point to the length
-        of the data.
-
- @return TRUE to indicate success, FALSE to indicate failure.
- */
-__success(return)
-BOOLEAN
-YoriWinHexEditGetSelectedData(
-    __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __out PVOID * Data,
-    __out PYORI_ALLOC_SIZE_T DataLength
-    )
-{
-    PYORI_WIN_CTRL_HEX_EDIT HexEdit;
-    PYORI_WIN_CTRL Ctrl;
-    YORI_ALLOC_SIZE_T LocalDataLength;
-    PUCHAR BufferPointer;
-    PUCHAR Buffer;
-
-    Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
-    HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
-
-    if (!YoriWinHexEditGetSelectedDataPointer(CtrlHandle, &BufferPointer, &LocalDataLength)) {
+    Buffer = YoriLibReferencedMalloc((YORI_ALLOC_SIZE_T)LocalDataLength);
+    if (Buffer == NULL) {
         return FALSE;
     }
 
-    Buffer = YoriLibReferencedMalloc(LocalDataLength);
-    if (Buffer == NULL) {
+    if (!YoriWinHexEditReadDataInternal(HexEdit, HexEdit->Selection.FirstByteOffset, Buffer, (YORI_ALLOC_SIZE_T)LocalDataLength)) {
+        YoriLibDereference(Buffer);
         return FALSE;
     }
 
-    memcpy(Buffer, BufferPointer, LocalDataLength);
     *Data = Buffer;
-    *DataLength = LocalDataLength;
+    *DataLength = (YORI_ALLOC_SIZE_T)LocalDataLength;
 
     return TRUE;
 }
@@ -3258,7 +4253,7 @@ YoriWinHexEditSetColor(
 
     HexEdit->TextAttributes = Attributes;
     HexEdit->SelectedAttributes = SelectedAttributes;
-    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (DWORD)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (YORI_MAX_UNSIGNED_T)-1);
     YoriWinHexEditPaintNonClient(HexEdit);
     YoriWinHexEditPaint(HexEdit);
 }
@@ -3278,7 +4273,7 @@ VOID
 YoriWinHexEditGetViewportLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __out PYORI_ALLOC_SIZE_T ViewportLeft,
-    __out PYORI_ALLOC_SIZE_T ViewportTop
+    __out PYORI_MAX_UNSIGNED_T ViewportTop
     )
 {
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
@@ -3304,14 +4299,14 @@ VOID
 YoriWinHexEditSetViewportLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __in YORI_ALLOC_SIZE_T NewViewportLeft,
-    __in YORI_ALLOC_SIZE_T NewViewportTop
+    __in YORI_MAX_UNSIGNED_T NewViewportTop
     )
 {
     COORD ClientSize;
     PYORI_WIN_CTRL Ctrl;
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
-    YORI_ALLOC_SIZE_T EffectiveNewViewportTop;
-    YORI_ALLOC_SIZE_T LinesPopulated;
+    YORI_MAX_UNSIGNED_T EffectiveNewViewportTop;
+    YORI_MAX_UNSIGNED_T LinesPopulated;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
@@ -3336,13 +4331,13 @@ YoriWinHexEditSetViewportLocation(
     //
 
     if (EffectiveNewViewportTop != HexEdit->ViewportTop) {
-        YoriWinHexEditExpandDirtyRange(HexEdit, EffectiveNewViewportTop, (YORI_ALLOC_SIZE_T)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, EffectiveNewViewportTop, (YORI_MAX_UNSIGNED_T)-1);
         HexEdit->ViewportTop = EffectiveNewViewportTop;
         YoriWinHexEditRepaintScrollBar(HexEdit);
     }
 
     if (NewViewportLeft != HexEdit->ViewportLeft) {
-        YoriWinHexEditExpandDirtyRange(HexEdit, EffectiveNewViewportTop, (YORI_ALLOC_SIZE_T)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, EffectiveNewViewportTop, (YORI_MAX_UNSIGNED_T)-1);
         HexEdit->ViewportLeft = NewViewportLeft;
     }
     YoriWinHexEditPaint(HexEdit);
@@ -3366,17 +4361,14 @@ YoriWinHexEditClear(
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
 
-    if (HexEdit->Buffer != NULL) {
-        YoriLibDereference(HexEdit->Buffer);
-        HexEdit->Buffer = NULL;
-    }
+    YoriWinHexEditFreeBuffer(HexEdit);
     HexEdit->BufferAllocated = 0;
     HexEdit->BufferValid = 0;
 
     HexEdit->ViewportTop = 0;
     HexEdit->ViewportLeft = 0;
 
-    YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (DWORD)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_MAX_UNSIGNED_T)-1);
     YoriWinHexEditSetCursorLocationToZero(HexEdit);
 
     YoriWinHexEditPaint(HexEdit);
@@ -3555,7 +4547,7 @@ YoriWinHexEditSetBytesPerWord(
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
@@ -3589,7 +4581,7 @@ YoriWinHexEditSetBytesPerWord(
 
     YoriWinHexEditSetCursorToBufferLocation(HexEdit, CellType, BufferOffset, BitShift);
 
-    YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_ALLOC_SIZE_T)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_MAX_UNSIGNED_T)-1);
 
     YoriWinHexEditEnsureCursorVisible(HexEdit);
     YoriWinHexEditPaintNonClient(HexEdit);
@@ -3619,7 +4611,7 @@ YoriWinHexEditSetStyle(
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
@@ -3651,7 +4643,7 @@ YoriWinHexEditSetStyle(
 
     YoriWinHexEditSetCursorToBufferLocation(HexEdit, CellType, BufferOffset, BitShift);
 
-    YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_ALLOC_SIZE_T)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_MAX_UNSIGNED_T)-1);
 
     YoriWinHexEditEnsureCursorVisible(HexEdit);
     YoriWinHexEditPaintNonClient(HexEdit);
@@ -3681,7 +4673,7 @@ BOOLEAN
 YoriWinHexEditGetCursorLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __out PBOOLEAN AsChar,
-    __out PYORI_ALLOC_SIZE_T BufferOffset,
+    __out PYORI_MAX_UNSIGNED_T BufferOffset,
     __out PUCHAR BitShift
     )
 {
@@ -3690,7 +4682,7 @@ YoriWinHexEditGetCursorLocation(
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T LocalBufferOffset;
+    YORI_MAX_UNSIGNED_T LocalBufferOffset;
     UCHAR LocalBitShift;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
@@ -3739,7 +4731,7 @@ BOOLEAN
 YoriWinHexEditGetVisualCursorLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __out PYORI_ALLOC_SIZE_T CursorOffset,
-    __out PYORI_ALLOC_SIZE_T CursorLine
+    __out PYORI_MAX_UNSIGNED_T CursorLine
     )
 {
     PYORI_WIN_CTRL Ctrl;
@@ -3770,13 +4762,14 @@ __success(return)
 BOOLEAN
 YoriWinHexEditDeleteData(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T DataOffset,
+    __in YORI_MAX_UNSIGNED_T DataOffset,
     __in YORI_ALLOC_SIZE_T Length
     )
 {
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
     PYORI_WIN_CTRL Ctrl;
     YORI_ALLOC_SIZE_T LengthToRemove;
+    YORI_ALLOC_SIZE_T Offset;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
@@ -3785,19 +4778,24 @@ YoriWinHexEditDeleteData(
         return FALSE;
     }
 
+    if (!YoriWinHexEditConvertToMemory(HexEdit)) {
+        return FALSE;
+    }
+
+    Offset = (YORI_ALLOC_SIZE_T)DataOffset;
     LengthToRemove = Length;
-    if (DataOffset + LengthToRemove > HexEdit->BufferValid) {
-        LengthToRemove = HexEdit->BufferValid - DataOffset;
+    if (Offset + LengthToRemove > HexEdit->BufferValid) {
+        LengthToRemove = (YORI_ALLOC_SIZE_T)HexEdit->BufferValid - Offset;
     }
 
-    if (HexEdit->BufferValid > DataOffset + LengthToRemove) {
-        memmove(&HexEdit->Buffer[DataOffset],
-                &HexEdit->Buffer[DataOffset + LengthToRemove],
-                (DWORD)(HexEdit->BufferValid - DataOffset - LengthToRemove));
+    if (HexEdit->BufferValid > Offset + LengthToRemove) {
+        memmove(&HexEdit->Buffer[Offset],
+                &HexEdit->Buffer[Offset + LengthToRemove],
+                (DWORD)(HexEdit->BufferValid - Offset - LengthToRemove));
     }
 
     HexEdit->BufferValid = HexEdit->BufferValid - LengthToRemove;
-    YoriWinHexEditExpandDirtyRange(HexEdit, (YORI_ALLOC_SIZE_T)(DataOffset / HexEdit->BytesPerLine), (YORI_ALLOC_SIZE_T)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, DataOffset / HexEdit->BytesPerLine, (YORI_MAX_UNSIGNED_T)-1);
     return TRUE;
 }
 
@@ -3818,7 +4816,7 @@ __success(return)
 BOOLEAN
 YoriWinHexEditInsertData(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T DataOffset,
+    __in YORI_MAX_UNSIGNED_T DataOffset,
     __in PVOID Data,
     __in YORI_ALLOC_SIZE_T Length
     )
@@ -3833,15 +4831,19 @@ YoriWinHexEditInsertData(
         return FALSE;
     }
 
+    if (!YoriWinHexEditConvertToMemory(HexEdit)) {
+        return FALSE;
+    }
+
     if (!YoriWinHexEditInsertSpaceInBuffer(HexEdit, DataOffset, Length)) {
         return FALSE;
     }
 
-    memmove(&HexEdit->Buffer[DataOffset],
+    memmove(&HexEdit->Buffer[(YORI_ALLOC_SIZE_T)DataOffset],
             Data,
             (DWORD)Length);
 
-    YoriWinHexEditExpandDirtyRange(HexEdit, (YORI_ALLOC_SIZE_T)(DataOffset / HexEdit->BytesPerLine), (DWORD)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, DataOffset / HexEdit->BytesPerLine, (YORI_MAX_UNSIGNED_T)-1);
     return TRUE;
 }
 
@@ -3862,33 +4864,36 @@ __success(return)
 BOOLEAN
 YoriWinHexEditReplaceData(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T DataOffset,
+    __in YORI_MAX_UNSIGNED_T DataOffset,
     __in PVOID Data,
     __in YORI_ALLOC_SIZE_T Length
     )
 {
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
     PYORI_WIN_CTRL Ctrl;
-    YORI_ALLOC_SIZE_T FirstDirtyLine;
-    YORI_ALLOC_SIZE_T LastDirtyLine;
+    YORI_MAX_UNSIGNED_T FirstDirtyLine;
+    YORI_MAX_UNSIGNED_T LastDirtyLine;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
 
+    //
+    //  Extending the data requires it to be held in memory.  Replacing
+    //  data within the existing range can be done against paged data.
+    //
+
     if (DataOffset + Length > HexEdit->BufferValid) {
-        if (!YoriWinHexEditEnsureBufferLength(HexEdit, DataOffset + Length)) {
+        if (!YoriWinHexEditEnsureBufferValid(HexEdit, DataOffset + Length)) {
             return FALSE;
         }
-
-        HexEdit->BufferValid = DataOffset + Length;
     }
 
-    memmove(&HexEdit->Buffer[DataOffset],
-            Data,
-            (DWORD)Length);
+    if (!YoriWinHexEditWriteDataInternal(HexEdit, DataOffset, Data, Length)) {
+        return FALSE;
+    }
 
-    FirstDirtyLine = (YORI_ALLOC_SIZE_T)(DataOffset / HexEdit->BytesPerLine);
-    LastDirtyLine = (YORI_ALLOC_SIZE_T)((DataOffset + Length) / HexEdit->BytesPerLine);
+    FirstDirtyLine = DataOffset / HexEdit->BytesPerLine;
+    LastDirtyLine = (DataOffset + Length) / HexEdit->BytesPerLine;
     YoriWinHexEditExpandDirtyRange(HexEdit, FirstDirtyLine, LastDirtyLine);
     return TRUE;
 }
@@ -3931,10 +4936,10 @@ YoriWinHexEditDeleteSelection(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle
     )
 {
-    YORI_ALLOC_SIZE_T CursorOffset;
+    YORI_MAX_UNSIGNED_T CursorOffset;
     BOOLEAN AsChar;
     UCHAR BitShift;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_ALLOC_SIZE_T Length;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
@@ -3949,15 +4954,25 @@ YoriWinHexEditDeleteSelection(
         return FALSE;
     }
 
-    BufferOffset = (YORI_ALLOC_SIZE_T)HexEdit->Selection.FirstByteOffset;
-    Length = (YORI_ALLOC_SIZE_T)HexEdit->Selection.BeyondLastByteOffset - BufferOffset;
+    //
+    //  Removing data moves everything after it, which requires the data to
+    //  be held in memory.  Once it is, the selection length fits in an
+    //  allocation.
+    //
+
+    if (!YoriWinHexEditConvertToMemory(HexEdit)) {
+        return FALSE;
+    }
+
+    BufferOffset = HexEdit->Selection.FirstByteOffset;
+    Length = (YORI_ALLOC_SIZE_T)(HexEdit->Selection.BeyondLastByteOffset - BufferOffset);
 
     if (Length == 0) {
         return FALSE;
     }
 
     YoriWinHexEditGetCursorLocation(&HexEdit->Ctrl, &AsChar, &CursorOffset, &BitShift);
-    CursorOffset = (YORI_ALLOC_SIZE_T)BufferOffset;
+    CursorOffset = BufferOffset;
     if (AsChar) {
         CellType = YoriWinHexEditCellTypeCharValue;
     } else {
@@ -4002,7 +5017,7 @@ YoriWinHexEditSetVisualBufferOffset(
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
     if (VisualBufferOffset != HexEdit->VisualBufferOffset) {
         HexEdit->VisualBufferOffset = VisualBufferOffset;
-        YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_ALLOC_SIZE_T)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_MAX_UNSIGNED_T)-1);
 
         YoriWinHexEditEnsureCursorVisible(HexEdit);
         YoriWinHexEditPaint(HexEdit);
@@ -4032,19 +5047,21 @@ YoriWinHexEditCutSelectedData(
 {
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
     PYORI_WIN_CTRL Ctrl;
-    PUCHAR Buffer;
+    PVOID Buffer;
     YORI_ALLOC_SIZE_T BufferLength;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
 
-    if (!YoriWinHexEditGetSelectedDataPointer(CtrlHandle, &Buffer, &BufferLength)) {
+    if (!YoriWinHexEditGetSelectedData(CtrlHandle, &Buffer, &BufferLength)) {
         return FALSE;
     }
 
     if (!YoriLibCopyBinaryData(Buffer, BufferLength)) {
+        YoriLibDereference(Buffer);
         return FALSE;
     }
+    YoriLibDereference(Buffer);
 
     if (YoriWinHexEditDeleteSelection(&HexEdit->Ctrl)) {
         HexEdit->UserModified = TRUE;
@@ -4068,19 +5085,21 @@ YoriWinHexEditCopySelectedData(
 {
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
     PYORI_WIN_CTRL Ctrl;
-    PUCHAR Buffer;
+    PVOID Buffer;
     YORI_ALLOC_SIZE_T BufferLength;
 
     Ctrl = (PYORI_WIN_CTRL)CtrlHandle;
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
 
-    if (!YoriWinHexEditGetSelectedDataPointer(CtrlHandle, &Buffer, &BufferLength)) {
+    if (!YoriWinHexEditGetSelectedData(CtrlHandle, &Buffer, &BufferLength)) {
         return FALSE;
     }
 
     if (!YoriLibCopyBinaryData(Buffer, BufferLength)) {
+        YoriLibDereference(Buffer);
         return FALSE;
     }
+    YoriLibDereference(Buffer);
 
     YoriWinHexEditClearSelectionInternal(HexEdit);
     YoriWinHexEditEnsureCursorVisible(HexEdit);
@@ -4105,7 +5124,7 @@ YoriWinHexEditPasteData(
     PYORI_WIN_CTRL Ctrl;
     PUCHAR Buffer;
     YORI_ALLOC_SIZE_T BufferLength;
-    YORI_ALLOC_SIZE_T EffectiveCursorOffset;
+    YORI_MAX_UNSIGNED_T EffectiveCursorOffset;
     BOOLEAN AsChar;
     UCHAR BitShift;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
@@ -4181,9 +5200,9 @@ YoriWinHexEditDelete(
             HexEdit->UserModified = TRUE;
         }
     } else {
-        YORI_ALLOC_SIZE_T FirstLine;
+        YORI_MAX_UNSIGNED_T FirstLine;
         YORI_ALLOC_SIZE_T FirstCharOffset;
-        YORI_ALLOC_SIZE_T LastLine;
+        YORI_MAX_UNSIGNED_T LastLine;
         YORI_ALLOC_SIZE_T LastCharOffset;
 
         FirstLine = HexEdit->CursorLine;
@@ -4222,7 +5241,7 @@ YoriWinHexEditPageUp(
 {
     COORD ClientSize;
     YORI_ALLOC_SIZE_T ViewportHeight;
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorOffset;
 
     if (ShiftPressed) {
@@ -4247,7 +5266,7 @@ YoriWinHexEditPageUp(
             HexEdit->ViewportTop = 0;
         }
 
-        YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_ALLOC_SIZE_T)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_MAX_UNSIGNED_T)-1);
 
         NewCursorOffset = HexEdit->CursorOffset;
         YoriWinHexEditSetCursorLocationInternal(HexEdit, NewCursorOffset, NewCursorLine);
@@ -4283,9 +5302,9 @@ YoriWinHexEditPageDown(
 {
     COORD ClientSize;
     YORI_ALLOC_SIZE_T ViewportHeight;
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorOffset;
-    YORI_ALLOC_SIZE_T LinesPopulated;
+    YORI_MAX_UNSIGNED_T LinesPopulated;
 
     if (ShiftPressed) {
         YoriWinHexEditStartSelectionAtCursor(HexEdit, FALSE);
@@ -4299,7 +5318,7 @@ YoriWinHexEditPageDown(
 
     if (HexEdit->ViewportTop + ViewportHeight < LinesPopulated) {
         HexEdit->ViewportTop = HexEdit->ViewportTop + ViewportHeight;
-        YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (DWORD)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, HexEdit->ViewportTop, (YORI_MAX_UNSIGNED_T)-1);
         NewCursorLine = HexEdit->CursorLine;
         if (HexEdit->CursorLine + ViewportHeight < LinesPopulated) {
             NewCursorLine = HexEdit->CursorLine + ViewportHeight;
@@ -4338,8 +5357,8 @@ YoriWinHexEditNotifyMouseWheel(
 {
     COORD ClientSize;
     YORI_ALLOC_SIZE_T LineCountToDisplay;
-    YORI_ALLOC_SIZE_T NewViewportTop;
-    YORI_ALLOC_SIZE_T LinesPopulated;
+    YORI_MAX_UNSIGNED_T NewViewportTop;
+    YORI_MAX_UNSIGNED_T LinesPopulated;
 
     YoriWinGetControlClientSize(&HexEdit->Ctrl, &ClientSize);
     LineCountToDisplay = ClientSize.Y;
@@ -4382,7 +5401,7 @@ YoriWinHexEditAddChar(
     __in TCHAR Char
     )
 {
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorOffset;
 
     if (!HexEdit->InsertMode) {
@@ -4416,12 +5435,12 @@ YoriWinHexEditCursorLeft(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorOffset;
 
     if (ShiftPressed) {
@@ -4466,12 +5485,12 @@ YoriWinHexEditCursorRight(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
     BOOLEAN BeyondBufferEnd;
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorOffset;
 
     if (ShiftPressed) {
@@ -4525,7 +5544,7 @@ YoriWinHexEditCursorHome(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
@@ -4579,7 +5598,7 @@ YoriWinHexEditCursorEnd(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
@@ -4642,7 +5661,7 @@ YoriWinHexEditCursorUp(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
@@ -4698,7 +5717,7 @@ YoriWinHexEditCursorDown(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
@@ -4752,7 +5771,7 @@ YoriWinHexEditCursorCtrlHome(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
@@ -4804,7 +5823,7 @@ YoriWinHexEditCursorCtrlEnd(
     __in BOOLEAN ShiftPressed
     )
 {
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
@@ -4861,9 +5880,9 @@ YoriWinHexEditMouseDown(
     __in DWORD DisplayY
     )
 {
-    YORI_ALLOC_SIZE_T NewCursorLine;
+    YORI_MAX_UNSIGNED_T NewCursorLine;
     YORI_ALLOC_SIZE_T NewCursorChar;
-    YORI_ALLOC_SIZE_T BufferOffset;
+    YORI_MAX_UNSIGNED_T BufferOffset;
     YORI_WIN_HEX_EDIT_CELL_TYPE CellType;
     YORI_ALLOC_SIZE_T ByteOffset;
     UCHAR BitShift;
@@ -5043,10 +6062,7 @@ YoriWinHexEditEventHandler(
     HexEdit = CONTAINING_RECORD(Ctrl, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
     switch(Event->EventType) {
         case YoriWinEventParentDestroyed:
-            if (HexEdit->Buffer != NULL) {
-                YoriLibDereference(HexEdit->Buffer);
-                HexEdit->Buffer = NULL;
-            }
+            YoriWinHexEditFreeBuffer(HexEdit);
             YoriLibFreeStringContents(&HexEdit->Caption);
             YoriWinDestroyControl(Ctrl);
             YoriLibDereference(HexEdit);
@@ -5256,8 +6272,8 @@ YoriWinHexEditNotifyScrollChange(
     COORD ClientSize;
     WORD ElementCountToDisplay;
     PYORI_WIN_CTRL ScrollCtrl;
-    YORI_ALLOC_SIZE_T NewViewportTop;
-    YORI_ALLOC_SIZE_T LinesPopulated;
+    YORI_MAX_UNSIGNED_T NewViewportTop;
+    YORI_MAX_UNSIGNED_T LinesPopulated;
 
     ScrollCtrl = (PYORI_WIN_CTRL)ScrollCtrlHandle;
     HexEdit = CONTAINING_RECORD(ScrollCtrl->Parent, YORI_WIN_CTRL_HEX_EDIT, Ctrl);
@@ -5278,13 +6294,13 @@ YoriWinHexEditNotifyScrollChange(
         }
     } else {
         if (ScrollValue < LinesPopulated) {
-            NewViewportTop = (YORI_ALLOC_SIZE_T)ScrollValue;
+            NewViewportTop = ScrollValue;
         }
     }
 
     if (NewViewportTop != HexEdit->ViewportTop) {
         HexEdit->ViewportTop = NewViewportTop;
-        YoriWinHexEditExpandDirtyRange(HexEdit, NewViewportTop, (YORI_ALLOC_SIZE_T)-1);
+        YoriWinHexEditExpandDirtyRange(HexEdit, NewViewportTop, (YORI_MAX_UNSIGNED_T)-1);
     } else {
         return;
     }
@@ -5335,7 +6351,7 @@ YoriWinHexEditReposition(
         YoriWinScrollBarReposition(HexEdit->VScrollCtrl, &ScrollBarRect);
     }
 
-    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (YORI_ALLOC_SIZE_T)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (YORI_MAX_UNSIGNED_T)-1);
     YoriWinHexEditPaintNonClient(HexEdit);
     YoriWinHexEditPaint(HexEdit);
 
@@ -5390,7 +6406,7 @@ BOOLEAN
 YoriWinHexEditSetCursorLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __in BOOLEAN AsChar,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
     __in UCHAR BitShift
     )
 {
@@ -5429,13 +6445,13 @@ __success(return)
 BOOLEAN
 YoriWinHexEditSetSelectionRange(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T FirstByteOffset,
-    __in YORI_ALLOC_SIZE_T LastByteOffset
+    __in YORI_MAX_UNSIGNED_T FirstByteOffset,
+    __in YORI_MAX_UNSIGNED_T LastByteOffset
     )
 {
     PYORI_WIN_CTRL_HEX_EDIT HexEdit;
-    YORI_ALLOC_SIZE_T FirstDirtyLine;
-    YORI_ALLOC_SIZE_T LastDirtyLine;
+    YORI_MAX_UNSIGNED_T FirstDirtyLine;
+    YORI_MAX_UNSIGNED_T LastDirtyLine;
 
     HexEdit = (PYORI_WIN_CTRL_HEX_EDIT)CtrlHandle;
 
@@ -5457,8 +6473,8 @@ YoriWinHexEditSetSelectionRange(
     HexEdit->Selection.FirstByteOffset = FirstByteOffset;
     HexEdit->Selection.BeyondLastByteOffset = LastByteOffset + 1;
 
-    FirstDirtyLine = (YORI_ALLOC_SIZE_T)(HexEdit->Selection.FirstByteOffset / HexEdit->BytesPerLine);
-    LastDirtyLine = (YORI_ALLOC_SIZE_T)((HexEdit->Selection.BeyondLastByteOffset - 1) / HexEdit->BytesPerLine);
+    FirstDirtyLine = HexEdit->Selection.FirstByteOffset / HexEdit->BytesPerLine;
+    LastDirtyLine = (HexEdit->Selection.BeyondLastByteOffset - 1) / HexEdit->BytesPerLine;
 
     YoriWinHexEditExpandDirtyRange(HexEdit, FirstDirtyLine, LastDirtyLine);
 
@@ -5575,7 +6591,7 @@ YoriWinHexEditCreate(
     }
 
     YoriWinHexEditPaintNonClient(HexEdit);
-    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (DWORD)-1);
+    YoriWinHexEditExpandDirtyRange(HexEdit, 0, (YORI_MAX_UNSIGNED_T)-1);
 
     //
     //  SetCursorLocation implicitly paints the client area
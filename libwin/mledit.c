@@ -261,7 +261,10 @@ typedef struct _YORI_WIN_CTRL_MULTILINE_EDIT {
     YORI_STRING Caption;
 
     /**
-     An array of lines corresponding to lines within a file.
+     An array of lines corresponding to lines within a file.  The unused
+     entries in this array form a gap which is located at GapStart, so
+     lines must be located with @ref YoriWinMultilineEditLineAt rather than
+     by indexing into this array.
      */
     PYORI_STRING LineArray;
 
@@ -275,6 +278,16 @@ typedef struct _YORI_WIN_CTRL_MULTILINE_EDIT {
      */
     YORI_ALLOC_SIZE_T LinesPopulated;
 
+    /**
+     The line index where the gap of unused entries in LineArray begins.
+     Lines before this index are at the same index in LineArray, and lines
+     at or after this index follow the gap.  Lines are inserted and deleted
+     by moving the gap to the modified location, so a sequence of edits at
+     nearby lines only moves the lines between them, rather than all lines
+     through the end of the file.
+     */
+    YORI_ALLOC_SIZE_T GapStart;
+
     /**
      A stack of changes which can be undone.
      */
@@ -481,6 +494,71 @@ typedef struct _YORI_WIN_CTRL_MULTILINE_EDIT {
 
 } YORI_WIN_CTRL_MULTILINE_EDIT, *PYORI_WIN_CTRL_MULTILINE_EDIT;
 
+//
+//  =========================================
+//  LINE ARRAY FUNCTIONS
+//  =========================================
+//
+
+/**
+ Return a pointer to a line within the multiline edit control.
+
+ @param MultilineEdit Pointer to the multiline edit control.
+
+ @param LineIndex Specifies the index of the line to return.  This must be
+        less than LinesPopulated.
+
+ @return Pointer to the line.
+ */
+PYORI_STRING
+YoriWinMultilineEditLineAt(
+    __in PYORI_WIN_CTRL_MULTILINE_EDIT MultilineEdit,
+    __in YORI_ALLOC_SIZE_T LineIndex
+    )
+{
+    if (LineIndex < MultilineEdit->GapStart) {
+        return &MultilineEdit->LineArray[LineIndex];
+    }
+
+    return &MultilineEdit->LineArray[LineIndex + MultilineEdit->LinesAllocated - MultilineEdit->LinesPopulated];
+}
+
+/**
+ Move the gap of unused entries within the line array so that it begins at
+ the specified line index.  Only the lines between the current and new
+ location of the gap are moved.
+
+ @param MultilineEdit Pointer to the multiline edit control.
+
+ @param NewGapStart Specifies the line index where the gap should begin.
+        This must not be greater than LinesPopulated.
+ */
+VOID
+YoriWinMultilineEditMoveGap(
+    __in PYORI_WIN_CTRL_MULTILINE_EDIT MultilineEdit,
+    __in YORI_ALLOC_SIZE_T NewGapStart
+    )
+{
+    YORI_ALLOC_SIZE_T GapLength;
+
+    ASSERT(NewGapStart <= MultilineEdit->LinesPopulated);
+
+    GapLength = MultilineEdit->LinesAllocated - MultilineEdit->LinesPopulated;
+    if (GapLength > 0) {
+        if (NewGapStart < MultilineEdit->GapStart) {
+            memmove(&MultilineEdit->LineArray[NewGapStart + GapLength],
+                    &MultilineEdit->LineArray[NewGapStart],
+                    (MultilineEdit->GapStart - NewGapStart) * sizeof(YORI_STRING));
+        } else if (NewGapStart > MultilineEdit->GapStart) {
+            memmove(&MultilineEdit->LineArray[MultilineEdit->GapStart],
+                    &MultilineEdit->LineArray[MultilineEdit->GapStart + GapLength],
+                    (NewGapStart - MultilineEdit->GapStart) * sizeof(YORI_STRING));
+        }
+    }
+
+    MultilineEdit->GapStart = NewGapStart;
+}
+
 //
 //  =========================================
 //  DISPLAY FUNCTIONS
@@ -555,7 +633,7 @@ YoriWinMultilineEditFindCursorCharFromDisplayChar(
         return;
     }
 
-    Line = &MultilineEdit->LineArray[LineIndex];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, LineIndex);
 
     YoriWinTextBufferOffsetFromDisplayCellOffset(WinMgrHandle,
                                                  Line,
@@ -600,7 +678,7 @@ YoriWinMultilineEditFindDisplayCharFromCursorChar(
         return;
     }
 
-    Line = &MultilineEdit->LineArray[LineIndex];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, LineIndex);
 
     YoriWinTextDisplayCellOffsetFromBufferOffset(WinMgrHandle,
                                                  Line,
@@ -851,7 +929,7 @@ YoriWinMultilineEditGenerateDisplayLine(
 
     TopLevelWindow = YoriWinGetTopLevelWindow(&MultilineEdit->Ctrl);
     WinMgrHandle = YoriWinGetWindowManagerHandle(TopLevelWindow);
-    SourceLine = &MultilineEdit->LineArray[LineIndex];
+    SourceLine = YoriWinMultilineEditLineAt(MultilineEdit, LineIndex);
 
     //
     //  Create a string that corresponds to the current position in the
@@ -2158,26 +2236,26 @@ YoriWinMultilineEditGetTextRangeLength(
     if (FirstLine == LastLine) {
         ASSERT(LastCharOffset >= FirstCharOffset);
         CharsInRange = 0;
-        if (FirstCharOffset >= MultilineEdit->LineArray[FirstLine].LengthInChars) {
+        if (FirstCharOffset >= YoriWinMultilineEditLineAt(MultilineEdit, FirstLine)->LengthInChars) {
             CharsInRange = 0;
-        } else if (LastCharOffset >= MultilineEdit->LineArray[FirstLine].LengthInChars) {
-            CharsInRange = MultilineEdit->LineArray[FirstLine].LengthInChars - FirstCharOffset;
+        } else if (LastCharOffset >= YoriWinMultilineEditLineAt(MultilineEdit, FirstLine)->LengthInChars) {
+            CharsInRange = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine)->LengthInChars - FirstCharOffset;
         } else {
             CharsInRange = LastCharOffset - FirstCharOffset;
         }
     } else {
         LinesInRange = LastLine - FirstLine;
         CharsInRange = 0;
-        if (FirstCharOffset < MultilineEdit->LineArray[FirstLine].LengthInChars) {
-            CharsInRange += MultilineEdit->LineArray[FirstLine].LengthInChars - FirstCharOffset;
+        if (FirstCharOffset < YoriWinMultilineEditLineAt(MultilineEdit, FirstLine)->LengthInChars) {
+            CharsInRange += YoriWinMultilineEditLineAt(MultilineEdit, FirstLine)->LengthInChars - FirstCharOffset;
         }
         for (LineIndex = FirstLine + 1; LineIndex < LastLine; LineIndex++) {
-            CharsInRange += MultilineEdit->LineArray[LineIndex].LengthInChars;
+            CharsInRange += YoriWinMultilineEditLineAt(MultilineEdit, LineIndex)->LengthInChars;
         }
-        if (LastCharOffset < MultilineEdit->LineArray[LineIndex].LengthInChars) {
+        if (LastCharOffset < YoriWinMultilineEditLineAt(MultilineEdit, LineIndex)->LengthInChars) {
             CharsInRange += LastCharOffset;
         } else {
-            CharsInRange += MultilineEdit->LineArray[LineIndex].LengthInChars;
+            CharsInRange += YoriWinMultilineEditLineAt(MultilineEdit, LineIndex)->LengthInChars;
         }
         CharsInRange += LinesInRange * NewlineLength;
     }
@@ -2239,7 +2317,7 @@ YoriWinMultilineEditGetIndentationOnLine(
 {
     PCYORI_STRING Line;
 
-    Line = &MultilineEdit->LineArray[LineIndex];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, LineIndex);
     YoriWinMultilineEditGetIndentationOnString(Line, Indent);
 }
 
@@ -2284,7 +2362,7 @@ YoriWinMultilineEditFindPreviousIndentLine(
     //
 
     for (ProbeLine = MultilineEdit->AutoIndentAppliedLine; ProbeLine > 0; ProbeLine--) {
-        ProbeLineString = &MultilineEdit->LineArray[ProbeLine - 1];
+        ProbeLineString = YoriWinMultilineEditLineAt(MultilineEdit, ProbeLine - 1);
         if (ProbeLineString->LengthInChars > 0) {
             YoriWinMultilineEditGetIndentationOnString(ProbeLineString, &ProbeIndent);
             MatchingLength = YoriLibCntStringMatchChars(&CurrentIndent, &ProbeIndent);
@@ -2344,7 +2422,7 @@ YoriWinMultilineEditPopulateTextRange(
     PYORI_STRING Line;
     LPTSTR Ptr;
 
-    Line = &MultilineEdit->LineArray[FirstLine];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine);
 
     if (FirstLine == LastLine) {
         if (FirstCharOffset > Line->LengthInChars) {
@@ -2369,18 +2447,18 @@ YoriWinMultilineEditPopulateTextRange(
             memcpy(Ptr, NewlineString->StartOfString, NewlineString->LengthInChars * sizeof(TCHAR));
             Ptr += NewlineString->LengthInChars;
             memcpy(Ptr,
-                   MultilineEdit->LineArray[LineIndex].StartOfString,
-                   MultilineEdit->LineArray[LineIndex].LengthInChars * sizeof(TCHAR));
-            Ptr += MultilineEdit->LineArray[LineIndex].LengthInChars;
+                   YoriWinMultilineEditLineAt(MultilineEdit, LineIndex)->StartOfString,
+                   YoriWinMultilineEditLineAt(MultilineEdit, LineIndex)->LengthInChars * sizeof(TCHAR));
+            Ptr += YoriWinMultilineEditLineAt(MultilineEdit, LineIndex)->LengthInChars;
         }
         memcpy(Ptr, NewlineString->StartOfString, NewlineString->LengthInChars * sizeof(TCHAR));
         Ptr += NewlineString->LengthInChars;
-        if (LastCharOffset < MultilineEdit->LineArray[LastLine].LengthInChars) {
+        if (LastCharOffset < YoriWinMultilineEditLineAt(MultilineEdit, LastLine)->LengthInChars) {
             CharsInRange = LastCharOffset;
         } else {
-            CharsInRange = MultilineEdit->LineArray[LastLine].LengthInChars;
+            CharsInRange = YoriWinMultilineEditLineAt(MultilineEdit, LastLine)->LengthInChars;
         }
-        memcpy(Ptr, MultilineEdit->LineArray[LastLine].StartOfString, CharsInRange * sizeof(TCHAR));
+        memcpy(Ptr, YoriWinMultilineEditLineAt(MultilineEdit, LastLine)->StartOfString, CharsInRange * sizeof(TCHAR));
         Ptr += LastCharOffset;
 
         SelectedText->LengthInChars = (YORI_ALLOC_SIZE_T)(Ptr - SelectedText->StartOfString);
@@ -2513,7 +2591,6 @@ YoriWinMultilineEditDeleteTextRange(
     YORI_ALLOC_SIZE_T CharsToCopy;
     YORI_ALLOC_SIZE_T CharsToDelete;
     YORI_ALLOC_SIZE_T LinesToDelete;
-    YORI_ALLOC_SIZE_T LinesToCopy;
     YORI_ALLOC_SIZE_T FirstLineIndexToKeep;
     YORI_ALLOC_SIZE_T LineIndexToDelete;
     PYORI_STRING Line;
@@ -2588,7 +2665,7 @@ YoriWinMultilineEditDeleteTextRange(
         }
     }
 
-    Line = &MultilineEdit->LineArray[FirstLine];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine);
 
     //
     //  If the selection is one line, this is a simple case, because no
@@ -2625,7 +2702,7 @@ YoriWinMultilineEditDeleteTextRange(
     ASSERT(LastLine < MultilineEdit->LinesPopulated ||
            (LastLine == MultilineEdit->LinesPopulated && LastCharOffset == 0));
     if (LastLine < MultilineEdit->LinesPopulated) {
-        FinalLine = &MultilineEdit->LineArray[LastLine];
+        FinalLine = YoriWinMultilineEditLineAt(MultilineEdit, LastLine);
     } else {
         FinalLine = NULL;
     }
@@ -2694,25 +2771,25 @@ YoriWinMultilineEditDeleteTextRange(
     }
 
     for (LineIndexToDelete = 0; LineIndexToDelete < LinesToDelete; LineIndexToDelete++) {
-        YoriLibFreeStringContents(&MultilineEdit->LineArray[FirstLine + 1 + LineIndexToDelete]);
+        YoriLibFreeStringContents(YoriWinMultilineEditLineAt(MultilineEdit, FirstLine + 1 + LineIndexToDelete));
     }
 
+    //
+    //  Move the gap to follow the deleted lines, and extend it backwards
+    //  over them.
+    //
+
     FirstLineIndexToKeep = FirstLine + 1 + LinesToDelete;
-    if (FirstLineIndexToKeep < MultilineEdit->LinesPopulated) {
-        LinesToCopy = MultilineEdit->LinesPopulated - FirstLineIndexToKeep;
-    } else {
-        LinesToCopy = 0;
+    if (FirstLineIndexToKeep > MultilineEdit->LinesPopulated) {
+        FirstLineIndexToKeep = MultilineEdit->LinesPopulated;
     }
 
-    if (LinesToCopy > 0) {
-        memmove(&MultilineEdit->LineArray[FirstLine + 1],
-                &MultilineEdit->LineArray[FirstLine + 1 + LinesToDelete],
-                LinesToCopy * sizeof(YORI_STRING));
-    }
+    YoriWinMultilineEditMoveGap(MultilineEdit, FirstLineIndexToKeep);
 
     YoriWinMultilineEditExpandDirtyRange(MultilineEdit, FirstLine, MultilineEdit->LinesPopulated);
     MultilineEdit->UserModified = TRUE;
 
+    MultilineEdit->GapStart = MultilineEdit->GapStart - LinesToDelete;
     MultilineEdit->LinesPopulated = MultilineEdit->LinesPopulated - LinesToDelete;
 
     return TRUE;
@@ -2821,8 +2898,23 @@ YoriWinMultilineEditReallocateLineArray(
         return FALSE;
     }
 
+    //
+    //  Copy the lines before and after the gap, so that the gap grows to
+    //  include all of the new entries.
+    //
+
     if (MultilineEdit->LinesPopulated > 0) {
-        memcpy(NewLineArray, MultilineEdit->LineArray, MultilineEdit->LinesPopulated * sizeof(YORI_STRING));
+        if (MultilineEdit->GapStart > 0) {
+            memcpy(NewLineArray, MultilineEdit->LineArray, MultilineEdit->GapStart * sizeof(YORI_STRING));
+        }
+        if (MultilineEdit->GapStart < MultilineEdit->LinesPopulated) {
+            memcpy(&NewLineArray[MultilineEdit->GapStart + NewLineCount - MultilineEdit->LinesPopulated],
+                   YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->GapStart),
+                   (MultilineEdit->LinesPopulated - MultilineEdit->GapStart) * sizeof(YORI_STRING));
+        }
+    }
+
+    if (MultilineEdit->LineArray != NULL) {
         YoriLibDereference(MultilineEdit->LineArray);
     }
 
@@ -2867,7 +2959,7 @@ YoriWinMultilineEditTrimAutoIndent(
         return FALSE;
     }
 
-    Line = &MultilineEdit->LineArray[LineIndex];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, LineIndex);
 
     ASSERT(Line->LengthInChars == MultilineEdit->AutoIndentSourceLength);
     ASSERT(Line->LengthInChars != 0);
@@ -2959,18 +3051,18 @@ YoriWinMultilineEditInsertLines(
         SourceLine = FirstLine;
         TargetLine = SourceLine + LineCount + 1;
     }
-    if (SourceLine < MultilineEdit->LinesPopulated) {
-        DWORD LinesToMove;
-        LinesToMove = MultilineEdit->LinesPopulated - SourceLine;
-        memmove(&MultilineEdit->LineArray[TargetLine],
-                &MultilineEdit->LineArray[SourceLine],
-                LinesToMove * sizeof(YORI_STRING));
-    }
 
+    //
+    //  Move the gap to the insertion point and populate new lines from the
+    //  start of the gap.
+    //
+
+    YoriWinMultilineEditMoveGap(MultilineEdit, SourceLine);
     for (Index = SourceLine; Index < TargetLine; Index++) {
         YoriLibInitEmptyString(&MultilineEdit->LineArray[Index]);
     }
 
+    MultilineEdit->GapStart = TargetLine;
     MultilineEdit->LinesPopulated = (YORI_ALLOC_SIZE_T)LinesRequired;
     return TRUE;
 }
@@ -3073,7 +3165,7 @@ YoriWinMultilineEditInsertTextRange(
 
         if (AutoIndentLeadingString.LengthInChars > 0 && Text->LengthInChars > 0) {
             TCHAR FirstChar;
-            Line = &MultilineEdit->LineArray[FirstLine];
+            Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine);
             FirstChar = Text->StartOfString[0];
             if (AutoIndentLeadingString.LengthInChars == Line->LengthInChars &&
                 (FirstChar == '\n' || FirstChar == '\r')) {
@@ -3106,7 +3198,7 @@ YoriWinMultilineEditInsertTextRange(
 
     YoriLibInitEmptyString(&TrailingPortionOfFirstLine);
     if (FirstLine < MultilineEdit->LinesPopulated) {
-        Line = &MultilineEdit->LineArray[FirstLine];
+        Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine);
         if (FirstCharOffset < Line->LengthInChars) {
             ASSERT(Line->MemoryToFree != NULL);
             YoriLibReference(Line->MemoryToFree);
@@ -3158,7 +3250,7 @@ YoriWinMultilineEditInsertTextRange(
                     CharsLastLine = CharsThisLine;
                 }
             } else {
-                Line = &MultilineEdit->LineArray[FirstLine + LineIndex];
+                Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine + LineIndex);
                 ASSERT(Line->LengthInChars == 0);
                 CharsNeeded = CharsThisLine;
                 if (LineIndex == LineCount) {
@@ -3266,7 +3358,7 @@ YoriWinMultilineEditInsertTextRange(
         ASSERT(AutoIndentLeadingString.StartOfString == NULL);
     }
 
-    Line = &MultilineEdit->LineArray[FirstLine];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine);
     if (FirstCharOffset + CharsFirstLine + TrailingPortionOfFirstLine.LengthInChars > Line->LengthAllocated) {
         if (!YoriLibReallocString(Line, FirstCharOffset + CharsFirstLine + TrailingPortionOfFirstLine.LengthInChars + YORI_WIN_MULTILINE_EDIT_LINE_PADDING)) {
             YoriLibFreeStringContents(&TrailingPortionOfFirstLine);
@@ -3320,7 +3412,7 @@ YoriWinMultilineEditInsertTextRange(
         //
 
         if (TruncateFirstLine) {
-            Line = &MultilineEdit->LineArray[FirstLine];
+            Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine);
             YoriWinMultilineEditDeleteTextRange(MultilineEdit,
                                                 TRUE,
                                                 FALSE,
@@ -3426,7 +3518,7 @@ YoriWinMultilineEditOverwriteTextRange(
             //
 
             if (Undo->u.OverwriteText.Text.StartOfString == NULL) {
-                Line = &MultilineEdit->LineArray[FirstLine];
+                Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine);
                 if (!YoriLibCopyString(&Undo->u.OverwriteText.Text, Line)) {
                     return FALSE;
                 }
@@ -3504,7 +3596,7 @@ YoriWinMultilineEditOverwriteTextRange(
                 StartOffsetThisLine = FirstCharOffset;
             }
 
-            Line = &MultilineEdit->LineArray[FirstLine + LineIndex];
+            Line = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine + LineIndex);
             CharsNeeded = StartOffsetThisLine + CharsThisLine;
             if (Line->LengthAllocated < CharsNeeded) {
                 YoriLibFreeStringContents(Line);
@@ -3532,7 +3624,7 @@ YoriWinMultilineEditOverwriteTextRange(
                 Line->LengthInChars = StartOffsetThisLine + CharsThisLine;
             } else if (MoveTrailingTextToNextLine && Line->LengthInChars > StartOffsetThisLine + CharsThisLine) {
                 PYORI_STRING NextLine;
-                NextLine = &MultilineEdit->LineArray[FirstLine + LineIndex + 1];
+                NextLine = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine + LineIndex + 1);
                 ASSERT(NextLine->LengthInChars == 0);
                 CharsNeeded = Line->LengthInChars - (StartOffsetThisLine + CharsThisLine);
                 if (NextLine->LengthAllocated < CharsNeeded) {
@@ -3664,9 +3756,11 @@ YoriWinMultilineEditAppendLinesNoDataCopy(
         }
     }
 
+    YoriWinMultilineEditMoveGap(MultilineEdit, MultilineEdit->LinesPopulated);
     memcpy(&MultilineEdit->LineArray[MultilineEdit->LinesPopulated], NewLines, NewLineCount * sizeof(YORI_STRING));
     YoriWinMultilineEditExpandDirtyRange(MultilineEdit, MultilineEdit->LinesPopulated, MultilineEdit->LinesPopulated + NewLineCount);
     MultilineEdit->LinesPopulated = MultilineEdit->LinesPopulated + NewLineCount;
+    MultilineEdit->GapStart = MultilineEdit->LinesPopulated;
 
     YoriWinMultilineEditPaint(MultilineEdit);
     return TRUE;
@@ -3799,8 +3893,8 @@ YoriWinMultilineEditCheckSelectionState(
     } else {
         ASSERT(Selection->LastLine != Selection->FirstLine || Selection->FirstCharOffset < Selection->LastCharOffset);
     }
-    ASSERT(Selection->FirstCharOffset <= MultilineEdit->LineArray[Selection->FirstLine].LengthInChars);
-    ASSERT(Selection->LastCharOffset <= MultilineEdit->LineArray[Selection->LastLine].LengthInChars);
+    ASSERT(Selection->FirstCharOffset <= YoriWinMultilineEditLineAt(MultilineEdit, Selection->FirstLine)->LengthInChars);
+    ASSERT(Selection->LastCharOffset <= YoriWinMultilineEditLineAt(MultilineEdit, Selection->LastLine)->LengthInChars);
 }
 
 /**
@@ -3859,13 +3953,13 @@ YoriWinMultilineEditStartSelectionAtCursor(
         } else if (EffectiveCursorLine >= MultilineEdit->LinesPopulated) {
 
             EffectiveCursorLine = MultilineEdit->LinesPopulated - 1;
-            EffectiveCursorOffset = MultilineEdit->LineArray[EffectiveCursorLine].LengthInChars;
+            EffectiveCursorOffset = YoriWinMultilineEditLineAt(MultilineEdit, EffectiveCursorLine)->LengthInChars;
 
         }
 
         if (EffectiveCursorLine < MultilineEdit->LinesPopulated) {
-            if (EffectiveCursorOffset > MultilineEdit->LineArray[EffectiveCursorLine].LengthInChars) {
-                EffectiveCursorOffset = MultilineEdit->LineArray[EffectiveCursorLine].LengthInChars;
+            if (EffectiveCursorOffset > YoriWinMultilineEditLineAt(MultilineEdit, EffectiveCursorLine)->LengthInChars) {
+                EffectiveCursorOffset = YoriWinMultilineEditLineAt(MultilineEdit, EffectiveCursorLine)->LengthInChars;
             }
         }
 
@@ -3976,11 +4070,11 @@ YoriWinMultilineEditExtendSelectionToCursor(
     EffectiveCursorOffset = MultilineEdit->CursorOffset;
     if (EffectiveCursorLine >= MultilineEdit->LinesPopulated) {
         EffectiveCursorLine = MultilineEdit->LinesPopulated - 1;
-        EffectiveCursorOffset = MultilineEdit->LineArray[EffectiveCursorLine].LengthInChars;
+        EffectiveCursorOffset = YoriWinMultilineEditLineAt(MultilineEdit, EffectiveCursorLine)->LengthInChars;
     }
 
-    if (EffectiveCursorOffset > MultilineEdit->LineArray[EffectiveCursorLine].LengthInChars) {
-        EffectiveCursorOffset = MultilineEdit->LineArray[EffectiveCursorLine].LengthInChars;
+    if (EffectiveCursorOffset > YoriWinMultilineEditLineAt(MultilineEdit, EffectiveCursorLine)->LengthInChars) {
+        EffectiveCursorOffset = YoriWinMultilineEditLineAt(MultilineEdit, EffectiveCursorLine)->LengthInChars;
     }
 
     if (EffectiveCursorLine < AnchorLine) {
@@ -4278,7 +4372,7 @@ YoriWinMultilineEditPasteText(
     if (MultilineEdit->AutoIndentApplied &&
         MultilineEdit->CursorLine == MultilineEdit->AutoIndentAppliedLine) {
 
-        Line = &MultilineEdit->LineArray[MultilineEdit->CursorLine];
+        Line = YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->CursorLine);
 
         for (Index = 0;
              Index < Line->LengthInChars &&
@@ -4547,11 +4641,12 @@ YoriWinMultilineEditClear(
     YoriWinMultilineEditClearSelection(MultilineEdit);
 
     for (Index = 0; Index < MultilineEdit->LinesPopulated; Index++) {
-        YoriLibFreeStringContents(&MultilineEdit->LineArray[Index]);
+        YoriLibFreeStringContents(YoriWinMultilineEditLineAt(MultilineEdit, Index));
     }
     YoriWinMultilineEditClearUndo(MultilineEdit);
 
     MultilineEdit->LinesPopulated = 0;
+    MultilineEdit->GapStart = 0;
     MultilineEdit->ViewportTop = 0;
     MultilineEdit->ViewportLeft = 0;
 
@@ -4688,7 +4783,7 @@ YoriWinMultilineEditGetLineByIndex(
         return NULL;
     }
 
-    return &MultilineEdit->LineArray[Index];
+    return YoriWinMultilineEditLineAt(MultilineEdit, Index);
 }
 
 /**
@@ -4845,9 +4940,9 @@ YoriWinMultilineEditSetTraditionalNavigation(
     YoriWinMultilineEditClearDesiredDisplayOffset(MultilineEdit);
     if (!MultilineEdit->TraditionalEditNavigation) {
         if (MultilineEdit->CursorLine < MultilineEdit->LinesPopulated) {
-            if (MultilineEdit->CursorOffset > MultilineEdit->LineArray[MultilineEdit->CursorLine].LengthInChars) {
+            if (MultilineEdit->CursorOffset > YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->CursorLine)->LengthInChars) {
                 YoriWinMultilineEditSetCursorLocationInternal(MultilineEdit,
-                                                              MultilineEdit->LineArray[MultilineEdit->CursorLine].LengthInChars,
+                                                              YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->CursorLine)->LengthInChars,
                                                               MultilineEdit->CursorLine);
             }
         }
@@ -5007,7 +5102,7 @@ YoriWinMultilineEditBackspace(
         return YoriWinMultilineEditDeleteSelection(&MultilineEdit->Ctrl);
     }
 
-    Line = &MultilineEdit->LineArray[MultilineEdit->CursorLine];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->CursorLine);
 
     LastLine = MultilineEdit->CursorLine;
     LastCharOffset = MultilineEdit->CursorOffset;
@@ -5040,7 +5135,7 @@ YoriWinMultilineEditBackspace(
         }
 
         FirstLine = MultilineEdit->CursorLine - 1;
-        FirstCharOffset = MultilineEdit->LineArray[FirstLine].LengthInChars;
+        FirstCharOffset = YoriWinMultilineEditLineAt(MultilineEdit, FirstLine)->LengthInChars;
     } else {
         FirstLine = LastLine;
         FirstCharOffset = LastCharOffset - 1;
@@ -5088,7 +5183,7 @@ YoriWinMultilineEditDelete(
         return YoriWinMultilineEditDeleteSelection(&MultilineEdit->Ctrl);
     }
 
-    Line = &MultilineEdit->LineArray[MultilineEdit->CursorLine];
+    Line = YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->CursorLine);
 
     FirstLine = MultilineEdit->CursorLine;
     FirstCharOffset = MultilineEdit->CursorOffset;
@@ -5351,7 +5446,7 @@ YoriWinMultilineEditNotifyDoubleClick(
         //  If it's beyond the end of the line, there's nothing to select.
         //
 
-        Line = &MultilineEdit->LineArray[NewCursorLine];
+        Line = YoriWinMultilineEditLineAt(MultilineEdit, NewCursorLine);
         if (NewCursorChar >= Line->LengthInChars) {
             return;
         }
@@ -5527,8 +5622,8 @@ YoriWinMultilineEditScrollForMouseSelect(
     if (!MultilineEdit->TraditionalEditNavigation) {
         if (MultilineEdit->LinesPopulated > 0) {
             ASSERT(NewCursorLine < MultilineEdit->LinesPopulated);
-            if (NewCursorOffset > MultilineEdit->LineArray[NewCursorLine].LengthInChars) {
-                NewCursorOffset = MultilineEdit->LineArray[NewCursorLine].LengthInChars;
+            if (NewCursorOffset > YoriWinMultilineEditLineAt(MultilineEdit, NewCursorLine)->LengthInChars) {
+                NewCursorOffset = YoriWinMultilineEditLineAt(MultilineEdit, NewCursorLine)->LengthInChars;
             }
         }
     }
@@ -5665,7 +5760,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedKey(
             if (MultilineEdit->CursorOffset == 0) {
                 ASSERT(!MultilineEdit->TraditionalEditNavigation);
                 NewCursorLine = NewCursorLine - 1;
-                NewCursorOffset = MultilineEdit->LineArray[NewCursorLine].LengthInChars;
+                NewCursorOffset = YoriWinMultilineEditLineAt(MultilineEdit, NewCursorLine)->LengthInChars;
                 YoriWinMultilineEditTrimAutoIndent(MultilineEdit, MultilineEdit->CursorLine, 0);
             } else {
                 NewCursorOffset = MultilineEdit->CursorOffset - 1;
@@ -5683,7 +5778,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedKey(
     } else if (Event->KeyDown.VirtualKeyCode == VK_RIGHT) {
         if (MultilineEdit->TraditionalEditNavigation ||
             (MultilineEdit->CursorLine < MultilineEdit->LinesPopulated &&
-             MultilineEdit->CursorOffset < MultilineEdit->LineArray[MultilineEdit->CursorLine].LengthInChars) ||
+             MultilineEdit->CursorOffset < YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->CursorLine)->LengthInChars) ||
             MultilineEdit->CursorLine + 1 < MultilineEdit->LinesPopulated) {
 
             if (Event->KeyDown.CtrlMask & SHIFT_PRESSED) {
@@ -5695,7 +5790,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedKey(
             NewCursorOffset = MultilineEdit->CursorOffset + 1;
             if (!MultilineEdit->TraditionalEditNavigation) {
                 if ((NewCursorLine < MultilineEdit->LinesPopulated &&
-                     NewCursorOffset > MultilineEdit->LineArray[NewCursorLine].LengthInChars)) {
+                     NewCursorOffset > YoriWinMultilineEditLineAt(MultilineEdit, NewCursorLine)->LengthInChars)) {
 
                     NewCursorLine = NewCursorLine + 1;
                     NewCursorOffset = 0;
@@ -5737,7 +5832,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedKey(
             YoriWinMultilineEditClearSelection(MultilineEdit);
         }
         if (MultilineEdit->CursorLine < MultilineEdit->LinesPopulated) {
-            FinalChar = MultilineEdit->LineArray[MultilineEdit->CursorLine].LengthInChars;
+            FinalChar = YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->CursorLine)->LengthInChars;
         }
         if (MultilineEdit->CursorOffset != FinalChar) {
             YoriWinMultilineEditSetCursorLocationInternal(MultilineEdit, FinalChar, MultilineEdit->CursorLine);
@@ -5907,7 +6002,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedCtrlKey(
             YoriWinMultilineEditClearSelection(MultilineEdit);
         }
         if (MultilineEdit->LinesPopulated > 0) {
-            FinalChar = MultilineEdit->LineArray[MultilineEdit->LinesPopulated - 1].LengthInChars;
+            FinalChar = YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->LinesPopulated - 1)->LengthInChars;
             if (MultilineEdit->CursorLine != MultilineEdit->LinesPopulated - 1 ||
                 MultilineEdit->CursorOffset != FinalChar) {
 
@@ -5936,7 +6031,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedCtrlKey(
                 YORI_STRING WhitespaceChars = YORILIB_CONSTANT_STRING(_T(" -\t"));
                 PYORI_STRING Line;
 
-                Line = &MultilineEdit->LineArray[ProbeLine];
+                Line = YoriWinMultilineEditLineAt(MultilineEdit, ProbeLine);
                 Index = ProbeOffset;
                 if (Index > Line->LengthInChars) {
                     Index = Line->LengthInChars;
@@ -5948,7 +6043,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedCtrlKey(
                 }
                 if (Index == 0 && ProbeLine > 0) {
                     ProbeLine--;
-                    ProbeOffset = MultilineEdit->LineArray[ProbeLine].LengthInChars;
+                    ProbeOffset = YoriWinMultilineEditLineAt(MultilineEdit, ProbeLine)->LengthInChars;
                     continue;
                 }
                 while(Index > 0 &&
@@ -5985,7 +6080,7 @@ YoriWinMultilineEditProcessPossiblyEnhancedCtrlKey(
                 YORI_STRING WhitespaceChars = YORILIB_CONSTANT_STRING(_T(" -\t"));
                 PYORI_STRING Line;
 
-                Line = &MultilineEdit->LineArray[ProbeLine];
+                Line = YoriWinMultilineEditLineAt(MultilineEdit, ProbeLine);
                 Index = ProbeOffset;
                 if (Index > Line->LengthInChars) {
                     Index = Line->LengthInChars;
@@ -6049,7 +6144,7 @@ YoriWinMultilineEditEventHandler(
         case YoriWinEventParentDestroyed:
             YoriWinMultilineEditClearUndo(MultilineEdit);
             for (Index = 0; Index < MultilineEdit->LinesPopulated; Index++) {
-                YoriLibFreeStringContents(&MultilineEdit->LineArray[Index]);
+                YoriLibFreeStringContents(YoriWinMultilineEditLineAt(MultilineEdit, Index));
             }
             if (MultilineEdit->LineArray != NULL) {
                 YoriLibDereference(MultilineEdit->LineArray);
@@ -6107,7 +6202,7 @@ YoriWinMultilineEditEventHandler(
                                                                   0,
                                                                   0,
                                                                   MultilineEdit->LinesPopulated - 1,
-                                                                  MultilineEdit->LineArray[MultilineEdit->LinesPopulated - 1].LengthInChars);
+                                                                  YoriWinMultilineEditLineAt(MultilineEdit, MultilineEdit->LinesPopulated - 1)->LengthInChars);
                         }
                         return TRUE;
                     } else if (Event->KeyDown.VirtualKeyCode == 'C') {
@@ -336,6 +336,31 @@ YoriWinHexEditGetDataNoCopy(
     __out PYORI_ALLOC_SIZE_T BufferLength
     );
 
+YORI_MAX_UNSIGNED_T
+YoriWinHexEditGetDataLength(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle
+    );
+
+__success(return)
+BOOLEAN
+YoriWinHexEditReadData(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
+    __in YORI_MAX_UNSIGNED_T Offset,
+    __out_bcount(Length) PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length
+    );
+
+BOOLEAN
+YoriWinHexEditIsDataPaged(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle
+    );
+
+__success(return)
+BOOLEAN
+YoriWinHexEditWriteModifiedPages(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle
+    );
+
 __success(return)
 BOOLEAN
 YoriWinHexEditGetSelectedData(
@@ -391,6 +416,16 @@ YoriWinHexEditSetCursorMoveNotifyCallback(
     __in PYORI_WIN_NOTIFY_HEX_EDIT_CURSOR_MOVE NotifyCallback
     );
 
+__success(return)
+BOOLEAN
+YoriWinHexEditSetDataFromFile(
+    __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
+    __in HANDLE FileHandle,
+    __in DWORDLONG FileOffset,
+    __in DWORDLONG Length,
+    __in BOOLEAN AllowShortData
+    );
+
 BOOLEAN
 YoriWinHexEditSetDataNoCopy(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
@@ -416,7 +451,7 @@ BOOLEAN
 YoriWinHexEditSetCursorLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __in BOOLEAN AsChar,
-    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in YORI_MAX_UNSIGNED_T BufferOffset,
     __in UCHAR BitShift
     );
 
@@ -425,7 +460,7 @@ BOOLEAN
 YoriWinHexEditGetCursorLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __out PBOOLEAN AsChar,
-    __out PYORI_ALLOC_SIZE_T BufferOffset,
+    __out PYORI_MAX_UNSIGNED_T BufferOffset,
     __out PUCHAR BitShift
     );
 
@@ -434,21 +469,21 @@ BOOLEAN
 YoriWinHexEditGetVisualCursorLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __out PYORI_ALLOC_SIZE_T CursorOffset,
-    __out PYORI_ALLOC_SIZE_T CursorLine
+    __out PYORI_MAX_UNSIGNED_T CursorLine
     );
 
 VOID
 YoriWinHexEditGetViewportLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __out PYORI_ALLOC_SIZE_T ViewportLeft,
-    __out PYORI_ALLOC_SIZE_T ViewportTop
+    __out PYORI_MAX_UNSIGNED_T ViewportTop
     );
 
 VOID
 YoriWinHexEditSetViewportLocation(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
     __in YORI_ALLOC_SIZE_T NewViewportLeft,
-    __in YORI_ALLOC_SIZE_T NewViewportTop
+    __in YORI_MAX_UNSIGNED_T NewViewportTop
     );
 
 BOOLEAN
@@ -471,15 +506,15 @@ __success(return)
 BOOLEAN
 YoriWinHexEditSetSelectionRange(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T FirstByteOffset,
-    __in YORI_ALLOC_SIZE_T LastByteOffset
+    __in YORI_MAX_UNSIGNED_T FirstByteOffset,
+    __in YORI_MAX_UNSIGNED_T LastByteOffset
     );
 
 __success(return)
 BOOLEAN
 YoriWinHexEditDeleteData(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T DataOffset,
+    __in YORI_MAX_UNSIGNED_T DataOffset,
     __in YORI_ALLOC_SIZE_T Length
     );
 
@@ -487,7 +522,7 @@ __success(return)
 BOOLEAN
 YoriWinHexEditInsertData(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T DataOffset,
+    __in YORI_MAX_UNSIGNED_T DataOffset,
     __in PVOID Data,
     __in YORI_ALLOC_SIZE_T Length
     );
@@ -496,7 +531,7 @@ __success(return)
 BOOLEAN
 YoriWinHexEditReplaceData(
     __in PYORI_WIN_CTRL_HANDLE CtrlHandle,
-    __in YORI_ALLOC_SIZE_T DataOffset,
+    __in YORI_MAX_UNSIGNED_T DataOffset,
     __in PVOID Data,
     __in YORI_ALLOC_SIZE_T Length
     );
@@ -140,11 +140,10 @@ LinesProcessStream(
     )
 {
     PVOID LineContext = NULL;
-    YORI_STRING LineString;
+    YORI_LIB_LINE_VIEW LineView;
+    YORI_ALLOC_SIZE_T LineLength;
     BOOLEAN OneLineFound;
 
-    YoriLibInitEmptyString(&LineString);
-
     LinesContext->FilesFound++;
     LinesContext->FilesFoundThisArg++;
     LinesContext->FileLinesFound = 0;
@@ -155,24 +154,35 @@ LinesProcessStream(
 
     while (TRUE) {
 
-        if (!YoriLibReadLineToString(&LineString, &LineContext, hSource)) {
+        if (!YoriLibReadLineToView(&LineView, &LineContext, hSource)) {
             break;
         }
 
         LinesContext->FileLinesFound++;
-        LinesContext->FileTotalChars = LinesContext->FileTotalChars + LineString.LengthInChars;
-        if (LineString.LengthInChars > LinesContext->FileLongestLine) {
-            LinesContext->FileLongestLine = LineString.LengthInChars;
+
+        //
+        //  Lines are only converted to determine their length if length
+        //  statistics were requested.  Counting lines alone does not need
+        //  to look at their contents.
+        //
+
+        if (!LinesContext->DisplayLengthStats) {
+            continue;
+        }
+
+        LineLength = YoriLibLineViewGetLengthInChars(&LineView);
+        LinesContext->FileTotalChars = LinesContext->FileTotalChars + LineLength;
+        if (LineLength > LinesContext->FileLongestLine) {
+            LinesContext->FileLongestLine = LineLength;
         }
 
-        if (!OneLineFound || LineString.LengthInChars < LinesContext->FileShortestLine) {
-            LinesContext->FileShortestLine = LineString.LengthInChars;
+        if (!OneLineFound || LineLength < LinesContext->FileShortestLine) {
+            LinesContext->FileShortestLine = LineLength;
             OneLineFound = TRUE;
         }
     }
 
     YoriLibLineReadCloseOrCache(LineContext);
-    YoriLibFreeStringContents(&LineString);
 
     LinesContext->TotalLinesFound += LinesContext->FileLinesFound;
     return TRUE;
@@ -0,0 +1,436 @@
+/**
+ * @file make/dircache.c
+ *
+ * Yori shell make directory metadata cache
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yorilib.h>
+#include <yorish.h>
+#include "make.h"
+
+/**
+ Information about a single file found when enumerating a directory.
+ */
+typedef struct _MAKE_FILE_CACHE_ENTRY {
+
+    /**
+     The hash entry of the file.  The key is the file name without any
+     path.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     The list of files within the directory, to facilitate bulk delete.
+     Paired with MAKE_DIRECTORY_CACHE_ENTRY::FileList .
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     The attributes of the file.
+     */
+    DWORD FileAttributes;
+
+    /**
+     The last write time of the file.
+     */
+    LARGE_INTEGER ModifiedTime;
+
+    /**
+     Storage for the file name, which is used as the hash key.  This is
+     allocated as part of this structure and extends beyond it.
+     */
+    TCHAR FileName[1];
+
+} MAKE_FILE_CACHE_ENTRY, *PMAKE_FILE_CACHE_ENTRY;
+
+/**
+ Information about a directory whose contents have been enumerated.
+ */
+typedef struct _MAKE_DIRECTORY_CACHE_ENTRY {
+
+    /**
+     The hash entry of the directory.  The key is the full path to the
+     directory, without a trailing separator.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     The list of known directories, to facilitate bulk delete.  Paired with
+     MAKE_CONTEXT::DirectoryCacheList .
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     A hash table of files found in the directory.  This is NULL if the
+     directory could not be enumerated, in which case probes in this
+     directory need to query the file system directly.
+     */
+    PYORI_HASH_TABLE Files;
+
+    /**
+     A list of files found in the directory.  Paired with
+     MAKE_FILE_CACHE_ENTRY::ListEntry .
+     */
+    YORI_LIST_ENTRY FileList;
+
+    /**
+     Storage for the directory name, which is used as the hash key.  This is
+     allocated as part of this structure and extends beyond it.
+     */
+    TCHAR DirectoryName[1];
+
+} MAKE_DIRECTORY_CACHE_ENTRY, *PMAKE_DIRECTORY_CACHE_ENTRY;
+
+/**
+ Free all of the files found within a directory, leaving the directory
+ entry indicating its contents are unknown.
+
+ @param Directory Pointer to the directory whose contents should be freed.
+ */
+VOID
+MakeFreeDirectoryCacheFiles(
+    __inout PMAKE_DIRECTORY_CACHE_ENTRY Directory
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_FILE_CACHE_ENTRY File;
+
+    ListEntry = YoriLibGetNextListEntry(&Directory->FileList, NULL);
+    while (ListEntry != NULL) {
+        File = CONTAINING_RECORD(ListEntry, MAKE_FILE_CACHE_ENTRY, ListEntry);
+        YoriLibRemoveListItem(&File->ListEntry);
+        YoriLibHashRemoveByEntry(&File->HashEntry);
+        YoriLibFree(File);
+        ListEntry = YoriLibGetNextListEntry(&Directory->FileList, NULL);
+    }
+
+    if (Directory->Files != NULL) {
+        YoriLibFreeEmptyHashTable(Directory->Files);
+        Directory->Files = NULL;
+    }
+}
+
+/**
+ Discard all cached directory contents.  This is performed when commands
+ may have modified the file system, and once the dependency graph has been
+ built.
+
+ @param MakeContext Pointer to the context.
+ */
+VOID
+MakeDeleteDirectoryCache(
+    __in PMAKE_CONTEXT MakeContext
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_DIRECTORY_CACHE_ENTRY Directory;
+
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->DirectoryCacheList, NULL);
+    while (ListEntry != NULL) {
+        Directory = CONTAINING_RECORD(ListEntry, MAKE_DIRECTORY_CACHE_ENTRY, ListEntry);
+        YoriLibRemoveListItem(&Directory->ListEntry);
+        YoriLibHashRemoveByEntry(&Directory->HashEntry);
+        MakeFreeDirectoryCacheFiles(Directory);
+        YoriLibFree(Directory);
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->DirectoryCacheList, NULL);
+    }
+}
+
+/**
+ Enumerate the contents of a directory and record the attributes and
+ timestamps of every file in it.
+
+ @param Directory Pointer to the directory cache entry to populate.  On
+        entry, the hash entry key contains the directory name.
+
+ @return TRUE to indicate the directory contents are known, which includes
+         the directory not existing.  FALSE to indicate the contents could
+         not be determined.
+ */
+BOOLEAN
+MakeEnumerateDirectoryIntoCache(
+    __inout PMAKE_DIRECTORY_CACHE_ENTRY Directory
+    )
+{
+    PMAKE_FILE_CACHE_ENTRY File;
+    YORI_STRING SearchPath;
+    YORI_STRING FileName;
+    WIN32_FIND_DATA FindData;
+    HANDLE FindHandle;
+    DWORD Err;
+
+    if (!YoriLibAllocateString(&SearchPath, Directory->HashEntry.Key.LengthInChars + sizeof("\\*"))) {
+        return FALSE;
+    }
+
+    SearchPath.LengthInChars = YoriLibSPrintf(SearchPath.StartOfString, _T("%y\\*"), &Directory->HashEntry.Key);
+
+    Directory->Files = YoriLibAllocateHashTable(32);
+    if (Directory->Files == NULL) {
+        YoriLibFreeStringContents(&SearchPath);
+        return FALSE;
+    }
+
+    FindHandle = FindFirstFile(SearchPath.StartOfString, &FindData);
+    YoriLibFreeStringContents(&SearchPath);
+    if (FindHandle == INVALID_HANDLE_VALUE) {
+
+        //
+        //  If the directory does not exist, or is empty, no file within it
+        //  exists.  Any other error means the contents are unknown.
+        //
+
+        Err = GetLastError();
+        if (Err == ERROR_FILE_NOT_FOUND || Err == ERROR_PATH_NOT_FOUND) {
+            return TRUE;
+        }
+
+        return FALSE;
+    }
+
+    do {
+        YoriLibConstantString(&FileName, FindData.cFileName);
+        if (YoriLibCompareStringLit(&FileName, _T(".")) == 0 ||
+            YoriLibCompareStringLit(&FileName, _T("..")) == 0) {
+
+            continue;
+        }
+
+        //
+        //  The hash table references the key rather than copying it, so
+        //  the name needs to outlive the find data.
+        //
+
+        File = YoriLibMalloc(sizeof(MAKE_FILE_CACHE_ENTRY) + FileName.LengthInChars * sizeof(TCHAR));
+        if (File == NULL) {
+            FindClose(FindHandle);
+            return FALSE;
+        }
+
+        memcpy(File->FileName, FileName.StartOfString, FileName.LengthInChars * sizeof(TCHAR));
+        File->FileName[FileName.LengthInChars] = '\0';
+        FileName.StartOfString = File->FileName;
+
+        File->FileAttributes = FindData.dwFileAttributes;
+        File->ModifiedTime.LowPart = FindData.ftLastWriteTime.dwLowDateTime;
+        File->ModifiedTime.HighPart = FindData.ftLastWriteTime.dwHighDateTime;
+
+        YoriLibHashInsertByKey(Directory->Files, &FileName, File, &File->HashEntry);
+        YoriLibAppendList(&Directory->FileList, &File->ListEntry);
+
+    } while (FindNextFile(FindHandle, &FindData));
+
+    FindClose(FindHandle);
+    return TRUE;
+}
+
+/**
+ Find the directory cache entry for a directory, enumerating the directory
+ if it has not been encountered before.
+
+ @param MakeContext Pointer to the context.
+
+ @param DirectoryName Pointer to the full path to the directory, without a
+        trailing separator.
+
+ @return Pointer to the directory cache entry, or NULL on allocation
+         failure.
+ */
+PMAKE_DIRECTORY_CACHE_ENTRY
+MakeLookupOrCreateDirectoryCacheEntry(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING DirectoryName
+    )
+{
+    PMAKE_DIRECTORY_CACHE_ENTRY Directory;
+    PYORI_HASH_ENTRY HashEntry;
+    YORI_STRING Key;
+
+    HashEntry = YoriLibHashLookupByKey(MakeContext->DirectoryCache, DirectoryName);
+    if (HashEntry != NULL) {
+        return CONTAINING_RECORD(HashEntry, MAKE_DIRECTORY_CACHE_ENTRY, HashEntry);
+    }
+
+    Directory = YoriLibMalloc(sizeof(MAKE_DIRECTORY_CACHE_ENTRY) + DirectoryName->LengthInChars * sizeof(TCHAR));
+    if (Directory == NULL) {
+        return NULL;
+    }
+
+    ZeroMemory(Directory, sizeof(MAKE_DIRECTORY_CACHE_ENTRY));
+    YoriLibInitializeListHead(&Directory->FileList);
+
+    //
+    //  The caller's name is typically part of a longer path whose lifetime
+    //  is unrelated to the cache, and the hash table references the key
+    //  rather than copying it, so keep a copy with the entry.  Insert first
+    //  so the hash entry key can be used to build the search path.
+    //
+
+    memcpy(Directory->DirectoryName, DirectoryName->StartOfString, DirectoryName->LengthInChars * sizeof(TCHAR));
+    Directory->DirectoryName[DirectoryName->LengthInChars] = '\0';
+    YoriLibInitEmptyString(&Key);
+    Key.StartOfString = Directory->DirectoryName;
+    Key.LengthInChars = DirectoryName->LengthInChars;
+    Key.LengthAllocated = DirectoryName->LengthInChars + 1;
+
+    YoriLibHashInsertByKey(MakeContext->DirectoryCache, &Key, Directory, &Directory->HashEntry);
+    YoriLibAppendList(&MakeContext->DirectoryCacheList, &Directory->ListEntry);
+
+    //
+    //  If enumeration fails, keep the entry so it is not retried for every
+    //  file, but discard anything partially found so that probes in this
+    //  directory fall back to the file system.
+    //
+
+    if (!MakeEnumerateDirectoryIntoCache(Directory)) {
+        MakeFreeDirectoryCacheFiles(Directory);
+    }
+
+    return Directory;
+}
+
+/**
+ Look up a file in the directory cache, enumerating its parent directory if
+ that has not been done already.
+
+ @param MakeContext Pointer to the context.
+
+ @param FullPath Pointer to the fully qualified path to the file.
+
+ @param FileExists On successful completion, set to TRUE if the file exists,
+        or FALSE if it does not.
+
+ @param FileAttributes On successful completion, if the file exists, set to
+        the attributes of the file.
+
+ @param ModifiedTime On successful completion, if the file exists, set to
+        the last write time of the file.
+
+ @return TRUE to indicate the cache was able to determine whether the file
+         exists, or FALSE if the caller should query the file system.
+ */
+__success(return)
+BOOLEAN
+MakeLookupFileInDirectoryCache(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING FullPath,
+    __out PBOOLEAN FileExists,
+    __out PDWORD FileAttributes,
+    __out PLARGE_INTEGER ModifiedTime
+    )
+{
+    PMAKE_DIRECTORY_CACHE_ENTRY Directory;
+    PMAKE_FILE_CACHE_ENTRY File;
+    PYORI_HASH_ENTRY HashEntry;
+    YORI_STRING DirectoryName;
+    YORI_STRING FileName;
+    YORI_ALLOC_SIZE_T Index;
+
+    if (MakeContext->DirectoryCache == NULL) {
+        return FALSE;
+    }
+
+    //
+    //  Split the path into a parent directory and a file name.  Paths
+    //  referring to a root, or with a trailing separator, are not cached.
+    //
+
+    YoriLibInitEmptyString(&FileName);
+    for (Index = FullPath->LengthInChars; Index > 0; Index--) {
+        if (YoriLibIsSep(FullPath->StartOfString[Index - 1])) {
+            FileName.StartOfString = &FullPath->StartOfString[Index];
+            FileName.LengthInChars = FullPath->LengthInChars - Index;
+            break;
+        }
+    }
+
+    if (Index <= 1 || FileName.LengthInChars == 0) {
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(&DirectoryName);
+    DirectoryName.StartOfString = FullPath->StartOfString;
+    DirectoryName.LengthInChars = Index - 1;
+
+    Directory = MakeLookupOrCreateDirectoryCacheEntry(MakeContext, &DirectoryName);
+    if (Directory == NULL || Directory->Files == NULL) {
+        return FALSE;
+    }
+
+    HashEntry = YoriLibHashLookupByKey(Directory->Files, &FileName);
+    if (HashEntry == NULL) {
+
+        //
+        //  Enumeration returns long file names.  If the name might be a
+        //  short name, let the file system resolve it.
+        //
+
+        if (YoriLibFindLeftMostCharacter(&FileName, '~') != NULL) {
+            return FALSE;
+        }
+
+        *FileExists = FALSE;
+        return TRUE;
+    }
+
+    File = CONTAINING_RECORD(HashEntry, MAKE_FILE_CACHE_ENTRY, HashEntry);
+    *FileExists = TRUE;
+    *FileAttributes = File->FileAttributes;
+    ModifiedTime->QuadPart = File->ModifiedTime.QuadPart;
+    return TRUE;
+}
+
+/**
+ Determine whether a file exists, using the directory cache where possible.
+
+ @param MakeContext Pointer to the context.
+
+ @param FullPath Pointer to the fully qualified, NULL terminated path to the
+        file.
+
+ @return TRUE if the file exists, FALSE if it does not.
+ */
+BOOLEAN
+MakeDoesFileExist(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING FullPath
+    )
+{
+    BOOLEAN FileExists;
+    DWORD FileAttributes;
+    LARGE_INTEGER ModifiedTime;
+
+    if (MakeLookupFileInDirectoryCache(MakeContext, FullPath, &FileExists, &FileAttributes, &ModifiedTime)) {
+        return FileExists;
+    }
+
+    ASSERT(YoriLibIsStringNullTerminated(FullPath));
+    if (GetFileAttributes(FullPath->StartOfString) != (DWORD)-1) {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+// vim:sw=4:ts=4:et:
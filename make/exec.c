@@ -47,6 +47,13 @@ typedef struct _MAKE_CHILD_RECIPE {
      */
     DWORD JobId;
 
+    /**
+     Indicates the slot executing this recipe.  Unlike the job identifier,
+     this remains allocated for the duration of the recipe including any
+     builtin commands, and is used to report how busy each slot was.
+     */
+    DWORD Slot;
+
     /**
      The current directory for this recipe.
      */
@@ -739,6 +746,150 @@ MakeRecipeCompletion(
     YoriLibFreeStringContents(&ChildRecipe->CurrentDirectory);
 }
 
+/**
+ Indicate whether one ready target should be launched before another.
+ Targets which start the longest chain are launched first.  Targets with
+ equal cost are launched in the order they became ready.
+
+ @param First Pointer to the first target.
+
+ @param Second Pointer to the second target.
+
+ @return TRUE if First should be launched before Second, FALSE if not.
+ */
+BOOLEAN
+MakeIsReadyTargetHigherPriority(
+    __in PMAKE_TARGET First,
+    __in PMAKE_TARGET Second
+    )
+{
+    if (First->RemainingPathCost != Second->RemainingPathCost) {
+        return (BOOLEAN)(First->RemainingPathCost > Second->RemainingPathCost);
+    }
+
+    return (BOOLEAN)(First->ReadySequence < Second->ReadySequence);
+}
+
+/**
+ Move an entry in the ready heap towards the root until its parent has a
+ higher priority.
+
+ @param MakeContext Pointer to the context.
+
+ @param Index The index of the entry to move.
+ */
+VOID
+MakeReadyHeapSiftUp(
+    __in PMAKE_CONTEXT MakeContext,
+    __in YORI_ALLOC_SIZE_T Index
+    )
+{
+    PMAKE_TARGET Target;
+    YORI_ALLOC_SIZE_T ParentIndex;
+
+    Target = MakeContext->ReadyHeap[Index];
+    while (Index > 0) {
+        ParentIndex = (Index - 1) / 2;
+        if (!MakeIsReadyTargetHigherPriority(Target, MakeContext->ReadyHeap[ParentIndex])) {
+            break;
+        }
+        MakeContext->ReadyHeap[Index] = MakeContext->ReadyHeap[ParentIndex];
+        Index = ParentIndex;
+    }
+    MakeContext->ReadyHeap[Index] = Target;
+}
+
+/**
+ Move an entry in the ready heap away from the root until both of its
+ children have a lower priority.
+
+ @param MakeContext Pointer to the context.
+
+ @param Index The index of the entry to move.
+ */
+VOID
+MakeReadyHeapSiftDown(
+    __in PMAKE_CONTEXT MakeContext,
+    __in YORI_ALLOC_SIZE_T Index
+    )
+{
+    PMAKE_TARGET Target;
+    YORI_ALLOC_SIZE_T ChildIndex;
+    YORI_ALLOC_SIZE_T Count;
+
+    Count = MakeContext->ReadyHeapCount;
+    Target = MakeContext->ReadyHeap[Index];
+    while (TRUE) {
+        ChildIndex = Index * 2 + 1;
+        if (ChildIndex >= Count) {
+            break;
+        }
+        if (ChildIndex + 1 < Count &&
+            MakeIsReadyTargetHigherPriority(MakeContext->ReadyHeap[ChildIndex + 1], MakeContext->ReadyHeap[ChildIndex])) {
+
+            ChildIndex++;
+        }
+        if (!MakeIsReadyTargetHigherPriority(MakeContext->ReadyHeap[ChildIndex], Target)) {
+            break;
+        }
+        MakeContext->ReadyHeap[Index] = MakeContext->ReadyHeap[ChildIndex];
+        Index = ChildIndex;
+    }
+    MakeContext->ReadyHeap[Index] = Target;
+}
+
+/**
+ Insert a target into the ready heap.  The heap is allocated with space for
+ every target that needs to be built, so this cannot fail.
+
+ @param MakeContext Pointer to the context.
+
+ @param Target Pointer to the target which is ready to execute.
+ */
+VOID
+MakeInsertReadyTarget(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PMAKE_TARGET Target
+    )
+{
+    ASSERT(MakeContext->ReadyHeapCount < MakeContext->ReadyHeapAllocated);
+
+    Target->ReadySequence = MakeContext->ReadySequence;
+    MakeContext->ReadySequence++;
+
+    MakeContext->ReadyHeap[MakeContext->ReadyHeapCount] = Target;
+    MakeContext->ReadyHeapCount++;
+    MakeReadyHeapSiftUp(MakeContext, MakeContext->ReadyHeapCount - 1);
+}
+
+/**
+ Remove the highest priority target from the ready heap.
+
+ @param MakeContext Pointer to the context.
+
+ @return Pointer to the target, or NULL if no target is ready.
+ */
+PMAKE_TARGET
+MakeRemoveReadyTarget(
+    __in PMAKE_CONTEXT MakeContext
+    )
+{
+    PMAKE_TARGET Target;
+
+    if (MakeContext->ReadyHeapCount == 0) {
+        return NULL;
+    }
+
+    Target = MakeContext->ReadyHeap[0];
+    MakeContext->ReadyHeapCount--;
+    if (MakeContext->ReadyHeapCount > 0) {
+        MakeContext->ReadyHeap[0] = MakeContext->ReadyHeap[MakeContext->ReadyHeapCount];
+        MakeReadyHeapSiftDown(MakeContext, 0);
+    }
+
+    return Target;
+}
+
 /**
  Launch the recipe for the next ready target.
 
@@ -757,7 +908,6 @@ MakeLaunchNextTarget(
     )
 {
     PMAKE_TARGET Target;
-    PYORI_LIST_ENTRY ListEntry;
     BOOLEAN Result;
 
     //
@@ -770,20 +920,19 @@ MakeLaunchNextTarget(
     //  Get the next target.
     //
 
-    ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsReady, NULL);
+    Target = MakeRemoveReadyTarget(MakeContext);
 
     //
     //  The caller should have checked that there is a target.
     //
 
-    ASSERT(ListEntry != NULL);
-    if (ListEntry == NULL) {
+    ASSERT(Target != NULL);
+    if (Target == NULL) {
         return FALSE;
     }
 
-    YoriLibRemoveListItem(ListEntry);
-    YoriLibAppendList(&MakeContext->TargetsRunning, ListEntry);
-    Target = CONTAINING_RECORD(ListEntry, MAKE_TARGET, RebuildList);
+    YoriLibAppendList(&MakeContext->TargetsRunning, &Target->RebuildList);
+    QueryPerformanceCounter(&Target->StartTime);
 
     ChildRecipe->Target = Target;
     ChildRecipe->Cmd = NULL;
@@ -816,9 +965,443 @@ MakeLaunchNextTarget(
     return Result;
 }
 
+/**
+ The estimated cost of each command in a recipe, in milliseconds, when no
+ previous duration has been recorded for the target.
+ */
+#define MAKE_DEFAULT_COMMAND_COST 100
+
+/**
+ Load recipe durations recorded by a previous execution.
+
+ @param MakeContext Pointer to the context.
+
+ @param MakeFileName Pointer to the file name of the makefile.  If this
+        contains a string, it will be used as the base name for the stats
+        file.
+ */
+VOID
+MakeLoadRecipeStats(
+    __inout PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING MakeFileName
+    )
+{
+    PMAKE_RECIPE_STATS_ENTRY Entry;
+    YORI_STRING StatsFileName;
+    YORI_STRING Key;
+    YORI_STRING LineString;
+    YORI_ALLOC_SIZE_T CharsConsumed;
+    YORI_MAX_SIGNED_T llTemp;
+    HANDLE hStats;
+    PVOID LineContext = NULL;
+
+    if (!MakeGetCacheFileNameFromMakeFileName(MakeFileName, _T(".prs"), &StatsFileName)) {
+        return;
+    }
+
+    hStats = CreateFile(StatsFileName.StartOfString, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    YoriLibFreeStringContents(&StatsFileName);
+    if (hStats == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    YoriLibInitEmptyString(&LineString);
+
+    while (TRUE) {
+        if (!YoriLibReadLineToString(&LineString, &LineContext, hStats)) {
+            break;
+        }
+
+        //
+        //  The format of each line is expected to be:
+        //  Duration:TargetName
+        //
+
+        if (!YoriLibStringToNumber(&LineString, FALSE, &llTemp, &CharsConsumed) ||
+            CharsConsumed == 0 ||
+            CharsConsumed + 1 >= LineString.LengthInChars ||
+            LineString.StartOfString[CharsConsumed] != ':') {
+
+            break;
+        }
+
+        YoriLibInitEmptyString(&Key);
+        Key.StartOfString = &LineString.StartOfString[CharsConsumed + 1];
+        Key.LengthInChars = LineString.LengthInChars - CharsConsumed - 1;
+
+        if (YoriLibHashLookupByKey(MakeContext->RecipeStats, &Key) != NULL) {
+            continue;
+        }
+
+        //
+        //  Copy the trailing portion of the line so the hash package has
+        //  an allocation that won't go away
+        //
+
+        if (!YoriLibAllocateString(&Key, LineString.LengthInChars - CharsConsumed - 1)) {
+            break;
+        }
+
+        memcpy(Key.StartOfString, &LineString.StartOfString[CharsConsumed + 1], (LineString.LengthInChars - CharsConsumed - 1) * sizeof(TCHAR));
+        Key.LengthInChars = LineString.LengthInChars - CharsConsumed - 1;
+
+        Entry = YoriLibMalloc(sizeof(MAKE_RECIPE_STATS_ENTRY));
+        if (Entry == NULL) {
+            YoriLibFreeStringContents(&Key);
+            break;
+        }
+
+        ZeroMemory(Entry, sizeof(MAKE_RECIPE_STATS_ENTRY));
+        Entry->Duration = (DWORD)llTemp;
+
+        YoriLibHashInsertByKey(MakeContext->RecipeStats, &Key, Entry, &Entry->HashEntry);
+        YoriLibAppendList(&MakeContext->RecipeStatsList, &Entry->ListEntry);
+        YoriLibFreeStringContents(&Key);
+    }
+
+    YoriLibLineReadCloseOrCache(LineContext);
+    YoriLibFreeStringContents(&LineString);
+    CloseHandle(hStats);
+}
+
+/**
+ Deallocate all recipe durations and write them to a file so a subsequent
+ execution can use them to estimate the cost of each target.
+
+ @param MakeContext Pointer to the context.
+
+ @param MakeFileName Pointer to the file name of the makefile.  If this
+        contains a string, it will be used as the base name for the stats
+        file.
+ */
+VOID
+MakeSaveAndDeleteRecipeStats(
+    __inout PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING MakeFileName
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_RECIPE_STATS_ENTRY Entry;
+    YORI_STRING StatsFileName;
+    HANDLE hStats;
+
+    if (MakeContext->RecipeStats == NULL) {
+        return;
+    }
+
+    hStats = NULL;
+    if (MakeGetCacheFileNameFromMakeFileName(MakeFileName, _T(".prs"), &StatsFileName)) {
+        hStats = CreateFile(StatsFileName.StartOfString, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hStats == INVALID_HANDLE_VALUE) {
+            hStats = NULL;
+        }
+        YoriLibFreeStringContents(&StatsFileName);
+    }
+
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->RecipeStatsList, NULL);
+    while (ListEntry != NULL) {
+        Entry = CONTAINING_RECORD(ListEntry, MAKE_RECIPE_STATS_ENTRY, ListEntry);
+
+        if (hStats != NULL) {
+            YoriLibOutputToDevice(hStats, 0, _T("%i:%y\n"), Entry->Duration, &Entry->HashEntry.Key);
+        }
+        YoriLibRemoveListItem(&Entry->ListEntry);
+        YoriLibHashRemoveByEntry(&Entry->HashEntry);
+        YoriLibFree(Entry);
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->RecipeStatsList, NULL);
+    }
+    YoriLibFreeEmptyHashTable(MakeContext->RecipeStats);
+    MakeContext->RecipeStats = NULL;
+
+    if (hStats != NULL) {
+        CloseHandle(hStats);
+    }
+}
+
+/**
+ Record the time taken to execute the recipe for a target so that a later
+ execution can estimate its cost.  If a duration was recorded previously,
+ the new value is averaged with it so a single slow run does not dominate.
+
+ @param MakeContext Pointer to the context.
+
+ @param Target Pointer to the target whose recipe has completed.
+ */
+VOID
+MakeRecordRecipeDuration(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PMAKE_TARGET Target
+    )
+{
+    PMAKE_RECIPE_STATS_ENTRY Entry;
+    PYORI_HASH_ENTRY HashEntry;
+    LARGE_INTEGER Frequency;
+    DWORD Duration;
+
+    if (MakeContext->RecipeStats == NULL) {
+        return;
+    }
+
+    QueryPerformanceFrequency(&Frequency);
+    Duration = (DWORD)((Target->EndTime.QuadPart - Target->StartTime.QuadPart) * 1000 / Frequency.QuadPart);
+
+    HashEntry = YoriLibHashLookupByKey(MakeContext->RecipeStats, &Target->HashEntry.Key);
+    if (HashEntry != NULL) {
+        Entry = CONTAINING_RECORD(HashEntry, MAKE_RECIPE_STATS_ENTRY, HashEntry);
+        Entry->Duration = (Entry->Duration + Duration) / 2;
+        return;
+    }
+
+    Entry = YoriLibMalloc(sizeof(MAKE_RECIPE_STATS_ENTRY));
+    if (Entry == NULL) {
+        return;
+    }
+
+    ZeroMemory(Entry, sizeof(MAKE_RECIPE_STATS_ENTRY));
+    Entry->Duration = Duration;
+
+    YoriLibHashInsertByKey(MakeContext->RecipeStats, &Target->HashEntry.Key, Entry, &Entry->HashEntry);
+    YoriLibAppendList(&MakeContext->RecipeStatsList, &Entry->ListEntry);
+}
+
+/**
+ Estimate the time needed to execute the recipe for a target.  If the
+ target has been built before, the recorded duration is used; otherwise
+ each command is assumed to take a fixed amount of time.
+
+ @param MakeContext Pointer to the context.
+
+ @param Target Pointer to the target.
+
+ @return The estimated duration, in milliseconds.
+ */
+DWORD
+MakeEstimateRecipeDuration(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PMAKE_TARGET Target
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_HASH_ENTRY HashEntry;
+    PMAKE_RECIPE_STATS_ENTRY Entry;
+    DWORD Duration;
+
+    if (YoriLibIsListEmpty(&Target->ExecCmds)) {
+        return 0;
+    }
+
+    if (MakeContext->RecipeStats != NULL) {
+        HashEntry = YoriLibHashLookupByKey(MakeContext->RecipeStats, &Target->HashEntry.Key);
+        if (HashEntry != NULL) {
+            Entry = CONTAINING_RECORD(HashEntry, MAKE_RECIPE_STATS_ENTRY, HashEntry);
+            return Entry->Duration;
+        }
+    }
+
+    Duration = 0;
+    ListEntry = YoriLibGetNextListEntry(&Target->ExecCmds, NULL);
+    while (ListEntry != NULL) {
+        Duration = Duration + MAKE_DEFAULT_COMMAND_COST;
+        ListEntry = YoriLibGetNextListEntry(&Target->ExecCmds, ListEntry);
+    }
+
+    return Duration;
+}
+
+/**
+ Calculate the estimated cost of building a target and the most expensive
+ chain of targets that depend on it.  Results are retained in the target so
+ each target is only evaluated once.
+
+ @param MakeContext Pointer to the context.
+
+ @param Target Pointer to the target.
+
+ @return The estimated remaining path cost, in milliseconds.
+ */
+DWORDLONG
+MakeCalculateRemainingPathCost(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PMAKE_TARGET Target
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_TARGET_DEPENDENCY Dependency;
+    DWORDLONG ChildCost;
+    DWORDLONG LongestChildCost;
+
+    if (Target->RemainingPathCostCalculated) {
+        return Target->RemainingPathCost;
+    }
+
+    LongestChildCost = 0;
+    ListEntry = YoriLibGetNextListEntry(&Target->ChildDependents, NULL);
+    while (ListEntry != NULL) {
+        Dependency = CONTAINING_RECORD(ListEntry, MAKE_TARGET_DEPENDENCY, ParentDependents);
+        if (Dependency->Child->RebuildRequired) {
+            ChildCost = MakeCalculateRemainingPathCost(MakeContext, Dependency->Child);
+            if (ChildCost > LongestChildCost) {
+                LongestChildCost = ChildCost;
+            }
+        }
+        ListEntry = YoriLibGetNextListEntry(&Target->ChildDependents, ListEntry);
+    }
+
+    Target->EstimatedDuration = MakeEstimateRecipeDuration(MakeContext, Target);
+    Target->RemainingPathCost = Target->EstimatedDuration + LongestChildCost;
+    Target->RemainingPathCostCalculated = TRUE;
+    return Target->RemainingPathCost;
+}
+
+/**
+ Calculate the remaining path cost for every target that needs to be built,
+ and move all targets which are ready to execute into the ready heap so the
+ longest chain is launched first.  The heap is allocated with space for
+ every target that needs to be built, since each can only become ready once.
+
+ @param MakeContext Pointer to the context.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+MakePrioritizeReadyTargets(
+    __in PMAKE_CONTEXT MakeContext
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_TARGET Target;
+    YORI_ALLOC_SIZE_T TargetCount;
+    YORI_ALLOC_SIZE_T Index;
+
+    //
+    //  Start from one so the allocation is never empty.
+    //
+
+    TargetCount = 1;
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsWaiting, NULL);
+    while (ListEntry != NULL) {
+        Target = CONTAINING_RECORD(ListEntry, MAKE_TARGET, RebuildList);
+        MakeCalculateRemainingPathCost(MakeContext, Target);
+        TargetCount++;
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsWaiting, ListEntry);
+    }
+
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsReady, NULL);
+    while (ListEntry != NULL) {
+        Target = CONTAINING_RECORD(ListEntry, MAKE_TARGET, RebuildList);
+        MakeCalculateRemainingPathCost(MakeContext, Target);
+        TargetCount++;
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsReady, ListEntry);
+    }
+
+    if (!YoriLibIsSizeAllocatable((YORI_MAX_UNSIGNED_T)TargetCount * sizeof(PMAKE_TARGET))) {
+        return FALSE;
+    }
+
+    MakeContext->ReadyHeap = YoriLibMalloc(TargetCount * sizeof(PMAKE_TARGET));
+    if (MakeContext->ReadyHeap == NULL) {
+        return FALSE;
+    }
+
+    MakeContext->ReadyHeapAllocated = TargetCount;
+    MakeContext->ReadyHeapCount = 0;
+
+    //
+    //  Add the targets in the order they were found, then build the heap
+    //  in a single pass.  Targets in the heap are not linked into any list.
+    //
+
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsReady, NULL);
+    while (ListEntry != NULL) {
+        Target = CONTAINING_RECORD(ListEntry, MAKE_TARGET, RebuildList);
+        YoriLibRemoveListItem(ListEntry);
+        YoriLibInitializeListHead(ListEntry);
+        Target->ReadySequence = MakeContext->ReadySequence;
+        MakeContext->ReadySequence++;
+        MakeContext->ReadyHeap[MakeContext->ReadyHeapCount] = Target;
+        MakeContext->ReadyHeapCount++;
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsReady, NULL);
+    }
+
+    for (Index = MakeContext->ReadyHeapCount / 2; Index > 0; Index--) {
+        MakeReadyHeapSiftDown(MakeContext, Index - 1);
+    }
+
+    return TRUE;
+}
+
+/**
+ Display the critical path observed while executing targets, and how much
+ of the execution time each slot spent running recipes.
+
+ @param MakeContext Pointer to the context.
+
+ @param SlotBusyTime Pointer to an array of performance counter ticks that
+        each slot spent executing recipes.
+
+ @param ExecuteTime The number of performance counter ticks spent executing
+        all targets.
+ */
+VOID
+MakeDisplayExecutionPerf(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PDWORDLONG SlotBusyTime,
+    __in DWORDLONG ExecuteTime
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_TARGET Target;
+    PMAKE_TARGET LastTarget;
+    LARGE_INTEGER Frequency;
+    DWORDLONG Duration;
+    DWORDLONG PathDuration;
+    DWORD Index;
+
+    QueryPerformanceFrequency(&Frequency);
+
+    //
+    //  Find the target that finished last, then walk back through the
+    //  parent that finished last for each target, since that parent is the
+    //  one which delayed it.
+    //
+
+    LastTarget = NULL;
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsFinished, NULL);
+    while (ListEntry != NULL) {
+        Target = CONTAINING_RECORD(ListEntry, MAKE_TARGET, RebuildList);
+        if (LastTarget == NULL || Target->EndTime.QuadPart > LastTarget->EndTime.QuadPart) {
+            LastTarget = Target;
+        }
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsFinished, ListEntry);
+    }
+
+    YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("\nCritical path, last target first:\n"));
+    PathDuration = 0;
+    for (Target = LastTarget; Target != NULL; Target = Target->CriticalPathParent) {
+        if (YoriLibIsListEmpty(&Target->ExecCmds)) {
+            continue;
+        }
+        Duration = (Target->EndTime.QuadPart - Target->StartTime.QuadPart) * 1000 / Frequency.QuadPart;
+        PathDuration = PathDuration + Duration;
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%8lli ms %y\n"), Duration, &Target->HashEntry.Key);
+    }
+    YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Critical path recipes: %lli ms\n\n"), PathDuration);
+
+    for (Index = 0; Index < MakeContext->NumberProcesses; Index++) {
+        Duration = SlotBusyTime[Index] * 1000 / Frequency.QuadPart;
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                      _T("Slot %i busy: %lli ms (%lli%%)\n"),
+                      Index,
+                      Duration,
+                      ExecuteTime > 0?(SlotBusyTime[Index] * 100 / ExecuteTime):0);
+    }
+}
+
 /**
  Update the dependency graph to ensure that any targets waiting for the
- specified target can now be executed.
+ specified target can now be executed.  If the target executed a recipe,
+ its duration is recorded for future estimates.
 
  @param MakeContext Pointer to the context.
 
@@ -836,6 +1419,13 @@ MakeUpdateDependenciesForTarget(
     YoriLibRemoveListItem(&Target->RebuildList);
     YoriLibAppendList(&MakeContext->TargetsFinished, &Target->RebuildList);
 
+    QueryPerformanceCounter(&Target->EndTime);
+    if (YoriLibIsListEmpty(&Target->ExecCmds)) {
+        Target->StartTime.QuadPart = Target->EndTime.QuadPart;
+    } else {
+        MakeRecordRecipeDuration(MakeContext, Target);
+    }
+
     ListEntry = NULL;
     ListEntry = YoriLibGetNextListEntry(&Target->ChildDependents, ListEntry);
     while (ListEntry != NULL) {
@@ -843,8 +1433,10 @@ MakeUpdateDependenciesForTarget(
         if (Dependency->Child->RebuildRequired) {
             Dependency->Child->NumberParentsToBuild--;
             if (Dependency->Child->NumberParentsToBuild == 0) {
+                Dependency->Child->CriticalPathParent = Target;
                 YoriLibRemoveListItem(&Dependency->Child->RebuildList);
-                YoriLibAppendList(&MakeContext->TargetsReady, &Dependency->Child->RebuildList);
+                YoriLibInitializeListHead(&Dependency->Child->RebuildList);
+                MakeInsertReadyTarget(MakeContext, Dependency->Child);
             }
         }
         ListEntry = YoriLibGetNextListEntry(&Target->ChildDependents, ListEntry);
@@ -975,21 +1567,19 @@ MakeCompleteReadyWithNoRecipe(
     __in PMAKE_CONTEXT MakeContext
     )
 {
-    PYORI_LIST_ENTRY ListEntry;
     PMAKE_TARGET Target;
     BOOLEAN RemovedItem;
 
     RemovedItem = FALSE;
-    ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsReady, NULL);
-    while (ListEntry != NULL) {
-        Target = CONTAINING_RECORD(ListEntry, MAKE_TARGET, RebuildList);
+    while (MakeContext->ReadyHeapCount > 0) {
+        Target = MakeContext->ReadyHeap[0];
         if (YoriLibIsListEmpty(&Target->ExecCmds)) {
             RemovedItem = TRUE;
+            MakeRemoveReadyTarget(MakeContext);
             MakeUpdateDependenciesForTarget(MakeContext, Target);
         } else {
             break;
         }
-        ListEntry = YoriLibGetNextListEntry(&MakeContext->TargetsReady, NULL);
     }
 
     return RemovedItem;
@@ -1012,15 +1602,31 @@ MakeExecuteRequiredTargets(
     DWORD Index;
     HANDLE *ProcessHandleArray;
     PMAKE_CHILD_RECIPE ChildRecipeArray;
+    PMAKE_TARGET Target;
+    PDWORDLONG SlotBusyTime;
+    DWORDLONG SlotsAllocated;
+    DWORDLONG TestMask;
+    DWORD Slot;
+    LARGE_INTEGER StartTime;
+    LARGE_INTEGER EndTime;
     BOOLEAN Result;
     BOOLEAN MoveToNextTarget;
     BOOLEAN TargetFailureObserved;
 
     NumberActiveProcesses = 0;
     TargetFailureObserved = FALSE;
+    SlotsAllocated = 0;
+
+    SlotBusyTime = YoriLibMalloc(MakeContext->NumberProcesses * sizeof(DWORDLONG));
+    if (SlotBusyTime == NULL) {
+        return FALSE;
+    }
+
+    ZeroMemory(SlotBusyTime, MakeContext->NumberProcesses * sizeof(DWORDLONG));
 
     ProcessHandleArray = YoriLibMalloc(MakeContext->NumberProcesses * sizeof(HANDLE));
     if (ProcessHandleArray == NULL) {
+        YoriLibFree(SlotBusyTime);
         return FALSE;
     }
 
@@ -1029,16 +1635,49 @@ MakeExecuteRequiredTargets(
     ChildRecipeArray = YoriLibMalloc(MakeContext->NumberProcesses * sizeof(MAKE_CHILD_RECIPE));
     if (ChildRecipeArray == NULL) {
         YoriLibFree(ProcessHandleArray);
+        YoriLibFree(SlotBusyTime);
         return FALSE;
     }
 
     ZeroMemory(ChildRecipeArray, MakeContext->NumberProcesses * sizeof(MAKE_CHILD_RECIPE));
     Result = TRUE;
 
+    //
+    //  Estimate the cost of each target and launch the targets that start
+    //  the longest chains first, so the critical path does not end up as
+    //  the tail of the build.
+    //
+
+    if (!MakePrioritizeReadyTargets(MakeContext)) {
+        YoriLibFree(ChildRecipeArray);
+        YoriLibFree(ProcessHandleArray);
+        YoriLibFree(SlotBusyTime);
+        return FALSE;
+    }
+    QueryPerformanceCounter(&StartTime);
+
     while (TRUE) {
 
-        while (NumberActiveProcesses < MakeContext->NumberProcesses && !YoriLibIsListEmpty(&MakeContext->TargetsReady)) {
+        while (NumberActiveProcesses < MakeContext->NumberProcesses && MakeContext->ReadyHeapCount > 0) {
             if (!MakeCompleteReadyWithNoRecipe(MakeContext)) {
+
+                //
+                //  Find a free slot.  Since there are as many slots as
+                //  processes, one should always be available.
+                //
+
+                for (Slot = 0; Slot < MakeContext->NumberProcesses; Slot++) {
+                    TestMask = 1;
+                    TestMask = TestMask << Slot;
+                    if ((SlotsAllocated & TestMask) == 0) {
+                        break;
+                    }
+                }
+
+                ASSERT(Slot < MakeContext->NumberProcesses);
+                SlotsAllocated = SlotsAllocated | TestMask;
+                ChildRecipeArray[NumberActiveProcesses].Slot = Slot;
+
                 if (!MakeLaunchNextTarget(MakeContext, &ChildRecipeArray[NumberActiveProcesses])) {
                     Result = FALSE;
                     goto Drain;
@@ -1047,7 +1686,7 @@ MakeExecuteRequiredTargets(
             }
         }
 
-        while (NumberActiveProcesses == MakeContext->NumberProcesses || YoriLibIsListEmpty(&MakeContext->TargetsReady)) {
+        while (NumberActiveProcesses == MakeContext->NumberProcesses || MakeContext->ReadyHeapCount == 0) {
 
             if (NumberActiveProcesses == 0) {
                 break;
@@ -1101,8 +1740,15 @@ MakeExecuteRequiredTargets(
             //
 
             if (MoveToNextTarget) {
+                Target = ChildRecipeArray[Index].Target;
+                Slot = ChildRecipeArray[Index].Slot;
+                TestMask = 1;
+                TestMask = TestMask << Slot;
+                SlotsAllocated = SlotsAllocated & ~(TestMask);
+
                 if (Result) {
-                    MakeUpdateDependenciesForTarget(MakeContext, ChildRecipeArray[Index].Target);
+                    MakeUpdateDependenciesForTarget(MakeContext, Target);
+                    SlotBusyTime[Slot] = SlotBusyTime[Slot] + Target->EndTime.QuadPart - Target->StartTime.QuadPart;
                 } else {
                     MakeRecipeCompletion(MakeContext, &ChildRecipeArray[Index]);
                 }
@@ -1138,7 +1784,7 @@ MakeExecuteRequiredTargets(
         //  be anything left to do or something is horribly wrong.
         //
 
-        if (NumberActiveProcesses == 0 && YoriLibIsListEmpty(&MakeContext->TargetsReady)) {
+        if (NumberActiveProcesses == 0 && MakeContext->ReadyHeapCount == 0) {
             ASSERT(MakeContext->KeepGoing || YoriLibIsListEmpty(&MakeContext->TargetsWaiting));
             break;
         }
@@ -1146,6 +1792,9 @@ MakeExecuteRequiredTargets(
 
     if (TargetFailureObserved) {
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Failures encountered, build incomplete\n"));
+    } else if (MakeContext->PerfDisplay) {
+        QueryPerformanceCounter(&EndTime);
+        MakeDisplayExecutionPerf(MakeContext, SlotBusyTime, EndTime.QuadPart - StartTime.QuadPart);
     }
 
 Drain:
@@ -1182,8 +1831,14 @@ Drain:
         NumberActiveProcesses--;
     }
 
+    YoriLibFree(MakeContext->ReadyHeap);
+    MakeContext->ReadyHeap = NULL;
+    MakeContext->ReadyHeapCount = 0;
+    MakeContext->ReadyHeapAllocated = 0;
+
     YoriLibFree(ChildRecipeArray);
     YoriLibFree(ProcessHandleArray);
+    YoriLibFree(SlotBusyTime);
 
     return Result;
 }
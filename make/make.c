@@ -45,8 +45,8 @@ CHAR strMakeHelpText[] =
         "   -k             Keep executing jobs after errors\n"
         "   -m             Perform tasks at low priority\n"
         "   -mm            Perform tasks at very low priority\n"
-        "   -perf          Display how much time was spent in each phase of processing\n"
-        "   -pru           Keep a cache of preprocessor recently executed results\n"
+        "   -perf          Display time spent in each phase, the critical path and slot use\n"
+        "   -pru           Keep a cache of preprocessor results and recipe durations\n"
         "   -s             Silently launch child processes\n";
 
 
@@ -381,6 +381,9 @@ ENTRYPOINT(
     YoriLibInitializeListHead(&MakeContext.TargetsReady);
     YoriLibInitializeListHead(&MakeContext.TargetsWaiting);
     YoriLibInitializeListHead(&MakeContext.PreprocessorCacheList);
+    YoriLibInitializeListHead(&MakeContext.RecipeStatsList);
+    YoriLibInitializeListHead(&MakeContext.DirectoryCacheList);
+    YoriLibInitializeListHead(&MakeContext.SpeculativeCmdList);
     YoriLibInitEmptyString(&FullFileName);
     Priority = MakePriorityNormal;
     ExplicitTargetFound = FALSE;
@@ -449,6 +452,12 @@ ENTRYPOINT(
         goto Cleanup;
     }
 
+    MakeContext.DirectoryCache = YoriLibAllocateHashTable(250);
+    if (MakeContext.DirectoryCache == NULL) {
+        Result = EXIT_FAILURE;
+        goto Cleanup;
+    }
+
     for (i = 1; i < ArgC; i++) {
 
         ArgumentUnderstood = FALSE;
@@ -497,6 +506,13 @@ ENTRYPOINT(
                         goto Cleanup;
                     }
                 }
+                if (MakeContext.RecipeStats == NULL) {
+                    MakeContext.RecipeStats = YoriLibAllocateHashTable(1000);
+                    if (MakeContext.RecipeStats == NULL) {
+                        Result = EXIT_FAILURE;
+                        goto Cleanup;
+                    }
+                }
                 ArgumentUnderstood = TRUE;
 
             } else if (YoriLibCompareStringLitIns(&Arg, _T("s")) == 0) {
@@ -617,6 +633,16 @@ ENTRYPOINT(
         MakeContext.NumberProcesses = 64;
     }
 
+    //
+    //  If more than one process can execute, preprocessor commands can be
+    //  launched ahead of the preprocessor.  If the table can't be
+    //  allocated, commands are executed as they are reached.
+    //
+
+    if (MakeContext.NumberProcesses > 1) {
+        MakeContext.SpeculativeCmds = YoriLibAllocateHashTable(50);
+    }
+
     //
     //  Find the directory containing the makefile and populate it as the
     //  initial scope.
@@ -722,14 +748,18 @@ ENTRYPOINT(
 #endif
 
     //
-    //  When using a cache, try to load any cached preprocessor conditions for
-    //  this makefile.
+    //  When using a cache, try to load any cached preprocessor conditions
+    //  and recipe durations for this makefile.
     //
 
     if (MakeContext.PreprocessorCache != NULL) {
         MakeLoadPreprocessorCacheEntries(&MakeContext, &FullFileName);
     }
 
+    if (MakeContext.RecipeStats != NULL) {
+        MakeLoadRecipeStats(&MakeContext, &FullFileName);
+    }
+
     hStream = CreateFile(FullFileName.StartOfString, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
     if (hStream == INVALID_HANDLE_VALUE) {
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("No makefile found\n"));
@@ -743,6 +773,7 @@ ENTRYPOINT(
 
     QueryPerformanceCounter(&StartTime);
     MakeProcessStream(hStream, &MakeContext, &FullFileName);
+    MakeDeleteAllSpeculativeCmds(&MakeContext);
     QueryPerformanceCounter(&EndTime);
 
     MakeContext.TimeInPreprocessor = EndTime.QuadPart - StartTime.QuadPart;
@@ -815,6 +846,13 @@ ENTRYPOINT(
     QueryPerformanceCounter(&EndTime);
     MakeContext.TimeBuildingGraph = EndTime.QuadPart - StartTime.QuadPart;
 
+    //
+    //  Executing targets will change the file system, so cached directory
+    //  contents are no longer needed or accurate.
+    //
+
+    MakeDeleteDirectoryCache(&MakeContext);
+
     //
     //  Execute the tasks
     //
@@ -854,8 +892,19 @@ Cleanup:
         YoriLibFreeEmptyHashTable(MakeContext.Targets);
     }
 
+    if (MakeContext.DirectoryCache != NULL) {
+        MakeDeleteDirectoryCache(&MakeContext);
+        YoriLibFreeEmptyHashTable(MakeContext.DirectoryCache);
+    }
+
+    if (MakeContext.SpeculativeCmds != NULL) {
+        MakeDeleteAllSpeculativeCmds(&MakeContext);
+        YoriLibFreeEmptyHashTable(MakeContext.SpeculativeCmds);
+    }
+
     MakeDeleteAllScopes(&MakeContext);
     MakeSaveAndDeleteAllPreprocessorCacheEntries(&MakeContext, &FullFileName);
+    MakeSaveAndDeleteRecipeStats(&MakeContext, &FullFileName);
 
     YoriLibFreeStringContents(&FullFileName);
 
@@ -887,6 +936,7 @@ Cleanup:
         MakeContext.TimeInCleanup = MakeContext.TimeInCleanup * 1000 / Frequency.QuadPart;
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("\n"));
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Time in preprocessor child processes: %lli ms\n"), MakeContext.TimeInPreprocessorCreateProcess);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Preprocessor commands launched early: %i, used: %i\n"), MakeContext.SpeculativeCmdsLaunched, MakeContext.SpeculativeCmdsUsed);
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Time in preprocessor: %lli ms\n"), MakeContext.TimeInPreprocessor);
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Time building graph: %lli ms\n"), MakeContext.TimeBuildingGraph);
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Time executing commands: %lli ms\n"), MakeContext.TimeInExecute);
@@ -113,6 +113,133 @@ typedef struct _MAKE_PREPROC_EXEC_CACHE_ENTRY {
 
 } MAKE_PREPROC_EXEC_CACHE_ENTRY, *PMAKE_PREPROC_EXEC_CACHE_ENTRY;
 
+/**
+ A preprocessor command which has been launched speculatively, before the
+ preprocessor reached the line that evaluates it.  When the preprocessor
+ needs the result of a command, it can use the result of a matching
+ speculative command rather than launching it again.
+ */
+typedef struct _MAKE_PREPROC_SPECULATIVE_CMD {
+
+    /**
+     The hash entry of the command.  The key is the command after variable
+     expansion.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     A list of all speculative commands to facilitate efficient teardown.
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     The parsed command context.
+     */
+    YORI_LIBSH_CMD_CONTEXT CmdContext;
+
+    /**
+     The execution plan for the command.
+     */
+    YORI_LIBSH_EXEC_PLAN ExecPlan;
+
+    /**
+     A handle to the final process in the plan, whose exit code is the
+     result of the command.  This is owned by the execution plan.
+     */
+    HANDLE ProcessHandle;
+
+    /**
+     The exit code of the command.  Only meaningful if Completed is TRUE.
+     */
+    DWORD ExitCode;
+
+    /**
+     TRUE if the command has completed and ExitCode is valid.
+     */
+    BOOLEAN Completed;
+
+} MAKE_PREPROC_SPECULATIVE_CMD, *PMAKE_PREPROC_SPECULATIVE_CMD;
+
+/**
+ A line of a makefile, retained so that the preprocessor can look ahead for
+ commands to launch speculatively without reading the makefile again.
+ */
+typedef struct _MAKE_LOOKAHEAD_LINE {
+
+    /**
+     The line after comments have been removed, continuation lines joined,
+     and whitespace trimmed.
+     */
+    YORI_STRING Line;
+
+    /**
+     The line number of the final line in the makefile that forms this
+     line.
+     */
+    DWORD LineNumber;
+
+    /**
+     TRUE if the line contains a comment marking its commands as probes
+     which have no side effects and can be launched speculatively.
+     */
+    BOOLEAN Probe;
+
+} MAKE_LOOKAHEAD_LINE, *PMAKE_LOOKAHEAD_LINE;
+
+/**
+ The lines of a makefile being preprocessed, loaded the first time the
+ preprocessor looks ahead in it.
+ */
+typedef struct _MAKE_LOOKAHEAD_CACHE {
+
+    /**
+     An array of lines in the makefile which are not empty.
+     */
+    PMAKE_LOOKAHEAD_LINE Lines;
+
+    /**
+     The number of elements in Lines which are populated.
+     */
+    DWORD LineCount;
+
+    /**
+     The number of elements allocated in Lines.
+     */
+    DWORD LinesAllocated;
+
+    /**
+     TRUE if an attempt has been made to load the makefile.  If loading
+     failed, it is not attempted again.
+     */
+    BOOLEAN Loaded;
+
+} MAKE_LOOKAHEAD_CACHE, *PMAKE_LOOKAHEAD_CACHE;
+
+/**
+ A record of how long the recipe for a target took to execute.  These are
+ recorded so that a subsequent compilation can estimate the cost of each
+ target and start the longest chain of targets first.
+ */
+typedef struct _MAKE_RECIPE_STATS_ENTRY {
+
+    /**
+     The hash entry of the target.  The key is the fully qualified target
+     name.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     A list of all entries to facilitate efficient teardown.
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     The time taken to execute the recipe, in milliseconds.
+     */
+    DWORD Duration;
+
+} MAKE_RECIPE_STATS_ENTRY, *PMAKE_RECIPE_STATS_ENTRY;
+
 /**
  The name of the default target within a scope.  This refers to the first
  user defined target within the scope.  Note this name is chosen to be an
@@ -555,6 +682,11 @@ typedef struct _MAKE_TARGET {
      */
     BOOLEAN InferenceRulePseudoTarget;
 
+    /**
+     TRUE if RemainingPathCost has been calculated for this target.
+     */
+    BOOLEAN RemainingPathCostCalculated;
+
     /**
      The timestamp of the file.  This is only meaningful if FileExists is
      TRUE (implying FileProbed is also TRUE.)
@@ -589,6 +721,45 @@ typedef struct _MAKE_TARGET {
      */
     YORI_LIST_ENTRY ExecCmds;
 
+    /**
+     The estimated time to execute the recipe for this target, in
+     milliseconds.  This comes from the recipe stats if this target has
+     been built before.
+     */
+    DWORD EstimatedDuration;
+
+    /**
+     The estimated time to execute this target and the most expensive chain
+     of targets that depend on it, in milliseconds.  Ready targets are
+     launched in descending order of this value.
+     */
+    DWORDLONG RemainingPathCost;
+
+    /**
+     The last parent target to complete, which allowed this target to
+     become ready.  This is used to reconstruct the critical path after
+     execution.
+     */
+    struct _MAKE_TARGET *CriticalPathParent;
+
+    /**
+     The value of MAKE_CONTEXT::ReadySequence when this target became ready
+     to execute.
+     */
+    DWORDLONG ReadySequence;
+
+    /**
+     The performance counter value when the recipe for this target was
+     launched.
+     */
+    LARGE_INTEGER StartTime;
+
+    /**
+     The performance counter value when the recipe for this target
+     completed.
+     */
+    LARGE_INTEGER EndTime;
+
 } MAKE_TARGET, *PMAKE_TARGET;
 
 /**
@@ -687,10 +858,35 @@ typedef struct _MAKE_CONTEXT {
 
     /**
      A list of targets which can be built when there is a processor to
-     build them.
+     build them, populated while the dependency graph is constructed.  These
+     are moved into ReadyHeap before execution begins.
      */
     YORI_LIST_ENTRY TargetsReady;
 
+    /**
+     An array of targets which can be built when there is a processor to
+     build them, arranged as a binary heap so that the target with the
+     highest RemainingPathCost is first.
+     */
+    PMAKE_TARGET *ReadyHeap;
+
+    /**
+     The number of targets currently in ReadyHeap.
+     */
+    YORI_ALLOC_SIZE_T ReadyHeapCount;
+
+    /**
+     The number of elements allocated in ReadyHeap.
+     */
+    YORI_ALLOC_SIZE_T ReadyHeapAllocated;
+
+    /**
+     A counter that is incremented each time a target becomes ready.  This
+     allows targets with equal cost to be launched in the order they became
+     ready.
+     */
+    DWORDLONG ReadySequence;
+
     /**
      A list of targets which need to be built, but cannot be built now due
      to not having dependencies satisfied.
@@ -707,6 +903,66 @@ typedef struct _MAKE_CONTEXT {
      */
     YORI_LIST_ENTRY PreprocessorCacheList;
 
+    /**
+     A hash table of preprocessor commands launched speculatively, keyed by
+     the expanded command.
+     */
+    PYORI_HASH_TABLE SpeculativeCmds;
+
+    /**
+     A list of preprocessor commands launched speculatively, used to
+     facilitate bulk delete.
+     */
+    YORI_LIST_ENTRY SpeculativeCmdList;
+
+    /**
+     The file name of the makefile currently being preprocessed, used to
+     look ahead for preprocessor commands that can be launched
+     speculatively.  NULL if no makefile is being preprocessed.
+     */
+    PYORI_STRING ActiveStreamFileName;
+
+    /**
+     The line number within ActiveStreamFileName currently being
+     preprocessed.
+     */
+    DWORD ActiveStreamLineNumber;
+
+    /**
+     The lines of ActiveStreamFileName, used to look ahead for preprocessor
+     commands that can be launched speculatively.  NULL if no makefile is
+     being preprocessed.
+     */
+    PMAKE_LOOKAHEAD_CACHE ActiveStreamLookahead;
+
+    /**
+     TRUE if the line within ActiveStreamFileName currently being
+     preprocessed is marked as a probe with no side effects.
+     */
+    BOOLEAN ActiveStreamLineIsProbe;
+
+    /**
+     A hash table of recipe durations from previous executions, keyed by
+     target name.
+     */
+    PYORI_HASH_TABLE RecipeStats;
+
+    /**
+     A list of known recipe stats entries, used to facilitate bulk delete.
+     */
+    YORI_LIST_ENTRY RecipeStatsList;
+
+    /**
+     A hash table of directories whose contents have been enumerated, used
+     to determine file existence and timestamps without opening each file.
+     */
+    PYORI_HASH_TABLE DirectoryCache;
+
+    /**
+     A list of enumerated directories, used to facilitate bulk delete.
+     */
+    YORI_LIST_ENTRY DirectoryCacheList;
+
     /**
      Allocations used to generate files to look for when determining which
      inference rules to apply.  Because these are very temporary, they are
@@ -788,6 +1044,17 @@ typedef struct _MAKE_CONTEXT {
      */
     DWORD AllocExpandedLine;
 
+    /**
+     The number of preprocessor commands launched speculatively.
+     */
+    DWORD SpeculativeCmdsLaunched;
+
+    /**
+     The number of speculatively launched preprocessor commands whose
+     results were used.
+     */
+    DWORD SpeculativeCmdsUsed;
+
     /**
      The number of child processes to execute concurrently.  This defaults
      to the number of logical processors, but is limited to 64 due to
@@ -906,6 +1173,11 @@ MakeShExecuteInProc(
     __in PYORI_LIBSH_SINGLE_EXEC_CONTEXT ExecContext
     );
 
+VOID
+MakeShCancelExecPlan(
+    __in PYORI_LIBSH_EXEC_PLAN ExecPlan
+    );
+
 DWORD
 MakeShExecExecPlan(
     __in PYORI_LIBSH_EXEC_PLAN ExecPlan,
@@ -933,6 +1205,14 @@ MakeProcessStream(
     __in PYORI_STRING FileName
     );
 
+__success(return)
+BOOLEAN
+MakeGetCacheFileNameFromMakeFileName(
+    __in PYORI_STRING MakeFileName,
+    __in LPCTSTR Extension,
+    __out PYORI_STRING CacheFileName
+    );
+
 VOID
 MakeLoadPreprocessorCacheEntries(
     __inout PMAKE_CONTEXT MakeContext,
@@ -945,6 +1225,11 @@ MakeSaveAndDeleteAllPreprocessorCacheEntries(
     __in PYORI_STRING MakeFileName
     );
 
+VOID
+MakeDeleteAllSpeculativeCmds(
+    __inout PMAKE_CONTEXT MakeContext
+    );
+
 VOID
 MakeDeleteInlineFiles(
     __in PMAKE_CONTEXT MakeContext
@@ -986,6 +1271,29 @@ MakeDeleteAllScopes(
     __inout PMAKE_CONTEXT MakeContext
     );
 
+// *** DIRCACHE.C ***
+
+VOID
+MakeDeleteDirectoryCache(
+    __in PMAKE_CONTEXT MakeContext
+    );
+
+__success(return)
+BOOLEAN
+MakeLookupFileInDirectoryCache(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING FullPath,
+    __out PBOOLEAN FileExists,
+    __out PDWORD FileAttributes,
+    __out PLARGE_INTEGER ModifiedTime
+    );
+
+BOOLEAN
+MakeDoesFileExist(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING FullPath
+    );
+
 // *** TARGET.C ***
 
 VOID
@@ -1070,3 +1378,15 @@ BOOLEAN
 MakeExecuteRequiredTargets(
     __in PMAKE_CONTEXT MakeContext
     );
+
+VOID
+MakeLoadRecipeStats(
+    __inout PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING MakeFileName
+    );
+
+VOID
+MakeSaveAndDeleteRecipeStats(
+    __inout PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING MakeFileName
+    );
@@ -673,26 +673,33 @@ MakeBeginNestedConditionFalse(
 }
 
 /**
- Generate the name of the preprocessor cache file from the specified
- make file name.
+ Generate the name of a cache file from the specified make file name.
 
  @param MakeFileName Pointer to the make file name.
 
+ @param Extension Pointer to the extension to append to the make file name,
+        including the period.
+
  @param CacheFileName On successful completion, updated to contain a newly
         allocated string referring to the file name of the cache file.
 
  @return TRUE to indicate success, FALSE to indicate failure.
  */
+__success(return)
 BOOLEAN
 MakeGetCacheFileNameFromMakeFileName(
     __in PYORI_STRING MakeFileName,
+    __in LPCTSTR Extension,
     __out PYORI_STRING CacheFileName
     )
 {
+    YORI_ALLOC_SIZE_T ExtensionLength;
+
     YoriLibInitEmptyString(CacheFileName);
     if (MakeFileName->LengthInChars > 0) {
-        if (YoriLibAllocateString(CacheFileName, MakeFileName->LengthInChars + sizeof(".pru"))) {
-            CacheFileName->LengthInChars = YoriLibSPrintf(CacheFileName->StartOfString, _T("%y.pru"), MakeFileName);
+        ExtensionLength = (YORI_ALLOC_SIZE_T)_tcslen(Extension);
+        if (YoriLibAllocateString(CacheFileName, MakeFileName->LengthInChars + ExtensionLength + 1)) {
+            CacheFileName->LengthInChars = YoriLibSPrintf(CacheFileName->StartOfString, _T("%y%s"), MakeFileName, Extension);
             return TRUE;
         }
     }
@@ -723,7 +730,7 @@ MakeLoadPreprocessorCacheEntries(
     HANDLE hCache;
     PVOID LineContext = NULL;
 
-    if (!MakeGetCacheFileNameFromMakeFileName(MakeFileName, &CacheFileName)) {
+    if (!MakeGetCacheFileNameFromMakeFileName(MakeFileName, _T(".pru"), &CacheFileName)) {
         return;
     }
 
@@ -831,7 +838,7 @@ MakeSaveAndDeleteAllPreprocessorCacheEntries(
 
     hCache = NULL;
     YoriLibInitEmptyString(&CacheFileName);
-    if (MakeGetCacheFileNameFromMakeFileName(MakeFileName, &CacheFileName)) {
+    if (MakeGetCacheFileNameFromMakeFileName(MakeFileName, _T(".pru"), &CacheFileName)) {
         hCache = CreateFile(CacheFileName.StartOfString, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
         if (hCache == INVALID_HANDLE_VALUE) {
             hCache = NULL;
@@ -1023,6 +1030,893 @@ MakeAddToPreprocessorCache(
     YoriLibFreeStringContents(&Key);
 }
 
+/**
+ Free a speculatively launched preprocessor command.  If the command is
+ still executing, this waits for it to complete.
+
+ @param Entry Pointer to the speculative command to free.
+ */
+VOID
+MakeFreeSpeculativeCmd(
+    __in PMAKE_PREPROC_SPECULATIVE_CMD Entry
+    )
+{
+    PYORI_LIBSH_SINGLE_EXEC_CONTEXT ExecContext;
+
+    YoriLibRemoveListItem(&Entry->ListEntry);
+    YoriLibHashRemoveByEntry(&Entry->HashEntry);
+
+    if (YoriLibIsOperationCancelled()) {
+        MakeShCancelExecPlan(&Entry->ExecPlan);
+    }
+
+    ExecContext = Entry->ExecPlan.FirstCmd;
+    while (ExecContext != NULL) {
+        if (ExecContext->hProcess != NULL) {
+            WaitForSingleObject(ExecContext->hProcess, INFINITE);
+        }
+        ExecContext = ExecContext->NextProgram;
+    }
+
+    YoriLibShFreeExecPlan(&Entry->ExecPlan);
+    YoriLibShFreeCmdContext(&Entry->CmdContext);
+    YoriLibFree(Entry);
+}
+
+/**
+ Free all speculatively launched preprocessor commands.  This is used when
+ preprocessing is complete, or when a command with side effects is about to
+ execute, which may invalidate the results of commands that were launched
+ before it.
+
+ @param MakeContext Pointer to the context.
+ */
+VOID
+MakeDeleteAllSpeculativeCmds(
+    __inout PMAKE_CONTEXT MakeContext
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_PREPROC_SPECULATIVE_CMD Entry;
+
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->SpeculativeCmdList, NULL);
+    while (ListEntry != NULL) {
+        Entry = CONTAINING_RECORD(ListEntry, MAKE_PREPROC_SPECULATIVE_CMD, ListEntry);
+        MakeFreeSpeculativeCmd(Entry);
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->SpeculativeCmdList, NULL);
+    }
+}
+
+/**
+ Check for any speculatively launched preprocessor commands that have
+ completed, capture their exit codes, and return the number of commands
+ which are still executing.
+
+ @param MakeContext Pointer to the context.
+
+ @return The number of speculatively launched commands still executing.
+ */
+DWORD
+MakeReapSpeculativeCmds(
+    __in PMAKE_CONTEXT MakeContext
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PMAKE_PREPROC_SPECULATIVE_CMD Entry;
+    DWORD StillRunning;
+
+    StillRunning = 0;
+    ListEntry = YoriLibGetNextListEntry(&MakeContext->SpeculativeCmdList, NULL);
+    while (ListEntry != NULL) {
+        Entry = CONTAINING_RECORD(ListEntry, MAKE_PREPROC_SPECULATIVE_CMD, ListEntry);
+        if (!Entry->Completed) {
+            if (WaitForSingleObject(Entry->ProcessHandle, 0) == WAIT_OBJECT_0) {
+                GetExitCodeProcess(Entry->ProcessHandle, &Entry->ExitCode);
+                Entry->Completed = TRUE;
+            } else {
+                StillRunning++;
+            }
+        }
+        ListEntry = YoriLibGetNextListEntry(&MakeContext->SpeculativeCmdList, ListEntry);
+    }
+
+    return StillRunning;
+}
+
+/**
+ Return TRUE if a redirection target refers to the NUL device.  The shell
+ parser records a redirect to NUL as a redirect to a file with that name, so
+ this is how output which is discarded is recognized.
+
+ @param FileName Pointer to the redirection target.
+
+ @return TRUE if the target is the NUL device, FALSE if it is not.
+ */
+BOOLEAN
+MakeIsRedirectToNul(
+    __in PYORI_STRING FileName
+    )
+{
+    YORI_STRING NameToCheck;
+
+    YoriLibInitEmptyString(&NameToCheck);
+    NameToCheck.StartOfString = FileName->StartOfString;
+    NameToCheck.LengthInChars = FileName->LengthInChars;
+
+    if (YoriLibIsPathPrefixed(&NameToCheck)) {
+        NameToCheck.StartOfString += sizeof("\\\\.\\") - 1;
+        NameToCheck.LengthInChars -= sizeof("\\\\.\\") - 1;
+    }
+
+    if (YoriLibCompareStringLitIns(&NameToCheck, _T("NUL")) == 0) {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ Determine whether an execution plan can be launched before the preprocessor
+ reaches it.  Builtins execute within this process and are not safe to run
+ concurrently with the preprocessor.  Since a command can be launched
+ speculatively and its result discarded, only plans which consist of
+ external programs connected by pipes, whose final output is discarded, are
+ launched.  This describes the typical probe, such as testing whether a
+ compiler supports a flag, while excluding plans that redirect to files.
+ Note this cannot determine that the programs themselves have no side
+ effects, so plans are only launched speculatively if the makefile also
+ marks them as probes.
+
+ @param ExecPlan Pointer to the execution plan.
+
+ @return TRUE if the plan can be launched speculatively, FALSE if it should
+         only be executed when the preprocessor reaches it.
+ */
+BOOLEAN
+MakeIsPlanSafeToSpeculate(
+    __in PYORI_LIBSH_EXEC_PLAN ExecPlan
+    )
+{
+    PYORI_LIBSH_SINGLE_EXEC_CONTEXT ExecContext;
+
+    ExecContext = ExecPlan->FirstCmd;
+    if (ExecContext == NULL) {
+        return FALSE;
+    }
+
+    while (ExecContext != NULL) {
+        if (ExecContext->CmdToExec.ArgC == 0 ||
+            YoriLibShLookupBuiltinByName(&ExecContext->CmdToExec.ArgV[0]) != NULL) {
+
+            return FALSE;
+        }
+
+        if (ExecContext->StdErrType == StdErrTypeOverwrite) {
+            if (!MakeIsRedirectToNul(&ExecContext->StdErr.Overwrite.FileName)) {
+                return FALSE;
+            }
+        } else if (ExecContext->StdErrType != StdErrTypeDefault &&
+                   ExecContext->StdErrType != StdErrTypeNull &&
+                   ExecContext->StdErrType != StdErrTypeStdOut) {
+
+            return FALSE;
+        }
+
+        if (ExecContext->NextProgram != NULL) {
+            if (ExecContext->NextProgramType != NextProgramExecConcurrently ||
+                ExecContext->StdOutType != StdOutTypePipe) {
+
+                return FALSE;
+            }
+        } else if (ExecContext->StdOutType == StdOutTypeOverwrite) {
+            if (!MakeIsRedirectToNul(&ExecContext->StdOut.Overwrite.FileName)) {
+                return FALSE;
+            }
+        } else if (ExecContext->StdOutType != StdOutTypeNull) {
+            return FALSE;
+        }
+
+        ExecContext = ExecContext->NextProgram;
+    }
+
+    return TRUE;
+}
+
+/**
+ Launch a preprocessor command speculatively, without waiting for it to
+ complete.  Processes are launched on this thread, one plan after another,
+ so that pipe handles from one plan are never inherited into another.
+
+ @param MakeContext Pointer to the context.
+
+ @param Cmd Pointer to the command to launch, after variable expansion.
+
+ @return TRUE to indicate the command was launched, FALSE if it was not.
+ */
+BOOLEAN
+MakeLaunchSpeculativeCmd(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING Cmd
+    )
+{
+    PMAKE_PREPROC_SPECULATIVE_CMD Entry;
+    PYORI_LIBSH_SINGLE_EXEC_CONTEXT ExecContext;
+    PYORI_LIBSH_SINGLE_EXEC_CONTEXT LastContext;
+    YORI_STRING FoundInPath;
+    YORI_STRING Key;
+    BOOL FailedInRedirection;
+
+    if (YoriLibHashLookupByKey(MakeContext->SpeculativeCmds, Cmd) != NULL) {
+        return FALSE;
+    }
+
+    Entry = YoriLibMalloc(sizeof(MAKE_PREPROC_SPECULATIVE_CMD));
+    if (Entry == NULL) {
+        return FALSE;
+    }
+
+    ZeroMemory(Entry, sizeof(MAKE_PREPROC_SPECULATIVE_CMD));
+
+    //
+    //  The command refers to the caller's line buffer, so copy it so the
+    //  hash package has an allocation that won't go away
+    //
+
+    if (!YoriLibAllocateString(&Key, Cmd->LengthInChars)) {
+        YoriLibFree(Entry);
+        return FALSE;
+    }
+
+    memcpy(Key.StartOfString, Cmd->StartOfString, Cmd->LengthInChars * sizeof(TCHAR));
+    Key.LengthInChars = Cmd->LengthInChars;
+
+    if (!YoriLibShParseCmdlineToCmdContext(Cmd, 0, &Entry->CmdContext)) {
+        YoriLibFreeStringContents(&Key);
+        YoriLibFree(Entry);
+        return FALSE;
+    }
+
+    if (!YoriLibShParseCmdContextToExecPlan(&Entry->CmdContext, &Entry->ExecPlan, NULL, NULL, NULL, NULL)) {
+        YoriLibShFreeCmdContext(&Entry->CmdContext);
+        YoriLibFreeStringContents(&Key);
+        YoriLibFree(Entry);
+        return FALSE;
+    }
+
+    if (!MakeIsPlanSafeToSpeculate(&Entry->ExecPlan)) {
+        goto Fail;
+    }
+
+    //
+    //  Resolve every program before launching any, so a program that can't
+    //  be found doesn't leave a partially launched pipeline.
+    //
+
+    ExecContext = Entry->ExecPlan.FirstCmd;
+    while (ExecContext != NULL) {
+        YoriLibInitEmptyString(&FoundInPath);
+        if (!YoriLibLocateExecutableInPath(&ExecContext->CmdToExec.ArgV[0], NULL, NULL, &FoundInPath)) {
+            goto Fail;
+        }
+        if (FoundInPath.LengthInChars == 0) {
+            YoriLibFreeStringContents(&FoundInPath);
+            goto Fail;
+        }
+        YoriLibFreeStringContents(&ExecContext->CmdToExec.ArgV[0]);
+        memcpy(&ExecContext->CmdToExec.ArgV[0], &FoundInPath, sizeof(YORI_STRING));
+        ExecContext = ExecContext->NextProgram;
+    }
+
+    LastContext = NULL;
+    ExecContext = Entry->ExecPlan.FirstCmd;
+    while (ExecContext != NULL) {
+        ExecContext->WaitForCompletion = FALSE;
+        FailedInRedirection = FALSE;
+        if (YoriLibShCreateProcess(ExecContext, NULL, &FailedInRedirection) != NO_ERROR) {
+            YoriLibShCleanupFailedProcessLaunch(ExecContext);
+            MakeShCancelExecPlan(&Entry->ExecPlan);
+            goto Fail;
+        }
+        LastContext = ExecContext;
+        ExecContext = ExecContext->NextProgram;
+    }
+
+    ASSERT(LastContext != NULL && LastContext->hProcess != NULL);
+    Entry->ProcessHandle = LastContext->hProcess;
+
+#if MAKE_DEBUG_PREPROCESSOR_CREATEPROCESS
+    YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Speculatively launched preprocessor command: %y\n"), Cmd);
+#endif
+
+    YoriLibHashInsertByKey(MakeContext->SpeculativeCmds, &Key, Entry, &Entry->HashEntry);
+    YoriLibAppendList(&MakeContext->SpeculativeCmdList, &Entry->ListEntry);
+    YoriLibFreeStringContents(&Key);
+    MakeContext->SpeculativeCmdsLaunched++;
+    return TRUE;
+
+Fail:
+    YoriLibShFreeExecPlan(&Entry->ExecPlan);
+    YoriLibShFreeCmdContext(&Entry->CmdContext);
+    YoriLibFreeStringContents(&Key);
+    YoriLibFree(Entry);
+    return FALSE;
+}
+
+/**
+ Return TRUE if a makefile line references a variable whose name is in a
+ list of variable names.  This is used to avoid launching a command whose
+ expansion is expected to change before the preprocessor reaches it.
+
+ @param Line Pointer to the unexpanded line.
+
+ @param VariableNames Pointer to a string containing variable names, each
+        terminated with a semicolon.
+
+ @return TRUE if the line references one of the variables, FALSE if it
+         does not.
+ */
+BOOLEAN
+MakeDoesLineReferenceVariables(
+    __in PYORI_STRING Line,
+    __in PYORI_STRING VariableNames
+    )
+{
+    YORI_STRING Reference;
+    YORI_STRING Name;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T NameStart;
+    YORI_ALLOC_SIZE_T NameIndex;
+
+    if (VariableNames->LengthInChars == 0) {
+        return FALSE;
+    }
+
+    for (Index = 0; Index + 1 < Line->LengthInChars; Index++) {
+        if (Line->StartOfString[Index] != '$' ||
+            Line->StartOfString[Index + 1] != '(') {
+
+            continue;
+        }
+
+        YoriLibInitEmptyString(&Reference);
+        Reference.StartOfString = &Line->StartOfString[Index + 2];
+        while (Index + 2 + Reference.LengthInChars < Line->LengthInChars &&
+               Reference.StartOfString[Reference.LengthInChars] != ')' &&
+               Reference.StartOfString[Reference.LengthInChars] != ':') {
+
+            Reference.LengthInChars++;
+        }
+
+        NameStart = 0;
+        for (NameIndex = 0; NameIndex < VariableNames->LengthInChars; NameIndex++) {
+            if (VariableNames->StartOfString[NameIndex] == ';') {
+                YoriLibInitEmptyString(&Name);
+                Name.StartOfString = &VariableNames->StartOfString[NameStart];
+                Name.LengthInChars = NameIndex - NameStart;
+                if (YoriLibCompareStringIns(&Name, &Reference) == 0) {
+                    return TRUE;
+                }
+                NameStart = NameIndex + 1;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ Append a variable name to a list of variable names, each terminated with a
+ semicolon.
+
+ @param VariableNames Pointer to the list of variable names.  This may be
+        reallocated within this routine.
+
+ @param Name Pointer to the variable name to append.
+
+ @return TRUE to indicate success, FALSE if the name could not be appended,
+         including if the name cannot be determined without expansion.
+ */
+BOOLEAN
+MakeAppendVariableName(
+    __inout PYORI_STRING VariableNames,
+    __in PYORI_STRING Name
+    )
+{
+    if (Name->LengthInChars == 0 ||
+        YoriLibFindLeftMostCharacter(Name, '$') != NULL ||
+        YoriLibFindLeftMostCharacter(Name, ';') != NULL) {
+
+        return FALSE;
+    }
+
+    if (VariableNames->LengthInChars + Name->LengthInChars + 1 > VariableNames->LengthAllocated) {
+        if (!YoriLibReallocString(VariableNames, (VariableNames->LengthInChars + Name->LengthInChars + 1) * 2)) {
+            return FALSE;
+        }
+    }
+
+    memcpy(&VariableNames->StartOfString[VariableNames->LengthInChars], Name->StartOfString, Name->LengthInChars * sizeof(TCHAR));
+    VariableNames->LengthInChars = VariableNames->LengthInChars + Name->LengthInChars;
+    VariableNames->StartOfString[VariableNames->LengthInChars] = ';';
+    VariableNames->LengthInChars++;
+    return TRUE;
+}
+
+/**
+ Return TRUE if a makefile line contains a comment marking the commands in
+ the line as probes which have no side effects.  Commands are only launched
+ speculatively if they are marked this way, since whether a command has side
+ effects can't be determined by looking at it.  The marker is a comment, so
+ other make implementations ignore it.
+
+ @param Line Pointer to the line, before comments are removed.
+
+ @return TRUE if the line is marked as a probe, FALSE if it is not.
+ */
+BOOLEAN
+MakeIsLineMarkedAsProbe(
+    __in PYORI_STRING Line
+    )
+{
+    YORI_STRING Comment;
+    YORI_STRING Marker;
+    YORI_ALLOC_SIZE_T Index;
+
+    for (Index = 0; Index < Line->LengthInChars; Index++) {
+        if (Line->StartOfString[Index] == '#') {
+            break;
+        }
+    }
+
+    if (Index == Line->LengthInChars) {
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(&Comment);
+    Comment.StartOfString = &Line->StartOfString[Index + 1];
+    Comment.LengthInChars = Line->LengthInChars - Index - 1;
+    YoriLibConstantString(&Marker, _T("ymake:probe"));
+
+    if (YoriLibFindFirstMatchSubstrIns(&Comment, 1, &Marker, NULL) != NULL) {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ Free the lines of a makefile that were loaded to look ahead for
+ preprocessor commands.
+
+ @param Lookahead Pointer to the lookahead cache.  The structure itself is
+        owned by the caller and is not freed.
+ */
+VOID
+MakeFreeLookaheadCache(
+    __inout PMAKE_LOOKAHEAD_CACHE Lookahead
+    )
+{
+    DWORD Index;
+
+    for (Index = 0; Index < Lookahead->LineCount; Index++) {
+        YoriLibFreeStringContents(&Lookahead->Lines[Index].Line);
+    }
+
+    if (Lookahead->Lines != NULL) {
+        YoriLibFree(Lookahead->Lines);
+        Lookahead->Lines = NULL;
+    }
+
+    Lookahead->LineCount = 0;
+    Lookahead->LinesAllocated = 0;
+}
+
+/**
+ Read a makefile and retain each line which is not empty, after comments
+ are removed and continuation lines are joined, so that the preprocessor
+ can look ahead in the makefile repeatedly without reading it again.
+
+ @param FileName Pointer to the makefile name.
+
+ @param Lookahead Pointer to the lookahead cache to populate.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+MakeLoadLookaheadCache(
+    __in PYORI_STRING FileName,
+    __inout PMAKE_LOOKAHEAD_CACHE Lookahead
+    )
+{
+    HANDLE hSource;
+    PVOID LineContext;
+    PMAKE_LOOKAHEAD_LINE NewLines;
+    PMAKE_LOOKAHEAD_LINE Entry;
+    YORI_STRING LineString;
+    YORI_STRING JoinedLine;
+    YORI_STRING LineToProcess;
+    DWORD LineNumber;
+    DWORD NewAllocated;
+    BOOLEAN MoreLinesNeeded;
+    BOOLEAN Result;
+
+    hSource = CreateFile(FileName->StartOfString, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+    if (hSource == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+
+    LineContext = NULL;
+    YoriLibInitEmptyString(&LineString);
+    YoriLibInitEmptyString(&JoinedLine);
+    YoriLibInitEmptyString(&LineToProcess);
+    LineNumber = 0;
+    Result = TRUE;
+
+    while (TRUE) {
+
+        if (!YoriLibReadLineToString(&LineString, &LineContext, hSource)) {
+            break;
+        }
+        LineNumber++;
+
+        LineToProcess.StartOfString = LineString.StartOfString;
+        LineToProcess.LengthInChars = LineString.LengthInChars;
+        MakeTruncateComments(&LineToProcess);
+
+        MoreLinesNeeded = FALSE;
+        if (LineToProcess.LengthInChars > 0 && LineToProcess.StartOfString[LineToProcess.LengthInChars - 1] == '\\') {
+            MoreLinesNeeded = TRUE;
+        }
+
+        if (JoinedLine.LengthInChars > 0 || MoreLinesNeeded) {
+            MakeTrimWhitespace(&LineToProcess);
+            MakeJoinLines(&JoinedLine, &LineToProcess);
+            if (MoreLinesNeeded) {
+                continue;
+            }
+            LineToProcess.StartOfString = JoinedLine.StartOfString;
+            LineToProcess.LengthInChars = JoinedLine.LengthInChars;
+        }
+
+        MakeTrimWhitespace(&LineToProcess);
+
+        if (LineToProcess.LengthInChars == 0) {
+            JoinedLine.LengthInChars = 0;
+            continue;
+        }
+
+        if (Lookahead->LineCount == Lookahead->LinesAllocated) {
+            NewAllocated = Lookahead->LinesAllocated * 2;
+            if (NewAllocated < 256) {
+                NewAllocated = 256;
+            }
+            if (!YoriLibIsSizeAllocatable((YORI_MAX_UNSIGNED_T)NewAllocated * sizeof(MAKE_LOOKAHEAD_LINE))) {
+                Result = FALSE;
+                break;
+            }
+            NewLines = YoriLibMalloc((YORI_ALLOC_SIZE_T)(NewAllocated * sizeof(MAKE_LOOKAHEAD_LINE)));
+            if (NewLines == NULL) {
+                Result = FALSE;
+                break;
+            }
+            if (Lookahead->LineCount > 0) {
+                memcpy(NewLines, Lookahead->Lines, Lookahead->LineCount * sizeof(MAKE_LOOKAHEAD_LINE));
+            }
+            if (Lookahead->Lines != NULL) {
+                YoriLibFree(Lookahead->Lines);
+            }
+            Lookahead->Lines = NewLines;
+            Lookahead->LinesAllocated = NewAllocated;
+        }
+
+        Entry = &Lookahead->Lines[Lookahead->LineCount];
+        if (!YoriLibCopyString(&Entry->Line, &LineToProcess)) {
+            Result = FALSE;
+            break;
+        }
+        Entry->LineNumber = LineNumber;
+        Entry->Probe = MakeIsLineMarkedAsProbe(&LineString);
+        Lookahead->LineCount++;
+
+        JoinedLine.LengthInChars = 0;
+    }
+
+    YoriLibLineReadClose(LineContext);
+    CloseHandle(hSource);
+    YoriLibFreeStringContents(&LineString);
+    YoriLibFreeStringContents(&JoinedLine);
+
+    if (!Result) {
+        MakeFreeLookaheadCache(Lookahead);
+    }
+
+    return Result;
+}
+
+/**
+ Look ahead in the makefile currently being preprocessed for !IF and
+ !ELSEIF conditions containing commands, and launch them speculatively so
+ they execute in parallel with each other and with the command that the
+ preprocessor is about to execute.  The lookahead stops at any !INCLUDE, or
+ when it reaches a region which may not be evaluated.  Commands are only
+ launched from conditions which are marked as probes and are not nested
+ within a later conditional block, so they are commands without side effects
+ that will be executed unless an error occurs.  Results are keyed by the
+ command after expansion, so a command whose variables change before the
+ preprocessor reaches it will simply not be used.  The makefile is read
+ once, the first time this is called for it.
+
+ @param ScopeContext Pointer to the scope context.
+ */
+VOID
+MakeSpeculatePreprocessorCmds(
+    __in PMAKE_SCOPE_CONTEXT ScopeContext
+    )
+{
+    PMAKE_CONTEXT MakeContext;
+    PMAKE_LOOKAHEAD_CACHE Lookahead;
+    PMAKE_LOOKAHEAD_LINE Entry;
+    YORI_STRING LineToProcess;
+    YORI_STRING ExpandedLine;
+    YORI_STRING VariableNotFound;
+    YORI_STRING AssignedVariables;
+    YORI_STRING Name;
+    YORI_STRING Cmd;
+    MAKE_PREPROCESSOR_LINE_TYPE PreprocessorLineType;
+    YORI_ALLOC_SIZE_T ArgOffset;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T CmdStart;
+    DWORD LineIndex;
+    DWORD Low;
+    DWORD High;
+    DWORD Depth;
+    DWORD SlotsAvailable;
+    DWORD Running;
+    BOOLEAN QuoteOpen;
+    BOOLEAN BraceOpen;
+    BOOLEAN Stop;
+
+    MakeContext = ScopeContext->MakeContext;
+    Lookahead = MakeContext->ActiveStreamLookahead;
+
+    if (MakeContext->ActiveStreamFileName == NULL ||
+        Lookahead == NULL ||
+        MakeContext->NumberProcesses <= 1) {
+
+        return;
+    }
+
+    Running = MakeReapSpeculativeCmds(MakeContext);
+    if (Running + 1 >= MakeContext->NumberProcesses) {
+        return;
+    }
+    SlotsAvailable = MakeContext->NumberProcesses - 1 - Running;
+
+    if (!Lookahead->Loaded) {
+        Lookahead->Loaded = TRUE;
+        if (!MakeLoadLookaheadCache(MakeContext->ActiveStreamFileName, Lookahead)) {
+            return;
+        }
+    }
+
+    //
+    //  Find the first line following the one being preprocessed.
+    //
+
+    Low = 0;
+    High = Lookahead->LineCount;
+    while (Low < High) {
+        LineIndex = Low + (High - Low) / 2;
+        if (Lookahead->Lines[LineIndex].LineNumber <= MakeContext->ActiveStreamLineNumber) {
+            Low = LineIndex + 1;
+        } else {
+            High = LineIndex;
+        }
+    }
+
+    YoriLibInitEmptyString(&ExpandedLine);
+    YoriLibInitEmptyString(&AssignedVariables);
+    Stop = FALSE;
+
+    //
+    //  This is called while evaluating an !IF or !ELSEIF line, so the lines
+    //  that follow are nested within its block.
+    //
+
+    Depth = 1;
+
+    for (LineIndex = Low; !Stop && SlotsAvailable > 0 && LineIndex < Lookahead->LineCount; LineIndex++) {
+
+        Entry = &Lookahead->Lines[LineIndex];
+        YoriLibInitEmptyString(&LineToProcess);
+        LineToProcess.StartOfString = Entry->Line.StartOfString;
+        LineToProcess.LengthInChars = Entry->Line.LengthInChars;
+
+        //
+        //  For lines that are not preprocessor directives, look for variable
+        //  assignments, so commands which refer to those variables are not
+        //  launched with stale values.  If the name of the variable being
+        //  assigned can't be determined without expansion, give up.
+        //
+
+        if (LineToProcess.StartOfString[0] != '!') {
+            BraceOpen = FALSE;
+            for (Index = 0; Index < LineToProcess.LengthInChars; Index++) {
+                if (LineToProcess.StartOfString[Index] == '[') {
+                    BraceOpen = TRUE;
+                } else if (LineToProcess.StartOfString[Index] == ']') {
+                    BraceOpen = FALSE;
+                } else if (!BraceOpen && LineToProcess.StartOfString[Index] == ':') {
+                    break;
+                } else if (!BraceOpen && LineToProcess.StartOfString[Index] == '=') {
+                    YoriLibInitEmptyString(&Name);
+                    Name.StartOfString = LineToProcess.StartOfString;
+                    Name.LengthInChars = Index;
+                    MakeTrimWhitespace(&Name);
+                    if (!MakeAppendVariableName(&AssignedVariables, &Name)) {
+                        Stop = TRUE;
+                    }
+                    break;
+                }
+            }
+            continue;
+        }
+
+        PreprocessorLineType = MakeDeterminePreprocessorLineType(&LineToProcess, &ArgOffset);
+        YoriLibInitEmptyString(&Name);
+        if (ArgOffset < LineToProcess.LengthInChars) {
+            Name.StartOfString = &LineToProcess.StartOfString[ArgOffset];
+            Name.LengthInChars = LineToProcess.LengthInChars - ArgOffset;
+            MakeTrimWhitespace(&Name);
+        }
+
+        switch(PreprocessorLineType) {
+            case MakePreprocessorLineTypeIfDef:
+            case MakePreprocessorLineTypeIfNDef:
+                Depth++;
+                break;
+            case MakePreprocessorLineTypeEndIf:
+                if (Depth > 0) {
+                    Depth--;
+                }
+                break;
+            case MakePreprocessorLineTypeElse:
+            case MakePreprocessorLineTypeElseIf:
+            case MakePreprocessorLineTypeElseIfDef:
+            case MakePreprocessorLineTypeElseIfNDef:
+                if (Depth == 0) {
+                    Stop = TRUE;
+                }
+                break;
+            case MakePreprocessorLineTypeError:
+            case MakePreprocessorLineTypeInclude:
+            case MakePreprocessorLineTypeUnknown:
+                if (Depth == 0) {
+                    Stop = TRUE;
+                }
+                break;
+            case MakePreprocessorLineTypeUndef:
+                if (!MakeAppendVariableName(&AssignedVariables, &Name)) {
+                    Stop = TRUE;
+                }
+                break;
+            case MakePreprocessorLineTypeIf:
+                Depth++;
+                if (Depth != 1 ||
+                    !Entry->Probe ||
+                    MakeDoesLineReferenceVariables(&LineToProcess, &AssignedVariables)) {
+
+                    break;
+                }
+
+                //
+                //  Expand the line in the same way the preprocessor will,
+                //  then find each command enclosed in braces.
+                //
+
+                YoriLibInitEmptyString(&VariableNotFound);
+                if (!MakeExpandVariables(ScopeContext, NULL, &ExpandedLine, &LineToProcess, &VariableNotFound) ||
+                    VariableNotFound.LengthInChars > 0) {
+
+                    break;
+                }
+
+                QuoteOpen = FALSE;
+                BraceOpen = FALSE;
+                CmdStart = 0;
+                for (Index = 0; Index < ExpandedLine.LengthInChars && SlotsAvailable > 0; Index++) {
+                    if (ExpandedLine.StartOfString[Index] == '"') {
+                        if (!QuoteOpen) {
+                            QuoteOpen = TRUE;
+                        } else {
+                            QuoteOpen = FALSE;
+                        }
+                    }
+
+                    if (!BraceOpen && ExpandedLine.StartOfString[Index] == '[') {
+                        BraceOpen = TRUE;
+                        CmdStart = Index + 1;
+                        if (QuoteOpen) {
+                            CmdStart = 0;
+                        }
+                    } else if (BraceOpen && ExpandedLine.StartOfString[Index] == ']') {
+                        BraceOpen = FALSE;
+                        if (CmdStart > 0 && Index > CmdStart) {
+                            YoriLibInitEmptyString(&Cmd);
+                            Cmd.StartOfString = &ExpandedLine.StartOfString[CmdStart];
+                            Cmd.LengthInChars = Index - CmdStart;
+                            if ((MakeContext->PreprocessorCache == NULL ||
+                                 MakeLookupPreprocessorCache(ScopeContext, &Cmd) == NULL) &&
+                                MakeLaunchSpeculativeCmd(MakeContext, &Cmd)) {
+
+                                SlotsAvailable--;
+                            }
+                        }
+                    }
+                }
+                break;
+        }
+    }
+
+    YoriLibFreeStringContents(&ExpandedLine);
+    YoriLibFreeStringContents(&AssignedVariables);
+}
+
+/**
+ Look for a speculatively launched command matching the command that the
+ preprocessor needs to evaluate.  If one is found, wait for it to complete
+ and return its exit code.
+
+ @param MakeContext Pointer to the context.
+
+ @param Cmd Pointer to the command to execute, after variable expansion.
+
+ @param ExitCode On successful completion, updated to contain the exit code
+        of the command.
+
+ @return TRUE if a matching command was found and ExitCode is valid, FALSE
+         if the command needs to be executed.
+ */
+__success(return)
+BOOLEAN
+MakeCollectSpeculativeCmd(
+    __in PMAKE_CONTEXT MakeContext,
+    __in PYORI_STRING Cmd,
+    __out PDWORD ExitCode
+    )
+{
+    PYORI_HASH_ENTRY HashEntry;
+    PMAKE_PREPROC_SPECULATIVE_CMD Entry;
+    BOOLEAN Result;
+
+    HashEntry = YoriLibHashLookupByKey(MakeContext->SpeculativeCmds, Cmd);
+    if (HashEntry == NULL) {
+        return FALSE;
+    }
+
+    //
+    //  Hash lookups are case insensitive but commands may not be, so only
+    //  use a result from exactly the same command.
+    //
+
+    Entry = CONTAINING_RECORD(HashEntry, MAKE_PREPROC_SPECULATIVE_CMD, HashEntry);
+    Result = FALSE;
+    if (YoriLibCompareString(&HashEntry->Key, Cmd) == 0) {
+        if (!Entry->Completed) {
+            WaitForSingleObject(Entry->ProcessHandle, INFINITE);
+            GetExitCodeProcess(Entry->ProcessHandle, &Entry->ExitCode);
+            Entry->Completed = TRUE;
+        }
+        *ExitCode = Entry->ExitCode;
+        MakeContext->SpeculativeCmdsUsed++;
+        Result = TRUE;
+    }
+
+    MakeFreeSpeculativeCmd(Entry);
+    return Result;
+}
+
 /**
  Execute a subcommand and capture the result.  Currently this is used to
  evaluate preprocessor if statements only.
@@ -1067,6 +1961,12 @@ MakeExecuteCommandCaptureExitCode(
         }
     }
 
+    if (ScopeContext->MakeContext->SpeculativeCmds != NULL &&
+        MakeCollectSpeculativeCmd(ScopeContext->MakeContext, Cmd, &ExitCode)) {
+
+        goto Executed;
+    }
+
     if (!YoriLibShParseCmdlineToCmdContext(Cmd, 0, &CmdContext)) {
         goto Complete;
     }
@@ -1076,11 +1976,36 @@ MakeExecuteCommandCaptureExitCode(
         goto Complete;
     }
 
+    //
+    //  If this command is marked as having no side effects, launch any
+    //  later commands in parallel with it.  If it may have side effects,
+    //  any commands that were launched early may have observed state before
+    //  this command changed it, so their results can't be used.
+    //
+
+    if (ScopeContext->MakeContext->SpeculativeCmds != NULL) {
+        if (ScopeContext->MakeContext->ActiveStreamLineIsProbe &&
+            MakeIsPlanSafeToSpeculate(&ExecPlan)) {
+            MakeSpeculatePreprocessorCmds(ScopeContext);
+        } else {
+            MakeDeleteAllSpeculativeCmds(ScopeContext->MakeContext);
+        }
+    }
+
     ExitCode = MakeShExecExecPlan(&ExecPlan, NULL);
 
     YoriLibShFreeExecPlan(&ExecPlan);
     YoriLibShFreeCmdContext(&CmdContext);
 
+Executed:
+
+    //
+    //  The command may have created or modified files, so any directory
+    //  contents that have been cached may be stale.
+    //
+
+    MakeDeleteDirectoryCache(ScopeContext->MakeContext);
+
     if (ScopeContext->MakeContext->PreprocessorCache != NULL) {
         MakeAddToPreprocessorCache(ScopeContext, Cmd, ExitCode);
     }
@@ -2700,10 +3625,30 @@ MakeProcessStream(
     LPTSTR PrefixString;
     PMAKE_TARGET ActiveRecipeTarget = NULL;
     PMAKE_SCOPE_CONTEXT ScopeContext;
+    PYORI_STRING PreviousStreamFileName;
+    PMAKE_LOOKAHEAD_CACHE PreviousStreamLookahead;
+    MAKE_LOOKAHEAD_CACHE Lookahead;
+    DWORD PreviousStreamLineNumber;
     DWORD LineNumber;
+    BOOLEAN PreviousStreamLineIsProbe;
 
     ScopeContext = MakeContext->ActiveScope;
 
+    //
+    //  Record the location being preprocessed so that later preprocessor
+    //  commands can be found and launched speculatively.  Included files
+    //  are processed recursively, so restore the includer's location when
+    //  this stream is complete.
+    //
+
+    PreviousStreamFileName = MakeContext->ActiveStreamFileName;
+    PreviousStreamLineNumber = MakeContext->ActiveStreamLineNumber;
+    PreviousStreamLookahead = MakeContext->ActiveStreamLookahead;
+    PreviousStreamLineIsProbe = MakeContext->ActiveStreamLineIsProbe;
+    ZeroMemory(&Lookahead, sizeof(Lookahead));
+    MakeContext->ActiveStreamFileName = FileName;
+    MakeContext->ActiveStreamLookahead = &Lookahead;
+
     YoriLibInitEmptyString(&LineString);
     YoriLibInitEmptyString(&JoinedLine);
     YoriLibInitEmptyString(&LineToProcess);
@@ -2720,6 +3665,7 @@ MakeProcessStream(
             break;
         }
         LineNumber++;
+        MakeContext->ActiveStreamLineNumber = LineNumber;
 
         //
         //  Line might be:
@@ -2733,6 +3679,8 @@ MakeProcessStream(
         //   - Inline file (lines between << and << within a recipe)
         //
 
+        MakeContext->ActiveStreamLineIsProbe = MakeIsLineMarkedAsProbe(&LineString);
+
         LineToProcess.StartOfString = LineString.StartOfString;
         LineToProcess.LengthInChars = LineString.LengthInChars;
         MakeTruncateComments(&LineToProcess);
@@ -2880,6 +3828,12 @@ MakeProcessStream(
     YoriLibFreeStringContents(&JoinedLine);
     YoriLibFreeStringContents(&ExpandedLine);
 
+    MakeFreeLookaheadCache(&Lookahead);
+    MakeContext->ActiveStreamFileName = PreviousStreamFileName;
+    MakeContext->ActiveStreamLineNumber = PreviousStreamLineNumber;
+    MakeContext->ActiveStreamLookahead = PreviousStreamLookahead;
+    MakeContext->ActiveStreamLineIsProbe = PreviousStreamLineIsProbe;
+
     return TRUE;
 }
 
@@ -162,15 +162,21 @@ MakeDeleteAllTargets(
  Open the target and query its timestamp.  The target may not exist (implying
  it needs to be rebuilt.)
 
+ @param MakeContext Pointer to the context.
+
  @param Target Pointer to the target to query.
  */
 VOID
 MakeProbeTargetFile(
+    __in PMAKE_CONTEXT MakeContext,
     __in PMAKE_TARGET Target
     )
 {
     HANDLE FileHandle;
     BY_HANDLE_FILE_INFORMATION FileInfo;
+    BOOLEAN FileExists;
+    DWORD FileAttributes;
+    LARGE_INTEGER ModifiedTime;
 
     if (Target->FileProbed) {
         return;
@@ -178,6 +184,26 @@ MakeProbeTargetFile(
 
     ASSERT(!Target->FileExists);
 
+    //
+    //  Most targets are answered by enumerating their parent directory
+    //  once, which is far cheaper than opening each file when many
+    //  targets are in the same directory.
+    //
+
+    if (MakeLookupFileInDirectoryCache(MakeContext, &Target->HashEntry.Key, &FileExists, &FileAttributes, &ModifiedTime)) {
+        if (FileExists) {
+            Target->FileExists = TRUE;
+            if (FileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                Target->ModifiedTime.LowPart = 0;
+                Target->ModifiedTime.HighPart = 0;
+            } else {
+                Target->ModifiedTime.QuadPart = ModifiedTime.QuadPart;
+            }
+        }
+        Target->FileProbed = TRUE;
+        return;
+    }
+
     //
     //  Check if the object already exists, and if so, when it was last
     //  modified.  Normally this would only need FILE_READ_ATTRIBUTES,
@@ -366,6 +392,13 @@ MakeLookupOrCreateTarget(
         Target->ModifiedTime.QuadPart = 0;
         Target->InferenceRule = NULL;
         Target->InferenceRuleParentTarget = NULL;
+        Target->RemainingPathCostCalculated = FALSE;
+        Target->EstimatedDuration = 0;
+        Target->RemainingPathCost = 0;
+        Target->CriticalPathParent = NULL;
+        Target->ReadySequence = 0;
+        Target->StartTime.QuadPart = 0;
+        Target->EndTime.QuadPart = 0;
         YoriLibInitEmptyString(&Target->Recipe);
         YoriLibInitializeListHead(&Target->ExecCmds);
         YoriLibHashInsertByKey(MakeContext->Targets, &FullPath, Target, &Target->HashEntry);
@@ -985,9 +1018,9 @@ MakeFindInferenceRuleForTarget(
         if (MakeBuildProbeNameFromInferenceRule(InferenceRule, &TargetNoExt, FileToProbe)) {
             FoundRuleWithTargetExtension = TRUE;
 #if MAKE_DEBUG_TARGETS
-            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("GetFileAttributes for: %s\n"), FileToProbe->StartOfString);
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Probing for: %s\n"), FileToProbe->StartOfString);
 #endif
-            if (GetFileAttributes(FileToProbe->StartOfString) != (DWORD)-1) {
+            if (MakeDoesFileExist(ScopeContext->MakeContext, FileToProbe)) {
                 FileToProbe->LengthInChars = FileToProbe->LengthInChars + InferenceRule->SourceExtension.LengthInChars;
                 if (!MakeAssignInferenceRuleToTarget(ScopeContext, Target, InferenceRule, FileToProbe)) {
                     return FALSE;
@@ -1039,9 +1072,9 @@ MakeFindInferenceRuleForTarget(
                 if (MakeBuildProbeNameFromInferenceRule(NestedRule, FileToProbe, NestedFileToProbe)) {
 
 #if MAKE_DEBUG_TARGETS
-                    YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Nested GetFileAttributes for: %s\n"), NestedFileToProbe->StartOfString);
+                    YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("Nested probing for: %s\n"), NestedFileToProbe->StartOfString);
 #endif
-                    if (GetFileAttributes(NestedFileToProbe->StartOfString) != (DWORD)-1) {
+                    if (MakeDoesFileExist(ScopeContext->MakeContext, NestedFileToProbe)) {
 
                         //
                         //  First, generate the outer rule, assigning the
@@ -1257,7 +1290,7 @@ MakeExpandTargetVariable(
     if (SymbolChars == 0) {
         return FALSE;
     }
-    MakeProbeTargetFile(Target);
+    MakeProbeTargetFile(MakeContext, Target);
 
     YoriLibInitEmptyString(&BaseVariableName);
     BaseVariableName.StartOfString = VariableName->StartOfString;
@@ -1305,7 +1338,7 @@ MakeExpandTargetVariable(
         ListEntry = YoriLibGetNextListEntry(&Target->ParentDependents, NULL);
         while (ListEntry != NULL) {
             DependentTarget = CONTAINING_RECORD(ListEntry, MAKE_TARGET_DEPENDENCY, ChildDependents);
-            MakeProbeTargetFile(DependentTarget->Parent);
+            MakeProbeTargetFile(MakeContext, DependentTarget->Parent);
             if (!Target->FileExists ||
                 !DependentTarget->Parent->FileExists ||
                 DependentTarget->Parent->ModifiedTime.QuadPart > Target->ModifiedTime.QuadPart) {
@@ -1324,7 +1357,7 @@ MakeExpandTargetVariable(
         ListEntry = YoriLibGetNextListEntry(&Target->ParentDependents, NULL);
         while (ListEntry != NULL) {
             DependentTarget = CONTAINING_RECORD(ListEntry, MAKE_TARGET_DEPENDENCY, ChildDependents);
-            MakeProbeTargetFile(DependentTarget->Parent);
+            MakeProbeTargetFile(MakeContext, DependentTarget->Parent);
             if (!Target->FileExists ||
                 !DependentTarget->Parent->FileExists ||
                 DependentTarget->Parent->ModifiedTime.QuadPart > Target->ModifiedTime.QuadPart) {
@@ -1664,13 +1697,10 @@ MakeMarkTargetForRebuild(
     }
 
     //
-    //  MSFIX Ideally these lists would be sorted or approximately sorted
-    //  where the targets that have the most dependencies are done before
-    //  those with fewer dependencies.  Doing this intelligently really
-    //  requires knowledge of all ancestors.  Appending to the end means
-    //  that depth first traversal should ensure that all dependencies are
-    //  satisfied, and if many targets depend on one target that target
-    //  should be uncovered relatively early.
+    //  Appending to the end means that depth first traversal should ensure
+    //  that all dependencies are satisfied.  Once the full graph is known,
+    //  the ready list is moved into a heap so that targets starting the
+    //  longest chain are executed first; see MakePrioritizeReadyTargets.
     //
 
     Target->RebuildRequired = TRUE;
@@ -1760,7 +1790,7 @@ MakeDetermineDependenciesForTarget(
         return FALSE;
     }
 
-    MakeProbeTargetFile(Target);
+    MakeProbeTargetFile(MakeContext, Target);
 
     Target->EvaluatingDependencies = TRUE;
 
@@ -1802,7 +1832,7 @@ MakeDetermineDependenciesForTarget(
             Target->NumberParentsToBuild = Target->NumberParentsToBuild + 1;
             SetRebuildRequired = TRUE;
         }
-        MakeProbeTargetFile(Parent);
+        MakeProbeTargetFile(MakeContext, Parent);
         if (Parent->FileExists && Target->FileExists && Parent->ModifiedTime.QuadPart > Target->ModifiedTime.QuadPart) {
             SetRebuildRequired = TRUE;
         }
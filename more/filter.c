@@ -0,0 +1,915 @@
+/**
+ * @file more/filter.c
+ *
+ * Yori shell more apply search filters on background threads
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "more.h"
+
+/**
+ Free the search strings within a filter criteria.
+
+ @param Criteria Pointer to the criteria to free.
+ */
+VOID
+MoreFilterFreeCriteria(
+    __inout PMORE_FILTER_CRITERIA Criteria
+    )
+{
+    UCHAR Index;
+
+    for (Index = 0; Index < Criteria->SearchCount; Index++) {
+        YoriLibFreeStringContents(&Criteria->SearchStrings[Index]);
+    }
+    Criteria->SearchCount = 0;
+}
+
+/**
+ Transfer ownership of the search strings in one filter criteria to
+ another.
+
+ @param Dest Pointer to the criteria to populate.  This is expected to not
+        contain any search strings.
+
+ @param Src Pointer to the criteria to take the search strings from.  On
+        completion this contains no search strings.
+ */
+VOID
+MoreFilterMoveCriteria(
+    __out PMORE_FILTER_CRITERIA Dest,
+    __inout PMORE_FILTER_CRITERIA Src
+    )
+{
+    UCHAR Index;
+
+    memcpy(Dest, Src, sizeof(MORE_FILTER_CRITERIA));
+    for (Index = 0; Index < MORE_MAX_SEARCHES; Index++) {
+        YoriLibInitEmptyString(&Src->SearchStrings[Index]);
+    }
+    Src->SearchCount = 0;
+}
+
+/**
+ Capture a private copy of the current search strings, so that a filter can
+ be applied on background threads while the user edits the search strings.
+
+ @param MoreContext Pointer to the more context containing the search
+        strings.
+
+ @param Criteria On successful completion, populated with a copy of the
+        search strings.
+
+ @return TRUE to indicate success, FALSE to indicate allocation failure.
+ */
+__success(return)
+BOOLEAN
+MoreFilterCaptureCriteria(
+    __in PMORE_CONTEXT MoreContext,
+    __out PMORE_FILTER_CRITERIA Criteria
+    )
+{
+    UCHAR Index;
+    UCHAR SearchCount;
+    PYORI_STRING Src;
+    PYORI_STRING Dest;
+
+    for (Index = 0; Index < MORE_MAX_SEARCHES; Index++) {
+        YoriLibInitEmptyString(&Criteria->SearchStrings[Index]);
+    }
+    Criteria->SearchCount = 0;
+
+    SearchCount = MoreSearchCountActive(MoreContext);
+    for (Index = 0; Index < SearchCount; Index++) {
+        Src = &MoreContext->SearchStrings[Index];
+        Dest = &Criteria->SearchStrings[Index];
+        if (!YoriLibAllocateString(Dest, Src->LengthInChars + 1)) {
+            MoreFilterFreeCriteria(Criteria);
+            return FALSE;
+        }
+        memcpy(Dest->StartOfString, Src->StartOfString, Src->LengthInChars * sizeof(TCHAR));
+        Dest->LengthInChars = Src->LengthInChars;
+        Dest->StartOfString[Dest->LengthInChars] = '\0';
+        Criteria->SearchCount = (UCHAR)(Index + 1);
+    }
+
+    return TRUE;
+}
+
+/**
+ Determine whether every line matching one filter criteria must also match
+ another.  This is true when each search string contains the corresponding
+ search string of the other, which is the common case of a user typing more
+ characters into a search string.
+
+ @param NewCriteria Pointer to the criteria that may be narrower.
+
+ @param OldCriteria Pointer to the criteria that may be broader.
+
+ @return TRUE if every line matching NewCriteria also matches OldCriteria,
+         FALSE if this cannot be determined.
+ */
+BOOLEAN
+MoreFilterIsNarrowerCriteria(
+    __in PMORE_FILTER_CRITERIA NewCriteria,
+    __in PMORE_FILTER_CRITERIA OldCriteria
+    )
+{
+    UCHAR Index;
+
+    if (NewCriteria->SearchCount != OldCriteria->SearchCount) {
+        return FALSE;
+    }
+
+    for (Index = 0; Index < NewCriteria->SearchCount; Index++) {
+        if (YoriLibFindFirstMatchSubstrIns(&NewCriteria->SearchStrings[Index], 1, &OldCriteria->SearchStrings[Index], NULL) == NULL) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ Determine whether a line matches the criteria of a filter job.
+
+ @param Job Pointer to the filter job.
+
+ @param LineContents Pointer to the contents of the line.
+
+ @return TRUE if the line matches, FALSE if it does not.
+ */
+BOOLEAN
+MoreFilterDoesLineMatch(
+    __in PMORE_FILTER_JOB Job,
+    __in PCYORI_STRING LineContents
+    )
+{
+    if (YoriLibMultiMatchFindFirst(&Job->Matcher, LineContents, NULL) != NULL) {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ Free a filter job.  The job must not be in use by any filter thread.
+
+ @param Job Pointer to the job to free.
+ */
+VOID
+MoreFilterFreeJob(
+    __in PMORE_FILTER_JOB Job
+    )
+{
+    YoriLibMultiMatchCleanup(&Job->Matcher);
+    MoreFilterFreeCriteria(&Job->Criteria);
+    YoriLibFree(Job);
+}
+
+/**
+ Allocate a filter job to evaluate a range of lines.
+
+ @param Criteria Pointer to the criteria to apply.  On success, ownership of
+        the search strings is transferred to the job.
+
+ @param Narrowing TRUE if the lines to evaluate are candidate lines, FALSE if
+        they are physical lines.
+
+ @param FirstLineNumber If Narrowing is FALSE, the first physical line number
+        to evaluate.
+
+ @param LineCount The number of lines to evaluate.
+
+ @param LastLineNumber The physical line number of the last line covered by
+        the job.
+
+ @return Pointer to the job, or NULL on allocation failure.
+ */
+__success(return != NULL)
+PMORE_FILTER_JOB
+MoreFilterAllocateJob(
+    __inout PMORE_FILTER_CRITERIA Criteria,
+    __in BOOLEAN Narrowing,
+    __in DWORDLONG FirstLineNumber,
+    __in DWORDLONG LineCount,
+    __in DWORDLONG LastLineNumber
+    )
+{
+    PMORE_FILTER_JOB Job;
+    DWORDLONG ChunkCount;
+    YORI_MAX_UNSIGNED_T BytesRequired;
+
+    ChunkCount = (LineCount + MORE_LINES_PER_BLOCK - 1) / MORE_LINES_PER_BLOCK;
+    BytesRequired = sizeof(MORE_FILTER_JOB) + ChunkCount * sizeof(MORE_FILTER_CHUNK);
+    if (!YoriLibIsSizeAllocatable(BytesRequired)) {
+        return NULL;
+    }
+
+    Job = YoriLibMalloc((YORI_ALLOC_SIZE_T)BytesRequired);
+    if (Job == NULL) {
+        return NULL;
+    }
+
+    ZeroMemory(Job, (YORI_ALLOC_SIZE_T)BytesRequired);
+    MoreFilterMoveCriteria(&Job->Criteria, Criteria);
+    if (!YoriLibMultiMatchInitialize(&Job->Matcher, Job->Criteria.SearchCount, Job->Criteria.SearchStrings, TRUE)) {
+        MoreFilterMoveCriteria(Criteria, &Job->Criteria);
+        YoriLibFree(Job);
+        return NULL;
+    }
+    Job->Narrowing = Narrowing;
+    Job->FirstLineNumber = FirstLineNumber;
+    Job->LineCount = LineCount;
+    Job->LastLineNumber = LastLineNumber;
+    Job->ChunkCount = (DWORD)ChunkCount;
+    Job->Chunks = (PMORE_FILTER_CHUNK)(Job + 1);
+
+    return Job;
+}
+
+/**
+ Return the physical line corresponding to a line within a filter job.
+
+ @param MoreContext Pointer to the more context.
+
+ @param Job Pointer to the filter job.
+
+ @param JobLineIndex The zero based index of the line within the job.
+
+ @return Pointer to the physical line, or NULL if it does not exist.
+ */
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreFilterGetJobLine(
+    __in PMORE_CONTEXT MoreContext,
+    __in PMORE_FILTER_JOB Job,
+    __in DWORDLONG JobLineIndex
+    )
+{
+    if (Job->Narrowing) {
+        return MoreGetCandidatePhysicalLine(MoreContext, JobLineIndex + 1);
+    }
+
+    return MoreGetPhysicalLine(MoreContext, Job->FirstLineNumber + JobLineIndex);
+}
+
+/**
+ Return the number of lines described by a chunk within a filter job.  This
+ is MORE_LINES_PER_BLOCK except for the final chunk.
+
+ @param Job Pointer to the filter job.
+
+ @param ChunkIndex The index of the chunk within the job.
+
+ @return The number of lines in the chunk.
+ */
+DWORD
+MoreFilterLinesInChunk(
+    __in PMORE_FILTER_JOB Job,
+    __in DWORD ChunkIndex
+    )
+{
+    DWORDLONG FirstLine;
+
+    FirstLine = (DWORDLONG)ChunkIndex * MORE_LINES_PER_BLOCK;
+    ASSERT(FirstLine < Job->LineCount);
+    if (Job->LineCount - FirstLine > MORE_LINES_PER_BLOCK) {
+        return MORE_LINES_PER_BLOCK;
+    }
+    return (DWORD)(Job->LineCount - FirstLine);
+}
+
+/**
+ Evaluate each line in a chunk against the filter criteria, recording which
+ lines match.  This is called on a filter thread without holding any lock.
+ Only lines which were present when the job was queued are evaluated, so
+ they can be accessed without synchronizing with the ingest thread.
+
+ @param MoreContext Pointer to the more context.
+
+ @param Job Pointer to the filter job.
+
+ @param ChunkIndex The index of the chunk to evaluate.
+
+ @return TRUE if the chunk was evaluated, FALSE if the job was cancelled.
+ */
+BOOLEAN
+MoreFilterEvaluateChunk(
+    __in PMORE_CONTEXT MoreContext,
+    __in PMORE_FILTER_JOB Job,
+    __in DWORD ChunkIndex
+    )
+{
+    PMORE_FILTER_CHUNK Chunk;
+    PMORE_PHYSICAL_LINE ThisLine;
+    DWORDLONG FirstLine;
+    DWORD LineCount;
+    DWORD Index;
+
+    Chunk = &Job->Chunks[ChunkIndex];
+    FirstLine = (DWORDLONG)ChunkIndex * MORE_LINES_PER_BLOCK;
+    LineCount = MoreFilterLinesInChunk(Job, ChunkIndex);
+
+    ZeroMemory(Chunk->MatchBitmap, sizeof(Chunk->MatchBitmap));
+
+    for (Index = 0; Index < LineCount; Index++) {
+        if ((Index % MORE_FILTER_CANCEL_CHECK_INTERVAL) == 0 &&
+            Job->Cancelled) {
+
+            return FALSE;
+        }
+
+        ThisLine = MoreFilterGetJobLine(MoreContext, Job, FirstLine + Index);
+        ASSERT(ThisLine != NULL);
+        if (ThisLine != NULL &&
+            MoreFilterDoesLineMatch(Job, &ThisLine->LineContents)) {
+
+            Chunk->MatchBitmap[Index / 32] = Chunk->MatchBitmap[Index / 32] | ((DWORD)1 << (Index % 32));
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ The main function for each filter thread.  This waits for a job to have
+ chunks available, claims one, evaluates it, and indicates to the viewport
+ thread that results are available.
+
+ @param Context Pointer to the more context.
+
+ @return Zero.
+ */
+DWORD WINAPI
+MoreFilterThread(
+    __in LPVOID Context
+    )
+{
+    PMORE_CONTEXT MoreContext;
+    PMORE_FILTER_CONTEXT Filter;
+    PMORE_FILTER_JOB Job;
+    HANDLE WaitHandles[2];
+    DWORD ChunkIndex;
+    BOOLEAN Complete;
+
+    MoreContext = (PMORE_CONTEXT)Context;
+    Filter = &MoreContext->Filter;
+    WaitHandles[0] = Filter->ShutdownEvent;
+    WaitHandles[1] = Filter->WorkAvailableEvent;
+
+    while (TRUE) {
+        if (WaitForMultipleObjects(2, WaitHandles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) {
+            break;
+        }
+
+        WaitForSingleObject(Filter->Mutex, INFINITE);
+        Job = Filter->Job;
+        if (Job == NULL || Job->Cancelled || Job->NextChunk >= Job->ChunkCount) {
+            ResetEvent(Filter->WorkAvailableEvent);
+            ReleaseMutex(Filter->Mutex);
+            continue;
+        }
+
+        ChunkIndex = Job->NextChunk;
+        Job->NextChunk++;
+        if (Job->NextChunk >= Job->ChunkCount) {
+            ResetEvent(Filter->WorkAvailableEvent);
+        }
+        Filter->ActiveThreads++;
+        ResetEvent(Filter->ThreadsIdleEvent);
+        ReleaseMutex(Filter->Mutex);
+
+        Complete = MoreFilterEvaluateChunk(MoreContext, Job, ChunkIndex);
+
+        //
+        //  Once the chunk is marked complete and the thread is no longer
+        //  active, the job may be freed, so it must not be referenced
+        //  again.
+        //
+
+        WaitForSingleObject(Filter->Mutex, INFINITE);
+        if (Complete) {
+            Job->Chunks[ChunkIndex].Complete = TRUE;
+        }
+        Filter->ActiveThreads--;
+        if (Filter->ActiveThreads == 0) {
+            SetEvent(Filter->ThreadsIdleEvent);
+        }
+        ReleaseMutex(Filter->Mutex);
+
+        if (Complete) {
+            SetEvent(Filter->ProgressEvent);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ Create the synchronization objects and threads used to apply filters, if
+ they have not been created already.  These are created on first use since
+ many invocations never filter.
+
+ @param MoreContext Pointer to the more context.
+
+ @return TRUE to indicate that filter threads are available, FALSE if they
+         could not be created.
+ */
+__success(return)
+BOOLEAN
+MoreFilterStartThreads(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_FILTER_CONTEXT Filter;
+    SYSTEM_INFO SystemInfo;
+    DWORD MaxThreads;
+    DWORD ThreadId;
+
+    Filter = &MoreContext->Filter;
+    if (Filter->ThreadCount > 0) {
+        return TRUE;
+    }
+
+    if (Filter->Mutex == NULL) {
+        Filter->Mutex = CreateMutex(NULL, FALSE, NULL);
+        if (Filter->Mutex == NULL) {
+            return FALSE;
+        }
+    }
+
+    if (Filter->WorkAvailableEvent == NULL) {
+        Filter->WorkAvailableEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if (Filter->WorkAvailableEvent == NULL) {
+            return FALSE;
+        }
+    }
+
+    if (Filter->ThreadsIdleEvent == NULL) {
+        Filter->ThreadsIdleEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
+        if (Filter->ThreadsIdleEvent == NULL) {
+            return FALSE;
+        }
+    }
+
+    if (Filter->ProgressEvent == NULL) {
+        Filter->ProgressEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+        if (Filter->ProgressEvent == NULL) {
+            return FALSE;
+        }
+    }
+
+    if (Filter->ShutdownEvent == NULL) {
+        Filter->ShutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if (Filter->ShutdownEvent == NULL) {
+            return FALSE;
+        }
+    }
+
+    //
+    //  Searching is CPU bound, so use one thread per processor.  The
+    //  viewport thread is mostly waiting while this happens.
+    //
+
+    GetSystemInfo(&SystemInfo);
+    MaxThreads = SystemInfo.dwNumberOfProcessors;
+    if (MaxThreads < 1) {
+        MaxThreads = 1;
+    }
+    if (MaxThreads > MORE_MAX_FILTER_THREADS) {
+        MaxThreads = MORE_MAX_FILTER_THREADS;
+    }
+
+    while (Filter->ThreadCount < MaxThreads) {
+        Filter->Threads[Filter->ThreadCount] = CreateThread(NULL, 0, MoreFilterThread, MoreContext, 0, &ThreadId);
+        if (Filter->Threads[Filter->ThreadCount] == NULL) {
+            break;
+        }
+        Filter->ThreadCount++;
+    }
+
+    if (Filter->ThreadCount == 0) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Cancel any job being evaluated by filter threads, and wait for the threads
+ to stop referencing it.  Threads check for cancellation frequently, so this
+ wait is brief.
+
+ @param MoreContext Pointer to the more context.
+ */
+VOID
+MoreFilterCancelJob(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_FILTER_CONTEXT Filter;
+
+    Filter = &MoreContext->Filter;
+    if (Filter->ThreadCount == 0) {
+        return;
+    }
+
+    WaitForSingleObject(Filter->Mutex, INFINITE);
+    if (Filter->Job != NULL) {
+        InterlockedExchange(&Filter->Job->Cancelled, TRUE);
+    }
+    ResetEvent(Filter->WorkAvailableEvent);
+    ReleaseMutex(Filter->Mutex);
+
+    WaitForSingleObject(Filter->ThreadsIdleEvent, INFINITE);
+}
+
+/**
+ Make a job the current job, and wake filter threads to evaluate it.  The
+ caller must hold PhysicalLineMutex.
+
+ @param MoreContext Pointer to the more context.
+
+ @param Job Pointer to the new job.
+
+ @return Pointer to the previous job, which is no longer referenced by
+         filter threads and should be freed by the caller, or NULL if there
+         was no previous job.
+ */
+PMORE_FILTER_JOB
+MoreFilterQueueJob(
+    __inout PMORE_CONTEXT MoreContext,
+    __in PMORE_FILTER_JOB Job
+    )
+{
+    PMORE_FILTER_CONTEXT Filter;
+    PMORE_FILTER_JOB OldJob;
+
+    Filter = &MoreContext->Filter;
+
+    WaitForSingleObject(Filter->Mutex, INFINITE);
+    OldJob = Filter->Job;
+    Filter->Job = Job;
+    if (Job->ChunkCount > 0) {
+        SetEvent(Filter->WorkAvailableEvent);
+    }
+    ReleaseMutex(Filter->Mutex);
+
+    //
+    //  Wake the viewport thread so that a job with no lines is completed
+    //  immediately.
+    //
+
+    SetEvent(Filter->ProgressEvent);
+
+    return OldJob;
+}
+
+/**
+ Begin applying the current search strings as a filter on background
+ threads.  The set of filtered lines is emptied, and is populated as
+ results are published by @ref MorePublishFilterResults .  If the search
+ strings only narrow the criteria used to generate an earlier complete set
+ of filtered lines, only the lines in that set are evaluated.
+
+ @param MoreContext Pointer to the more context.
+
+ @return TRUE to indicate the filter was started, FALSE on failure.
+ */
+__success(return)
+BOOLEAN
+MoreStartFilter(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_FILTER_CONTEXT Filter;
+    MORE_FILTER_CRITERIA Criteria;
+    PMORE_FILTER_JOB OldJob;
+    PMORE_FILTER_JOB NewJob;
+    BOOLEAN Narrowing;
+
+    Filter = &MoreContext->Filter;
+
+    if (!MoreFilterStartThreads(MoreContext)) {
+        return FALSE;
+    }
+
+    if (!MoreFilterCaptureCriteria(MoreContext, &Criteria)) {
+        return FALSE;
+    }
+
+    MoreFilterCancelJob(MoreContext);
+
+    WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
+
+    //
+    //  If the previous job completed and the new criteria is narrower, its
+    //  results become the candidate lines.  If the previous job did not
+    //  complete, the existing candidate lines can still be used if the new
+    //  criteria is narrower than the criteria that generated them.
+    //
+
+    Narrowing = FALSE;
+    OldJob = Filter->Job;
+    if (OldJob != NULL &&
+        !Filter->InProgress &&
+        MoreContext->FilteredLinesIndexed &&
+        MoreFilterIsNarrowerCriteria(&Criteria, &OldJob->Criteria)) {
+
+        MoreMoveFilteredLinesToCandidates(MoreContext);
+        MoreFilterFreeCriteria(&Filter->CandidateCriteria);
+        MoreFilterMoveCriteria(&Filter->CandidateCriteria, &OldJob->Criteria);
+        Filter->CandidateLastLineNumber = MoreContext->LineCount;
+        Filter->CandidatesValid = TRUE;
+        Narrowing = TRUE;
+    } else if (Filter->CandidatesValid &&
+               MoreFilterIsNarrowerCriteria(&Criteria, &Filter->CandidateCriteria)) {
+
+        Narrowing = TRUE;
+    } else {
+        Filter->CandidatesValid = FALSE;
+        MoreFilterFreeCriteria(&Filter->CandidateCriteria);
+        MoreContext->CandidateLineCount = 0;
+    }
+
+    if (Narrowing) {
+        NewJob = MoreFilterAllocateJob(&Criteria, TRUE, 0, MoreContext->CandidateLineCount, Filter->CandidateLastLineNumber);
+    } else {
+        NewJob = MoreFilterAllocateJob(&Criteria, FALSE, 1, MoreContext->LineCount, MoreContext->LineCount);
+    }
+
+    if (NewJob == NULL) {
+        MoreFilterFreeCriteria(&Criteria);
+        ReleaseMutex(MoreContext->PhysicalLineMutex);
+        return FALSE;
+    }
+
+    MoreContext->FilteredLinesIndexed = TRUE;
+    MoreContext->FilteredLineCount = 0;
+    Filter->InProgress = TRUE;
+
+    OldJob = MoreFilterQueueJob(MoreContext, NewJob);
+    ReleaseMutex(MoreContext->PhysicalLineMutex);
+
+    if (OldJob != NULL) {
+        MoreFilterFreeJob(OldJob);
+    }
+
+    return TRUE;
+}
+
+/**
+ Stop applying any filter, so that every physical line is a filtered line.
+
+ @param MoreContext Pointer to the more context.
+ */
+VOID
+MoreStopFilter(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_FILTER_CONTEXT Filter;
+    PMORE_FILTER_JOB OldJob;
+
+    Filter = &MoreContext->Filter;
+
+    MoreFilterCancelJob(MoreContext);
+
+    WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
+
+    //
+    //  Lines added while no filter is in effect are not evaluated, so any
+    //  candidate lines are no longer complete.
+    //
+
+    MoreContext->FilteredLinesIndexed = FALSE;
+    MoreContext->FilteredLineCount = MoreContext->LineCount;
+    MoreContext->CandidateLineCount = 0;
+    Filter->InProgress = FALSE;
+    Filter->CandidatesValid = FALSE;
+    MoreFilterFreeCriteria(&Filter->CandidateCriteria);
+
+    OldJob = NULL;
+    if (Filter->Job != NULL) {
+        WaitForSingleObject(Filter->Mutex, INFINITE);
+        OldJob = Filter->Job;
+        Filter->Job = NULL;
+        ReleaseMutex(Filter->Mutex);
+    }
+
+    ReleaseMutex(MoreContext->PhysicalLineMutex);
+
+    if (OldJob != NULL) {
+        MoreFilterFreeJob(OldJob);
+    }
+}
+
+/**
+ Add the lines matching the filter within a completed chunk to the set of
+ filtered lines.  The caller must hold PhysicalLineMutex.
+
+ @param MoreContext Pointer to the more context.
+
+ @param Job Pointer to the filter job.
+
+ @param ChunkIndex The index of the chunk to publish.
+
+ @return TRUE to indicate success, FALSE to indicate allocation failure.
+ */
+__success(return)
+BOOLEAN
+MoreFilterPublishChunk(
+    __inout PMORE_CONTEXT MoreContext,
+    __in PMORE_FILTER_JOB Job,
+    __in DWORD ChunkIndex
+    )
+{
+    PMORE_FILTER_CHUNK Chunk;
+    PMORE_PHYSICAL_LINE ThisLine;
+    DWORDLONG FirstLine;
+    DWORD LineCount;
+    DWORD Index;
+
+    Chunk = &Job->Chunks[ChunkIndex];
+    FirstLine = (DWORDLONG)ChunkIndex * MORE_LINES_PER_BLOCK;
+    LineCount = MoreFilterLinesInChunk(Job, ChunkIndex);
+
+    for (Index = 0; Index < LineCount; Index++) {
+        ThisLine = MoreFilterGetJobLine(MoreContext, Job, FirstLine + Index);
+        if (ThisLine == NULL) {
+            continue;
+        }
+
+        if (Chunk->MatchBitmap[Index / 32] & ((DWORD)1 << (Index % 32))) {
+            if (!MoreAppendFilteredPhysicalLine(MoreContext, ThisLine)) {
+                return FALSE;
+            }
+        } else {
+            ThisLine->FilteredLineNumber = 0;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ Add the results of any chunks completed by filter threads to the set of
+ filtered lines.  Chunks are published in order, so the set of filtered
+ lines is always a prefix of the final result.  Once every chunk has been
+ published, any lines added by the ingest thread while the job was running
+ are evaluated by a further job.  This is called on the viewport thread
+ when MORE_FILTER_CONTEXT::ProgressEvent is signalled.
+
+ @param MoreContext Pointer to the more context.
+
+ @return TRUE if the set of filtered lines or the state of the filter
+         changed, FALSE if nothing changed.
+ */
+BOOLEAN
+MorePublishFilterResults(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_FILTER_CONTEXT Filter;
+    PMORE_FILTER_JOB Job;
+    PMORE_FILTER_JOB NewJob;
+    MORE_FILTER_CRITERIA Criteria;
+    BOOLEAN Complete;
+    BOOLEAN Changed;
+
+    Filter = &MoreContext->Filter;
+    Job = Filter->Job;
+    if (Job == NULL || !Filter->InProgress) {
+        return FALSE;
+    }
+
+    Changed = FALSE;
+    WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
+
+    while (Job->ChunksPublished < Job->ChunkCount) {
+        WaitForSingleObject(Filter->Mutex, INFINITE);
+        Complete = Job->Chunks[Job->ChunksPublished].Complete;
+        ReleaseMutex(Filter->Mutex);
+
+        if (!Complete) {
+            break;
+        }
+
+        if (!MoreFilterPublishChunk(MoreContext, Job, Job->ChunksPublished)) {
+            MoreContext->OutOfMemory = TRUE;
+            ReleaseMutex(MoreContext->PhysicalLineMutex);
+            return TRUE;
+        }
+
+        Job->ChunksPublished++;
+        Changed = TRUE;
+    }
+
+    if (Job->ChunksPublished == Job->ChunkCount) {
+        Changed = TRUE;
+        if (MoreContext->LineCount > Job->LastLineNumber) {
+            MoreFilterMoveCriteria(&Criteria, &Job->Criteria);
+            NewJob = MoreFilterAllocateJob(&Criteria,
+                                           FALSE,
+                                           Job->LastLineNumber + 1,
+                                           MoreContext->LineCount - Job->LastLineNumber,
+                                           MoreContext->LineCount);
+            if (NewJob == NULL) {
+                MoreFilterMoveCriteria(&Job->Criteria, &Criteria);
+                MoreContext->OutOfMemory = TRUE;
+            } else {
+                Job = MoreFilterQueueJob(MoreContext, NewJob);
+                MoreFilterFreeJob(Job);
+            }
+        } else {
+            Filter->InProgress = FALSE;
+        }
+    }
+
+    ReleaseMutex(MoreContext->PhysicalLineMutex);
+
+    return Changed;
+}
+
+/**
+ Terminate filter threads and free any filter state.
+
+ @param MoreContext Pointer to the more context.
+ */
+VOID
+MoreFilterCleanup(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_FILTER_CONTEXT Filter;
+    DWORD Index;
+
+    Filter = &MoreContext->Filter;
+
+    if (Filter->ThreadCount > 0) {
+        MoreFilterCancelJob(MoreContext);
+        SetEvent(Filter->ShutdownEvent);
+        WaitForMultipleObjects(Filter->ThreadCount, Filter->Threads, TRUE, INFINITE);
+        for (Index = 0; Index < Filter->ThreadCount; Index++) {
+            CloseHandle(Filter->Threads[Index]);
+            Filter->Threads[Index] = NULL;
+        }
+        Filter->ThreadCount = 0;
+    }
+
+    if (Filter->Job != NULL) {
+        MoreFilterFreeJob(Filter->Job);
+        Filter->Job = NULL;
+    }
+
+    MoreFilterFreeCriteria(&Filter->CandidateCriteria);
+    Filter->CandidatesValid = FALSE;
+    Filter->InProgress = FALSE;
+
+    if (Filter->Mutex != NULL) {
+        CloseHandle(Filter->Mutex);
+        Filter->Mutex = NULL;
+    }
+
+    if (Filter->WorkAvailableEvent != NULL) {
+        CloseHandle(Filter->WorkAvailableEvent);
+        Filter->WorkAvailableEvent = NULL;
+    }
+
+    if (Filter->ThreadsIdleEvent != NULL) {
+        CloseHandle(Filter->ThreadsIdleEvent);
+        Filter->ThreadsIdleEvent = NULL;
+    }
+
+    if (Filter->ProgressEvent != NULL) {
+        CloseHandle(Filter->ProgressEvent);
+        Filter->ProgressEvent = NULL;
+    }
+
+    if (Filter->ShutdownEvent != NULL) {
+        CloseHandle(Filter->ShutdownEvent);
+        Filter->ShutdownEvent = NULL;
+    }
+}
+
+// vim:sw=4:ts=4:et:
@@ -82,7 +82,6 @@ MoreAddPhysicalLineToBuffer(
     YORI_ALLOC_SIZE_T CharIndex;
     YORI_ALLOC_SIZE_T DestIndex;
     YORI_ALLOC_SIZE_T TabIndex;
-    YORI_ALLOC_SIZE_T Alignment;
     YORI_ALLOC_SIZE_T BytesRequired;
 
     //
@@ -100,12 +99,13 @@ MoreAddPhysicalLineToBuffer(
     }
 
     //
-    //  We need space for the structure, all characters in the source, a NULL,
-    //  and since tabs will be replaced with spaces the number of spaces per
-    //  tab minus one (for the tab character being removed.)
+    //  We need space for all characters in the source, a NULL, and since
+    //  tabs will be replaced with spaces the number of spaces per tab minus
+    //  one (for the tab character being removed.)  The structure describing
+    //  the line is held in the line store, not in this buffer.
     //
 
-    BytesRequired = sizeof(MORE_PHYSICAL_LINE) + (LineString->LengthInChars + TabCount * (MoreContext->TabWidth - 1) + 1) * sizeof(TCHAR);
+    BytesRequired = (LineString->LengthInChars + TabCount * (MoreContext->TabWidth - 1) + 1) * sizeof(TCHAR);
 
     //
     //  If we need a buffer, allocate a buffer that typically has space for
@@ -130,22 +130,25 @@ MoreAddPhysicalLineToBuffer(
         }
     }
 
+    NewLine = MoreAllocatePhysicalLine(MoreContext);
+    if (NewLine == NULL) {
+        MoreContext->OutOfMemory = TRUE;
+        return FALSE;
+    }
+
     //
-    //  Write this line into the current buffer
+    //  Write this line into the current buffer.  The line store holds one
+    //  reference on the buffer for all of the lines within it, which is
+    //  taken when the first line is written.
     //
 
-    NewLine = (PMORE_PHYSICAL_LINE)YoriLibAddToPointer(AllocContext->Buffer, AllocContext->BufferOffset);
-
-    YoriLibReference(AllocContext->Buffer);
-    NewLine->FilteredLineList.Next = NULL;
-    NewLine->FilteredLineList.Prev = NULL;
+    if (AllocContext->BufferOffset == 0) {
+        YoriLibReference(AllocContext->Buffer);
+    }
     NewLine->MemoryToFree = AllocContext->Buffer;
     NewLine->InitialColor = AllocContext->PreviousColor;
-    NewLine->LineNumber = MoreContext->LineCount + 1;
-    NewLine->FilteredLineNumber = NewLine->LineNumber;
-    YoriLibReference(AllocContext->Buffer);
-    NewLine->LineContents.MemoryToFree = AllocContext->Buffer;
-    NewLine->LineContents.StartOfString = (LPTSTR)(NewLine + 1);
+    YoriLibInitEmptyString(&NewLine->LineContents);
+    NewLine->LineContents.StartOfString = (LPTSTR)YoriLibAddToPointer(AllocContext->Buffer, AllocContext->BufferOffset);
 
     for (CharIndex = 0, DestIndex = 0; CharIndex < LineString->LengthInChars; CharIndex++) {
         //
@@ -194,30 +197,25 @@ MoreAddPhysicalLineToBuffer(
     AllocContext->BytesRemainingInBuffer = AllocContext->BytesRemainingInBuffer - BytesRequired;
 
     //
-    //  Align the buffer to 8 bytes.  There's no length checking because
-    //  the allocation is assumed to be aligned to 8 bytes.
-    //
-
-    Alignment = AllocContext->BufferOffset % 8;
-    if (Alignment > 0) {
-        Alignment = 8 - Alignment;
-        AllocContext->BufferOffset = AllocContext->BufferOffset + Alignment;
-        AllocContext->BytesRemainingInBuffer = AllocContext->BytesRemainingInBuffer - Alignment;
-    }
-
-    //
-    //  Insert the new line into the list
+    //  Make the new line visible.  If a filter is being indexed, the line
+    //  is added to it if it matches; if not, every line is a filtered line.
+    //  If a filter is still being applied on background threads, the line
+    //  is left for it to evaluate once it reaches the end of its lines.
     //
 
     WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
+    ASSERT(NewLine->LineNumber == MoreContext->LineCount + 1);
     MoreContext->LineCount++;
-    YoriLibAppendList(&MoreContext->PhysicalLineList, &NewLine->LineList);
-    if (!MoreContext->FilterToSearch ||
-        MoreFindNextSearchMatch(MoreContext, &NewLine->LineContents, NULL, NULL)) {
-
-        YoriLibAppendList(&MoreContext->FilteredPhysicalLineList, &NewLine->FilteredLineList);
+    if (!MoreContext->FilteredLinesIndexed) {
         MoreContext->FilteredLineCount++;
         NewLine->FilteredLineNumber = MoreContext->FilteredLineCount;
+    } else if (!MoreContext->Filter.InProgress &&
+               MoreFilterDoesLineMatch(MoreContext->Filter.Job, &NewLine->LineContents)) {
+        if (!MoreAppendFilteredPhysicalLine(MoreContext, NewLine)) {
+            ReleaseMutex(MoreContext->PhysicalLineMutex);
+            MoreContext->OutOfMemory = TRUE;
+            return FALSE;
+        }
     }
     ReleaseMutex(MoreContext->PhysicalLineMutex);
 
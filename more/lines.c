@@ -112,7 +112,24 @@ MoreFindNextSearchMatch(
 
     CountFound = MoreSearchCountActive(MoreContext);
 
-    Found = YoriLibFindFirstMatchSubstrIns(StringToSearch, CountFound, MoreContext->SearchStrings, MatchOffset);
+    //
+    //  Prepare to search for all of the strings at once if they have
+    //  changed since the last search.  If this fails, fall back to
+    //  searching for each string in turn.
+    //
+
+    if (MoreContext->SearchMatcherStale) {
+        YoriLibMultiMatchCleanup(&MoreContext->SearchMatcher);
+        if (YoriLibMultiMatchInitialize(&MoreContext->SearchMatcher, CountFound, MoreContext->SearchStrings, TRUE)) {
+            MoreContext->SearchMatcherStale = FALSE;
+        }
+    }
+
+    if (MoreContext->SearchMatcherStale) {
+        Found = YoriLibFindFirstMatchSubstrIns(StringToSearch, CountFound, MoreContext->SearchStrings, MatchOffset);
+    } else {
+        Found = YoriLibMultiMatchFindFirst(&MoreContext->SearchMatcher, StringToSearch, MatchOffset);
+    }
     if (Found != NULL) {
         if (MatchIndex != NULL) {
 
@@ -238,6 +255,7 @@ MoreSearchIndexFree(
 
     YoriLibInitEmptyString(&MoreContext->SearchStrings[Index]);
     MoreContext->SearchContext[Index].ColorIndex = (UCHAR)-1;
+    MoreContext->SearchMatcherStale = TRUE;
 }
 
 /**
@@ -314,23 +332,32 @@ MoreGetNextFilteredPhysicalLine(
     __in_opt PMORE_PHYSICAL_LINE PreviousLine
     )
 {
-    PYORI_LIST_ENTRY ListEntry;
     PMORE_PHYSICAL_LINE ThisLine;
 
+    //
+    //  If no filter is in effect, every physical line is a filtered line.
+    //  If the previous line doesn't match the current filter, it has no
+    //  position among filtered lines, so there is no next line.
+    //
+
     if (PreviousLine != NULL) {
-        ListEntry = YoriLibGetNextListEntry(&MoreContext->FilteredPhysicalLineList, &PreviousLine->FilteredLineList);
+        if (!MoreContext->FilteredLinesIndexed) {
+            return MoreGetPhysicalLine(MoreContext, PreviousLine->LineNumber + 1);
+        }
+        if (PreviousLine->FilteredLineNumber == 0) {
+            return NULL;
+        }
+        ThisLine = MoreGetFilteredPhysicalLine(MoreContext, PreviousLine->FilteredLineNumber + 1);
     } else {
-        ListEntry = YoriLibGetNextListEntry(&MoreContext->FilteredPhysicalLineList, NULL);
+        ThisLine = MoreGetFilteredPhysicalLine(MoreContext, 1);
     }
 
-    if (ListEntry == NULL) {
+    if (ThisLine == NULL) {
         return NULL;
     }
 
-    ThisLine = CONTAINING_RECORD(ListEntry, MORE_PHYSICAL_LINE, FilteredLineList);
-
     //
-    //  Check that the list is sorted
+    //  Check that the index is sorted
     //
 
     ASSERT(PreviousLine == NULL || ThisLine->FilteredLineNumber == PreviousLine->FilteredLineNumber + 1);
@@ -359,23 +386,26 @@ MoreGetPreviousFilteredPhysicalLine(
     __in_opt PMORE_PHYSICAL_LINE NextLine
     )
 {
-    PYORI_LIST_ENTRY ListEntry;
     PMORE_PHYSICAL_LINE ThisLine;
 
     if (NextLine != NULL) {
-        ListEntry = YoriLibGetPreviousListEntry(&MoreContext->FilteredPhysicalLineList, &NextLine->FilteredLineList);
+        if (!MoreContext->FilteredLinesIndexed) {
+            return MoreGetPhysicalLine(MoreContext, NextLine->LineNumber - 1);
+        }
+        if (NextLine->FilteredLineNumber == 0) {
+            return NULL;
+        }
+        ThisLine = MoreGetFilteredPhysicalLine(MoreContext, NextLine->FilteredLineNumber - 1);
     } else {
-        ListEntry = YoriLibGetPreviousListEntry(&MoreContext->FilteredPhysicalLineList, NULL);
+        ThisLine = MoreGetFilteredPhysicalLine(MoreContext, MoreContext->FilteredLineCount);
     }
 
-    if (ListEntry == NULL) {
+    if (ThisLine == NULL) {
         return NULL;
     }
 
-    ThisLine = CONTAINING_RECORD(ListEntry, MORE_PHYSICAL_LINE, FilteredLineList);
-
     //
-    //  Check that the list is sorted
+    //  Check that the index is sorted
     //
 
     ASSERT(NextLine == NULL || ThisLine->FilteredLineNumber + 1 == NextLine->FilteredLineNumber);
@@ -383,98 +413,6 @@ MoreGetPreviousFilteredPhysicalLine(
     return ThisLine;
 }
 
-/**
- Apply a new search criteria to update the set of filtered lines.
-
- MSFIX This routine wants to be much smarter.  Ideally it would initiate an
- asynchronous process that gets synchronized when next/previous lines are
- needed.  This would allow the display to rapidly update while the number of
- filtered lines is updated in the background (refreshing the status line.)
-
- @param MoreContext Pointer to the more context, indicating the current search
-        terms.
-
- @param PreviousStartPoint Optionally points to a physical line which is
-        currently displayed.  If specified, this function attempts to return
-        a "good" physical line to display once the new filter has been
-        applied.
-
- @return Pointer to a physical line which should be used to display after the
-         filter has been updated.
- */
-PMORE_PHYSICAL_LINE
-MoreUpdateFilteredLines(
-    __in PMORE_CONTEXT MoreContext,
-    __in_opt PMORE_PHYSICAL_LINE PreviousStartPoint
-    )
-{
-    PYORI_LIST_ENTRY ListEntry;
-    PMORE_PHYSICAL_LINE PreviousFilteredLine;
-    PMORE_PHYSICAL_LINE ThisLine;
-    BOOLEAN MatchFound;
-    DWORDLONG FilteredLineNumber;
-    DWORDLONG PreviousStartLineNumber;
-    PMORE_PHYSICAL_LINE NewStartPoint;
-
-    PreviousStartLineNumber = 0;
-    NewStartPoint = NULL;
-    if (PreviousStartPoint != NULL) {
-        PreviousStartLineNumber = PreviousStartPoint->LineNumber;
-    }
-
-    WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
-
-    PreviousFilteredLine = NULL;
-    FilteredLineNumber = 0;
-    ListEntry = YoriLibGetNextListEntry(&MoreContext->PhysicalLineList, NULL);
-
-    while (ListEntry != NULL) {
-
-        ThisLine = CONTAINING_RECORD(ListEntry, MORE_PHYSICAL_LINE, LineList);
-        if (MoreContext->FilterToSearch) {
-            MatchFound = MoreFindNextSearchMatch(MoreContext, &ThisLine->LineContents, NULL, NULL);
-        } else {
-            MatchFound = TRUE;
-        }
-
-        if (!MatchFound) {
-            if (ThisLine->FilteredLineList.Next != NULL) {
-                ASSERT(MoreContext->FilteredLineCount > 0);
-                MoreContext->FilteredLineCount--;
-                YoriLibRemoveListItem(&ThisLine->FilteredLineList);
-                ThisLine->FilteredLineList.Next = NULL;
-            }
-        } else {
-            if (ThisLine->FilteredLineList.Next == NULL) {
-                if (PreviousFilteredLine != NULL) {
-                    ASSERT(ThisLine->LineNumber > PreviousFilteredLine->LineNumber);
-                    YoriLibInsertList(&PreviousFilteredLine->FilteredLineList, &ThisLine->FilteredLineList);
-                } else {
-                    YoriLibInsertList(&MoreContext->FilteredPhysicalLineList, &ThisLine->FilteredLineList);
-                }
-                MoreContext->FilteredLineCount++;
-                ASSERT(MoreContext->FilteredLineCount <= MoreContext->LineCount);
-            }
-            FilteredLineNumber++;
-            ThisLine->FilteredLineNumber = FilteredLineNumber;
-            PreviousFilteredLine = ThisLine;
-            if (NewStartPoint == NULL && ThisLine->LineNumber >= PreviousStartLineNumber) {
-                NewStartPoint = ThisLine;
-            }
-        }
-
-
-        ListEntry = YoriLibGetNextListEntry(&MoreContext->PhysicalLineList, &ThisLine->LineList);
-    }
-
-    ASSERT(MoreContext->FilteredLineCount == FilteredLineNumber);
-
-    ReleaseMutex(MoreContext->PhysicalLineMutex);
-
-    return NewStartPoint;
-}
-
-
 /**
  Return the number of characters within a subset of a physical line which
  will form a logical line.  Conceptually this represents either the minimum
@@ -0,0 +1,525 @@
+/**
+ * @file more/linestor.c
+ *
+ * Yori shell more store of physical lines indexed by line number
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "more.h"
+
+/**
+ Initialize an index of elements, allocating its array of directories.
+
+ @param Index Pointer to the index to initialize.
+
+ @return TRUE to indicate success, FALSE to indicate allocation failure.
+ */
+__success(return)
+BOOLEAN
+MoreLineIndexInitialize(
+    __out PMORE_LINE_INDEX Index
+    )
+{
+    Index->Directories = YoriLibMalloc(sizeof(PVOID *) * MORE_DIRECTORIES_PER_INDEX);
+    if (Index->Directories == NULL) {
+        return FALSE;
+    }
+
+    ZeroMemory(Index->Directories, sizeof(PVOID *) * MORE_DIRECTORIES_PER_INDEX);
+    return TRUE;
+}
+
+/**
+ Free all blocks and directories within an index of elements.
+
+ @param Index Pointer to the index to free.
+ */
+VOID
+MoreLineIndexFree(
+    __inout PMORE_LINE_INDEX Index
+    )
+{
+    DWORD DirectoryIndex;
+    DWORD BlockIndex;
+    PVOID *Directory;
+
+    if (Index->Directories == NULL) {
+        return;
+    }
+
+    for (DirectoryIndex = 0; DirectoryIndex < MORE_DIRECTORIES_PER_INDEX; DirectoryIndex++) {
+        Directory = Index->Directories[DirectoryIndex];
+        if (Directory == NULL) {
+            continue;
+        }
+
+        for (BlockIndex = 0; BlockIndex < MORE_BLOCKS_PER_DIRECTORY; BlockIndex++) {
+            if (Directory[BlockIndex] != NULL) {
+                YoriLibFree(Directory[BlockIndex]);
+            }
+        }
+
+        YoriLibFree(Directory);
+    }
+
+    YoriLibFree(Index->Directories);
+    Index->Directories = NULL;
+}
+
+/**
+ Return a pointer to an element within an index of elements.  This does not
+ require synchronization, because blocks never move once allocated, but the
+ caller is responsible for only looking at elements known to be populated.
+
+ @param Index Pointer to the index.
+
+ @param ElementSize The size of each element in the index, in bytes.
+
+ @param ElementNumber The zero based number of the element to return.
+
+ @return Pointer to the element, or NULL if the block containing the element
+         has not been allocated.
+ */
+__success(return != NULL)
+PVOID
+MoreLineIndexGetElement(
+    __in PMORE_LINE_INDEX Index,
+    __in YORI_ALLOC_SIZE_T ElementSize,
+    __in DWORDLONG ElementNumber
+    )
+{
+    DWORDLONG BlockNumber;
+    DWORD DirectoryIndex;
+    DWORD BlockIndex;
+    DWORD IndexInBlock;
+    PVOID *Directory;
+    PUCHAR Block;
+
+    if (Index->Directories == NULL) {
+        return NULL;
+    }
+
+    BlockNumber = ElementNumber / MORE_LINES_PER_BLOCK;
+    if (BlockNumber >= (DWORDLONG)MORE_BLOCKS_PER_DIRECTORY * MORE_DIRECTORIES_PER_INDEX) {
+        return NULL;
+    }
+
+    DirectoryIndex = (DWORD)(BlockNumber / MORE_BLOCKS_PER_DIRECTORY);
+    BlockIndex = (DWORD)(BlockNumber % MORE_BLOCKS_PER_DIRECTORY);
+    IndexInBlock = (DWORD)(ElementNumber % MORE_LINES_PER_BLOCK);
+
+    Directory = Index->Directories[DirectoryIndex];
+    if (Directory == NULL) {
+        return NULL;
+    }
+
+    Block = Directory[BlockIndex];
+    if (Block == NULL) {
+        return NULL;
+    }
+
+    return Block + IndexInBlock * ElementSize;
+}
+
+/**
+ Return a pointer to an element within an index of elements, allocating the
+ block containing it if it has not been allocated yet.  The caller is
+ expected to hold MORE_CONTEXT::PhysicalLineMutex so that blocks are only
+ allocated by one thread at a time.
+
+ @param Index Pointer to the index.
+
+ @param ElementSize The size of each element in the index, in bytes.
+
+ @param ElementNumber The zero based number of the element to return.
+
+ @return Pointer to the element, or NULL on allocation failure or if the
+         element number exceeds the capacity of the index.
+ */
+__success(return != NULL)
+PVOID
+MoreLineIndexAllocateElement(
+    __inout PMORE_LINE_INDEX Index,
+    __in YORI_ALLOC_SIZE_T ElementSize,
+    __in DWORDLONG ElementNumber
+    )
+{
+    DWORDLONG BlockNumber;
+    DWORD DirectoryIndex;
+    DWORD BlockIndex;
+    PVOID *Directory;
+    PVOID Block;
+
+    if (Index->Directories == NULL) {
+        return NULL;
+    }
+
+    BlockNumber = ElementNumber / MORE_LINES_PER_BLOCK;
+    if (BlockNumber >= (DWORDLONG)MORE_BLOCKS_PER_DIRECTORY * MORE_DIRECTORIES_PER_INDEX) {
+        return NULL;
+    }
+
+    DirectoryIndex = (DWORD)(BlockNumber / MORE_BLOCKS_PER_DIRECTORY);
+    BlockIndex = (DWORD)(BlockNumber % MORE_BLOCKS_PER_DIRECTORY);
+
+    Directory = Index->Directories[DirectoryIndex];
+    if (Directory == NULL) {
+        Directory = YoriLibMalloc(sizeof(PVOID) * MORE_BLOCKS_PER_DIRECTORY);
+        if (Directory == NULL) {
+            return NULL;
+        }
+        ZeroMemory(Directory, sizeof(PVOID) * MORE_BLOCKS_PER_DIRECTORY);
+        Index->Directories[DirectoryIndex] = Directory;
+    }
+
+    if (Directory[BlockIndex] == NULL) {
+        Block = YoriLibMalloc(ElementSize * MORE_LINES_PER_BLOCK);
+        if (Block == NULL) {
+            return NULL;
+        }
+        ZeroMemory(Block, ElementSize * MORE_LINES_PER_BLOCK);
+        Directory[BlockIndex] = Block;
+    }
+
+    return MoreLineIndexGetElement(Index, ElementSize, ElementNumber);
+}
+
+/**
+ Initialize the store of physical lines on the more context.
+
+ @param MoreContext Pointer to the more context.
+
+ @return TRUE to indicate success, FALSE to indicate allocation failure.
+ */
+__success(return)
+BOOLEAN
+MoreInitializeLineStore(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    if (!MoreLineIndexInitialize(&MoreContext->PhysicalLines)) {
+        return FALSE;
+    }
+
+    if (!MoreLineIndexInitialize(&MoreContext->FilteredLines)) {
+        MoreLineIndexFree(&MoreContext->PhysicalLines);
+        return FALSE;
+    }
+
+    if (!MoreLineIndexInitialize(&MoreContext->CandidateLines)) {
+        MoreLineIndexFree(&MoreContext->FilteredLines);
+        MoreLineIndexFree(&MoreContext->PhysicalLines);
+        return FALSE;
+    }
+
+    MoreContext->LineCount = 0;
+    MoreContext->FilteredLineCount = 0;
+    MoreContext->CandidateLineCount = 0;
+    MoreContext->FilteredLinesIndexed = FALSE;
+    return TRUE;
+}
+
+/**
+ Free all physical lines and the store containing them.  The ingest thread
+ must have terminated before calling this function.
+
+ @param MoreContext Pointer to the more context.
+ */
+VOID
+MoreFreeLineStore(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    DWORDLONG LineNumber;
+    PMORE_PHYSICAL_LINE PhysicalLine;
+    PVOID PreviousMemoryToFree;
+
+    //
+    //  Lines within a text allocation are contiguous, and the store holds
+    //  one reference on each allocation, so release it each time the
+    //  allocation changes.
+    //
+
+    PreviousMemoryToFree = NULL;
+    for (LineNumber = 1; LineNumber <= MoreContext->LineCount; LineNumber++) {
+        PhysicalLine = MoreGetPhysicalLine(MoreContext, LineNumber);
+        if (PhysicalLine == NULL) {
+            break;
+        }
+
+        if (PhysicalLine->MemoryToFree != PreviousMemoryToFree) {
+            PreviousMemoryToFree = PhysicalLine->MemoryToFree;
+            YoriLibDereference(PreviousMemoryToFree);
+        }
+    }
+
+    MoreLineIndexFree(&MoreContext->CandidateLines);
+    MoreLineIndexFree(&MoreContext->FilteredLines);
+    MoreLineIndexFree(&MoreContext->PhysicalLines);
+    MoreContext->LineCount = 0;
+    MoreContext->FilteredLineCount = 0;
+    MoreContext->CandidateLineCount = 0;
+    MoreContext->FilteredLinesIndexed = FALSE;
+}
+
+/**
+ Return storage for the next physical line to be added.  This is called from
+ the ingest thread, which is the only thread adding physical lines.  The
+ line is not visible to other threads until the caller increments
+ MORE_CONTEXT::LineCount with PhysicalLineMutex held.
+
+ @param MoreContext Pointer to the more context.
+
+ @return Pointer to the physical line, with its LineNumber populated, or NULL
+         on allocation failure.
+ */
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreAllocatePhysicalLine(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_PHYSICAL_LINE NewLine;
+
+    //
+    //  Most of the time the block already exists, and since only this
+    //  thread allocates physical lines, it can be checked without the
+    //  mutex.  A new block is only allocated once per MORE_LINES_PER_BLOCK
+    //  lines.
+    //
+
+    NewLine = MoreLineIndexGetElement(&MoreContext->PhysicalLines, sizeof(MORE_PHYSICAL_LINE), MoreContext->LineCount);
+    if (NewLine == NULL) {
+        WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
+        NewLine = MoreLineIndexAllocateElement(&MoreContext->PhysicalLines, sizeof(MORE_PHYSICAL_LINE), MoreContext->LineCount);
+        ReleaseMutex(MoreContext->PhysicalLineMutex);
+        if (NewLine == NULL) {
+            return NULL;
+        }
+    }
+
+    NewLine->LineNumber = MoreContext->LineCount + 1;
+    NewLine->FilteredLineNumber = 0;
+    return NewLine;
+}
+
+/**
+ Return the physical line with the specified line number.
+
+ @param MoreContext Pointer to the more context.
+
+ @param LineNumber The line number to return.  The first line is one.
+
+ @return Pointer to the physical line, or NULL if no line with this line
+         number exists.
+ */
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreGetPhysicalLine(
+    __in PMORE_CONTEXT MoreContext,
+    __in DWORDLONG LineNumber
+    )
+{
+    if (LineNumber == 0 || LineNumber > MoreContext->LineCount) {
+        return NULL;
+    }
+
+    return MoreLineIndexGetElement(&MoreContext->PhysicalLines, sizeof(MORE_PHYSICAL_LINE), LineNumber - 1);
+}
+
+/**
+ Add a physical line to the end of the set of lines matching the filter
+ criteria.  The caller must hold PhysicalLineMutex, and lines must be added
+ in ascending line number order.
+
+ @param MoreContext Pointer to the more context.
+
+ @param PhysicalLine Pointer to the physical line which matches the filter
+        criteria.  Its FilteredLineNumber is updated by this function.
+
+ @return TRUE to indicate success, FALSE to indicate allocation failure.
+ */
+__success(return)
+BOOLEAN
+MoreAppendFilteredPhysicalLine(
+    __inout PMORE_CONTEXT MoreContext,
+    __in PMORE_PHYSICAL_LINE PhysicalLine
+    )
+{
+    PMORE_PHYSICAL_LINE *Entry;
+
+    Entry = MoreLineIndexAllocateElement(&MoreContext->FilteredLines, sizeof(PMORE_PHYSICAL_LINE), MoreContext->FilteredLineCount);
+    if (Entry == NULL) {
+        return FALSE;
+    }
+
+    *Entry = PhysicalLine;
+    MoreContext->FilteredLineCount++;
+    PhysicalLine->FilteredLineNumber = MoreContext->FilteredLineCount;
+    return TRUE;
+}
+
+/**
+ Return the physical line with the specified filtered line number.  If no
+ filter is in effect, this is the same as the physical line number.
+
+ @param MoreContext Pointer to the more context.
+
+ @param FilteredLineNumber The filtered line number to return.  The first
+        line is one.
+
+ @return Pointer to the physical line, or NULL if no line with this filtered
+         line number exists.
+ */
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreGetFilteredPhysicalLine(
+    __in PMORE_CONTEXT MoreContext,
+    __in DWORDLONG FilteredLineNumber
+    )
+{
+    PMORE_PHYSICAL_LINE *Entry;
+
+    if (FilteredLineNumber == 0 || FilteredLineNumber > MoreContext->FilteredLineCount) {
+        return NULL;
+    }
+
+    if (!MoreContext->FilteredLinesIndexed) {
+        return MoreGetPhysicalLine(MoreContext, FilteredLineNumber);
+    }
+
+    Entry = MoreLineIndexGetElement(&MoreContext->FilteredLines, sizeof(PMORE_PHYSICAL_LINE), FilteredLineNumber - 1);
+    if (Entry == NULL) {
+        return NULL;
+    }
+
+    return *Entry;
+}
+
+/**
+ Return the first filtered physical line whose physical line number is at or
+ after a specified line number.  Since filtered lines are in ascending
+ physical line order, this is a binary search.
+
+ @param MoreContext Pointer to the more context.
+
+ @param LineNumber The physical line number to search for.
+
+ @return Pointer to the physical line, or NULL if no filtered line is at or
+         after the specified line number.
+ */
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreFindFilteredPhysicalLineAtOrAfter(
+    __in PMORE_CONTEXT MoreContext,
+    __in DWORDLONG LineNumber
+    )
+{
+    DWORDLONG Low;
+    DWORDLONG High;
+    DWORDLONG Middle;
+    PMORE_PHYSICAL_LINE ThisLine;
+
+    WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
+
+    //
+    //  Find the lowest filtered line number in the range [Low, High] whose
+    //  physical line number is at least LineNumber.  High is one beyond
+    //  the final filtered line if no such line exists.
+    //
+
+    Low = 1;
+    High = MoreContext->FilteredLineCount + 1;
+    while (Low < High) {
+        Middle = Low + (High - Low) / 2;
+        ThisLine = MoreGetFilteredPhysicalLine(MoreContext, Middle);
+        if (ThisLine == NULL) {
+            break;
+        }
+        if (ThisLine->LineNumber >= LineNumber) {
+            High = Middle;
+        } else {
+            Low = Middle + 1;
+        }
+    }
+
+    ThisLine = MoreGetFilteredPhysicalLine(MoreContext, Low);
+    ReleaseMutex(MoreContext->PhysicalLineMutex);
+
+    return ThisLine;
+}
+
+/**
+ Move the current set of filtered lines to be the set of candidate lines,
+ leaving the set of filtered lines empty.  The caller must hold
+ PhysicalLineMutex and ensure no filter thread is reading candidate lines.
+
+ @param MoreContext Pointer to the more context.
+ */
+VOID
+MoreMoveFilteredLinesToCandidates(
+    __inout PMORE_CONTEXT MoreContext
+    )
+{
+    MORE_LINE_INDEX Swap;
+
+    memcpy(&Swap, &MoreContext->CandidateLines, sizeof(MORE_LINE_INDEX));
+    memcpy(&MoreContext->CandidateLines, &MoreContext->FilteredLines, sizeof(MORE_LINE_INDEX));
+    memcpy(&MoreContext->FilteredLines, &Swap, sizeof(MORE_LINE_INDEX));
+
+    MoreContext->CandidateLineCount = MoreContext->FilteredLineCount;
+    MoreContext->FilteredLineCount = 0;
+}
+
+/**
+ Return the physical line for a specified candidate line.
+
+ @param MoreContext Pointer to the more context.
+
+ @param CandidateLineNumber The candidate line number to return.  The first
+        line is one.
+
+ @return Pointer to the physical line, or NULL if no candidate line with
+         this number exists.
+ */
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreGetCandidatePhysicalLine(
+    __in PMORE_CONTEXT MoreContext,
+    __in DWORDLONG CandidateLineNumber
+    )
+{
+    PMORE_PHYSICAL_LINE *Entry;
+
+    if (CandidateLineNumber == 0 || CandidateLineNumber > MoreContext->CandidateLineCount) {
+        return NULL;
+    }
+
+    Entry = MoreLineIndexGetElement(&MoreContext->CandidateLines, sizeof(PMORE_PHYSICAL_LINE), CandidateLineNumber - 1);
+    if (Entry == NULL) {
+        return NULL;
+    }
+
+    return *Entry;
+}
+
+// vim:sw=4:ts=4:et:
@@ -42,20 +42,10 @@
 typedef struct _MORE_PHYSICAL_LINE {
 
     /**
-     A list of physical lines.  Paired with MORE_CONTEXT::PhysicalLineList
-     and synchronized with MORE_CONTEXT::PhysicalLineMutex .
-     */
-    YORI_LIST_ENTRY LineList;
-
-    /**
-     A list of physical lines matching the current search criteria.  Paired
-     with MORE_CONTEXT::FilteredPhysicalLineList and synchronized with
-     MORE_CONTEXT::PhysicalLineMutex .
-     */
-    YORI_LIST_ENTRY FilteredLineList;
-
-    /**
-     Pointer to the referenced allocation that contains this physical line.
+     Pointer to the referenced text allocation that contains the contents of
+     this physical line.  The line store holds a single reference on each
+     text allocation on behalf of every line within it, so this is not
+     referenced per line, but callers can reference it to retain the text.
      */
     PVOID MemoryToFree;
 
@@ -73,7 +63,8 @@ typedef struct _MORE_PHYSICAL_LINE {
     /**
      The number of this physical line within the set of lines which match the
      filter criteria.  If filtering is not enabled, this is the same as
-     LineNumber, above.
+     LineNumber, above.  If the line does not match the filter criteria,
+     this is zero.
      */
     DWORDLONG FilteredLineNumber;
 
@@ -83,6 +74,40 @@ typedef struct _MORE_PHYSICAL_LINE {
     YORI_STRING LineContents;
 } MORE_PHYSICAL_LINE, *PMORE_PHYSICAL_LINE;
 
+/**
+ The number of elements in each block of a line index.
+ */
+#define MORE_LINES_PER_BLOCK 2048
+
+/**
+ The number of blocks referenced by each directory of a line index.
+ */
+#define MORE_BLOCKS_PER_DIRECTORY 1024
+
+/**
+ The number of directories in a line index.  Combined with the above, this
+ bounds the number of lines that can be indexed.
+ */
+#define MORE_DIRECTORIES_PER_INDEX 1024
+
+/**
+ An index of fixed size elements, addressed by element number.  Elements are
+ allocated in blocks, and blocks are found via a two level lookup.  Since
+ neither blocks nor the arrays pointing to them are ever reallocated, an
+ element never moves once allocated, and a thread can read any element that
+ it knows has been populated without synchronizing with a thread adding
+ new elements.
+ */
+typedef struct _MORE_LINE_INDEX {
+
+    /**
+     An array of MORE_DIRECTORIES_PER_INDEX directories, each of which is an
+     array of MORE_BLOCKS_PER_DIRECTORY pointers to blocks.  Any of these
+     may be NULL if no element has been allocated within it.
+     */
+    PVOID **Directories;
+} MORE_LINE_INDEX, *PMORE_LINE_INDEX;
+
 /**
  A logical line, meaning a line rendered for display on the console.
  */
@@ -216,30 +241,266 @@ typedef struct _MORE_SEARCH_CONTEXT {
 
 } MORE_SEARCH_CONTEXT, *PMORE_SEARCH_CONTEXT;
 
+/**
+ The maximum number of threads used to apply a filter.
+ */
+#define MORE_MAX_FILTER_THREADS 16
+
+/**
+ The number of lines a filter thread evaluates between checks for whether
+ the filter has been cancelled.
+ */
+#define MORE_FILTER_CANCEL_CHECK_INTERVAL 64
+
+/**
+ A private copy of the search strings used to apply a filter.  This is
+ needed because the user can edit the search strings while a filter is
+ being applied.
+ */
+typedef struct _MORE_FILTER_CRITERIA {
+
+    /**
+     The number of search strings below which are in use.
+     */
+    UCHAR SearchCount;
+
+    /**
+     The strings to search for.  A line matches the filter if it contains
+     any of these.
+     */
+    YORI_STRING SearchStrings[MORE_MAX_SEARCHES];
+} MORE_FILTER_CRITERIA, *PMORE_FILTER_CRITERIA;
+
+/**
+ The result of applying a filter to a contiguous range of lines.  Each
+ chunk describes MORE_LINES_PER_BLOCK lines.
+ */
+typedef struct _MORE_FILTER_CHUNK {
+
+    /**
+     TRUE once a filter thread has evaluated every line in the chunk.
+     Synchronized with MORE_FILTER_CONTEXT::Mutex .
+     */
+    BOOLEAN Complete;
+
+    /**
+     A bitmap with one bit per line in the chunk, set if the line matches
+     the filter criteria.
+     */
+    DWORD MatchBitmap[MORE_LINES_PER_BLOCK / 32];
+} MORE_FILTER_CHUNK, *PMORE_FILTER_CHUNK;
+
+/**
+ A request to apply a filter to a range of lines.  The range is divided into
+ chunks which are evaluated by filter threads in any order, and are
+ published to the filtered line index in order.
+ */
+typedef struct _MORE_FILTER_JOB {
+
+    /**
+     The search criteria to apply.
+     */
+    MORE_FILTER_CRITERIA Criteria;
+
+    /**
+     A matcher prepared to search for all of the strings in Criteria at
+     once.  This is prepared before the job is visible to filter threads and
+     is not modified afterwards, so it can be used by any thread.
+     */
+    YORI_LIB_MULTI_MATCH Matcher;
+
+    /**
+     Nonzero if the job has been cancelled and filter threads should stop
+     evaluating lines for it.
+     */
+    LONG volatile Cancelled;
+
+    /**
+     TRUE if the lines to evaluate are the candidate lines from a previous
+     filter, because the new criteria can only match a subset of them.
+     FALSE if the lines to evaluate are a range of physical lines.
+     */
+    BOOLEAN Narrowing;
+
+    /**
+     If Narrowing is FALSE, the physical line number of the first line to
+     evaluate.  Unused if Narrowing is TRUE, where evaluation starts at the
+     first candidate line.
+     */
+    DWORDLONG FirstLineNumber;
+
+    /**
+     The number of lines to evaluate.
+     */
+    DWORDLONG LineCount;
+
+    /**
+     The physical line number of the last line covered by this job.  Lines
+     after this were added during the job and need to be evaluated by a
+     later job.
+     */
+    DWORDLONG LastLineNumber;
+
+    /**
+     The number of chunks in the Chunks array.
+     */
+    DWORD ChunkCount;
+
+    /**
+     The next chunk for a filter thread to evaluate.  Synchronized with
+     MORE_FILTER_CONTEXT::Mutex .
+     */
+    DWORD NextChunk;
+
+    /**
+     The number of chunks whose results have been added to the filtered
+     line index.  Only used by the viewport thread.
+     */
+    DWORD ChunksPublished;
+
+    /**
+     An array of ChunkCount chunks describing the results of the job.
+     */
+    PMORE_FILTER_CHUNK Chunks;
+} MORE_FILTER_JOB, *PMORE_FILTER_JOB;
+
+/**
+ State for applying filters on background threads.
+ */
+typedef struct _MORE_FILTER_CONTEXT {
+
+    /**
+     Synchronization between the viewport thread and filter threads.  This
+     protects Job, ActiveThreads, and the chunk state within Job.  If
+     MORE_CONTEXT::PhysicalLineMutex is also needed, it must be acquired
+     first.
+     */
+    HANDLE Mutex;
+
+    /**
+     A manual reset event which is set while a job has chunks that have not
+     been claimed by a filter thread.
+     */
+    HANDLE WorkAvailableEvent;
+
+    /**
+     A manual reset event which is set when no filter thread is evaluating
+     a chunk.
+     */
+    HANDLE ThreadsIdleEvent;
+
+    /**
+     An event which is signalled when a filter thread completes a chunk,
+     so the viewport thread can publish its results.
+     */
+    HANDLE ProgressEvent;
+
+    /**
+     A manual reset event which is set when filter threads should exit.
+     */
+    HANDLE ShutdownEvent;
+
+    /**
+     The number of filter threads in the Threads array.
+     */
+    DWORD ThreadCount;
+
+    /**
+     The number of filter threads currently evaluating a chunk.
+     */
+    DWORD ActiveThreads;
+
+    /**
+     Handles to the filter threads.
+     */
+    HANDLE Threads[MORE_MAX_FILTER_THREADS];
+
+    /**
+     The current job, or the most recently completed one.  Its criteria are
+     used to evaluate lines added after it completes.  NULL if no filter is
+     in effect.
+     */
+    PMORE_FILTER_JOB Job;
+
+    /**
+     TRUE if a job has lines whose results have not been published.  While
+     this is set, lines added by the ingest thread are not evaluated, and
+     are left for a later job.  Synchronized with
+     MORE_CONTEXT::PhysicalLineMutex .
+     */
+    BOOLEAN InProgress;
+
+    /**
+     TRUE if MORE_CONTEXT::CandidateLines contains the complete set of lines
+     matching CandidateCriteria, up to CandidateLastLineNumber.
+     */
+    BOOLEAN CandidatesValid;
+
+    /**
+     The criteria that generated the candidate lines.
+     */
+    MORE_FILTER_CRITERIA CandidateCriteria;
+
+    /**
+     The physical line number of the last line evaluated to generate the
+     candidate lines.
+     */
+    DWORDLONG CandidateLastLineNumber;
+
+    /**
+     TRUE if the viewport is waiting for the filter to find the first line
+     to display.  Only used by the viewport thread.
+     */
+    BOOLEAN StartPending;
+
+    /**
+     The physical line number that the viewport should start displaying from
+     once a matching line at or after it has been found.  Only used by the
+     viewport thread.
+     */
+    DWORDLONG StartLineNumber;
+} MORE_FILTER_CONTEXT, *PMORE_FILTER_CONTEXT;
+
 /**
  Context passed to the callback which is invoked for each file found.
  */
 typedef struct _MORE_CONTEXT {
 
     /**
-     A linked list of physical lines.
+     An index of physical lines, where each element is a MORE_PHYSICAL_LINE
+     and the element number is one less than the line number.
+     */
+    MORE_LINE_INDEX PhysicalLines;
+
+    /**
+     An index of physical lines matching the current search criteria, where
+     each element is a pointer to a MORE_PHYSICAL_LINE and the element
+     number is one less than the filtered line number.  This is only
+     maintained if FilteredLinesIndexed is TRUE.
+     */
+    MORE_LINE_INDEX FilteredLines;
+
+    /**
+     An index of physical lines matching a previous search criteria, in the
+     same form as FilteredLines.  When the search criteria is extended, only
+     these lines need to be evaluated.
      */
-    YORI_LIST_ENTRY PhysicalLineList;
+    MORE_LINE_INDEX CandidateLines;
 
     /**
-     A linked list of physical lines matching the current search criteria.
+     The number of lines in CandidateLines.
      */
-    YORI_LIST_ENTRY FilteredPhysicalLineList;
+    DWORDLONG CandidateLineCount;
 
     /**
-     Synchronization around PhysicalLineList.
+     Synchronization around adding to PhysicalLines and FilteredLines.
      */
     HANDLE PhysicalLineMutex;
 
     /**
-     An event that is signalled when new lines are added to the
-     PhysicalLineList in case the viewport thread wants to update display
-     when lines are added.
+     An event that is signalled when new lines are added to PhysicalLines
+     in case the viewport thread wants to update display when lines are
+     added.
      */
     HANDLE PhysicalLineAvailableEvent;
 
@@ -269,14 +530,14 @@ typedef struct _MORE_CONTEXT {
 
     /**
      An array of size ViewportHeight of lines currently displayed.  Note these
-     refer to the strings in the PhysicalLineList.
+     refer to the strings in PhysicalLines.
      */
     PMORE_LOGICAL_LINE DisplayViewportLines;
 
     /**
      An array of size ViewportHeight of lines that are being constructed to
-     display in future.  Note these refer to the strings in the
-     PhysicalLineList.
+     display in future.  Note these refer to the strings in
+     PhysicalLines.
      */
     PMORE_LOGICAL_LINE StagingViewportLines;
 
@@ -342,6 +603,18 @@ typedef struct _MORE_CONTEXT {
      */
     UCHAR SearchColors[MORE_MAX_SEARCHES];
 
+    /**
+     A matcher prepared to search for all of SearchStrings at once.  This is
+     only valid if SearchMatcherStale is FALSE.
+     */
+    YORI_LIB_MULTI_MATCH SearchMatcher;
+
+    /**
+     TRUE if SearchStrings have changed since SearchMatcher was prepared,
+     so it needs to be prepared again before searching.
+     */
+    BOOLEAN SearchMatcherStale;
+
     /**
      Indicates the current color that the user is manipulating.  This can
      be 0-8, where the user switches them with Ctrl+1 - Ctrl+9.
@@ -440,6 +713,19 @@ typedef struct _MORE_CONTEXT {
      */
     DWORDLONG FilteredLineCount;
 
+    /**
+     TRUE if FilteredLines describes the set of lines matching the filter
+     criteria.  FALSE if no filter is in effect, and each filtered line
+     number is the same as the physical line number.  This is only changed
+     when the set of filtered lines is rebuilt, with PhysicalLineMutex held.
+     */
+    BOOLEAN FilteredLinesIndexed;
+
+    /**
+     State for applying filters on background threads.
+     */
+    MORE_FILTER_CONTEXT Filter;
+
 } MORE_CONTEXT, *PMORE_CONTEXT;
 
 VOID
@@ -586,10 +872,88 @@ MoreFindPreviousLineWithSearchMatch(
     __out_opt PYORI_ALLOC_SIZE_T LogicalLinesMoved
     );
 
+BOOLEAN
+MoreFilterDoesLineMatch(
+    __in PMORE_FILTER_JOB Job,
+    __in PCYORI_STRING LineContents
+    );
+
+__success(return)
+BOOLEAN
+MoreStartFilter(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+VOID
+MoreStopFilter(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+BOOLEAN
+MorePublishFilterResults(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+VOID
+MoreFilterCleanup(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+__success(return)
+BOOLEAN
+MoreInitializeLineStore(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+VOID
+MoreFreeLineStore(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreAllocatePhysicalLine(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreGetPhysicalLine(
+    __in PMORE_CONTEXT MoreContext,
+    __in DWORDLONG LineNumber
+    );
+
+__success(return)
+BOOLEAN
+MoreAppendFilteredPhysicalLine(
+    __inout PMORE_CONTEXT MoreContext,
+    __in PMORE_PHYSICAL_LINE PhysicalLine
+    );
+
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreGetFilteredPhysicalLine(
+    __in PMORE_CONTEXT MoreContext,
+    __in DWORDLONG FilteredLineNumber
+    );
+
+__success(return != NULL)
+PMORE_PHYSICAL_LINE
+MoreFindFilteredPhysicalLineAtOrAfter(
+    __in PMORE_CONTEXT MoreContext,
+    __in DWORDLONG LineNumber
+    );
+
+VOID
+MoreMoveFilteredLinesToCandidates(
+    __inout PMORE_CONTEXT MoreContext
+    );
+
+__success(return != NULL)
 PMORE_PHYSICAL_LINE
-MoreUpdateFilteredLines(
+MoreGetCandidatePhysicalLine(
     __in PMORE_CONTEXT MoreContext,
-    __in_opt PMORE_PHYSICAL_LINE PreviousStartPoint
+    __in DWORDLONG CandidateLineNumber
     );
 
 // vim:sw=4:ts=4:et:
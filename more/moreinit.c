@@ -168,8 +168,10 @@ MoreInitContext(
     MoreContext->WaitForMore = WaitForMore;
     MoreContext->TabWidth = 4;
 
-    YoriLibInitializeListHead(&MoreContext->PhysicalLineList);
-    YoriLibInitializeListHead(&MoreContext->FilteredPhysicalLineList);
+    if (!MoreInitializeLineStore(MoreContext)) {
+        return FALSE;
+    }
+
     MoreContext->PhysicalLineMutex = CreateMutex(NULL, FALSE, NULL);
     if (MoreContext->PhysicalLineMutex == NULL) {
         return FALSE;
@@ -209,6 +211,7 @@ MoreInitContext(
     }
 
     MoreContext->SearchColorIndex = 0;
+    MoreContext->SearchMatcherStale = TRUE;
 
     MoreGetViewportDimensions(&ScreenInfo, &MoreContext->ViewportWidth, &MoreContext->ViewportHeight);
 
@@ -241,8 +244,8 @@ MoreCleanupContext(
 {
     YORI_ALLOC_SIZE_T Index;
 
-    ASSERT(YoriLibIsListEmpty(&MoreContext->PhysicalLineList));
-    ASSERT(YoriLibIsListEmpty(&MoreContext->FilteredPhysicalLineList));
+    MoreFilterCleanup(MoreContext);
+    MoreFreeLineStore(MoreContext);
 
     if (MoreContext->DisplayViewportLines != NULL) {
         YoriLibFree(MoreContext->DisplayViewportLines);
@@ -279,6 +282,8 @@ MoreCleanupContext(
         MoreContext->SearchContext[Index].ColorIndex = (UCHAR)-1;
     }
 
+    YoriLibMultiMatchCleanup(&MoreContext->SearchMatcher);
+    MoreContext->SearchMatcherStale = TRUE;
     MoreContext->SearchColorIndex = 0;
 }
 
@@ -294,8 +299,6 @@ MoreGracefulExit(
     __inout PMORE_CONTEXT MoreContext
     )
 {
-    PYORI_LIST_ENTRY ListEntry;
-    PMORE_PHYSICAL_LINE PhysicalLine;
     YORI_ALLOC_SIZE_T Index;
 
     YoriLibCancelSet();
@@ -305,22 +308,6 @@ MoreGracefulExit(
         YoriLibFreeStringContents(&MoreContext->DisplayViewportLines[Index].Line);
     }
 
-    ListEntry = YoriLibGetNextListEntry(&MoreContext->FilteredPhysicalLineList, NULL);
-    while (ListEntry != NULL) {
-        PhysicalLine = CONTAINING_RECORD(ListEntry, MORE_PHYSICAL_LINE, LineList);
-        YoriLibRemoveListItem(ListEntry);
-        ListEntry = YoriLibGetNextListEntry(&MoreContext->FilteredPhysicalLineList, NULL);
-    }
-
-    ListEntry = YoriLibGetNextListEntry(&MoreContext->PhysicalLineList, NULL);
-    while (ListEntry != NULL) {
-        PhysicalLine = CONTAINING_RECORD(ListEntry, MORE_PHYSICAL_LINE, LineList);
-        YoriLibRemoveListItem(ListEntry);
-        YoriLibFreeStringContents(&PhysicalLine->LineContents);
-        YoriLibDereference(PhysicalLine->MemoryToFree);
-        ListEntry = YoriLibGetNextListEntry(&MoreContext->PhysicalLineList, NULL);
-    }
-
     MoreCleanupContext(MoreContext);
 }
 
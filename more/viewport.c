@@ -822,6 +822,15 @@ MoreAddNewLinesToViewport(
     YORI_ALLOC_SIZE_T LinesReturned;
     BOOLEAN Success;
 
+    //
+    //  If a filter is being applied and hasn't yet found the line to start
+    //  displaying from, don't display lines before it.
+    //
+
+    if (MoreContext->Filter.StartPending) {
+        return;
+    }
+
     WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
 
     //
@@ -1657,8 +1666,6 @@ MoreAreMoreLinesAvailable(
 {
     DWORDLONG LastViewportLineNumber;
     DWORDLONG LastPhysicalLineNumber;
-    PYORI_LIST_ENTRY ListEntry;
-    PMORE_PHYSICAL_LINE LastPhysicalLine;
     PMORE_LOGICAL_LINE LastViewportLine;
 
     //
@@ -1691,9 +1698,7 @@ MoreAreMoreLinesAvailable(
     LastViewportLineNumber = LastViewportLine->PhysicalLine->LineNumber;
 
     WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
-    ListEntry = YoriLibGetPreviousListEntry(&MoreContext->PhysicalLineList, NULL);
-    LastPhysicalLine = CONTAINING_RECORD(ListEntry, MORE_PHYSICAL_LINE, LineList);
-    LastPhysicalLineNumber = LastPhysicalLine->LineNumber;
+    LastPhysicalLineNumber = MoreContext->LineCount;
     ReleaseMutex(MoreContext->PhysicalLineMutex);
 
     if (LastPhysicalLineNumber > LastViewportLineNumber) {
@@ -1705,8 +1710,10 @@ MoreAreMoreLinesAvailable(
 
 /**
  Apply search changes that could affect the set of lines being filtered.
- This applies the new filter, then displays the new set of lines in the
- viewport, and indicates that the status line needs to be redrawn.
+ If filtering is enabled, this starts applying the new filter on background
+ threads and clears the viewport, which is populated as results are found.
+ If filtering is disabled, this displays all lines in the viewport.  In
+ both cases the status line needs to be redrawn.
 
  @param MoreContext Pointer to the more context.
  */
@@ -1716,10 +1723,33 @@ MoreRefreshFilteredLinesDisplay(
     )
 {
     PMORE_PHYSICAL_LINE NewStart;
+    DWORDLONG StartLineNumber;
+
+    NewStart = NULL;
+    StartLineNumber = 0;
     if (MoreContext->LinesInViewport > 0) {
-        NewStart = MoreUpdateFilteredLines(MoreContext, MoreContext->DisplayViewportLines[0].PhysicalLine);
+        NewStart = MoreContext->DisplayViewportLines[0].PhysicalLine;
+        StartLineNumber = NewStart->LineNumber;
+    } else if (MoreContext->Filter.StartPending) {
+        StartLineNumber = MoreContext->Filter.StartLineNumber;
+    }
+
+    if (MoreContext->FilterToSearch) {
+        if (!MoreStartFilter(MoreContext)) {
+            MoreContext->OutOfMemory = TRUE;
+            return;
+        }
+        MoreContext->Filter.StartPending = TRUE;
+        MoreContext->Filter.StartLineNumber = StartLineNumber;
+        NewStart = NULL;
     } else {
-        NewStart = MoreUpdateFilteredLines(MoreContext, NULL);
+        MoreStopFilter(MoreContext);
+        MoreContext->Filter.StartPending = FALSE;
+        if (NewStart == NULL && StartLineNumber > 0) {
+            WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
+            NewStart = MoreGetPhysicalLine(MoreContext, StartLineNumber);
+            ReleaseMutex(MoreContext->PhysicalLineMutex);
+        }
     }
 
     //
@@ -1734,7 +1764,9 @@ MoreRefreshFilteredLinesDisplay(
     MoreContext->LinesInViewport = 0;
     MoreContext->LinesInPage = 0;
     MoreContext->SearchDirty = TRUE;
-    MoreGenerateEntireViewportWithStartingLine(MoreContext, NewStart);
+    if (!MoreContext->Filter.StartPending) {
+        MoreGenerateEntireViewportWithStartingLine(MoreContext, NewStart);
+    }
 }
 
 /**
@@ -1793,7 +1825,18 @@ MoreAppendToSearchString(
         SearchString->LengthInChars = SearchString->LengthInChars + String->LengthInChars;
     }
     MoreContext->SearchContext[SearchIndex].ColorIndex = MoreContext->SearchColorIndex;
+    MoreContext->SearchMatcherStale = TRUE;
     MoreContext->SearchDirty = TRUE;
+
+    //
+    //  Filters are applied in the background, so the filter can be updated
+    //  as the user types.  Since this extends the search string, only lines
+    //  matching the previous filter need to be searched.
+    //
+
+    if (MoreContext->FilterToSearch) {
+        MoreRefreshFilteredLinesDisplay(MoreContext);
+    }
     return TRUE;
 }
 
@@ -1957,15 +2000,16 @@ MoreProcessKeyDown(
                     }
                 } else {
                     SearchString->LengthInChars = SearchString->LengthInChars - InputRecord->Event.KeyEvent.wRepeatCount;
+                    MoreContext->SearchMatcherStale = TRUE;
+                    if (MoreContext->FilterToSearch) {
+                        MoreRefreshFilteredLinesDisplay(MoreContext);
+                    }
                 }
                 MoreContext->SearchDirty = TRUE;
             } else if (Char == '\r') {
                 if (YoriLibIsSelectionActive(&MoreContext->Selection)) {
                     MoreCopySelectionIfPresent(MoreContext);
                 } else if (MoreContext->SearchUiActive) {
-                    if (MoreContext->FilterToSearch) {
-                        MoreRefreshFilteredLinesDisplay(MoreContext);
-                    }
                     MoreContext->SearchUiActive = FALSE;
                     MoreContext->SearchDirty = TRUE;
                 }
@@ -2241,6 +2285,48 @@ MoreCheckForStatusLineChange(
     }
 }
 
+/**
+ Publish results found by filter threads and update the viewport to display
+ them.  Until a matching line at or after the line previously at the top of
+ the viewport is found, nothing is displayed, so the display stays at the
+ same position in the data.  After that, lines are added to the viewport as
+ they are found, the same way as lines arriving from the ingest thread.
+
+ @param MoreContext Pointer to the more context.
+ */
+VOID
+MoreProcessFilterProgress(
+    __in PMORE_CONTEXT MoreContext
+    )
+{
+    PMORE_PHYSICAL_LINE NewStart;
+
+    if (!MorePublishFilterResults(MoreContext)) {
+        return;
+    }
+
+    //
+    //  If the user has navigated to display something while waiting, stop
+    //  waiting for the original position.
+    //
+
+    if (MoreContext->Filter.StartPending && MoreContext->LinesInViewport > 0) {
+        MoreContext->Filter.StartPending = FALSE;
+    }
+
+    if (MoreContext->Filter.StartPending) {
+        NewStart = MoreFindFilteredPhysicalLineAtOrAfter(MoreContext, MoreContext->Filter.StartLineNumber);
+        if (NewStart != NULL || !MoreContext->Filter.InProgress) {
+            MoreContext->Filter.StartPending = FALSE;
+            MoreGenerateEntireViewportWithStartingLine(MoreContext, NewStart);
+        }
+    } else {
+        MoreAddNewLinesToViewport(MoreContext);
+    }
+
+    MoreCheckForStatusLineChange(MoreContext);
+}
+
 /**
  Periodically update the selection by scrolling.  This occurs when the mouse
  button is held down and the mouse pointer is outside the console window,
@@ -2692,7 +2778,7 @@ MoreViewportDisplay(
     __inout PMORE_CONTEXT MoreContext
     )
 {
-    HANDLE ObjectsToWaitFor[4];
+    HANDLE ObjectsToWaitFor[5];
     HANDLE InHandle;
     DWORD WaitObject;
     DWORD HandleCountToWait;
@@ -2771,6 +2857,9 @@ MoreViewportDisplay(
         if (WaitForIngestThread) {
             ObjectsToWaitFor[HandleCountToWait++] = MoreContext->IngestThread;
         }
+        if (MoreContext->Filter.InProgress) {
+            ObjectsToWaitFor[HandleCountToWait++] = MoreContext->Filter.ProgressEvent;
+        }
 
         if (YoriLibIsPeriodicScrollActive(&MoreContext->Selection)) {
             Timeout = 100;
@@ -2828,6 +2917,10 @@ MoreViewportDisplay(
 
                 MoreAddNewLinesToViewport(MoreContext);
 
+            } else if (ObjectsToWaitFor[WaitObject - WAIT_OBJECT_0] == MoreContext->Filter.ProgressEvent) {
+
+                MoreProcessFilterProgress(MoreContext);
+
             } else if (ObjectsToWaitFor[WaitObject - WAIT_OBJECT_0] == MoreContext->IngestThread) {
 
                 WaitForSingleObject(MoreContext->PhysicalLineMutex, INFINITE);
@@ -87,6 +87,11 @@ typedef struct _REPL_CONTEXT {
      */
     PYORI_STRING NewString;
 
+    /**
+     A matcher prepared to search for MatchString.
+     */
+    YORI_LIB_MULTI_MATCH Matcher;
+
 } REPL_CONTEXT, *PREPL_CONTEXT;
 
 /**
@@ -153,14 +158,8 @@ ReplProcessStream(
             //  If no match is found, the line processing is complete
             //
 
-            if (ReplContext->Insensitive) {
-                if (YoriLibFindFirstMatchSubstrIns(&SearchSubset, 1, ReplContext->MatchString, &MatchOffset) == NULL) {
-                    break;
-                }
-            } else {
-                if (YoriLibFindFirstMatchSubstr(&SearchSubset, 1, ReplContext->MatchString, &MatchOffset) == NULL) {
-                    break;
-                }
+            if (YoriLibMultiMatchFindFirst(&ReplContext->Matcher, &SearchSubset, &MatchOffset) == NULL) {
+                break;
             }
 
             //
@@ -434,6 +433,11 @@ ENTRYPOINT(
     }
     StartArg += 2;
 
+    if (!YoriLibMultiMatchInitialize(&ReplContext.Matcher, 1, ReplContext.MatchString, (BOOLEAN)ReplContext.Insensitive)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("repl: out of memory\n"));
+        return EXIT_FAILURE;
+    }
+
 #if YORI_BUILTIN
     YoriLibCancelEnable(FALSE);
 #endif
@@ -446,6 +450,7 @@ ENTRYPOINT(
     if (StartArg == 0 || StartArg >= ArgC) {
         if (YoriLibIsStdInConsole()) {
             YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("No file or pipe for input\n"));
+            YoriLibMultiMatchCleanup(&ReplContext.Matcher);
             return EXIT_FAILURE;
         }
 
@@ -470,6 +475,8 @@ ENTRYPOINT(
         }
     }
 
+    YoriLibMultiMatchCleanup(&ReplContext.Matcher);
+
 #if !YORI_BUILTIN
     YoriLibLineReadCleanupCache();
 #endif
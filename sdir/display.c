@@ -35,6 +35,12 @@
 //  Display support
 //
 
+/**
+ A buffer used to combine writes to standard output when it is not a
+ console.
+ */
+YORI_LIB_OUTPUT_BUFFER SdirOutputBuffer;
+
 /**
  Write a specified number of characters to the output device.
 
@@ -58,6 +64,10 @@ SdirWriteRawStringToOutputDevice(
     String.StartOfString = (LPTSTR)OutputString;
     String.LengthInChars = Length;
 
+    if (hConsole == SdirOutputBuffer.hOutput) {
+        return YoriLibOutputStringToBuffer(&SdirOutputBuffer, 0, &String);
+    }
+
     return YoriLibOutputString(hConsole, 0, &String);
 }
 
@@ -83,6 +93,9 @@ SdirSetConsoleTextAttribute(
     __in YORILIB_COLOR_ATTRIBUTES Attribute
     )
 {
+    TCHAR EscapeBuffer[YORI_MAX_VT_ESCAPE_CHARS];
+    YORI_STRING EscapeString;
+
     if (YoriLibAreColorsIdentical(Attribute, SdirCurrentAttribute)) {
         return TRUE;
     }
@@ -90,7 +103,15 @@ SdirSetConsoleTextAttribute(
     SdirCurrentAttribute.Ctrl = Attribute.Ctrl;
     SdirCurrentAttribute.Win32Attr = Attribute.Win32Attr;
 
-    return YoriLibVtSetConsoleTextAttrDev(hConsole, 0, Attribute.Ctrl, Attribute.Win32Attr);
+    YoriLibInitEmptyString(&EscapeString);
+    EscapeString.StartOfString = EscapeBuffer;
+    EscapeString.LengthAllocated = sizeof(EscapeBuffer)/sizeof(EscapeBuffer[0]);
+
+    if (!YoriLibVtStringForTextAttribute(&EscapeString, Attribute.Ctrl, Attribute.Win32Attr)) {
+        return FALSE;
+    }
+
+    return SdirWriteRawStringToOutputDevice(hConsole, EscapeString.StartOfString, EscapeString.LengthInChars);
 }
 
 /**
@@ -79,6 +79,14 @@ SdirAppInitialize(VOID)
     }
     ZeroMemory(Summary, sizeof(SDIR_SUMMARY));
 
+    if (!YoriLibOutputBufferInitialize(&SdirOutputBuffer, hConsoleOutput)) {
+        YoriLibFree(Summary);
+        Summary = NULL;
+        YoriLibFree(Opts);
+        Opts = NULL;
+        return FALSE;
+    }
+
     //
     //  For simplicity, initialize this now.  On failure we restore to
     //  this value.  Hopefully we'll find the correct value before any
@@ -401,6 +409,11 @@ SdirParseOpt (
 
         } else {
         }
+    } else if (Opt[0] == 'n') {
+        if (Opt[1] == '\0') {
+            Opts->DisableSort = TRUE;
+            OptParsed = TRUE;
+        }
     } else if (Opt[0] == 'p') {
         if (Opt[1] == 'n') {
             Opts->EnablePause = FALSE;
@@ -594,6 +607,7 @@ VOID
 SdirAppCleanup(VOID)
 {
     SetConsoleCtrlHandler(SdirCancelHandler, FALSE);
+    YoriLibOutputBufferCleanup(&SdirOutputBuffer);
     if (Opts != NULL) {
         YoriLibFreeStringContents(&Opts->CustomFileFilter);
         YoriLibFreeStringContents(&Opts->CustomFileColor);
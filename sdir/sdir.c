@@ -207,8 +207,6 @@ SdirAddToCollection (
     ) 
 {
     PYORI_FILE_INFO CurrentEntry;
-    YORI_ALLOC_SIZE_T i, j;
-    DWORD CompareResult = 0;
 
     if (SdirDirCollectionCurrent >= SdirAllocatedDirents) {
         if (SdirDirCollectionCurrent < ((YORI_ALLOC_SIZE_T)-1)) {
@@ -240,46 +238,153 @@ SdirAddToCollection (
     }
 
     //
-    //  Now that our internal entry is fully poulated, insert it into the
-    //  correct sorted position.  As an optimization, check if we just need
-    //  to insert at the end (for file name sort on NTFS, this is the
-    //  common case.)
+    //  Now that our internal entry is fully populated, append it.  Entries
+    //  are sorted once enumeration is complete by
+    //  @ref SdirSortCollection .
     //
 
-    if (SdirDirCollectionCurrent > 1 &&
-        Opts->Sort[0].CompareFn(SdirDirSorted[SdirDirCollectionCurrent - 2], CurrentEntry) == Opts->Sort[0].CompareInverseCondition) {
+    SdirDirSorted[SdirDirCollectionCurrent - 1] = CurrentEntry;
+    return TRUE;
+}
+
+/**
+ Determine whether one entry should be displayed after another by applying
+ each of the user's sort criteria in turn until one of them distinguishes
+ the two entries.
+
+ @param First Pointer to the entry that is currently ahead in the display
+        order.
+
+ @param Second Pointer to the entry that is currently behind in the display
+        order.
+
+ @return TRUE if Second should be displayed before First, FALSE if the
+         existing order should be retained.  Entries which compare equal
+         under all criteria retain their existing order.
+ */
+BOOLEAN
+SdirShouldSwapEntries(
+    __in PYORI_FILE_INFO First,
+    __in PYORI_FILE_INFO Second
+    )
+{
+    DWORD Index;
+    DWORD CompareResult;
+
+    for (Index = 0; Index < Opts->CurrentSort; Index++) {
+        CompareResult = Opts->Sort[Index].CompareFn(First, Second);
+
+        if (CompareResult == Opts->Sort[Index].CompareBreakCondition) {
+            return TRUE;
+        }
+
+        if (CompareResult == Opts->Sort[Index].CompareInverseCondition) {
+            return FALSE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ Sort the entries in SdirDirSorted according to the user's sort criteria.
+ This is a stable bottom up merge sort, so it executes in O(n log n) time
+ and entries which are equal under all criteria are displayed in the order
+ they were enumerated.  As an optimization, the collection is checked
+ first to see if it is already in order, which is the common case for file
+ name sort on NTFS.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+SdirSortCollection(VOID)
+{
+    PYORI_FILE_INFO * Temp;
+    PYORI_FILE_INFO * Src;
+    PYORI_FILE_INFO * Dest;
+    PYORI_FILE_INFO * Swap;
+    YORI_ALLOC_SIZE_T Count;
+    YORI_ALLOC_SIZE_T Width;
+    YORI_ALLOC_SIZE_T Start;
+    YORI_ALLOC_SIZE_T Middle;
+    YORI_ALLOC_SIZE_T End;
+    YORI_ALLOC_SIZE_T Left;
+    YORI_ALLOC_SIZE_T Right;
+    YORI_ALLOC_SIZE_T Index;
+
+    Count = SdirDirCollectionCurrent;
+    if (Opts->DisableSort || Count < 2) {
+        return TRUE;
+    }
 
-        SdirDirSorted[SdirDirCollectionCurrent - 1] = CurrentEntry;
+    for (Index = 1; Index < Count; Index++) {
+        if (SdirShouldSwapEntries(SdirDirSorted[Index - 1], SdirDirSorted[Index])) {
+            break;
+        }
+    }
+
+    if (Index == Count) {
         return TRUE;
     }
 
+    Temp = YoriLibMalloc(Count * sizeof(PYORI_FILE_INFO));
+    if (Temp == NULL) {
+        SdirDisplayError(GetLastError(), _T("YoriLibMalloc"));
+        return FALSE;
+    }
+
     //
-    //  Currently sorting is done very inefficiently by a selection sort
-    //  type algorithm.  Generally this doesn't run due to the optimization
-    //  above.  When a different sort order is requested, performance could
-    //  be improved by using a better algorithm here.
+    //  Merge runs of Width entries from Src into Dest, doubling Width each
+    //  pass until a single run covers the whole collection.
     //
 
-    for (i = 0; i < SdirDirCollectionCurrent - 1; i++) {
+    Src = SdirDirSorted;
+    Dest = Temp;
 
-        for (j = 0; j < Opts->CurrentSort; j++) {
-            CompareResult = Opts->Sort[j].CompareFn(SdirDirSorted[i], CurrentEntry);
+    for (Width = 1; Width < Count; Width = Width * 2) {
+        for (Start = 0; Start < Count; Start = End) {
+            Middle = Start + Width;
+            if (Middle > Count || Middle < Start) {
+                Middle = Count;
+            }
+            End = Middle + Width;
+            if (End > Count || End < Middle) {
+                End = Count;
+            }
 
-            if (CompareResult == Opts->Sort[j].CompareBreakCondition ||
-                CompareResult == Opts->Sort[j].CompareInverseCondition) {
-                break;
+            Left = Start;
+            Right = Middle;
+            for (Index = Start; Index < End; Index++) {
+                if (Left < Middle &&
+                    (Right >= End || !SdirShouldSwapEntries(Src[Left], Src[Right]))) {
+                    Dest[Index] = Src[Left];
+                    Left++;
+                } else {
+                    Dest[Index] = Src[Right];
+                    Right++;
+                }
             }
         }
 
-        if (CompareResult == Opts->Sort[j].CompareBreakCondition) {
-            for (j = SdirDirCollectionCurrent - 1; j > i; j--) {
-                SdirDirSorted[j] = SdirDirSorted[j - 1];
-            }
-            SdirDirSorted[i] = CurrentEntry;
-            return TRUE;
+        Swap = Src;
+        Src = Dest;
+        Dest = Swap;
+
+        if (Width > Count / 2) {
+            break;
         }
     }
-    SdirDirSorted[SdirDirCollectionCurrent - 1] = CurrentEntry;
+
+    //
+    //  If the final pass left the result in the temporary buffer, copy it
+    //  back.
+    //
+
+    if (Src != SdirDirSorted) {
+        memcpy(SdirDirSorted, Src, Count * sizeof(PYORI_FILE_INFO));
+    }
+
+    YoriLibFree(Temp);
     return TRUE;
 }
 
@@ -920,6 +1025,10 @@ SdirDisplayCollection(VOID)
     LPTSTR LineElements = SdirLineElementsText;
     PSDIR_FEATURE Feature;
 
+    if (!SdirSortCollection()) {
+        return FALSE;
+    }
+
 #ifdef UNICODE
     if (Opts->OutputExtendedCharacters) {
         LineElements = SdirLineElementsRich;
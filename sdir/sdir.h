@@ -137,15 +137,15 @@ typedef struct _SDIR_COMPARE {
 
     /**
      Can be set to YORI_LIB_EQUAL, YORI_LIB_GREATER_THAN, YORI_LIB_LESS_THAN.
-     Items are inserted into order by comparing against existing entries
-     until this condition is met, at which point the item can be inserted
-     into its sorted position.
+     When comparing an earlier entry against a later entry, if this
+     condition is met the later entry should be displayed first.
      */
     DWORD           CompareBreakCondition;
 
     /**
      The inverse condition of BreakCondition above.  Used to check if things
-     are already in correct order.
+     are already in correct order, so that later criteria need not be
+     evaluated.
      */
     DWORD           CompareInverseCondition;
 } SDIR_COMPARE, *PSDIR_COMPARE;
@@ -508,6 +508,12 @@ typedef struct _SDIR_OPTS {
      */
     BOOLEAN         BasicEnumeration:1;
 
+    /**
+     TRUE if entries should be displayed in the order they were enumerated
+     without applying any sort criteria.
+     */
+    BOOLEAN         DisableSort:1;
+
     /**
      The color attributes from when the program was started, that should
      be restored on exit.
@@ -683,6 +689,7 @@ extern const SDIR_EXEC SdirExec[];
 extern PYORI_FILE_INFO SdirDirCollection;
 extern PYORI_FILE_INFO * SdirDirSorted;
 extern WORD SdirWriteStringLinesDisplayed;
+extern YORI_LIB_OUTPUT_BUFFER SdirOutputBuffer;
 
 //
 //  Functions from display.c
@@ -213,6 +213,7 @@ CHAR strCmdLineOpts[] =
                    "   -fc[string]  Apply custom file color string, see file color section\n"
                    "   -fe[string]  Exclude files matching criteria, see file color section\n"
                    "   -l/-ln       Traverse symbolic links and mount points when recursing\n"
+                   "   -n           Display files in enumeration order without sorting\n"
                    "   -p/-pn       Pause/no pause after each screen\n"
                    "   -r           Recurse through directories when enumerating\n"
                    "   -t/-tn       Truncate/no truncate of very long file names\n"
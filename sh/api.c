@@ -128,6 +128,18 @@ YoriApiClearHistoryStrings(VOID)
     return TRUE;
 }
 
+/**
+ Discard all cached knowledge of executables found in the path.
+
+ @return TRUE to indicate the cache was cleared.
+ */
+BOOL
+YoriApiClearPathCache(VOID)
+{
+    YoriShClearPathCache();
+    return TRUE;
+}
+
 /**
  Decrements the recursion depth that the prompt should display when the $+$
  token is used.
@@ -433,6 +445,26 @@ YoriApiGetNextJobId(
     return YoriShGetNextJobId(PreviousJobId);
 }
 
+/**
+ Build the set of commands that the shell has resolved to executables in
+ the path into an array of NULL terminated strings in command=path form,
+ terminated by an additional NULL terminator.  The result must be freed
+ with a subsequent call to @ref YoriApiFreeYoriString .
+
+ @param CommandStrings On successful completion, populated with the set of
+        command strings.
+
+ @return Return TRUE to indicate success, FALSE to indicate failure.
+ */
+BOOL
+YoriApiGetPathCacheStrings(
+    __out PYORI_STRING CommandStrings
+    )
+{
+    YoriLibInitEmptyString(CommandStrings);
+    return YoriShGetPathCacheStrings(CommandStrings);
+}
+
 /**
  Build the complete set of system defined aliases into a an array of key value
  pairs and return a pointer to the result.  This must be freed with a
@@ -87,7 +87,7 @@ YoriShBuckPass (
 
         if (count == 0) {
             YoriLibInitEmptyString(&FoundInPath);
-            if (YoriLibLocateExecutableInPath(&YsNewArg, NULL, NULL, &FoundInPath) && FoundInPath.LengthInChars > 0) {
+            if (YoriShLocateExecutableInPath(&YsNewArg, NULL, NULL, &FoundInPath) && FoundInPath.LengthInChars > 0) {
                 memcpy(&ExecContext->CmdToExec.ArgV[0], &FoundInPath, sizeof(YORI_STRING));
                 ASSERT(YoriLibIsStringNullTerminated(&ExecContext->CmdToExec.ArgV[0]));
                 YoriLibInitEmptyString(&FoundInPath);
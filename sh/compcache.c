@@ -0,0 +1,956 @@
+/**
+ * @file sh/compcache.c
+ *
+ * Yori shell background cache of directory contents for suggestions
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "yori.h"
+
+/**
+ The maximum number of directories whose contents are retained.  When this
+ is exceeded, the least recently used directory is discarded.
+ */
+#define YORI_SH_COMPLETION_CACHE_MAX_DIRECTORIES (16)
+
+/**
+ The number of milliseconds a directory's contents are used before checking
+ whether the directory has changed.
+ */
+#define YORI_SH_COMPLETION_CACHE_VALIDATE_INTERVAL (1000)
+
+/**
+ The number of directory entries to process between checks for whether the
+ enumeration is still wanted.
+ */
+#define YORI_SH_COMPLETION_CACHE_CANCEL_CHECK_INTERVAL (256)
+
+/**
+ Information about a single file or directory within a cached directory.
+ */
+typedef struct _YORI_SH_COMPLETION_CACHE_ENTRY {
+
+    /**
+     The attributes of the file.
+     */
+    DWORD FileAttributes;
+
+    /**
+     The offset of the file name within the directory's name buffer, in
+     characters.  The name is NULL terminated.
+     */
+    YORI_ALLOC_SIZE_T FileNameOffset;
+
+    /**
+     The length of the file name, in characters.
+     */
+    YORI_ALLOC_SIZE_T FileNameLength;
+
+    /**
+     The offset of the short file name within the directory's name buffer,
+     in characters.  The name is NULL terminated.
+     */
+    YORI_ALLOC_SIZE_T ShortNameOffset;
+
+    /**
+     The length of the short file name, in characters.  This is zero if the
+     file has no short name.
+     */
+    YORI_ALLOC_SIZE_T ShortNameLength;
+
+} YORI_SH_COMPLETION_CACHE_ENTRY, *PYORI_SH_COMPLETION_CACHE_ENTRY;
+
+/**
+ The contents of a directory at a point in time.  This is a single
+ referenced allocation containing the entries and all of their names.  Once
+ it is published, only ValidatedTick and ListEntry are modified, and only
+ with the cache mutex held, so a referenced directory can be read without
+ holding the mutex.
+ */
+typedef struct _YORI_SH_COMPLETION_CACHE_DIRECTORY {
+
+    /**
+     The list of cached directories, in most recently used order.  Paired
+     with YORI_SH_COMPLETION_CACHE::DirectoryList .
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     The fully qualified, escaped path to the directory.  This does not
+     include a trailing separator.
+     */
+    YORI_STRING DirectoryName;
+
+    /**
+     The last write time of the directory when it was enumerated.  Creating,
+     deleting or renaming a file within the directory updates this.
+     */
+    LARGE_INTEGER LastWriteTime;
+
+    /**
+     The tick count when the last write time of the directory was last
+     confirmed to match LastWriteTime.
+     */
+    DWORD ValidatedTick;
+
+    /**
+     The number of entries in the Entries array.
+     */
+    YORI_ALLOC_SIZE_T EntryCount;
+
+    /**
+     An array of entries describing the contents of the directory.
+     */
+    PYORI_SH_COMPLETION_CACHE_ENTRY Entries;
+
+    /**
+     The buffer containing the names of all entries.
+     */
+    LPTSTR Names;
+
+} YORI_SH_COMPLETION_CACHE_DIRECTORY, *PYORI_SH_COMPLETION_CACHE_DIRECTORY;
+
+/**
+ The state of the completion cache, which is shared between the input
+ thread and a background thread that enumerates directories.
+ */
+typedef struct _YORI_SH_COMPLETION_CACHE {
+
+    /**
+     A mutex protecting the list of directories and the pending request.
+     */
+    HANDLE Mutex;
+
+    /**
+     The background thread which enumerates directories.
+     */
+    HANDLE WorkerThread;
+
+    /**
+     An event signalled when a new request is made of the background
+     thread.
+     */
+    HANDLE RequestEvent;
+
+    /**
+     An event signalled when the background thread should terminate.
+     */
+    HANDLE ShutdownEvent;
+
+    /**
+     An event signalled by the background thread when the contents of a
+     directory have been added or updated.  The input thread resets this
+     and regenerates any suggestion.
+     */
+    HANDLE CompleteEvent;
+
+    /**
+     The directory that the background thread should enumerate next.  Each
+     request replaces any earlier request that has not yet started.
+     */
+    YORI_STRING RequestedDirectory;
+
+    /**
+     The directory that the background thread is currently enumerating.
+     */
+    YORI_STRING ActiveDirectory;
+
+    /**
+     A number which changes whenever a request for a different directory is
+     made.  The background thread abandons an enumeration when this changes,
+     since the user has moved on to something else.
+     */
+    LONG volatile RequestGeneration;
+
+    /**
+     The list of cached directories, in most recently used order.  Paired
+     with YORI_SH_COMPLETION_CACHE_DIRECTORY::ListEntry .
+     */
+    YORI_LIST_ENTRY DirectoryList;
+
+    /**
+     The number of directories in DirectoryList.
+     */
+    YORI_ALLOC_SIZE_T DirectoryCount;
+
+} YORI_SH_COMPLETION_CACHE, *PYORI_SH_COMPLETION_CACHE;
+
+/**
+ The cache of directory contents used to generate suggestions.
+ */
+YORI_SH_COMPLETION_CACHE YoriShCompletionCache;
+
+/**
+ Find a cached directory by name.  The cache mutex must be held.
+
+ @param DirectoryName Pointer to the fully qualified name of the directory.
+
+ @return Pointer to the cached directory, or NULL if it is not cached.
+ */
+PYORI_SH_COMPLETION_CACHE_DIRECTORY
+YoriShCompletionCacheFindDirectory(
+    __in PCYORI_STRING DirectoryName
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_COMPLETION_CACHE_DIRECTORY Directory;
+
+    ListEntry = YoriLibGetNextListEntry(&YoriShCompletionCache.DirectoryList, NULL);
+    while (ListEntry != NULL) {
+        Directory = CONTAINING_RECORD(ListEntry, YORI_SH_COMPLETION_CACHE_DIRECTORY, ListEntry);
+        if (YoriLibCompareStringIns(&Directory->DirectoryName, DirectoryName) == 0) {
+            return Directory;
+        }
+        ListEntry = YoriLibGetNextListEntry(&YoriShCompletionCache.DirectoryList, ListEntry);
+    }
+
+    return NULL;
+}
+
+/**
+ Query the last write time of a directory.
+
+ @param DirectoryName Pointer to the NULL terminated name of the directory.
+
+ @param LastWriteTime On successful completion, updated to contain the last
+        write time of the directory.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriShCompletionCacheGetWriteTime(
+    __in PCYORI_STRING DirectoryName,
+    __out PLARGE_INTEGER LastWriteTime
+    )
+{
+    WIN32_FILE_ATTRIBUTE_DATA FileAttributes;
+
+    if (!GetFileAttributesEx(DirectoryName->StartOfString, GetFileExInfoStandard, &FileAttributes)) {
+        return FALSE;
+    }
+
+    LastWriteTime->LowPart = FileAttributes.ftLastWriteTime.dwLowDateTime;
+    LastWriteTime->HighPart = FileAttributes.ftLastWriteTime.dwHighDateTime;
+    return TRUE;
+}
+
+/**
+ Return the separator to insert between a cached directory name and the name
+ of an object within it.  Root directories retain their trailing separator,
+ so nothing further is needed.
+
+ @param DirectoryName Pointer to the fully qualified name of the directory.
+
+ @return Pointer to a constant string containing the separator, which may be
+         empty.
+ */
+LPTSTR
+YoriShCompletionCacheChildSeparator(
+    __in PCYORI_STRING DirectoryName
+    )
+{
+    if (DirectoryName->LengthInChars > 0 &&
+        YoriLibIsSep(DirectoryName->StartOfString[DirectoryName->LengthInChars - 1])) {
+
+        return _T("");
+    }
+
+    return _T("\\");
+}
+
+/**
+ Enumerate the contents of a directory into a new cached directory
+ structure.  This is performed on the background thread.
+
+ @param DirectoryName Pointer to the fully qualified name of the directory.
+
+ @param LastWriteTime The last write time of the directory, captured before
+        enumeration commences.
+
+ @param Generation The request generation that caused this enumeration.  If
+        the generation changes, the enumeration is abandoned.
+
+ @return Pointer to a newly allocated directory structure, or NULL if the
+         directory could not be enumerated or the enumeration was abandoned.
+ */
+PYORI_SH_COMPLETION_CACHE_DIRECTORY
+YoriShCompletionCacheEnumerate(
+    __in PCYORI_STRING DirectoryName,
+    __in LARGE_INTEGER LastWriteTime,
+    __in LONG Generation
+    )
+{
+    PYORI_SH_COMPLETION_CACHE_DIRECTORY Directory;
+    PYORI_SH_COMPLETION_CACHE_ENTRY Entries;
+    PYORI_SH_COMPLETION_CACHE_ENTRY NewEntries;
+    PYORI_SH_COMPLETION_CACHE_ENTRY Entry;
+    YORI_ALLOC_SIZE_T EntryCount;
+    YORI_ALLOC_SIZE_T EntriesAllocated;
+    YORI_ALLOC_SIZE_T FileNameLength;
+    YORI_ALLOC_SIZE_T ShortNameLength;
+    YORI_STRING SearchPath;
+    YORI_STRING Names;
+    WIN32_FIND_DATA FindData;
+    HANDLE FindHandle;
+    YORI_ALLOC_SIZE_T BytesNeeded;
+    BOOLEAN Abandoned;
+
+    if (!YoriLibAllocateString(&SearchPath, DirectoryName->LengthInChars + sizeof("\\*"))) {
+        return NULL;
+    }
+    SearchPath.LengthInChars = YoriLibSPrintf(SearchPath.StartOfString, _T("%y%s*"), DirectoryName, YoriShCompletionCacheChildSeparator(DirectoryName));
+
+    FindHandle = FindFirstFile(SearchPath.StartOfString, &FindData);
+    YoriLibFreeStringContents(&SearchPath);
+    if (FindHandle == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    Entries = NULL;
+    Abandoned = FALSE;
+    EntryCount = 0;
+    EntriesAllocated = 0;
+    if (!YoriLibAllocateString(&Names, 4096)) {
+        FindClose(FindHandle);
+        return NULL;
+    }
+
+    do {
+
+        //
+        //  Periodically check whether the user has moved on to a different
+        //  directory or the shell is exiting, and if so, stop.
+        //
+
+        if (EntryCount % YORI_SH_COMPLETION_CACHE_CANCEL_CHECK_INTERVAL == 0 &&
+            (YoriShCompletionCache.RequestGeneration != Generation ||
+             WaitForSingleObject(YoriShCompletionCache.ShutdownEvent, 0) == WAIT_OBJECT_0)) {
+
+            Abandoned = TRUE;
+            break;
+        }
+
+        if ((FindData.cFileName[0] == '.' && FindData.cFileName[1] == '\0') ||
+            (FindData.cFileName[0] == '.' && FindData.cFileName[1] == '.' && FindData.cFileName[2] == '\0')) {
+
+            continue;
+        }
+
+        if (EntryCount == EntriesAllocated) {
+            if (EntriesAllocated == 0) {
+                EntriesAllocated = 256;
+            } else {
+                EntriesAllocated = EntriesAllocated * 2;
+            }
+            NewEntries = YoriLibMalloc(EntriesAllocated * sizeof(YORI_SH_COMPLETION_CACHE_ENTRY));
+            if (NewEntries == NULL) {
+                Abandoned = TRUE;
+                break;
+            }
+            if (Entries != NULL) {
+                memcpy(NewEntries, Entries, EntryCount * sizeof(YORI_SH_COMPLETION_CACHE_ENTRY));
+                YoriLibFree(Entries);
+            }
+            Entries = NewEntries;
+        }
+
+        FileNameLength = (YORI_ALLOC_SIZE_T)_tcslen(FindData.cFileName);
+        ShortNameLength = (YORI_ALLOC_SIZE_T)_tcslen(FindData.cAlternateFileName);
+        if (Names.LengthInChars + FileNameLength + ShortNameLength + 2 > Names.LengthAllocated) {
+            if (!YoriLibReallocString(&Names, (Names.LengthAllocated + FileNameLength + ShortNameLength + 2) * 2)) {
+                Abandoned = TRUE;
+                break;
+            }
+        }
+
+        Entry = &Entries[EntryCount];
+        Entry->FileAttributes = FindData.dwFileAttributes;
+        Entry->FileNameOffset = Names.LengthInChars;
+        Entry->FileNameLength = FileNameLength;
+        memcpy(&Names.StartOfString[Names.LengthInChars], FindData.cFileName, (FileNameLength + 1) * sizeof(TCHAR));
+        Names.LengthInChars = Names.LengthInChars + FileNameLength + 1;
+
+        Entry->ShortNameOffset = Names.LengthInChars;
+        Entry->ShortNameLength = ShortNameLength;
+        memcpy(&Names.StartOfString[Names.LengthInChars], FindData.cAlternateFileName, (ShortNameLength + 1) * sizeof(TCHAR));
+        Names.LengthInChars = Names.LengthInChars + ShortNameLength + 1;
+
+        EntryCount++;
+
+    } while (FindNextFile(FindHandle, &FindData));
+
+    //
+    //  If enumeration stopped early, for any reason, the contents are
+    //  incomplete and can't be used.
+    //
+
+    if (Abandoned || GetLastError() != ERROR_NO_MORE_FILES) {
+        FindClose(FindHandle);
+        YoriLibFreeStringContents(&Names);
+        if (Entries != NULL) {
+            YoriLibFree(Entries);
+        }
+        return NULL;
+    }
+
+    FindClose(FindHandle);
+
+    //
+    //  Pack the result into a single allocation so that it can be shared
+    //  with the input thread by reference.
+    //
+
+    BytesNeeded = sizeof(YORI_SH_COMPLETION_CACHE_DIRECTORY) +
+                  EntryCount * sizeof(YORI_SH_COMPLETION_CACHE_ENTRY) +
+                  (DirectoryName->LengthInChars + 1 + Names.LengthInChars) * sizeof(TCHAR);
+
+    Directory = YoriLibReferencedMalloc(BytesNeeded);
+    if (Directory == NULL) {
+        YoriLibFreeStringContents(&Names);
+        if (Entries != NULL) {
+            YoriLibFree(Entries);
+        }
+        return NULL;
+    }
+
+    Directory->Entries = (PYORI_SH_COMPLETION_CACHE_ENTRY)(Directory + 1);
+    Directory->EntryCount = EntryCount;
+    if (EntryCount > 0) {
+        memcpy(Directory->Entries, Entries, EntryCount * sizeof(YORI_SH_COMPLETION_CACHE_ENTRY));
+    }
+
+    YoriLibInitEmptyString(&Directory->DirectoryName);
+    Directory->DirectoryName.StartOfString = (LPTSTR)(Directory->Entries + EntryCount);
+    Directory->DirectoryName.LengthInChars = DirectoryName->LengthInChars;
+    Directory->DirectoryName.LengthAllocated = DirectoryName->LengthInChars + 1;
+    memcpy(Directory->DirectoryName.StartOfString, DirectoryName->StartOfString, DirectoryName->LengthInChars * sizeof(TCHAR));
+    Directory->DirectoryName.StartOfString[DirectoryName->LengthInChars] = '\0';
+
+    Directory->Names = Directory->DirectoryName.StartOfString + DirectoryName->LengthInChars + 1;
+    memcpy(Directory->Names, Names.StartOfString, Names.LengthInChars * sizeof(TCHAR));
+
+    Directory->LastWriteTime.QuadPart = LastWriteTime.QuadPart;
+    Directory->ValidatedTick = GetTickCount();
+
+    YoriLibFreeStringContents(&Names);
+    if (Entries != NULL) {
+        YoriLibFree(Entries);
+    }
+
+    return Directory;
+}
+
+/**
+ Process a single request on the background thread.  If the directory is
+ already cached and hasn't changed, this confirms it is still valid.
+ Otherwise the directory is enumerated and the result added to the cache,
+ and the input thread is notified.
+
+ @param DirectoryName Pointer to the fully qualified name of the directory.
+
+ @param Generation The request generation of this request.
+ */
+VOID
+YoriShCompletionCacheProcessRequest(
+    __in PYORI_STRING DirectoryName,
+    __in LONG Generation
+    )
+{
+    PYORI_SH_COMPLETION_CACHE_DIRECTORY Existing;
+    PYORI_SH_COMPLETION_CACHE_DIRECTORY Directory;
+    PYORI_LIST_ENTRY ListEntry;
+    LARGE_INTEGER LastWriteTime;
+
+    if (!YoriShCompletionCacheGetWriteTime(DirectoryName, &LastWriteTime)) {
+        return;
+    }
+
+    WaitForSingleObject(YoriShCompletionCache.Mutex, INFINITE);
+    Existing = YoriShCompletionCacheFindDirectory(DirectoryName);
+    if (Existing != NULL &&
+        Existing->LastWriteTime.QuadPart == LastWriteTime.QuadPart) {
+
+        Existing->ValidatedTick = GetTickCount();
+        ReleaseMutex(YoriShCompletionCache.Mutex);
+        return;
+    }
+    ReleaseMutex(YoriShCompletionCache.Mutex);
+
+    Directory = YoriShCompletionCacheEnumerate(DirectoryName, LastWriteTime, Generation);
+    if (Directory == NULL) {
+        return;
+    }
+
+    //
+    //  Replace any previous contents for this directory, and if the cache
+    //  is full, discard the least recently used directory.
+    //
+
+    WaitForSingleObject(YoriShCompletionCache.Mutex, INFINITE);
+    Existing = YoriShCompletionCacheFindDirectory(DirectoryName);
+    if (Existing != NULL) {
+        YoriLibRemoveListItem(&Existing->ListEntry);
+        YoriShCompletionCache.DirectoryCount--;
+        YoriLibDereference(Existing);
+    }
+
+    YoriLibInsertList(&YoriShCompletionCache.DirectoryList, &Directory->ListEntry);
+    YoriShCompletionCache.DirectoryCount++;
+
+    if (YoriShCompletionCache.DirectoryCount > YORI_SH_COMPLETION_CACHE_MAX_DIRECTORIES) {
+        ListEntry = YoriLibGetPreviousListEntry(&YoriShCompletionCache.DirectoryList, NULL);
+        Existing = CONTAINING_RECORD(ListEntry, YORI_SH_COMPLETION_CACHE_DIRECTORY, ListEntry);
+        YoriLibRemoveListItem(&Existing->ListEntry);
+        YoriShCompletionCache.DirectoryCount--;
+        YoriLibDereference(Existing);
+    }
+    ReleaseMutex(YoriShCompletionCache.Mutex);
+
+    SetEvent(YoriShCompletionCache.CompleteEvent);
+}
+
+/**
+ The background thread which processes requests to enumerate directories.
+
+ @param Context Unused.
+
+ @return Zero.
+ */
+DWORD WINAPI
+YoriShCompletionCacheWorker(
+    __in LPVOID Context
+    )
+{
+    HANDLE WaitHandles[2];
+    YORI_STRING DirectoryName;
+    LONG Generation;
+    DWORD Err;
+
+    UNREFERENCED_PARAMETER(Context);
+
+    WaitHandles[0] = YoriShCompletionCache.ShutdownEvent;
+    WaitHandles[1] = YoriShCompletionCache.RequestEvent;
+
+    while (TRUE) {
+        Err = WaitForMultipleObjects(2, WaitHandles, FALSE, INFINITE);
+        if (Err != WAIT_OBJECT_0 + 1) {
+            break;
+        }
+
+        WaitForSingleObject(YoriShCompletionCache.Mutex, INFINITE);
+        memcpy(&DirectoryName, &YoriShCompletionCache.RequestedDirectory, sizeof(YORI_STRING));
+        YoriLibInitEmptyString(&YoriShCompletionCache.RequestedDirectory);
+        YoriLibFreeStringContents(&YoriShCompletionCache.ActiveDirectory);
+        YoriLibCloneString(&YoriShCompletionCache.ActiveDirectory, &DirectoryName);
+        Generation = YoriShCompletionCache.RequestGeneration;
+        ReleaseMutex(YoriShCompletionCache.Mutex);
+
+        if (DirectoryName.LengthInChars > 0) {
+            YoriShCompletionCacheProcessRequest(&DirectoryName, Generation);
+        }
+
+        WaitForSingleObject(YoriShCompletionCache.Mutex, INFINITE);
+        YoriLibFreeStringContents(&YoriShCompletionCache.ActiveDirectory);
+        ReleaseMutex(YoriShCompletionCache.Mutex);
+        YoriLibFreeStringContents(&DirectoryName);
+    }
+
+    return 0;
+}
+
+/**
+ Create the synchronization objects and background thread used by the cache,
+ if they have not been created already.
+
+ @return TRUE to indicate the cache is ready for use, FALSE to indicate
+         failure.
+ */
+__success(return)
+BOOLEAN
+YoriShCompletionCacheInitialize(VOID)
+{
+    DWORD ThreadId;
+
+    if (YoriShCompletionCache.WorkerThread != NULL) {
+        return TRUE;
+    }
+
+    if (YoriShCompletionCache.Mutex == NULL) {
+        YoriShCompletionCache.Mutex = CreateMutex(NULL, FALSE, NULL);
+        if (YoriShCompletionCache.Mutex == NULL) {
+            return FALSE;
+        }
+        YoriLibInitializeListHead(&YoriShCompletionCache.DirectoryList);
+    }
+
+    if (YoriShCompletionCache.RequestEvent == NULL) {
+        YoriShCompletionCache.RequestEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+        if (YoriShCompletionCache.RequestEvent == NULL) {
+            return FALSE;
+        }
+    }
+
+    if (YoriShCompletionCache.ShutdownEvent == NULL) {
+        YoriShCompletionCache.ShutdownEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if (YoriShCompletionCache.ShutdownEvent == NULL) {
+            return FALSE;
+        }
+    }
+
+    if (YoriShCompletionCache.CompleteEvent == NULL) {
+        YoriShCompletionCache.CompleteEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if (YoriShCompletionCache.CompleteEvent == NULL) {
+            return FALSE;
+        }
+    }
+
+    YoriShCompletionCache.WorkerThread = CreateThread(NULL, 0, YoriShCompletionCacheWorker, NULL, 0, &ThreadId);
+    if (YoriShCompletionCache.WorkerThread == NULL) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Ask the background thread to enumerate or revalidate a directory.  This
+ replaces any earlier request which has not started.  If the directory is
+ different to the one currently being enumerated, that enumeration is
+ abandoned.  The cache mutex must be held.
+
+ @param DirectoryName Pointer to the fully qualified name of the directory.
+ */
+VOID
+YoriShCompletionCacheQueueRequest(
+    __in PYORI_STRING DirectoryName
+    )
+{
+    if (YoriLibCompareStringIns(&YoriShCompletionCache.RequestedDirectory, DirectoryName) == 0) {
+        return;
+    }
+
+    YoriLibFreeStringContents(&YoriShCompletionCache.RequestedDirectory);
+    if (YoriLibCompareStringIns(&YoriShCompletionCache.ActiveDirectory, DirectoryName) == 0) {
+        return;
+    }
+
+    YoriLibCloneString(&YoriShCompletionCache.RequestedDirectory, DirectoryName);
+    InterlockedIncrement((PLONG)&YoriShCompletionCache.RequestGeneration);
+    SetEvent(YoriShCompletionCache.RequestEvent);
+}
+
+/**
+ Find files matching a search string using the cached contents of the
+ directory.  If the directory is not cached, or may have changed, the
+ background thread is asked to enumerate it, and the completion event is
+ signalled when that is done so that a suggestion can be generated again.
+ This function never waits for a directory to be enumerated.
+
+ @param SearchString Pointer to the string to search for.  This consists of
+        an optional directory, a file name prefix, and a trailing '*'.
+
+ @param MatchFlags Specifies whether files, directories, or both should be
+        returned.
+
+ @param Callback The function to invoke for each matching file.
+
+ @param Context Context to pass to Callback.
+
+ @param WarmOnly If TRUE, the search is only handled if the directory is
+        cached and has been validated recently.  This is used for tab
+        completion, where the user is waiting for a complete result.  If
+        FALSE, the search is handled from any cached contents, or returns no
+        matches if the directory is not cached.
+
+ @return TRUE if the search was handled by the cache, even if the directory
+         is not yet available and no matches were returned.  FALSE if the
+         search cannot be handled by the cache, and the caller should
+         enumerate the file system directly.
+ */
+__success(return)
+BOOLEAN
+YoriShCompletionCacheForEachFile(
+    __in PYORI_STRING SearchString,
+    __in WORD MatchFlags,
+    __in PYORILIB_FILE_ENUM_FN Callback,
+    __in PVOID Context,
+    __in BOOLEAN WarmOnly
+    )
+{
+    YORI_ALLOC_SIZE_T CharsToFinalSlash;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_STRING UserDirectory;
+    YORI_STRING DirectoryName;
+    YORI_STRING EffectiveRoot;
+    YORI_STRING Prefix;
+    YORI_STRING EntryName;
+    YORI_STRING FullName;
+    PYORI_SH_COMPLETION_CACHE_DIRECTORY Directory;
+    PYORI_SH_COMPLETION_CACHE_ENTRY Entry;
+    WIN32_FIND_DATA FindData;
+    TCHAR Char;
+    BOOLEAN IsDirectory;
+    BOOLEAN Matched;
+    BOOLEAN Stale;
+
+    if (SearchString->LengthInChars == 0 ||
+        SearchString->StartOfString[SearchString->LengthInChars - 1] != '*') {
+        return FALSE;
+    }
+
+    //
+    //  Only handle a simple prefix match.  Anything involving wildcards,
+    //  streams or extended expression operators is left to the full
+    //  enumeration logic.
+    //
+
+    CharsToFinalSlash = SearchString->LengthInChars - 1;
+    while (CharsToFinalSlash > 0) {
+        if (YoriLibIsSep(SearchString->StartOfString[CharsToFinalSlash - 1])) {
+            break;
+        }
+        if (CharsToFinalSlash == 2 && YoriLibIsDrvLetterColon(SearchString)) {
+            break;
+        }
+        CharsToFinalSlash--;
+    }
+
+    for (Index = 0; Index < SearchString->LengthInChars - 1; Index++) {
+        Char = SearchString->StartOfString[Index];
+        if (Char == '*' || Char == '?' || Char == '[' || Char == '{') {
+            return FALSE;
+        }
+        if (Char == ':' && Index >= CharsToFinalSlash) {
+            return FALSE;
+        }
+    }
+
+    YoriLibInitEmptyString(&Prefix);
+    Prefix.StartOfString = &SearchString->StartOfString[CharsToFinalSlash];
+    Prefix.LengthInChars = SearchString->LengthInChars - CharsToFinalSlash - 1;
+
+    YoriLibInitEmptyString(&UserDirectory);
+    if (CharsToFinalSlash == 0) {
+        YoriLibConstantString(&UserDirectory, _T("."));
+    } else {
+        UserDirectory.StartOfString = SearchString->StartOfString;
+        UserDirectory.LengthInChars = CharsToFinalSlash;
+    }
+
+    if (!YoriLibUserToSingleFilePath(&UserDirectory, TRUE, &DirectoryName)) {
+        return FALSE;
+    }
+
+    //
+    //  Remove any trailing separator so that a directory has a single cache
+    //  entry.  Roots keep their separator, since "C:" refers to the current
+    //  directory of the drive rather than its root.
+    //
+
+    if (!YoriLibFindEffRoot(&DirectoryName, &EffectiveRoot)) {
+        YoriLibFreeStringContents(&DirectoryName);
+        return FALSE;
+    }
+
+    while (DirectoryName.LengthInChars > EffectiveRoot.LengthInChars &&
+           YoriLibIsSep(DirectoryName.StartOfString[DirectoryName.LengthInChars - 1])) {
+        DirectoryName.LengthInChars--;
+    }
+    DirectoryName.StartOfString[DirectoryName.LengthInChars] = '\0';
+
+    if (!YoriShCompletionCacheInitialize()) {
+        YoriLibFreeStringContents(&DirectoryName);
+        return FALSE;
+    }
+
+    //
+    //  Find the directory and take a reference to it so that it can be used
+    //  without holding the mutex.  If it's not cached, or it's time to check
+    //  if it has changed, ask the background thread to look at it.  If the
+    //  caller needs current contents and they may be out of date, let the
+    //  caller enumerate the directory.
+    //
+
+    Stale = TRUE;
+    WaitForSingleObject(YoriShCompletionCache.Mutex, INFINITE);
+    Directory = YoriShCompletionCacheFindDirectory(&DirectoryName);
+    if (Directory != NULL) {
+        YoriLibRemoveListItem(&Directory->ListEntry);
+        YoriLibInsertList(&YoriShCompletionCache.DirectoryList, &Directory->ListEntry);
+        if (GetTickCount() - Directory->ValidatedTick > YORI_SH_COMPLETION_CACHE_VALIDATE_INTERVAL) {
+            YoriShCompletionCacheQueueRequest(&DirectoryName);
+        } else {
+            Stale = FALSE;
+        }
+
+        if (WarmOnly && Stale) {
+            Directory = NULL;
+        } else {
+            YoriLibReference(Directory);
+        }
+    } else {
+        YoriShCompletionCacheQueueRequest(&DirectoryName);
+    }
+    ReleaseMutex(YoriShCompletionCache.Mutex);
+
+    if (Directory == NULL) {
+        YoriLibFreeStringContents(&DirectoryName);
+        if (WarmOnly) {
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    YoriLibInitEmptyString(&FullName);
+    ZeroMemory(&FindData, sizeof(FindData));
+
+    for (Index = 0; Index < Directory->EntryCount; Index++) {
+        Entry = &Directory->Entries[Index];
+
+        IsDirectory = FALSE;
+        if (Entry->FileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            IsDirectory = TRUE;
+        }
+
+        if (IsDirectory && (MatchFlags & YORILIB_ENUM_RETURN_DIRECTORIES) == 0) {
+            continue;
+        }
+
+        if (!IsDirectory && (MatchFlags & YORILIB_ENUM_RETURN_FILES) == 0) {
+            continue;
+        }
+
+        Matched = FALSE;
+        YoriLibInitEmptyString(&EntryName);
+        EntryName.StartOfString = &Directory->Names[Entry->FileNameOffset];
+        EntryName.LengthInChars = Entry->FileNameLength;
+        if (YoriLibCompareStringInsCnt(&EntryName, &Prefix, Prefix.LengthInChars) == 0) {
+            Matched = TRUE;
+        } else if (Entry->ShortNameLength > 0) {
+            EntryName.StartOfString = &Directory->Names[Entry->ShortNameOffset];
+            EntryName.LengthInChars = Entry->ShortNameLength;
+            if (YoriLibCompareStringInsCnt(&EntryName, &Prefix, Prefix.LengthInChars) == 0) {
+                Matched = TRUE;
+            }
+        }
+
+        if (!Matched) {
+            continue;
+        }
+
+        //
+        //  Build the information that file enumeration would have supplied
+        //  for this entry.
+        //
+
+        if (FullName.LengthAllocated < Directory->DirectoryName.LengthInChars + 1 + Entry->FileNameLength + 1) {
+            YoriLibFreeStringContents(&FullName);
+            if (!YoriLibAllocateString(&FullName, Directory->DirectoryName.LengthInChars + 1 + Entry->FileNameLength + 1 + MAX_PATH)) {
+                break;
+            }
+        }
+
+        EntryName.StartOfString = &Directory->Names[Entry->FileNameOffset];
+        EntryName.LengthInChars = Entry->FileNameLength;
+        FullName.LengthInChars = YoriLibSPrintf(FullName.StartOfString, _T("%y%s%y"), &Directory->DirectoryName, YoriShCompletionCacheChildSeparator(&Directory->DirectoryName), &EntryName);
+
+        FindData.dwFileAttributes = Entry->FileAttributes;
+        YoriLibSPrintfS(FindData.cFileName, sizeof(FindData.cFileName)/sizeof(FindData.cFileName[0]), _T("%y"), &EntryName);
+        EntryName.StartOfString = &Directory->Names[Entry->ShortNameOffset];
+        EntryName.LengthInChars = Entry->ShortNameLength;
+        YoriLibSPrintfS(FindData.cAlternateFileName, sizeof(FindData.cAlternateFileName)/sizeof(FindData.cAlternateFileName[0]), _T("%y"), &EntryName);
+
+        if (!Callback(&FullName, &FindData, 0, Context)) {
+            break;
+        }
+    }
+
+    YoriLibFreeStringContents(&FullName);
+    YoriLibDereference(Directory);
+    YoriLibFreeStringContents(&DirectoryName);
+    return TRUE;
+}
+
+/**
+ Return the event which is signalled when the background thread has added
+ or updated the contents of a directory.  The input thread waits on this
+ alongside console input so that it can regenerate suggestions.
+
+ @return The event handle, or NULL if the cache has not been used.
+ */
+HANDLE
+YoriShGetCompletionCacheEvent(VOID)
+{
+    return YoriShCompletionCache.CompleteEvent;
+}
+
+/**
+ Stop the background thread and discard all cached directory contents.
+ */
+VOID
+YoriShCleanupCompletionCache(VOID)
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_COMPLETION_CACHE_DIRECTORY Directory;
+
+    if (YoriShCompletionCache.WorkerThread != NULL) {
+        SetEvent(YoriShCompletionCache.ShutdownEvent);
+        WaitForSingleObject(YoriShCompletionCache.WorkerThread, INFINITE);
+        CloseHandle(YoriShCompletionCache.WorkerThread);
+        YoriShCompletionCache.WorkerThread = NULL;
+    }
+
+    if (YoriShCompletionCache.Mutex != NULL) {
+        ListEntry = YoriLibGetNextListEntry(&YoriShCompletionCache.DirectoryList, NULL);
+        while (ListEntry != NULL) {
+            Directory = CONTAINING_RECORD(ListEntry, YORI_SH_COMPLETION_CACHE_DIRECTORY, ListEntry);
+            YoriLibRemoveListItem(&Directory->ListEntry);
+            YoriLibDereference(Directory);
+            ListEntry = YoriLibGetNextListEntry(&YoriShCompletionCache.DirectoryList, NULL);
+        }
+        YoriShCompletionCache.DirectoryCount = 0;
+
+        CloseHandle(YoriShCompletionCache.Mutex);
+        YoriShCompletionCache.Mutex = NULL;
+    }
+
+    if (YoriShCompletionCache.RequestEvent != NULL) {
+        CloseHandle(YoriShCompletionCache.RequestEvent);
+        YoriShCompletionCache.RequestEvent = NULL;
+    }
+
+    if (YoriShCompletionCache.ShutdownEvent != NULL) {
+        CloseHandle(YoriShCompletionCache.ShutdownEvent);
+        YoriShCompletionCache.ShutdownEvent = NULL;
+    }
+
+    if (YoriShCompletionCache.CompleteEvent != NULL) {
+        CloseHandle(YoriShCompletionCache.CompleteEvent);
+        YoriShCompletionCache.CompleteEvent = NULL;
+    }
+
+    YoriLibFreeStringContents(&YoriShCompletionCache.RequestedDirectory);
+    YoriLibFreeStringContents(&YoriShCompletionCache.ActiveDirectory);
+}
+
+// vim:sw=4:ts=4:et:
@@ -165,7 +165,9 @@ YoriLibComplateCompareFilePath(
 /**
  Populates the list of matches for a command history tab completion.  This
  function searches the history for matching commands in MRU order and
- populates the list with the result.
+ populates the list with the result.  Commands match if they start with the
+ search string, or if the search string starts with '*', if they contain
+ the remainder of the search string.
 
  @param TabContext Pointer to the tab completion context.  This provides
         the search criteria and has its match list populated with results
@@ -181,8 +183,8 @@ YoriShPerformHistoryTabCompletion(
     )
 {
     LPTSTR FoundPath;
-    YORI_ALLOC_SIZE_T CompareLength;
-    PYORI_LIST_ENTRY ListEntry;
+    YORI_STRING SearchString;
+    BOOLEAN PrefixOnly;
     PYORI_SH_HISTORY_ENTRY HistoryEntry;
     PYORI_SH_TAB_COMPLETE_MATCH Match;
     PYORI_HASH_ENTRY PriorEntry;
@@ -193,11 +195,20 @@ YoriShPerformHistoryTabCompletion(
     //  Set up state necessary for different types of searching.
     //
 
-    FoundPath = _tcschr(TabContext->SearchString.StartOfString, '*');
+    YoriLibInitEmptyString(&SearchString);
+    SearchString.StartOfString = TabContext->SearchString.StartOfString;
+    SearchString.LengthInChars = TabContext->SearchString.LengthInChars;
+
+    PrefixOnly = TRUE;
+    if (SearchString.LengthInChars > 0 && SearchString.StartOfString[0] == '*') {
+        PrefixOnly = FALSE;
+        SearchString.StartOfString++;
+        SearchString.LengthInChars--;
+    }
+
+    FoundPath = YoriLibFindLeftMostCharacter(&SearchString, '*');
     if (FoundPath != NULL) {
-        CompareLength = (YORI_ALLOC_SIZE_T)(FoundPath - TabContext->SearchString.StartOfString);
-    } else {
-        CompareLength = TabContext->SearchString.LengthInChars;
+        SearchString.LengthInChars = (YORI_ALLOC_SIZE_T)(FoundPath - SearchString.StartOfString);
     }
     FoundPath = NULL;
 
@@ -205,53 +216,49 @@ YoriShPerformHistoryTabCompletion(
     //  Search the list of history.
     //
 
-    ListEntry = YoriLibGetPreviousListEntry(&YoriShGlobal.CommandHistory, NULL);
-    while (ListEntry != NULL) {
-        HistoryEntry = CONTAINING_RECORD(ListEntry, YORI_SH_HISTORY_ENTRY, ListEntry);
+    HistoryEntry = YoriShFindPreviousHistoryMatch(&SearchString, PrefixOnly, NULL);
+    while (HistoryEntry != NULL) {
 
-        if (YoriLibCompareStringInsCnt(&HistoryEntry->CmdLine, &TabContext->SearchString, CompareLength) == 0) {
+        //
+        //  Allocate a match entry for this file.
+        //
 
-            //
-            //  Allocate a match entry for this file.
-            //
+        Match = YoriLibReferencedMalloc(sizeof(YORI_SH_TAB_COMPLETE_MATCH) + (HistoryEntry->CmdLine.LengthInChars + 1) * sizeof(TCHAR));
+        if (Match == NULL) {
+            return;
+        }
 
-            Match = YoriLibReferencedMalloc(sizeof(YORI_SH_TAB_COMPLETE_MATCH) + (HistoryEntry->CmdLine.LengthInChars + 1) * sizeof(TCHAR));
-            if (Match == NULL) {
-                return;
-            }
+        //
+        //  Populate the file into the entry.
+        //
 
-            //
-            //  Populate the file into the entry.
-            //
+        YoriLibInitEmptyString(&Match->Value);
+        Match->Value.StartOfString = (LPTSTR)(Match + 1);
+        YoriLibReference(Match);
+        Match->Value.MemoryToFree = Match;
+        YoriLibSPrintf(Match->Value.StartOfString, _T("%y"), &HistoryEntry->CmdLine);
+        Match->Value.LengthInChars = HistoryEntry->CmdLine.LengthInChars;
+        Match->CursorOffset = Match->Value.LengthInChars;
 
-            YoriLibInitEmptyString(&Match->Value);
-            Match->Value.StartOfString = (LPTSTR)(Match + 1);
-            YoriLibReference(Match);
-            Match->Value.MemoryToFree = Match;
-            YoriLibSPrintf(Match->Value.StartOfString, _T("%y"), &HistoryEntry->CmdLine);
-            Match->Value.LengthInChars = HistoryEntry->CmdLine.LengthInChars;
-            Match->CursorOffset = Match->Value.LengthInChars;
+        //
+        //  If the user is requesting all matches to be enumerates for
+        //  tab completion, don't add an entry if there's a duplicate.
+        //  If the user is requesting to be able to cycle to the next
+        //  entry, keep duplicates, because they're an in-order record
+        //  of the commands the user entered.
 
-            //
-            //  If the user is requesting all matches to be enumerates for
-            //  tab completion, don't add an entry if there's a duplicate.
-            //  If the user is requesting to be able to cycle to the next
-            //  entry, keep duplicates, because they're an in-order record
-            //  of the commands the user entered.
-
-            PriorEntry = NULL;
-            if (YoriShGlobal.CompletionListAll) {
-                PriorEntry = YoriLibHashLookupByKey(TabContext->MatchHashTable, &Match->Value);
-            }
+        PriorEntry = NULL;
+        if (YoriShGlobal.CompletionListAll) {
+            PriorEntry = YoriLibHashLookupByKey(TabContext->MatchHashTable, &Match->Value);
+        }
 
-            if (PriorEntry == NULL) {
-                YoriShAddMatchToTabContextAtEnd(TabContext, Match);
-            } else {
-                YoriLibFreeStringContents(&Match->Value);
-                YoriLibDereference(Match);
-            }
+        if (PriorEntry == NULL) {
+            YoriShAddMatchToTabContextAtEnd(TabContext, Match);
+        } else {
+            YoriLibFreeStringContents(&Match->Value);
+            YoriLibDereference(Match);
         }
-        ListEntry = YoriLibGetPreviousListEntry(&YoriShGlobal.CommandHistory, ListEntry);
+        HistoryEntry = YoriShFindPreviousHistoryMatch(&SearchString, PrefixOnly, HistoryEntry);
     }
 }
 
@@ -533,10 +540,10 @@ YoriShPerformExecutableTabCompletion(
     //
 
     YoriLibInitEmptyString(&FoundExecutable);
-    Result = YoriLibLocateExecutableInPath(&SearchString,
-                                           YoriShAddExecutableToTabList,
-                                           &ExecTabContext,
-                                           &FoundExecutable);
+    Result = YoriShLocateExecutableInPath(&SearchString,
+                                          YoriShAddExecutableToTabList,
+                                          &ExecTabContext,
+                                          &FoundExecutable);
     YoriLibInitEmptyString(&FoundExecutable);
 
     //
@@ -1121,13 +1128,35 @@ YoriShFindMatchingStreamsForStringOrCursorPosition(
 {
     YORI_STRING FileMidpointSearchString;
     YORI_ALLOC_SIZE_T Index;
+    BOOLEAN UsedCache;
 
     //
-    //  First check for a match for the whole string
+    //  First check for a match for the whole string.  When generating a
+    //  suggestion, use the cached contents of the directory if possible so
+    //  that the input thread never waits for the file system.  If the
+    //  directory isn't cached yet, the suggestion is regenerated when the
+    //  background thread has enumerated it.  Tab completion uses the cached
+    //  contents if they were validated recently, and only enumerates the
+    //  directory if they weren't.
     //
 
     EnumContext->SearchString = SearchString->StartOfString;
-    if (!YoriLibForEachStream(SearchString, MatchFlags, 0, YoriShFileTabCompletionCallback, YoriShFileTabCompletionErrorCallback, EnumContext)) {
+    UsedCache = FALSE;
+    if (!EnumContext->ExpandFullPath) {
+        if ((TabContext->TabFlagsUsedCreatingList & YORI_SH_TAB_SUGGESTIONS) != 0) {
+            if (YoriShCompletionCacheForEachFile(SearchString, MatchFlags, YoriShFileTabCompletionCallback, EnumContext, FALSE)) {
+                if (CursorOffset > 0 && CursorOffset + 1 < SearchString->LengthInChars) {
+                    TabContext->PotentialNonPrefixMatch = TRUE;
+                }
+                return;
+            }
+        } else {
+            UsedCache = YoriShCompletionCacheForEachFile(SearchString, MatchFlags, YoriShFileTabCompletionCallback, EnumContext, TRUE);
+        }
+    }
+
+    if (!UsedCache &&
+        !YoriLibForEachStream(SearchString, MatchFlags, 0, YoriShFileTabCompletionCallback, YoriShFileTabCompletionErrorCallback, EnumContext)) {
         return;
     }
 
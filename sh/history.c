@@ -49,7 +49,385 @@ HANDLE YoriShHistoryLock;
 BOOL YoriShHistoryInitialized;
 
 /**
- Add an entered command into the command history buffer.
+ The number of lines known to be in the history file, either because they
+ were loaded from it or appended to it by this process.  This is used to
+ decide when the file has accumulated enough duplicate or expired entries
+ that it should be rewritten.
+ */
+YORI_ALLOC_SIZE_T YoriShHistoryLinesInFile;
+
+/**
+ Set to TRUE if commands have been removed from history since the history
+ file was last written.  Those commands are still in the file, so it must be
+ rewritten regardless of how many lines it contains.
+ */
+BOOLEAN YoriShHistoryFileStale;
+
+/**
+ The number of lines beyond twice the number of history entries that the
+ history file can contain before it is rewritten.
+ */
+#define YORI_SH_HISTORY_COMPACT_SLACK (256)
+
+/**
+ The minimum number of trigram buckets in the history search index.
+ */
+#define YORI_SH_HISTORY_MIN_BUCKETS (256)
+
+/**
+ The maximum number of trigram buckets in the history search index.
+ */
+#define YORI_SH_HISTORY_MAX_BUCKETS (65536)
+
+/**
+ The number of characters in each fragment of text recorded in the history
+ search index.
+ */
+#define YORI_SH_HISTORY_TRIGRAM_LENGTH (3)
+
+/**
+ A list of index slots of history entries which contain a trigram that maps
+ to a single bucket.  Slots are in ascending order, which is the order that
+ commands were entered.
+ */
+typedef struct _YORI_SH_HISTORY_POSTINGS {
+
+    /**
+     An array of index slots.
+     */
+    PYORI_ALLOC_SIZE_T Slots;
+
+    /**
+     The number of elements in the Slots array that are populated.
+     */
+    YORI_ALLOC_SIZE_T Count;
+
+    /**
+     The number of elements allocated in the Slots array.
+     */
+    YORI_ALLOC_SIZE_T Allocated;
+
+} YORI_SH_HISTORY_POSTINGS, *PYORI_SH_HISTORY_POSTINGS;
+
+/**
+ An index of history entries.  Each history entry has a slot, which is
+ allocated in the order entries are added.  Every three character sequence
+ within each entry is hashed to a bucket, and the bucket records the slots
+ of entries containing it.  A search for a string of three or more
+ characters can therefore examine only the entries in the smallest bucket of
+ any sequence within the search string, rather than all of history.  When
+ an entry is removed its slot is emptied, and empty slots are discarded when
+ the index is rebuilt.
+ */
+typedef struct _YORI_SH_HISTORY_INDEX {
+
+    /**
+     An array of history entries indexed by slot.  Slots of entries that
+     have been removed are NULL.
+     */
+    PYORI_SH_HISTORY_ENTRY *Entries;
+
+    /**
+     The number of slots that have been used.
+     */
+    YORI_ALLOC_SIZE_T SlotCount;
+
+    /**
+     The number of slots allocated in the Entries array.
+     */
+    YORI_ALLOC_SIZE_T SlotsAllocated;
+
+    /**
+     The number of slots which refer to an entry.
+     */
+    YORI_ALLOC_SIZE_T LiveCount;
+
+    /**
+     The number of buckets.  This is always a power of two.
+     */
+    YORI_ALLOC_SIZE_T BucketCount;
+
+    /**
+     An array of buckets, each containing the slots of entries containing a
+     trigram that maps to the bucket.
+     */
+    PYORI_SH_HISTORY_POSTINGS Buckets;
+
+    /**
+     A hash table of commands, used to find an earlier instance of a command
+     when it is entered again.
+     */
+    PYORI_HASH_TABLE Commands;
+
+} YORI_SH_HISTORY_INDEX, *PYORI_SH_HISTORY_INDEX;
+
+/**
+ The index of history entries.
+ */
+YORI_SH_HISTORY_INDEX YoriShHistoryIndex;
+
+/**
+ Return the bucket for a three character sequence within a string.  The
+ sequence is case insensitive.
+
+ @param String Pointer to the string.
+
+ @param Offset The offset of the sequence within the string.  The string
+        must contain at least three characters from this offset.
+
+ @param BucketCount The number of buckets.  This must be a power of two.
+
+ @return The bucket number.
+ */
+YORI_ALLOC_SIZE_T
+YoriShHistoryTrigramBucket(
+    __in PCYORI_STRING String,
+    __in YORI_ALLOC_SIZE_T Offset,
+    __in YORI_ALLOC_SIZE_T BucketCount
+    )
+{
+    DWORD Hash;
+    YORI_ALLOC_SIZE_T Index;
+
+    Hash = 2166136261;
+    for (Index = 0; Index < YORI_SH_HISTORY_TRIGRAM_LENGTH; Index++) {
+        Hash = Hash ^ YoriLibUpcaseChar(String->StartOfString[Offset + Index]);
+        Hash = Hash * 16777619;
+    }
+
+    Hash = Hash ^ (Hash >> 16);
+    return (YORI_ALLOC_SIZE_T)(Hash & (BucketCount - 1));
+}
+
+/**
+ Free the history search index.  Searches examine all history entries until
+ the index is rebuilt.
+ */
+VOID
+YoriShHistoryIndexDiscard(VOID)
+{
+    YORI_ALLOC_SIZE_T Index;
+
+    if (YoriShHistoryIndex.Buckets != NULL) {
+        for (Index = 0; Index < YoriShHistoryIndex.BucketCount; Index++) {
+            if (YoriShHistoryIndex.Buckets[Index].Slots != NULL) {
+                YoriLibFree(YoriShHistoryIndex.Buckets[Index].Slots);
+            }
+        }
+        YoriLibFree(YoriShHistoryIndex.Buckets);
+        YoriShHistoryIndex.Buckets = NULL;
+    }
+
+    if (YoriShHistoryIndex.Entries != NULL) {
+        YoriLibFree(YoriShHistoryIndex.Entries);
+        YoriShHistoryIndex.Entries = NULL;
+    }
+
+    YoriShHistoryIndex.BucketCount = 0;
+    YoriShHistoryIndex.SlotCount = 0;
+    YoriShHistoryIndex.SlotsAllocated = 0;
+    YoriShHistoryIndex.LiveCount = 0;
+}
+
+/**
+ Record each three character sequence within a history entry in the
+ history search index.  The entry must already have been assigned a slot.
+
+ @param HistoryEntry Pointer to the history entry.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriShHistoryIndexAddTrigrams(
+    __in PYORI_SH_HISTORY_ENTRY HistoryEntry
+    )
+{
+    YORI_ALLOC_SIZE_T Offset;
+    YORI_ALLOC_SIZE_T NewAllocated;
+    PYORI_ALLOC_SIZE_T NewSlots;
+    PYORI_SH_HISTORY_POSTINGS Postings;
+
+    for (Offset = 0; Offset + YORI_SH_HISTORY_TRIGRAM_LENGTH <= HistoryEntry->CmdLine.LengthInChars; Offset++) {
+        Postings = &YoriShHistoryIndex.Buckets[YoriShHistoryTrigramBucket(&HistoryEntry->CmdLine, Offset, YoriShHistoryIndex.BucketCount)];
+
+        //
+        //  Since slots are added in ascending order, if this entry has
+        //  already been recorded in this bucket it is the final slot.
+        //
+
+        if (Postings->Count > 0 &&
+            Postings->Slots[Postings->Count - 1] == HistoryEntry->IndexSlot) {
+
+            continue;
+        }
+
+        if (Postings->Count == Postings->Allocated) {
+            NewAllocated = Postings->Allocated * 2;
+            if (NewAllocated == 0) {
+                NewAllocated = 16;
+            }
+            NewSlots = YoriLibMalloc(NewAllocated * sizeof(YORI_ALLOC_SIZE_T));
+            if (NewSlots == NULL) {
+                return FALSE;
+            }
+            if (Postings->Slots != NULL) {
+                memcpy(NewSlots, Postings->Slots, Postings->Count * sizeof(YORI_ALLOC_SIZE_T));
+                YoriLibFree(Postings->Slots);
+            }
+            Postings->Slots = NewSlots;
+            Postings->Allocated = NewAllocated;
+        }
+
+        Postings->Slots[Postings->Count] = HistoryEntry->IndexSlot;
+        Postings->Count++;
+    }
+
+    return TRUE;
+}
+
+/**
+ Construct the history search index from the current set of history
+ entries.  Slots are assigned in history order, discarding any slots of
+ removed entries, and the number of buckets is chosen based on the number
+ of entries.  On failure the index is discarded.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriShHistoryIndexRebuild(VOID)
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_HISTORY_ENTRY HistoryEntry;
+    YORI_ALLOC_SIZE_T EntryCount;
+    YORI_ALLOC_SIZE_T BucketCount;
+
+    YoriShHistoryIndexDiscard();
+
+    EntryCount = 0;
+    ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, NULL);
+    while (ListEntry != NULL) {
+        EntryCount++;
+        ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, ListEntry);
+    }
+
+    BucketCount = YORI_SH_HISTORY_MIN_BUCKETS;
+    while (BucketCount < EntryCount / 2 && BucketCount < YORI_SH_HISTORY_MAX_BUCKETS) {
+        BucketCount = BucketCount * 2;
+    }
+
+    YoriShHistoryIndex.SlotsAllocated = EntryCount * 2 + 64;
+    YoriShHistoryIndex.Entries = YoriLibMalloc(YoriShHistoryIndex.SlotsAllocated * sizeof(PYORI_SH_HISTORY_ENTRY));
+    if (YoriShHistoryIndex.Entries == NULL) {
+        YoriShHistoryIndexDiscard();
+        return FALSE;
+    }
+
+    YoriShHistoryIndex.Buckets = YoriLibMalloc(BucketCount * sizeof(YORI_SH_HISTORY_POSTINGS));
+    if (YoriShHistoryIndex.Buckets == NULL) {
+        YoriShHistoryIndexDiscard();
+        return FALSE;
+    }
+    ZeroMemory(YoriShHistoryIndex.Buckets, BucketCount * sizeof(YORI_SH_HISTORY_POSTINGS));
+    YoriShHistoryIndex.BucketCount = BucketCount;
+
+    ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, NULL);
+    while (ListEntry != NULL) {
+        HistoryEntry = CONTAINING_RECORD(ListEntry, YORI_SH_HISTORY_ENTRY, ListEntry);
+        HistoryEntry->IndexSlot = YoriShHistoryIndex.SlotCount;
+        YoriShHistoryIndex.Entries[YoriShHistoryIndex.SlotCount] = HistoryEntry;
+        YoriShHistoryIndex.SlotCount++;
+        YoriShHistoryIndex.LiveCount++;
+        if (!YoriShHistoryIndexAddTrigrams(HistoryEntry)) {
+            YoriShHistoryIndexDiscard();
+            return FALSE;
+        }
+        ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, ListEntry);
+    }
+
+    return TRUE;
+}
+
+/**
+ Add a history entry to the history search index.  The entry must already
+ be the final entry in the history list.  If the index has no free slots,
+ or has grown large enough that it needs more buckets, it is rebuilt, which
+ includes the new entry.
+
+ @param HistoryEntry Pointer to the history entry.
+ */
+VOID
+YoriShHistoryIndexInsert(
+    __in PYORI_SH_HISTORY_ENTRY HistoryEntry
+    )
+{
+    if (YoriShHistoryIndex.Entries == NULL ||
+        YoriShHistoryIndex.SlotCount == YoriShHistoryIndex.SlotsAllocated ||
+        (YoriShHistoryIndex.LiveCount > YoriShHistoryIndex.BucketCount * 8 &&
+         YoriShHistoryIndex.BucketCount < YORI_SH_HISTORY_MAX_BUCKETS)) {
+
+        YoriShHistoryIndexRebuild();
+        return;
+    }
+
+    HistoryEntry->IndexSlot = YoriShHistoryIndex.SlotCount;
+    YoriShHistoryIndex.Entries[YoriShHistoryIndex.SlotCount] = HistoryEntry;
+    YoriShHistoryIndex.SlotCount++;
+    YoriShHistoryIndex.LiveCount++;
+
+    if (!YoriShHistoryIndexAddTrigrams(HistoryEntry)) {
+        YoriShHistoryIndexDiscard();
+    }
+}
+
+/**
+ Remove a history entry from the history search index.  The slot is emptied
+ but any buckets referring to it are left unchanged until the index is
+ rebuilt.
+
+ @param HistoryEntry Pointer to the history entry.
+ */
+VOID
+YoriShHistoryIndexRemove(
+    __in PYORI_SH_HISTORY_ENTRY HistoryEntry
+    )
+{
+    if (YoriShHistoryIndex.Entries != NULL &&
+        HistoryEntry->IndexSlot < YoriShHistoryIndex.SlotCount &&
+        YoriShHistoryIndex.Entries[HistoryEntry->IndexSlot] == HistoryEntry) {
+
+        YoriShHistoryIndex.Entries[HistoryEntry->IndexSlot] = NULL;
+        YoriShHistoryIndex.LiveCount--;
+    }
+}
+
+/**
+ Remove a history entry from the history list and all indexes, and free
+ it.  The caller is expected to hold the history lock.
+
+ @param HistoryEntry Pointer to the history entry.
+ */
+VOID
+YoriShFreeHistoryEntry(
+    __in PYORI_SH_HISTORY_ENTRY HistoryEntry
+    )
+{
+    YoriLibRemoveListItem(&HistoryEntry->ListEntry);
+    if (HistoryEntry->HashEntry.HashTable != NULL) {
+        YoriLibHashRemoveByEntry(&HistoryEntry->HashEntry);
+    }
+    YoriShHistoryIndexRemove(HistoryEntry);
+    YoriLibFreeStringContents(&HistoryEntry->CmdLine);
+    YoriLibFree(HistoryEntry);
+    YoriShCommandHistoryCount--;
+}
+
+/**
+ Add an entered command into the command history buffer.  If the most
+ recently entered command that matches the new command case insensitively
+ is identical to it, that earlier instance is removed, so that a repeated
+ command appears once at the position it was most recently entered.
 
  @param NewCmd Pointer to a Yori string corresponding to the new
         entry to add to history.
@@ -70,6 +448,8 @@ YoriShAddToHistory(
 {
     YORI_ALLOC_SIZE_T LengthToAllocate;
     PYORI_SH_HISTORY_ENTRY NewHistoryEntry;
+    PYORI_SH_HISTORY_ENTRY ExistingHistoryEntry;
+    PYORI_HASH_ENTRY HashEntry;
 
     if (NewCmd->LengthInChars == 0) {
         return TRUE;
@@ -95,6 +475,38 @@ YoriShAddToHistory(
             }
         }
 
+        //
+        //  Size the table for the number of commands that history can hold.
+        //  It grows if the limit is raised later.
+        //
+
+        if (YoriShHistoryIndex.Commands == NULL) {
+            YoriShHistoryIndex.Commands = YoriLibAllocateHashTable((YORI_ALLOC_SIZE_T)(YoriShCommandHistoryMax + 1));
+        }
+
+        //
+        //  The hash table is case insensitive and holds one entry per key,
+        //  being the most recent command with that key.  Commands are only
+        //  considered identical if they match exactly.  If the most recent
+        //  command differs only by case, it stays in history but is removed
+        //  from the hash table, and the new command takes its place.  This
+        //  means an older command that differs only by case from a newer one
+        //  can no longer be found, and will not be removed if it is entered
+        //  again.
+        //
+
+        if (YoriShHistoryIndex.Commands != NULL) {
+            HashEntry = YoriLibHashLookupByKey(YoriShHistoryIndex.Commands, NewCmd);
+            if (HashEntry != NULL) {
+                ExistingHistoryEntry = (PYORI_SH_HISTORY_ENTRY)HashEntry->Context;
+                if (YoriLibCompareString(&ExistingHistoryEntry->CmdLine, NewCmd) == 0) {
+                    YoriShFreeHistoryEntry(ExistingHistoryEntry);
+                } else {
+                    YoriLibHashRemoveByEntry(&ExistingHistoryEntry->HashEntry);
+                }
+            }
+        }
+
         NewHistoryEntry = YoriLibMalloc(LengthToAllocate);
         if (NewHistoryEntry == NULL) {
             ReleaseMutex(YoriShHistoryLock);
@@ -102,19 +514,23 @@ YoriShAddToHistory(
         }
 
         YoriLibCloneString(&NewHistoryEntry->CmdLine, NewCmd);
+        NewHistoryEntry->HashEntry.HashTable = NULL;
+        NewHistoryEntry->IndexSlot = 0;
 
         YoriLibAppendList(&YoriShGlobal.CommandHistory, &NewHistoryEntry->ListEntry);
         YoriShCommandHistoryCount++;
+        if (YoriShHistoryIndex.Commands != NULL) {
+            YoriLibHashInsertByKey(YoriShHistoryIndex.Commands, &NewHistoryEntry->CmdLine, NewHistoryEntry, &NewHistoryEntry->HashEntry);
+        }
+        YoriShHistoryIndexInsert(NewHistoryEntry);
+
         while (YoriShCommandHistoryCount > YoriShCommandHistoryMax) {
             PYORI_LIST_ENTRY ListEntry;
             PYORI_SH_HISTORY_ENTRY OldHistoryEntry;
 
             ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, NULL);
             OldHistoryEntry = CONTAINING_RECORD(ListEntry, YORI_SH_HISTORY_ENTRY, ListEntry);
-            YoriLibRemoveListItem(ListEntry);
-            YoriLibFreeStringContents(&OldHistoryEntry->CmdLine);
-            YoriLibFree(OldHistoryEntry);
-            YoriShCommandHistoryCount--;
+            YoriShFreeHistoryEntry(OldHistoryEntry);
         }
         ReleaseMutex(YoriShHistoryLock);
     }
@@ -139,10 +555,8 @@ YoriShRemoveOneHistoryEntry(
     )
 {
     if (WaitForSingleObject(YoriShHistoryLock, 0) == WAIT_OBJECT_0) {
-        YoriLibRemoveListItem(&HistoryEntry->ListEntry);
-        YoriLibFreeStringContents(&HistoryEntry->CmdLine);
-        YoriLibFree(HistoryEntry);
-        YoriShCommandHistoryCount--;
+        YoriShFreeHistoryEntry(HistoryEntry);
+        YoriShHistoryFileStale = TRUE;
         ReleaseMutex(YoriShHistoryLock);
     }
 }
@@ -161,15 +575,165 @@ YoriShClearAllHistory(VOID)
         while (ListEntry != NULL) {
             HistoryEntry = CONTAINING_RECORD(ListEntry, YORI_SH_HISTORY_ENTRY, ListEntry);
             ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, ListEntry);
-            YoriLibRemoveListItem(&HistoryEntry->ListEntry);
-            YoriLibFreeStringContents(&HistoryEntry->CmdLine);
-            YoriLibFree(HistoryEntry);
-            YoriShCommandHistoryCount--;
+            YoriShFreeHistoryEntry(HistoryEntry);
+        }
+
+        YoriShHistoryIndexDiscard();
+        if (YoriShHistoryIndex.Commands != NULL) {
+            YoriLibFreeEmptyHashTable(YoriShHistoryIndex.Commands);
+            YoriShHistoryIndex.Commands = NULL;
         }
+        YoriShHistoryFileStale = TRUE;
         ReleaseMutex(YoriShHistoryLock);
     }
 }
 
+/**
+ Check whether a history entry matches a search string.  The comparison is
+ case insensitive.
+
+ @param HistoryEntry Pointer to the history entry.
+
+ @param SearchString Pointer to the string to search for.
+
+ @param PrefixOnly If TRUE, the history entry must start with the search
+        string.  If FALSE, the search string can occur anywhere within the
+        history entry.
+
+ @return TRUE if the history entry matches, FALSE if it does not.
+ */
+BOOLEAN
+YoriShDoesHistoryEntryMatch(
+    __in PYORI_SH_HISTORY_ENTRY HistoryEntry,
+    __in PYORI_STRING SearchString,
+    __in BOOLEAN PrefixOnly
+    )
+{
+    if (SearchString->LengthInChars == 0) {
+        return TRUE;
+    }
+
+    if (PrefixOnly) {
+        if (YoriLibCompareStringInsCnt(&HistoryEntry->CmdLine, SearchString, SearchString->LengthInChars) == 0) {
+            return TRUE;
+        }
+        return FALSE;
+    }
+
+    if (YoriLibFindFirstMatchSubstrIns(&HistoryEntry->CmdLine, 1, SearchString, NULL) != NULL) {
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ Find the most recent history entry that matches a search string, and is
+ older than a specified history entry.  The comparison is case insensitive.
+ Searches for strings of three or more characters use the history search
+ index to only examine entries that may match.
+
+ @param SearchString Pointer to the string to search for.  If this is
+        empty, all entries match.
+
+ @param PrefixOnly If TRUE, the history entry must start with the search
+        string.  If FALSE, the search string can occur anywhere within the
+        history entry.
+
+ @param PreviousMatch Optionally points to a history entry returned from a
+        previous call.  If specified, only entries older than this entry are
+        returned.  If NULL, the search starts from the most recent entry.
+
+ @return Pointer to the matching history entry, or NULL if no further
+         entries match.
+ */
+PYORI_SH_HISTORY_ENTRY
+YoriShFindPreviousHistoryMatch(
+    __in PYORI_STRING SearchString,
+    __in BOOLEAN PrefixOnly,
+    __in_opt PYORI_SH_HISTORY_ENTRY PreviousMatch
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_HISTORY_ENTRY HistoryEntry;
+    PYORI_SH_HISTORY_POSTINGS Postings;
+    PYORI_SH_HISTORY_POSTINGS SmallestPostings;
+    YORI_ALLOC_SIZE_T Offset;
+    YORI_ALLOC_SIZE_T Start;
+    YORI_ALLOC_SIZE_T End;
+    YORI_ALLOC_SIZE_T Midpoint;
+
+    if (YoriShGlobal.CommandHistory.Next == NULL) {
+        return NULL;
+    }
+
+    if (SearchString->LengthInChars >= YORI_SH_HISTORY_TRIGRAM_LENGTH &&
+        YoriShHistoryIndex.Buckets != NULL &&
+        (PreviousMatch == NULL ||
+         (PreviousMatch->IndexSlot < YoriShHistoryIndex.SlotCount &&
+          YoriShHistoryIndex.Entries[PreviousMatch->IndexSlot] == PreviousMatch))) {
+
+        //
+        //  Every match must contain every three character sequence in the
+        //  search string, so only the entries in the smallest bucket need
+        //  to be examined.
+        //
+
+        SmallestPostings = NULL;
+        for (Offset = 0; Offset + YORI_SH_HISTORY_TRIGRAM_LENGTH <= SearchString->LengthInChars; Offset++) {
+            Postings = &YoriShHistoryIndex.Buckets[YoriShHistoryTrigramBucket(SearchString, Offset, YoriShHistoryIndex.BucketCount)];
+            if (SmallestPostings == NULL || Postings->Count < SmallestPostings->Count) {
+                SmallestPostings = Postings;
+            }
+        }
+
+        //
+        //  Find the first slot in the bucket that is not older than the
+        //  previous match, and search backwards from there.
+        //
+
+        End = SmallestPostings->Count;
+        if (PreviousMatch != NULL) {
+            Start = 0;
+            while (Start < End) {
+                Midpoint = Start + (End - Start) / 2;
+                if (SmallestPostings->Slots[Midpoint] < PreviousMatch->IndexSlot) {
+                    Start = Midpoint + 1;
+                } else {
+                    End = Midpoint;
+                }
+            }
+        }
+
+        while (End > 0) {
+            End--;
+            HistoryEntry = YoriShHistoryIndex.Entries[SmallestPostings->Slots[End]];
+            if (HistoryEntry != NULL &&
+                YoriShDoesHistoryEntryMatch(HistoryEntry, SearchString, PrefixOnly)) {
+
+                return HistoryEntry;
+            }
+        }
+
+        return NULL;
+    }
+
+    ListEntry = NULL;
+    if (PreviousMatch != NULL) {
+        ListEntry = &PreviousMatch->ListEntry;
+    }
+
+    ListEntry = YoriLibGetPreviousListEntry(&YoriShGlobal.CommandHistory, ListEntry);
+    while (ListEntry != NULL) {
+        HistoryEntry = CONTAINING_RECORD(ListEntry, YORI_SH_HISTORY_ENTRY, ListEntry);
+        if (YoriShDoesHistoryEntryMatch(HistoryEntry, SearchString, PrefixOnly)) {
+            return HistoryEntry;
+        }
+        ListEntry = YoriLibGetPreviousListEntry(&YoriShGlobal.CommandHistory, ListEntry);
+    }
+
+    return NULL;
+}
+
 /**
  Configure the maximum amount of history to retain if the user has requested
  this behavior by setting YORIHISTSIZE.
@@ -235,32 +799,25 @@ YoriShInitHistory(VOID)
 }
 
 /**
- Load history from a file if the user has requested this behavior by
- setting YORIHISTFILE.  Configure the maximum amount of history to retain
- if the user has requested this behavior by setting YORIHISTSIZE.
+ Return the fully qualified path to the history file, if the user has
+ requested history be saved by setting YORIHISTFILE.
+
+ @param FilePath On successful completion, updated to contain the path to
+        the history file.  If no history file is configured, this is
+        returned as an empty string.
 
  @return TRUE to indicate success, FALSE to indicate failure.
  */
 __success(return)
-BOOL
-YoriShLoadHistoryFromFile(VOID)
+BOOLEAN
+YoriShGetHistoryFileName(
+    __out PYORI_STRING FilePath
+    )
 {
     YORI_ALLOC_SIZE_T EnvVarLength;
     YORI_STRING UserHistFileName;
-    YORI_STRING FilePath;
-    HANDLE FileHandle;
-    PVOID LineContext = NULL;
-    YORI_STRING LineString;
-
-    if (YoriShHistoryInitialized) {
-        return TRUE;
-    }
-
-    YoriShInitHistory();
 
-    //
-    //  Check if there's a file to load saved history from.
-    //
+    YoriLibInitEmptyString(FilePath);
 
     EnvVarLength = YoriShGetEnvironmentVariableWithoutSubstitution(_T("YORIHISTFILE"), NULL, 0, NULL);
     if (EnvVarLength == 0) {
@@ -278,12 +835,51 @@ YoriShLoadHistoryFromFile(VOID)
         return FALSE;
     }
 
-    if (!YoriLibUserToSingleFilePath(&UserHistFileName, TRUE, &FilePath)) {
+    if (!YoriLibUserToSingleFilePath(&UserHistFileName, TRUE, FilePath)) {
         YoriLibFreeStringContents(&UserHistFileName);
         return FALSE;
     }
 
     YoriLibFreeStringContents(&UserHistFileName);
+    return TRUE;
+}
+
+/**
+ Load history from a file if the user has requested this behavior by
+ setting YORIHISTFILE.  Configure the maximum amount of history to retain
+ if the user has requested this behavior by setting YORIHISTSIZE.  The file
+ is a log of commands in the order they were entered, so where a command
+ appears more than once, the final instance determines its position in
+ history.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriShLoadHistoryFromFile(VOID)
+{
+    YORI_STRING FilePath;
+    HANDLE FileHandle;
+    PVOID LineContext = NULL;
+    YORI_STRING LineString;
+
+    if (YoriShHistoryInitialized) {
+        return TRUE;
+    }
+
+    YoriShInitHistory();
+
+    //
+    //  Check if there's a file to load saved history from.
+    //
+
+    if (!YoriShGetHistoryFileName(&FilePath)) {
+        return FALSE;
+    }
+
+    if (FilePath.LengthInChars == 0) {
+        return TRUE;
+    }
 
     FileHandle = CreateFile(FilePath.StartOfString,
                             GENERIC_READ,
@@ -314,6 +910,8 @@ YoriShLoadHistoryFromFile(VOID)
             break;
         }
 
+        YoriShHistoryLinesInFile++;
+
         //
         //  If we fail to add to history, stop.  If it is added to history,
         //  that string is now owned by the history buffer, so reinitialize
@@ -335,44 +933,87 @@ YoriShLoadHistoryFromFile(VOID)
 }
 
 /**
- Write the current command history buffer to a file, if the user has requested
- this behavior by configuring the YORIHISTFILE environment variable.
+ Append a single command to the history file, if the user has requested
+ this behavior by configuring the YORIHISTFILE environment variable.  This
+ is called as each command is entered, so that the file does not need to
+ be rewritten when the shell exits.
+
+ @param NewCmd Pointer to the command to append.
 
  @return TRUE to indicate success, FALSE to indicate failure.
  */
 __success(return)
 BOOL
-YoriShSaveHistoryToFile(VOID)
+YoriShAppendToHistoryFile(
+    __in PYORI_STRING NewCmd
+    )
 {
-    YORI_ALLOC_SIZE_T FileNameLength;
-    YORI_STRING UserHistFileName;
     YORI_STRING FilePath;
     HANDLE FileHandle;
-    PYORI_LIST_ENTRY ListEntry;
-    PYORI_SH_HISTORY_ENTRY HistoryEntry;
 
-    FileNameLength = YoriShGetEnvironmentVariableWithoutSubstitution(_T("YORIHISTFILE"), NULL, 0, NULL);
-    if (FileNameLength == 0) {
+    if (!YoriShGetHistoryFileName(&FilePath)) {
+        return FALSE;
+    }
+
+    if (FilePath.LengthInChars == 0) {
         return TRUE;
     }
 
-    if (!YoriLibAllocateString(&UserHistFileName, FileNameLength)) {
+    FileHandle = CreateFile(FilePath.StartOfString,
+                            FILE_APPEND_DATA,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL,
+                            OPEN_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL,
+                            NULL);
+
+    YoriLibFreeStringContents(&FilePath);
+
+    if (FileHandle == NULL || FileHandle == INVALID_HANDLE_VALUE) {
         return FALSE;
     }
 
-    UserHistFileName.LengthInChars = YoriShGetEnvironmentVariableWithoutSubstitution(_T("YORIHISTFILE"), UserHistFileName.StartOfString, UserHistFileName.LengthAllocated, NULL);
+    YoriLibOutputToDevice(FileHandle, 0, _T("%y\n"), NewCmd);
+    YoriShHistoryLinesInFile++;
 
-    if (UserHistFileName.LengthInChars == 0 || UserHistFileName.LengthInChars >= UserHistFileName.LengthAllocated) {
-        YoriLibFreeStringContents(&UserHistFileName);
-        return FALSE;
+    CloseHandle(FileHandle);
+    return TRUE;
+}
+
+/**
+ Write the current command history buffer to a file, if the user has requested
+ this behavior by configuring the YORIHISTFILE environment variable.  Since
+ commands are appended to the file as they are entered, this is only
+ performed if the file has accumulated many more lines than there are
+ history entries, if no commands have been loaded from or appended to
+ the file, or if commands have been removed from history so the file
+ contains commands that should not be loaded again.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriShSaveHistoryToFile(VOID)
+{
+    YORI_STRING FilePath;
+    HANDLE FileHandle;
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_HISTORY_ENTRY HistoryEntry;
+
+    if (!YoriShHistoryFileStale &&
+        YoriShHistoryLinesInFile > 0 &&
+        YoriShHistoryLinesInFile <= YoriShCommandHistoryCount * 2 + YORI_SH_HISTORY_COMPACT_SLACK) {
+
+        return TRUE;
     }
 
-    if (!YoriLibUserToSingleFilePath(&UserHistFileName, TRUE, &FilePath)) {
-        YoriLibFreeStringContents(&UserHistFileName);
+    if (!YoriShGetHistoryFileName(&FilePath)) {
         return FALSE;
     }
 
-    YoriLibFreeStringContents(&UserHistFileName);
+    if (FilePath.LengthInChars == 0) {
+        return TRUE;
+    }
 
     FileHandle = CreateFile(FilePath.StartOfString,
                             GENERIC_WRITE,
@@ -398,11 +1039,14 @@ YoriShSaveHistoryToFile(VOID)
     //
 
     if (WaitForSingleObject(YoriShHistoryLock, 0) == WAIT_OBJECT_0) {
+        YoriShHistoryLinesInFile = 0;
+        YoriShHistoryFileStale = FALSE;
         ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, NULL);
         while (ListEntry != NULL) {
             HistoryEntry = CONTAINING_RECORD(ListEntry, YORI_SH_HISTORY_ENTRY, ListEntry);
 
             YoriLibOutputToDevice(FileHandle, 0, _T("%y\n"), &HistoryEntry->CmdLine);
+            YoriShHistoryLinesInFile++;
 
             ListEntry = YoriLibGetNextListEntry(&YoriShGlobal.CommandHistory, ListEntry);
         }
@@ -3051,6 +3051,88 @@ YoriShProcessMouseScroll(
     return FALSE;
 }
 
+/**
+ Called when the background thread has finished enumerating a directory.
+ If no suggestion is currently displayed, this may be because the directory
+ contents were not available when the suggestion was generated, so discard
+ any matches and generate the suggestion again.
+
+ @param Buffer Pointer to the input buffer.
+ */
+VOID
+YoriShRefreshSuggestion(
+    __inout PYORI_SH_INPUT_BUFFER Buffer
+    )
+{
+    if (YoriShGlobal.DelayBeforeSuggesting == 0 ||
+        Buffer->TabContext.TabCount != 0 ||
+        Buffer->SuggestionString.LengthInChars != 0) {
+
+        return;
+    }
+
+    YoriShClearTabCompletionMatches(Buffer);
+
+    //
+    //  If the suggestion hasn't been generated yet, it will be generated
+    //  after the normal delay using the new directory contents.
+    //
+
+    if (!Buffer->SuggestionPopulated) {
+        return;
+    }
+
+    YoriShConfigureConsoleForTabComplete(Buffer);
+    YoriShCompleteSuggestion(Buffer);
+    YoriShConfigureConsoleForInput(Buffer);
+    if (Buffer->SuggestionString.LengthInChars > 0) {
+        Buffer->SuggestionDirty = TRUE;
+        YoriShDisplayAfterKeyPress(Buffer);
+    }
+}
+
+/**
+ Wait for console input to arrive.  While waiting, if the background thread
+ finishes enumerating a directory, regenerate any suggestion so it can be
+ displayed without waiting for further input.
+
+ @param Buffer Pointer to the input buffer.
+
+ @param InputHandle The handle to the console input.
+
+ @param Timeout The maximum time to wait for input, in milliseconds.
+
+ @return WAIT_OBJECT_0 if input is available, WAIT_TIMEOUT if no input
+         arrived within the timeout, or another value to indicate failure.
+ */
+DWORD
+YoriShWaitForInput(
+    __inout PYORI_SH_INPUT_BUFFER Buffer,
+    __in HANDLE InputHandle,
+    __in DWORD Timeout
+    )
+{
+    HANDLE WaitHandles[2];
+    DWORD Err;
+
+    WaitHandles[0] = InputHandle;
+    WaitHandles[1] = YoriShGetCompletionCacheEvent();
+
+    if (WaitHandles[1] == NULL) {
+        return WaitForSingleObject(InputHandle, Timeout);
+    }
+
+    while (TRUE) {
+        Err = WaitForMultipleObjects(2, WaitHandles, FALSE, Timeout);
+        if (Err != WAIT_OBJECT_0 + 1) {
+            return Err;
+        }
+
+        ResetEvent(WaitHandles[1]);
+        YoriShRefreshSuggestion(Buffer);
+    }
+}
+
 
 /**
  Get a new expression from the user through the console.
@@ -3182,8 +3264,10 @@ YoriShGetExpressionFromConsole(
             if (TerminateInput) {
                 YoriShTerminateInput(&Buffer);
                 ReadConsoleInput(InputHandle, InputRecords, CurrentRecordIndex + 1, &ActuallyRead);
-                if (Buffer.String.LengthInChars > 0) {
-                    YoriShAddToHistory(&Buffer.String, TRUE);
+                if (Buffer.String.LengthInChars > 0 &&
+                    YoriShAddToHistory(&Buffer.String, TRUE)) {
+
+                    YoriShAppendToHistoryFile(&Buffer.String);
                 }
                 memcpy(Expression, &Buffer.String, sizeof(YORI_STRING));
                 return TRUE;
@@ -3222,7 +3306,7 @@ YoriShGetExpressionFromConsole(
         while (TRUE) {
             if (YoriLibIsPeriodicScrollActive(&Buffer.Selection)) {
 
-                err = WaitForSingleObject(InputHandle, 100);
+                err = YoriShWaitForInput(&Buffer, InputHandle, 100);
                 if (err == WAIT_OBJECT_0) {
                     break;
                 }
@@ -3230,7 +3314,7 @@ YoriShGetExpressionFromConsole(
                     YoriLibPeriodicScrollForSelection(&Buffer.Selection);
                 }
             } else if (!Buffer.SuggestionPopulated) {
-                err = WaitForSingleObject(InputHandle, YoriShGlobal.DelayBeforeSuggesting);
+                err = YoriShWaitForInput(&Buffer, InputHandle, YoriShGlobal.DelayBeforeSuggesting);
                 if (err == WAIT_OBJECT_0) {
                     break;
                 }
@@ -3247,7 +3331,7 @@ YoriShGetExpressionFromConsole(
                     }
                 }
             } else if (!RestartStateSaved) {
-                err = WaitForSingleObject(InputHandle, 30 * 1000);
+                err = YoriShWaitForInput(&Buffer, InputHandle, 30 * 1000);
                 if (err == WAIT_OBJECT_0) {
                     break;
                 }
@@ -3257,7 +3341,7 @@ YoriShGetExpressionFromConsole(
                     RestartStateSaved = TRUE;
                 }
             } else {
-                err = WaitForSingleObject(InputHandle, INFINITE);
+                err = YoriShWaitForInput(&Buffer, InputHandle, INFINITE);
                 if (err == WAIT_OBJECT_0) {
                     break;
                 }
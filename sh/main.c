@@ -916,6 +916,8 @@ ymain (
     YoriShScanJobsReportCompletion(TRUE);
     YoriShClearAllHistory();
     YoriShClearAllAliases();
+    YoriShClearPathCache();
+    YoriShCleanupCompletionCache();
     YoriLibShBuiltinUnregisterAll();
     YoriShDiscardSavedRestartState(NULL);
     YoriShCleanupInputContext();
@@ -57,7 +57,7 @@ YoriShResolveCommandToExecutable(
         YoriLibCloneString(&ExpandedCmd, &CmdContext->ArgV[0]);
     }
 
-    if (YoriLibLocateExecutableInPath(&ExpandedCmd, NULL, NULL, &FoundExecutable)) {
+    if (YoriShLocateExecutableInPath(&ExpandedCmd, NULL, NULL, &FoundExecutable)) {
 
         if (FoundExecutable.LengthInChars > 0) {
             YoriLibFreeStringContents(&CmdContext->ArgV[0]);
@@ -0,0 +1,1372 @@
+/**
+ * @file sh/pathcache.c
+ *
+ * Yori shell cache of executables found in the path
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "yori.h"
+
+/**
+ A hardcoded search order for file extensions if the environment variable is
+ not defined.  This matches the order used by the library path search.
+ */
+LPCTSTR YoriShPathCacheDefaultPathExt = _T(".com;.exe;.bat;.cmd");
+
+/**
+ Information about a single executable file found when enumerating a
+ directory in the path.
+ */
+typedef struct _YORI_SH_PATH_CACHE_FILE {
+
+    /**
+     The hash entry of the file.  The key is the file name without any
+     path.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     The list of files within the directory in enumeration order.  Paired
+     with YORI_SH_PATH_CACHE_DIRECTORY::FileList .
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     Storage for the file name, which is used as the hash key.  This is
+     allocated as part of this structure and extends beyond it.
+     */
+    TCHAR FileName[1];
+
+} YORI_SH_PATH_CACHE_FILE, *PYORI_SH_PATH_CACHE_FILE;
+
+/**
+ Information about a directory in the path.
+ */
+typedef struct _YORI_SH_PATH_CACHE_DIRECTORY {
+
+    /**
+     The list of directories in path search order.  Paired with
+     YORI_SH_PATH_CACHE::DirectoryList .
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     The fully qualified, NULL terminated path to the directory.  This does
+     not have a trailing separator unless it refers to the root of a drive.
+     */
+    YORI_STRING DirectoryName;
+
+    /**
+     A change notification handle which is signalled when a file is
+     created, deleted or renamed in the directory.  If a change notification
+     could not be established, this is NULL and the last write time of the
+     directory is checked instead.
+     */
+    HANDLE ChangeNotification;
+
+    /**
+     The last write time of the directory when it was enumerated.  Only
+     meaningful if ChangeNotification is NULL.
+     */
+    LARGE_INTEGER LastWriteTime;
+
+    /**
+     TRUE if the directory did not exist when it was enumerated.  Only
+     meaningful if ChangeNotification is NULL.
+     */
+    BOOLEAN Missing;
+
+    /**
+     A hash table of executable files found in the directory.  This is NULL
+     if the directory has not been enumerated since it was last changed.
+     */
+    PYORI_HASH_TABLE Files;
+
+    /**
+     A list of executable files found in the directory.  Paired with
+     YORI_SH_PATH_CACHE_FILE::ListEntry .
+     */
+    YORI_LIST_ENTRY FileList;
+
+} YORI_SH_PATH_CACHE_DIRECTORY, *PYORI_SH_PATH_CACHE_DIRECTORY;
+
+/**
+ Information about a command which has previously been resolved to a file
+ in one of the directories in the path.
+ */
+typedef struct _YORI_SH_PATH_CACHE_COMMAND {
+
+    /**
+     The hash entry of the command.  The key is the command as it was
+     searched for.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     The list of commands in the order they were resolved.  Paired with
+     YORI_SH_PATH_CACHE::CommandList .
+     */
+    YORI_LIST_ENTRY ListEntry;
+
+    /**
+     The fully qualified path to the executable.
+     */
+    YORI_STRING FoundPath;
+
+    /**
+     TRUE if the command specified an extension and the file found has the
+     name exactly as specified.  FALSE if the file was found by appending an
+     extension from PATHEXT.
+     */
+    BOOLEAN ExactMatch;
+
+} YORI_SH_PATH_CACHE_COMMAND, *PYORI_SH_PATH_CACHE_COMMAND;
+
+/**
+ The state of the executable cache.
+ */
+typedef struct _YORI_SH_PATH_CACHE {
+
+    /**
+     The value of the PATH environment variable that the directory list was
+     built from.
+     */
+    YORI_STRING PathVariable;
+
+    /**
+     The value of the PATHEXT environment variable that the extension list
+     was built from.
+     */
+    YORI_STRING PathExtVariable;
+
+    /**
+     An array of extensions to search for, in search order.  These strings
+     refer to PathExtVariable or the default extension list and do not
+     have allocations of their own.
+     */
+    PYORI_STRING PathExt;
+
+    /**
+     The number of elements in the PathExt array.
+     */
+    YORI_ALLOC_SIZE_T PathExtCount;
+
+    /**
+     The list of directories in the path, in search order.  Paired with
+     YORI_SH_PATH_CACHE_DIRECTORY::ListEntry .
+     */
+    YORI_LIST_ENTRY DirectoryList;
+
+    /**
+     A hash table of commands which have been resolved to an executable
+     in the path.
+     */
+    PYORI_HASH_TABLE Commands;
+
+    /**
+     The list of commands which have been resolved, in the order they were
+     resolved.  Paired with YORI_SH_PATH_CACHE_COMMAND::ListEntry .
+     */
+    YORI_LIST_ENTRY CommandList;
+
+    /**
+     TRUE once PathVariable and PathExtVariable have been captured and the
+     directory list built from them.
+     */
+    BOOLEAN Initialized;
+
+    /**
+     TRUE if the cache can be used with the current PATH.  This is FALSE if
+     the path contains relative directories, whose meaning depends on the
+     current directory.
+     */
+    BOOLEAN Usable;
+
+} YORI_SH_PATH_CACHE, *PYORI_SH_PATH_CACHE;
+
+/**
+ The cache of directories in the path and the commands found in them.
+ */
+YORI_SH_PATH_CACHE YoriShPathCache;
+
+/**
+ Free all of the files found within a directory, leaving the directory
+ entry indicating it needs to be enumerated again.
+
+ @param Directory Pointer to the directory whose contents should be freed.
+ */
+VOID
+YoriShPathCacheFreeDirectoryFiles(
+    __inout PYORI_SH_PATH_CACHE_DIRECTORY Directory
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_PATH_CACHE_FILE File;
+
+    ListEntry = YoriLibGetNextListEntry(&Directory->FileList, NULL);
+    while (ListEntry != NULL) {
+        File = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_FILE, ListEntry);
+        YoriLibRemoveListItem(&File->ListEntry);
+        YoriLibHashRemoveByEntry(&File->HashEntry);
+        YoriLibFree(File);
+        ListEntry = YoriLibGetNextListEntry(&Directory->FileList, NULL);
+    }
+
+    if (Directory->Files != NULL) {
+        YoriLibFreeEmptyHashTable(Directory->Files);
+        Directory->Files = NULL;
+    }
+}
+
+/**
+ Discard all commands which have been resolved, so that each is searched
+ for again on next use.
+ */
+VOID
+YoriShPathCacheFreeCommands(VOID)
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_PATH_CACHE_COMMAND Command;
+
+    if (YoriShPathCache.CommandList.Next == NULL) {
+        return;
+    }
+
+    ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.CommandList, NULL);
+    while (ListEntry != NULL) {
+        Command = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_COMMAND, ListEntry);
+        YoriLibRemoveListItem(&Command->ListEntry);
+        YoriLibHashRemoveByEntry(&Command->HashEntry);
+        YoriLibFreeStringContents(&Command->FoundPath);
+        YoriLibFree(Command);
+        ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.CommandList, NULL);
+    }
+}
+
+/**
+ Discard everything known about the path, including the directories within
+ it, the files found within those directories, and any commands that have
+ been resolved.  The next search will capture the path again.
+ */
+VOID
+YoriShClearPathCache(VOID)
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_PATH_CACHE_DIRECTORY Directory;
+
+    YoriShPathCacheFreeCommands();
+    if (YoriShPathCache.Commands != NULL) {
+        YoriLibFreeEmptyHashTable(YoriShPathCache.Commands);
+        YoriShPathCache.Commands = NULL;
+    }
+
+    if (YoriShPathCache.DirectoryList.Next != NULL) {
+        ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, NULL);
+        while (ListEntry != NULL) {
+            Directory = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_DIRECTORY, ListEntry);
+            YoriLibRemoveListItem(&Directory->ListEntry);
+            YoriShPathCacheFreeDirectoryFiles(Directory);
+            if (Directory->ChangeNotification != NULL) {
+                FindCloseChangeNotification(Directory->ChangeNotification);
+            }
+            YoriLibFreeStringContents(&Directory->DirectoryName);
+            YoriLibFree(Directory);
+            ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, NULL);
+        }
+    }
+
+    if (YoriShPathCache.PathExt != NULL) {
+        YoriLibFree(YoriShPathCache.PathExt);
+        YoriShPathCache.PathExt = NULL;
+    }
+    YoriShPathCache.PathExtCount = 0;
+
+    YoriLibFreeStringContents(&YoriShPathCache.PathVariable);
+    YoriLibFreeStringContents(&YoriShPathCache.PathExtVariable);
+    YoriShPathCache.Initialized = FALSE;
+    YoriShPathCache.Usable = FALSE;
+}
+
+/**
+ Return TRUE if a file name ends in one of the extensions in PATHEXT.
+
+ @param FileName Pointer to the file name to check.
+
+ @return TRUE if the file name has an executable extension, FALSE if not.
+ */
+BOOLEAN
+YoriShPathCacheIsExecutableName(
+    __in PCYORI_STRING FileName
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    YORI_STRING FileExt;
+    PYORI_STRING PathExt;
+
+    for (Index = 0; Index < YoriShPathCache.PathExtCount; Index++) {
+        PathExt = &YoriShPathCache.PathExt[Index];
+        if (FileName->LengthInChars > PathExt->LengthInChars) {
+            YoriLibInitEmptyString(&FileExt);
+            FileExt.StartOfString = &FileName->StartOfString[FileName->LengthInChars - PathExt->LengthInChars];
+            FileExt.LengthInChars = PathExt->LengthInChars;
+            if (YoriLibCompareStringIns(&FileExt, PathExt) == 0) {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ Decompose the captured PATHEXT value into an array of extensions in search
+ order.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheBuildPathExt(VOID)
+{
+    YORI_STRING PathExtString;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Start;
+    YORI_ALLOC_SIZE_T Count;
+    BOOLEAN Populate;
+
+    if (YoriShPathCache.PathExtVariable.LengthInChars > 0) {
+        YoriLibInitEmptyString(&PathExtString);
+        PathExtString.StartOfString = YoriShPathCache.PathExtVariable.StartOfString;
+        PathExtString.LengthInChars = YoriShPathCache.PathExtVariable.LengthInChars;
+    } else {
+        YoriLibConstantString(&PathExtString, YoriShPathCacheDefaultPathExt);
+    }
+
+    //
+    //  Count the components on the first pass and populate them on the
+    //  second.
+    //
+
+    Populate = FALSE;
+    while (TRUE) {
+        Count = 0;
+        Index = 0;
+        while (Index < PathExtString.LengthInChars) {
+            Start = Index;
+            while (Index < PathExtString.LengthInChars && PathExtString.StartOfString[Index] != ';') {
+                Index++;
+            }
+
+            if (Index > Start) {
+                if (Populate) {
+                    YoriLibInitEmptyString(&YoriShPathCache.PathExt[Count]);
+                    YoriShPathCache.PathExt[Count].StartOfString = &PathExtString.StartOfString[Start];
+                    YoriShPathCache.PathExt[Count].LengthInChars = Index - Start;
+                }
+                Count++;
+            }
+            Index++;
+        }
+
+        if (Populate || Count == 0) {
+            break;
+        }
+
+        YoriShPathCache.PathExt = YoriLibMalloc(Count * sizeof(YORI_STRING));
+        if (YoriShPathCache.PathExt == NULL) {
+            return FALSE;
+        }
+        Populate = TRUE;
+    }
+
+    YoriShPathCache.PathExtCount = Count;
+    return TRUE;
+}
+
+/**
+ Add a directory from the path to the end of the list of directories to
+ search.  The directory is not enumerated until it is needed.
+
+ @param PathComponent Pointer to the directory as it is specified in the
+        path.
+
+ @return TRUE to indicate the directory was added.  FALSE to indicate it was
+         not, either because it is a relative path or because of an
+         allocation failure.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheAddDirectory(
+    __in PYORI_STRING PathComponent
+    )
+{
+    PYORI_SH_PATH_CACHE_DIRECTORY Directory;
+    YORI_STRING RelativeName;
+
+    //
+    //  A relative directory in the path, such as ".", refers to a different
+    //  location whenever the current directory changes.  These can't be
+    //  cached.
+    //
+
+    if (!YoriLibIsDrvLetterColonSlash(PathComponent) &&
+        (PathComponent->LengthInChars < 2 ||
+         !YoriLibIsSep(PathComponent->StartOfString[0]) ||
+         !YoriLibIsSep(PathComponent->StartOfString[1]))) {
+
+        return FALSE;
+    }
+
+    Directory = YoriLibMalloc(sizeof(YORI_SH_PATH_CACHE_DIRECTORY));
+    if (Directory == NULL) {
+        return FALSE;
+    }
+
+    ZeroMemory(Directory, sizeof(YORI_SH_PATH_CACHE_DIRECTORY));
+    YoriLibInitializeListHead(&Directory->FileList);
+
+    if (!YoriLibCopyString(&RelativeName, PathComponent)) {
+        YoriLibFree(Directory);
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(&Directory->DirectoryName);
+    if (!YoriLibGetFullPathNameAlloc(&RelativeName, FALSE, &Directory->DirectoryName, NULL)) {
+        YoriLibFreeStringContents(&RelativeName);
+        YoriLibFree(Directory);
+        return FALSE;
+    }
+    YoriLibFreeStringContents(&RelativeName);
+
+    //
+    //  Remove any trailing separator, unless it refers to the root of a
+    //  drive, so that names can be consistently appended.
+    //
+
+    if (Directory->DirectoryName.LengthInChars > 3 &&
+        YoriLibIsSep(Directory->DirectoryName.StartOfString[Directory->DirectoryName.LengthInChars - 1])) {
+
+        Directory->DirectoryName.LengthInChars--;
+        Directory->DirectoryName.StartOfString[Directory->DirectoryName.LengthInChars] = '\0';
+    }
+
+    YoriLibAppendList(&YoriShPathCache.DirectoryList, &Directory->ListEntry);
+    return TRUE;
+}
+
+/**
+ Check whether the PATH and PATHEXT environment variables have changed since
+ the cache was built.  If they have, discard everything and build the list
+ of directories again.
+
+ @return TRUE if the cache can be used, FALSE if the caller should perform
+         an uncached search.
+ */
+BOOLEAN
+YoriShPathCacheCheckEnvironment(VOID)
+{
+    YORI_STRING PathVariable;
+    YORI_STRING PathExtVariable;
+    YORI_STRING PathComponent;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Start;
+
+    YoriLibInitEmptyString(&PathVariable);
+    YoriLibInitEmptyString(&PathExtVariable);
+
+    if (!YoriLibAllocateAndGetEnvVar(_T("PATH"), &PathVariable)) {
+        return FALSE;
+    }
+
+    if (!YoriLibAllocateAndGetEnvVar(_T("PATHEXT"), &PathExtVariable)) {
+        YoriLibFreeStringContents(&PathVariable);
+        return FALSE;
+    }
+
+    if (YoriShPathCache.Initialized &&
+        YoriLibCompareString(&PathVariable, &YoriShPathCache.PathVariable) == 0 &&
+        YoriLibCompareString(&PathExtVariable, &YoriShPathCache.PathExtVariable) == 0) {
+
+        YoriLibFreeStringContents(&PathVariable);
+        YoriLibFreeStringContents(&PathExtVariable);
+        return YoriShPathCache.Usable;
+    }
+
+    YoriShClearPathCache();
+    if (YoriShPathCache.DirectoryList.Next == NULL) {
+        YoriLibInitializeListHead(&YoriShPathCache.DirectoryList);
+        YoriLibInitializeListHead(&YoriShPathCache.CommandList);
+    }
+
+    memcpy(&YoriShPathCache.PathVariable, &PathVariable, sizeof(YORI_STRING));
+    memcpy(&YoriShPathCache.PathExtVariable, &PathExtVariable, sizeof(YORI_STRING));
+    YoriShPathCache.Initialized = TRUE;
+
+    YoriShPathCache.Commands = YoriLibAllocateHashTable(64);
+    if (YoriShPathCache.Commands == NULL) {
+        return FALSE;
+    }
+
+    if (!YoriShPathCacheBuildPathExt()) {
+        return FALSE;
+    }
+
+    //
+    //  Split the path into directories.  Like the library search, a
+    //  component can be surrounded in quotes.
+    //
+
+    Index = 0;
+    while (Index < PathVariable.LengthInChars) {
+        Start = Index;
+        while (Index < PathVariable.LengthInChars && PathVariable.StartOfString[Index] != ';') {
+            Index++;
+        }
+
+        YoriLibInitEmptyString(&PathComponent);
+        PathComponent.StartOfString = &PathVariable.StartOfString[Start];
+        PathComponent.LengthInChars = Index - Start;
+        Index++;
+
+        if (PathComponent.LengthInChars > 0 && PathComponent.StartOfString[0] == '"') {
+            PathComponent.StartOfString++;
+            PathComponent.LengthInChars--;
+        }
+
+        if (PathComponent.LengthInChars > 0 && PathComponent.StartOfString[PathComponent.LengthInChars - 1] == '"') {
+            PathComponent.LengthInChars--;
+        }
+
+        if (PathComponent.LengthInChars == 0) {
+            continue;
+        }
+
+        if (!YoriShPathCacheAddDirectory(&PathComponent)) {
+            return FALSE;
+        }
+    }
+
+    YoriShPathCache.Usable = TRUE;
+    return TRUE;
+}
+
+/**
+ Query the last write time of a directory, or determine that it does not
+ exist.
+
+ @param Directory Pointer to the directory to query.
+
+ @param Missing On successful completion, set to TRUE if the directory does
+        not exist.
+
+ @param LastWriteTime On successful completion, set to the last write time of
+        the directory, or zero if it does not exist.
+
+ @return TRUE to indicate the state of the directory is known, FALSE if it
+         could not be determined.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheGetDirectoryState(
+    __in PYORI_SH_PATH_CACHE_DIRECTORY Directory,
+    __out PBOOLEAN Missing,
+    __out PLARGE_INTEGER LastWriteTime
+    )
+{
+    HANDLE hDir;
+    FILETIME WriteTime;
+    DWORD Err;
+
+    *Missing = FALSE;
+    LastWriteTime->QuadPart = 0;
+
+    hDir = CreateFile(Directory->DirectoryName.StartOfString,
+                      FILE_READ_ATTRIBUTES,
+                      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                      NULL,
+                      OPEN_EXISTING,
+                      FILE_FLAG_BACKUP_SEMANTICS,
+                      NULL);
+
+    if (hDir == INVALID_HANDLE_VALUE) {
+        Err = GetLastError();
+        if (Err == ERROR_FILE_NOT_FOUND || Err == ERROR_PATH_NOT_FOUND) {
+            *Missing = TRUE;
+            return TRUE;
+        }
+        return FALSE;
+    }
+
+    if (!GetFileTime(hDir, NULL, NULL, &WriteTime)) {
+        CloseHandle(hDir);
+        return FALSE;
+    }
+
+    CloseHandle(hDir);
+    LastWriteTime->LowPart = WriteTime.dwLowDateTime;
+    LastWriteTime->HighPart = WriteTime.dwHighDateTime;
+    return TRUE;
+}
+
+/**
+ Enumerate a directory in the path and record every executable file found
+ within it.
+
+ @param Directory Pointer to the directory to enumerate.
+
+ @return TRUE to indicate the directory contents are known, which includes
+         the directory not existing.  FALSE to indicate the contents could
+         not be determined.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheEnumerateDirectory(
+    __inout PYORI_SH_PATH_CACHE_DIRECTORY Directory
+    )
+{
+    PYORI_SH_PATH_CACHE_FILE File;
+    YORI_STRING SearchPath;
+    YORI_STRING FileName;
+    WIN32_FIND_DATA FindData;
+    HANDLE FindHandle;
+    DWORD Err;
+
+    //
+    //  Arm change detection before enumerating, so that anything which
+    //  changes during enumeration is detected on the next search.
+    //
+
+    if (Directory->ChangeNotification == NULL) {
+        Directory->ChangeNotification = FindFirstChangeNotification(Directory->DirectoryName.StartOfString, FALSE, FILE_NOTIFY_CHANGE_FILE_NAME);
+        if (Directory->ChangeNotification == INVALID_HANDLE_VALUE) {
+            Directory->ChangeNotification = NULL;
+        }
+    }
+
+    if (Directory->ChangeNotification == NULL) {
+        if (!YoriShPathCacheGetDirectoryState(Directory, &Directory->Missing, &Directory->LastWriteTime)) {
+            Directory->Missing = FALSE;
+            Directory->LastWriteTime.QuadPart = 0;
+        }
+    }
+
+    if (!YoriLibAllocateString(&SearchPath, Directory->DirectoryName.LengthInChars + sizeof("\\*"))) {
+        return FALSE;
+    }
+
+    if (YoriLibIsSep(Directory->DirectoryName.StartOfString[Directory->DirectoryName.LengthInChars - 1])) {
+        SearchPath.LengthInChars = YoriLibSPrintf(SearchPath.StartOfString, _T("%y*"), &Directory->DirectoryName);
+    } else {
+        SearchPath.LengthInChars = YoriLibSPrintf(SearchPath.StartOfString, _T("%y\\*"), &Directory->DirectoryName);
+    }
+
+    Directory->Files = YoriLibAllocateHashTable(32);
+    if (Directory->Files == NULL) {
+        YoriLibFreeStringContents(&SearchPath);
+        return FALSE;
+    }
+
+    FindHandle = FindFirstFile(SearchPath.StartOfString, &FindData);
+    YoriLibFreeStringContents(&SearchPath);
+    if (FindHandle == INVALID_HANDLE_VALUE) {
+
+        //
+        //  If the directory does not exist, or is empty, no file within it
+        //  exists.  Any other error means the contents are unknown.
+        //
+
+        Err = GetLastError();
+        if (Err == ERROR_FILE_NOT_FOUND || Err == ERROR_PATH_NOT_FOUND) {
+            return TRUE;
+        }
+
+        YoriShPathCacheFreeDirectoryFiles(Directory);
+        return FALSE;
+    }
+
+    do {
+        if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            continue;
+        }
+
+        YoriLibConstantString(&FileName, FindData.cFileName);
+        if (!YoriShPathCacheIsExecutableName(&FileName)) {
+            continue;
+        }
+
+        //
+        //  The hash table references the key rather than copying it, so
+        //  the name needs to outlive the find data.
+        //
+
+        File = YoriLibMalloc(sizeof(YORI_SH_PATH_CACHE_FILE) + FileName.LengthInChars * sizeof(TCHAR));
+        if (File == NULL) {
+            FindClose(FindHandle);
+            YoriShPathCacheFreeDirectoryFiles(Directory);
+            return FALSE;
+        }
+
+        memcpy(File->FileName, FileName.StartOfString, FileName.LengthInChars * sizeof(TCHAR));
+        File->FileName[FileName.LengthInChars] = '\0';
+        FileName.StartOfString = File->FileName;
+
+        YoriLibHashInsertByKey(Directory->Files, &FileName, File, &File->HashEntry);
+        YoriLibAppendList(&Directory->FileList, &File->ListEntry);
+
+    } while (FindNextFile(FindHandle, &FindData));
+
+    FindClose(FindHandle);
+    return TRUE;
+}
+
+/**
+ Check whether the contents of a directory may have changed since it was
+ enumerated.  If so, discard the contents so it will be enumerated again
+ when next needed.
+
+ @param Directory Pointer to the directory to check.
+
+ @return TRUE if the directory contents were discarded, FALSE if they are
+         still valid or had not been enumerated.
+ */
+BOOLEAN
+YoriShPathCacheHasDirectoryChanged(
+    __inout PYORI_SH_PATH_CACHE_DIRECTORY Directory
+    )
+{
+    LARGE_INTEGER LastWriteTime;
+    BOOLEAN Missing;
+
+    if (Directory->Files == NULL) {
+        return FALSE;
+    }
+
+    if (Directory->ChangeNotification != NULL) {
+        if (WaitForSingleObject(Directory->ChangeNotification, 0) != WAIT_OBJECT_0) {
+            return FALSE;
+        }
+
+        if (!FindNextChangeNotification(Directory->ChangeNotification)) {
+            FindCloseChangeNotification(Directory->ChangeNotification);
+            Directory->ChangeNotification = NULL;
+        }
+    } else {
+        if (YoriShPathCacheGetDirectoryState(Directory, &Missing, &LastWriteTime) &&
+            Missing == Directory->Missing &&
+            LastWriteTime.QuadPart == Directory->LastWriteTime.QuadPart) {
+
+            return FALSE;
+        }
+    }
+
+    YoriShPathCacheFreeDirectoryFiles(Directory);
+    return TRUE;
+}
+
+/**
+ Prepare the cache for a search.  This checks whether the path has changed,
+ and whether any directory within it has changed.  If any directory has
+ changed, previously resolved commands are discarded, since a new file could
+ take precedence over a file found in a later directory.
+
+ @return TRUE if the cache can be used, FALSE if the caller should perform
+         an uncached search.
+ */
+BOOLEAN
+YoriShPathCacheRefresh(VOID)
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_PATH_CACHE_DIRECTORY Directory;
+    BOOLEAN Changed;
+
+    if (!YoriShPathCacheCheckEnvironment()) {
+        return FALSE;
+    }
+
+    Changed = FALSE;
+    ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, NULL);
+    while (ListEntry != NULL) {
+        Directory = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_DIRECTORY, ListEntry);
+        if (YoriShPathCacheHasDirectoryChanged(Directory)) {
+            Changed = TRUE;
+        }
+        ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, ListEntry);
+    }
+
+    if (Changed) {
+        YoriShPathCacheFreeCommands();
+    }
+
+    return TRUE;
+}
+
+/**
+ Build the fully qualified path to a file found in a directory.
+
+ @param Directory Pointer to the directory containing the file.
+
+ @param File Pointer to the file.
+
+ @param FoundPath On successful completion, updated to contain a newly
+        allocated fully qualified path to the file.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheBuildFullName(
+    __in PYORI_SH_PATH_CACHE_DIRECTORY Directory,
+    __in PYORI_SH_PATH_CACHE_FILE File,
+    __out PYORI_STRING FoundPath
+    )
+{
+    if (!YoriLibAllocateString(FoundPath, Directory->DirectoryName.LengthInChars + 1 + File->HashEntry.Key.LengthInChars + 1)) {
+        return FALSE;
+    }
+
+    if (YoriLibIsSep(Directory->DirectoryName.StartOfString[Directory->DirectoryName.LengthInChars - 1])) {
+        FoundPath->LengthInChars = YoriLibSPrintf(FoundPath->StartOfString, _T("%y%y"), &Directory->DirectoryName, &File->HashEntry.Key);
+    } else {
+        FoundPath->LengthInChars = YoriLibSPrintf(FoundPath->StartOfString, _T("%y\\%y"), &Directory->DirectoryName, &File->HashEntry.Key);
+    }
+
+    return TRUE;
+}
+
+/**
+ Search the current directory for an executable.  This is never cached,
+ since it depends on the current directory, and is performed by the library
+ so that the results are identical to an uncached search.
+
+ @param SearchFor Pointer to the name to search for.
+
+ @param ExactName If TRUE, search for the name exactly as specified.  If
+        FALSE, search for the name with each extension in PATHEXT appended.
+
+ @param MatchAllCallback Optional callback to invoke on every match.  If not
+        specified, the first match is returned in FoundPath.
+
+ @param MatchAllContext Context to pass to MatchAllCallback .
+
+ @param FoundPath On successful completion, if MatchAllCallback is not
+        specified, updated to contain a newly allocated path to any match,
+        or an empty string if no match was found.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheSearchCurrentDirectory(
+    __in PYORI_STRING SearchFor,
+    __in BOOLEAN ExactName,
+    __in_opt PYORI_LIB_PATH_MATCH_FN MatchAllCallback,
+    __in_opt PVOID MatchAllContext,
+    __out PYORI_STRING FoundPath
+    )
+{
+    YORI_STRING EmptyPath;
+    YORI_ALLOC_SIZE_T Length;
+    BOOL Result;
+
+    Length = (YORI_ALLOC_SIZE_T)GetCurrentDirectory(0, NULL);
+    if (Length < MAX_PATH) {
+        Length = MAX_PATH;
+    }
+
+    Length = Length + sizeof("\\\\?\\") + 256;
+    if (!YoriLibAllocateString(FoundPath, Length)) {
+        return FALSE;
+    }
+
+    FoundPath->StartOfString[0] = '\0';
+    YoriLibConstantString(&EmptyPath, _T(""));
+
+    if (ExactName) {
+        Result = YoriLibPathLocateKnownExtensionUnknownLocation(SearchFor, &EmptyPath, MatchAllCallback, MatchAllContext, FoundPath);
+    } else {
+        Result = YoriLibPathLocateUnknownExtensionUnknownLocation(SearchFor, &EmptyPath, TRUE, MatchAllCallback, MatchAllContext, FoundPath);
+    }
+
+    if (!Result) {
+        YoriLibFreeStringContents(FoundPath);
+        return FALSE;
+    }
+
+    if (MatchAllCallback != NULL || FoundPath->StartOfString[0] == '\0') {
+        YoriLibFreeStringContents(FoundPath);
+    }
+
+    return TRUE;
+}
+
+/**
+ Search the directories in the path for an executable, enumerating any
+ directory whose contents are not already known.
+
+ @param SearchFor Pointer to the name to search for.
+
+ @param ExactName If TRUE, search for the name exactly as specified.  If
+        FALSE, search for the name with each extension in PATHEXT appended,
+        in PATHEXT order.
+
+ @param FoundPath On successful completion, updated to contain a newly
+        allocated path to the first match, or an empty string if no match
+        was found.
+
+ @return TRUE to indicate the search completed, FALSE if a directory could
+         not be enumerated and the caller should perform an uncached search.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheSearchDirectories(
+    __in PYORI_STRING SearchFor,
+    __in BOOLEAN ExactName,
+    __out PYORI_STRING FoundPath
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_PATH_CACHE_DIRECTORY Directory;
+    PYORI_HASH_ENTRY HashEntry;
+    YORI_STRING Candidate;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T LongestExt;
+
+    YoriLibInitEmptyString(FoundPath);
+    YoriLibInitEmptyString(&Candidate);
+
+    if (!ExactName) {
+        LongestExt = 0;
+        for (Index = 0; Index < YoriShPathCache.PathExtCount; Index++) {
+            if (YoriShPathCache.PathExt[Index].LengthInChars > LongestExt) {
+                LongestExt = YoriShPathCache.PathExt[Index].LengthInChars;
+            }
+        }
+
+        if (!YoriLibAllocateString(&Candidate, SearchFor->LengthInChars + LongestExt + 1)) {
+            return FALSE;
+        }
+
+        memcpy(Candidate.StartOfString, SearchFor->StartOfString, SearchFor->LengthInChars * sizeof(TCHAR));
+    }
+
+    ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, NULL);
+    while (ListEntry != NULL) {
+        Directory = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_DIRECTORY, ListEntry);
+        if (Directory->Files == NULL &&
+            !YoriShPathCacheEnumerateDirectory(Directory)) {
+
+            YoriLibFreeStringContents(&Candidate);
+            return FALSE;
+        }
+
+        HashEntry = NULL;
+        if (ExactName) {
+            HashEntry = YoriLibHashLookupByKey(Directory->Files, SearchFor);
+        } else {
+            for (Index = 0; Index < YoriShPathCache.PathExtCount; Index++) {
+                memcpy(&Candidate.StartOfString[SearchFor->LengthInChars],
+                       YoriShPathCache.PathExt[Index].StartOfString,
+                       YoriShPathCache.PathExt[Index].LengthInChars * sizeof(TCHAR));
+                Candidate.LengthInChars = SearchFor->LengthInChars + YoriShPathCache.PathExt[Index].LengthInChars;
+                HashEntry = YoriLibHashLookupByKey(Directory->Files, &Candidate);
+                if (HashEntry != NULL) {
+                    break;
+                }
+            }
+        }
+
+        if (HashEntry != NULL) {
+            YoriLibFreeStringContents(&Candidate);
+            return YoriShPathCacheBuildFullName(Directory, HashEntry->Context, FoundPath);
+        }
+
+        ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, ListEntry);
+    }
+
+    YoriLibFreeStringContents(&Candidate);
+    return TRUE;
+}
+
+/**
+ Record a command which has been resolved to an executable in the path.
+ Failure to record is not fatal; the command will be searched for again.
+
+ @param SearchFor Pointer to the command as it was searched for.
+
+ @param FoundPath Pointer to the fully qualified path to the executable.
+
+ @param ExactMatch TRUE if the file was found with the name exactly as
+        specified, FALSE if an extension from PATHEXT was appended.
+ */
+VOID
+YoriShPathCacheAddCommand(
+    __in PYORI_STRING SearchFor,
+    __in PYORI_STRING FoundPath,
+    __in BOOLEAN ExactMatch
+    )
+{
+    PYORI_SH_PATH_CACHE_COMMAND Command;
+    PYORI_HASH_ENTRY HashEntry;
+    YORI_STRING Key;
+
+    HashEntry = YoriLibHashLookupByKey(YoriShPathCache.Commands, SearchFor);
+    if (HashEntry != NULL) {
+        return;
+    }
+
+    Command = YoriLibMalloc(sizeof(YORI_SH_PATH_CACHE_COMMAND));
+    if (Command == NULL) {
+        return;
+    }
+
+    ZeroMemory(Command, sizeof(YORI_SH_PATH_CACHE_COMMAND));
+    Command->ExactMatch = ExactMatch;
+
+    if (!YoriLibCopyString(&Command->FoundPath, FoundPath)) {
+        YoriLibFree(Command);
+        return;
+    }
+
+    //
+    //  Copy the command so the hash package has an allocation that won't
+    //  go away
+    //
+
+    if (!YoriLibCopyString(&Key, SearchFor)) {
+        YoriLibFreeStringContents(&Command->FoundPath);
+        YoriLibFree(Command);
+        return;
+    }
+
+    YoriLibHashInsertByKey(YoriShPathCache.Commands, &Key, Command, &Command->HashEntry);
+    YoriLibAppendList(&YoriShPathCache.CommandList, &Command->ListEntry);
+    YoriLibFreeStringContents(&Key);
+}
+
+/**
+ Invoke a callback for every executable in the current directory and in
+ the path which starts with a specified prefix.  This is used for tab
+ completion.
+
+ @param SearchFor Pointer to the prefix to search for, followed by a
+        trailing wildcard.
+
+ @param MatchAllCallback The callback to invoke for each match.
+
+ @param MatchAllContext Context to pass to MatchAllCallback .
+
+ @return TRUE to indicate success, FALSE to indicate failure or that the
+         callback requested enumeration to stop.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheEnumerateMatches(
+    __in PYORI_STRING SearchFor,
+    __in PYORI_LIB_PATH_MATCH_FN MatchAllCallback,
+    __in_opt PVOID MatchAllContext
+    )
+{
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_LIST_ENTRY FileEntry;
+    PYORI_SH_PATH_CACHE_DIRECTORY Directory;
+    PYORI_SH_PATH_CACHE_FILE File;
+    YORI_STRING Prefix;
+    YORI_STRING FoundPath;
+
+    if (!YoriShPathCacheSearchCurrentDirectory(SearchFor, FALSE, MatchAllCallback, MatchAllContext, &FoundPath)) {
+        return FALSE;
+    }
+
+    YoriLibInitEmptyString(&Prefix);
+    Prefix.StartOfString = SearchFor->StartOfString;
+    Prefix.LengthInChars = SearchFor->LengthInChars - 1;
+
+    ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, NULL);
+    while (ListEntry != NULL) {
+        Directory = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_DIRECTORY, ListEntry);
+        if (Directory->Files == NULL &&
+            !YoriShPathCacheEnumerateDirectory(Directory)) {
+
+            return FALSE;
+        }
+
+        FileEntry = YoriLibGetNextListEntry(&Directory->FileList, NULL);
+        while (FileEntry != NULL) {
+            File = CONTAINING_RECORD(FileEntry, YORI_SH_PATH_CACHE_FILE, ListEntry);
+            if (YoriLibCompareStringInsCnt(&Prefix, &File->HashEntry.Key, Prefix.LengthInChars) == 0) {
+                if (!YoriShPathCacheBuildFullName(Directory, File, &FoundPath)) {
+                    return FALSE;
+                }
+                if (!MatchAllCallback(&FoundPath, MatchAllContext)) {
+                    YoriLibFreeStringContents(&FoundPath);
+                    return FALSE;
+                }
+                YoriLibFreeStringContents(&FoundPath);
+            }
+            FileEntry = YoriLibGetNextListEntry(&Directory->FileList, FileEntry);
+        }
+
+        ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.DirectoryList, ListEntry);
+    }
+
+    return TRUE;
+}
+
+/**
+ Determine whether a search can be answered from the cache.  The cache only
+ describes directories in the path, so names containing a path are not
+ cached.  Names with an extension are only cached if the extension is in
+ PATHEXT, since only those files are recorded.  Wildcards are only supported
+ as a trailing wildcard when enumerating all matches, which is the form used
+ by tab completion.
+
+ @param SearchFor Pointer to the name to search for.
+
+ @param MatchAll TRUE if the caller is enumerating all matches, FALSE if it
+        is looking for the first match.
+
+ @param HasExtension On successful completion, set to TRUE if the name
+        contains an extension.
+
+ @return TRUE if the search can be answered from the cache, FALSE if not.
+ */
+__success(return)
+BOOLEAN
+YoriShPathCacheIsCacheableSearch(
+    __in PYORI_STRING SearchFor,
+    __in BOOLEAN MatchAll,
+    __out PBOOLEAN HasExtension
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    TCHAR Char;
+
+    *HasExtension = FALSE;
+
+    if (SearchFor->LengthInChars == 0) {
+        return FALSE;
+    }
+
+    for (Index = 0; Index < SearchFor->LengthInChars; Index++) {
+        Char = SearchFor->StartOfString[Index];
+        if (YoriLibIsSep(Char) || Char == ':' || Char == '?') {
+            return FALSE;
+        }
+
+        //
+        //  Enumeration returns long file names.  If the name might be a
+        //  short name, let the file system resolve it.
+        //
+
+        if (Char == '~') {
+            return FALSE;
+        }
+
+        if (Char == '.') {
+            *HasExtension = TRUE;
+        }
+
+        if (Char == '*' && (!MatchAll || Index + 1 != SearchFor->LengthInChars)) {
+            return FALSE;
+        }
+    }
+
+    if (MatchAll) {
+        if (*HasExtension || SearchFor->StartOfString[SearchFor->LengthInChars - 1] != '*') {
+            return FALSE;
+        }
+    } else if (*HasExtension && !YoriShPathCacheIsExecutableName(SearchFor)) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Search for an executable in the current directory and the path, using and
+ updating the cache where possible.  This follows the same search order as
+ @ref YoriLibLocateExecutableInPath and falls back to it for any search the
+ cache cannot answer.
+
+ @param SearchFor The file name to search for.
+
+ @param MatchAllCallback An optional callback to invoke each time a
+        candidate match is found.
+
+ @param MatchAllContext Context information to supply to MatchAllCallback
+        if it is specified.
+
+ @param PathName On successful completion, updated to point to a newly
+        allocated string containing the first match, or an empty string if
+        no match was found.
+
+ @return TRUE to indicate the search was performed, FALSE to indicate
+         failure.
+ */
+__success(return)
+BOOLEAN
+YoriShLocateExecutableInPath(
+    __in PYORI_STRING SearchFor,
+    __in_opt PYORI_LIB_PATH_MATCH_FN MatchAllCallback,
+    __in_opt PVOID MatchAllContext,
+    __out _When_(MatchAllCallback != NULL, _Post_invalid_) PYORI_STRING PathName
+    )
+{
+    PYORI_SH_PATH_CACHE_COMMAND Command;
+    PYORI_HASH_ENTRY HashEntry;
+    BOOLEAN HasExtension;
+
+    if (!YoriShPathCacheRefresh() ||
+        !YoriShPathCacheIsCacheableSearch(SearchFor, (BOOLEAN)(MatchAllCallback != NULL), &HasExtension)) {
+
+        return YoriLibLocateExecutableInPath(SearchFor, MatchAllCallback, MatchAllContext, PathName);
+    }
+
+    YoriLibInitEmptyString(PathName);
+
+    if (MatchAllCallback != NULL) {
+        return YoriShPathCacheEnumerateMatches(SearchFor, MatchAllCallback, MatchAllContext);
+    }
+
+    Command = NULL;
+    HashEntry = YoriLibHashLookupByKey(YoriShPathCache.Commands, SearchFor);
+    if (HashEntry != NULL) {
+        Command = HashEntry->Context;
+    }
+
+    //
+    //  If an extension is specified, the name exactly as specified is
+    //  searched for in the current directory and every directory in the
+    //  path before trying to append extensions.
+    //
+
+    if (HasExtension) {
+        if (!YoriShPathCacheSearchCurrentDirectory(SearchFor, TRUE, NULL, NULL, PathName)) {
+            return FALSE;
+        }
+
+        if (PathName->LengthInChars > 0) {
+            return TRUE;
+        }
+
+        if (Command != NULL && Command->ExactMatch) {
+            return YoriLibCopyString(PathName, &Command->FoundPath);
+        }
+
+        if (Command == NULL) {
+            if (!YoriShPathCacheSearchDirectories(SearchFor, TRUE, PathName)) {
+                return YoriLibLocateExecutableInPath(SearchFor, NULL, NULL, PathName);
+            }
+
+            if (PathName->LengthInChars > 0) {
+                YoriShPathCacheAddCommand(SearchFor, PathName, TRUE);
+                return TRUE;
+            }
+        }
+    }
+
+    if (!YoriShPathCacheSearchCurrentDirectory(SearchFor, FALSE, NULL, NULL, PathName)) {
+        return FALSE;
+    }
+
+    if (PathName->LengthInChars > 0) {
+        return TRUE;
+    }
+
+    if (Command != NULL) {
+        return YoriLibCopyString(PathName, &Command->FoundPath);
+    }
+
+    if (!YoriShPathCacheSearchDirectories(SearchFor, FALSE, PathName)) {
+        return YoriLibLocateExecutableInPath(SearchFor, NULL, NULL, PathName);
+    }
+
+    if (PathName->LengthInChars > 0) {
+        YoriShPathCacheAddCommand(SearchFor, PathName, FALSE);
+    }
+
+    return TRUE;
+}
+
+/**
+ Build the set of commands that have been resolved to an executable in the
+ path into an array of NULL terminated strings in the form command=path,
+ terminated by an additional NULL terminator.  The result must be freed with
+ a subsequent call to @ref YoriLibFreeStringContents .
+
+ @param CommandStrings On successful completion, populated with the set of
+        command strings.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOL
+YoriShGetPathCacheStrings(
+    __inout PYORI_STRING CommandStrings
+    )
+{
+    YORI_ALLOC_SIZE_T CharsNeeded;
+    YORI_ALLOC_SIZE_T StringOffset;
+    PYORI_LIST_ENTRY ListEntry;
+    PYORI_SH_PATH_CACHE_COMMAND Command;
+    BOOLEAN Usable;
+
+    //
+    //  Discard anything that is no longer valid, so that only commands
+    //  that would be used are displayed.
+    //
+
+    Usable = YoriShPathCacheRefresh();
+
+    CharsNeeded = 1;
+    if (Usable) {
+        ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.CommandList, NULL);
+        while (ListEntry != NULL) {
+            Command = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_COMMAND, ListEntry);
+            CharsNeeded = CharsNeeded + Command->HashEntry.Key.LengthInChars + Command->FoundPath.LengthInChars + 2;
+            ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.CommandList, ListEntry);
+        }
+    }
+
+    if (CommandStrings->LengthAllocated < CharsNeeded) {
+        YoriLibFreeStringContents(CommandStrings);
+        if (!YoriLibAllocateString(CommandStrings, CharsNeeded)) {
+            return FALSE;
+        }
+    }
+
+    StringOffset = 0;
+    if (Usable) {
+        ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.CommandList, NULL);
+        while (ListEntry != NULL) {
+            Command = CONTAINING_RECORD(ListEntry, YORI_SH_PATH_CACHE_COMMAND, ListEntry);
+            YoriLibSPrintf(&CommandStrings->StartOfString[StringOffset], _T("%y=%y"), &Command->HashEntry.Key, &Command->FoundPath);
+            StringOffset = StringOffset + Command->HashEntry.Key.LengthInChars + Command->FoundPath.LengthInChars + 2;
+            ListEntry = YoriLibGetNextListEntry(&YoriShPathCache.CommandList, ListEntry);
+        }
+    }
+    CommandStrings->StartOfString[StringOffset] = '\0';
+
+    return TRUE;
+}
+
+// vim:sw=4:ts=4:et:
@@ -361,6 +361,11 @@ YORI_CMD_BUILTIN YoriCmd_OSVER;
  */
 YORI_CMD_BUILTIN YoriCmd_YPATH;
 
+/**
+ Declaration for the builtin command.
+ */
+YORI_CMD_BUILTIN YoriCmd_PATHCACHE;
+
 /**
  Declaration for the builtin command.
  */
@@ -610,6 +615,7 @@ YoriShBuiltins[] = {
                     {_T("LINES"),     YoriCmd_LINES},
                     {_T("NICE"),      YoriCmd_NICE},
                     {_T("OSVER"),     YoriCmd_OSVER},
+                    {_T("PATHCACHE"), YoriCmd_PATHCACHE},
                     {_T("PETOOL"),    YoriCmd_PETOOL},
                     {_T("PROCINFO"),  YoriCmd_PROCINFO},
                     {_T("PUSHD"),     YoriCmd_PUSHD},
@@ -137,6 +137,24 @@ YoriShExecuteBuiltinString(
     __in PYORI_STRING Expression
     );
 
+// *** COMPCACHE.C ***
+
+__success(return)
+BOOLEAN
+YoriShCompletionCacheForEachFile(
+    __in PYORI_STRING SearchString,
+    __in WORD MatchFlags,
+    __in PYORILIB_FILE_ENUM_FN Callback,
+    __in PVOID Context,
+    __in BOOLEAN WarmOnly
+    );
+
+HANDLE
+YoriShGetCompletionCacheEvent(VOID);
+
+VOID
+YoriShCleanupCompletionCache(VOID);
+
 // *** COMPLETE.C ***
 
 VOID
@@ -311,10 +329,23 @@ __success(return)
 BOOL
 YoriShLoadHistoryFromFile(VOID);
 
+__success(return)
+BOOL
+YoriShAppendToHistoryFile(
+    __in PYORI_STRING NewCmd
+    );
+
 __success(return)
 BOOL
 YoriShSaveHistoryToFile(VOID);
 
+PYORI_SH_HISTORY_ENTRY
+YoriShFindPreviousHistoryMatch(
+    __in PYORI_STRING SearchString,
+    __in BOOLEAN PrefixOnly,
+    __in_opt PYORI_SH_HISTORY_ENTRY PreviousMatch
+    );
+
 __success(return)
 BOOL
 YoriShGetHistoryStrings(
@@ -431,6 +462,26 @@ YoriShResolveCommandToExecutable(
     __out PBOOLEAN ExecutableFound
     );
 
+// *** PATHCACHE.C ***
+
+VOID
+YoriShClearPathCache(VOID);
+
+__success(return)
+BOOL
+YoriShGetPathCacheStrings(
+    __inout PYORI_STRING CommandStrings
+    );
+
+__success(return)
+BOOLEAN
+YoriShLocateExecutableInPath(
+    __in PYORI_STRING SearchFor,
+    __in_opt PYORI_LIB_PATH_MATCH_FN MatchAllCallback,
+    __in_opt PVOID MatchAllContext,
+    __out _When_(MatchAllCallback != NULL, _Post_invalid_) PYORI_STRING PathName
+    );
+
 // *** PROMPT.C ***
 BOOL
 YoriShDisplayPrompt(VOID);
@@ -34,6 +34,17 @@ typedef struct _YORI_SH_HISTORY_ENTRY {
      */
     YORI_LIST_ENTRY ListEntry;
 
+    /**
+     The entry for this command in the hash table of commands, used to find
+     an earlier instance of the same command.
+     */
+    YORI_HASH_ENTRY HashEntry;
+
+    /**
+     The slot of this entry within the history search index.
+     */
+    YORI_ALLOC_SIZE_T IndexSlot;
+
     /**
      The command that was executed by the user.
      */
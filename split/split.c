@@ -56,6 +56,104 @@ SplitHelp(VOID)
     return TRUE;
 }
 
+/**
+ The preferred size of each buffer used to move data between a reader and a
+ writer.
+ */
+#define SPLIT_BUFFER_SIZE (1024 * 1024)
+
+/**
+ The number of buffers that can be in flight between a reader and a writer.
+ This bounds the amount of memory used regardless of the size of each part.
+ */
+#define SPLIT_BUFFER_COUNT 4
+
+/**
+ The maximum number of parts to write concurrently when the source can be
+ read at arbitrary offsets.
+ */
+#define SPLIT_MAX_PART_WRITERS 4
+
+/**
+ A single buffer that is passed from a reader to a writer.
+ */
+typedef struct _SPLIT_PIPELINE_BUFFER {
+
+    /**
+     Pointer to the data in the buffer.
+     */
+    PUCHAR Data;
+
+    /**
+     The number of bytes of valid data in the buffer.
+     */
+    DWORD BytesValid;
+
+    /**
+     TRUE if this buffer contains the first data of a new part, so the writer
+     should open a new part before writing it.
+     */
+    BOOLEAN NewPart;
+
+    /**
+     TRUE if the reader has no more data to supply.  This buffer contains no
+     data.
+     */
+    BOOLEAN EndOfData;
+
+} SPLIT_PIPELINE_BUFFER, *PSPLIT_PIPELINE_BUFFER;
+
+/**
+ A fixed ring of buffers used to allow a reader and a writer on different
+ threads to operate concurrently.
+ */
+typedef struct _SPLIT_PIPELINE {
+
+    /**
+     A single allocation containing the data for every buffer.
+     */
+    PUCHAR Allocation;
+
+    /**
+     The number of bytes in each buffer.
+     */
+    DWORD BufferSize;
+
+    /**
+     The index of the next buffer for the reader to populate.  Only used by
+     the reader.
+     */
+    DWORD ReaderIndex;
+
+    /**
+     The index of the next buffer for the writer to consume.  Only used by
+     the writer.
+     */
+    DWORD WriterIndex;
+
+    /**
+     A semaphore counting the number of buffers available to the reader.
+     */
+    HANDLE EmptySemaphore;
+
+    /**
+     A semaphore counting the number of buffers available to the writer.
+     */
+    HANDLE FullSemaphore;
+
+    /**
+     Set to TRUE by either side when an error occurs.  The reader stops
+     reading, and the writer discards any remaining buffers.
+     */
+    LONG volatile Failed;
+
+    /**
+     The ring of buffers.
+     */
+    SPLIT_PIPELINE_BUFFER Buffers[SPLIT_BUFFER_COUNT];
+
+} SPLIT_PIPELINE, *PSPLIT_PIPELINE;
+
 /**
  Context passed to the callback which is invoked for each file found.
  */
@@ -89,40 +187,234 @@ typedef struct _SPLIT_CONTEXT {
      */
     YORI_STRING Prefix;
 
+    /**
+     When writing parts concurrently, the full path to the source file.  Each
+     writer opens its own handle so that reads at different offsets don't
+     contend for a single file position.
+     */
+    PYORI_STRING SourcePath;
+
+    /**
+     When writing parts concurrently, the length of the source file in bytes.
+     */
+    DWORDLONG SourceLength;
+
+    /**
+     When writing parts concurrently, the index of the next part for a writer
+     to claim, relative to CurrentPartNumber.
+     */
+    LONG volatile NextPartIndex;
+
+    /**
+     When writing parts concurrently, set to TRUE if any writer fails, so
+     that other writers stop.
+     */
+    LONG volatile Failed;
+
+    /**
+     When writing parts from a stream, the ring of buffers between the
+     thread reading the stream and the thread writing parts.
+     */
+    PSPLIT_PIPELINE Pipeline;
+
 } SPLIT_CONTEXT, *PSPLIT_CONTEXT;
 
 /**
- Open a file in which to output the result of a fragment of the split
- operation.
+ Prepare a ring of buffers to pass data between a reader and a writer.
 
- @param SplitContext Pointer to a context describing the split operation
-        and its current state.
+ @param Pipeline Pointer to the pipeline to initialize.
 
- @return Handle to the opened object, or NULL on failure.
+ @return TRUE to indicate success, FALSE to indicate failure.
  */
-HANDLE
-SplitOpenTargetForCurrentPart(
-    __in PSPLIT_CONTEXT SplitContext
+__success(return)
+BOOLEAN
+SplitPipelineInitialize(
+    __out PSPLIT_PIPELINE Pipeline
+    )
+{
+    YORI_ALLOC_SIZE_T BytesAllocated;
+    DWORD Index;
+
+    ZeroMemory(Pipeline, (DWORD)sizeof(SPLIT_PIPELINE));
+
+    BytesAllocated = YoriLibMaximumAllocationInRange(SPLIT_BUFFER_COUNT * 64 * 1024, SPLIT_BUFFER_COUNT * SPLIT_BUFFER_SIZE);
+    if (BytesAllocated == 0) {
+        return FALSE;
+    }
+
+    Pipeline->Allocation = YoriLibMalloc(BytesAllocated);
+    if (Pipeline->Allocation == NULL) {
+        return FALSE;
+    }
+
+    Pipeline->BufferSize = BytesAllocated / SPLIT_BUFFER_COUNT;
+    for (Index = 0; Index < SPLIT_BUFFER_COUNT; Index++) {
+        Pipeline->Buffers[Index].Data = &Pipeline->Allocation[Index * Pipeline->BufferSize];
+    }
+
+    Pipeline->EmptySemaphore = CreateSemaphore(NULL, SPLIT_BUFFER_COUNT, SPLIT_BUFFER_COUNT, NULL);
+    Pipeline->FullSemaphore = CreateSemaphore(NULL, 0, SPLIT_BUFFER_COUNT, NULL);
+    if (Pipeline->EmptySemaphore == NULL || Pipeline->FullSemaphore == NULL) {
+        if (Pipeline->EmptySemaphore != NULL) {
+            CloseHandle(Pipeline->EmptySemaphore);
+        }
+        if (Pipeline->FullSemaphore != NULL) {
+            CloseHandle(Pipeline->FullSemaphore);
+        }
+        YoriLibFree(Pipeline->Allocation);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ Free the resources used by a pipeline.  Neither the reader nor the writer
+ can be using it.
+
+ @param Pipeline Pointer to the pipeline to clean up.
+ */
+VOID
+SplitPipelineCleanup(
+    __in PSPLIT_PIPELINE Pipeline
+    )
+{
+    CloseHandle(Pipeline->EmptySemaphore);
+    CloseHandle(Pipeline->FullSemaphore);
+    YoriLibFree(Pipeline->Allocation);
+}
+
+/**
+ Wait for a buffer to be available for the reader to populate.  If the
+ pipeline has failed, the reader should mark the buffer as EndOfData and
+ queue it.
+
+ @param Pipeline Pointer to the pipeline.
+
+ @return Pointer to the buffer to populate.
+ */
+PSPLIT_PIPELINE_BUFFER
+SplitPipelineGetEmptyBuffer(
+    __in PSPLIT_PIPELINE Pipeline
+    )
+{
+    PSPLIT_PIPELINE_BUFFER Buffer;
+
+    WaitForSingleObject(Pipeline->EmptySemaphore, INFINITE);
+    Buffer = &Pipeline->Buffers[Pipeline->ReaderIndex];
+    Pipeline->ReaderIndex = (Pipeline->ReaderIndex + 1) % SPLIT_BUFFER_COUNT;
+    Buffer->BytesValid = 0;
+    Buffer->NewPart = FALSE;
+    Buffer->EndOfData = FALSE;
+    return Buffer;
+}
+
+/**
+ Indicate that the most recently returned empty buffer has been populated
+ and is ready for the writer.
+
+ @param Pipeline Pointer to the pipeline.
+ */
+VOID
+SplitPipelineQueueBuffer(
+    __in PSPLIT_PIPELINE Pipeline
+    )
+{
+    ReleaseSemaphore(Pipeline->FullSemaphore, 1, NULL);
+}
+
+/**
+ Wait for a buffer to be available for the writer to consume.
+
+ @param Pipeline Pointer to the pipeline.
+
+ @return Pointer to the buffer to consume.
+ */
+PSPLIT_PIPELINE_BUFFER
+SplitPipelineGetFullBuffer(
+    __in PSPLIT_PIPELINE Pipeline
+    )
+{
+    WaitForSingleObject(Pipeline->FullSemaphore, INFINITE);
+    return &Pipeline->Buffers[Pipeline->WriterIndex];
+}
+
+/**
+ Indicate that the most recently returned full buffer has been consumed and
+ can be reused by the reader.
+
+ @param Pipeline Pointer to the pipeline.
+ */
+VOID
+SplitPipelineReleaseBuffer(
+    __in PSPLIT_PIPELINE Pipeline
+    )
+{
+    Pipeline->WriterIndex = (Pipeline->WriterIndex + 1) % SPLIT_BUFFER_COUNT;
+    ReleaseSemaphore(Pipeline->EmptySemaphore, 1, NULL);
+}
+
+/**
+ Generate the name of a fragment of a split operation.
+
+ @param Prefix Pointer to the prefix of fragment names.
+
+ @param PartNumber The number of the fragment.
+
+ @return Pointer to a newly allocated NULL terminated file name, which the
+         caller should free with YoriLibFree, or NULL on failure.
+ */
+LPTSTR
+SplitGetPartFileName(
+    __in PYORI_STRING Prefix,
+    __in YORI_MAX_SIGNED_T PartNumber
     )
 {
     LPTSTR NewFileName;
     YORI_STRING NumberString;
-    HANDLE hDestFile;
 
     YoriLibInitEmptyString(&NumberString);
-    if (!YoriLibNumberToString(&NumberString, SplitContext->CurrentPartNumber, 10, 0, '\0')) {
+    if (!YoriLibNumberToString(&NumberString, PartNumber, 10, 0, '\0')) {
         return NULL;
     }
 
-    NewFileName = YoriLibMalloc((SplitContext->Prefix.LengthInChars + NumberString.LengthInChars + 1) * sizeof(TCHAR));
+    NewFileName = YoriLibMalloc((Prefix->LengthInChars + NumberString.LengthInChars + 1) * sizeof(TCHAR));
     if (NewFileName == NULL) {
         YoriLibFreeStringContents(&NumberString);
         return NULL;
     }
 
-    YoriLibSPrintf(NewFileName, _T("%y%y"), &SplitContext->Prefix, &NumberString);
+    YoriLibSPrintf(NewFileName, _T("%y%y"), Prefix, &NumberString);
     YoriLibFreeStringContents(&NumberString);
 
+    return NewFileName;
+}
+
+/**
+ Open a file in which to output the result of a fragment of the split
+ operation.
+
+ @param SplitContext Pointer to a context describing the split operation
+        and its current state.
+
+ @param PartNumber The number of the fragment to open.
+
+ @return Handle to the opened object, or NULL on failure.
+ */
+HANDLE
+SplitOpenTargetForPart(
+    __in PSPLIT_CONTEXT SplitContext,
+    __in YORI_MAX_SIGNED_T PartNumber
+    )
+{
+    LPTSTR NewFileName;
+    HANDLE hDestFile;
+
+    NewFileName = SplitGetPartFileName(&SplitContext->Prefix, PartNumber);
+    if (NewFileName == NULL) {
+        return NULL;
+    }
+
     hDestFile = CreateFile(NewFileName,
                            GENERIC_WRITE,
                            FILE_SHARE_READ|FILE_SHARE_DELETE,
@@ -143,12 +435,433 @@ SplitOpenTargetForCurrentPart(
     return hDestFile;
 }
 
+/**
+ Write a buffer to a part file, displaying any error.
+
+ @param hDestFile Handle to the part file.
+
+ @param Buffer Pointer to the data to write.
+
+ @param Length The number of bytes to write.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+SplitWritePartData(
+    __in HANDLE hDestFile,
+    __in PUCHAR Buffer,
+    __in DWORD Length
+    )
+{
+    DWORD BytesWritten;
+
+    if (!WriteFile(hDestFile, Buffer, Length, &BytesWritten, NULL)) {
+        SYSERR LastError = GetLastError();
+        LPTSTR ErrText = YoriLibGetWinErrorText(LastError);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: write failed: %s"), ErrText);
+        YoriLibFreeWinErrorText(ErrText);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ A thread which writes parts from buffers populated by a thread reading the
+ source stream.
+
+ @param Context Pointer to the split context.
+
+ @return Zero.
+ */
+DWORD WINAPI
+SplitStreamPartWriterThread(
+    __in LPVOID Context
+    )
+{
+    PSPLIT_CONTEXT SplitContext;
+    PSPLIT_PIPELINE Pipeline;
+    PSPLIT_PIPELINE_BUFFER Buffer;
+    HANDLE hDestFile;
+
+    SplitContext = (PSPLIT_CONTEXT)Context;
+    Pipeline = SplitContext->Pipeline;
+    hDestFile = NULL;
+
+    while (TRUE) {
+        Buffer = SplitPipelineGetFullBuffer(Pipeline);
+        if (Buffer->EndOfData) {
+            break;
+        }
+
+        //
+        //  After a failure, keep consuming buffers so the reader can make
+        //  progress until it notices.
+        //
+
+        if (!Pipeline->Failed) {
+            if (Buffer->NewPart) {
+                if (hDestFile != NULL) {
+                    CloseHandle(hDestFile);
+                }
+                hDestFile = SplitOpenTargetForPart(SplitContext, SplitContext->CurrentPartNumber);
+                if (hDestFile == NULL) {
+                    InterlockedExchange(&Pipeline->Failed, TRUE);
+                } else {
+                    SplitContext->CurrentPartNumber++;
+                }
+            }
+
+            if (hDestFile != NULL &&
+                !SplitWritePartData(hDestFile, Buffer->Data, Buffer->BytesValid)) {
+
+                InterlockedExchange(&Pipeline->Failed, TRUE);
+            }
+        }
+
+        SplitPipelineReleaseBuffer(Pipeline);
+    }
+
+    if (hDestFile != NULL) {
+        CloseHandle(hDestFile);
+    }
+
+    return 0;
+}
+
+/**
+ Break an incoming stream into parts by a number of bytes.  The stream is
+ read on this thread into a fixed ring of buffers, and parts are written on
+ another thread, so memory use does not depend on the size of each part.
+
+ @param hSource A handle to the incoming stream.
+
+ @param SplitContext Pointer to a context describing the actions to perform.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+SplitStreamByBytes(
+    __in HANDLE hSource,
+    __in PSPLIT_CONTEXT SplitContext
+    )
+{
+    SPLIT_PIPELINE Pipeline;
+    PSPLIT_PIPELINE_BUFFER Buffer;
+    HANDLE WriterThread;
+    DWORD ThreadId;
+    DWORD BytesToRead;
+    DWORD BytesRead;
+    YORI_MAX_SIGNED_T PartRemaining;
+    BOOLEAN StartNewPart;
+
+    if (!SplitPipelineInitialize(&Pipeline)) {
+        return FALSE;
+    }
+
+    SplitContext->Pipeline = &Pipeline;
+    WriterThread = CreateThread(NULL, 0, SplitStreamPartWriterThread, SplitContext, 0, &ThreadId);
+    if (WriterThread == NULL) {
+        SplitContext->Pipeline = NULL;
+        SplitPipelineCleanup(&Pipeline);
+        return FALSE;
+    }
+
+    PartRemaining = 0;
+    StartNewPart = FALSE;
+
+    while (TRUE) {
+        Buffer = SplitPipelineGetEmptyBuffer(&Pipeline);
+        if (Pipeline.Failed) {
+            Buffer->EndOfData = TRUE;
+            SplitPipelineQueueBuffer(&Pipeline);
+            break;
+        }
+
+        if (PartRemaining == 0) {
+            PartRemaining = SplitContext->BytesPerPart;
+            StartNewPart = TRUE;
+        }
+
+        BytesToRead = Pipeline.BufferSize;
+        if ((YORI_MAX_SIGNED_T)BytesToRead > PartRemaining) {
+            BytesToRead = (DWORD)PartRemaining;
+        }
+
+        if (!ReadFile(hSource, Buffer->Data, BytesToRead, &BytesRead, NULL) ||
+            BytesRead == 0) {
+
+            Buffer->EndOfData = TRUE;
+            SplitPipelineQueueBuffer(&Pipeline);
+            break;
+        }
+
+        Buffer->BytesValid = BytesRead;
+        Buffer->NewPart = StartNewPart;
+        StartNewPart = FALSE;
+        PartRemaining = PartRemaining - BytesRead;
+        SplitPipelineQueueBuffer(&Pipeline);
+    }
+
+    WaitForSingleObject(WriterThread, INFINITE);
+    CloseHandle(WriterThread);
+    SplitContext->Pipeline = NULL;
+
+    if (Pipeline.Failed) {
+        SplitPipelineCleanup(&Pipeline);
+        return FALSE;
+    }
+
+    SplitPipelineCleanup(&Pipeline);
+    return TRUE;
+}
+
+/**
+ A thread which claims parts of a source file and writes each one, reading
+ the source at the offset of the part.
+
+ @param Context Pointer to the split context.
+
+ @return Zero.
+ */
+DWORD WINAPI
+SplitParallelPartWriterThread(
+    __in LPVOID Context
+    )
+{
+    PSPLIT_CONTEXT SplitContext;
+    HANDLE hSource;
+    HANDLE hDestFile;
+    PUCHAR Buffer;
+    DWORD BufferSize;
+    DWORD BytesToRead;
+    DWORD BytesRead;
+    LONG PartIndex;
+    LONG OffsetHigh;
+    DWORDLONG PartOffset;
+    DWORDLONG PartRemaining;
+    SYSERR LastError;
+    LPTSTR ErrText;
+
+    SplitContext = (PSPLIT_CONTEXT)Context;
+
+    hSource = CreateFile(SplitContext->SourcePath->StartOfString,
+                         GENERIC_READ,
+                         FILE_SHARE_READ | FILE_SHARE_DELETE,
+                         NULL,
+                         OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_SEQUENTIAL_SCAN,
+                         NULL);
+
+    if (hSource == INVALID_HANDLE_VALUE) {
+        LastError = GetLastError();
+        ErrText = YoriLibGetWinErrorText(LastError);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: open of %y failed: %s"), SplitContext->SourcePath, ErrText);
+        YoriLibFreeWinErrorText(ErrText);
+        InterlockedExchange(&SplitContext->Failed, TRUE);
+        return 0;
+    }
+
+    BufferSize = YoriLibMaximumAllocationInRange(64 * 1024, SPLIT_BUFFER_SIZE);
+    Buffer = NULL;
+    if (BufferSize > 0) {
+        Buffer = YoriLibMalloc(BufferSize);
+    }
+    if (Buffer == NULL) {
+        InterlockedExchange(&SplitContext->Failed, TRUE);
+        CloseHandle(hSource);
+        return 0;
+    }
+
+    while (!SplitContext->Failed) {
+        PartIndex = InterlockedIncrement(&SplitContext->NextPartIndex) - 1;
+        PartOffset = (DWORDLONG)PartIndex * SplitContext->BytesPerPart;
+        if (PartOffset >= SplitContext->SourceLength) {
+            break;
+        }
+
+        PartRemaining = SplitContext->SourceLength - PartOffset;
+        if (PartRemaining > (DWORDLONG)SplitContext->BytesPerPart) {
+            PartRemaining = SplitContext->BytesPerPart;
+        }
+
+        OffsetHigh = (LONG)(PartOffset >> 32);
+        if (SetFilePointer(hSource, (LONG)PartOffset, &OffsetHigh, FILE_BEGIN) == INVALID_SET_FILE_POINTER &&
+            GetLastError() != NO_ERROR) {
+
+            LastError = GetLastError();
+            ErrText = YoriLibGetWinErrorText(LastError);
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: seek of %y failed: %s"), SplitContext->SourcePath, ErrText);
+            YoriLibFreeWinErrorText(ErrText);
+            InterlockedExchange(&SplitContext->Failed, TRUE);
+            break;
+        }
+
+        hDestFile = SplitOpenTargetForPart(SplitContext, SplitContext->CurrentPartNumber + PartIndex);
+        if (hDestFile == NULL) {
+            InterlockedExchange(&SplitContext->Failed, TRUE);
+            break;
+        }
+
+        while (PartRemaining > 0 && !SplitContext->Failed) {
+            BytesToRead = BufferSize;
+            if ((DWORDLONG)BytesToRead > PartRemaining) {
+                BytesToRead = (DWORD)PartRemaining;
+            }
+
+            if (!ReadFile(hSource, Buffer, BytesToRead, &BytesRead, NULL)) {
+                LastError = GetLastError();
+                ErrText = YoriLibGetWinErrorText(LastError);
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: read of %y failed: %s"), SplitContext->SourcePath, ErrText);
+                YoriLibFreeWinErrorText(ErrText);
+                InterlockedExchange(&SplitContext->Failed, TRUE);
+                break;
+            }
+
+            //
+            //  If the file became shorter while being split, the part ends
+            //  early.
+            //
+
+            if (BytesRead == 0) {
+                break;
+            }
+
+            if (!SplitWritePartData(hDestFile, Buffer, BytesRead)) {
+                InterlockedExchange(&SplitContext->Failed, TRUE);
+                break;
+            }
+
+            PartRemaining = PartRemaining - BytesRead;
+        }
+
+        CloseHandle(hDestFile);
+    }
+
+    YoriLibFree(Buffer);
+    CloseHandle(hSource);
+    return 0;
+}
+
+/**
+ Break a file into parts by a number of bytes, writing several parts
+ concurrently.  This requires the file to be on disk so that it can be read
+ from any offset.
+
+ @param hSource A handle to the source file.
+
+ @param SourcePath Pointer to the full path to the source file.
+
+ @param SplitContext Pointer to a context describing the actions to perform.
+
+ @param Handled On completion, set to TRUE if the file was processed, or
+        FALSE if it is not suitable for concurrent processing and should be
+        processed as a stream.
+
+ @return TRUE to indicate success, FALSE to indicate failure.
+ */
+__success(return)
+BOOLEAN
+SplitFileByBytesParallel(
+    __in HANDLE hSource,
+    __in PYORI_STRING SourcePath,
+    __in PSPLIT_CONTEXT SplitContext,
+    __out PBOOLEAN Handled
+    )
+{
+    SYSTEM_INFO SystemInfo;
+    HANDLE Threads[SPLIT_MAX_PART_WRITERS];
+    DWORD ThreadCount;
+    DWORD MaxThreads;
+    DWORD ThreadId;
+    DWORD Index;
+    DWORDLONG SourceLength;
+    DWORDLONG PartCount;
+
+    *Handled = FALSE;
+
+    if (GetFileType(hSource) != FILE_TYPE_DISK) {
+        return TRUE;
+    }
+
+    if (YoriLibGetFileOrDeviceSize(hSource, &SourceLength) != ERROR_SUCCESS) {
+        return TRUE;
+    }
+
+    //
+    //  A single part gains nothing from being written concurrently, and the
+    //  part index needs to fit in a LONG.
+    //
+
+    PartCount = (SourceLength + SplitContext->BytesPerPart - 1) / SplitContext->BytesPerPart;
+    if (PartCount < 2 || PartCount >= 0x7FFFFFFF) {
+        return TRUE;
+    }
+
+    GetSystemInfo(&SystemInfo);
+    MaxThreads = SystemInfo.dwNumberOfProcessors;
+    if (MaxThreads < 2) {
+        return TRUE;
+    }
+    if (MaxThreads > SPLIT_MAX_PART_WRITERS) {
+        MaxThreads = SPLIT_MAX_PART_WRITERS;
+    }
+    if ((DWORDLONG)MaxThreads > PartCount) {
+        MaxThreads = (DWORD)PartCount;
+    }
+
+    SplitContext->SourcePath = SourcePath;
+    SplitContext->SourceLength = SourceLength;
+    SplitContext->NextPartIndex = 0;
+    SplitContext->Failed = FALSE;
+
+    ThreadCount = 0;
+    while (ThreadCount < MaxThreads) {
+        Threads[ThreadCount] = CreateThread(NULL, 0, SplitParallelPartWriterThread, SplitContext, 0, &ThreadId);
+        if (Threads[ThreadCount] == NULL) {
+            break;
+        }
+        ThreadCount++;
+    }
+
+    //
+    //  If no threads could be created, no parts have been claimed, so the
+    //  file can still be processed as a stream.
+    //
+
+    if (ThreadCount == 0) {
+        SplitContext->SourcePath = NULL;
+        return TRUE;
+    }
+
+    *Handled = TRUE;
+    WaitForMultipleObjects(ThreadCount, Threads, TRUE, INFINITE);
+    for (Index = 0; Index < ThreadCount; Index++) {
+        CloseHandle(Threads[Index]);
+    }
+
+    SplitContext->SourcePath = NULL;
+    SplitContext->CurrentPartNumber = SplitContext->CurrentPartNumber + (YORI_MAX_SIGNED_T)PartCount;
+
+    if (SplitContext->Failed) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 /**
  Take a single incoming stream and break it into pieces.
 
  @param hSource A handle to the incoming stream, which may be a file or a
         pipe.
- 
+
+ @param SourcePath Optionally points to the full path to the incoming
+        stream.  If present and the stream is a file on disk, parts may be
+        written concurrently.
+
  @param SplitContext Pointer to a context describing the actions to perform.
 
  @return TRUE to indicate success, FALSE to indicate failure.
@@ -156,6 +869,7 @@ SplitOpenTargetForCurrentPart(
 BOOL
 SplitProcessStream(
     __in HANDLE hSource,
+    __in_opt PYORI_STRING SourcePath,
     __in PSPLIT_CONTEXT SplitContext
     )
 {
@@ -181,7 +895,7 @@ SplitProcessStream(
             }
 
             if (hDestFile == NULL) {
-                hDestFile = SplitOpenTargetForCurrentPart(SplitContext);
+                hDestFile = SplitOpenTargetForPart(SplitContext, SplitContext->CurrentPartNumber);
                 if (hDestFile == NULL) {
                     YoriLibLineReadCloseOrCache(LineContext);
                     YoriLibFreeStringContents(&LineString);
@@ -197,47 +911,152 @@ SplitProcessStream(
         YoriLibLineReadCloseOrCache(LineContext);
         YoriLibFreeStringContents(&LineString);
     } else {
-        PVOID Buffer;
-        ULONG BytesRead;
+        BOOLEAN Handled;
+
+        if (SourcePath != NULL) {
+            if (!SplitFileByBytesParallel(hSource, SourcePath, SplitContext, &Handled)) {
+                return FALSE;
+            }
+
+            if (Handled) {
+                return TRUE;
+            }
+        }
 
-        Buffer = YoriLibMalloc((YORI_ALLOC_SIZE_T)SplitContext->BytesPerPart);
-        if (Buffer == NULL) {
+        if (!SplitStreamByBytes(hSource, SplitContext)) {
             return FALSE;
         }
+    }
 
-        while (TRUE) {
-            if (!ReadFile(hSource, Buffer, (YORI_ALLOC_SIZE_T)SplitContext->BytesPerPart, &BytesRead, NULL)) {
-                break;
-            }
+    return TRUE;
+}
 
-            if (BytesRead == 0) {
+/**
+ Context for a thread reading the fragments of a join operation.
+ */
+typedef struct _SPLIT_JOIN_CONTEXT {
+
+    /**
+     Pointer to the string containing the prefix name of the set of files.
+     */
+    PYORI_STRING Prefix;
+
+    /**
+     The ring of buffers used to pass data from the reading thread to the
+     writing thread.
+     */
+    SPLIT_PIPELINE Pipeline;
+
+} SPLIT_JOIN_CONTEXT, *PSPLIT_JOIN_CONTEXT;
+
+/**
+ A thread which reads each fragment of a join operation in turn and passes
+ the data to the thread writing the combined file.  This allows the next
+ fragment to be read while the previous one is being written.
+
+ @param Context Pointer to the join context.
+
+ @return Zero.
+ */
+DWORD WINAPI
+SplitJoinReaderThread(
+    __in LPVOID Context
+    )
+{
+    PSPLIT_JOIN_CONTEXT JoinContext;
+    PSPLIT_PIPELINE Pipeline;
+    PSPLIT_PIPELINE_BUFFER Buffer;
+    HANDLE SourceHandle;
+    DWORD BytesRead;
+    YORI_MAX_SIGNED_T CurrentFragment;
+    LPTSTR FragmentFileName;
+    SYSERR LastError;
+    LPTSTR ErrText;
+
+    JoinContext = (PSPLIT_JOIN_CONTEXT)Context;
+    Pipeline = &JoinContext->Pipeline;
+    CurrentFragment = 0;
+
+    while(!Pipeline->Failed) {
+
+        FragmentFileName = SplitGetPartFileName(JoinContext->Prefix, CurrentFragment);
+        if (FragmentFileName == NULL) {
+            InterlockedExchange(&Pipeline->Failed, TRUE);
+            break;
+        }
+
+        SourceHandle = CreateFile(FragmentFileName,
+                                  GENERIC_READ,
+                                  FILE_SHARE_READ|FILE_SHARE_DELETE,
+                                  NULL,
+                                  OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_SEQUENTIAL_SCAN,
+                                  NULL);
+        if (SourceHandle == INVALID_HANDLE_VALUE) {
+            LastError = GetLastError();
+            if (LastError == ERROR_FILE_NOT_FOUND && CurrentFragment > 0) {
+                YoriLibFree(FragmentFileName);
                 break;
             }
+            ErrText = YoriLibGetWinErrorText(LastError);
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: open of %s failed: %s"), FragmentFileName, ErrText);
+            YoriLibFreeWinErrorText(ErrText);
+            YoriLibFree(FragmentFileName);
+            InterlockedExchange(&Pipeline->Failed, TRUE);
+            break;
+        }
 
-            hDestFile = SplitOpenTargetForCurrentPart(SplitContext);
-            if (hDestFile == NULL) {
-                YoriLibFree(Buffer);
-                return FALSE;
+        while(TRUE) {
+
+            Buffer = SplitPipelineGetEmptyBuffer(Pipeline);
+            if (Pipeline->Failed) {
+                Buffer->EndOfData = TRUE;
+                SplitPipelineQueueBuffer(Pipeline);
+                CloseHandle(SourceHandle);
+                YoriLibFree(FragmentFileName);
+                return 0;
             }
-            SplitContext->CurrentPartNumber++;
 
-            if (!WriteFile(hDestFile, Buffer, BytesRead, &BytesRead, NULL)) {
-                SYSERR LastError = GetLastError();
-                LPTSTR ErrText = YoriLibGetWinErrorText(LastError);
-                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: write failed: %s"), ErrText);
-                YoriLibFreeWinErrorText(ErrText);
-                CloseHandle(hDestFile);
-                YoriLibFree(Buffer);
-                return FALSE;
+            if (!ReadFile(SourceHandle, Buffer->Data, Pipeline->BufferSize, &BytesRead, NULL)) {
+                LastError = GetLastError();
+                if (LastError == ERROR_HANDLE_EOF) {
+                    BytesRead = 0;
+                } else {
+                    ErrText = YoriLibGetWinErrorText(LastError);
+                    YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: read of %s failed: %s"), FragmentFileName, ErrText);
+                    YoriLibFreeWinErrorText(ErrText);
+                    InterlockedExchange(&Pipeline->Failed, TRUE);
+                    Buffer->EndOfData = TRUE;
+                    SplitPipelineQueueBuffer(Pipeline);
+                    CloseHandle(SourceHandle);
+                    YoriLibFree(FragmentFileName);
+                    return 0;
+                }
             }
 
-            CloseHandle(hDestFile);
+            //
+            //  At the end of a fragment the buffer contains no data.  It is
+            //  still passed to the writer, which skips it, since that
+            //  returns it to the ring.
+            //
+
+            Buffer->BytesValid = BytesRead;
+            SplitPipelineQueueBuffer(Pipeline);
+
+            if (BytesRead == 0) {
+                break;
+            }
         }
 
-        YoriLibFree(Buffer);
+        CloseHandle(SourceHandle);
+        YoriLibFree(FragmentFileName);
+        CurrentFragment++;
     }
 
-    return TRUE;
+    Buffer = SplitPipelineGetEmptyBuffer(Pipeline);
+    Buffer->EndOfData = TRUE;
+    SplitPipelineQueueBuffer(Pipeline);
+    return 0;
 }
 
 /**
@@ -258,22 +1077,19 @@ SplitJoin(
     __in PYORI_STRING OutputFile
     )
 {
-    HANDLE SourceHandle;
+    SPLIT_JOIN_CONTEXT JoinContext;
+    PSPLIT_PIPELINE_BUFFER Buffer;
     HANDLE TargetHandle;
-    PUCHAR Buffer;
-    DWORD BytesRead;
-    YORI_ALLOC_SIZE_T BytesAllocated;
-    YORI_MAX_SIGNED_T CurrentFragment;
-    LPTSTR FragmentFileName;
-    YORI_STRING NumberString;
+    HANDLE ReaderThread;
+    DWORD ThreadId;
+    DWORD BytesWritten;
     SYSERR LastError;
     LPTSTR ErrText;
 
     ASSERT(YoriLibIsStringNullTerminated(OutputFile));
 
-    BytesAllocated = YoriLibMaximumAllocationInRange(60 * 1024, 256 * 1024);
-    Buffer = YoriLibMalloc(BytesAllocated);
-    if (Buffer == NULL) {
+    JoinContext.Prefix = Prefix;
+    if (!SplitPipelineInitialize(&JoinContext.Pipeline)) {
         return FALSE;
     }
 
@@ -290,95 +1106,52 @@ SplitJoin(
         ErrText = YoriLibGetWinErrorText(LastError);
         YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: open of %y failed: %s"), OutputFile, ErrText);
         YoriLibFreeWinErrorText(ErrText);
-        YoriLibFree(Buffer);
+        SplitPipelineCleanup(&JoinContext.Pipeline);
         return FALSE;
     }
 
-    CurrentFragment = 0;
+    ReaderThread = CreateThread(NULL, 0, SplitJoinReaderThread, &JoinContext, 0, &ThreadId);
+    if (ReaderThread == NULL) {
+        CloseHandle(TargetHandle);
+        SplitPipelineCleanup(&JoinContext.Pipeline);
+        return FALSE;
+    }
 
     while(TRUE) {
-
-        YoriLibInitEmptyString(&NumberString);
-        if (!YoriLibNumberToString(&NumberString, CurrentFragment, 10, 0, '\0')) {
-            CloseHandle(TargetHandle);
-            YoriLibFree(Buffer);
-            return FALSE;
+        Buffer = SplitPipelineGetFullBuffer(&JoinContext.Pipeline);
+        if (Buffer->EndOfData) {
+            break;
         }
 
-        FragmentFileName = YoriLibMalloc((Prefix->LengthInChars + NumberString.LengthInChars + 1) * sizeof(TCHAR));
-        if (FragmentFileName == NULL) {
-            YoriLibFreeStringContents(&NumberString);
-            CloseHandle(TargetHandle);
-            YoriLibFree(Buffer);
-            return FALSE;
-        }
+        //
+        //  After a failure, keep consuming buffers so the reader can make
+        //  progress until it notices.
+        //
 
-        YoriLibSPrintf(FragmentFileName, _T("%y%y"), Prefix, &NumberString);
-        YoriLibFreeStringContents(&NumberString);
+        if (!JoinContext.Pipeline.Failed &&
+            Buffer->BytesValid > 0 &&
+            !WriteFile(TargetHandle, Buffer->Data, Buffer->BytesValid, &BytesWritten, NULL)) {
 
-        SourceHandle = CreateFile(FragmentFileName,
-                                  GENERIC_READ,
-                                  FILE_SHARE_READ|FILE_SHARE_DELETE,
-                                  NULL,
-                                  OPEN_EXISTING,
-                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_BACKUP_SEMANTICS,
-                                  NULL);
-        if (SourceHandle == INVALID_HANDLE_VALUE) {
             LastError = GetLastError();
-            if (LastError == ERROR_FILE_NOT_FOUND && CurrentFragment > 0) {
-                YoriLibFree(FragmentFileName);
-                break;
-            }
             ErrText = YoriLibGetWinErrorText(LastError);
-            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: open of %s failed: %s"), FragmentFileName, ErrText);
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: write to %y failed: %s"), OutputFile, ErrText);
             YoriLibFreeWinErrorText(ErrText);
-            YoriLibFree(FragmentFileName);
-            CloseHandle(TargetHandle);
-            YoriLibFree(Buffer);
-            return FALSE;
+            InterlockedExchange(&JoinContext.Pipeline.Failed, TRUE);
         }
 
-        while(TRUE) {
-
-            if (!ReadFile(SourceHandle, Buffer, BytesAllocated, &BytesRead, NULL)) {
-                LastError = GetLastError();
-                if (LastError == ERROR_HANDLE_EOF) {
-                    break;
-                }
-                ErrText = YoriLibGetWinErrorText(LastError);
-                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: read of %s failed: %s"), FragmentFileName, ErrText);
-                YoriLibFreeWinErrorText(ErrText);
-                YoriLibFree(FragmentFileName);
-                CloseHandle(TargetHandle);
-                CloseHandle(SourceHandle);
-                YoriLibFree(Buffer);
-                return FALSE;
-            }
-
-            if (BytesRead == 0) {
-                break;
-            }
+        SplitPipelineReleaseBuffer(&JoinContext.Pipeline);
+    }
 
-            if (!WriteFile(TargetHandle, Buffer, BytesRead, &BytesRead, NULL)) {
-                LastError = GetLastError();
-                ErrText = YoriLibGetWinErrorText(LastError);
-                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: write to %y failed: %s"), OutputFile, ErrText);
-                YoriLibFreeWinErrorText(ErrText);
-                YoriLibFree(FragmentFileName);
-                CloseHandle(TargetHandle);
-                CloseHandle(SourceHandle);
-                YoriLibFree(Buffer);
-                return FALSE;
-            }
-        }
+    WaitForSingleObject(ReaderThread, INFINITE);
+    CloseHandle(ReaderThread);
+    CloseHandle(TargetHandle);
 
-        CloseHandle(SourceHandle);
-        YoriLibFree(FragmentFileName);
-        CurrentFragment++;
+    if (JoinContext.Pipeline.Failed) {
+        SplitPipelineCleanup(&JoinContext.Pipeline);
+        return FALSE;
     }
 
-    YoriLibFree(Buffer);
-    CloseHandle(TargetHandle);
+    SplitPipelineCleanup(&JoinContext.Pipeline);
     return TRUE;
 }
 
@@ -515,7 +1288,7 @@ ENTRYPOINT(
                 Result = EXIT_FAILURE;
             }
         } else {
-            if (SplitContext.BytesPerPart == 0 || SplitContext.BytesPerPart >= YORI_MAX_ALLOC_SIZE) {
+            if (SplitContext.BytesPerPart <= 0) {
                 YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("split: invalid bytes per part\n"));
                 Result = EXIT_FAILURE;
             }
@@ -544,7 +1317,7 @@ ENTRYPOINT(
             }
 
             if (Result == EXIT_SUCCESS) {
-                if (!SplitProcessStream(GetStdHandle(STD_INPUT_HANDLE), &SplitContext)) {
+                if (!SplitProcessStream(GetStdHandle(STD_INPUT_HANDLE), NULL, &SplitContext)) {
                     Result = EXIT_FAILURE;
                 }
             }
@@ -552,6 +1325,7 @@ ENTRYPOINT(
             HANDLE FileHandle;
             YORI_STRING FilePath;
 
+            YoriLibInitEmptyString(&FilePath);
             if (!YoriLibUserToSingleFilePath(&ArgV[StartArg], TRUE, &FilePath)) {
                 Result = EXIT_FAILURE;
             }
@@ -573,16 +1347,16 @@ ENTRYPOINT(
                     YoriLibFreeWinErrorText(ErrText);
                     Result = EXIT_FAILURE;
                 }
-
-                YoriLibFreeStringContents(&FilePath);
             }
 
             if (Result == EXIT_SUCCESS) {
-                if (!SplitProcessStream(FileHandle, &SplitContext)) {
+                if (!SplitProcessStream(FileHandle, &FilePath, &SplitContext)) {
                     Result = EXIT_FAILURE;
                 }
                 CloseHandle(FileHandle);
             }
+
+            YoriLibFreeStringContents(&FilePath);
         }
         YoriLibFreeStringContents(&SplitContext.Prefix);
     }
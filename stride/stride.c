@@ -127,6 +127,7 @@ StrideProcessStream(
 {
     PVOID LineContext = NULL;
     CONSOLE_SCREEN_BUFFER_INFO ScreenInfo;
+    YORI_LIB_LINE_VIEW LineView;
     YORI_STRING LineString;
     BOOL OutputIsConsole;
     DWORD dwMode;
@@ -149,15 +150,23 @@ StrideProcessStream(
 
     while (TRUE) {
 
-        if (!YoriLibReadLineToString(&LineString, &LineContext, hSource)) {
+        if (!YoriLibReadLineToView(&LineView, &LineContext, hSource)) {
             break;
         }
 
         LineRelativeToStride = (DWORD)((StrideContext->FileLinesFound - StrideContext->Offset) % StrideContext->Interval);
         StrideContext->FileLinesFound++;
 
+        //
+        //  Only lines that are being displayed need to be converted.
+        //
+
         if (LineRelativeToStride < StrideContext->LinesOnEachInterval) {
 
+            if (!YoriLibLineViewToString(&LineView, &LineString)) {
+                break;
+            }
+
             YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y"), &LineString);
             CharactersDisplayed = LineString.LengthInChars;
             if (CharactersDisplayed == 0 ||
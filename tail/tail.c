@@ -32,6 +32,20 @@
  */
 #define MAX_LINE_COUNT (1*1024*1024)
 
+/**
+ The number of bytes to read at a time when scanning backwards from the end
+ of a file for line terminators.
+ */
+#define TAIL_SCAN_CHUNK_SIZE (256*1024)
+
+/**
+ The maximum amount of time to wait for a change notification before
+ checking for more data anyway, in milliseconds.  Change notifications for
+ a file's size are not guaranteed to be generated promptly as data is
+ written, so this bounds the latency of output in that case.
+ */
+#define TAIL_CHANGE_WAIT_TIMEOUT (1000)
+
 #if defined(_MSC_VER) && _MSC_VER >= 900
 #pragma warning(disable: 4220) // Varargs matches remaining parameters
 #endif
@@ -118,6 +132,11 @@ typedef struct _TAIL_CONTEXT {
      */
     PYORI_STRING LinesArray;
 
+    /**
+     A buffer used to combine lines written to standard output.
+     */
+    YORI_LIB_OUTPUT_BUFFER OutputBuffer;
+
     /**
      If TRUE, continue outputting results as more arrive.  If FALSE, terminate
      as soon as the requested lines have been output.
@@ -136,12 +155,263 @@ typedef struct _TAIL_CONTEXT {
 
 } TAIL_CONTEXT, *PTAIL_CONTEXT;
 
+/**
+ Count the line terminators in a buffer of 8 bit characters.  A carriage
+ return followed by a line feed is a single terminator, which is counted at
+ the line feed.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param Length The number of bytes in the buffer.
+
+ @param FollowingChar The character that follows the buffer in the file, or
+        zero if the buffer ends at the end of the file.
+
+ @param StopAtCount If nonzero, stop counting when this number of terminators
+        has been found.
+
+ @param StopOffset On successful completion, if StopAtCount terminators were
+        found, updated to contain the offset following the final terminator
+        counted.
+
+ @return The number of terminators found.
+ */
+YORI_ALLOC_SIZE_T
+TailCountLineTerminators(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T Length,
+    __in UCHAR FollowingChar,
+    __in YORI_ALLOC_SIZE_T StopAtCount,
+    __out PYORI_ALLOC_SIZE_T StopOffset
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Count;
+    UCHAR NextChar;
+
+    Count = 0;
+    Index = 0;
+    *StopOffset = 0;
+    while (TRUE) {
+        Index = Index + YoriLibFindLineTerminatorA(&Buffer[Index], Length - Index);
+        if (Index >= Length) {
+            break;
+        }
+
+        if (Buffer[Index] == '\r') {
+            if (Index + 1 < Length) {
+                NextChar = Buffer[Index + 1];
+            } else {
+                NextChar = FollowingChar;
+            }
+
+            if (NextChar == '\n') {
+                Index++;
+                if (Index >= Length) {
+                    break;
+                }
+                continue;
+            }
+        }
+
+        Index++;
+        Count++;
+        if (StopAtCount != 0 && Count == StopAtCount) {
+            *StopOffset = Index;
+            break;
+        }
+    }
+
+    return Count;
+}
+
+/**
+ Scan backwards from the end of a file to find the offset of the start of
+ the final lines in the file.  The file is read in large blocks from the end
+ until enough line terminators are found, so only data near the end of the
+ file is read regardless of the length of its lines.
+
+ @param hSource Handle to the file.
+
+ @param LinesToDisplay The number of lines to find at the end of the file.
+
+ @param StartOffset On successful completion, updated to contain the offset
+        of the first line to display.  If the file has fewer lines than
+        requested, this is zero.
+
+ @return TRUE to indicate success, FALSE if the file could not be scanned,
+         in which case the caller should read the file forwards.
+ */
+__success(return)
+BOOL
+TailFindStartOfFinalLines(
+    __in HANDLE hSource,
+    __in YORI_ALLOC_SIZE_T LinesToDisplay,
+    __out PDWORDLONG StartOffset
+    )
+{
+    PUCHAR Buffer;
+    LARGE_INTEGER FileSize;
+    LARGE_INTEGER ChunkStart;
+    DWORDLONG ChunkEnd;
+    YORI_ALLOC_SIZE_T ChunkLength;
+    YORI_ALLOC_SIZE_T TerminatorsNeeded;
+    YORI_ALLOC_SIZE_T TerminatorsFound;
+    YORI_ALLOC_SIZE_T StopOffset;
+    DWORD BytesRead;
+    UCHAR FollowingChar;
+
+    //
+    //  Terminators are searched for as single bytes, which doesn't work for
+    //  UTF-16 input.
+    //
+
+    if (YoriLibGetMultibyteInputEncoding() == CP_UTF16) {
+        return FALSE;
+    }
+
+    if (YoriLibGetFileOrDeviceSize(hSource, (PDWORDLONG)&FileSize.QuadPart) != ERROR_SUCCESS) {
+        return FALSE;
+    }
+
+    if (FileSize.QuadPart == 0) {
+        *StartOffset = 0;
+        return TRUE;
+    }
+
+    Buffer = YoriLibMalloc(TAIL_SCAN_CHUNK_SIZE);
+    if (Buffer == NULL) {
+        return FALSE;
+    }
+
+    //
+    //  Start with the final chunk, which is shortened so that subsequent
+    //  chunks are aligned.  A terminator at the end of the file ends the
+    //  final line rather than starting a new one, so one more terminator is
+    //  needed in that case.
+    //
+
+    TerminatorsNeeded = LinesToDisplay;
+    ChunkEnd = FileSize.QuadPart;
+    ChunkStart.QuadPart = (ChunkEnd - 1) & ~((DWORDLONG)TAIL_SCAN_CHUNK_SIZE - 1);
+    FollowingChar = 0;
+
+    while (TRUE) {
+        ChunkLength = (YORI_ALLOC_SIZE_T)(ChunkEnd - ChunkStart.QuadPart);
+
+        if (SetFilePointer(hSource, ChunkStart.LowPart, &ChunkStart.HighPart, FILE_BEGIN) == INVALID_SET_FILE_POINTER &&
+            GetLastError() != NO_ERROR) {
+
+            YoriLibFree(Buffer);
+            return FALSE;
+        }
+
+        if (!ReadFile(hSource, Buffer, ChunkLength, &BytesRead, NULL) ||
+            BytesRead != ChunkLength) {
+
+            YoriLibFree(Buffer);
+            return FALSE;
+        }
+
+        if (ChunkEnd == (DWORDLONG)FileSize.QuadPart &&
+            (Buffer[ChunkLength - 1] == '\r' || Buffer[ChunkLength - 1] == '\n')) {
+
+            TerminatorsNeeded++;
+        }
+
+        //
+        //  Count the terminators in this chunk.  If there are enough to
+        //  satisfy the request, find the one where display should start,
+        //  which is counted from the start of the chunk.
+        //
+
+        TerminatorsFound = TailCountLineTerminators(Buffer, ChunkLength, FollowingChar, 0, &StopOffset);
+        if (TerminatorsFound >= TerminatorsNeeded) {
+            TailCountLineTerminators(Buffer, ChunkLength, FollowingChar, TerminatorsFound - TerminatorsNeeded + 1, &StopOffset);
+            *StartOffset = ChunkStart.QuadPart + StopOffset;
+            break;
+        }
+
+        TerminatorsNeeded = TerminatorsNeeded - TerminatorsFound;
+
+        if (ChunkStart.QuadPart == 0) {
+            *StartOffset = 0;
+            break;
+        }
+
+        if (YoriLibIsOperationCancelled()) {
+            YoriLibFree(Buffer);
+            return FALSE;
+        }
+
+        FollowingChar = Buffer[0];
+        ChunkEnd = ChunkStart.QuadPart;
+        ChunkStart.QuadPart = ChunkEnd - TAIL_SCAN_CHUNK_SIZE;
+    }
+
+    YoriLibFree(Buffer);
+    return TRUE;
+}
+
+/**
+ Create a change notification that is signalled when a file is modified.
+ Notifications are generated for a directory, so this notification will
+ also be signalled when other files in the same directory are modified.
+
+ @param FilePath Pointer to the full path to the file.
+
+ @return Handle to the change notification, or NULL if it could not be
+         created.
+ */
+HANDLE
+TailCreateChangeNotification(
+    __in PYORI_STRING FilePath
+    )
+{
+    YORI_STRING ParentDirectory;
+    LPTSTR FinalSlash;
+    HANDLE ChangeHandle;
+
+    FinalSlash = YoriLibFindRightMostCharacter(FilePath, '\\');
+    if (FinalSlash == NULL) {
+        return NULL;
+    }
+
+    YoriLibInitEmptyString(&ParentDirectory);
+    if (!YoriLibAllocateString(&ParentDirectory, (YORI_ALLOC_SIZE_T)(FinalSlash - FilePath->StartOfString) + 2)) {
+        return NULL;
+    }
+
+    //
+    //  Retain the final slash, so that the root of a drive is "C:\"
+    //  rather than "C:" which refers to the current directory on the drive.
+    //
+
+    ParentDirectory.LengthInChars = (YORI_ALLOC_SIZE_T)(FinalSlash - FilePath->StartOfString) + 1;
+    memcpy(ParentDirectory.StartOfString, FilePath->StartOfString, ParentDirectory.LengthInChars * sizeof(TCHAR));
+    ParentDirectory.StartOfString[ParentDirectory.LengthInChars] = '\0';
+
+    ChangeHandle = FindFirstChangeNotification(ParentDirectory.StartOfString,
+                                               FALSE,
+                                               FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+
+    YoriLibFreeStringContents(&ParentDirectory);
+    if (ChangeHandle == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    return ChangeHandle;
+}
+
 /**
  Process a single opened stream, enumerating through all lines and displaying
  the set requested by the user.
 
  @param hSource The opened source stream.
 
+ @param FilePath Optionally points to the full path of the file that was
+        opened.  This is used to wait for changes to the file.
+
  @param TailContext Pointer to context information specifying which lines to
         display.
  
@@ -150,32 +420,43 @@ typedef struct _TAIL_CONTEXT {
 BOOL
 TailProcessStream(
     __in HANDLE hSource,
+    __in_opt PYORI_STRING FilePath,
     __in PTAIL_CONTEXT TailContext
     )
 {
     PVOID LineContext = NULL;
     YORI_MAX_UNSIGNED_T StartLine = 0;
+    YORI_MAX_UNSIGNED_T FirstConvertedLine;
     YORI_MAX_UNSIGNED_T CurrentLine;
     PYORI_STRING LineString;
-    YORI_LIB_LINE_ENDING LineEnding;
+    YORI_LIB_LINE_VIEW LineView;
     BOOL TimeoutReached;
     DWORD SeekToEndOffset = 0;
     DWORD Err;
     DWORD BytesWritten;
+    LARGE_INTEGER StartOffset;
+    HANDLE ChangeHandle;
+    HANDLE WaitHandles[2];
+    DWORD WaitHandleCount;
 
     DWORD FileType = GetFileType(hSource);
     FileType = FileType & ~(FILE_TYPE_REMOTE);
 
     //
-    //  If it's a file and we want the final few lines, start searching
-    //  from the end, assuming an average line size of 256 bytes.
+    //  If it's a file and we want the final few lines, scan backwards from
+    //  the end to find where they start.  If that's not possible, start
+    //  searching from the end, assuming an average line size of 256 bytes.
     //
 
     if (FileType == FILE_TYPE_DISK &&
         !TailContext->StartLineSpecified &&
         TailContext->FinalLine == 0) {
 
-        SeekToEndOffset = 256 * TailContext->LinesToDisplay;
+        if (TailFindStartOfFinalLines(hSource, TailContext->LinesToDisplay, (PDWORDLONG)&StartOffset.QuadPart)) {
+            SetFilePointer(hSource, StartOffset.LowPart, &StartOffset.HighPart, FILE_BEGIN);
+        } else {
+            SeekToEndOffset = 256 * TailContext->LinesToDisplay;
+        }
     }
 
     TailContext->FilesFound++;
@@ -190,19 +471,37 @@ TailProcessStream(
             }
         }
         TailContext->LinesFound = 0;
+        FirstConvertedLine = (YORI_MAX_UNSIGNED_T)-1;
 
         while (TRUE) {
 
-            if (!YoriLibReadLineToStringEx(&TailContext->LinesArray[TailContext->LinesFound % TailContext->LinesToDisplay],
-                                           &LineContext,
-                                           !TailContext->WaitForMore,
-                                           INFINITE,
-                                           hSource,
-                                           &LineEnding,
-                                           &TimeoutReached)) {
+            if (!YoriLibReadLineToViewEx(&LineView,
+                                         &LineContext,
+                                         !TailContext->WaitForMore,
+                                         INFINITE,
+                                         hSource,
+                                         &TimeoutReached)) {
                 break;
             }
 
+            //
+            //  Lines are only converted if they could be displayed.  When
+            //  looking for lines in the middle of a file, everything before
+            //  that region is counted but not converted.
+            //
+
+            if ((!TailContext->StartLineSpecified || TailContext->LinesFound >= TailContext->StartLine) &&
+                (TailContext->FinalLine == 0 || TailContext->LinesFound + TailContext->LinesToDisplay >= TailContext->FinalLine)) {
+
+                if (!YoriLibLineViewToString(&LineView, &TailContext->LinesArray[TailContext->LinesFound % TailContext->LinesToDisplay])) {
+                    break;
+                }
+
+                if (FirstConvertedLine == (YORI_MAX_UNSIGNED_T)-1) {
+                    FirstConvertedLine = TailContext->LinesFound;
+                }
+            }
+
             TailContext->LinesFound++;
 
             if (TailContext->FinalLine != 0 && TailContext->LinesFound >= TailContext->FinalLine) {
@@ -243,15 +542,55 @@ TailProcessStream(
         }
     }
 
+    //
+    //  Only display lines that were converted.  If the stream ended before
+    //  the region being looked for, the ring contains empty lines or lines
+    //  from a previous stream, so those are skipped.
+    //
+
+    if (FirstConvertedLine == (YORI_MAX_UNSIGNED_T)-1) {
+        StartLine = TailContext->LinesFound;
+    } else if (StartLine < FirstConvertedLine) {
+        StartLine = FirstConvertedLine;
+    }
+
     for (CurrentLine = StartLine; CurrentLine < TailContext->LinesFound; CurrentLine++) {
         LineString = &TailContext->LinesArray[CurrentLine % TailContext->LinesToDisplay];
-        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y\n"), LineString);
+        YoriLibOutputToBuffer(&TailContext->OutputBuffer, 0, _T("%y\n"), LineString);
     }
 
+    //
+    //  Write buffered lines before any error for the next file, or before
+    //  waiting for more data to arrive.  New lines that arrive while
+    //  waiting are written as they are found.
+    //
+
+    YoriLibOutputBufferFlush(&TailContext->OutputBuffer);
+
     if (TailContext->WaitForMore) {
+
+        //
+        //  If the stream is a file, wait for the directory containing it to
+        //  report a change rather than polling.
+        //
+
+        ChangeHandle = NULL;
+        if (FilePath != NULL && FileType == FILE_TYPE_DISK) {
+            ChangeHandle = TailCreateChangeNotification(FilePath);
+        }
+
+        WaitHandleCount = 0;
+        if (ChangeHandle != NULL) {
+            WaitHandles[WaitHandleCount++] = ChangeHandle;
+            if (YoriLibCancelGetEvent() != NULL) {
+                WaitHandles[WaitHandleCount++] = YoriLibCancelGetEvent();
+            }
+        }
+
         while (TRUE) {
 
-            if (!YoriLibReadLineToStringEx(&TailContext->LinesArray[0], &LineContext, FALSE, INFINITE, hSource, &LineEnding, &TimeoutReached)) {
+            if (!YoriLibReadLineToViewEx(&LineView, &LineContext, FALSE, INFINITE, hSource, &TimeoutReached) ||
+                !YoriLibLineViewToString(&LineView, &TailContext->LinesArray[0])) {
 
                 //
                 //  Check if the target handle is still around
@@ -269,11 +608,21 @@ TailProcessStream(
                     break;
                 }
 
-                Sleep(200L);
+                if (ChangeHandle != NULL) {
+                    if (WaitForMultipleObjects(WaitHandleCount, WaitHandles, FALSE, TAIL_CHANGE_WAIT_TIMEOUT) == WAIT_OBJECT_0) {
+                        FindNextChangeNotification(ChangeHandle);
+                    }
+                } else {
+                    Sleep(200L);
+                }
                 continue;
             }
             YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%y\n"), &TailContext->LinesArray[0]);
         }
+
+        if (ChangeHandle != NULL) {
+            FindCloseChangeNotification(ChangeHandle);
+        }
     }
 
     YoriLibLineReadCloseOrCache(LineContext);
@@ -333,7 +682,7 @@ TailFileFoundCallback(
         }
 
         TailContext->SavedErrorThisArg = ERROR_SUCCESS;
-        TailProcessStream(FileHandle, TailContext);
+        TailProcessStream(FileHandle, FilePath, TailContext);
 
         CloseHandle(FileHandle);
     }
@@ -533,6 +882,11 @@ ENTRYPOINT(
         return EXIT_FAILURE;
     }
 
+    if (!YoriLibOutputBufferInitialize(&TailContext.OutputBuffer, GetStdHandle(STD_OUTPUT_HANDLE))) {
+        YoriLibFree(TailContext.LinesArray);
+        return EXIT_FAILURE;
+    }
+
 #if YORI_BUILTIN
     YoriLibCancelEnable(FALSE);
 #endif
@@ -556,11 +910,12 @@ ENTRYPOINT(
     if (StartArg == 0 || StartArg == ArgC) {
         if (YoriLibIsStdInConsole()) {
             YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("No file or pipe for input\n"));
+            YoriLibOutputBufferCleanup(&TailContext.OutputBuffer);
             YoriLibFree(TailContext.LinesArray);
             return EXIT_FAILURE;
         }
 
-        TailProcessStream(GetStdHandle(STD_INPUT_HANDLE), &TailContext);
+        TailProcessStream(GetStdHandle(STD_INPUT_HANDLE), NULL, &TailContext);
     } else {
         MatchFlags = YORILIB_ENUM_RETURN_FILES | YORILIB_ENUM_DIRECTORY_CONTENTS;
         if (TailContext.Recursive) {
@@ -601,6 +956,7 @@ ENTRYPOINT(
         YoriLibFreeStringContents(&TailContext.LinesArray[Count]);
     }
     YoriLibFree(TailContext.LinesArray);
+    YoriLibOutputBufferCleanup(&TailContext.OutputBuffer);
 
 #if !YORI_BUILTIN
     YoriLibLineReadCleanupCache();
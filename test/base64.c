@@ -0,0 +1,421 @@
+/**
+ * @file test/base64.c
+ *
+ * Yori shell test base64 encode and decode
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yorilib.h>
+#include "test.h"
+
+/**
+ The largest buffer to encode and decode when checking correctness.  This is
+ large enough to span many lines and many vectorized blocks.
+ */
+#define TEST_BASE64_BUFFER_LENGTH 4096
+
+/**
+ The number of bytes to encode and decode when measuring throughput.
+ */
+#define TEST_BASE64_THROUGHPUT_LENGTH (32 * 1024 * 1024)
+
+/**
+ The number of bytes to process in each call when measuring throughput.
+ */
+#define TEST_BASE64_THROUGHPUT_CHUNK (YORI_LIB_BASE64_LINE_LENGTH / 4 * 3 * 4096)
+
+/**
+ Generate a pseudo random number.  This is not intended to be high quality,
+ just repeatable and free of any CRT dependency.
+
+ @param Seed Pointer to the seed, updated on each call.
+
+ @return A pseudo random number.
+ */
+DWORD
+TestBase64Random(
+    __inout PDWORD Seed
+    )
+{
+    *Seed = *Seed * 1103515245 + 12345;
+    return (*Seed >> 16) & 0x7FFF;
+}
+
+/**
+ Encode a buffer, passing it to the encoder in randomly sized chunks.
+
+ @param Source Pointer to the bytes to encode.
+
+ @param SourceLength The number of bytes to encode.
+
+ @param LineLength The number of characters on each line, or zero for no
+        line breaks.
+
+ @param UseSsse3 If FALSE, SSSE3 instructions are not used even if
+        available.
+
+ @param Seed Pointer to the seed used to select chunk sizes.
+
+ @param Dest Pointer to a buffer to receive the encoded characters.
+
+ @return The number of characters written.
+ */
+YORI_ALLOC_SIZE_T
+TestBase64EncodeInChunks(
+    __in PUCHAR Source,
+    __in YORI_ALLOC_SIZE_T SourceLength,
+    __in YORI_ALLOC_SIZE_T LineLength,
+    __in BOOLEAN UseSsse3,
+    __inout PDWORD Seed,
+    __out PUCHAR Dest
+    )
+{
+    YORI_LIB_BASE64_ENCODER Encoder;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T ChunkLength;
+    YORI_ALLOC_SIZE_T CharsWritten;
+
+    YoriLibBase64EncodeInitialize(&Encoder, LineLength);
+    if (!UseSsse3) {
+        Encoder.UseSsse3 = FALSE;
+    }
+
+    CharsWritten = 0;
+    for (Index = 0; Index < SourceLength; Index = Index + ChunkLength) {
+        ChunkLength = (YORI_ALLOC_SIZE_T)(1 + TestBase64Random(Seed) % 200);
+        if (ChunkLength > SourceLength - Index) {
+            ChunkLength = SourceLength - Index;
+        }
+        CharsWritten = CharsWritten + YoriLibBase64EncodeUpdate(&Encoder, &Source[Index], ChunkLength, &Dest[CharsWritten]);
+    }
+
+    CharsWritten = CharsWritten + YoriLibBase64EncodeFinalize(&Encoder, &Dest[CharsWritten]);
+    return CharsWritten;
+}
+
+/**
+ Decode a buffer, passing it to the decoder in randomly sized chunks.
+
+ @param Source Pointer to the characters to decode.
+
+ @param SourceLength The number of characters to decode.
+
+ @param UseSsse3 If FALSE, SSSE3 instructions are not used even if
+        available.
+
+ @param Seed Pointer to the seed used to select chunk sizes.
+
+ @param Dest Pointer to a buffer to receive the decoded bytes.
+
+ @param BytesWritten On successful completion, updated to contain the number
+        of bytes written.
+
+ @return TRUE to indicate success, FALSE if the decoder rejected the input.
+ */
+__success(return)
+BOOL
+TestBase64DecodeInChunks(
+    __in PUCHAR Source,
+    __in YORI_ALLOC_SIZE_T SourceLength,
+    __in BOOLEAN UseSsse3,
+    __inout PDWORD Seed,
+    __out PUCHAR Dest,
+    __out PYORI_ALLOC_SIZE_T BytesWritten
+    )
+{
+    YORI_LIB_BASE64_DECODER Decoder;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T ChunkLength;
+    YORI_ALLOC_SIZE_T Written;
+    YORI_ALLOC_SIZE_T ChunkWritten;
+
+    YoriLibBase64DecodeInitialize(&Decoder);
+    if (!UseSsse3) {
+        Decoder.UseSsse3 = FALSE;
+    }
+
+    Written = 0;
+    for (Index = 0; Index < SourceLength; Index = Index + ChunkLength) {
+        ChunkLength = (YORI_ALLOC_SIZE_T)(1 + TestBase64Random(Seed) % 300);
+        if (ChunkLength > SourceLength - Index) {
+            ChunkLength = SourceLength - Index;
+        }
+        if (!YoriLibBase64DecodeUpdate(&Decoder, &Source[Index], ChunkLength, &Dest[Written], &ChunkWritten)) {
+            return FALSE;
+        }
+        Written = Written + ChunkWritten;
+    }
+
+    if (!YoriLibBase64DecodeFinalize(&Decoder, &Dest[Written], &ChunkWritten)) {
+        return FALSE;
+    }
+
+    *BytesWritten = Written + ChunkWritten;
+    return TRUE;
+}
+
+/**
+ A test variation to encode and decode the RFC 4648 test vectors, then
+ buffers of random data and random length in random chunks, with and without
+ line breaks and with and without SSSE3 instructions.  The vectorized and
+ scalar encodings must be identical, and decoding must reproduce the
+ original data.
+ */
+BOOLEAN
+TestBase64RoundTrip(VOID)
+{
+    PUCHAR Buffer;
+    PUCHAR Encoded;
+    PUCHAR EncodedScalar;
+    PUCHAR Decoded;
+    DWORD Seed;
+    DWORD Iteration;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T BufferLength;
+    YORI_ALLOC_SIZE_T LineLength;
+    YORI_ALLOC_SIZE_T EncodedLength;
+    YORI_ALLOC_SIZE_T EncodedScalarLength;
+    YORI_ALLOC_SIZE_T DecodedLength;
+    BOOLEAN UseSsse3;
+    BOOLEAN Result;
+    CONST CHAR * Vectors[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+
+    Buffer = YoriLibMalloc(TEST_BASE64_BUFFER_LENGTH * 6);
+    if (Buffer == NULL) {
+        return FALSE;
+    }
+
+    Encoded = Buffer + TEST_BASE64_BUFFER_LENGTH;
+    EncodedScalar = Encoded + TEST_BASE64_BUFFER_LENGTH * 2;
+    Decoded = EncodedScalar + TEST_BASE64_BUFFER_LENGTH * 2;
+
+    Result = FALSE;
+    Seed = 1;
+
+    for (Index = 0; Index < sizeof(Vectors)/sizeof(Vectors[0]); Index++) {
+        EncodedLength = TestBase64EncodeInChunks((PUCHAR)"foobar", Index, 0, TRUE, &Seed, Encoded);
+        if (EncodedLength != strlen(Vectors[Index]) ||
+            memcmp(Encoded, Vectors[Index], EncodedLength) != 0) {
+
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i encoding %i bytes returned %i chars, expected %hs\n"), __FILE__, __LINE__, Index, EncodedLength, Vectors[Index]);
+            goto Exit;
+        }
+    }
+
+    for (Iteration = 0; Iteration < 2000; Iteration++) {
+
+        BufferLength = (YORI_ALLOC_SIZE_T)(TestBase64Random(&Seed) % TEST_BASE64_BUFFER_LENGTH);
+        for (Index = 0; Index < BufferLength; Index++) {
+            Buffer[Index] = (UCHAR)TestBase64Random(&Seed);
+        }
+
+        LineLength = 0;
+        if ((Iteration % 2) == 0) {
+            LineLength = YORI_LIB_BASE64_LINE_LENGTH;
+        }
+
+        EncodedLength = TestBase64EncodeInChunks(Buffer, BufferLength, LineLength, TRUE, &Seed, Encoded);
+        EncodedScalarLength = TestBase64EncodeInChunks(Buffer, BufferLength, LineLength, FALSE, &Seed, EncodedScalar);
+        if (EncodedLength != EncodedScalarLength ||
+            memcmp(Encoded, EncodedScalar, EncodedLength) != 0) {
+
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i encodings differ, length %i line length %i\n"), __FILE__, __LINE__, BufferLength, LineLength);
+            goto Exit;
+        }
+
+        for (UseSsse3 = FALSE; UseSsse3 <= TRUE; UseSsse3++) {
+            if (!TestBase64DecodeInChunks(Encoded, EncodedLength, UseSsse3, &Seed, Decoded, &DecodedLength)) {
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i decode failed, length %i line length %i\n"), __FILE__, __LINE__, BufferLength, LineLength);
+                goto Exit;
+            }
+
+            if (DecodedLength != BufferLength ||
+                memcmp(Decoded, Buffer, BufferLength) != 0) {
+
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i decode returned %i bytes, expected %i, line length %i\n"), __FILE__, __LINE__, DecodedLength, BufferLength, LineLength);
+                goto Exit;
+            }
+        }
+    }
+
+    //
+    //  Characters outside the alphabet and data after padding must be
+    //  rejected.
+    //
+
+    if (TestBase64DecodeInChunks((PUCHAR)"Zm9v*mFy", 8, TRUE, &Seed, Decoded, &DecodedLength) ||
+        TestBase64DecodeInChunks((PUCHAR)"Zg==Zm8=", 8, TRUE, &Seed, Decoded, &DecodedLength) ||
+        TestBase64DecodeInChunks((PUCHAR)"Zm9vY", 5, TRUE, &Seed, Decoded, &DecodedLength)) {
+
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i invalid input was accepted\n"), __FILE__, __LINE__);
+        goto Exit;
+    }
+
+    Result = TRUE;
+
+Exit:
+    YoriLibFree(Buffer);
+    return Result;
+}
+
+/**
+ Calculate a throughput in megabytes per second.
+
+ @param Bytes The number of bytes processed.
+
+ @param Elapsed The time taken, in 100ns units.
+
+ @return The throughput in megabytes per second.
+ */
+DWORD
+TestBase64Throughput(
+    __in DWORDLONG Bytes,
+    __in LONGLONG Elapsed
+    )
+{
+    if (Elapsed <= 0) {
+        Elapsed = 1;
+    }
+
+    return (DWORD)(Bytes * 10 * 1000 * 1000 / (DWORDLONG)Elapsed / (1024 * 1024));
+}
+
+/**
+ A test variation to measure the throughput of encoding and decoding a
+ large buffer in the chunk size used by the base64 command, with and
+ without SSSE3 instructions.  The throughput is displayed, and the variation
+ fails only if decoding does not reproduce the original data.  Since this
+ allocates large buffers and takes some time, it only runs if requested with
+ -v.
+ */
+BOOLEAN
+TestBase64Benchmark(VOID)
+{
+    YORI_LIB_BASE64_ENCODER Encoder;
+    YORI_LIB_BASE64_DECODER Decoder;
+    YORI_MAX_UNSIGNED_T EncodedAllocation;
+    PUCHAR Buffer;
+    PUCHAR Encoded;
+    PUCHAR Decoded;
+    DWORD Seed;
+    DWORD Pass;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T ChunkLength;
+    YORI_ALLOC_SIZE_T EncodedLength;
+    YORI_ALLOC_SIZE_T DecodedLength;
+    YORI_ALLOC_SIZE_T ChunkWritten;
+    LONGLONG StartTime;
+    LONGLONG EncodeTime;
+    LONGLONG DecodeTime;
+    BOOLEAN Result;
+
+    YoriLibBase64EncodeInitialize(&Encoder, YORI_LIB_BASE64_LINE_LENGTH);
+    EncodedAllocation = YoriLibBase64EncodeMaximumOutput(&Encoder, TEST_BASE64_THROUGHPUT_LENGTH);
+    if (!YoriLibIsSizeAllocatable(TEST_BASE64_THROUGHPUT_LENGTH * 2 + EncodedAllocation)) {
+        return FALSE;
+    }
+
+    Buffer = YoriLibMalloc((YORI_ALLOC_SIZE_T)(TEST_BASE64_THROUGHPUT_LENGTH * 2 + EncodedAllocation));
+    if (Buffer == NULL) {
+        return FALSE;
+    }
+
+    Decoded = Buffer + TEST_BASE64_THROUGHPUT_LENGTH;
+    Encoded = Decoded + TEST_BASE64_THROUGHPUT_LENGTH;
+
+    Seed = 1;
+    for (Index = 0; Index < TEST_BASE64_THROUGHPUT_LENGTH; Index++) {
+        Buffer[Index] = (UCHAR)TestBase64Random(&Seed);
+    }
+
+    //
+    //  Run the scalar and vectorized paths alternately, twice each, so the
+    //  first pass warms the buffers for both.
+    //
+
+    Result = FALSE;
+    for (Pass = 0; Pass < 4; Pass++) {
+
+        YoriLibBase64EncodeInitialize(&Encoder, YORI_LIB_BASE64_LINE_LENGTH);
+        YoriLibBase64DecodeInitialize(&Decoder);
+        if ((Pass % 2) == 0) {
+            Encoder.UseSsse3 = FALSE;
+            Decoder.UseSsse3 = FALSE;
+        }
+
+        StartTime = YoriLibGetSystemTimeAsInteger();
+        EncodedLength = 0;
+        for (Index = 0; Index < TEST_BASE64_THROUGHPUT_LENGTH; Index = Index + ChunkLength) {
+            ChunkLength = TEST_BASE64_THROUGHPUT_CHUNK;
+            if (ChunkLength > TEST_BASE64_THROUGHPUT_LENGTH - Index) {
+                ChunkLength = TEST_BASE64_THROUGHPUT_LENGTH - Index;
+            }
+            EncodedLength = EncodedLength + YoriLibBase64EncodeUpdate(&Encoder, &Buffer[Index], ChunkLength, &Encoded[EncodedLength]);
+        }
+        EncodedLength = EncodedLength + YoriLibBase64EncodeFinalize(&Encoder, &Encoded[EncodedLength]);
+        EncodeTime = YoriLibGetSystemTimeAsInteger() - StartTime;
+
+        StartTime = YoriLibGetSystemTimeAsInteger();
+        DecodedLength = 0;
+        for (Index = 0; Index < EncodedLength; Index = Index + ChunkLength) {
+            ChunkLength = TEST_BASE64_THROUGHPUT_CHUNK;
+            if (ChunkLength > EncodedLength - Index) {
+                ChunkLength = EncodedLength - Index;
+            }
+            if (!YoriLibBase64DecodeUpdate(&Decoder, &Encoded[Index], ChunkLength, &Decoded[DecodedLength], &ChunkWritten)) {
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i decode failed\n"), __FILE__, __LINE__);
+                goto Exit;
+            }
+            DecodedLength = DecodedLength + ChunkWritten;
+        }
+        if (!YoriLibBase64DecodeFinalize(&Decoder, &Decoded[DecodedLength], &ChunkWritten)) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i decode failed\n"), __FILE__, __LINE__);
+            goto Exit;
+        }
+        DecodedLength = DecodedLength + ChunkWritten;
+        DecodeTime = YoriLibGetSystemTimeAsInteger() - StartTime;
+
+        if (DecodedLength != TEST_BASE64_THROUGHPUT_LENGTH ||
+            memcmp(Decoded, Buffer, TEST_BASE64_THROUGHPUT_LENGTH) != 0) {
+
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i decode returned %i bytes, expected %i\n"), __FILE__, __LINE__, DecodedLength, TEST_BASE64_THROUGHPUT_LENGTH);
+            goto Exit;
+        }
+
+        if (Pass >= 2) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDOUT,
+                          _T("  %hs: encode %i MB/s, decode %i MB/s\n"),
+                          Encoder.UseSsse3?"SSSE3":"Scalar",
+                          TestBase64Throughput(TEST_BASE64_THROUGHPUT_LENGTH, EncodeTime),
+                          TestBase64Throughput(TEST_BASE64_THROUGHPUT_LENGTH, DecodeTime));
+        }
+    }
+
+    Result = TRUE;
+
+Exit:
+    YoriLibFree(Buffer);
+    return Result;
+}
+
+// vim:sw=4:ts=4:et:
@@ -0,0 +1,247 @@
+/**
+ * @file test/bytesrch.c
+ *
+ * Yori shell test binary buffer search
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yorilib.h>
+#include "test.h"
+
+/**
+ The length of the buffer to search.  This is large enough to exercise both
+ vectorized and scalar paths many times within a single buffer.
+ */
+#define TEST_BYTE_SEARCH_BUFFER_LENGTH 4096
+
+/**
+ Generate a pseudo random number.  This is not intended to be high quality,
+ just repeatable and free of any CRT dependency.
+
+ @param Seed Pointer to the seed, updated on each call.
+
+ @return A pseudo random number.
+ */
+DWORD
+TestByteSearchRandom(
+    __inout PDWORD Seed
+    )
+{
+    *Seed = *Seed * 1103515245 + 12345;
+    return (*Seed >> 16) & 0x7FFF;
+}
+
+/**
+ Search forward for a sub-buffer one position at a time, as a reference to
+ compare the library search against.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param BufferLength The length of the buffer, in bytes.
+
+ @param BufferOffset The first offset that a match may start at.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.
+
+ @return The offset of the match, or -1 if no match exists.
+ */
+YORI_ALLOC_SIZE_T
+TestByteSearchSimpleNext(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+
+    for (Index = BufferOffset; Index + SearchBufferLength <= BufferLength; Index++) {
+        if (memcmp(&Buffer[Index], SearchBuffer, SearchBufferLength) == 0) {
+            return Index;
+        }
+    }
+
+    return (YORI_ALLOC_SIZE_T)-1;
+}
+
+/**
+ Search backward for a sub-buffer one position at a time, as a reference to
+ compare the library search against.
+
+ @param Buffer Pointer to the buffer to search.
+
+ @param BufferLength The length of the buffer, in bytes.
+
+ @param BufferOffset The last offset that a match may start at.
+
+ @param SearchBuffer Pointer to the buffer to search for.
+
+ @param SearchBufferLength The length of the search buffer, in bytes.
+
+ @return The offset of the match, or -1 if no match exists.
+ */
+YORI_ALLOC_SIZE_T
+TestByteSearchSimplePrevious(
+    __in PUCHAR Buffer,
+    __in YORI_ALLOC_SIZE_T BufferLength,
+    __in YORI_ALLOC_SIZE_T BufferOffset,
+    __in PUCHAR SearchBuffer,
+    __in YORI_ALLOC_SIZE_T SearchBufferLength
+    )
+{
+    YORI_ALLOC_SIZE_T Index;
+
+    if (BufferLength < SearchBufferLength) {
+        return (YORI_ALLOC_SIZE_T)-1;
+    }
+
+    Index = BufferOffset;
+    if (Index > BufferLength - SearchBufferLength) {
+        Index = BufferLength - SearchBufferLength;
+    }
+
+    while (TRUE) {
+        if (memcmp(&Buffer[Index], SearchBuffer, SearchBufferLength) == 0) {
+            return Index;
+        }
+        if (Index == 0) {
+            break;
+        }
+        Index--;
+    }
+
+    return (YORI_ALLOC_SIZE_T)-1;
+}
+
+/**
+ A test variation to search buffers forward and backward for sub-buffers of
+ varying length, from varying offsets, and check the results against a
+ simple search.  Buffers are populated with random data, where matches are
+ rare, and with data drawn from only two or four values, where partial
+ matches are frequent and searches that skip ahead are least effective.
+ */
+BOOLEAN
+TestByteSearch(VOID)
+{
+    PUCHAR Buffer;
+    UCHAR SearchBuffer[40];
+    DWORD Seed;
+    DWORD Iteration;
+    DWORD Alphabet;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T BufferLength;
+    YORI_ALLOC_SIZE_T SearchBufferLength;
+    YORI_ALLOC_SIZE_T Offset;
+    YORI_ALLOC_SIZE_T Expected;
+    YORI_ALLOC_SIZE_T Found;
+    BOOLEAN Result;
+
+    Buffer = YoriLibMalloc(TEST_BYTE_SEARCH_BUFFER_LENGTH);
+    if (Buffer == NULL) {
+        return FALSE;
+    }
+
+    Result = FALSE;
+    Seed = 1;
+    for (Iteration = 0; Iteration < 3000; Iteration++) {
+
+        switch(Iteration % 3) {
+            case 0:
+                Alphabet = 2;
+                break;
+            case 1:
+                Alphabet = 4;
+                break;
+            default:
+                Alphabet = 256;
+                break;
+        }
+
+        BufferLength = (YORI_ALLOC_SIZE_T)(TestByteSearchRandom(&Seed) % TEST_BYTE_SEARCH_BUFFER_LENGTH);
+        for (Index = 0; Index < BufferLength; Index++) {
+            Buffer[Index] = (UCHAR)(TestByteSearchRandom(&Seed) % Alphabet);
+        }
+
+        //
+        //  Search for something known to be in the buffer half of the time,
+        //  and something that is probably not the rest of the time.
+        //
+
+        SearchBufferLength = (YORI_ALLOC_SIZE_T)(1 + TestByteSearchRandom(&Seed) % sizeof(SearchBuffer));
+        if (BufferLength >= SearchBufferLength && (Iteration % 2) == 0) {
+            Offset = (YORI_ALLOC_SIZE_T)(TestByteSearchRandom(&Seed) % (BufferLength - SearchBufferLength + 1));
+            memcpy(SearchBuffer, &Buffer[Offset], SearchBufferLength);
+        } else {
+            for (Index = 0; Index < SearchBufferLength; Index++) {
+                SearchBuffer[Index] = (UCHAR)(TestByteSearchRandom(&Seed) % Alphabet);
+            }
+        }
+
+        Offset = (YORI_ALLOC_SIZE_T)(TestByteSearchRandom(&Seed) % (BufferLength + 1));
+
+        Expected = TestByteSearchSimpleNext(Buffer, BufferLength, Offset, SearchBuffer, SearchBufferLength);
+        if (!YoriLibFindNextBytes(Buffer, BufferLength, Offset, SearchBuffer, SearchBufferLength, &Found)) {
+            Found = (YORI_ALLOC_SIZE_T)-1;
+        }
+        if (Found != Expected) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                          _T("%hs:%i YoriLibFindNextBytes returned %i expected %i, length %i offset %i search length %i\n"),
+                          __FILE__,
+                          __LINE__,
+                          Found,
+                          Expected,
+                          BufferLength,
+                          Offset,
+                          SearchBufferLength);
+            goto Exit;
+        }
+
+        Expected = TestByteSearchSimplePrevious(Buffer, BufferLength, Offset, SearchBuffer, SearchBufferLength);
+        if (!YoriLibFindPreviousBytes(Buffer, BufferLength, Offset, SearchBuffer, SearchBufferLength, &Found)) {
+            Found = (YORI_ALLOC_SIZE_T)-1;
+        }
+        if (Found != Expected) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                          _T("%hs:%i YoriLibFindPreviousBytes returned %i expected %i, length %i offset %i search length %i\n"),
+                          __FILE__,
+                          __LINE__,
+                          Found,
+                          Expected,
+                          BufferLength,
+                          Offset,
+                          SearchBufferLength);
+            goto Exit;
+        }
+    }
+
+    Result = TRUE;
+
+Exit:
+    YoriLibFree(Buffer);
+    return Result;
+}
+
+// vim:sw=4:ts=4:et:
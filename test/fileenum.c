@@ -391,4 +391,173 @@ TestEnumWindows(VOID)
     return TRUE;
 }
 
+/**
+ Context passed to the callback which is invoked for each file found when
+ comparing parallel enumerates against a regular enumerate.
+ */
+typedef struct _TEST_PARALLEL_ENUM_CONTEXT {
+
+    /**
+     A mutex to synchronize updates from an unordered enumerate.
+     */
+    HANDLE Mutex;
+
+    /**
+     Indicates the number of files enumerated.
+     */
+    DWORD FilesFound;
+
+    /**
+     A hash of every path found, combined in the order they were found.
+     */
+    DWORD OrderedHash;
+
+    /**
+     A hash of every path found, combined such that the order they were
+     found does not change the result.
+     */
+    DWORD UnorderedHash;
+
+} TEST_PARALLEL_ENUM_CONTEXT, *PTEST_PARALLEL_ENUM_CONTEXT;
+
+/**
+ A callback that is invoked when a file is found when comparing parallel
+ enumerates against a regular enumerate.  This can be called concurrently
+ from multiple threads.
+
+ @param FilePath Pointer to the file path that was found.
+
+ @param FileInfo Information about the file.
+
+ @param Depth Specifies recursion depth.  Ignored in this application.
+
+ @param Context Pointer to the test context.
+
+ @return TRUE to continute enumerating, FALSE to abort.
+ */
+BOOL
+TestParallelEnumFileFoundCallback(
+    __in PYORI_STRING FilePath,
+    __in PWIN32_FIND_DATA FileInfo,
+    __in DWORD Depth,
+    __in PVOID Context
+    )
+{
+    PTEST_PARALLEL_ENUM_CONTEXT TestContext = (PTEST_PARALLEL_ENUM_CONTEXT)Context;
+    DWORD PathHash;
+
+    UNREFERENCED_PARAMETER(FileInfo);
+    UNREFERENCED_PARAMETER(Depth);
+
+    PathHash = YoriLibHashString32(0, FilePath);
+
+    WaitForSingleObject(TestContext->Mutex, INFINITE);
+    TestContext->FilesFound++;
+    TestContext->OrderedHash = YoriLibHashString32(TestContext->OrderedHash, FilePath);
+    TestContext->UnorderedHash = TestContext->UnorderedHash + PathHash;
+    ReleaseMutex(TestContext->Mutex);
+
+    return TRUE;
+}
+
+/**
+ A test variation to recursively enumerate a directory with a regular
+ enumerate, an ordered parallel enumerate, and an unordered parallel
+ enumerate, and check that the ordered enumerate returns the same objects
+ in the same order and the unordered enumerate returns the same objects.
+ */
+BOOLEAN
+TestEnumParallel(VOID)
+{
+    TEST_PARALLEL_ENUM_CONTEXT Regular;
+    TEST_PARALLEL_ENUM_CONTEXT Ordered;
+    TEST_PARALLEL_ENUM_CONTEXT Unordered;
+    YORI_STRING FileSpec;
+    WORD MatchFlags;
+    BOOLEAN Result;
+
+    Result = FALSE;
+    ZeroMemory(&Regular, sizeof(Regular));
+    ZeroMemory(&Ordered, sizeof(Ordered));
+    ZeroMemory(&Unordered, sizeof(Unordered));
+
+    Regular.Mutex = CreateMutex(NULL, FALSE, NULL);
+    Ordered.Mutex = CreateMutex(NULL, FALSE, NULL);
+    Unordered.Mutex = CreateMutex(NULL, FALSE, NULL);
+    if (Regular.Mutex == NULL || Ordered.Mutex == NULL || Unordered.Mutex == NULL) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i CreateMutex failed\n"), __FILE__, __LINE__);
+        goto Exit;
+    }
+
+    MatchFlags = YORILIB_ENUM_RETURN_FILES |
+                 YORILIB_ENUM_RETURN_DIRECTORIES |
+                 YORILIB_ENUM_REC_BEFORE_RETURN |
+                 YORILIB_ENUM_NO_LINK_TRAVERSE;
+
+    YoriLibConstantString(&FileSpec, _T("C:\\Windows\\System32\\drivers"));
+    if (!YoriLibForEachFile(&FileSpec,
+                            MatchFlags,
+                            0,
+                            TestParallelEnumFileFoundCallback,
+                            TestEnumFileEnumerateErrorCallback,
+                            &Regular)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibForEachFile failed searching %y, error %i\n"), __FILE__, __LINE__, &FileSpec, GetLastError());
+        goto Exit;
+    }
+
+    if (Regular.FilesFound <= 1) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibForEachFile found no files looking for %y\n"), __FILE__, __LINE__, &FileSpec);
+        goto Exit;
+    }
+
+    if (!YoriLibForEachFile(&FileSpec,
+                            MatchFlags | YORILIB_ENUM_PARALLEL,
+                            0,
+                            TestParallelEnumFileFoundCallback,
+                            TestEnumFileEnumerateErrorCallback,
+                            &Ordered)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibForEachFile failed searching %y, error %i\n"), __FILE__, __LINE__, &FileSpec, GetLastError());
+        goto Exit;
+    }
+
+    if (Ordered.FilesFound != Regular.FilesFound ||
+        Ordered.OrderedHash != Regular.OrderedHash) {
+
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i ordered parallel enumerate found %i files, regular enumerate found %i, hash %08x vs %08x\n"), __FILE__, __LINE__, Ordered.FilesFound, Regular.FilesFound, Ordered.OrderedHash, Regular.OrderedHash);
+        goto Exit;
+    }
+
+    if (!YoriLibForEachFile(&FileSpec,
+                            MatchFlags | YORILIB_ENUM_PARALLEL_UNORDERED,
+                            0,
+                            TestParallelEnumFileFoundCallback,
+                            TestEnumFileEnumerateErrorCallback,
+                            &Unordered)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibForEachFile failed searching %y, error %i\n"), __FILE__, __LINE__, &FileSpec, GetLastError());
+        goto Exit;
+    }
+
+    if (Unordered.FilesFound != Regular.FilesFound ||
+        Unordered.UnorderedHash != Regular.UnorderedHash) {
+
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i unordered parallel enumerate found %i files, regular enumerate found %i, hash %08x vs %08x\n"), __FILE__, __LINE__, Unordered.FilesFound, Regular.FilesFound, Unordered.UnorderedHash, Regular.UnorderedHash);
+        goto Exit;
+    }
+
+    Result = TRUE;
+
+Exit:
+    if (Regular.Mutex != NULL) {
+        CloseHandle(Regular.Mutex);
+    }
+    if (Ordered.Mutex != NULL) {
+        CloseHandle(Ordered.Mutex);
+    }
+    if (Unordered.Mutex != NULL) {
+        CloseHandle(Unordered.Mutex);
+    }
+
+    return Result;
+}
+
 // vim:sw=4:ts=4:et:
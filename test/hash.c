@@ -0,0 +1,161 @@
+/**
+ * @file test/hash.c
+ *
+ * Yori shell test hash tables
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yorilib.h>
+#include "test.h"
+
+/**
+ The number of entries to insert into the hash table.
+ */
+#define TEST_HASH_ENTRY_COUNT 100000
+
+/**
+ A test variation that inserts many entries into a hash table which starts
+ small, verifies that every entry can be found after the table grows, that
+ lookups are case insensitive, and that entries can be removed both by key
+ and by entry.
+ */
+BOOLEAN
+TestHashTableGrowth(VOID)
+{
+    PYORI_HASH_TABLE HashTable;
+    PYORI_HASH_ENTRY Entries;
+    PYORI_HASH_ENTRY Found;
+    YORI_STRING Key;
+    YORI_STRING EntryKey;
+    TCHAR KeyBuffer[32];
+    DWORD Index;
+    BOOLEAN Result;
+
+    HashTable = YoriLibAllocateHashTable(1);
+    if (HashTable == NULL) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibAllocateHashTable failed\n"), __FILE__, __LINE__);
+        return FALSE;
+    }
+
+    Entries = YoriLibMalloc(TEST_HASH_ENTRY_COUNT * sizeof(YORI_HASH_ENTRY));
+    if (Entries == NULL) {
+        YoriLibFreeEmptyHashTable(HashTable);
+        return FALSE;
+    }
+
+    ZeroMemory(Entries, TEST_HASH_ENTRY_COUNT * sizeof(YORI_HASH_ENTRY));
+
+    YoriLibInitEmptyString(&Key);
+    Key.StartOfString = KeyBuffer;
+    Key.LengthAllocated = sizeof(KeyBuffer)/sizeof(KeyBuffer[0]);
+    Result = FALSE;
+
+    //
+    //  The hash table references the key string rather than copying it, so
+    //  each entry needs its own allocation.  The table holds a reference,
+    //  so the local one can be released immediately.
+    //
+
+    for (Index = 0; Index < TEST_HASH_ENTRY_COUNT; Index++) {
+        if (!YoriLibAllocateString(&EntryKey, sizeof(KeyBuffer)/sizeof(KeyBuffer[0]))) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibAllocateString failed\n"), __FILE__, __LINE__);
+            goto Exit;
+        }
+        EntryKey.LengthInChars = YoriLibSPrintf(EntryKey.StartOfString, _T("Key%i"), Index);
+        YoriLibHashInsertByKey(HashTable, &EntryKey, &Entries[Index], &Entries[Index]);
+        YoriLibFreeStringContents(&EntryKey);
+    }
+
+    if (HashTable->EntryCount != TEST_HASH_ENTRY_COUNT) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i hash table has %i entries, expected %i\n"), __FILE__, __LINE__, HashTable->EntryCount, TEST_HASH_ENTRY_COUNT);
+        goto Exit;
+    }
+
+    if (HashTable->NumberBuckets < TEST_HASH_ENTRY_COUNT) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i hash table has %i buckets, expected growth to at least %i\n"), __FILE__, __LINE__, HashTable->NumberBuckets, TEST_HASH_ENTRY_COUNT);
+        goto Exit;
+    }
+
+    for (Index = 0; Index < TEST_HASH_ENTRY_COUNT; Index++) {
+        Key.LengthInChars = YoriLibSPrintf(Key.StartOfString, _T("kEY%i"), Index);
+        Found = YoriLibHashLookupByKey(HashTable, &Key);
+        if (Found != &Entries[Index] || Found->Context != &Entries[Index]) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i lookup of %y returned incorrect entry\n"), __FILE__, __LINE__, &Key);
+            goto Exit;
+        }
+    }
+
+    Key.LengthInChars = YoriLibSPrintf(Key.StartOfString, _T("Key%i"), TEST_HASH_ENTRY_COUNT);
+    if (YoriLibHashLookupByKey(HashTable, &Key) != NULL) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i lookup of %y found an entry that was never inserted\n"), __FILE__, __LINE__, &Key);
+        goto Exit;
+    }
+
+    //
+    //  Remove the even entries by key, then check that only the odd
+    //  entries can be found.
+    //
+
+    for (Index = 0; Index < TEST_HASH_ENTRY_COUNT; Index += 2) {
+        Key.LengthInChars = YoriLibSPrintf(Key.StartOfString, _T("Key%i"), Index);
+        if (YoriLibHashRemoveByKey(HashTable, &Key) != &Entries[Index]) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i remove of %y returned incorrect entry\n"), __FILE__, __LINE__, &Key);
+            goto Exit;
+        }
+    }
+
+    for (Index = 0; Index < TEST_HASH_ENTRY_COUNT; Index++) {
+        Key.LengthInChars = YoriLibSPrintf(Key.StartOfString, _T("Key%i"), Index);
+        Found = YoriLibHashLookupByKey(HashTable, &Key);
+        if ((Index % 2) == 0) {
+            if (Found != NULL) {
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i lookup of %y found a removed entry\n"), __FILE__, __LINE__, &Key);
+                goto Exit;
+            }
+        } else if (Found != &Entries[Index]) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i lookup of %y returned incorrect entry\n"), __FILE__, __LINE__, &Key);
+            goto Exit;
+        }
+    }
+
+    Result = TRUE;
+
+Exit:
+
+    for (Index = 0; Index < TEST_HASH_ENTRY_COUNT; Index++) {
+        if (Entries[Index].HashTable != NULL) {
+            YoriLibHashRemoveByEntry(&Entries[Index]);
+        }
+    }
+
+    if (Result && HashTable->EntryCount != 0) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i hash table has %i entries after removing all, expected 0\n"), __FILE__, __LINE__, HashTable->EntryCount);
+        Result = FALSE;
+    }
+
+    YoriLibFree(Entries);
+    YoriLibFreeEmptyHashTable(HashTable);
+    return Result;
+}
+
+// vim:sw=4:ts=4:et:
@@ -0,0 +1,331 @@
+/**
+ * @file test/lineread.c
+ *
+ * Yori shell test line reading
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yorilib.h>
+#include "test.h"
+
+/**
+ Generate a pseudo random number.  This is not intended to be high quality,
+ just repeatable and free of any CRT dependency.
+
+ @param Seed Pointer to the seed, updated on each call.
+
+ @return A pseudo random number.
+ */
+DWORD
+TestLineReadRandom(
+    __inout PDWORD Seed
+    )
+{
+    *Seed = *Seed * 1103515245 + 12345;
+    return (*Seed >> 16) & 0x7FFF;
+}
+
+/**
+ A test variation to search buffers of varying length and alignment for line
+ terminators and check the result against a simple character by character
+ search.
+ */
+BOOLEAN
+TestLineTerminatorSearch(VOID)
+{
+    UCHAR NarrowBuffer[128];
+    WCHAR WideBuffer[128];
+    DWORD Seed;
+    DWORD Iteration;
+    DWORD Value;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T Offset;
+    YORI_ALLOC_SIZE_T Length;
+    YORI_ALLOC_SIZE_T Expected;
+    YORI_ALLOC_SIZE_T Found;
+
+    Seed = 1;
+    for (Iteration = 0; Iteration < 100000; Iteration++) {
+
+        //
+        //  Populate the buffer with mostly printable characters, some
+        //  control characters and high bit characters which are near
+        //  the values being searched for, and a sparse set of line
+        //  terminators.
+        //
+
+        for (Index = 0; Index < sizeof(NarrowBuffer); Index++) {
+            Value = TestLineReadRandom(&Seed) % 64;
+            if (Value == 0) {
+                NarrowBuffer[Index] = '\r';
+                WideBuffer[Index] = '\r';
+            } else if (Value == 1) {
+                NarrowBuffer[Index] = '\n';
+                WideBuffer[Index] = '\n';
+            } else if (Value < 8) {
+                NarrowBuffer[Index] = (UCHAR)TestLineReadRandom(&Seed);
+                WideBuffer[Index] = (WCHAR)(TestLineReadRandom(&Seed) << 1 | TestLineReadRandom(&Seed));
+            } else {
+                NarrowBuffer[Index] = (UCHAR)('0' + Value);
+                WideBuffer[Index] = (WCHAR)('0' + Value);
+            }
+        }
+
+        Offset = TestLineReadRandom(&Seed) % 16;
+        Length = (YORI_ALLOC_SIZE_T)(TestLineReadRandom(&Seed) % (sizeof(NarrowBuffer) - Offset));
+
+        Expected = Length;
+        for (Index = 0; Index < Length; Index++) {
+            if (NarrowBuffer[Offset + Index] == '\r' ||
+                NarrowBuffer[Offset + Index] == '\n') {
+
+                Expected = Index;
+                break;
+            }
+        }
+
+        Found = YoriLibFindLineTerminatorA(&NarrowBuffer[Offset], Length);
+        if (Found != Expected) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                          _T("%hs:%i YoriLibFindLineTerminatorA returned %i expected %i, offset %i length %i\n"),
+                          __FILE__,
+                          __LINE__,
+                          Found,
+                          Expected,
+                          Offset,
+                          Length);
+            return FALSE;
+        }
+
+        Expected = Length;
+        for (Index = 0; Index < Length; Index++) {
+            if (WideBuffer[Offset + Index] == '\r' ||
+                WideBuffer[Offset + Index] == '\n') {
+
+                Expected = Index;
+                break;
+            }
+        }
+
+        Found = YoriLibFindLineTerminatorW(&WideBuffer[Offset], Length);
+        if (Found != Expected) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                          _T("%hs:%i YoriLibFindLineTerminatorW returned %i expected %i, offset %i length %i\n"),
+                          __FILE__,
+                          __LINE__,
+                          Found,
+                          Expected,
+                          Offset,
+                          Length);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ The number of lines to write into the file used to test line reading.
+ */
+#define TEST_LINE_READ_LINE_COUNT 20001
+
+/**
+ Return the number of characters in a line generated by the line read test.
+ Most lines are short, but some are long enough to span many vector
+ operations.
+
+ @param LineNumber The line number to generate.
+
+ @return The number of characters in the line, excluding the terminator.
+ */
+YORI_ALLOC_SIZE_T
+TestLineReadLineLength(
+    __in DWORD LineNumber
+    )
+{
+    if ((LineNumber % 997) == 0) {
+        return 4000 + LineNumber % 100;
+    }
+    if ((LineNumber % 13) == 0) {
+        return 200 + LineNumber % 50;
+    }
+    return LineNumber % 40;
+}
+
+/**
+ Return the line ending used by a line generated by the line read test.
+ The file contains a mix of CRLF, LF and CR terminated lines.  Note the final
+ line should not be CR terminated, since the line reader cannot know whether
+ a LF would follow it.
+
+ @param LineNumber The line number to generate.
+
+ @return The line ending for the line.
+ */
+YORI_LIB_LINE_ENDING
+TestLineReadLineEnding(
+    __in DWORD LineNumber
+    )
+{
+    switch(LineNumber % 5) {
+        case 0:
+        case 3:
+            return YoriLibLineEndingLF;
+        case 4:
+            return YoriLibLineEndingCR;
+    }
+    return YoriLibLineEndingCRLF;
+}
+
+/**
+ A test variation to write a file containing short, long, and mixed line
+ ending lines, then read it back with the line reader and verify that each
+ line has the expected length, contents, and line ending.
+ */
+BOOLEAN
+TestLineReadMixedEndings(VOID)
+{
+    YORI_STRING TempPath;
+    YORI_STRING Prefix;
+    YORI_STRING TempFileName;
+    YORI_STRING LineString;
+    HANDLE TempHandle;
+    PUCHAR WriteBuffer;
+    PVOID LineContext;
+    DWORD LineNumber;
+    DWORD BytesWritten;
+    YORI_ALLOC_SIZE_T Index;
+    YORI_ALLOC_SIZE_T LineLength;
+    YORI_ALLOC_SIZE_T BufferLength;
+    YORI_LIB_LINE_ENDING LineEnding;
+    BOOL TimeoutReached;
+    BOOLEAN Result;
+
+    if (!YoriLibGetTempPath(&TempPath, 0)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibGetTempPath failed\n"), __FILE__, __LINE__);
+        return FALSE;
+    }
+
+    YoriLibConstantString(&Prefix, _T("TST"));
+    if (!YoriLibGetTempFileName(&TempPath, &Prefix, &TempHandle, &TempFileName)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibGetTempFileName failed\n"), __FILE__, __LINE__);
+        YoriLibFreeStringContents(&TempPath);
+        return FALSE;
+    }
+    YoriLibFreeStringContents(&TempPath);
+
+    Result = FALSE;
+    LineContext = NULL;
+    YoriLibInitEmptyString(&LineString);
+    WriteBuffer = YoriLibMalloc(8192);
+    if (WriteBuffer == NULL) {
+        goto Exit;
+    }
+
+    for (LineNumber = 0; LineNumber < TEST_LINE_READ_LINE_COUNT; LineNumber++) {
+        LineLength = TestLineReadLineLength(LineNumber);
+        for (Index = 0; Index < LineLength; Index++) {
+            WriteBuffer[Index] = (UCHAR)('a' + (LineNumber + Index) % 26);
+        }
+        BufferLength = LineLength;
+        LineEnding = TestLineReadLineEnding(LineNumber);
+        if (LineEnding == YoriLibLineEndingCRLF) {
+            WriteBuffer[BufferLength++] = '\r';
+            WriteBuffer[BufferLength++] = '\n';
+        } else if (LineEnding == YoriLibLineEndingLF) {
+            WriteBuffer[BufferLength++] = '\n';
+        } else {
+            WriteBuffer[BufferLength++] = '\r';
+        }
+
+        if (!WriteFile(TempHandle, WriteBuffer, BufferLength, &BytesWritten, NULL) ||
+            BytesWritten != BufferLength) {
+
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i WriteFile failed\n"), __FILE__, __LINE__);
+            goto Exit;
+        }
+    }
+
+    SetFilePointer(TempHandle, 0, NULL, FILE_BEGIN);
+
+    for (LineNumber = 0; LineNumber < TEST_LINE_READ_LINE_COUNT; LineNumber++) {
+        if (!YoriLibReadLineToStringEx(&LineString, &LineContext, TRUE, INFINITE, TempHandle, &LineEnding, &TimeoutReached)) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibReadLineToStringEx failed on line %i\n"), __FILE__, __LINE__, LineNumber);
+            goto Exit;
+        }
+
+        LineLength = TestLineReadLineLength(LineNumber);
+        if (LineString.LengthInChars != LineLength) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                          _T("%hs:%i line %i has length %i expected %i\n"),
+                          __FILE__,
+                          __LINE__,
+                          LineNumber,
+                          LineString.LengthInChars,
+                          LineLength);
+            goto Exit;
+        }
+
+        for (Index = 0; Index < LineLength; Index++) {
+            if (LineString.StartOfString[Index] != (TCHAR)('a' + (LineNumber + Index) % 26)) {
+                YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i line %i has unexpected contents at offset %i\n"), __FILE__, __LINE__, LineNumber, Index);
+                goto Exit;
+            }
+        }
+
+        if (LineEnding != TestLineReadLineEnding(LineNumber)) {
+
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                          _T("%hs:%i line %i has line ending %i expected %i\n"),
+                          __FILE__,
+                          __LINE__,
+                          LineNumber,
+                          LineEnding,
+                          TestLineReadLineEnding(LineNumber));
+            goto Exit;
+        }
+    }
+
+    if (YoriLibReadLineToStringEx(&LineString, &LineContext, TRUE, INFINITE, TempHandle, &LineEnding, &TimeoutReached)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibReadLineToStringEx returned data after the final line\n"), __FILE__, __LINE__);
+        goto Exit;
+    }
+
+    Result = TRUE;
+
+Exit:
+
+    if (LineContext != NULL) {
+        YoriLibLineReadClose(LineContext);
+    }
+    YoriLibFreeStringContents(&LineString);
+    if (WriteBuffer != NULL) {
+        YoriLibFree(WriteBuffer);
+    }
+    CloseHandle(TempHandle);
+    DeleteFile(TempFileName.StartOfString);
+    YoriLibFreeStringContents(&TempFileName);
+    return Result;
+}
+
+// vim:sw=4:ts=4:et:
@@ -0,0 +1,162 @@
+/**
+ * @file test/output.c
+ *
+ * Yori shell test buffered output
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yorilib.h>
+#include "test.h"
+
+/**
+ The number of short lines to write through the output buffer.
+ */
+#define TEST_OUTPUT_LINE_COUNT 20000
+
+/**
+ The number of characters in a line which is larger than the output buffer.
+ */
+#define TEST_OUTPUT_LONG_LINE_LENGTH (YORI_LIB_OUTPUT_BUFFER_SIZE + 1000)
+
+/**
+ A test variation to write many short lines and a line larger than the
+ buffer to a file through an output buffer, then read the file back and
+ verify that every line arrived in order.
+ */
+BOOLEAN
+TestOutputBufferToFile(VOID)
+{
+    YORI_STRING TempPath;
+    YORI_STRING Prefix;
+    YORI_STRING TempFileName;
+    YORI_STRING LineString;
+    YORI_STRING LongLine;
+    YORI_STRING Expected;
+    YORI_LIB_OUTPUT_BUFFER OutputBuffer;
+    HANDLE TempHandle;
+    PVOID LineContext;
+    DWORD LineNumber;
+    YORI_ALLOC_SIZE_T Index;
+    BOOLEAN Result;
+
+    if (!YoriLibGetTempPath(&TempPath, 0)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibGetTempPath failed\n"), __FILE__, __LINE__);
+        return FALSE;
+    }
+
+    YoriLibConstantString(&Prefix, _T("TST"));
+    if (!YoriLibGetTempFileName(&TempPath, &Prefix, &TempHandle, &TempFileName)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibGetTempFileName failed\n"), __FILE__, __LINE__);
+        YoriLibFreeStringContents(&TempPath);
+        return FALSE;
+    }
+    YoriLibFreeStringContents(&TempPath);
+
+    Result = FALSE;
+    LineContext = NULL;
+    YoriLibInitEmptyString(&LineString);
+    YoriLibInitEmptyString(&Expected);
+    YoriLibInitEmptyString(&LongLine);
+
+    if (!YoriLibAllocateString(&LongLine, TEST_OUTPUT_LONG_LINE_LENGTH + 1)) {
+        goto Exit;
+    }
+
+    for (Index = 0; Index < TEST_OUTPUT_LONG_LINE_LENGTH; Index++) {
+        LongLine.StartOfString[Index] = (TCHAR)('a' + Index % 26);
+    }
+    LongLine.StartOfString[TEST_OUTPUT_LONG_LINE_LENGTH] = '\n';
+    LongLine.LengthInChars = TEST_OUTPUT_LONG_LINE_LENGTH + 1;
+
+    if (!YoriLibOutputBufferInitialize(&OutputBuffer, TempHandle)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibOutputBufferInitialize failed\n"), __FILE__, __LINE__);
+        goto Exit;
+    }
+
+    for (LineNumber = 0; LineNumber < TEST_OUTPUT_LINE_COUNT; LineNumber++) {
+        if (!YoriLibOutputToBuffer(&OutputBuffer, 0, _T("Line %i\n"), LineNumber)) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibOutputToBuffer failed on line %i\n"), __FILE__, __LINE__, LineNumber);
+            YoriLibOutputBufferCleanup(&OutputBuffer);
+            goto Exit;
+        }
+    }
+
+    if (!YoriLibOutputStringToBuffer(&OutputBuffer, 0, &LongLine) ||
+        !YoriLibOutputToBuffer(&OutputBuffer, 0, _T("End\n"))) {
+
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibOutputStringToBuffer failed\n"), __FILE__, __LINE__);
+        YoriLibOutputBufferCleanup(&OutputBuffer);
+        goto Exit;
+    }
+
+    YoriLibOutputBufferCleanup(&OutputBuffer);
+
+    SetFilePointer(TempHandle, 0, NULL, FILE_BEGIN);
+
+    for (LineNumber = 0; LineNumber < TEST_OUTPUT_LINE_COUNT; LineNumber++) {
+        if (!YoriLibReadLineToString(&LineString, &LineContext, TempHandle)) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibReadLineToString failed on line %i\n"), __FILE__, __LINE__, LineNumber);
+            goto Exit;
+        }
+
+        YoriLibYPrintf(&Expected, _T("Line %i"), LineNumber);
+        if (YoriLibCompareString(&LineString, &Expected) != 0) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i line %i is '%y' expected '%y'\n"), __FILE__, __LINE__, LineNumber, &LineString, &Expected);
+            goto Exit;
+        }
+    }
+
+    LongLine.LengthInChars = TEST_OUTPUT_LONG_LINE_LENGTH;
+    if (!YoriLibReadLineToString(&LineString, &LineContext, TempHandle) ||
+        YoriLibCompareString(&LineString, &LongLine) != 0) {
+
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i long line does not match\n"), __FILE__, __LINE__);
+        goto Exit;
+    }
+
+    YoriLibFreeStringContents(&Expected);
+    YoriLibConstantString(&Expected, _T("End"));
+    if (!YoriLibReadLineToString(&LineString, &LineContext, TempHandle) ||
+        YoriLibCompareString(&LineString, &Expected) != 0) {
+
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i final line does not match\n"), __FILE__, __LINE__);
+        goto Exit;
+    }
+
+    Result = TRUE;
+
+Exit:
+
+    if (LineContext != NULL) {
+        YoriLibLineReadClose(LineContext);
+    }
+    YoriLibFreeStringContents(&LineString);
+    YoriLibFreeStringContents(&LongLine);
+    YoriLibFreeStringContents(&Expected);
+    CloseHandle(TempHandle);
+    DeleteFile(TempFileName.StartOfString);
+    YoriLibFreeStringContents(&TempFileName);
+    return Result;
+}
+
+// vim:sw=4:ts=4:et:
@@ -0,0 +1,222 @@
+/**
+ * @file test/sha.c
+ *
+ * Yori shell test SHA-1 and SHA-256 digests
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yoripch.h>
+#include <yorilib.h>
+#include "test.h"
+
+/**
+ A known answer test from FIPS 180.
+ */
+typedef struct _TEST_SHA_VECTOR {
+
+    /**
+     The message, which is repeated RepeatCount times.
+     */
+    LPCSTR Message;
+
+    /**
+     The number of times to repeat Message.
+     */
+    DWORD RepeatCount;
+
+    /**
+     TRUE if the digest is SHA-256, FALSE if it is SHA-1.
+     */
+    BOOLEAN Sha256;
+
+    /**
+     The expected digest, in hex.
+     */
+    LPCSTR Digest;
+} TEST_SHA_VECTOR, *PTEST_SHA_VECTOR;
+
+/**
+ The known answer tests to verify.
+ */
+CONST TEST_SHA_VECTOR TestShaVectors[] = {
+    {"", 1, FALSE, "da39a3ee5e6b4b0d3255bfef95601890afd80709"},
+    {"abc", 1, FALSE, "a9993e364706816aba3e25717850c26c9cd0d89d"},
+    {"abcdbcdecdefdefgefghfghighijhijkijkljklmjklmnklmnlmnomnopnopq", 1, FALSE, "84983e441c3bd26ebaae4aa1f95129e5e54670f1"},
+    {"a", 1000000, FALSE, "34aa973cd4c4daa4f61eeb2bdbad27316534016f"},
+    {"", 1, TRUE, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+    {"abc", 1, TRUE, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+    {"abcdbcdecdefdefgefghfghighijhijkijkljklmjklmnklmnlmnomnopnopq", 1, TRUE, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+    {"a", 1000000, TRUE, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+};
+
+/**
+ The number of bytes to supply in each update call.  These are chosen to
+ exercise partial blocks, exact blocks, and data spanning blocks.  Zero
+ indicates the entire message in a single call.
+ */
+CONST DWORD TestShaChunkSizes[] = {0, 1, 3, 55, 56, 63, 64, 65, 1000};
+
+/**
+ Convert a hex digest into bytes.
+
+ @param Hex Pointer to the NULL terminated hex string.
+
+ @param Digest Pointer to a buffer to receive the bytes.
+
+ @return The number of bytes written.
+ */
+DWORD
+TestShaHexToBytes(
+    __in LPCSTR Hex,
+    __out PUCHAR Digest
+    )
+{
+    DWORD Index;
+    UCHAR Nibble;
+    CHAR Char;
+
+    for (Index = 0; Hex[Index] != '\0'; Index++) {
+        Char = Hex[Index];
+        if (Char >= '0' && Char <= '9') {
+            Nibble = (UCHAR)(Char - '0');
+        } else {
+            Nibble = (UCHAR)(Char - 'a' + 10);
+        }
+
+        if ((Index % 2) == 0) {
+            Digest[Index / 2] = (UCHAR)(Nibble << 4);
+        } else {
+            Digest[Index / 2] = (UCHAR)(Digest[Index / 2] | Nibble);
+        }
+    }
+
+    return Index / 2;
+}
+
+/**
+ A test variation that calculates the SHA-1 and SHA-256 digests of the
+ FIPS 180 messages, supplying the data in chunks of varying size, with the
+ processor's SHA extensions used if available and with the portable
+ implementation.
+ */
+BOOLEAN
+TestShaKnownAnswers(VOID)
+{
+    YORI_LIB_SHA_CONTEXT ShaContext;
+    UCHAR Expected[YORI_LIB_SHA256_DIGEST_LENGTH];
+    UCHAR Digest[YORI_LIB_SHA256_DIGEST_LENGTH];
+    PUCHAR Buffer;
+    DWORD BufferLength;
+    DWORD MessageLength;
+    DWORD DigestLength;
+    DWORD VectorIndex;
+    DWORD ChunkIndex;
+    DWORD ChunkLength;
+    DWORD Repeat;
+    DWORD Index;
+    DWORD Pass;
+    BOOLEAN UseShaExtensions;
+    BOOLEAN Result;
+
+    //
+    //  Allocate a buffer large enough for the longest message once it has
+    //  been repeated.
+    //
+
+    BufferLength = 0;
+    for (VectorIndex = 0; VectorIndex < sizeof(TestShaVectors)/sizeof(TestShaVectors[0]); VectorIndex++) {
+        MessageLength = (DWORD)strlen(TestShaVectors[VectorIndex].Message) * TestShaVectors[VectorIndex].RepeatCount;
+        if (MessageLength > BufferLength) {
+            BufferLength = MessageLength;
+        }
+    }
+
+    Buffer = YoriLibMalloc(BufferLength);
+    if (Buffer == NULL) {
+        return FALSE;
+    }
+
+    Result = FALSE;
+    for (VectorIndex = 0; VectorIndex < sizeof(TestShaVectors)/sizeof(TestShaVectors[0]); VectorIndex++) {
+
+        MessageLength = (DWORD)strlen(TestShaVectors[VectorIndex].Message);
+        for (Repeat = 0; Repeat < TestShaVectors[VectorIndex].RepeatCount; Repeat++) {
+            memcpy(&Buffer[Repeat * MessageLength], TestShaVectors[VectorIndex].Message, MessageLength);
+        }
+        MessageLength = MessageLength * TestShaVectors[VectorIndex].RepeatCount;
+        DigestLength = TestShaHexToBytes(TestShaVectors[VectorIndex].Digest, Expected);
+
+        //
+        //  The first pass uses the default, which uses the SHA extensions if
+        //  the processor supports them.  The second forces the portable
+        //  implementation.
+        //
+
+        for (Pass = 0; Pass < 2; Pass++) {
+            for (ChunkIndex = 0; ChunkIndex < sizeof(TestShaChunkSizes)/sizeof(TestShaChunkSizes[0]); ChunkIndex++) {
+
+                if (TestShaVectors[VectorIndex].Sha256) {
+                    YoriLibSha256Initialize(&ShaContext);
+                } else {
+                    YoriLibSha1Initialize(&ShaContext);
+                }
+
+                if (Pass == 1) {
+                    ShaContext.UseShaExtensions = FALSE;
+                }
+                UseShaExtensions = ShaContext.UseShaExtensions;
+
+                for (Index = 0; Index < MessageLength; Index = Index + ChunkLength) {
+                    ChunkLength = TestShaChunkSizes[ChunkIndex];
+                    if (ChunkLength == 0 || ChunkLength > MessageLength - Index) {
+                        ChunkLength = MessageLength - Index;
+                    }
+                    YoriLibShaUpdate(&ShaContext, &Buffer[Index], ChunkLength);
+                }
+
+                YoriLibShaFinalize(&ShaContext, Digest);
+
+                if (memcmp(Digest, Expected, DigestLength) != 0) {
+                    YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                                  _T("%hs:%i %hs digest of vector %i with chunk size %i and SHA extensions %i did not match %hs\n"),
+                                  __FILE__,
+                                  __LINE__,
+                                  TestShaVectors[VectorIndex].Sha256?"SHA-256":"SHA-1",
+                                  VectorIndex,
+                                  TestShaChunkSizes[ChunkIndex],
+                                  UseShaExtensions,
+                                  TestShaVectors[VectorIndex].Digest);
+                    goto Exit;
+                }
+            }
+        }
+    }
+
+    Result = TRUE;
+
+Exit:
+    YoriLibFree(Buffer);
+    return Result;
+}
+
+// vim:sw=4:ts=4:et:
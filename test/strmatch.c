@@ -0,0 +1,373 @@
+/**
+ * @file test/strmatch.c
+ *
+ * Yori shell test multi-pattern string matching
+ *
+ * Copyright (c) 2026 Malcolm J. Smith
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <yoripch.h>
+#include <yoripch.h>
+#include <yorilib.h>
+#include "test.h"
+
+/**
+ The number of random sets of substrings and strings to compare.
+ */
+#define TEST_STRMATCH_ITERATIONS 20000
+
+/**
+ The maximum number of substrings in each random set.
+ */
+#define TEST_STRMATCH_MAX_MATCHES 6
+
+/**
+ The maximum length of each random substring.
+ */
+#define TEST_STRMATCH_MAX_MATCH_LENGTH 4
+
+/**
+ The maximum length of each random string to search.
+ */
+#define TEST_STRMATCH_MAX_STRING_LENGTH 48
+
+/**
+ Generate a pseudo random number.  This is not intended to be high quality,
+ just repeatable and free of any CRT dependency.
+
+ @param Seed Pointer to the seed, updated on each call.
+
+ @return A pseudo random number.
+ */
+DWORD
+TestStrMatchRandom(
+    __inout PDWORD Seed
+    )
+{
+    *Seed = *Seed * 1103515245 + 12345;
+    return (*Seed >> 16) & 0x7FFF;
+}
+
+/**
+ Fill a string with random characters.  The characters are drawn from a
+ small alphabet containing both cases of some letters, so that substrings
+ frequently overlap and match case insensitively.
+
+ @param String Pointer to the string to fill.  This must have enough space
+        allocated for MaximumLength characters.
+
+ @param MaximumLength The largest number of characters to generate.
+
+ @param Seed Pointer to the seed used to select characters.
+ */
+VOID
+TestStrMatchRandomString(
+    __inout PYORI_STRING String,
+    __in YORI_ALLOC_SIZE_T MaximumLength,
+    __inout PDWORD Seed
+    )
+{
+    LPCTSTR Alphabet = _T("abcABh");
+    YORI_ALLOC_SIZE_T Index;
+
+    String->LengthInChars = (YORI_ALLOC_SIZE_T)(TestStrMatchRandom(Seed) % (MaximumLength + 1));
+    for (Index = 0; Index < String->LengthInChars; Index++) {
+        String->StartOfString[Index] = Alphabet[TestStrMatchRandom(Seed) % 6];
+    }
+}
+
+/**
+ Check the result of a search against the expected result.
+
+ @param MatchArray Pointer to the array of substrings that was searched for.
+
+ @param Found The substring returned by the search.
+
+ @param FoundOffset The offset returned by the search.
+
+ @param Expected The substring that should have been returned.
+
+ @param ExpectedOffset The offset that should have been returned.
+
+ @param String Pointer to the string that was searched.
+
+ @param Operation A description of the search, for diagnostic output.
+
+ @return TRUE if the results match, FALSE if they do not.
+ */
+BOOLEAN
+TestStrMatchCompare(
+    __in PYORI_STRING MatchArray,
+    __in_opt PYORI_STRING Found,
+    __in YORI_ALLOC_SIZE_T FoundOffset,
+    __in_opt PYORI_STRING Expected,
+    __in YORI_ALLOC_SIZE_T ExpectedOffset,
+    __in PCYORI_STRING String,
+    __in LPCSTR Operation
+    )
+{
+    if (Found != Expected ||
+        (Found != NULL && FoundOffset != ExpectedOffset)) {
+
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR,
+                      _T("%hs:%i %hs of \"%y\" returned index %i offset %i, expected index %i offset %i\n"),
+                      __FILE__,
+                      __LINE__,
+                      Operation,
+                      String,
+                      (Found == NULL)?-1:(int)(Found - MatchArray),
+                      FoundOffset,
+                      (Expected == NULL)?-1:(int)(Expected - MatchArray),
+                      ExpectedOffset);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ A test variation that compiles random sets of substrings and searches random
+ strings for them, comparing the results against
+ @ref YoriLibFindFirstMatchSubstr and @ref YoriLibFindFirstMatchSubstrIns .
+ */
+BOOLEAN
+TestMultiMatchRandom(VOID)
+{
+    YORI_LIB_MULTI_MATCH Matcher;
+    YORI_STRING MatchArray[TEST_STRMATCH_MAX_MATCHES];
+    TCHAR MatchBuffer[TEST_STRMATCH_MAX_MATCHES][TEST_STRMATCH_MAX_MATCH_LENGTH];
+    YORI_STRING String;
+    TCHAR StringBuffer[TEST_STRMATCH_MAX_STRING_LENGTH];
+    PYORI_STRING Found;
+    PYORI_STRING Expected;
+    YORI_ALLOC_SIZE_T FoundOffset;
+    YORI_ALLOC_SIZE_T ExpectedOffset;
+    YORI_ALLOC_SIZE_T NumberMatches;
+    YORI_ALLOC_SIZE_T Index;
+    DWORD Iteration;
+    DWORD Seed;
+    BOOLEAN Insensitive;
+
+    YoriLibInitEmptyString(&String);
+    String.StartOfString = StringBuffer;
+    String.LengthAllocated = TEST_STRMATCH_MAX_STRING_LENGTH;
+
+    for (Index = 0; Index < TEST_STRMATCH_MAX_MATCHES; Index++) {
+        YoriLibInitEmptyString(&MatchArray[Index]);
+        MatchArray[Index].StartOfString = MatchBuffer[Index];
+        MatchArray[Index].LengthAllocated = TEST_STRMATCH_MAX_MATCH_LENGTH;
+    }
+
+    Seed = 1;
+    for (Iteration = 0; Iteration < TEST_STRMATCH_ITERATIONS; Iteration++) {
+
+        Insensitive = (BOOLEAN)((Iteration % 2) != 0);
+        NumberMatches = (YORI_ALLOC_SIZE_T)(1 + TestStrMatchRandom(&Seed) % TEST_STRMATCH_MAX_MATCHES);
+        for (Index = 0; Index < NumberMatches; Index++) {
+            TestStrMatchRandomString(&MatchArray[Index], TEST_STRMATCH_MAX_MATCH_LENGTH, &Seed);
+        }
+        TestStrMatchRandomString(&String, TEST_STRMATCH_MAX_STRING_LENGTH, &Seed);
+
+        if (!YoriLibMultiMatchInitialize(&Matcher, NumberMatches, MatchArray, Insensitive)) {
+            YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibMultiMatchInitialize failed\n"), __FILE__, __LINE__);
+            return FALSE;
+        }
+
+        //
+        //  FindFirst should return the same result as searching at each
+        //  offset in turn.
+        //
+
+        Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+        if (Insensitive) {
+            Expected = YoriLibFindFirstMatchSubstrIns(&String, NumberMatches, MatchArray, &ExpectedOffset);
+        } else {
+            Expected = YoriLibFindFirstMatchSubstr(&String, NumberMatches, MatchArray, &ExpectedOffset);
+        }
+
+        if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, Expected, ExpectedOffset, &String, "FindFirst")) {
+            YoriLibMultiMatchCleanup(&Matcher);
+            return FALSE;
+        }
+
+        //
+        //  FindAny should return the earliest substring in the array that
+        //  occurs anywhere, along with its first occurrence.
+        //
+
+        Found = YoriLibMultiMatchFindAny(&Matcher, &String, &FoundOffset);
+        Expected = NULL;
+        ExpectedOffset = 0;
+        for (Index = 0; Index < NumberMatches; Index++) {
+            if (Insensitive) {
+                Expected = YoriLibFindFirstMatchSubstrIns(&String, 1, &MatchArray[Index], &ExpectedOffset);
+            } else {
+                Expected = YoriLibFindFirstMatchSubstr(&String, 1, &MatchArray[Index], &ExpectedOffset);
+            }
+            if (Expected != NULL) {
+                break;
+            }
+        }
+
+        if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, Expected, ExpectedOffset, &String, "FindAny")) {
+            YoriLibMultiMatchCleanup(&Matcher);
+            return FALSE;
+        }
+
+        YoriLibMultiMatchCleanup(&Matcher);
+    }
+
+    return TRUE;
+}
+
+/**
+ A test variation that searches for overlapping substrings where the answer
+ is known, including case insensitive searches and searches of an empty
+ string.
+ */
+BOOLEAN
+TestMultiMatchKnown(VOID)
+{
+    YORI_LIB_MULTI_MATCH Matcher;
+    YORI_STRING MatchArray[4];
+    YORI_STRING String;
+    PYORI_STRING Found;
+    YORI_ALLOC_SIZE_T FoundOffset;
+    BOOLEAN Result;
+
+    YoriLibConstantString(&MatchArray[0], _T("he"));
+    YoriLibConstantString(&MatchArray[1], _T("hers"));
+    YoriLibConstantString(&MatchArray[2], _T("she"));
+    YoriLibInitEmptyString(&MatchArray[3]);
+
+    Result = FALSE;
+
+    //
+    //  Case sensitively, "she" starts first in "ushers" even though "he"
+    //  and "hers" complete within it, and "he" is the earliest entry that
+    //  occurs anywhere.
+    //
+
+    if (!YoriLibMultiMatchInitialize(&Matcher, 3, MatchArray, FALSE)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibMultiMatchInitialize failed\n"), __FILE__, __LINE__);
+        return FALSE;
+    }
+
+    YoriLibConstantString(&String, _T("ushers"));
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, &MatchArray[2], 1, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    Found = YoriLibMultiMatchFindAny(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, &MatchArray[0], 2, &String, "FindAny")) {
+        goto Exit;
+    }
+
+    //
+    //  When two entries start at the same offset, the earlier one wins.
+    //
+
+    YoriLibConstantString(&String, _T("hers"));
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, &MatchArray[0], 0, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    YoriLibConstantString(&String, _T("USHERS"));
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, NULL, 0, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    YoriLibInitEmptyString(&String);
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, NULL, 0, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    Found = YoriLibMultiMatchFindAny(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, NULL, 0, &String, "FindAny")) {
+        goto Exit;
+    }
+
+    YoriLibMultiMatchCleanup(&Matcher);
+
+    //
+    //  Case insensitively, the same results are found in upper case.
+    //
+
+    if (!YoriLibMultiMatchInitialize(&Matcher, 3, MatchArray, TRUE)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibMultiMatchInitialize failed\n"), __FILE__, __LINE__);
+        return FALSE;
+    }
+
+    YoriLibConstantString(&String, _T("USHERS"));
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, &MatchArray[2], 1, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    YoriLibConstantString(&String, _T("uShErS"));
+    Found = YoriLibMultiMatchFindAny(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, &MatchArray[0], 2, &String, "FindAny")) {
+        goto Exit;
+    }
+
+    YoriLibMultiMatchCleanup(&Matcher);
+
+    //
+    //  An empty substring matches the start of any string other than an
+    //  empty one, but a nonempty substring starting at the same offset and
+    //  earlier in the array is preferred.
+    //
+
+    if (!YoriLibMultiMatchInitialize(&Matcher, 4, MatchArray, FALSE)) {
+        YoriLibOutput(YORI_LIB_OUTPUT_STDERR, _T("%hs:%i YoriLibMultiMatchInitialize failed\n"), __FILE__, __LINE__);
+        return FALSE;
+    }
+
+    YoriLibConstantString(&String, _T("ushers"));
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, &MatchArray[3], 0, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    YoriLibConstantString(&String, _T("hers"));
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, &MatchArray[0], 0, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    YoriLibInitEmptyString(&String);
+    Found = YoriLibMultiMatchFindFirst(&Matcher, &String, &FoundOffset);
+    if (!TestStrMatchCompare(MatchArray, Found, FoundOffset, NULL, 0, &String, "FindFirst")) {
+        goto Exit;
+    }
+
+    Result = TRUE;
+
+Exit:
+    YoriLibMultiMatchCleanup(&Matcher);
+    return Result;
+}
+
+// vim:sw=4:ts=4:et:
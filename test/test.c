@@ -41,7 +41,7 @@ CHAR strTestHelpText[] =
         "   -v             Variation to include\n"
         "   -x             Variation to exclude\n"
         "\n"
-        "Supported variations:\n";
+        "Supported variations (* only runs if included with -v):\n";
 
 /**
  A structure to describe a test variation.
@@ -58,6 +58,13 @@ typedef struct _TEST_VARIATION {
      */
     LPCTSTR Name;
 
+    /**
+     If TRUE, the variation only executes if it is included via command line
+     parameter.  This is used for variations that take a long time or
+     measure performance rather than checking correctness.
+     */
+    BOOLEAN ExplicitOnly;
+
     /**
      If TRUE, the execution status of this variation was set explicitly via
      command line parameter.  If FALSE, default execution should apply.
@@ -79,6 +86,7 @@ typedef struct _TEST_VARIATION {
 TEST_VARIATION TestVariations[] = {
     {TestEnumRoot,                         _T("EnumRoot")},
     {TestEnumWindows,                      _T("EnumWindows")},
+    {TestEnumParallel,                     _T("EnumParallel")},
     {TestParseTwoArgCmd,                   _T("ParseTwoArgCmd")},
     {TestParseOneArgContainingQuotesCmd,   _T("ParseOneArgContainingQuotesCmd")},
     {TestParseOneArgEnclosedInQuotesCmd,   _T("ParseOneArgEnclosedInQuotesCmd")},
@@ -93,6 +101,16 @@ TEST_VARIATION TestVariations[] = {
     {TestArgOneArgEnclosedInQuotesCmd,     _T("ArgOneArgEnclosedInQuotesCmd")},
     {TestArgRedirectWithEndingQuoteCmd,    _T("ArgRedirectWithEndingQuoteCmd")},
     {TestArgBackslashEscapeCmd,            _T("ArgBackslashEscapeCmd")},
+    {TestBase64RoundTrip,                  _T("Base64RoundTrip")},
+    {TestBase64Benchmark,                  _T("Base64Benchmark"), TRUE},
+    {TestByteSearch,                       _T("ByteSearch")},
+    {TestHashTableGrowth,                  _T("HashTableGrowth")},
+    {TestLineTerminatorSearch,             _T("LineTerminatorSearch")},
+    {TestLineReadMixedEndings,             _T("LineReadMixedEndings")},
+    {TestOutputBufferToFile,               _T("OutputBufferToFile")},
+    {TestShaKnownAnswers,                  _T("ShaKnownAnswers")},
+    {TestMultiMatchRandom,                 _T("MultiMatchRandom")},
+    {TestMultiMatchKnown,                  _T("MultiMatchKnown")},
 };
 
 
@@ -109,7 +127,7 @@ TestHelp(VOID)
 #endif
     YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("%hs"), strTestHelpText);
     for (i = 0; i < sizeof(TestVariations)/sizeof(TestVariations[0]); i++) {
-        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("    %s\n"), TestVariations[i].Name);
+        YoriLibOutput(YORI_LIB_OUTPUT_STDOUT, _T("    %s%s\n"), TestVariations[i].Name, TestVariations[i].ExplicitOnly?_T(" *"):_T(""));
     }
     return TRUE;
 }
@@ -185,9 +203,11 @@ ymain(
 
         ExecuteVariation = FALSE;
         if (RunAll) {
-            if (!TestVariations[i].ExplicitlySpecified ||
-                TestVariations[i].Execute) {
-
+            if (TestVariations[i].ExplicitlySpecified) {
+                if (TestVariations[i].Execute) {
+                    ExecuteVariation = TRUE;
+                }
+            } else if (!TestVariations[i].ExplicitOnly) {
                 ExecuteVariation = TRUE;
             }
         } else {
@@ -46,6 +46,12 @@ YORI_TEST_FN TestEnumRoot;
  */
 YORI_TEST_FN TestEnumWindows;
 
+/**
+ A test variation to compare parallel recursive enumerates against a regular
+ recursive enumerate.
+ */
+YORI_TEST_FN TestEnumParallel;
+
 /**
  A test variation to parse a command with two space delimited arguments.
  */
@@ -125,4 +131,58 @@ YORI_TEST_FN TestArgRedirectWithEndingQuoteCmd;
  */
 YORI_TEST_FN TestArgBackslashEscapeCmd;
 
+/**
+ A test variation to encode and decode base64 in chunks and verify the
+ result.
+ */
+YORI_TEST_FN TestBase64RoundTrip;
+
+/**
+ A test variation to measure base64 encode and decode throughput.
+ */
+YORI_TEST_FN TestBase64Benchmark;
+
+/**
+ A test variation to search binary buffers forward and backward.
+ */
+YORI_TEST_FN TestByteSearch;
+
+/**
+ A test variation to insert many entries into a hash table, requiring it to
+ grow.
+ */
+YORI_TEST_FN TestHashTableGrowth;
+
+/**
+ A test variation to search buffers for line terminators.
+ */
+YORI_TEST_FN TestLineTerminatorSearch;
+
+/**
+ A test variation to read a file containing lines of varying length and
+ mixed line endings.
+ */
+YORI_TEST_FN TestLineReadMixedEndings;
+
+/**
+ A test variation to write lines to a file through an output buffer.
+ */
+YORI_TEST_FN TestOutputBufferToFile;
+
+/**
+ A test variation to verify SHA-1 and SHA-256 digests against known answers.
+ */
+YORI_TEST_FN TestShaKnownAnswers;
+
+/**
+ A test variation to compare multi-pattern matching against searching for
+ each pattern at each offset.
+ */
+YORI_TEST_FN TestMultiMatchRandom;
+
+/**
+ A test variation to search for overlapping patterns with known results.
+ */
+YORI_TEST_FN TestMultiMatchKnown;
+
 // vim:sw=4:ts=4:et: